@@ -10,6 +10,7 @@
 #  include <Foundation/Platform/Win/PipeChannel_Win.h>
 #elif NS_ENABLED(NS_PLATFORM_LINUX)
 #  include <Foundation/Platform/Linux/PipeChannel_Linux.h>
+#  include <Foundation/Platform/Linux/SharedMemoryChannel_Linux.h>
 #endif
 
 NS_CHECK_AT_COMPILETIME((nsInt32)nsIpcChannel::ConnectionState::Disconnected == (nsInt32)nsIpcChannelEvent::Disconnected);
@@ -49,6 +50,22 @@ nsInternal::NewInstance<nsIpcChannel> nsIpcChannel::CreatePipeChannel(nsStringVi
 }
 
 
+nsInternal::NewInstance<nsIpcChannel> nsIpcChannel::CreateSharedMemoryChannel(nsStringView sAddress, Mode::Enum mode)
+{
+  if (sAddress.IsEmpty() || sAddress.GetElementCount() > 200)
+  {
+    nsLog::Error("Failed to create shared memory channel '{0}', name is not valid", sAddress);
+    return nullptr;
+  }
+
+#if NS_ENABLED(NS_PLATFORM_LINUX)
+  return NS_DEFAULT_NEW(nsSharedMemoryChannel_linux, sAddress, mode);
+#else
+  NS_ASSERT_NOT_IMPLEMENTED;
+  return nullptr;
+#endif
+}
+
 nsInternal::NewInstance<nsIpcChannel> nsIpcChannel::CreateNetworkChannel(nsStringView sAddress, Mode::Enum mode)
 {
 #ifdef BUILDSYSTEM_ENABLE_ENET_SUPPORT
@@ -93,6 +110,7 @@ bool nsIpcChannel::Send(nsArrayPtr<const nsUInt8> data)
     NS_LOCK(m_pOwner->m_TasksMutex);
     if (!m_pOwner->m_SendQueue.Contains(this))
       m_pOwner->m_SendQueue.PushBack(this);
+    OnMessageQueued();
     if (NeedWakeup())
     {
       m_pOwner->WakeUp();
@@ -0,0 +1,208 @@
+#include <Foundation/FoundationPCH.h>
+
+#include <Foundation/Communication/IpcChannel.h>
+#include <Foundation/Communication/RemoteInterfaceSharedMemory.h>
+#include <Foundation/Logging/Log.h>
+#include <Foundation/Types/ScopeExit.h>
+
+class nsRemoteInterfaceSharedMemoryImpl : public nsRemoteInterfaceSharedMemory
+{
+
+protected:
+  virtual void InternalUpdateRemoteInterface() override;
+  virtual nsResult InternalCreateConnection(nsRemoteMode mode, nsStringView sServerAddress) override;
+  virtual void InternalShutdownConnection() override;
+  virtual nsTime InternalGetPingToServer() override;
+  virtual nsResult InternalTransmit(nsRemoteTransmitMode tm, const nsArrayPtr<const nsUInt8>& data) override;
+
+private:
+  void ReceiveMessage(nsArrayPtr<const nsUInt8> message);
+  void ProcessMessage(nsArrayPtr<const nsUInt8> message);
+
+  nsUniquePtr<nsIpcChannel> m_pChannel;
+  bool m_bAllowNetworkUpdates = true;
+  bool m_bSentApplicationID = false;
+  bool m_bConnected = false;
+  nsUInt32 m_uiClientID = 0;
+
+  // Filled by the channel's worker thread, which must not wait for the interface's mutex.
+  nsMutex m_IncomingMutex;
+  nsDeque<nsDynamicArray<nsUInt8>> m_IncomingMessages;
+  nsDeque<nsDynamicArray<nsUInt8>> m_ProcessedMessages;
+};
+
+nsInternal::NewInstance<nsRemoteInterfaceSharedMemory> nsRemoteInterfaceSharedMemory::Make(nsAllocator* pAllocator /*= nsFoundation::GetDefaultAllocator()*/)
+{
+  return NS_NEW(pAllocator, nsRemoteInterfaceSharedMemoryImpl);
+}
+
+nsRemoteInterfaceSharedMemory::nsRemoteInterfaceSharedMemory() = default;
+nsRemoteInterfaceSharedMemory::~nsRemoteInterfaceSharedMemory() = default;
+
+nsResult nsRemoteInterfaceSharedMemoryImpl::InternalCreateConnection(nsRemoteMode mode, nsStringView sServerAddress)
+{
+  m_pChannel = nsIpcChannel::CreateSharedMemoryChannel(sServerAddress, (mode == nsRemoteMode::Server) ? nsIpcChannel::Mode::Server : nsIpcChannel::Mode::Client);
+
+  if (m_pChannel == nullptr)
+  {
+    nsLog::Error("Failed to create a shared memory channel for '{0}'", sServerAddress);
+    return NS_FAILURE;
+  }
+
+  m_pChannel->SetReceiveCallback(nsMakeDelegate(&nsRemoteInterfaceSharedMemoryImpl::ReceiveMessage, this));
+  m_pChannel->Connect();
+
+  m_sServerInfoIP = "localhost";
+  return NS_SUCCESS;
+}
+
+void nsRemoteInterfaceSharedMemoryImpl::InternalShutdownConnection()
+{
+  // tells the peer and waits for the channel's worker thread
+  m_pChannel.Clear();
+
+  m_bSentApplicationID = false;
+  m_bConnected = false;
+  m_uiClientID = 0;
+
+  NS_LOCK(m_IncomingMutex);
+  m_IncomingMessages.Clear();
+}
+
+nsTime nsRemoteInterfaceSharedMemoryImpl::InternalGetPingToServer()
+{
+  // no network in between
+  return nsTime::MakeZero();
+}
+
+nsResult nsRemoteInterfaceSharedMemoryImpl::InternalTransmit(nsRemoteTransmitMode tm, const nsArrayPtr<const nsUInt8>& data)
+{
+  NS_IGNORE_UNUSED(tm);
+
+  // the channel would keep the message until the next connection, the network implementation drops it instead
+  if (m_pChannel == nullptr || !m_pChannel->IsConnected())
+    return NS_FAILURE;
+
+  return m_pChannel->Send(data) ? NS_SUCCESS : NS_FAILURE;
+}
+
+void nsRemoteInterfaceSharedMemoryImpl::ReceiveMessage(nsArrayPtr<const nsUInt8> message)
+{
+  NS_LOCK(m_IncomingMutex);
+  m_IncomingMessages.ExpandAndGetRef() = message;
+}
+
+void nsRemoteInterfaceSharedMemoryImpl::InternalUpdateRemoteInterface()
+{
+  if (m_pChannel == nullptr)
+    return;
+
+  // every Send() updates the interface again
+  if (!m_bAllowNetworkUpdates)
+    return;
+
+  m_bAllowNetworkUpdates = false;
+  NS_SCOPE_EXIT(m_bAllowNetworkUpdates = true);
+
+  {
+    NS_LOCK(m_IncomingMutex);
+    m_ProcessedMessages.Swap(m_IncomingMessages);
+  }
+
+  for (const nsDynamicArray<nsUInt8>& message : m_ProcessedMessages)
+  {
+    ProcessMessage(message);
+  }
+
+  m_ProcessedMessages.Clear();
+
+  switch (m_pChannel->GetConnectionState())
+  {
+    case nsIpcChannel::ConnectionState::Connected:
+    {
+      if (GetRemoteMode() == nsRemoteMode::Server && !m_bSentApplicationID)
+      {
+        m_bSentApplicationID = true;
+
+        const nsUInt32 uiAppID = GetApplicationID();
+        Send(nsRemoteTransmitMode::Reliable, GetConnectionToken(), 'NSID', nsArrayPtr<const nsUInt8>(reinterpret_cast<const nsUInt8*>(&uiAppID), sizeof(nsUInt32)));
+
+        // then wait for its acknowledgment message
+      }
+    }
+    break;
+
+    case nsIpcChannel::ConnectionState::Disconnected:
+    {
+      if (m_bConnected)
+      {
+        m_bConnected = false;
+
+        if (GetRemoteMode() == nsRemoteMode::Client)
+        {
+          ReportDisconnectedFromServer();
+        }
+        else
+        {
+          ReportDisconnectedFromClient(m_uiClientID);
+          m_uiClientID = 0;
+        }
+      }
+
+      // the server waits for the next client, the client for the server to come back
+      m_bSentApplicationID = false;
+      m_pChannel->Connect();
+    }
+    break;
+
+    default:
+      break;
+  }
+}
+
+void nsRemoteInterfaceSharedMemoryImpl::ProcessMessage(nsArrayPtr<const nsUInt8> message)
+{
+  if (message.GetCount() < 12)
+    return;
+
+  const nsUInt32 uiApplicationID = *((const nsUInt32*)&message[0]);
+  const nsUInt32 uiSystemID = *((const nsUInt32*)&message[4]);
+  const nsUInt32 uiMsgID = *((const nsUInt32*)&message[8]);
+  const nsArrayPtr<const nsUInt8> data = message.GetSubArray(12);
+
+  if (uiSystemID != GetConnectionToken())
+  {
+    ReportMessage(uiApplicationID, uiSystemID, uiMsgID, data);
+    return;
+  }
+
+  switch (uiMsgID)
+  {
+    case 'NSID':
+    {
+      if (data.GetCount() < sizeof(nsUInt32))
+        break;
+
+      // acknowledge that the ID has been received
+      Send(GetConnectionToken(), 'AKID');
+
+      // go tell the others about it
+      m_bConnected = true;
+      ReportConnectionToServer(*((const nsUInt32*)data.GetPtr()));
+    }
+    break;
+
+    case 'AKID':
+    {
+      if (!m_bConnected)
+      {
+        m_bConnected = true;
+        m_uiClientID = uiApplicationID;
+
+        // the client received the server ID -> the connection has been established properly
+        ReportConnectionToClient(uiApplicationID);
+      }
+    }
+    break;
+  }
+}
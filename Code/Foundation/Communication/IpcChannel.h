@@ -39,6 +39,7 @@ struct NS_FOUNDATION_DLL nsIpcChannelEvent
 ///  A client should only try to connect to a server once the server has changed to ConnectionState::Connecting as this indicates the server is ready to be conneccted to.
 ///
 ///  Use nsIpcChannel:::CreatePipeChannel to create an IPC pipe instance.
+///  Use nsIpcChannel::CreateSharedMemoryChannel for a shared memory channel between processes on the same machine.
 ///  To send more complex messages accross, you can create a nsIpcProcessMessageProtocol on top of the channel.
 class NS_FOUNDATION_DLL nsIpcChannel
 {
@@ -75,6 +76,13 @@ public:
 
   static nsInternal::NewInstance<nsIpcChannel> CreateNetworkChannel(nsStringView sAddress, Mode::Enum mode);
 
+  /// \brief Creates an IPC communication channel between two processes on the same machine using a shared memory ring buffer.
+  ///
+  /// Unlike a pipe the data is not copied through the kernel, which pays off for high-bandwidth streams like debug captures.
+  /// \param szAddress Name of the channel, must be unique on a system and less than 200 characters.
+  /// \param mode Whether to run in client or server mode.
+  static nsInternal::NewInstance<nsIpcChannel> CreateSharedMemoryChannel(nsStringView sAddress, Mode::Enum mode);
+
 
   /// \brief Connects async. On success, m_Events will be broadcasted.
   void Connect();
@@ -113,6 +121,8 @@ protected:
   virtual void InternalSend() = 0;
   /// \brief Called by Send to determine whether the message loop need to be woken up.
   virtual bool NeedWakeup() const = 0;
+  /// \brief Called by Send on the sending thread after the message was queued. Channels that move the data on their own thread can pick it up here.
+  virtual void OnMessageQueued() {}
 
   void SetConnectionState(nsEnum<ConnectionState> state);
   /// \brief Implementation needs to call this when new data has been received.
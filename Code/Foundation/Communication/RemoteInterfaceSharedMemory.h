@@ -0,0 +1,24 @@
+#pragma once
+
+#include <Foundation/Communication/RemoteInterface.h>
+
+/// \brief An implementation for nsRemoteInterface built on top of a shared memory nsIpcChannel.
+///
+/// Only connects processes on the same machine, the address is the name of the channel instead of an IP and port.
+/// A server only accepts a single client at a time, once that client disconnects the server waits for the next one.
+///
+/// nsTelemetry does not use this, its connection handling is tied to ENet. Data that goes through nsTelemetry, e.g. the frame streams
+/// of the Jolt debugger interface, still takes the network path on the same machine. Only tools that talk over an nsRemoteInterface
+/// can use the shared memory channel.
+class NS_FOUNDATION_DLL nsRemoteInterfaceSharedMemory : public nsRemoteInterface
+{
+public:
+  ~nsRemoteInterfaceSharedMemory();
+
+  /// \brief Allocates a new instance with the given allocator
+  static nsInternal::NewInstance<nsRemoteInterfaceSharedMemory> Make(nsAllocator* pAllocator = nsFoundation::GetDefaultAllocator());
+
+private:
+  nsRemoteInterfaceSharedMemory();
+  friend class nsRemoteInterfaceSharedMemoryImpl;
+};
@@ -0,0 +1,554 @@
+#include <Foundation/FoundationPCH.h>
+
+#if NS_ENABLED(NS_PLATFORM_LINUX)
+#  include <Foundation/Communication/Implementation/MessageLoop.h>
+#  include <Foundation/Logging/Log.h>
+#  include <Foundation/Platform/Linux/SharedMemoryChannel_Linux.h>
+#  include <Foundation/Threading/AtomicUtils.h>
+#  include <Foundation/Threading/Thread.h>
+
+#  include <fcntl.h>
+#  include <linux/futex.h>
+#  include <signal.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#  include <unistd.h>
+
+static constexpr nsInt32 s_iSegmentMagic = 'NSHM';
+static constexpr nsUInt32 s_uiSegmentVersion = 1;
+static constexpr nsUInt32 s_uiRingCapacity = 4 * 1024 * 1024; // per direction, must be a power of two
+static constexpr nsInt32 s_iDoorbellTimeoutMS = 100;           // how often a sleeping worker checks whether the peer process still exists
+static constexpr nsInt32 s_iConnectRetryMS = 10;               // how often a client looks for the server's segment
+
+/// \brief The shared state of one side of the channel. Only the owning side sleeps on the doorbell, the peer rings it.
+struct alignas(64) nsSharedMemoryEndpoint
+{
+  nsInt32 m_iDoorbell;
+  nsInt32 m_iSleeping;        ///< Set while the owner is (about to be) waiting on the doorbell, the peer only issues a futex wake then.
+  nsInt32 m_iWaitingForSpace; ///< Set while the owner waits for the peer to read from the full ring.
+  nsInt32 m_iProcessId;       ///< Zero until the side attached to the segment.
+  nsInt32 m_iClosed;
+};
+
+/// \brief A single-producer single-consumer byte ring. The positions only ever grow, each on its own cache line.
+struct nsSharedMemoryRing
+{
+  alignas(64) nsInt64 m_iWritePos;
+  alignas(64) nsInt64 m_iReadPos;
+};
+
+/// \brief Lies at the start of the segment, the data of both rings follows it.
+struct alignas(64) nsSharedMemorySegmentHeader
+{
+  nsInt32 m_iMagic; ///< Written last by the server, the segment is valid once it is set.
+  nsUInt32 m_uiVersion;
+  nsUInt32 m_uiRingCapacity;
+  nsSharedMemoryEndpoint m_Endpoints[2]; ///< Indexed by nsIpcChannel::Mode.
+  nsSharedMemoryRing m_Rings[2];         ///< Each ring is written by the endpoint with the same index.
+};
+
+static constexpr nsUInt64 s_uiSegmentSize = sizeof(nsSharedMemorySegmentHeader) + 2 * static_cast<nsUInt64>(s_uiRingCapacity);
+
+static nsSharedMemorySegmentHeader* GetHeader(nsUInt8* pSegment)
+{
+  return reinterpret_cast<nsSharedMemorySegmentHeader*>(pSegment);
+}
+
+static nsUInt8* GetRingData(nsUInt8* pSegment, nsUInt32 uiRing)
+{
+  return pSegment + sizeof(nsSharedMemorySegmentHeader) + uiRing * s_uiRingCapacity;
+}
+
+static bool IsProcessAlive(nsInt32 iProcessId)
+{
+  // EPERM means the process exists, it just belongs to someone else
+  return kill(iProcessId, 0) == 0 || errno != ESRCH;
+}
+
+static void RingDoorbell(nsSharedMemoryEndpoint& ref_endpoint)
+{
+  // Pairs with the owner setting m_iSleeping before it compares the doorbell: either we see it sleeping or it sees the new value.
+  nsAtomicUtils::Increment(ref_endpoint.m_iDoorbell);
+
+  if (nsAtomicUtils::Read(ref_endpoint.m_iSleeping) != 0)
+  {
+    syscall(SYS_futex, &ref_endpoint.m_iDoorbell, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+  }
+}
+
+class nsSharedMemoryChannelThread : public nsThread
+{
+public:
+  nsSharedMemoryChannelThread(nsSharedMemoryChannel_linux* pChannel)
+    : nsThread("nsSharedMemoryChannelThread")
+    , m_pChannel(pChannel)
+  {
+  }
+
+private:
+  virtual nsUInt32 Run() override
+  {
+    m_pChannel->RunWorker();
+    return 0;
+  }
+
+  nsSharedMemoryChannel_linux* m_pChannel = nullptr;
+};
+
+nsSharedMemoryChannel_linux::nsSharedMemoryChannel_linux(nsStringView sAddress, Mode::Enum mode)
+  : nsIpcChannel(sAddress, mode)
+{
+  // POSIX shared memory names are a single path component
+  nsStringBuilder sName(sAddress);
+  sName.ReplaceAll("/", "_");
+  sName.Prepend("/ns-ipc-");
+  m_sSegmentName = sName;
+
+  m_pOwner->AddChannel(this);
+}
+
+nsSharedMemoryChannel_linux::~nsSharedMemoryChannel_linux()
+{
+  StopWorker();
+
+  if (m_pSegment != nullptr)
+  {
+    nsAtomicUtils::Set(GetHeader(m_pSegment)->m_Endpoints[m_Mode].m_iClosed, 1);
+    RingDoorbell(GetHeader(m_pSegment)->m_Endpoints[1 - m_Mode]);
+  }
+
+  CloseSegment();
+}
+
+void nsSharedMemoryChannel_linux::InternalConnect()
+{
+  if (GetConnectionState() != ConnectionState::Disconnected)
+    return;
+
+  if (m_Mode == Mode::Server && CreateSegment().Failed())
+    return;
+
+  m_previousSendOffset = 0;
+  SetConnectionState(ConnectionState::Connecting);
+
+  m_bStopWorker = false;
+  m_pWorker = NS_DEFAULT_NEW(nsSharedMemoryChannelThread, this);
+  m_pWorker->Start();
+}
+
+void nsSharedMemoryChannel_linux::InternalDisconnect()
+{
+  if (GetConnectionState() == ConnectionState::Disconnected)
+    return;
+
+  StopWorker();
+
+  if (m_pSegment != nullptr)
+  {
+    // tell the peer, it disconnects on its own
+    nsAtomicUtils::Set(GetHeader(m_pSegment)->m_Endpoints[m_Mode].m_iClosed, 1);
+    RingDoorbell(GetHeader(m_pSegment)->m_Endpoints[1 - m_Mode]);
+  }
+
+  {
+    NS_LOCK(m_OutputQueueMutex);
+    m_OutputQueue.Clear();
+  }
+
+  // Send() may run on any thread, it must see the disconnect before the segment goes away
+  SetConnectionState(ConnectionState::Disconnected);
+  CloseSegment();
+
+  m_IncomingMessages.RaiseSignal(); // Wakeup anyone still waiting for messages
+}
+
+void nsSharedMemoryChannel_linux::InternalSend()
+{
+  // OnMessageQueued() normally told the worker already, which is the only one writing into the ring
+  WakeWorker();
+}
+
+bool nsSharedMemoryChannel_linux::NeedWakeup() const
+{
+  // the worker sends the messages, not the message loop thread
+  return false;
+}
+
+void nsSharedMemoryChannel_linux::OnMessageQueued()
+{
+  // the worker sends the message without a detour over the message loop thread
+  WakeWorker();
+}
+
+void nsSharedMemoryChannel_linux::WakeWorker()
+{
+  // the lock keeps CloseSegment() from unmapping the segment in between the check and the doorbell
+  NS_LOCK(m_SegmentMutex);
+
+  if (IsConnected() && m_pSegment != nullptr)
+  {
+    RingDoorbell(GetHeader(m_pSegment)->m_Endpoints[m_Mode]);
+  }
+}
+
+nsResult nsSharedMemoryChannel_linux::CreateSegment()
+{
+  m_iSegmentFd = shm_open(m_sSegmentName.GetData(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+
+  // a server that crashed leaves its segment behind, only that one may be replaced, never the segment of a running server
+  if (m_iSegmentFd == -1 && errno == EEXIST && IsStaleSegment())
+  {
+    shm_unlink(m_sSegmentName.GetData());
+    m_iSegmentFd = shm_open(m_sSegmentName.GetData(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  }
+
+  if (m_iSegmentFd == -1)
+  {
+    nsLog::Error("[IPC]Failed to create shared memory segment '{}'. error {}", m_sSegmentName, errno);
+    return NS_FAILURE;
+  }
+
+  if (ftruncate(m_iSegmentFd, s_uiSegmentSize) == -1)
+  {
+    nsLog::Error("[IPC]Failed to resize shared memory segment '{}' to {} bytes. error {}", m_sSegmentName, s_uiSegmentSize, errno);
+    CloseSegment();
+    return NS_FAILURE;
+  }
+
+  void* pSegment = mmap(nullptr, s_uiSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_iSegmentFd, 0);
+  if (pSegment == MAP_FAILED)
+  {
+    nsLog::Error("[IPC]Failed to map shared memory segment '{}'. error {}", m_sSegmentName, errno);
+    CloseSegment();
+    return NS_FAILURE;
+  }
+
+  {
+    NS_LOCK(m_SegmentMutex);
+    m_pSegment = static_cast<nsUInt8*>(pSegment);
+    m_uiSegmentSize = s_uiSegmentSize;
+  }
+
+  // a new segment is zero filled, so both rings are empty and the client slot is free
+  nsSharedMemorySegmentHeader* pHeader = GetHeader(m_pSegment);
+  pHeader->m_uiVersion = s_uiSegmentVersion;
+  pHeader->m_uiRingCapacity = s_uiRingCapacity;
+  pHeader->m_Endpoints[Mode::Server].m_iProcessId = getpid();
+  nsAtomicUtils::Set(pHeader->m_iMagic, s_iSegmentMagic);
+
+  return NS_SUCCESS;
+}
+
+nsResult nsSharedMemoryChannel_linux::OpenSegment()
+{
+  m_iSegmentFd = shm_open(m_sSegmentName.GetData(), O_RDWR | O_CLOEXEC, 0);
+  if (m_iSegmentFd == -1)
+    return NS_FAILURE;
+
+  // the server may still be setting the segment up, or it belongs to another version
+  struct stat info = {};
+  if (fstat(m_iSegmentFd, &info) == -1 || static_cast<nsUInt64>(info.st_size) != s_uiSegmentSize)
+  {
+    CloseSegment();
+    return NS_FAILURE;
+  }
+
+  void* pSegment = mmap(nullptr, s_uiSegmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_iSegmentFd, 0);
+  if (pSegment == MAP_FAILED)
+  {
+    nsLog::Error("[IPC]Failed to map shared memory segment '{}'. error {}", m_sSegmentName, errno);
+    CloseSegment();
+    return NS_FAILURE;
+  }
+
+  {
+    NS_LOCK(m_SegmentMutex);
+    m_pSegment = static_cast<nsUInt8*>(pSegment);
+    m_uiSegmentSize = s_uiSegmentSize;
+  }
+
+  nsSharedMemorySegmentHeader* pHeader = GetHeader(m_pSegment);
+  if (nsAtomicUtils::Read(pHeader->m_iMagic) != s_iSegmentMagic || pHeader->m_uiVersion != s_uiSegmentVersion || pHeader->m_uiRingCapacity != s_uiRingCapacity)
+  {
+    CloseSegment();
+    return NS_FAILURE;
+  }
+
+  // claim the client slot, it stays taken while another client is connected
+  if (IsPeerGone() || !nsAtomicUtils::TestAndSet(pHeader->m_Endpoints[Mode::Client].m_iProcessId, 0, getpid()))
+  {
+    CloseSegment();
+    return NS_FAILURE;
+  }
+
+  RingDoorbell(pHeader->m_Endpoints[Mode::Server]);
+  return NS_SUCCESS;
+}
+
+bool nsSharedMemoryChannel_linux::IsStaleSegment() const
+{
+  const int iFd = shm_open(m_sSegmentName.GetData(), O_RDWR | O_CLOEXEC, 0);
+  if (iFd == -1)
+    return errno == ENOENT;
+
+  // a server that is still setting up its segment has not written its process ID yet, only a known dead owner makes it stale
+  bool bStale = false;
+  struct stat info = {};
+
+  if (fstat(iFd, &info) == 0 && static_cast<nsUInt64>(info.st_size) >= sizeof(nsSharedMemorySegmentHeader))
+  {
+    // writable, nsAtomicUtils::Read() is a read-modify-write on Posix
+    void* pHeader = mmap(nullptr, sizeof(nsSharedMemorySegmentHeader), PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0);
+
+    if (pHeader != MAP_FAILED)
+    {
+      const nsInt32 iProcessId = nsAtomicUtils::Read(static_cast<nsSharedMemorySegmentHeader*>(pHeader)->m_Endpoints[Mode::Server].m_iProcessId);
+      bStale = iProcessId != 0 && !IsProcessAlive(iProcessId);
+      munmap(pHeader, sizeof(nsSharedMemorySegmentHeader));
+    }
+  }
+
+  close(iFd);
+
+  if (!bStale)
+  {
+    nsLog::Error("[IPC]Shared memory segment '{}' belongs to a running server or one that is still starting up.", m_sSegmentName);
+  }
+
+  return bStale;
+}
+
+void nsSharedMemoryChannel_linux::CloseSegment()
+{
+  NS_LOCK(m_SegmentMutex);
+
+  if (m_pSegment != nullptr)
+  {
+    munmap(m_pSegment, m_uiSegmentSize);
+    m_pSegment = nullptr;
+    m_uiSegmentSize = 0;
+  }
+
+  if (m_iSegmentFd >= 0)
+  {
+    close(m_iSegmentFd);
+    m_iSegmentFd = -1;
+
+    // the name only lives as long as the server, a connected client keeps its mapping
+    if (m_Mode == Mode::Server)
+    {
+      shm_unlink(m_sSegmentName.GetData());
+    }
+  }
+}
+
+void nsSharedMemoryChannel_linux::StopWorker()
+{
+  if (m_pWorker == nullptr)
+    return;
+
+  m_bStopWorker = true;
+
+  // a client worker maps the segment itself, it may only be used here once the worker reported the connection
+  if ((m_Mode == Mode::Server || IsConnected()) && m_pSegment != nullptr)
+  {
+    RingDoorbell(GetHeader(m_pSegment)->m_Endpoints[m_Mode]);
+  }
+
+  m_pWorker->Join();
+  NS_DEFAULT_DELETE(m_pWorker);
+}
+
+void nsSharedMemoryChannel_linux::RunWorker()
+{
+  // the client only gets a segment once the server is up
+  while (m_pSegment == nullptr)
+  {
+    if (m_bStopWorker)
+      return;
+
+    if (OpenSegment().Succeeded())
+      break;
+
+    nsThreadUtils::Sleep(nsTime::MakeFromMilliseconds(s_iConnectRetryMS));
+  }
+
+  nsSharedMemorySegmentHeader* pHeader = GetHeader(m_pSegment);
+  nsSharedMemoryEndpoint& endpoint = pHeader->m_Endpoints[m_Mode];
+  const nsSharedMemoryEndpoint& peer = pHeader->m_Endpoints[1 - m_Mode];
+
+  if (m_Mode == Mode::Client)
+  {
+    SetConnectionState(ConnectionState::Connected);
+  }
+
+  while (!m_bStopWorker)
+  {
+    // everything the peer published before this value is seen by the work below
+    const nsInt32 iDoorbell = nsAtomicUtils::Read(endpoint.m_iDoorbell);
+
+    if (GetConnectionState() == ConnectionState::Connecting)
+    {
+      if (nsAtomicUtils::Read(pHeader->m_Endpoints[Mode::Client].m_iProcessId) == 0)
+      {
+        WaitForDoorbell(iDoorbell);
+        continue;
+      }
+
+      SetConnectionState(ConnectionState::Connected);
+    }
+
+    bool bDidWork = ProcessIncomingData();
+    bDidWork |= ProcessOutgoingData();
+
+    if (bDidWork)
+      continue;
+
+    if (nsAtomicUtils::Read(peer.m_iClosed) != 0 || (!WaitForDoorbell(iDoorbell) && IsPeerGone()))
+    {
+      // the peer may have written more before it closed
+      ProcessIncomingData();
+      Disconnect();
+      return;
+    }
+  }
+}
+
+bool nsSharedMemoryChannel_linux::ProcessIncomingData()
+{
+  nsSharedMemorySegmentHeader* pHeader = GetHeader(m_pSegment);
+  nsSharedMemoryRing& ring = pHeader->m_Rings[1 - m_Mode];
+  const nsUInt8* pRingData = GetRingData(m_pSegment, 1 - m_Mode);
+
+  const nsInt64 iReadPos = ring.m_iReadPos;
+  const nsInt64 iWritePos = nsAtomicUtils::Read(ring.m_iWritePos);
+  if (iReadPos == iWritePos)
+    return false;
+
+  // hand the data over right from the ring, the peer does not touch it before the read position moved on
+  const nsUInt32 uiAvailable = static_cast<nsUInt32>(iWritePos - iReadPos);
+  const nsUInt32 uiStart = static_cast<nsUInt32>(iReadPos) & (s_uiRingCapacity - 1);
+  const nsUInt32 uiFirst = nsMath::Min(uiAvailable, s_uiRingCapacity - uiStart);
+
+  ReceiveData(nsArrayPtr<const nsUInt8>(pRingData + uiStart, uiFirst));
+  if (uiAvailable > uiFirst)
+  {
+    ReceiveData(nsArrayPtr<const nsUInt8>(pRingData, uiAvailable - uiFirst));
+  }
+
+  nsAtomicUtils::Set(ring.m_iReadPos, iWritePos);
+
+  nsSharedMemoryEndpoint& peer = pHeader->m_Endpoints[1 - m_Mode];
+  if (nsAtomicUtils::TestAndSet(peer.m_iWaitingForSpace, 1, 0))
+  {
+    RingDoorbell(peer);
+  }
+
+  return true;
+}
+
+bool nsSharedMemoryChannel_linux::ProcessOutgoingData()
+{
+  nsSharedMemorySegmentHeader* pHeader = GetHeader(m_pSegment);
+  nsSharedMemoryRing& ring = pHeader->m_Rings[m_Mode];
+  nsUInt8* pRingData = GetRingData(m_pSegment, m_Mode);
+
+  const nsInt64 iStartPos = ring.m_iWritePos;
+  const nsInt64 iReadPos = nsAtomicUtils::Read(ring.m_iReadPos);
+  nsInt64 iWritePos = iStartPos;
+  bool bRingFull = false;
+
+  while (!bRingFull)
+  {
+    const nsMemoryStreamStorageInterface* storage = nullptr;
+    {
+      NS_LOCK(m_OutputQueueMutex);
+      if (m_OutputQueue.IsEmpty())
+        break;
+
+      storage = &m_OutputQueue.PeekFront();
+    }
+
+    const nsUInt64 uiSize = storage->GetStorageSize64();
+    while (m_previousSendOffset < uiSize)
+    {
+      const nsUInt32 uiFree = s_uiRingCapacity - static_cast<nsUInt32>(iWritePos - iReadPos);
+      if (uiFree == 0)
+      {
+        bRingFull = true;
+        break;
+      }
+
+      const nsArrayPtr<const nsUInt8> range = storage->GetContiguousMemoryRange(m_previousSendOffset);
+      const nsUInt32 uiCount = nsMath::Min(range.GetCount(), uiFree);
+      const nsUInt32 uiStart = static_cast<nsUInt32>(iWritePos) & (s_uiRingCapacity - 1);
+      const nsUInt32 uiFirst = nsMath::Min(uiCount, s_uiRingCapacity - uiStart);
+
+      nsMemoryUtils::Copy(pRingData + uiStart, range.GetPtr(), uiFirst);
+      nsMemoryUtils::Copy(pRingData, range.GetPtr() + uiFirst, uiCount - uiFirst);
+
+      iWritePos += uiCount;
+      m_previousSendOffset += uiCount;
+    }
+
+    if (m_previousSendOffset < uiSize)
+      break;
+
+    m_previousSendOffset = 0;
+
+    NS_LOCK(m_OutputQueueMutex);
+    m_OutputQueue.PopFront();
+  }
+
+  if (iWritePos != iStartPos)
+  {
+    // publish everything at once, the peer only gets woken when it sleeps
+    nsAtomicUtils::Set(ring.m_iWritePos, iWritePos);
+    RingDoorbell(pHeader->m_Endpoints[1 - m_Mode]);
+  }
+
+  if (bRingFull)
+  {
+    // ask the peer to ring once it made room, it may have done so already before it saw the flag
+    nsAtomicUtils::Set(pHeader->m_Endpoints[m_Mode].m_iWaitingForSpace, 1);
+    return iWritePos != iStartPos || nsAtomicUtils::Read(ring.m_iReadPos) != iReadPos;
+  }
+
+  return iWritePos != iStartPos;
+}
+
+bool nsSharedMemoryChannel_linux::IsPeerGone() const
+{
+  const nsSharedMemoryEndpoint& peer = GetHeader(m_pSegment)->m_Endpoints[1 - m_Mode];
+  if (nsAtomicUtils::Read(peer.m_iClosed) != 0)
+    return true;
+
+  // a process that crashed cannot say goodbye
+  const nsInt32 iProcessId = nsAtomicUtils::Read(peer.m_iProcessId);
+  return iProcessId != 0 && !IsProcessAlive(iProcessId);
+}
+
+bool nsSharedMemoryChannel_linux::WaitForDoorbell(nsInt32 iDoorbell)
+{
+  nsSharedMemoryEndpoint& endpoint = GetHeader(m_pSegment)->m_Endpoints[m_Mode];
+
+  nsAtomicUtils::Set(endpoint.m_iSleeping, 1);
+
+  bool bRung = true;
+  if (nsAtomicUtils::Read(endpoint.m_iDoorbell) == iDoorbell)
+  {
+    struct timespec timeout = {0, s_iDoorbellTimeoutMS * 1000000L};
+
+    // not FUTEX_PRIVATE_FLAG, the doorbell is rung from the other process
+    if (syscall(SYS_futex, &endpoint.m_iDoorbell, FUTEX_WAIT, iDoorbell, &timeout, nullptr, 0) == -1 && errno == ETIMEDOUT)
+    {
+      bRung = false;
+    }
+  }
+
+  nsAtomicUtils::Set(endpoint.m_iSleeping, 0);
+  return bRung;
+}
+
+#endif
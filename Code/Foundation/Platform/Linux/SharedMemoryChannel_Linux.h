@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Foundation/FoundationInternal.h>
+NS_FOUNDATION_INTERNAL_HEADER
+
+#if NS_ENABLED(NS_PLATFORM_LINUX)
+
+#  include <Foundation/Basics.h>
+#  include <Foundation/Communication/IpcChannel.h>
+
+class nsSharedMemoryChannelThread;
+
+/// \brief An nsIpcChannel between two processes on the same machine, built on a shared memory segment.
+///
+/// The server creates a POSIX shared memory object named after the address, the client maps the same object.
+/// The segment holds one single-producer single-consumer byte ring per direction, the bytes are copied straight into
+/// the ring of the peer and read back from it without any system call. Each side has a futex 'doorbell' in the segment,
+/// that the other side only wakes when it is actually sleeping on it.
+///
+/// The message loop waits on file descriptors only, so every channel runs its own worker thread that moves the data
+/// and sleeps on the doorbell. Send() rings the doorbell of the worker directly (OnMessageQueued()), the message loop thread only connects and disconnects.
+class NS_FOUNDATION_DLL nsSharedMemoryChannel_linux : public nsIpcChannel
+{
+public:
+  nsSharedMemoryChannel_linux(nsStringView sAddress, Mode::Enum mode);
+  ~nsSharedMemoryChannel_linux();
+
+private:
+  friend class nsSharedMemoryChannelThread;
+
+  // Run from the message loop thread
+  virtual void InternalConnect() override;
+  virtual void InternalDisconnect() override;
+  virtual void InternalSend() override;
+  virtual bool NeedWakeup() const override;
+
+  // Run from the threads calling Send()
+  virtual void OnMessageQueued() override;
+
+  void WakeWorker();
+  nsResult CreateSegment();
+  bool IsStaleSegment() const;
+  void CloseSegment();
+  void StopWorker();
+
+  // Run from the worker thread only
+  void RunWorker();
+  nsResult OpenSegment();
+  bool ProcessIncomingData();
+  bool ProcessOutgoingData();
+  bool IsPeerGone() const;
+  bool WaitForDoorbell(nsInt32 iDoorbell);
+
+private:
+  nsString m_sSegmentName;
+  int m_iSegmentFd = -1;
+  nsUInt8* m_pSegment = nullptr;
+  nsUInt64 m_uiSegmentSize = 0;
+  mutable nsMutex m_SegmentMutex; ///< Guards mapping and unmapping the segment against WakeWorker(), which runs on the threads calling Send().
+  nsSharedMemoryChannelThread* m_pWorker = nullptr;
+  nsAtomicBool m_bStopWorker;
+
+  nsUInt64 m_previousSendOffset = 0;
+};
+
+#endif
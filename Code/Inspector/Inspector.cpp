@@ -6,6 +6,7 @@
 #include <Inspector/FileWidget.moc.h>
 #include <Inspector/GlobalEventsWidget.moc.h>
 #include <Inspector/InputWidget.moc.h>
+#include <Inspector/JoltStepWidget.moc.h>
 #include <Inspector/LogDockWidget.moc.h>
 #include <Inspector/MainWidget.moc.h>
 #include <Inspector/MainWindow.moc.h>
@@ -100,6 +101,7 @@ public:
     nsTelemetry::AcceptMessagesForSystem('RFLC', true, nsQtReflectionWidget::ProcessTelemetry, nullptr);
     nsTelemetry::AcceptMessagesForSystem('TRAN', true, nsQtDataWidget::ProcessTelemetry, nullptr);
     nsTelemetry::AcceptMessagesForSystem('RESM', true, nsQtResourceWidget::ProcessTelemetry, nullptr);
+    nsTelemetry::AcceptMessagesForSystem('JOLT', true, nsQtJoltStepWidget::ProcessTelemetry, nullptr);
 
     QSettings Settings;
     const QString sServer = Settings.value("LastConnection", QLatin1String("localhost:1040")).toString();
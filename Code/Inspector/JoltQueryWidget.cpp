@@ -0,0 +1,355 @@
+#include <Inspector/InspectorPCH.h>
+
+#include <Foundation/Communication/Telemetry.h>
+#include <GuiFoundation/GuiFoundationDLL.h>
+#include <Inspector/JoltQueryWidget.moc.h>
+#include <Inspector/JoltStepWidget.moc.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHProtocol.h>
+
+nsQtJoltQueryWidget* nsQtJoltQueryWidget::s_pWidget = nullptr;
+
+// same order as JDebug::API::JPHQueryType
+static const char* s_szQueryTypeNames[nsQtJoltQueryWidget::s_uiNumQueryTypes] = {
+  "Cast Ray",
+  "Cast Ray (Collector)",
+  "Collide Point",
+  "Collide Shape",
+  "Cast Shape",
+  "Collect Shapes",
+  "BP Cast Ray",
+  "BP Collide AABox",
+  "BP Collide Sphere",
+  "BP Collide Point",
+  "BP Collide Box",
+  "BP Cast AABox",
+};
+
+// same order as JPH::EShapeSubType, the user types are shown by number
+static const char* s_szShapeSubTypeNames[] = {
+  "Sphere",
+  "Box",
+  "Triangle",
+  "Capsule",
+  "Tapered Capsule",
+  "Cylinder",
+  "Convex Hull",
+  "Static Compound",
+  "Mutable Compound",
+  "Rotated Translated",
+  "Scaled",
+  "Offset Center of Mass",
+  "Mesh",
+  "Height Field",
+  "Soft Body",
+};
+
+/// Sorts by a number instead of by the text.
+class nsQtJoltQueryNumberItem : public QTableWidgetItem
+{
+public:
+  nsQtJoltQueryNumberItem(double fValue, const char* szString)
+    : QTableWidgetItem(szString)
+  {
+    m_fValue = fValue;
+  }
+
+  bool operator<(const QTableWidgetItem& other) const { return m_fValue < ((nsQtJoltQueryNumberItem&)other).m_fValue; }
+
+  double m_fValue;
+};
+
+nsQtJoltQueryWidget::nsQtJoltQueryWidget(QWidget* pParent)
+  : ads::CDockWidget("Jolt Query Widget", pParent)
+{
+  s_pWidget = this;
+
+  setupUi(this);
+  setWidget(JoltQueryWidgetFrame);
+
+  setIcon(QIcon(":/Icons/Icons/LogoSmallJolt.svg"));
+
+  m_uiMaxRecords = 1000;
+
+  ResetStats();
+}
+
+void nsQtJoltQueryWidget::ResetStats()
+{
+  m_Records.Clear();
+  m_bRecordsChanged = true;
+  m_LastTableUpdate = nsTime::MakeFromSeconds(0);
+
+  m_uiLastStepIndex = 0;
+  m_uiNumDropped = 0;
+
+  for (nsUInt32 i = 0; i < s_uiNumQueryTypes; ++i)
+  {
+    m_QueryCounts[i] = 0;
+    m_QueryDurationsNs[i] = 0;
+  }
+
+  Table->clear();
+  Table->setRowCount(0);
+
+  {
+    QStringList Headers;
+    Headers.append(" Query ");
+    Headers.append(" Duration (µs) ");
+    Headers.append(" Candidates ");
+    Headers.append(" Filtered ");
+    Headers.append(" Hits ");
+    Headers.append(" Shape ");
+    Headers.append(" Recorded ");
+    Headers.append(" Step ");
+    Headers.append(" BP Layers ");
+    Headers.append(" Object Layers ");
+    Headers.append(" Position ");
+    Headers.append(" Tag ");
+
+    Table->setColumnCount(static_cast<int>(Headers.size()));
+    Table->setHorizontalHeaderLabels(Headers);
+    Table->horizontalHeader()->show();
+  }
+
+  Table->resizeColumnsToContents();
+  Table->sortByColumn(1, Qt::DescendingOrder);
+
+  LabelTotals->setText("");
+}
+
+void nsQtJoltQueryWidget::UpdateStats()
+{
+  if (!isVisible())
+    return;
+
+  SpinSampleInterval->setEnabled(nsTelemetry::IsConnectedToServer());
+  SpinSlowThreshold->setEnabled(nsTelemetry::IsConnectedToServer());
+
+  if (!m_bRecordsChanged || CheckPause->isChecked())
+    return;
+
+  if (nsTime::Now() - m_LastTableUpdate < nsTime::MakeFromSeconds(0.25))
+    return;
+
+  m_LastTableUpdate = nsTime::Now();
+  m_bRecordsChanged = false;
+
+  nsStringBuilder s;
+  s.SetFormat("Step: {0}, Dropped Records: {1}\n", m_uiLastStepIndex, m_uiNumDropped);
+
+  bool bFirst = true;
+  for (nsUInt32 i = 0; i < s_uiNumQueryTypes; ++i)
+  {
+    if (m_QueryCounts[i] == 0)
+      continue;
+
+    s.AppendFormat("{0}{1}: {2} ({3}ms)", bFirst ? "" : ", ", s_szQueryTypeNames[i], m_QueryCounts[i], nsArgF(m_QueryDurationsNs[i] / 1000000.0, 2));
+    bFirst = false;
+  }
+
+  LabelTotals->setText(s.GetData());
+
+  UpdateTable();
+}
+
+void nsQtJoltQueryWidget::UpdateTable()
+{
+  nsQtScopedUpdatesDisabled _1(Table);
+
+  Table->setSortingEnabled(false);
+  Table->setRowCount(static_cast<int>(m_Records.GetCount()));
+
+  nsStringBuilder sTemp;
+
+  for (nsUInt32 i = 0; i < m_Records.GetCount(); ++i)
+  {
+    const QueryRecord& record = m_Records[i];
+    const int iRow = static_cast<int>(i);
+
+    if (record.m_uiType < s_uiNumQueryTypes)
+      sTemp = s_szQueryTypeNames[record.m_uiType];
+    else
+      sTemp.SetFormat("Type {0}", record.m_uiType);
+
+    Table->setItem(iRow, 0, new QTableWidgetItem(sTemp.GetData()));
+
+    sTemp.SetFormat("{0}", nsArgF(record.m_uiDurationNs / 1000.0, 1));
+    Table->setItem(iRow, 1, new nsQtJoltQueryNumberItem(static_cast<double>(record.m_uiDurationNs), sTemp.GetData()));
+
+    sTemp.SetFormat("{0}", record.m_uiNumCandidates);
+    Table->setItem(iRow, 2, new nsQtJoltQueryNumberItem(record.m_uiNumCandidates, sTemp.GetData()));
+
+    sTemp.SetFormat("{0}", record.m_uiNumFiltered);
+    Table->setItem(iRow, 3, new nsQtJoltQueryNumberItem(record.m_uiNumFiltered, sTemp.GetData()));
+
+    sTemp.SetFormat("{0}", record.m_uiNumHits);
+    Table->setItem(iRow, 4, new nsQtJoltQueryNumberItem(record.m_uiNumHits, sTemp.GetData()));
+
+    // 0xFF is JDebug::API::JPHQueryRecord::s_uiNoShape
+    if (record.m_uiShapeSubType == 0xFF)
+      sTemp.Clear();
+    else if (record.m_uiShapeSubType < NS_ARRAY_SIZE(s_szShapeSubTypeNames))
+      sTemp = s_szShapeSubTypeNames[record.m_uiShapeSubType];
+    else
+      sTemp.SetFormat("Sub Type {0}", record.m_uiShapeSubType);
+
+    Table->setItem(iRow, 5, new QTableWidgetItem(sTemp.GetData()));
+
+    // same bits as JDebug::API::JPHQueryRecord::Flags
+    sTemp.Clear();
+    if ((record.m_uiFlags & NS_BIT(1)) != 0)
+      sTemp.Append("Slow");
+    if ((record.m_uiFlags & NS_BIT(0)) != 0)
+      sTemp.Append(sTemp.IsEmpty() ? "" : ", ", "Sampled");
+
+    Table->setItem(iRow, 6, new QTableWidgetItem(sTemp.GetData()));
+
+    sTemp.SetFormat("{0}", record.m_uiStepIndex);
+    Table->setItem(iRow, 7, new nsQtJoltQueryNumberItem(static_cast<double>(record.m_uiStepIndex), sTemp.GetData()));
+
+    sTemp.SetFormat("0x{0}", nsArgU(record.m_uiBroadPhaseLayerMask, 8, true, 16, true));
+    Table->setItem(iRow, 8, new QTableWidgetItem(sTemp.GetData()));
+
+    sTemp.SetFormat("0x{0}", nsArgU(record.m_uiObjectLayerMask, 16, true, 16, true));
+    Table->setItem(iRow, 9, new QTableWidgetItem(sTemp.GetData()));
+
+    sTemp.SetFormat("{0}, {1}, {2}", nsArgF(record.m_vPosition.x, 2), nsArgF(record.m_vPosition.y, 2), nsArgF(record.m_vPosition.z, 2));
+    QTableWidgetItem* pPositionItem = new QTableWidgetItem(sTemp.GetData());
+
+    sTemp.SetFormat("<p>Direction: {0}, {1}, {2}<br>Extents: {3}, {4}, {5}</p>", nsArgF(record.m_vDirection.x, 3), nsArgF(record.m_vDirection.y, 3),
+      nsArgF(record.m_vDirection.z, 3), nsArgF(record.m_vExtents.x, 3), nsArgF(record.m_vExtents.y, 3), nsArgF(record.m_vExtents.z, 3));
+    pPositionItem->setToolTip(sTemp.GetData());
+
+    Table->setItem(iRow, 10, pPositionItem);
+    Table->setItem(iRow, 11, new QTableWidgetItem(record.m_sTag.GetData()));
+  }
+
+  Table->setSortingEnabled(true);
+}
+
+nsResult nsQtJoltQueryWidget::ReadMessage(const nsUInt8* pData, nsUInt32 uiSize)
+{
+  // u64 step index, then the layout of JDebug::API::JPHQueryRecorder::WriteRecords()
+  JDebug::API::IO::JPHByteReader reader(nsArrayPtr<const nsUInt8>(pData, uiSize));
+  nsUInt64 uiValue = 0;
+
+  nsUInt64 uiStepIndex = 0;
+  reader.Read(uiStepIndex);
+
+  // a new session or a reconnect starts counting from zero again
+  if (uiStepIndex < m_uiLastStepIndex)
+    ResetStats();
+
+  m_uiLastStepIndex = uiStepIndex;
+
+  nsUInt8 uiNumTypes = 0;
+  reader.Read(uiNumTypes);
+
+  for (nsUInt32 i = 0; i < uiNumTypes && !reader.HasFailed(); ++i)
+  {
+    nsUInt64 uiNumQueries = 0;
+    nsUInt64 uiDurationNs = 0;
+    reader.ReadVarUInt(uiNumQueries);
+    reader.ReadVarUInt(uiDurationNs);
+
+    if (i < s_uiNumQueryTypes)
+    {
+      m_QueryCounts[i] += uiNumQueries;
+      m_QueryDurationsNs[i] += uiDurationNs;
+    }
+  }
+
+  reader.ReadVarUInt(uiValue);
+  m_uiNumDropped += uiValue;
+
+  nsUInt64 uiNumRecords = 0;
+  reader.ReadVarUInt(uiNumRecords);
+
+  for (nsUInt64 i = 0; i < uiNumRecords && !reader.HasFailed(); ++i)
+  {
+    QueryRecord record;
+    record.m_uiStepIndex = uiStepIndex;
+    reader.Read(record.m_uiType);
+    reader.Read(record.m_uiFlags);
+    reader.Read(record.m_uiShapeSubType);
+    reader.ReadVarUInt(record.m_uiDurationNs);
+
+    reader.ReadVarUInt(uiValue);
+    record.m_uiNumCandidates = static_cast<nsUInt32>(uiValue);
+    reader.ReadVarUInt(uiValue);
+    record.m_uiNumFiltered = static_cast<nsUInt32>(uiValue);
+    reader.ReadVarUInt(uiValue);
+    record.m_uiNumHits = static_cast<nsUInt32>(uiValue);
+
+    reader.Read(record.m_uiBroadPhaseLayerMask);
+    reader.Read(record.m_uiObjectLayerMask);
+    reader.Read(record.m_vPosition);
+    reader.Read(record.m_vDirection);
+    reader.Read(record.m_vExtents);
+
+    nsUInt64 uiTagLength = 0;
+    reader.ReadVarUInt(uiTagLength);
+
+    const nsUInt32 uiTagOffset = reader.GetOffset();
+    if (uiTagLength > uiSize || !reader.Skip(static_cast<nsUInt32>(uiTagLength)))
+      break;
+
+    record.m_sTag = nsStringView(reinterpret_cast<const char*>(pData + uiTagOffset), static_cast<nsUInt32>(uiTagLength));
+
+    m_Records.PushBack(record);
+  }
+
+  if (m_Records.GetCount() > m_uiMaxRecords)
+    m_Records.PopFront(m_Records.GetCount() - m_uiMaxRecords);
+
+  m_bRecordsChanged = true;
+
+  return reader.HasFailed() ? NS_FAILURE : NS_SUCCESS;
+}
+
+void nsQtJoltQueryWidget::ProcessMessage(const nsUInt8* pData, nsUInt32 uiSize)
+{
+  if (s_pWidget == nullptr)
+    return;
+
+  s_pWidget->ReadMessage(pData, uiSize).IgnoreResult();
+}
+
+void nsQtJoltQueryWidget::SendSettings()
+{
+  if (!nsTelemetry::IsConnectedToServer())
+    return;
+
+  nsDynamicArray<nsUInt8> data;
+  JDebug::API::IO::JPHByteWriter writer(data);
+  writer.Write(static_cast<nsUInt32>(SpinSampleInterval->value()));
+  writer.Write(static_cast<nsUInt64>(SpinSlowThreshold->value() * 1000.0));
+
+  // goes to the physics system the step widget shows
+  nsQtJoltStepWidget::SendToServer(JDebug::API::Protocol::s_uiMsgQuerySettings, data);
+}
+
+void nsQtJoltQueryWidget::on_SpinSampleInterval_editingFinished()
+{
+  SendSettings();
+}
+
+void nsQtJoltQueryWidget::on_SpinSlowThreshold_editingFinished()
+{
+  SendSettings();
+}
+
+void nsQtJoltQueryWidget::on_CheckPause_toggled(bool checked)
+{
+  m_bRecordsChanged = true;
+}
+
+void nsQtJoltQueryWidget::on_ButtonClear_clicked()
+{
+  const nsUInt64 uiLastStepIndex = m_uiLastStepIndex;
+
+  ResetStats();
+
+  m_uiLastStepIndex = uiLastStepIndex;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Foundation/Basics.h>
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Math/Vec3.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Time/Time.h>
+#include <Inspector/ui_JoltQueryWidget.h>
+#include <ads/DockWidget.h>
+
+class nsQtJoltQueryWidget : public ads::CDockWidget, public Ui_JoltQueryWidget
+{
+public:
+  Q_OBJECT
+
+public:
+  /// Matches JDebug::API::JPHQueryType::ENUM_COUNT, types a newer server sends are shown by number.
+  static const nsUInt8 s_uiNumQueryTypes = 12;
+
+  nsQtJoltQueryWidget(QWidget* pParent = 0);
+
+  static nsQtJoltQueryWidget* s_pWidget;
+
+private Q_SLOTS:
+
+  void on_SpinSampleInterval_editingFinished();
+  void on_SpinSlowThreshold_editingFinished();
+  void on_CheckPause_toggled(bool checked);
+  void on_ButtonClear_clicked();
+
+public:
+  /// Called by nsQtJoltStepWidget::ProcessTelemetry() for Protocol::s_uiMsgQueries, which owns the 'JOLT' messages.
+  static void ProcessMessage(const nsUInt8* pData, nsUInt32 uiSize);
+
+  void ResetStats();
+  void UpdateStats();
+
+private:
+  /// The part of JDebug::API::JPHQueryRecord the widget shows.
+  struct QueryRecord
+  {
+    nsUInt64 m_uiStepIndex = 0;
+    nsUInt8 m_uiType = 0;
+    nsUInt8 m_uiFlags = 0;
+    nsUInt8 m_uiShapeSubType = 0;
+    nsUInt64 m_uiDurationNs = 0;
+    nsUInt32 m_uiNumCandidates = 0;
+    nsUInt32 m_uiNumFiltered = 0;
+    nsUInt32 m_uiNumHits = 0;
+    nsUInt32 m_uiBroadPhaseLayerMask = 0;
+    nsUInt64 m_uiObjectLayerMask = 0;
+    nsVec3 m_vPosition = nsVec3::MakeZero();
+    nsVec3 m_vDirection = nsVec3::MakeZero();
+    nsVec3 m_vExtents = nsVec3::MakeZero();
+    nsString m_sTag;
+  };
+
+  nsResult ReadMessage(const nsUInt8* pData, nsUInt32 uiSize);
+  void SendSettings();
+  void UpdateTable();
+
+  nsUInt32 m_uiMaxRecords;
+  bool m_bRecordsChanged;
+  nsTime m_LastTableUpdate;
+
+  nsUInt64 m_uiLastStepIndex;
+  nsUInt64 m_QueryCounts[s_uiNumQueryTypes];
+  nsUInt64 m_QueryDurationsNs[s_uiNumQueryTypes];
+  nsUInt64 m_uiNumDropped;
+
+  nsDeque<QueryRecord> m_Records;
+};
@@ -0,0 +1,495 @@
+#include <Inspector/InspectorPCH.h>
+
+#include <Foundation/Communication/Telemetry.h>
+#include <GuiFoundation/GuiFoundationDLL.h>
+#include <Inspector/JoltQueryWidget.moc.h>
+#include <Inspector/JoltStepWidget.moc.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHProtocol.h>
+#include <QGraphicsPathItem>
+#include <QGraphicsView>
+#include <QSignalBlocker>
+
+nsQtJoltStepWidget* nsQtJoltStepWidget::s_pWidget = nullptr;
+
+static QColor s_PhaseColors[nsQtJoltStepWidget::s_uiNumPhases + 1] = {
+  QColor(255, 106, 0),   // orange
+  QColor(182, 255, 0),   // lime green
+  QColor(255, 0, 255),   // pink
+  QColor(0, 148, 255),   // light blue
+  QColor(255, 0, 0),     // red
+  QColor(0, 255, 255),   // turquoise
+  QColor(178, 0, 255),   // purple
+  QColor(0, 38, 255),    // dark blue
+  QColor(72, 0, 255),    // lilac
+  QColor(255, 216, 0),   // yellow
+  QColor(255, 255, 255), // white
+};
+
+// same order as JDebug::API::JPHStepPhase
+static const char* s_szPhaseNames[nsQtJoltStepWidget::s_uiNumPhases + 1] = {
+  "Broad Phase",
+  "Narrow Phase",
+  "Constraints",
+  "Islands",
+  "Solve Velocity",
+  "Integrate",
+  "CCD",
+  "Solve Position",
+  "Soft Bodies",
+  "Listeners",
+  "Step",
+};
+
+nsQtJoltStepWidget::nsQtJoltStepWidget(QWidget* pParent)
+  : ads::CDockWidget("Jolt Step Widget", pParent)
+{
+  s_pWidget = this;
+
+  m_uiDisplaySteps = 600;
+  m_bSamplesChanged = true;
+  m_uiStreamID = 0;
+
+  for (nsUInt32 i = 0; i <= s_uiNumPhases; ++i)
+    m_bDisplay[i] = true;
+
+  setupUi(this);
+  setWidget(JoltStepWidgetFrame);
+
+  setIcon(QIcon(":/Icons/Icons/LogoSmallJolt.svg"));
+
+  {
+    nsQtScopedUpdatesDisabled _1(ComboTimeframe);
+
+    ComboTimeframe->addItem("Timeframe: 300 steps");
+    ComboTimeframe->addItem("Timeframe: 600 steps");
+    ComboTimeframe->addItem("Timeframe: 1800 steps");
+    ComboTimeframe->addItem("Timeframe: 3600 steps");
+    ComboTimeframe->addItem("Timeframe: 18000 steps");
+    ComboTimeframe->setCurrentIndex(1);
+  }
+
+  {
+    nsQtScopedUpdatesDisabled _1(ListPhases);
+
+    for (nsUInt32 i = 0; i <= s_uiNumPhases; ++i)
+    {
+      ListPhases->addItem(s_szPhaseNames[i]);
+
+      QListWidgetItem* pItem = ListPhases->item(ListPhases->count() - 1);
+      pItem->setFlags(Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsUserCheckable);
+      pItem->setData(Qt::UserRole, i);
+      pItem->setCheckState(Qt::Checked);
+      pItem->setForeground(s_PhaseColors[i]);
+    }
+  }
+
+  m_pPathMax = m_Scene.addPath(QPainterPath(), QPen(QBrush(QColor(64, 64, 64)), 0));
+
+  for (nsUInt32 i = 0; i <= s_uiNumPhases; ++i)
+    m_pPath[i] = m_Scene.addPath(QPainterPath(), QPen(QBrush(s_PhaseColors[i]), 0));
+
+  QTransform t = StepView->transform();
+  t.scale(1, -1);
+  StepView->setTransform(t);
+
+  StepView->setScene(&m_Scene);
+
+  StepView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  StepView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+  StepView->setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
+
+  // only shown for a server with a JPHDebuggerHub
+  ComboStream->setVisible(false);
+
+  ResetStats();
+}
+
+void nsQtJoltStepWidget::ResetStats()
+{
+  m_Samples.Clear();
+
+  m_uiMaxSamples = 18000;
+  m_bSamplesChanged = true;
+
+  LabelStep->setText("Step:");
+  LabelCounters->setText("");
+}
+
+void nsQtJoltStepWidget::UpdateStats()
+{
+  if (!isVisible())
+    return;
+
+  if (!nsTelemetry::IsConnectedToServer())
+  {
+    ListPhases->setEnabled(false);
+    return;
+  }
+
+  ListPhases->setEnabled(true);
+
+  if (!m_bSamplesChanged)
+    return;
+
+  m_bSamplesChanged = false;
+
+  QPainterPath pp[s_uiNumPhases + 1];
+
+  nsTime tMax;
+
+  if (!m_Samples.IsEmpty())
+  {
+    // samples may be missing, the messages are sent unreliably, so the x axis is the step index and not the sample index
+    const nsUInt64 uiLastStep = m_Samples.PeekBack().m_uiStepIndex;
+
+    nsUInt32 uiFirstSample = 0;
+
+    while ((uiFirstSample < m_Samples.GetCount()) && (uiLastStep - m_Samples[uiFirstSample].m_uiStepIndex > m_uiDisplaySteps))
+      ++uiFirstSample;
+
+    for (nsUInt32 i = uiFirstSample; i < m_Samples.GetCount(); ++i)
+    {
+      const StepSample& sample = m_Samples[i];
+      const double fX = -static_cast<double>(uiLastStep - sample.m_uiStepIndex);
+
+      for (nsUInt32 uiPath = 0; uiPath <= s_uiNumPhases; ++uiPath)
+      {
+        if (!m_bDisplay[uiPath])
+          continue;
+
+        const nsTime time = uiPath < s_uiNumPhases ? sample.m_PhaseTime[uiPath] : sample.m_StepTime;
+
+        if (i == uiFirstSample)
+          pp[uiPath].moveTo(QPointF(fX, time.GetSeconds()));
+        else
+          pp[uiPath].lineTo(QPointF(fX, time.GetSeconds()));
+
+        tMax = nsMath::Max(tMax, time);
+      }
+    }
+  }
+
+  for (nsUInt32 i = 0; i <= s_uiNumPhases; ++i)
+    m_pPath[i]->setPath(pp[i]);
+
+  // render the helper lines for time values
+  {
+    QPainterPath pMax;
+
+    for (nsUInt32 i = 1; i < 10; ++i)
+    {
+      pMax.moveTo(QPointF(-static_cast<double>(m_uiDisplaySteps), nsTime::MakeFromMilliseconds(2.0 * i).GetSeconds()));
+      pMax.lineTo(QPointF(0, nsTime::MakeFromMilliseconds(2.0 * i).GetSeconds()));
+    }
+
+    m_pPathMax->setPath(pMax);
+  }
+
+  nsTime tShowMax = nsTime::MakeFromMilliseconds(20);
+
+  for (nsUInt32 t = 2; t < 20; t += 2)
+  {
+    tShowMax = nsTime::MakeFromMilliseconds(1) * t;
+
+    if (tMax < tShowMax)
+      break;
+  }
+
+  {
+    StepView->setSceneRect(QRectF(-static_cast<double>(m_uiDisplaySteps), 0, m_uiDisplaySteps, tShowMax.GetSeconds()));
+    StepView->fitInView(QRectF(-static_cast<double>(m_uiDisplaySteps), 0, m_uiDisplaySteps, tShowMax.GetSeconds()));
+  }
+
+  // the counters change every step, updating the labels more often than a few times a second is only noise
+  if (nsTime::Now() - m_LastUpdatedLabels > nsTime::MakeFromMilliseconds(250) && !m_Samples.IsEmpty())
+  {
+    m_LastUpdatedLabels = nsTime::Now();
+
+    const StepSample& last = m_Samples.PeekBack();
+
+    nsStringBuilder s;
+    s.SetFormat("Max: {0}ms", nsArgF(tShowMax.GetMilliseconds(), 0));
+    LabelMaxTime->setText(s.GetData());
+
+    s.SetFormat("Step: {0} ({1}ms)", last.m_uiStepIndex, nsArgF(last.m_StepTime.GetMilliseconds(), 2));
+    LabelStep->setText(s.GetData());
+
+    s.SetFormat("Bodies: {0}, Active: {1}, Active Soft Bodies: {2}, Islands: {3}, Largest Island: {4}, Body Pairs: {5}, Contact Constraints: {6}, CCD Bodies: {7}, "
+                "Velocity Steps: {8}, Position Steps: {9}",
+      last.m_uiNumBodies, last.m_uiNumActiveBodies, last.m_uiNumActiveSoftBodies, last.m_uiNumIslands, last.m_uiLargestIsland, last.m_uiNumBodyPairs,
+      last.m_uiNumContactConstraints, last.m_uiNumCCDBodies, last.m_uiNumVelocitySteps, last.m_uiNumPositionSteps);
+
+    s.Append("\nIsland Sizes:");
+
+    for (nsUInt32 i = 0; i < s_uiNumIslandBuckets; ++i)
+    {
+      if (i + 1 < s_uiNumIslandBuckets)
+        s.AppendFormat(" [{0}-{1}]: {2}", 1u << i, (2u << i) - 1, last.m_IslandSizes[i]);
+      else
+        s.AppendFormat(" [{0}+]: {1}", 1u << i, last.m_IslandSizes[i]);
+    }
+
+    LabelCounters->setText(s.GetData());
+
+    for (nsUInt32 i = 0; i < s_uiNumPhases; ++i)
+    {
+      nsStringBuilder sTooltip;
+      sTooltip.SetFormat("<p>Phase: {0}<br>Last Step: <b>{1}ms</b><br></p>", s_szPhaseNames[i], nsArgF(last.m_PhaseTime[i].GetMilliseconds(), 3));
+
+      ListPhases->item(i)->setToolTip(sTooltip.GetData());
+    }
+  }
+}
+
+nsResult nsQtJoltStepWidget::ReadSample(const nsUInt8* pData, nsUInt32 uiSize, StepSample& out_sample)
+{
+  // the layout is documented at JDebug::API::JPHStepStatistics::Write()
+  JDebug::API::IO::JPHByteReader reader(nsArrayPtr<const nsUInt8>(pData, uiSize));
+  nsUInt64 uiValue = 0;
+
+  auto ReadCount = [&](nsUInt32& out_uiCount)
+  {
+    reader.ReadVarUInt(uiValue);
+    out_uiCount = static_cast<nsUInt32>(uiValue);
+  };
+
+  auto ReadTime = [&](nsTime& out_time)
+  {
+    reader.ReadVarUInt(uiValue);
+    out_time = nsTime::MakeFromNanoseconds(static_cast<double>(uiValue));
+  };
+
+  reader.Read(out_sample.m_uiStepIndex);
+
+  nsUInt8 uiNumPhases = 0;
+  reader.Read(uiNumPhases);
+
+  for (nsUInt32 i = 0; i < uiNumPhases && !reader.HasFailed(); ++i)
+  {
+    nsTime cpuTime, wallTime;
+    nsUInt32 uiNumJobs = 0;
+    ReadTime(cpuTime);
+    ReadTime(wallTime);
+    ReadCount(uiNumJobs);
+
+    if (i < s_uiNumPhases)
+      out_sample.m_PhaseTime[i] = wallTime;
+  }
+
+  ReadTime(out_sample.m_StepTime);
+  ReadCount(out_sample.m_uiNumBodies);
+  ReadCount(out_sample.m_uiNumActiveBodies);
+  ReadCount(out_sample.m_uiNumActiveSoftBodies);
+  ReadCount(out_sample.m_uiNumIslands);
+  ReadCount(out_sample.m_uiLargestIsland);
+
+  nsUInt8 uiNumBuckets = 0;
+  reader.Read(uiNumBuckets);
+
+  for (nsUInt32 i = 0; i < uiNumBuckets && !reader.HasFailed(); ++i)
+  {
+    nsUInt32 uiCount = 0;
+    ReadCount(uiCount);
+    out_sample.m_IslandSizes[nsMath::Min<nsUInt32>(i, s_uiNumIslandBuckets - 1)] += uiCount;
+  }
+
+  ReadCount(out_sample.m_uiNumBodyPairs);
+  ReadCount(out_sample.m_uiNumContactConstraints);
+  ReadCount(out_sample.m_uiNumCCDBodies);
+  ReadCount(out_sample.m_uiNumVelocitySteps);
+  ReadCount(out_sample.m_uiNumPositionSteps);
+
+  return reader.HasFailed() ? NS_FAILURE : NS_SUCCESS;
+}
+
+void nsQtJoltStepWidget::ReadStreamList(const nsUInt8* pData, nsUInt32 uiSize)
+{
+  // the layout is documented at JDebug::API::Protocol::s_uiMsgStreamList
+  JDebug::API::IO::JPHByteReader reader(nsArrayPtr<const nsUInt8>(pData, uiSize));
+
+  nsUInt32 uiNumStreams = 0;
+  if (!reader.Read(uiNumStreams) || uiNumStreams > uiSize / (2 * sizeof(nsUInt32)))
+    return;
+
+  nsUInt32 uiSelectedStreamID = 0;
+
+  {
+    QSignalBlocker blocker(ComboStream);
+    ComboStream->clear();
+
+    nsDynamicArray<char> name;
+    nsStringBuilder sEntry;
+
+    for (nsUInt32 i = 0; i < uiNumStreams; ++i)
+    {
+      nsUInt32 uiStreamID = 0;
+      nsUInt32 uiNameLength = 0;
+      if (!reader.Read(uiStreamID) || !reader.Read(uiNameLength) || uiNameLength > uiSize)
+        break;
+
+      name.SetCountUninitialized(uiNameLength);
+      if (!reader.ReadBytes(name.GetData(), uiNameLength))
+        break;
+
+      sEntry.SetFormat("{0}: {1}", uiStreamID, nsStringView(name.GetData(), name.GetData() + name.GetCount()));
+      ComboStream->addItem(sEntry.GetData(), uiStreamID);
+
+      // keep showing the same system if it is still there, otherwise the first one
+      if (uiSelectedStreamID == 0 || uiStreamID == m_uiStreamID)
+      {
+        uiSelectedStreamID = uiStreamID;
+        ComboStream->setCurrentIndex(ComboStream->count() - 1);
+      }
+    }
+  }
+
+  ComboStream->setVisible(ComboStream->count() > 0);
+
+  SelectStream(uiSelectedStreamID);
+}
+
+void nsQtJoltStepWidget::SelectStream(nsUInt32 uiStreamID)
+{
+  if (uiStreamID != m_uiStreamID)
+  {
+    m_uiStreamID = uiStreamID;
+    ResetStats();
+
+    if (nsQtJoltQueryWidget::s_pWidget != nullptr)
+      nsQtJoltQueryWidget::s_pWidget->ResetStats();
+  }
+
+  if (!nsTelemetry::IsConnectedToServer())
+    return;
+
+  // the hub streams every system to a new connection, until it is told otherwise
+  nsTelemetryMessage msg;
+  msg.SetMessageID(JDebug::API::Protocol::s_uiSystemID, JDebug::API::Protocol::s_uiMsgSubscribe);
+  msg.GetWriter() << static_cast<nsUInt32>(m_uiStreamID != 0 ? 1 : 0);
+
+  if (m_uiStreamID != 0)
+    msg.GetWriter() << m_uiStreamID;
+
+  nsTelemetry::SendToServer(msg);
+}
+
+void nsQtJoltStepWidget::SendToServer(nsUInt32 uiMessageID, nsArrayPtr<const nsUInt8> data)
+{
+  if (!nsTelemetry::IsConnectedToServer())
+    return;
+
+  nsTelemetryMessage msg;
+
+  if (s_pWidget != nullptr && s_pWidget->m_uiStreamID != 0)
+  {
+    msg.SetMessageID(JDebug::API::Protocol::s_uiSystemID, JDebug::API::Protocol::s_uiMsgStream);
+    msg.GetWriter() << s_pWidget->m_uiStreamID;
+    msg.GetWriter() << uiMessageID;
+  }
+  else
+  {
+    msg.SetMessageID(JDebug::API::Protocol::s_uiSystemID, uiMessageID);
+  }
+
+  msg.GetWriter().WriteBytes(data.GetPtr(), data.GetCount()).IgnoreResult();
+  nsTelemetry::SendToServer(msg);
+}
+
+void nsQtJoltStepWidget::ProcessTelemetry(void* pUnuseed)
+{
+  if (s_pWidget == nullptr)
+    return;
+
+  nsTelemetryMessage Msg;
+  nsDynamicArray<nsUInt8> data;
+
+  // all Jolt debugger messages arrive here, the frames themselves are not shown by the Inspector
+  while (nsTelemetry::RetrieveMessage(JDebug::API::Protocol::s_uiSystemID, Msg) == NS_SUCCESS)
+  {
+    nsUInt32 uiMessageID = Msg.GetMessageID();
+
+    if (uiMessageID == JDebug::API::Protocol::s_uiMsgStream)
+    {
+      // a JPHDebuggerHub tags the messages with their physics system, only the selected one is shown
+      nsUInt32 uiStreamID = 0;
+      Msg.GetReader() >> uiStreamID;
+      Msg.GetReader() >> uiMessageID;
+
+      if (uiStreamID != s_pWidget->m_uiStreamID)
+        continue;
+    }
+    else if (s_pWidget->m_uiStreamID != 0 && uiMessageID != JDebug::API::Protocol::s_uiMsgStreamList)
+    {
+      // untagged messages come from a server without a hub, e.g. after connecting to another one
+      s_pWidget->m_uiStreamID = 0;
+      s_pWidget->ComboStream->clear();
+      s_pWidget->ComboStream->setVisible(false);
+    }
+
+    if (uiMessageID != JDebug::API::Protocol::s_uiMsgStepStatistics && uiMessageID != JDebug::API::Protocol::s_uiMsgQueries &&
+        uiMessageID != JDebug::API::Protocol::s_uiMsgStreamList)
+      continue;
+
+    // the message does not know its size, read it in chunks
+    data.Clear();
+    nsUInt8 chunk[256];
+
+    while (const nsUInt64 uiRead = Msg.GetReader().ReadBytes(chunk, sizeof(chunk)))
+      data.PushBackRange(nsArrayPtr<const nsUInt8>(chunk, static_cast<nsUInt32>(uiRead)));
+
+    if (uiMessageID == JDebug::API::Protocol::s_uiMsgStreamList)
+    {
+      s_pWidget->ReadStreamList(data.GetData(), data.GetCount());
+      continue;
+    }
+
+    if (uiMessageID == JDebug::API::Protocol::s_uiMsgQueries)
+    {
+      nsQtJoltQueryWidget::ProcessMessage(data.GetData(), data.GetCount());
+      continue;
+    }
+
+    StepSample sample;
+    if (ReadSample(data.GetData(), data.GetCount(), sample).Failed())
+      continue;
+
+    // a new session or a reconnect starts counting from zero again
+    if (!s_pWidget->m_Samples.IsEmpty() && sample.m_uiStepIndex <= s_pWidget->m_Samples.PeekBack().m_uiStepIndex)
+      s_pWidget->m_Samples.Clear();
+
+    s_pWidget->m_Samples.PushBack(sample);
+    s_pWidget->m_bSamplesChanged = true;
+
+    if (s_pWidget->m_Samples.GetCount() > s_pWidget->m_uiMaxSamples)
+      s_pWidget->m_Samples.PopFront(s_pWidget->m_Samples.GetCount() - s_pWidget->m_uiMaxSamples);
+  }
+}
+
+void nsQtJoltStepWidget::on_ListPhases_itemChanged(QListWidgetItem* item)
+{
+  m_bDisplay[item->data(Qt::UserRole).toUInt()] = (item->checkState() == Qt::Checked);
+  m_bSamplesChanged = true;
+}
+
+void nsQtJoltStepWidget::on_ComboTimeframe_currentIndexChanged(int index)
+{
+  const nsUInt32 uiSteps[] = {
+    300,
+    600,
+    1800,
+    3600,
+    18000,
+  };
+
+  m_uiDisplaySteps = uiSteps[index];
+  m_bSamplesChanged = true;
+}
+
+void nsQtJoltStepWidget::on_ComboStream_currentIndexChanged(int index)
+{
+  if (index < 0)
+    return;
+
+  SelectStream(ComboStream->itemData(index).toUInt());
+}
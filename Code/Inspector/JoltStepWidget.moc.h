@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Foundation/Basics.h>
+#include <Foundation/Containers/Deque.h>
+#include <Foundation/Time/Time.h>
+#include <Inspector/ui_JoltStepWidget.h>
+#include <QGraphicsView>
+#include <QListWidgetItem>
+#include <ads/DockWidget.h>
+
+class nsQtJoltStepWidget : public ads::CDockWidget, public Ui_JoltStepWidget
+{
+public:
+  Q_OBJECT
+
+public:
+  /// Matches JDebug::API::JPHStepPhase::ENUM_COUNT, phases a newer server sends are ignored.
+  static const nsUInt8 s_uiNumPhases = 10;
+  static const nsUInt8 s_uiNumIslandBuckets = 8;
+
+  nsQtJoltStepWidget(QWidget* pParent = 0);
+
+  static nsQtJoltStepWidget* s_pWidget;
+
+private Q_SLOTS:
+
+  void on_ListPhases_itemChanged(QListWidgetItem* item);
+  void on_ComboTimeframe_currentIndexChanged(int index);
+  void on_ComboStream_currentIndexChanged(int index);
+
+public:
+  static void ProcessTelemetry(void* pUnuseed);
+
+  /// Sends a 'JOLT' message to the server, wrapped in Protocol::s_uiMsgStream for the selected physics system if the server uses a JPHDebuggerHub.
+  static void SendToServer(nsUInt32 uiMessageID, nsArrayPtr<const nsUInt8> data);
+
+  void ResetStats();
+  void UpdateStats();
+
+private:
+  /// The part of JDebug::API::JPHStepStatistics the widget shows.
+  struct StepSample
+  {
+    nsUInt64 m_uiStepIndex = 0;
+    nsTime m_StepTime;
+    nsTime m_PhaseTime[s_uiNumPhases];
+    nsUInt32 m_uiNumBodies = 0;
+    nsUInt32 m_uiNumActiveBodies = 0;
+    nsUInt32 m_uiNumActiveSoftBodies = 0;
+    nsUInt32 m_uiNumIslands = 0;
+    nsUInt32 m_uiLargestIsland = 0;
+    nsUInt32 m_IslandSizes[s_uiNumIslandBuckets] = {};
+    nsUInt32 m_uiNumBodyPairs = 0;
+    nsUInt32 m_uiNumContactConstraints = 0;
+    nsUInt32 m_uiNumCCDBodies = 0;
+    nsUInt32 m_uiNumVelocitySteps = 0;
+    nsUInt32 m_uiNumPositionSteps = 0;
+  };
+
+  static nsResult ReadSample(const nsUInt8* pData, nsUInt32 uiSize, StepSample& out_sample);
+
+  void ReadStreamList(const nsUInt8* pData, nsUInt32 uiSize);
+  void SelectStream(nsUInt32 uiStreamID);
+
+  QGraphicsPathItem* m_pPath[s_uiNumPhases + 1]; ///< One path per phase, the last one is the whole step.
+  QGraphicsPathItem* m_pPathMax;
+  QGraphicsScene m_Scene;
+
+  bool m_bDisplay[s_uiNumPhases + 1];
+  nsUInt32 m_uiMaxSamples;
+  nsUInt32 m_uiDisplaySteps;
+  bool m_bSamplesChanged;
+  nsTime m_LastUpdatedLabels;
+
+  nsDeque<StepSample> m_Samples;
+
+  nsUInt32 m_uiStreamID; ///< The physics system of a JPHDebuggerHub that is shown, 0 if the server does not use a hub.
+};
@@ -5,6 +5,8 @@
 #include <Inspector/FileWidget.moc.h>
 #include <Inspector/GlobalEventsWidget.moc.h>
 #include <Inspector/InputWidget.moc.h>
+#include <Inspector/JoltQueryWidget.moc.h>
+#include <Inspector/JoltStepWidget.moc.h>
 #include <Inspector/LogDockWidget.moc.h>
 #include <Inspector/MainWidget.moc.h>
 #include <Inspector/MainWindow.moc.h>
@@ -49,6 +51,8 @@ nsQtMainWindow::nsQtMainWindow()
   nsQtLogDockWidget* pLogWidget = new nsQtLogDockWidget();
   nsQtMemoryWidget* pMemoryWidget = new nsQtMemoryWidget();
   nsQtTimeWidget* pTimeWidget = new nsQtTimeWidget();
+  nsQtJoltStepWidget* pJoltStepWidget = new nsQtJoltStepWidget();
+  nsQtJoltQueryWidget* pJoltQueryWidget = new nsQtJoltQueryWidget();
   nsQtInputWidget* pInputWidget = new nsQtInputWidget();
   //nsQtCVarsWidget* pCVarsWidget = new nsQtCVarsWidget();
   nsQtSubsystemsWidget* pSubsystemsWidget = new nsQtSubsystemsWidget();
@@ -62,6 +66,8 @@ nsQtMainWindow::nsQtMainWindow()
   NS_VERIFY(nullptr != QWidget::connect(pMainWidget, &ads::CDockWidget::viewToggled, this, &nsQtMainWindow::DockWidgetVisibilityChanged), "");
   NS_VERIFY(nullptr != QWidget::connect(pLogWidget, &ads::CDockWidget::viewToggled, this, &nsQtMainWindow::DockWidgetVisibilityChanged), "");
   NS_VERIFY(nullptr != QWidget::connect(pTimeWidget, &ads::CDockWidget::viewToggled, this, &nsQtMainWindow::DockWidgetVisibilityChanged), "");
+  NS_VERIFY(nullptr != QWidget::connect(pJoltStepWidget, &ads::CDockWidget::viewToggled, this, &nsQtMainWindow::DockWidgetVisibilityChanged), "");
+  NS_VERIFY(nullptr != QWidget::connect(pJoltQueryWidget, &ads::CDockWidget::viewToggled, this, &nsQtMainWindow::DockWidgetVisibilityChanged), "");
   NS_VERIFY(nullptr != QWidget::connect(pMemoryWidget, &ads::CDockWidget::viewToggled, this, &nsQtMainWindow::DockWidgetVisibilityChanged), "");
   NS_VERIFY(nullptr != QWidget::connect(pInputWidget, &ads::CDockWidget::viewToggled, this, &nsQtMainWindow::DockWidgetVisibilityChanged), "");
   NS_VERIFY(nullptr != QWidget::connect(pReflectionWidget, &ads::CDockWidget::viewToggled, this, &nsQtMainWindow::DockWidgetVisibilityChanged), "");
@@ -119,6 +125,8 @@ nsQtMainWindow::nsQtMainWindow()
   m_DockManager->addDockWidget(ads::BottomDockWidgetArea, pFileWidget);
   m_DockManager->addDockWidgetTab(ads::BottomDockWidgetArea, pMemoryWidget);
   m_DockManager->addDockWidgetTab(ads::BottomDockWidgetArea, pTimeWidget);
+  m_DockManager->addDockWidgetTab(ads::BottomDockWidgetArea, pJoltStepWidget);
+  m_DockManager->addDockWidgetTab(ads::BottomDockWidgetArea, pJoltQueryWidget);
 
 
   pLogWidget->raise();
@@ -258,6 +266,8 @@ void nsQtMainWindow::UpdateNetwork()
     nsQtLogDockWidget::s_pWidget->ResetStats();
     nsQtMemoryWidget::s_pWidget->ResetStats();
     nsQtTimeWidget::s_pWidget->ResetStats();
+    nsQtJoltStepWidget::s_pWidget->ResetStats();
+    nsQtJoltQueryWidget::s_pWidget->ResetStats();
     nsQtInputWidget::s_pWidget->ResetStats();
     nsQtReflectionWidget::s_pWidget->ResetStats();
     nsQtFileWidget::s_pWidget->ResetStats();
@@ -275,6 +285,8 @@ void nsQtMainWindow::UpdateNetwork()
   nsQtSubsystemsWidget::s_pWidget->UpdateStats();
   nsQtMemoryWidget::s_pWidget->UpdateStats();
   nsQtTimeWidget::s_pWidget->UpdateStats();
+  nsQtJoltStepWidget::s_pWidget->UpdateStats();
+  nsQtJoltQueryWidget::s_pWidget->UpdateStats();
   nsQtFileWidget::s_pWidget->UpdateStats();
   nsQtResourceWidget::s_pWidget->UpdateStats();
   // nsQtDataWidget::s_pWidget->UpdateStats();
@@ -292,6 +304,8 @@ void nsQtMainWindow::DockWidgetVisibilityChanged(bool bVisible)
   ActionShowWindowLog->setChecked(!nsQtLogDockWidget::s_pWidget->isClosed());
   ActionShowWindowMemory->setChecked(!nsQtMemoryWidget::s_pWidget->isClosed());
   ActionShowWindowTime->setChecked(!nsQtTimeWidget::s_pWidget->isClosed());
+  ActionShowWindowJoltStep->setChecked(!nsQtJoltStepWidget::s_pWidget->isClosed());
+  ActionShowWindowJoltQuery->setChecked(!nsQtJoltQueryWidget::s_pWidget->isClosed());
   ActionShowWindowInput->setChecked(!nsQtInputWidget::s_pWidget->isClosed());
   ActionShowWindowReflection->setChecked(!nsQtReflectionWidget::s_pWidget->isClosed());
   ActionShowWindowSubsystems->setChecked(!nsQtSubsystemsWidget::s_pWidget->isClosed());
@@ -36,6 +36,8 @@ private Q_SLOTS:
   void on_ActionShowWindowLog_triggered();
   void on_ActionShowWindowMemory_triggered();
   void on_ActionShowWindowTime_triggered();
+  void on_ActionShowWindowJoltStep_triggered();
+  void on_ActionShowWindowJoltQuery_triggered();
   void on_ActionShowWindowInput_triggered();
   void on_ActionShowWindowCVar_triggered();
   void on_ActionShowWindowReflection_triggered();
@@ -5,6 +5,8 @@
 #include <Inspector/FileWidget.moc.h>
 #include <Inspector/GlobalEventsWidget.moc.h>
 #include <Inspector/InputWidget.moc.h>
+#include <Inspector/JoltQueryWidget.moc.h>
+#include <Inspector/JoltStepWidget.moc.h>
 #include <Inspector/LogDockWidget.moc.h>
 #include <Inspector/MainWindow.moc.h>
 #include <Inspector/MemoryWidget.moc.h>
@@ -32,6 +34,18 @@ void nsQtMainWindow::on_ActionShowWindowTime_triggered()
   nsQtTimeWidget::s_pWidget->raise();
 }
 
+void nsQtMainWindow::on_ActionShowWindowJoltStep_triggered()
+{
+  nsQtJoltStepWidget::s_pWidget->toggleView(ActionShowWindowJoltStep->isChecked());
+  nsQtJoltStepWidget::s_pWidget->raise();
+}
+
+void nsQtMainWindow::on_ActionShowWindowJoltQuery_triggered()
+{
+  nsQtJoltQueryWidget::s_pWidget->toggleView(ActionShowWindowJoltQuery->isChecked());
+  nsQtJoltQueryWidget::s_pWidget->raise();
+}
+
 void nsQtMainWindow::on_ActionShowWindowInput_triggered()
 {
   nsQtInputWidget::s_pWidget->toggleView(ActionShowWindowInput->isChecked());
@@ -2,6 +2,7 @@
 
 #include <Foundation/Communication/Telemetry.h>
 #include <Foundation/Configuration/Startup.h>
+#include <InspectorPlugin/JoltInterface/JPHProfilerBridge.h>
 
 void AddLogWriter();
 void RemoveLogWriter();
@@ -75,11 +76,15 @@ NS_BEGIN_SUBSYSTEM_DECLARATION(InspectorPlugin, InspectorPluginMain)
     AddFileSystemEventHandler();
     AddResourceManagerEventHandler();
 
+    JDebug::API::JPHProfilerBridge::Install();
+
     SetAppStats();
   }
 
   ON_CORESYSTEMS_SHUTDOWN
   {
+    JDebug::API::JPHProfilerBridge::Uninstall();
+
     RemoveResourceManagerEventHandler();
     RemoveFileSystemEventHandler();
     RemoveTimeEventHandler();
@@ -0,0 +1,74 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHActivationTracker.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JDebug::API
+{
+  JPHActivationTracker::JPHActivationTracker() = default;
+
+  JPHActivationTracker::~JPHActivationTracker()
+  {
+    Detach();
+  }
+
+  void JPHActivationTracker::Attach(JPH::PhysicsSystem& inout_system)
+  {
+    Detach();
+
+    m_pChainedListener = inout_system.GetBodyActivationListener();
+    m_pAttachedSystem = &inout_system;
+    inout_system.SetBodyActivationListener(this);
+
+    NS_LOCK(m_Mutex);
+    m_Transitions.Clear();
+  }
+
+  void JPHActivationTracker::Detach()
+  {
+    if (m_pAttachedSystem == nullptr)
+      return;
+
+    // only restore the previous listener if nobody replaced the tracker in the meantime
+    if (m_pAttachedSystem->GetBodyActivationListener() == this)
+    {
+      m_pAttachedSystem->SetBodyActivationListener(m_pChainedListener);
+    }
+
+    m_pAttachedSystem = nullptr;
+    m_pChainedListener = nullptr;
+  }
+
+  void JPHActivationTracker::RetrieveTransitions(nsDynamicArray<JPH::BodyID>& out_bodies)
+  {
+    // swapping hands the capacity back and forth, so neither side allocates in the steady state
+    out_bodies.Clear();
+
+    NS_LOCK(m_Mutex);
+    out_bodies.Swap(m_Transitions);
+  }
+
+  void JPHActivationTracker::OnBodyActivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData)
+  {
+    {
+      NS_LOCK(m_Mutex);
+      m_Transitions.PushBack(inBodyID);
+    }
+
+    if (m_pChainedListener != nullptr)
+      m_pChainedListener->OnBodyActivated(inBodyID, inBodyUserData);
+  }
+
+  void JPHActivationTracker::OnBodyDeactivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData)
+  {
+    {
+      NS_LOCK(m_Mutex);
+      m_Transitions.PushBack(inBodyID);
+    }
+
+    if (m_pChainedListener != nullptr)
+      m_pChainedListener->OnBodyDeactivated(inBodyID, inBodyUserData);
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHActivationTracker);
@@ -0,0 +1,94 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHArenaTempAllocator.h>
+
+namespace JDebug::API
+{
+  JPHArenaTempAllocator::JPHArenaTempAllocator(nsUInt32 in_uiCapacity, nsAllocator* in_pParent)
+    : m_Allocator("Jolt/TempAllocator", in_pParent != nullptr ? in_pParent : nsFoundation::GetAlignedAllocator())
+  {
+    m_Stats.m_uiCapacity = nsMemoryUtils::AlignSize<nsUInt32>(in_uiCapacity, JPH_RVECTOR_ALIGNMENT);
+
+    if (m_Stats.m_uiCapacity > 0)
+    {
+      m_pArena = static_cast<nsUInt8*>(m_Allocator.Allocate(m_Stats.m_uiCapacity, JPH_RVECTOR_ALIGNMENT));
+    }
+  }
+
+  JPHArenaTempAllocator::~JPHArenaTempAllocator()
+  {
+    NS_ASSERT_DEV(m_Stats.m_uiUsed == 0 && m_Stats.m_uiFallbackBytes == 0, "Temporary memory is still allocated.");
+
+    if (m_pArena != nullptr)
+    {
+      m_Allocator.Deallocate(m_pArena);
+    }
+  }
+
+  void* JPHArenaTempAllocator::Allocate(JPH::uint inSize)
+  {
+    if (inSize == 0)
+      return nullptr;
+
+    const nsUInt32 uiSize = nsMemoryUtils::AlignSize<nsUInt32>(inSize, JPH_RVECTOR_ALIGNMENT);
+    void* pBlock = nullptr;
+
+    ++m_Stats.m_uiNumAllocations;
+
+    if (uiSize <= m_Stats.m_uiCapacity - m_Stats.m_uiUsed)
+    {
+      pBlock = m_pArena + m_Stats.m_uiUsed;
+      m_Stats.m_uiUsed += uiSize;
+    }
+    else
+    {
+      if (!m_bFallbackReported)
+      {
+        // logged once, a step that falls back usually does so every time
+        m_bFallbackReported = true;
+        nsLog::Warning("JPHArenaTempAllocator: {} bytes did not fit into the arena ({} of {} bytes used) and were allocated from the heap. The capacity should be at least {} bytes.",
+          uiSize, m_Stats.m_uiUsed, m_Stats.m_uiCapacity, m_Stats.m_uiUsed + m_Stats.m_uiFallbackBytes + uiSize);
+      }
+
+      pBlock = m_Allocator.Allocate(uiSize, JPH_RVECTOR_ALIGNMENT);
+
+      ++m_Stats.m_uiNumFallbackAllocations;
+      m_Stats.m_uiFallbackBytes += uiSize;
+      m_Stats.m_uiFallbackHighWaterMark = nsMath::Max(m_Stats.m_uiFallbackHighWaterMark, m_Stats.m_uiFallbackBytes);
+    }
+
+    m_Stats.m_uiHighWaterMark = nsMath::Max(m_Stats.m_uiHighWaterMark, m_Stats.m_uiUsed + m_Stats.m_uiFallbackBytes);
+    return pBlock;
+  }
+
+  void JPHArenaTempAllocator::Free(void* inAddress, JPH::uint inSize)
+  {
+    if (inAddress == nullptr)
+      return;
+
+    const nsUInt32 uiSize = nsMemoryUtils::AlignSize<nsUInt32>(inSize, JPH_RVECTOR_ALIGNMENT);
+    nsUInt8* pBlock = static_cast<nsUInt8*>(inAddress);
+
+    if (pBlock >= m_pArena && pBlock < m_pArena + m_Stats.m_uiCapacity)
+    {
+      NS_ASSERT_DEBUG(pBlock + uiSize == m_pArena + m_Stats.m_uiUsed, "Temporary memory must be freed in reverse order of allocation.");
+      m_Stats.m_uiUsed -= uiSize;
+    }
+    else
+    {
+      m_Allocator.Deallocate(pBlock);
+      m_Stats.m_uiFallbackBytes -= uiSize;
+    }
+  }
+
+  void JPHArenaTempAllocator::ResetStats()
+  {
+    m_Stats.m_uiHighWaterMark = m_Stats.m_uiUsed + m_Stats.m_uiFallbackBytes;
+    m_Stats.m_uiNumAllocations = 0;
+    m_Stats.m_uiNumFallbackAllocations = 0;
+    m_Stats.m_uiFallbackHighWaterMark = m_Stats.m_uiFallbackBytes;
+    m_bFallbackReported = false;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHArenaTempAllocator);
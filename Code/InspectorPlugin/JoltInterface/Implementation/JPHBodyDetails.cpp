@@ -0,0 +1,312 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHBodyDetails.h>
+#include <InspectorPlugin/JoltInterface/JPHShapeDictionary.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JPHBodyDetailsDetail
+{
+  enum BatchFlags : nsUInt8
+  {
+    HasContacts = NS_BIT(0),
+  };
+
+  enum DetailFlags : nsUInt8
+  {
+    Found = NS_BIT(0),
+    Active = NS_BIT(1),
+    Sensor = NS_BIT(2),
+    AllowSleeping = NS_BIT(3),
+    HasGroupFilter = NS_BIT(4),
+  };
+
+  /// u32 body ID and u8 flags, the least a body takes in the batch.
+  static constexpr nsUInt32 s_uiMinDetailSize = 5;
+
+  /// u32 body ID, two u32 sub shape IDs, float3 normal, two floats and two u8, the size of a contact in the batch.
+  static constexpr nsUInt32 s_uiContactSize = 34;
+
+  static nsVec3 ToVec3(JPH::Vec3Arg v)
+  {
+    return nsVec3(v.GetX(), v.GetY(), v.GetZ());
+  }
+
+  static void AddContact(const JDebug::API::JPHContactRecord& in_contact, bool bSecondBody, JDebug::API::JPHBodyDetail& ref_detail)
+  {
+    JDebug::API::JPHBodyContactDetail& contact = ref_detail.m_Contacts.ExpandAndGetRef();
+    contact.m_uiOtherBodyID = bSecondBody ? in_contact.m_uiBodyID1 : in_contact.m_uiBodyID2;
+    contact.m_uiSubShapeID = bSecondBody ? in_contact.m_uiSubShapeID2 : in_contact.m_uiSubShapeID1;
+    contact.m_uiOtherSubShapeID = bSecondBody ? in_contact.m_uiSubShapeID1 : in_contact.m_uiSubShapeID2;
+    contact.m_vNormal = bSecondBody ? -in_contact.m_vNormal : in_contact.m_vNormal;
+    contact.m_fPenetration = in_contact.m_fPenetration;
+    contact.m_fImpulse = in_contact.m_fImpulse;
+    contact.m_eEvent = in_contact.m_eEvent;
+    contact.m_uiFlags = in_contact.m_uiFlags;
+  }
+} // namespace JPHBodyDetailsDetail
+
+namespace JDebug::API
+{
+  void JPHBodyDetailBatch::Write(nsDynamicArray<nsUInt8>& out_data) const
+  {
+    using namespace JPHBodyDetailsDetail;
+
+    out_data.Clear();
+
+    IO::JPHByteWriter writer(out_data);
+    writer.Write(m_uiStepIndex);
+    writer.Write<nsUInt8>(m_bHasContacts ? BatchFlags::HasContacts : 0);
+    writer.WriteVarUInt(m_Details.GetCount());
+
+    for (const JPHBodyDetail& detail : m_Details)
+    {
+      nsUInt8 uiFlags = 0;
+      uiFlags |= detail.m_bFound ? DetailFlags::Found : 0;
+      uiFlags |= detail.m_bActive ? DetailFlags::Active : 0;
+      uiFlags |= detail.m_bSensor ? DetailFlags::Sensor : 0;
+      uiFlags |= detail.m_bAllowSleeping ? DetailFlags::AllowSleeping : 0;
+      uiFlags |= detail.m_bHasGroupFilter ? DetailFlags::HasGroupFilter : 0;
+
+      writer.Write(detail.m_uiBodyID);
+      writer.Write(uiFlags);
+
+      if (!detail.m_bFound)
+        continue;
+
+      writer.Write(detail.m_uiMotionType);
+      writer.Write(detail.m_uiMotionQuality);
+      writer.WriteVarUInt(detail.m_uiObjectLayer);
+      writer.Write(detail.m_uiUserData);
+      writer.Write(detail.m_uiCollisionGroupID);
+      writer.Write(detail.m_uiCollisionSubGroupID);
+      writer.Write(detail.m_fFriction);
+      writer.Write(detail.m_fRestitution);
+      writer.Write(detail.m_fMass);
+      writer.Write(detail.m_vInertiaDiagonal);
+      writer.Write(detail.m_qInertiaRotation);
+      writer.Write(detail.m_fLinearDamping);
+      writer.Write(detail.m_fAngularDamping);
+      writer.Write(detail.m_fGravityFactor);
+      writer.Write(detail.m_fMaxLinearVelocity);
+      writer.Write(detail.m_fMaxAngularVelocity);
+      writer.Write(detail.m_vCenterOfMass);
+      writer.Write(detail.m_uiShapeID);
+      writer.Write(detail.m_uiShapeType);
+      writer.Write(detail.m_uiShapeSubType);
+      writer.Write(detail.m_ShapeBounds.m_vMin);
+      writer.Write(detail.m_ShapeBounds.m_vMax);
+      writer.Write(detail.m_fShapeVolume);
+      writer.WriteVarUInt(detail.m_Contacts.GetCount());
+
+      for (const JPHBodyContactDetail& contact : detail.m_Contacts)
+      {
+        writer.Write(contact.m_uiOtherBodyID);
+        writer.Write(contact.m_uiSubShapeID);
+        writer.Write(contact.m_uiOtherSubShapeID);
+        writer.Write(contact.m_vNormal);
+        writer.Write(contact.m_fPenetration);
+        writer.Write(contact.m_fImpulse);
+        writer.Write(static_cast<nsUInt8>(contact.m_eEvent));
+        writer.Write(contact.m_uiFlags);
+      }
+    }
+  }
+
+  nsResult JPHBodyDetailBatch::Read(nsArrayPtr<const nsUInt8> in_data)
+  {
+    using namespace JPHBodyDetailsDetail;
+
+    *this = JPHBodyDetailBatch();
+
+    IO::JPHByteReader reader(in_data);
+    nsUInt8 uiBatchFlags = 0;
+    nsUInt64 uiCount = 0;
+
+    reader.Read(m_uiStepIndex);
+    reader.Read(uiBatchFlags);
+    reader.ReadVarUInt(uiCount);
+    m_bHasContacts = (uiBatchFlags & BatchFlags::HasContacts) != 0;
+
+    // don't trust the counts before checking them against the data that is actually there
+    if (reader.HasFailed() || uiCount > (in_data.GetCount() - reader.GetOffset()) / s_uiMinDetailSize)
+      return NS_FAILURE;
+
+    m_Details.SetCount(static_cast<nsUInt32>(uiCount));
+
+    for (JPHBodyDetail& detail : m_Details)
+    {
+      nsUInt8 uiFlags = 0;
+      reader.Read(detail.m_uiBodyID);
+      reader.Read(uiFlags);
+
+      detail.m_bFound = (uiFlags & DetailFlags::Found) != 0;
+      detail.m_bActive = (uiFlags & DetailFlags::Active) != 0;
+      detail.m_bSensor = (uiFlags & DetailFlags::Sensor) != 0;
+      detail.m_bAllowSleeping = (uiFlags & DetailFlags::AllowSleeping) != 0;
+      detail.m_bHasGroupFilter = (uiFlags & DetailFlags::HasGroupFilter) != 0;
+
+      if (!detail.m_bFound)
+        continue;
+
+      nsUInt64 uiObjectLayer = 0;
+
+      reader.Read(detail.m_uiMotionType);
+      reader.Read(detail.m_uiMotionQuality);
+      reader.ReadVarUInt(uiObjectLayer);
+      reader.Read(detail.m_uiUserData);
+      reader.Read(detail.m_uiCollisionGroupID);
+      reader.Read(detail.m_uiCollisionSubGroupID);
+      reader.Read(detail.m_fFriction);
+      reader.Read(detail.m_fRestitution);
+      reader.Read(detail.m_fMass);
+      reader.Read(detail.m_vInertiaDiagonal);
+      reader.Read(detail.m_qInertiaRotation);
+      reader.Read(detail.m_fLinearDamping);
+      reader.Read(detail.m_fAngularDamping);
+      reader.Read(detail.m_fGravityFactor);
+      reader.Read(detail.m_fMaxLinearVelocity);
+      reader.Read(detail.m_fMaxAngularVelocity);
+      reader.Read(detail.m_vCenterOfMass);
+      reader.Read(detail.m_uiShapeID);
+      reader.Read(detail.m_uiShapeType);
+      reader.Read(detail.m_uiShapeSubType);
+      reader.Read(detail.m_ShapeBounds.m_vMin);
+      reader.Read(detail.m_ShapeBounds.m_vMax);
+      reader.Read(detail.m_fShapeVolume);
+      reader.ReadVarUInt(uiCount);
+      detail.m_uiObjectLayer = static_cast<nsUInt32>(uiObjectLayer);
+
+      if (reader.HasFailed() || uiObjectLayer > nsMath::MaxValue<nsUInt32>() || uiCount > (in_data.GetCount() - reader.GetOffset()) / s_uiContactSize)
+        return NS_FAILURE;
+
+      detail.m_Contacts.SetCount(static_cast<nsUInt32>(uiCount));
+
+      for (JPHBodyContactDetail& contact : detail.m_Contacts)
+      {
+        nsUInt8 uiEvent = 0;
+
+        reader.Read(contact.m_uiOtherBodyID);
+        reader.Read(contact.m_uiSubShapeID);
+        reader.Read(contact.m_uiOtherSubShapeID);
+        reader.Read(contact.m_vNormal);
+        reader.Read(contact.m_fPenetration);
+        reader.Read(contact.m_fImpulse);
+        reader.Read(uiEvent);
+        reader.Read(contact.m_uiFlags);
+
+        if (uiEvent > static_cast<nsUInt8>(JPHContactEvent::Removed))
+          return NS_FAILURE;
+
+        contact.m_eEvent = static_cast<JPHContactEvent>(uiEvent);
+      }
+    }
+
+    return (reader.HasFailed() || !reader.IsAtEnd()) ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  JPHBodyDetailResolver::JPHBodyDetailResolver() = default;
+  JPHBodyDetailResolver::~JPHBodyDetailResolver() = default;
+
+  void JPHBodyDetailResolver::Resolve(const JPH::PhysicsSystem& in_system, const JPHShapeDictionary* in_pShapeDictionary, const JPHContactRecorder* in_pContactRecorder,
+    nsArrayPtr<const nsUInt32> in_bodyIDs, JPHBodyDetailBatch& inout_batch)
+  {
+    NS_PROFILE_SCOPE("JPHBodyDetailResolver::Resolve");
+
+    inout_batch.m_bHasContacts = in_pContactRecorder != nullptr;
+    inout_batch.m_Details.SetCount(in_bodyIDs.GetCount());
+    m_DetailIndices.Clear();
+
+    const JPH::BodyLockInterface& lockInterface = in_system.GetBodyLockInterface();
+
+    for (nsUInt32 i = 0; i < in_bodyIDs.GetCount(); ++i)
+    {
+      JPHBodyDetail& detail = inout_batch.m_Details[i];
+      detail = JPHBodyDetail();
+      detail.m_uiBodyID = in_bodyIDs[i];
+
+      // the IDs come from the client, one with the broad phase bit would trip an assert in JPH::BodyID
+      if ((in_bodyIDs[i] & JPH::BodyID::cBroadPhaseBit) != 0)
+        continue;
+
+      JPH::BodyLockRead lock(lockInterface, JPH::BodyID(in_bodyIDs[i]));
+
+      if (!lock.Succeeded())
+        continue;
+
+      ReadBody(lock.GetBody(), in_pShapeDictionary, detail);
+      m_DetailIndices.Insert(in_bodyIDs[i], i);
+    }
+
+    if (in_pContactRecorder == nullptr || m_DetailIndices.IsEmpty())
+      return;
+
+    // one pass over the contacts of the step, each contact may belong to two of the requested bodies
+    for (const JPHContactRecord& contact : in_pContactRecorder->GetContacts())
+    {
+      nsUInt32 uiIndex = 0;
+
+      if (m_DetailIndices.TryGetValue(contact.m_uiBodyID1, uiIndex))
+        JPHBodyDetailsDetail::AddContact(contact, false, inout_batch.m_Details[uiIndex]);
+
+      if (m_DetailIndices.TryGetValue(contact.m_uiBodyID2, uiIndex))
+        JPHBodyDetailsDetail::AddContact(contact, true, inout_batch.m_Details[uiIndex]);
+    }
+  }
+
+  void JPHBodyDetailResolver::ReadBody(const JPH::Body& in_body, const JPHShapeDictionary* in_pShapeDictionary, JPHBodyDetail& out_detail)
+  {
+    using namespace JPHBodyDetailsDetail;
+
+    const JPH::CollisionGroup& collisionGroup = in_body.GetCollisionGroup();
+    const JPH::Shape* pShape = in_body.GetShape();
+
+    out_detail.m_bFound = true;
+    out_detail.m_bActive = in_body.IsActive();
+    out_detail.m_bSensor = in_body.IsSensor();
+    out_detail.m_uiMotionType = static_cast<nsUInt8>(in_body.GetMotionType());
+    out_detail.m_uiObjectLayer = in_body.GetObjectLayer();
+    out_detail.m_uiUserData = in_body.GetUserData();
+    out_detail.m_uiCollisionGroupID = collisionGroup.GetGroupID();
+    out_detail.m_uiCollisionSubGroupID = collisionGroup.GetSubGroupID();
+    out_detail.m_bHasGroupFilter = collisionGroup.GetGroupFilter() != nullptr;
+    out_detail.m_fFriction = in_body.GetFriction();
+    out_detail.m_fRestitution = in_body.GetRestitution();
+    out_detail.m_vCenterOfMass = ToVec3(JPH::Vec3(in_body.GetCenterOfMassPosition()));
+
+    // static bodies have no motion properties, they keep the defaults of infinite mass and no damping
+    if (const JPH::MotionProperties* pMotion = in_body.GetMotionPropertiesUnchecked())
+    {
+      const float fInvMass = pMotion->GetInverseMassUnchecked();
+      const JPH::Vec3 vInvInertia = pMotion->GetInverseInertiaDiagonal();
+      const JPH::Quat qInertiaRotation = pMotion->GetInertiaRotation();
+
+      out_detail.m_bAllowSleeping = pMotion->GetAllowSleeping();
+      out_detail.m_uiMotionQuality = static_cast<nsUInt8>(pMotion->GetMotionQuality());
+      out_detail.m_fMass = fInvMass > 0.0f ? 1.0f / fInvMass : 0.0f;
+      out_detail.m_vInertiaDiagonal.x = vInvInertia.GetX() > 0.0f ? 1.0f / vInvInertia.GetX() : 0.0f;
+      out_detail.m_vInertiaDiagonal.y = vInvInertia.GetY() > 0.0f ? 1.0f / vInvInertia.GetY() : 0.0f;
+      out_detail.m_vInertiaDiagonal.z = vInvInertia.GetZ() > 0.0f ? 1.0f / vInvInertia.GetZ() : 0.0f;
+      out_detail.m_qInertiaRotation = nsQuat(qInertiaRotation.GetX(), qInertiaRotation.GetY(), qInertiaRotation.GetZ(), qInertiaRotation.GetW());
+      out_detail.m_fLinearDamping = pMotion->GetLinearDamping();
+      out_detail.m_fAngularDamping = pMotion->GetAngularDamping();
+      out_detail.m_fGravityFactor = pMotion->GetGravityFactor();
+      out_detail.m_fMaxLinearVelocity = pMotion->GetMaxLinearVelocity();
+      out_detail.m_fMaxAngularVelocity = pMotion->GetMaxAngularVelocity();
+    }
+
+    const JPH::AABox localBounds = pShape->GetLocalBounds();
+
+    out_detail.m_uiShapeID = in_pShapeDictionary != nullptr ? in_pShapeDictionary->FindShapeID(pShape) : JPHShapeDictionary::s_uiInvalidShapeID;
+    out_detail.m_uiShapeType = static_cast<nsUInt8>(pShape->GetType());
+    out_detail.m_uiShapeSubType = static_cast<nsUInt8>(pShape->GetSubType());
+    out_detail.m_ShapeBounds = nsBoundingBox::MakeFromMinMax(ToVec3(localBounds.mMin), ToVec3(localBounds.mMax));
+    out_detail.m_fShapeVolume = pShape->GetVolume();
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHBodyDetails);
@@ -0,0 +1,85 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHShapeDictionary.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/Body.h>
+
+namespace JDebug::API
+{
+  void JPHBodySnapshot::SetSlotCount(nsUInt32 in_uiNumSlots)
+  {
+    if (m_BodyIDs.GetCount() == in_uiNumSlots)
+      return;
+
+    // the arrays keep their capacity when shrinking, so a fluctuating body count does not cause reallocations
+    m_BodyIDs.SetCountUninitialized(in_uiNumSlots);
+    m_Positions.SetCountUninitialized(in_uiNumSlots);
+    m_Rotations.SetCountUninitialized(in_uiNumSlots);
+    m_LinearVelocities.SetCountUninitialized(in_uiNumSlots);
+    m_AngularVelocities.SetCountUninitialized(in_uiNumSlots);
+    m_MotionTypes.SetCountUninitialized(in_uiNumSlots);
+    m_States.SetCountUninitialized(in_uiNumSlots);
+    m_ObjectLayers.SetCountUninitialized(in_uiNumSlots);
+    m_ShapeIDs.SetCountUninitialized(in_uiNumSlots);
+  }
+
+  void JPHBodySnapshot::CaptureBody(const JPH::Body& in_body, nsUInt32 in_uiSlot)
+  {
+    const JPH::RVec3 vPosition = in_body.GetPosition();
+    const JPH::Quat qRotation = in_body.GetRotation();
+    const JPH::Vec3 vLinearVelocity = in_body.GetLinearVelocity();
+    const JPH::Vec3 vAngularVelocity = in_body.GetAngularVelocity();
+
+    nsUInt8 uiState = JPHBodyStateFlags::Valid;
+    uiState |= in_body.IsActive() ? JPHBodyStateFlags::Active : 0;
+    uiState |= in_body.IsSensor() ? JPHBodyStateFlags::Sensor : 0;
+    uiState |= in_body.IsSoftBody() ? JPHBodyStateFlags::SoftBody : 0;
+
+    m_BodyIDs[in_uiSlot] = in_body.GetID().GetIndexAndSequenceNumber();
+    m_Positions[in_uiSlot].Set(static_cast<float>(vPosition.GetX()), static_cast<float>(vPosition.GetY()), static_cast<float>(vPosition.GetZ()));
+    m_Rotations[in_uiSlot] = nsQuat(qRotation.GetX(), qRotation.GetY(), qRotation.GetZ(), qRotation.GetW());
+    m_LinearVelocities[in_uiSlot].Set(vLinearVelocity.GetX(), vLinearVelocity.GetY(), vLinearVelocity.GetZ());
+    m_AngularVelocities[in_uiSlot].Set(vAngularVelocity.GetX(), vAngularVelocity.GetY(), vAngularVelocity.GetZ());
+    m_MotionTypes[in_uiSlot] = static_cast<nsUInt8>(in_body.GetMotionType());
+    m_States[in_uiSlot] = uiState;
+    m_ObjectLayers[in_uiSlot] = static_cast<nsUInt32>(in_body.GetObjectLayer());
+  }
+
+  void JPHBodySnapshot::ClearSlots()
+  {
+    const nsUInt32 uiNumSlots = GetSlotCount();
+
+    if (uiNumSlots == 0)
+      return;
+
+    // cInvalidBodyID and s_uiInvalidShapeID are all bits set
+    static_assert(JPH::BodyID::cInvalidBodyID == 0xFFFFFFFF && JPHShapeDictionary::s_uiInvalidShapeID == 0xFFFFFFFF);
+    nsMemoryUtils::PatternFill(m_BodyIDs.GetData(), 0xFF, uiNumSlots);
+    nsMemoryUtils::PatternFill(m_ShapeIDs.GetData(), 0xFF, uiNumSlots);
+
+    nsMemoryUtils::ZeroFill(m_Positions.GetData(), uiNumSlots);
+    nsMemoryUtils::ZeroFill(m_Rotations.GetData(), uiNumSlots);
+    nsMemoryUtils::ZeroFill(m_LinearVelocities.GetData(), uiNumSlots);
+    nsMemoryUtils::ZeroFill(m_AngularVelocities.GetData(), uiNumSlots);
+    nsMemoryUtils::ZeroFill(m_MotionTypes.GetData(), uiNumSlots);
+    nsMemoryUtils::ZeroFill(m_States.GetData(), uiNumSlots);
+    nsMemoryUtils::ZeroFill(m_ObjectLayers.GetData(), uiNumSlots);
+  }
+
+  void JPHBodySnapshot::ClearSlot(nsUInt32 in_uiSlot)
+  {
+    m_BodyIDs[in_uiSlot] = JPH::BodyID::cInvalidBodyID;
+    m_Positions[in_uiSlot].SetZero();
+    m_Rotations[in_uiSlot] = nsQuat(0.0f, 0.0f, 0.0f, 0.0f);
+    m_LinearVelocities[in_uiSlot].SetZero();
+    m_AngularVelocities[in_uiSlot].SetZero();
+    m_MotionTypes[in_uiSlot] = 0;
+    m_States[in_uiSlot] = 0;
+    m_ObjectLayers[in_uiSlot] = 0;
+    m_ShapeIDs[in_uiSlot] = JPHShapeDictionary::s_uiInvalidShapeID;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHBodySnapshot);
@@ -0,0 +1,341 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHCaptureThrottle.h>
+
+namespace JDebug::API
+{
+  namespace JPHCaptureThrottleDetail
+  {
+    /// Weight of a new sample in the running average.
+    static constexpr double s_fAverageWeight = 0.1;
+
+    /// Per frame decay of the peaks towards the averages, a spike keeps the fidelity down for a few dozen frames.
+    static constexpr double s_fPeakDecay = 0.95;
+
+    /// Per frame decay of all estimates while frames are skipped, so the cost is measured again after a while.
+    static constexpr double s_fSkipDecay = 0.98;
+
+    /// Relative publishing cost of the levels, used until a level was measured. Delta frames get cheaper with every level, keyframes
+    /// always contain all bodies and only get cheaper with less content.
+    static constexpr double s_DeltaWeights[JPHCaptureFidelity::ENUM_COUNT] = {1.0, 0.8, 0.65, 0.35, 0.15};
+    static constexpr double s_KeyframeWeights[JPHCaptureFidelity::ENUM_COUNT] = {2.0, 2.0, 1.6, 1.6, 0.5};
+
+    /// Per slot costs in nanoseconds assumed before anything was measured, on the pessimistic side.
+    static constexpr double s_fDefaultCaptureCost = 60.0;
+    static constexpr double s_fDefaultPublishCost = 150.0;
+
+    static double GetWeight(JPHCaptureFidelity::Enum eFidelity, bool bKeyframe)
+    {
+      return bKeyframe ? s_KeyframeWeights[eFidelity] : s_DeltaWeights[eFidelity];
+    }
+
+    static double ToNanoseconds(nsTime time, nsUInt32 uiNumSlots)
+    {
+      return time.GetNanoseconds() / nsMath::Max(uiNumSlots, 1u);
+    }
+  } // namespace JPHCaptureThrottleDetail
+
+  const char* JPHCaptureFidelity::GetName(Enum in_eFidelity)
+  {
+    switch (in_eFidelity)
+    {
+      case Full:
+        return "Full";
+      case RelaxedTolerances:
+        return "Relaxed Tolerances";
+      case NoVelocities:
+        return "No Velocities";
+      case HalfRate:
+        return "Half Rate";
+      case StatesOnly:
+        return "States Only";
+      default:
+        break;
+    }
+
+    NS_ASSERT_NOT_IMPLEMENTED;
+    return "";
+  }
+
+  nsUInt32 JPHCaptureFidelity::GetSendRate(Enum in_eFidelity)
+  {
+    switch (in_eFidelity)
+    {
+      case HalfRate:
+        return 2;
+      case StatesOnly:
+        return 4;
+      default:
+        return 1;
+    }
+  }
+
+  void JPHCaptureThrottle::CostEstimate::AddSample(double fValue)
+  {
+    if (!m_bMeasured)
+    {
+      m_fAverage = fValue;
+      m_fPeak = fValue;
+      m_bMeasured = true;
+      return;
+    }
+
+    m_fAverage += (fValue - m_fAverage) * JPHCaptureThrottleDetail::s_fAverageWeight;
+    m_fPeak = nsMath::Max(m_fPeak, fValue);
+  }
+
+  void JPHCaptureThrottle::CostEstimate::Tick()
+  {
+    // keyframes are rare, so the peaks decay per frame and not per sample
+    m_fPeak = m_fAverage + (m_fPeak - m_fAverage) * JPHCaptureThrottleDetail::s_fPeakDecay;
+  }
+
+  void JPHCaptureThrottle::CostEstimate::Lower()
+  {
+    m_fAverage *= JPHCaptureThrottleDetail::s_fSkipDecay;
+    m_fPeak *= JPHCaptureThrottleDetail::s_fSkipDecay;
+  }
+
+  JPHCaptureThrottle::JPHCaptureThrottle() = default;
+
+  void JPHCaptureThrottle::SetBudget(const JPHCaptureBudget& in_budget)
+  {
+    m_Budget = in_budget;
+    m_uiFramesWithHeadroom = 0;
+  }
+
+  void JPHCaptureThrottle::Reset()
+  {
+    m_eFidelity = JPHCaptureFidelity::Full;
+    m_uiFramesWithHeadroom = 0;
+    m_bWarmUp = true;
+  }
+
+  nsTime JPHCaptureThrottle::ComputeFrameBudget(nsTime in_stepTime) const
+  {
+    if (!m_Budget.m_bEnabled)
+      return nsTime::MakeZero();
+
+    nsTime budget = m_Budget.m_MaxTime;
+
+    if (m_Budget.m_fMaxStepFraction > 0.0f && in_stepTime.IsPositive())
+    {
+      const nsTime stepBudget = in_stepTime * m_Budget.m_fMaxStepFraction;
+      budget = budget.IsPositive() ? nsMath::Min(budget, stepBudget) : stepBudget;
+    }
+
+    return budget;
+  }
+
+  double JPHCaptureThrottle::PredictCapture(nsUInt32 uiNumSlots) const
+  {
+    const double fCost = m_Capture.m_bMeasured ? m_Capture.GetPrediction() : JPHCaptureThrottleDetail::s_fDefaultCaptureCost;
+    return fCost * nsMath::Max(uiNumSlots, 1u);
+  }
+
+  double JPHCaptureThrottle::PredictPublish(JPHCaptureFidelity::Enum eFidelity, bool bKeyframe, nsUInt32 uiNumSlots) const
+  {
+    using namespace JPHCaptureThrottleDetail;
+
+    const double fNumSlots = nsMath::Max(uiNumSlots, 1u);
+    const nsUInt32 uiKeyframe = bKeyframe ? 1 : 0;
+
+    if (m_Publish[eFidelity][uiKeyframe].m_bMeasured)
+      return m_Publish[eFidelity][uiKeyframe].GetPrediction() * fNumSlots;
+
+    // Scale the closest measured estimate, preferring the same kind of frame. The weights are rough, but the error shrinks
+    // as soon as the level is used once.
+    double fBest = -1.0;
+    nsUInt32 uiBestDistance = nsMath::MaxValue<nsUInt32>();
+
+    for (nsUInt32 uiLevel = 0; uiLevel < JPHCaptureFidelity::ENUM_COUNT; ++uiLevel)
+    {
+      for (nsUInt32 uiKind = 0; uiKind < 2; ++uiKind)
+      {
+        const CostEstimate& estimate = m_Publish[uiLevel][uiKind];
+
+        if (!estimate.m_bMeasured)
+          continue;
+
+        const nsUInt32 uiDistance = nsMath::Abs(static_cast<nsInt32>(uiLevel) - static_cast<nsInt32>(eFidelity)) + (uiKind != uiKeyframe ? JPHCaptureFidelity::ENUM_COUNT : 0);
+
+        if (uiDistance < uiBestDistance)
+        {
+          uiBestDistance = uiDistance;
+          fBest = estimate.GetPrediction() * GetWeight(eFidelity, bKeyframe) / GetWeight(static_cast<JPHCaptureFidelity::Enum>(uiLevel), uiKind != 0);
+        }
+      }
+    }
+
+    if (fBest < 0.0)
+    {
+      fBest = s_fDefaultPublishCost * GetWeight(eFidelity, bKeyframe);
+    }
+
+    return fBest * fNumSlots;
+  }
+
+  bool JPHCaptureThrottle::BeginFrame(nsTime in_frameBudget, nsUInt32 in_uiNumSlots, const bool (&in_keyframePending)[JPHCaptureFidelity::ENUM_COUNT])
+  {
+    m_FrameBudget = in_frameBudget;
+
+    if (!in_frameBudget.IsPositive())
+    {
+      m_eFidelity = JPHCaptureFidelity::Full;
+      return true;
+    }
+
+    ForEachEstimate([](CostEstimate& estimate)
+      { estimate.Tick(); });
+
+    const double fBudget = in_frameBudget.GetNanoseconds();
+    const double fCapture = PredictCapture(in_uiNumSlots);
+
+    auto Predict = [&](nsUInt32 uiLevel, bool bKeyframe)
+    {
+      return fCapture + PredictPublish(static_cast<JPHCaptureFidelity::Enum>(uiLevel), bKeyframe, in_uiNumSlots);
+    };
+
+    auto Fits = [&](nsUInt32 uiLevel)
+    {
+      return Predict(uiLevel, in_keyframePending[uiLevel]) <= fBudget;
+    };
+
+    if (!Fits(m_eFidelity))
+    {
+      // Lower the fidelity right away, the budget is a hard limit. A more detailed level can only fit if the current one
+      // is about to write a keyframe, that is only used when no cheaper level is left.
+      nsUInt32 uiFitting = JPHCaptureFidelity::ENUM_COUNT;
+
+      for (nsUInt32 uiLevel = m_eFidelity + 1; uiLevel < JPHCaptureFidelity::ENUM_COUNT && uiFitting == JPHCaptureFidelity::ENUM_COUNT; ++uiLevel)
+      {
+        if (Fits(uiLevel))
+          uiFitting = uiLevel;
+      }
+
+      for (nsUInt32 uiLevel = m_eFidelity; uiLevel > 0 && uiFitting == JPHCaptureFidelity::ENUM_COUNT; --uiLevel)
+      {
+        if (Fits(uiLevel - 1))
+          uiFitting = uiLevel - 1;
+      }
+
+      m_uiFramesWithHeadroom = 0;
+
+      if (uiFitting == JPHCaptureFidelity::ENUM_COUNT)
+      {
+        // Not even the cheapest level fits. The encoders keep what their receivers know, the next published frame simply covers more time.
+        ++m_uiNumSkippedFrames;
+
+        // Without new samples a single expensive frame would stop the capture for good. Lowering the estimates makes the throttle
+        // try again after a while, the capture of that frame tells whether the cost went down.
+        ForEachEstimate([](CostEstimate& estimate)
+          { estimate.Lower(); });
+        return false;
+      }
+
+      m_eFidelity = static_cast<JPHCaptureFidelity::Enum>(uiFitting);
+      return true;
+    }
+
+    if (m_eFidelity == JPHCaptureFidelity::Full)
+      return true;
+
+    // Only go up one level once it fit with headroom for a while. Changing the content forces a keyframe, so the
+    // keyframe of the higher level has to fit as well.
+    const nsUInt32 uiHigher = m_eFidelity - 1;
+
+    if (Predict(uiHigher, in_keyframePending[uiHigher]) <= fBudget * m_Budget.m_fRestoreThreshold && Predict(uiHigher, true) <= fBudget)
+    {
+      if (++m_uiFramesWithHeadroom >= m_Budget.m_uiRestoreDelay)
+      {
+        m_eFidelity = static_cast<JPHCaptureFidelity::Enum>(uiHigher);
+        m_uiFramesWithHeadroom = 0;
+      }
+    }
+    else
+    {
+      m_uiFramesWithHeadroom = 0;
+    }
+
+    return true;
+  }
+
+  template <typename Func>
+  void JPHCaptureThrottle::ForEachEstimate(Func func)
+  {
+    func(m_Capture);
+
+    for (auto& publish : m_Publish)
+    {
+      func(publish[0]);
+      func(publish[1]);
+    }
+  }
+
+  bool JPHCaptureThrottle::CanPublish(nsTime in_frameBudget, nsTime in_captureTime, nsUInt32 in_uiNumSlots, bool in_bKeyframe) const
+  {
+    if (!in_frameBudget.IsPositive())
+      return true;
+
+    return in_captureTime.GetNanoseconds() + PredictPublish(m_eFidelity, in_bKeyframe, in_uiNumSlots) <= in_frameBudget.GetNanoseconds();
+  }
+
+  void JPHCaptureThrottle::EndFrame(nsTime in_captureTime, nsTime in_publishTime, nsUInt32 in_uiNumSlots, bool in_bKeyframe)
+  {
+    if (!m_bWarmUp)
+    {
+      m_Capture.AddSample(JPHCaptureThrottleDetail::ToNanoseconds(in_captureTime, in_uiNumSlots));
+      m_Publish[m_eFidelity][in_bKeyframe ? 1 : 0].AddSample(JPHCaptureThrottleDetail::ToNanoseconds(in_publishTime, in_uiNumSlots));
+    }
+
+    m_bWarmUp = false;
+
+    m_LastCost = in_captureTime + in_publishTime;
+    m_MaxCost = nsMath::Max(m_MaxCost, m_LastCost);
+
+    if (m_FrameBudget.IsPositive() && m_LastCost > m_FrameBudget)
+    {
+      ++m_uiNumFramesOverBudget;
+    }
+  }
+
+  void JPHCaptureThrottle::SkipFrame(nsTime in_captureTime, nsUInt32 in_uiNumSlots)
+  {
+    if (!m_bWarmUp)
+    {
+      m_Capture.AddSample(JPHCaptureThrottleDetail::ToNanoseconds(in_captureTime, in_uiNumSlots));
+    }
+
+    m_bWarmUp = false;
+
+    m_LastCost = in_captureTime;
+    m_MaxCost = nsMath::Max(m_MaxCost, m_LastCost);
+    ++m_uiNumSkippedFrames;
+
+    if (m_FrameBudget.IsPositive() && m_LastCost > m_FrameBudget)
+    {
+      ++m_uiNumFramesOverBudget;
+    }
+  }
+
+  void JPHCaptureThrottle::PublishStats(bool in_bForce)
+  {
+    const nsTime now = nsTime::Now();
+
+    if (!in_bForce && now - m_LastStatsTime < m_Budget.m_StatsInterval)
+      return;
+
+    m_LastStatsTime = now;
+
+    nsStats::SetStat("JDebug/Throttle/Fidelity", JPHCaptureFidelity::GetName(m_eFidelity));
+    nsStats::SetStat("JDebug/Throttle/Budget", m_FrameBudget);
+    nsStats::SetStat("JDebug/Throttle/Frame Cost", m_MaxCost);
+    nsStats::SetStat("JDebug/Throttle/Skipped Frames", m_uiNumSkippedFrames);
+    nsStats::SetStat("JDebug/Throttle/Frames Over Budget", m_uiNumFramesOverBudget);
+
+    // like the write latency of the capture, the cost is reported as the maximum over one interval
+    m_MaxCost = nsTime::MakeZero();
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHCaptureThrottle);
@@ -0,0 +1,222 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileManager.h>
+#include <InspectorPlugin/JoltInterface/JPHCaptureWriter.h>
+
+namespace JDebug::API
+{
+  JPHCaptureWriter::WriterThread::WriterThread(JPHCaptureWriter* pOwner)
+    : nsThread("JDebug Capture Writer")
+    , m_pOwner(pOwner)
+  {
+  }
+
+  nsUInt32 JPHCaptureWriter::WriterThread::Run()
+  {
+    return m_pOwner->RunWriter();
+  }
+
+  JPHCaptureWriter::JPHCaptureWriter() = default;
+
+  JPHCaptureWriter::~JPHCaptureWriter()
+  {
+    Stop();
+  }
+
+  void JPHCaptureWriter::Start(IO::JPHPVDFileManager& inout_sink, const JPHCaptureWriterSettings& in_settings)
+  {
+    Stop();
+
+    NS_ASSERT_DEV(inout_sink.IsOpen(), "The capture file has to be opened before the writer is started.");
+
+    m_Settings = in_settings;
+    m_pSink = &inout_sink;
+    m_pRing = NS_DEFAULT_NEW(IO::JPHCaptureRing, m_Settings.m_uiQueueCapacity);
+
+    m_bStopRequested = false;
+    m_iDroppedFrames = 0;
+    m_bShapesPending = false;
+    m_PendingShapes.Clear();
+    m_uiNextPushSequence = 0;
+    m_uiNextWriteSequence = 0;
+    m_bWaitForKeyframe = true; // the capture has to begin with a keyframe
+    m_LastStatsTime = nsTime::Now();
+    m_MaxWriteLatency = nsTime::MakeZero();
+
+    m_pThread = NS_DEFAULT_NEW(WriterThread, this);
+    m_pThread->Start();
+  }
+
+  void JPHCaptureWriter::Stop()
+  {
+    if (!IsRunning())
+      return;
+
+    m_bStopRequested = true;
+    m_FramesAvailable.RaiseSignal();
+    m_pThread->Join();
+
+    m_pThread.Clear();
+    m_pRing.Clear();
+    m_pSink = nullptr;
+  }
+
+  bool JPHCaptureWriter::Push(nsDynamicArray<nsUInt8>& inout_data, nsUInt64 in_uiStepIndex, bool in_bKeyframe, nsArrayPtr<const nsUInt8> in_records)
+  {
+    NS_ASSERT_DEV(IsRunning(), "The capture writer has not been started.");
+
+    // take the data, the caller gets the buffer that came out of the ring last time
+    m_PushFrame.m_Data.Swap(inout_data);
+    m_PushFrame.m_Records = in_records;
+    m_PushFrame.m_uiStepIndex = in_uiStepIndex;
+    m_PushFrame.m_uiSequence = m_uiNextPushSequence++;
+    m_PushFrame.m_EnqueueTime = nsTime::Now();
+    m_PushFrame.m_bKeyframe = in_bKeyframe;
+
+    bool bDropped = false;
+
+    while (!m_pRing->TryPush(m_PushFrame))
+    {
+      switch (m_Settings.m_eBackpressure)
+      {
+        case JPHCaptureBackpressure::DropOldest:
+          // the writer may have emptied a slot in the meantime, then there is nothing to drop
+          if (m_pRing->TryPop(m_DropFrame))
+          {
+            m_iDroppedFrames.Increment();
+            bDropped = true;
+          }
+          break;
+
+        case JPHCaptureBackpressure::DropNewest:
+          m_iDroppedFrames.Increment();
+          return false;
+
+        case JPHCaptureBackpressure::Stall:
+          m_SpaceAvailable.WaitForSignal(nsTime::MakeFromMilliseconds(1));
+          break;
+      }
+    }
+
+    m_FramesAvailable.RaiseSignal();
+    return !bDropped;
+  }
+
+  void JPHCaptureWriter::PushShape(nsUInt32 in_uiShapeID, nsArrayPtr<const nsUInt8> in_data)
+  {
+    NS_ASSERT_DEV(IsRunning(), "The capture writer has not been started.");
+
+    {
+      NS_LOCK(m_ShapeMutex);
+
+      IO::JPHByteWriter writer(m_PendingShapes);
+      writer.Write(in_uiShapeID);
+      writer.Write(in_data.GetCount());
+      writer.WriteBytes(in_data.GetPtr(), in_data.GetCount());
+    }
+
+    m_bShapesPending = true;
+  }
+
+  nsUInt32 JPHCaptureWriter::RunWriter()
+  {
+    while (!m_bStopRequested)
+    {
+      m_FramesAvailable.WaitForSignal(m_Settings.m_StatsInterval);
+
+      WriteQueuedFrames();
+      PublishStats(false);
+    }
+
+    // the producer has stopped, write whatever is left
+    WriteQueuedFrames();
+    WritePendingShapes();
+    PublishStats(true);
+    return 0;
+  }
+
+  void JPHCaptureWriter::WriteQueuedFrames()
+  {
+    while (m_pRing->TryPop(m_WriteFrame))
+    {
+      // shapes are pushed before the frames that use them, so everything a popped frame references is queued by now
+      WritePendingShapes();
+
+      if (m_Settings.m_eBackpressure == JPHCaptureBackpressure::Stall)
+      {
+        m_SpaceAvailable.RaiseSignal();
+      }
+
+      // a gap in the sequence means frames were dropped, delta frames are useless until the next keyframe
+      if (m_WriteFrame.m_uiSequence != m_uiNextWriteSequence)
+      {
+        m_bWaitForKeyframe = true;
+      }
+
+      m_uiNextWriteSequence = m_WriteFrame.m_uiSequence + 1;
+
+      if (m_bWaitForKeyframe && !m_WriteFrame.m_bKeyframe)
+      {
+        m_iDroppedFrames.Increment();
+        continue;
+      }
+
+      m_bWaitForKeyframe = false;
+
+      {
+        NS_PROFILE_SCOPE("JPHCaptureWriter::WriteFrame");
+
+        m_pSink->BeginFrame(m_WriteFrame.m_uiStepIndex, m_WriteFrame.m_bKeyframe);
+        m_pSink->WriteEncodedFrame(m_WriteFrame.m_Data);
+        m_pSink->WriteRecords(m_WriteFrame.m_Records);
+        m_pSink->EndFrame();
+      }
+
+      m_MaxWriteLatency = nsMath::Max(m_MaxWriteLatency, nsTime::Now() - m_WriteFrame.m_EnqueueTime);
+    }
+  }
+
+  void JPHCaptureWriter::WritePendingShapes()
+  {
+    if (!m_bShapesPending.Set(false))
+      return;
+
+    {
+      NS_LOCK(m_ShapeMutex);
+      m_WriteShapes.Swap(m_PendingShapes);
+      m_PendingShapes.Clear();
+    }
+
+    IO::JPHByteReader reader(m_WriteShapes);
+    while (!reader.IsAtEnd())
+    {
+      nsUInt32 uiShapeID = 0;
+      nsUInt32 uiSize = 0;
+      reader.Read(uiShapeID);
+      reader.Read(uiSize);
+
+      m_pSink->WriteShapeGeometry(uiShapeID, m_WriteShapes.GetArrayPtr().GetSubArray(reader.GetOffset(), uiSize));
+      reader.Skip(uiSize);
+    }
+  }
+
+  void JPHCaptureWriter::PublishStats(bool bForce)
+  {
+    const nsTime now = nsTime::Now();
+
+    if (!bForce && now - m_LastStatsTime < m_Settings.m_StatsInterval)
+      return;
+
+    m_LastStatsTime = now;
+
+    nsStats::SetStat("JDebug/Capture/Queue Depth", m_pRing->GetCount());
+    nsStats::SetStat("JDebug/Capture/Dropped Frames", GetNumDroppedFrames());
+    nsStats::SetStat("JDebug/Capture/Write Latency", m_MaxWriteLatency);
+
+    // the latency is reported as the maximum over one interval, spikes are what matters
+    m_MaxWriteLatency = nsTime::MakeZero();
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHCaptureWriter);
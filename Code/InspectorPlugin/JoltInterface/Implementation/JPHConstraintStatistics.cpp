@@ -0,0 +1,545 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHConstraintStatistics.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/Constraints/ConeConstraint.h>
+#include <Jolt/Physics/Constraints/DistanceConstraint.h>
+#include <Jolt/Physics/Constraints/FixedConstraint.h>
+#include <Jolt/Physics/Constraints/GearConstraint.h>
+#include <Jolt/Physics/Constraints/HingeConstraint.h>
+#include <Jolt/Physics/Constraints/PathConstraint.h>
+#include <Jolt/Physics/Constraints/PointConstraint.h>
+#include <Jolt/Physics/Constraints/PulleyConstraint.h>
+#include <Jolt/Physics/Constraints/RackAndPinionConstraint.h>
+#include <Jolt/Physics/Constraints/SixDOFConstraint.h>
+#include <Jolt/Physics/Constraints/SliderConstraint.h>
+#include <Jolt/Physics/Constraints/SwingTwistConstraint.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Vehicle/VehicleConstraint.h>
+
+namespace JPHConstraintStatisticsDetail
+{
+  using JPHConstraintDiagnostics = JDebug::API::JPHConstraintDiagnostics;
+  using JPHConstraintStressMetric = JDebug::API::JPHConstraintStressMetric;
+
+  /// Number of constraints measured by a single task.
+  static constexpr nsUInt32 s_uiConstraintsPerChunk = 1024;
+
+  static constexpr const char* s_szMetricNames[JPHConstraintStressMetric::ENUM_COUNT] = {"Linear Impulse", "Angular Impulse", "Position Error"};
+
+  /// Shared by all measuring tasks, kept in one struct so the lambda stays small enough for the delegate's inline storage.
+  struct CollectContext
+  {
+    const JPH::Constraints* m_pConstraints = nullptr;
+    const JPH::PhysicsSettings* m_pSettings = nullptr;
+    JPHConstraintDiagnostics* m_pRanked = nullptr;
+    nsUInt32 m_uiMaxRanked = 0;
+    JPHConstraintStressMetric::Enum m_eMetric = JPHConstraintStressMetric::Default;
+  };
+
+  /// Sums up the squared lambdas of the parts of a constraint.
+  struct LambdaSum
+  {
+    float m_fLinearSq = 0.0f;
+    float m_fAngularSq = 0.0f;
+
+    void AddLinear(float fLambda) { m_fLinearSq += fLambda * fLambda; }
+    void AddLinear(JPH::Vec3Arg vLambda) { m_fLinearSq += vLambda.LengthSq(); }
+    void AddLinear(const JPH::Vector<2>& vLambda) { m_fLinearSq += vLambda.LengthSq(); }
+    void AddAngular(float fLambda) { m_fAngularSq += fLambda * fLambda; }
+    void AddAngular(JPH::Vec3Arg vLambda) { m_fAngularSq += vLambda.LengthSq(); }
+    void AddAngular(const JPH::Vector<2>& vLambda) { m_fAngularSq += vLambda.LengthSq(); }
+  };
+
+  /// Returns whether a is ranked before b. Ties are broken by the constraint index, so the ranking does not depend on the chunking.
+  static bool IsRankedBefore(const JPHConstraintDiagnostics& a, const JPHConstraintDiagnostics& b, JPHConstraintStressMetric::Enum eMetric)
+  {
+    const float fStressA = a.GetStress(eMetric);
+    const float fStressB = b.GetStress(eMetric);
+
+    if (fStressA != fStressB)
+      return fStressA > fStressB;
+
+    return a.m_uiConstraintIndex < b.m_uiConstraintIndex;
+  }
+
+  /// Inserts into a shortlist that is sorted by IsRankedBefore() and holds at most uiMaxRanked entries.
+  static void InsertRanked(JPHConstraintDiagnostics* pRanked, nsUInt32& inout_uiNumRanked, nsUInt32 uiMaxRanked, const JPHConstraintDiagnostics& diagnostics, JPHConstraintStressMetric::Enum eMetric)
+  {
+    // once the list is full, almost every constraint is rejected by this single comparison
+    if (inout_uiNumRanked == uiMaxRanked && !IsRankedBefore(diagnostics, pRanked[uiMaxRanked - 1], eMetric))
+      return;
+
+    nsUInt32 uiPos = nsMath::Min(inout_uiNumRanked, uiMaxRanked - 1);
+
+    while (uiPos > 0 && IsRankedBefore(diagnostics, pRanked[uiPos - 1], eMetric))
+    {
+      pRanked[uiPos] = pRanked[uiPos - 1];
+      --uiPos;
+    }
+
+    pRanked[uiPos] = diagnostics;
+    inout_uiNumRanked = nsMath::Min(inout_uiNumRanked + 1, uiMaxRanked);
+  }
+
+  static JPH::Vec3 GetAnchorDelta(const JPH::TwoBodyConstraint& constraint)
+  {
+    const JPH::RVec3 vAnchor1 = constraint.GetBody1()->GetCenterOfMassTransform() * constraint.GetConstraintToBody1Matrix().GetTranslation();
+    const JPH::RVec3 vAnchor2 = constraint.GetBody2()->GetCenterOfMassTransform() * constraint.GetConstraintToBody2Matrix().GetTranslation();
+    return JPH::Vec3(vAnchor2 - vAnchor1);
+  }
+
+  /// The rotation from constraint space to world space, as seen from body 1.
+  static JPH::Mat44 GetConstraintRotation1(const JPH::TwoBodyConstraint& constraint)
+  {
+    return constraint.GetBody1()->GetCenterOfMassTransform().GetRotation().Multiply3x3(constraint.GetConstraintToBody1Matrix());
+  }
+
+  /// Measures the lambdas and the position error of the known constraint types.
+  static void MeasureType(const JPH::Constraint& constraint, LambdaSum& ref_lambdas, float& out_fPositionError)
+  {
+    switch (constraint.GetSubType())
+    {
+      case JPH::EConstraintSubType::Fixed:
+      {
+        const JPH::FixedConstraint& fixed = static_cast<const JPH::FixedConstraint&>(constraint);
+        ref_lambdas.AddLinear(fixed.GetTotalLambdaPosition());
+        ref_lambdas.AddAngular(fixed.GetTotalLambdaRotation());
+        out_fPositionError = GetAnchorDelta(fixed).Length();
+        break;
+      }
+
+      case JPH::EConstraintSubType::Point:
+      {
+        const JPH::PointConstraint& point = static_cast<const JPH::PointConstraint&>(constraint);
+        ref_lambdas.AddLinear(point.GetTotalLambdaPosition());
+        out_fPositionError = GetAnchorDelta(point).Length();
+        break;
+      }
+
+      case JPH::EConstraintSubType::Hinge:
+      {
+        const JPH::HingeConstraint& hinge = static_cast<const JPH::HingeConstraint&>(constraint);
+        ref_lambdas.AddLinear(hinge.GetTotalLambdaPosition());
+        ref_lambdas.AddAngular(hinge.GetTotalLambdaRotation());
+        ref_lambdas.AddAngular(hinge.GetTotalLambdaRotationLimits());
+        ref_lambdas.AddAngular(hinge.GetTotalLambdaMotor());
+        out_fPositionError = GetAnchorDelta(hinge).Length();
+        break;
+      }
+
+      case JPH::EConstraintSubType::Slider:
+      {
+        const JPH::SliderConstraint& slider = static_cast<const JPH::SliderConstraint&>(constraint);
+        ref_lambdas.AddLinear(slider.GetTotalLambdaPosition());
+        ref_lambdas.AddLinear(slider.GetTotalLambdaPositionLimits());
+        ref_lambdas.AddLinear(slider.GetTotalLambdaMotor());
+        ref_lambdas.AddAngular(slider.GetTotalLambdaRotation());
+
+        // the bodies may move along the slider axis, the error is the offset perpendicular to it
+        const JPH::Vec3 vDelta = GetAnchorDelta(slider);
+        const JPH::Vec3 vAxis = GetConstraintRotation1(slider).GetAxisX();
+        out_fPositionError = (vDelta - vAxis * vAxis.Dot(vDelta)).Length();
+        break;
+      }
+
+      case JPH::EConstraintSubType::Distance:
+      {
+        const JPH::DistanceConstraint& distance = static_cast<const JPH::DistanceConstraint&>(constraint);
+        ref_lambdas.AddLinear(distance.GetTotalLambdaPosition());
+
+        const float fDistance = GetAnchorDelta(distance).Length();
+        out_fPositionError = nsMath::Max(nsMath::Max(distance.GetMinDistance() - fDistance, fDistance - distance.GetMaxDistance()), 0.0f);
+        break;
+      }
+
+      case JPH::EConstraintSubType::Cone:
+      {
+        const JPH::ConeConstraint& cone = static_cast<const JPH::ConeConstraint&>(constraint);
+        ref_lambdas.AddLinear(cone.GetTotalLambdaPosition());
+        ref_lambdas.AddAngular(cone.GetTotalLambdaRotation());
+        out_fPositionError = GetAnchorDelta(cone).Length();
+        break;
+      }
+
+      case JPH::EConstraintSubType::SwingTwist:
+      {
+        const JPH::SwingTwistConstraint& swingTwist = static_cast<const JPH::SwingTwistConstraint&>(constraint);
+        ref_lambdas.AddLinear(swingTwist.GetTotalLambdaPosition());
+        ref_lambdas.AddAngular(swingTwist.GetTotalLambdaTwist());
+        ref_lambdas.AddAngular(swingTwist.GetTotalLambdaSwingY());
+        ref_lambdas.AddAngular(swingTwist.GetTotalLambdaSwingZ());
+        ref_lambdas.AddAngular(swingTwist.GetTotalLambdaMotor());
+        out_fPositionError = GetAnchorDelta(swingTwist).Length();
+        break;
+      }
+
+      case JPH::EConstraintSubType::SixDOF:
+      {
+        const JPH::SixDOFConstraint& sixDOF = static_cast<const JPH::SixDOFConstraint&>(constraint);
+        ref_lambdas.AddLinear(sixDOF.GetTotalLambdaPosition());
+        ref_lambdas.AddLinear(sixDOF.GetTotalLambdaMotorTranslation());
+        ref_lambdas.AddAngular(sixDOF.GetTotalLambdaRotation());
+        ref_lambdas.AddAngular(sixDOF.GetTotalLambdaMotorRotation());
+
+        // only the fixed translation axes should have no offset
+        const JPH::Vec3 vDelta = GetConstraintRotation1(sixDOF).Multiply3x3Transposed(GetAnchorDelta(sixDOF));
+        float fErrorSq = 0.0f;
+
+        for (nsUInt32 uiAxis = 0; uiAxis < 3; ++uiAxis)
+        {
+          if (sixDOF.IsFixedAxis(static_cast<JPH::SixDOFConstraint::EAxis>(JPH::SixDOFConstraint::EAxis::TranslationX + uiAxis)))
+            fErrorSq += vDelta[uiAxis] * vDelta[uiAxis];
+        }
+
+        out_fPositionError = nsMath::Sqrt(fErrorSq);
+        break;
+      }
+
+      case JPH::EConstraintSubType::Path:
+      {
+        const JPH::PathConstraint& path = static_cast<const JPH::PathConstraint&>(constraint);
+        ref_lambdas.AddLinear(path.GetTotalLambdaPosition());
+        ref_lambdas.AddLinear(path.GetTotalLambdaPositionLimits());
+        ref_lambdas.AddLinear(path.GetTotalLambdaMotor());
+        ref_lambdas.AddAngular(path.GetTotalLambdaRotationHinge());
+        ref_lambdas.AddAngular(path.GetTotalLambdaRotation());
+        break;
+      }
+
+      case JPH::EConstraintSubType::Vehicle:
+      {
+        const JPH::VehicleConstraint& vehicle = static_cast<const JPH::VehicleConstraint&>(constraint);
+
+        for (const JPH::Wheel* pWheel : vehicle.GetWheels())
+        {
+          ref_lambdas.AddLinear(pWheel->GetSuspensionLambda());
+          ref_lambdas.AddLinear(pWheel->GetLongitudinalLambda());
+          ref_lambdas.AddLinear(pWheel->GetLateralLambda());
+        }
+        break;
+      }
+
+      case JPH::EConstraintSubType::RackAndPinion:
+        ref_lambdas.AddLinear(static_cast<const JPH::RackAndPinionConstraint&>(constraint).GetTotalLambda());
+        break;
+
+      case JPH::EConstraintSubType::Gear:
+        ref_lambdas.AddAngular(static_cast<const JPH::GearConstraint&>(constraint).GetTotalLambda());
+        break;
+
+      case JPH::EConstraintSubType::Pulley:
+        ref_lambdas.AddLinear(static_cast<const JPH::PulleyConstraint&>(constraint).GetTotalLambdaPosition());
+        break;
+
+      default:
+        // user defined constraints are counted, but their lambdas are unknown
+        break;
+    }
+  }
+} // namespace JPHConstraintStatisticsDetail
+
+namespace JDebug::API
+{
+  const char* JPHConstraintStressMetric::GetName(Enum in_eMetric)
+  {
+    return in_eMetric < ENUM_COUNT ? JPHConstraintStatisticsDetail::s_szMetricNames[in_eMetric] : "";
+  }
+
+  float JPHConstraintDiagnostics::GetStress(JPHConstraintStressMetric::Enum in_eMetric) const
+  {
+    switch (in_eMetric)
+    {
+      case JPHConstraintStressMetric::AngularImpulse:
+        return m_fAngularImpulse;
+      case JPHConstraintStressMetric::PositionError:
+        return m_fPositionError;
+      default:
+        return m_fLinearImpulse;
+    }
+  }
+
+  nsUInt32 JPHConstraintStatistics::GetBucket(float in_fStress)
+  {
+    // also catches NaN
+    if (!(in_fStress > 0.0f))
+      return 0;
+
+    nsUInt32 uiBits = 0;
+    nsMemoryUtils::RawByteCopy(&uiBits, &in_fStress, sizeof(float));
+
+    // the exponent of the float is the power of two bucket, denormals end up in the first one and infinity in the last one
+    const nsInt32 iExponent = static_cast<nsInt32>((uiBits >> 23) & 0xFF) - 127;
+    return static_cast<nsUInt32>(nsMath::Clamp<nsInt32>(iExponent - s_iFirstBucketExponent, 0, s_uiNumBuckets - 1));
+  }
+
+  void JPHConstraintStatistics::Write(nsDynamicArray<nsUInt8>& out_data) const
+  {
+    out_data.Clear();
+
+    IO::JPHByteWriter writer(out_data);
+    writer.Write<nsUInt8>(m_eMetric);
+    writer.WriteVarUInt(m_uiNumConstraints);
+    writer.WriteVarUInt(m_uiNumActiveConstraints);
+    writer.Write(m_fMaxStress);
+    writer.Write(m_fTotalStress);
+    writer.Write(m_fMaxPositionError);
+    writer.Write<nsInt8>(s_iFirstBucketExponent);
+    writer.Write<nsUInt8>(s_uiNumBuckets);
+
+    for (nsUInt32 uiCount : m_Histogram)
+    {
+      writer.WriteVarUInt(uiCount);
+    }
+
+    writer.WriteVarUInt(m_Ranked.GetCount());
+
+    for (const JPHConstraintDiagnostics& diagnostics : m_Ranked)
+    {
+      writer.WriteVarUInt(diagnostics.m_uiConstraintIndex);
+      writer.Write(diagnostics.m_uiSubType);
+      writer.Write(diagnostics.m_uiBodyIDs[0]);
+      writer.Write(diagnostics.m_uiBodyIDs[1]);
+      writer.Write(diagnostics.m_uiUserData);
+      writer.Write(diagnostics.m_fLinearImpulse);
+      writer.Write(diagnostics.m_fAngularImpulse);
+      writer.Write(diagnostics.m_fPositionError);
+      writer.WriteVarUInt(diagnostics.m_uiNumVelocitySteps);
+      writer.WriteVarUInt(diagnostics.m_uiNumPositionSteps);
+    }
+  }
+
+  nsResult JPHConstraintStatistics::Read(nsArrayPtr<const nsUInt8> in_data)
+  {
+    *this = JPHConstraintStatistics();
+
+    IO::JPHByteReader reader(in_data);
+    nsUInt64 uiValue = 0;
+
+    auto ReadCount = [&](nsUInt32& out_uiCount)
+    {
+      reader.ReadVarUInt(uiValue);
+      out_uiCount = static_cast<nsUInt32>(uiValue);
+    };
+
+    nsUInt8 uiMetric = 0;
+    reader.Read(uiMetric);
+    m_eMetric = uiMetric < JPHConstraintStressMetric::ENUM_COUNT ? static_cast<JPHConstraintStressMetric::Enum>(uiMetric) : JPHConstraintStressMetric::Default;
+
+    ReadCount(m_uiNumConstraints);
+    ReadCount(m_uiNumActiveConstraints);
+    reader.Read(m_fMaxStress);
+    reader.Read(m_fTotalStress);
+    reader.Read(m_fMaxPositionError);
+
+    nsInt8 iFirstExponent = 0;
+    nsUInt8 uiNumBuckets = 0;
+    reader.Read(iFirstExponent);
+    reader.Read(uiNumBuckets);
+
+    for (nsUInt32 i = 0; i < uiNumBuckets && !reader.HasFailed(); ++i)
+    {
+      nsUInt32 uiCount = 0;
+      ReadCount(uiCount);
+
+      const nsInt32 iBucket = nsMath::Clamp<nsInt32>(iFirstExponent + static_cast<nsInt32>(i) - s_iFirstBucketExponent, 0, s_uiNumBuckets - 1);
+      m_Histogram[iBucket] += uiCount;
+    }
+
+    nsUInt32 uiNumRanked = 0;
+    ReadCount(uiNumRanked);
+
+    // every entry takes at least 32 bytes, don't trust the count before checking it against the data that is actually there
+    if (reader.HasFailed() || static_cast<nsUInt64>(uiNumRanked) * 32 > in_data.GetCount() - reader.GetOffset())
+      return NS_FAILURE;
+
+    m_Ranked.SetCount(uiNumRanked);
+
+    for (JPHConstraintDiagnostics& diagnostics : m_Ranked)
+    {
+      ReadCount(diagnostics.m_uiConstraintIndex);
+      reader.Read(diagnostics.m_uiSubType);
+      reader.Read(diagnostics.m_uiBodyIDs[0]);
+      reader.Read(diagnostics.m_uiBodyIDs[1]);
+      reader.Read(diagnostics.m_uiUserData);
+      reader.Read(diagnostics.m_fLinearImpulse);
+      reader.Read(diagnostics.m_fAngularImpulse);
+      reader.Read(diagnostics.m_fPositionError);
+      ReadCount(diagnostics.m_uiNumVelocitySteps);
+      ReadCount(diagnostics.m_uiNumPositionSteps);
+    }
+
+    return reader.HasFailed() ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  JPHConstraintMonitor::JPHConstraintMonitor() = default;
+  JPHConstraintMonitor::~JPHConstraintMonitor() = default;
+
+  void JPHConstraintMonitor::Measure(const JPH::Constraint& in_constraint, const JPH::PhysicsSettings* in_pSettings, JPHConstraintDiagnostics& out_diagnostics)
+  {
+    out_diagnostics.m_uiBodyIDs[0] = JPH::BodyID::cInvalidBodyID;
+    out_diagnostics.m_uiBodyIDs[1] = JPH::BodyID::cInvalidBodyID;
+    out_diagnostics.m_uiUserData = in_constraint.GetUserData();
+    out_diagnostics.m_uiSubType = static_cast<nsUInt8>(in_constraint.GetSubType());
+
+    const JPH::Body* pBodies[2] = {};
+
+    if (in_constraint.GetType() == JPH::EConstraintType::TwoBodyConstraint)
+    {
+      const JPH::TwoBodyConstraint& twoBody = static_cast<const JPH::TwoBodyConstraint&>(in_constraint);
+      pBodies[0] = twoBody.GetBody1();
+      pBodies[1] = twoBody.GetBody2();
+    }
+    else if (in_constraint.GetSubType() == JPH::EConstraintSubType::Vehicle)
+    {
+      pBodies[0] = static_cast<const JPH::VehicleConstraint&>(in_constraint).GetVehicleBody();
+    }
+
+    // same as JPH::CalculateSolverSteps: the largest override wins, a zero override adds the default to the candidates
+    nsUInt32 uiNumVelocitySteps = in_constraint.GetNumVelocityStepsOverride();
+    nsUInt32 uiNumPositionSteps = in_constraint.GetNumPositionStepsOverride();
+    bool bDefaultVelocitySteps = uiNumVelocitySteps == 0;
+    bool bDefaultPositionSteps = uiNumPositionSteps == 0;
+
+    for (nsUInt32 i = 0; i < 2; ++i)
+    {
+      if (pBodies[i] == nullptr)
+        continue;
+
+      out_diagnostics.m_uiBodyIDs[i] = pBodies[i]->GetID().GetIndexAndSequenceNumber();
+
+      if (pBodies[i]->IsDynamic())
+      {
+        const JPH::MotionProperties* pMotion = pBodies[i]->GetMotionPropertiesUnchecked();
+        uiNumVelocitySteps = nsMath::Max<nsUInt32>(uiNumVelocitySteps, pMotion->GetNumVelocityStepsOverride());
+        uiNumPositionSteps = nsMath::Max<nsUInt32>(uiNumPositionSteps, pMotion->GetNumPositionStepsOverride());
+        bDefaultVelocitySteps |= pMotion->GetNumVelocityStepsOverride() == 0;
+        bDefaultPositionSteps |= pMotion->GetNumPositionStepsOverride() == 0;
+      }
+    }
+
+    if (in_pSettings != nullptr)
+    {
+      if (bDefaultVelocitySteps)
+        uiNumVelocitySteps = nsMath::Max<nsUInt32>(uiNumVelocitySteps, in_pSettings->mNumVelocitySteps);
+      if (bDefaultPositionSteps)
+        uiNumPositionSteps = nsMath::Max<nsUInt32>(uiNumPositionSteps, in_pSettings->mNumPositionSteps);
+    }
+
+    out_diagnostics.m_uiNumVelocitySteps = uiNumVelocitySteps;
+    out_diagnostics.m_uiNumPositionSteps = uiNumPositionSteps;
+
+    JPHConstraintStatisticsDetail::LambdaSum lambdas;
+    out_diagnostics.m_fPositionError = 0.0f;
+    JPHConstraintStatisticsDetail::MeasureType(in_constraint, lambdas, out_diagnostics.m_fPositionError);
+
+    out_diagnostics.m_fLinearImpulse = nsMath::Sqrt(lambdas.m_fLinearSq);
+    out_diagnostics.m_fAngularImpulse = nsMath::Sqrt(lambdas.m_fAngularSq);
+  }
+
+  void JPHConstraintMonitor::Collect(const JPH::PhysicsSystem& in_system, const JPHConstraintMonitorSettings& in_settings, JPHConstraintStatistics& out_statistics)
+  {
+    NS_PROFILE_SCOPE("JPHConstraintMonitor::Collect");
+
+    using namespace JPHConstraintStatisticsDetail;
+
+    in_system.GetConstraints(m_Constraints);
+    const nsUInt32 uiNumConstraints = m_Constraints.size();
+    const nsUInt32 uiNumChunks = (uiNumConstraints + s_uiConstraintsPerChunk - 1) / s_uiConstraintsPerChunk;
+    const nsUInt32 uiMaxRanked = nsMath::Max(in_settings.m_uiMaxRanked, 1u);
+
+    m_ChunkResults.Clear();
+    m_ChunkResults.SetCount(uiNumChunks);
+    m_Ranked.SetCount(uiNumChunks * uiMaxRanked);
+
+    CollectContext context;
+    context.m_pConstraints = &m_Constraints;
+    context.m_pSettings = &in_system.GetPhysicsSettings();
+    context.m_pRanked = m_Ranked.GetData();
+    context.m_uiMaxRanked = uiMaxRanked;
+    context.m_eMetric = in_settings.m_eMetric;
+
+    nsParallelForParams params;
+    params.m_uiBinSize = 1;
+    params.m_uiMaxTasksPerThread = 2;
+
+    nsTaskSystem::ParallelForIndexed(
+      0, uiNumChunks, [this, &context](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+      {
+        const JPH::Constraints& constraints = *context.m_pConstraints;
+
+        for (nsUInt32 uiChunk = uiStartIndex; uiChunk < uiEndIndex; ++uiChunk)
+        {
+          ChunkResult& result = m_ChunkResults[uiChunk];
+          JPHConstraintDiagnostics* pRanked = context.m_pRanked + uiChunk * context.m_uiMaxRanked;
+
+          const nsUInt32 uiFirst = uiChunk * s_uiConstraintsPerChunk;
+          const nsUInt32 uiEnd = nsMath::Min<nsUInt32>(uiFirst + s_uiConstraintsPerChunk, static_cast<nsUInt32>(constraints.size()));
+
+          for (nsUInt32 i = uiFirst; i < uiEnd; ++i)
+          {
+            const JPH::Constraint& constraint = *constraints[i];
+
+            // inactive constraints keep the lambdas of the last step they were solved in
+            if (!constraint.IsActive())
+              continue;
+
+            JPHConstraintDiagnostics diagnostics;
+            diagnostics.m_uiConstraintIndex = i;
+            Measure(constraint, context.m_pSettings, diagnostics);
+
+            const float fStress = diagnostics.GetStress(context.m_eMetric);
+            ++result.m_uiNumActive;
+            ++result.m_Histogram[JPHConstraintStatistics::GetBucket(fStress)];
+            result.m_fMaxStress = nsMath::Max(result.m_fMaxStress, fStress);
+            result.m_fTotalStress += fStress;
+            result.m_fMaxPositionError = nsMath::Max(result.m_fMaxPositionError, diagnostics.m_fPositionError);
+
+            InsertRanked(pRanked, result.m_uiNumRanked, context.m_uiMaxRanked, diagnostics, context.m_eMetric);
+          }
+        }
+      },
+      "JoltConstraintMonitor", nsTaskNesting::Never, params);
+
+    // keeps the storage, but a constraint that is removed from the system must not stay alive until the next step
+    m_Constraints.clear();
+
+    out_statistics.m_eMetric = in_settings.m_eMetric;
+    out_statistics.m_uiNumConstraints = uiNumConstraints;
+    out_statistics.m_uiNumActiveConstraints = 0;
+    out_statistics.m_fMaxStress = 0.0f;
+    out_statistics.m_fTotalStress = 0.0f;
+    out_statistics.m_fMaxPositionError = 0.0f;
+    nsMemoryUtils::ZeroFillArray(out_statistics.m_Histogram);
+    out_statistics.m_Ranked.Clear();
+
+    for (nsUInt32 uiChunk = 0; uiChunk < uiNumChunks; ++uiChunk)
+    {
+      const ChunkResult& result = m_ChunkResults[uiChunk];
+      out_statistics.m_uiNumActiveConstraints += result.m_uiNumActive;
+      out_statistics.m_fMaxStress = nsMath::Max(out_statistics.m_fMaxStress, result.m_fMaxStress);
+      out_statistics.m_fTotalStress += result.m_fTotalStress;
+      out_statistics.m_fMaxPositionError = nsMath::Max(out_statistics.m_fMaxPositionError, result.m_fMaxPositionError);
+
+      for (nsUInt32 uiBucket = 0; uiBucket < JPHConstraintStatistics::s_uiNumBuckets; ++uiBucket)
+      {
+        out_statistics.m_Histogram[uiBucket] += result.m_Histogram[uiBucket];
+      }
+
+      out_statistics.m_Ranked.PushBackRange(nsArrayPtr<const JPHConstraintDiagnostics>(m_Ranked.GetData() + uiChunk * uiMaxRanked, result.m_uiNumRanked));
+    }
+
+    // at most uiMaxRanked entries per chunk, so this stays small even with many constraints
+    const JPHConstraintStressMetric::Enum eMetric = in_settings.m_eMetric;
+    out_statistics.m_Ranked.Sort([eMetric](const JPHConstraintDiagnostics& a, const JPHConstraintDiagnostics& b)
+      { return IsRankedBefore(a, b, eMetric); });
+
+    if (out_statistics.m_Ranked.GetCount() > uiMaxRanked)
+      out_statistics.m_Ranked.SetCount(uiMaxRanked);
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHConstraintStatistics);
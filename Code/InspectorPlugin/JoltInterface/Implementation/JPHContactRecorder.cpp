@@ -0,0 +1,355 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHContactRecorder.h>
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JPHContactRecorderDetail
+{
+  /// Source of JPHContactRecorder::m_uiRecorderID, 0 is never handed out.
+  static nsAtomicInteger32 s_iNextRecorderID;
+
+  /// The buffer the current thread used last, valid as long as the recorder ID matches.
+  struct ThreadCache
+  {
+    nsUInt32 m_uiRecorderID = 0;
+    void* m_pBuffer = nullptr;
+  };
+
+  static thread_local ThreadCache t_Cache;
+
+  static nsVec3 ToVec3(JPH::Vec3Arg v)
+  {
+    return nsVec3(v.GetX(), v.GetY(), v.GetZ());
+  }
+
+  /// Orders contacts by body pair, so the merged result does not depend on which thread reported what.
+  static bool IsLessByPair(const JDebug::API::JPHContactRecord& a, const JDebug::API::JPHContactRecord& b)
+  {
+    if (a.m_uiBodyID1 != b.m_uiBodyID1)
+      return a.m_uiBodyID1 < b.m_uiBodyID1;
+    if (a.m_uiBodyID2 != b.m_uiBodyID2)
+      return a.m_uiBodyID2 < b.m_uiBodyID2;
+    if (a.m_uiSubShapeID1 != b.m_uiSubShapeID1)
+      return a.m_uiSubShapeID1 < b.m_uiSubShapeID1;
+    if (a.m_uiSubShapeID2 != b.m_uiSubShapeID2)
+      return a.m_uiSubShapeID2 < b.m_uiSubShapeID2;
+
+    return a.m_eEvent < b.m_eEvent;
+  }
+
+  static float GetInverseMass(const JPH::Body& body)
+  {
+    return body.IsDynamic() ? body.GetMotionPropertiesUnchecked()->GetInverseMass() : 0.0f;
+  }
+} // namespace JPHContactRecorderDetail
+
+namespace JDebug::API
+{
+  JPHContactRecorder::JPHContactRecorder()
+  {
+    m_uiRecorderID = static_cast<nsUInt32>(JPHContactRecorderDetail::s_iNextRecorderID.Increment());
+  }
+
+  JPHContactRecorder::~JPHContactRecorder()
+  {
+    Detach();
+  }
+
+  void JPHContactRecorder::Attach(JPH::PhysicsSystem& inout_system)
+  {
+    Detach();
+
+    m_pChainedListener = inout_system.GetContactListener();
+    m_pAttachedSystem = &inout_system;
+    inout_system.SetContactListener(this);
+  }
+
+  void JPHContactRecorder::Detach()
+  {
+    if (m_pAttachedSystem == nullptr)
+      return;
+
+    // only restore the previous listener if nobody replaced the recorder in the meantime
+    if (m_pAttachedSystem->GetContactListener() == this)
+    {
+      m_pAttachedSystem->SetContactListener(m_pChainedListener);
+    }
+
+    m_pAttachedSystem = nullptr;
+  }
+
+  JPH::ValidateResult JPHContactRecorder::OnContactValidate(const JPH::Body& inBody1, const JPH::Body& inBody2, JPH::RVec3Arg inBaseOffset, const JPH::CollideShapeResult& inCollisionResult)
+  {
+    if (m_pChainedListener != nullptr)
+      return m_pChainedListener->OnContactValidate(inBody1, inBody2, inBaseOffset, inCollisionResult);
+
+    return JPH::ValidateResult::AcceptAllContactsForThisBodyPair;
+  }
+
+  void JPHContactRecorder::OnContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings)
+  {
+    // the chained listener may change the settings, record what Jolt is going to use
+    if (m_pChainedListener != nullptr)
+      m_pChainedListener->OnContactAdded(inBody1, inBody2, inManifold, ioSettings);
+
+    CountManifold(inBody1, inBody2, ioSettings);
+
+    if (m_bRecording)
+      RecordManifold(inBody1, inBody2, inManifold, ioSettings, JPHContactEvent::Added);
+  }
+
+  void JPHContactRecorder::OnContactPersisted(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings)
+  {
+    if (m_pChainedListener != nullptr)
+      m_pChainedListener->OnContactPersisted(inBody1, inBody2, inManifold, ioSettings);
+
+    CountManifold(inBody1, inBody2, ioSettings);
+
+    if (m_bRecording && m_Settings.m_bRecordPersisted)
+      RecordManifold(inBody1, inBody2, inManifold, ioSettings, JPHContactEvent::Persisted);
+  }
+
+  void JPHContactRecorder::OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair)
+  {
+    if (m_pChainedListener != nullptr)
+      m_pChainedListener->OnContactRemoved(inSubShapePair);
+
+    if (!m_bRecording)
+      return;
+
+    JPHContactRecord& contact = GetThreadBuffer().m_Contacts.ExpandAndGetRef();
+    contact.m_uiBodyID1 = inSubShapePair.GetBody1ID().GetIndexAndSequenceNumber();
+    contact.m_uiBodyID2 = inSubShapePair.GetBody2ID().GetIndexAndSequenceNumber();
+    contact.m_uiSubShapeID1 = inSubShapePair.GetSubShapeID1().GetValue();
+    contact.m_uiSubShapeID2 = inSubShapePair.GetSubShapeID2().GetValue();
+    contact.m_vNormal.SetZero();
+    contact.m_fPenetration = 0.0f;
+    contact.m_fImpulse = 0.0f;
+    contact.m_eEvent = JPHContactEvent::Removed;
+    contact.m_uiFlags = 0;
+    contact.m_uiNumPoints = 0;
+  }
+
+  void JPHContactRecorder::CountManifold(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactSettings& settings)
+  {
+    ThreadBuffer& buffer = GetThreadBuffer();
+
+    // a body never collides with itself, so the initial 0 does not match any pair
+    const nsUInt64 uiPair = (static_cast<nsUInt64>(body1.GetID().GetIndexAndSequenceNumber()) << 32) | body2.GetID().GetIndexAndSequenceNumber();
+
+    if (uiPair != buffer.m_uiLastBodyPair)
+    {
+      buffer.m_uiLastBodyPair = uiPair;
+      ++buffer.m_uiNumBodyPairs;
+    }
+
+    // sensor contacts do not create a contact constraint
+    if (!settings.mIsSensor)
+      ++buffer.m_uiNumManifolds;
+  }
+
+  void JPHContactRecorder::RecordManifold(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, const JPH::ContactSettings& settings, JPHContactEvent eEvent)
+  {
+    using namespace JPHContactRecorderDetail;
+
+    JPHContactRecord& contact = GetThreadBuffer().m_Contacts.ExpandAndGetRef();
+    contact.m_uiBodyID1 = body1.GetID().GetIndexAndSequenceNumber();
+    contact.m_uiBodyID2 = body2.GetID().GetIndexAndSequenceNumber();
+    contact.m_uiSubShapeID1 = manifold.mSubShapeID1.GetValue();
+    contact.m_uiSubShapeID2 = manifold.mSubShapeID2.GetValue();
+    contact.m_vNormal = ToVec3(manifold.mWorldSpaceNormal);
+    contact.m_fPenetration = manifold.mPenetrationDepth;
+    contact.m_eEvent = eEvent;
+    contact.m_uiFlags = 0;
+    contact.m_uiFlags |= settings.mIsSensor ? JPHContactRecord::Sensor : 0;
+    contact.m_uiFlags |= manifold.mPenetrationDepth < 0.0f ? JPHContactRecord::Speculative : 0;
+    contact.m_uiNumPoints = static_cast<nsUInt8>(nsMath::Min<nsUInt32>(manifold.mRelativeContactPointsOn1.size(), JPHContactRecord::s_uiMaxPoints));
+
+    // effective mass of the pair along the normal, ignoring rotation
+    const float fInvMassSum = GetInverseMass(body1) + GetInverseMass(body2);
+    const float fEffectiveMass = fInvMassSum > 0.0f ? 1.0f / fInvMassSum : 0.0f;
+
+    float fMaxApproachSpeed = 0.0f;
+
+    for (nsUInt32 i = 0; i < contact.m_uiNumPoints; ++i)
+    {
+      const JPH::RVec3 vPoint1 = manifold.GetWorldSpaceContactPointOn1(i);
+      const JPH::RVec3 vPoint2 = manifold.GetWorldSpaceContactPointOn2(i);
+      const JPH::RVec3 vPoint = 0.5f * (vPoint1 + vPoint2);
+
+      contact.m_vPoints[i].Set(static_cast<float>(vPoint.GetX()), static_cast<float>(vPoint.GetY()), static_cast<float>(vPoint.GetZ()));
+
+      // the normal points from body 1 to body 2, a negative relative speed means the bodies move into each other
+      const JPH::Vec3 vRelativeVelocity = body2.GetPointVelocity(vPoint) - body1.GetPointVelocity(vPoint);
+      fMaxApproachSpeed = nsMath::Max(fMaxApproachSpeed, -vRelativeVelocity.Dot(manifold.mWorldSpaceNormal));
+    }
+
+    contact.m_fImpulse = settings.mIsSensor ? 0.0f : fMaxApproachSpeed * fEffectiveMass;
+  }
+
+  JPHContactRecorder::ThreadBuffer& JPHContactRecorder::GetThreadBuffer()
+  {
+    using namespace JPHContactRecorderDetail;
+
+    if (t_Cache.m_uiRecorderID == m_uiRecorderID)
+      return *static_cast<ThreadBuffer*>(t_Cache.m_pBuffer);
+
+    // first contact of this thread, or the thread recorded for another recorder in between
+    const nsThreadID threadID = nsThreadUtils::GetCurrentThreadID();
+
+    ThreadBuffer* pBuffer = nullptr;
+
+    {
+      NS_LOCK(m_BufferMutex);
+
+      for (nsUniquePtr<ThreadBuffer>& pExisting : m_Buffers)
+      {
+        if (pExisting->m_ThreadID == threadID)
+        {
+          pBuffer = pExisting.Borrow();
+          break;
+        }
+      }
+
+      if (pBuffer == nullptr)
+      {
+        m_Buffers.PushBack(NS_DEFAULT_NEW(ThreadBuffer));
+        pBuffer = m_Buffers.PeekBack().Borrow();
+        pBuffer->m_ThreadID = threadID;
+      }
+    }
+
+    t_Cache.m_uiRecorderID = m_uiRecorderID;
+    t_Cache.m_pBuffer = pBuffer;
+    return *pBuffer;
+  }
+
+  void JPHContactRecorder::CollectContacts()
+  {
+    NS_PROFILE_SCOPE("JPHContactRecorder::CollectContacts");
+
+    m_Contacts.Clear();
+    m_uiNumDroppedContacts = 0;
+    m_uiNumBodyPairs = 0;
+    m_uiNumContactConstraints = 0;
+
+    // no thread can add a buffer while the physics system is not updated, the lock is only taken for consistency
+    NS_LOCK(m_BufferMutex);
+
+    nsUInt32 uiTotalCount = 0;
+    for (const nsUniquePtr<ThreadBuffer>& pBuffer : m_Buffers)
+    {
+      uiTotalCount += pBuffer->m_Contacts.GetCount();
+      m_uiNumBodyPairs += pBuffer->m_uiNumBodyPairs;
+      m_uiNumContactConstraints += pBuffer->m_uiNumManifolds;
+      pBuffer->m_uiLastBodyPair = 0;
+      pBuffer->m_uiNumBodyPairs = 0;
+      pBuffer->m_uiNumManifolds = 0;
+    }
+
+    m_Contacts.Reserve(uiTotalCount);
+
+    for (nsUniquePtr<ThreadBuffer>& pBuffer : m_Buffers)
+    {
+      m_Contacts.PushBackRange(pBuffer->m_Contacts);
+
+      // keeps the capacity, so a thread does not allocate anymore once the contact count is stable
+      pBuffer->m_Contacts.Clear();
+    }
+
+    if (m_Settings.m_uiMaxContacts > 0 && m_Contacts.GetCount() > m_Settings.m_uiMaxContacts)
+    {
+      // equal impulses are ordered by pair, so the selection does not depend on the thread scheduling either
+      m_Contacts.Sort([](const JPHContactRecord& a, const JPHContactRecord& b)
+        {
+          if (a.m_fImpulse != b.m_fImpulse)
+            return a.m_fImpulse > b.m_fImpulse;
+
+          return JPHContactRecorderDetail::IsLessByPair(a, b);
+        });
+
+      m_uiNumDroppedContacts = m_Contacts.GetCount() - m_Settings.m_uiMaxContacts;
+      m_Contacts.SetCount(m_Settings.m_uiMaxContacts);
+    }
+
+    m_Contacts.Sort(&JPHContactRecorderDetail::IsLessByPair);
+  }
+
+  void JPHContactRecorder::WriteContacts(nsArrayPtr<const JPHContactRecord> in_contacts, nsUInt32 in_uiNumDropped, nsDynamicArray<nsUInt8>& out_data)
+  {
+    out_data.Clear();
+
+    IO::JPHByteWriter writer(out_data);
+    writer.Write<nsUInt32>(in_contacts.GetCount());
+    writer.Write<nsUInt32>(in_uiNumDropped);
+
+    for (const JPHContactRecord& contact : in_contacts)
+    {
+      writer.Write(contact.m_uiBodyID1);
+      writer.Write(contact.m_uiBodyID2);
+      writer.Write(contact.m_uiSubShapeID1);
+      writer.Write(contact.m_uiSubShapeID2);
+      writer.Write(contact.m_eEvent);
+      writer.Write(contact.m_uiFlags);
+      writer.Write(contact.m_uiNumPoints);
+
+      if (contact.m_eEvent == JPHContactEvent::Removed)
+        continue;
+
+      writer.Write(contact.m_vNormal);
+      writer.Write(contact.m_fPenetration);
+      writer.Write(contact.m_fImpulse);
+      writer.WriteBytes(contact.m_vPoints, contact.m_uiNumPoints * sizeof(nsVec3));
+    }
+  }
+
+  nsResult JPHContactRecorder::ReadContacts(nsArrayPtr<const nsUInt8> in_data, nsDynamicArray<JPHContactRecord>& out_contacts, nsUInt32& out_uiNumDropped)
+  {
+    out_contacts.Clear();
+
+    IO::JPHByteReader reader(in_data);
+
+    nsUInt32 uiCount = 0;
+    reader.Read(uiCount);
+    reader.Read(out_uiNumDropped);
+
+    if (reader.HasFailed())
+      return NS_FAILURE;
+
+    for (nsUInt32 i = 0; i < uiCount; ++i)
+    {
+      JPHContactRecord& contact = out_contacts.ExpandAndGetRef();
+      reader.Read(contact.m_uiBodyID1);
+      reader.Read(contact.m_uiBodyID2);
+      reader.Read(contact.m_uiSubShapeID1);
+      reader.Read(contact.m_uiSubShapeID2);
+      reader.Read(contact.m_eEvent);
+      reader.Read(contact.m_uiFlags);
+      reader.Read(contact.m_uiNumPoints);
+
+      if (reader.HasFailed() || contact.m_uiNumPoints > JPHContactRecord::s_uiMaxPoints || contact.m_eEvent > JPHContactEvent::Removed)
+        return NS_FAILURE;
+
+      if (contact.m_eEvent == JPHContactEvent::Removed)
+      {
+        contact.m_vNormal.SetZero();
+        contact.m_uiNumPoints = 0;
+        continue;
+      }
+
+      reader.Read(contact.m_vNormal);
+      reader.Read(contact.m_fPenetration);
+      reader.Read(contact.m_fImpulse);
+      reader.ReadBytes(contact.m_vPoints, contact.m_uiNumPoints * sizeof(nsVec3));
+
+      if (reader.HasFailed())
+        return NS_FAILURE;
+    }
+
+    return NS_SUCCESS;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHContactRecorder);
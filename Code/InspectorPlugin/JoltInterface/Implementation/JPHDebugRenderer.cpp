@@ -0,0 +1,623 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHDebugRenderer.h>
+
+namespace JPHDebugRendererDetail
+{
+  using namespace JDebug::API;
+
+  static nsVec3 ToVec3(JPH::RVec3Arg v)
+  {
+    return nsVec3(static_cast<float>(v.GetX()), static_cast<float>(v.GetY()), static_cast<float>(v.GetZ()));
+  }
+
+  static nsInt8 PackNormal(float f)
+  {
+    return static_cast<nsInt8>(nsMath::Clamp(nsMath::Round(f * 127.0f), -127.0f, 127.0f));
+  }
+
+  /// Serializes a batch without its ID. Without indices, the vertices are drawn in order.
+  static void WriteBatch(nsDynamicArray<nsUInt8>& out_data, const JPH::DebugRenderer::Vertex* pVertices, nsUInt32 uiNumVertices, const JPH::uint32* pIndices, nsUInt32 uiNumIndices)
+  {
+    IO::JPHByteWriter writer(out_data);
+    writer.WriteVarUInt(uiNumVertices);
+    writer.WriteVarUInt(uiNumIndices);
+
+    for (nsUInt32 i = 0; i < uiNumVertices; ++i)
+    {
+      const JPH::DebugRenderer::Vertex& vertex = pVertices[i];
+      writer.Write(nsVec3(vertex.mPosition.x, vertex.mPosition.y, vertex.mPosition.z));
+
+      const nsInt8 normal[3] = {PackNormal(vertex.mNormal.x), PackNormal(vertex.mNormal.y), PackNormal(vertex.mNormal.z)};
+      writer.WriteBytes(normal, sizeof(normal));
+      writer.Write<nsUInt32>(vertex.mColor.GetUInt32());
+    }
+
+    // neighboring triangles share vertices, so the deltas are small
+    nsInt64 iPrevIndex = 0;
+
+    for (nsUInt32 i = 0; i < uiNumIndices; ++i)
+    {
+      const nsInt64 iIndex = pIndices != nullptr ? static_cast<nsInt64>(pIndices[i]) : static_cast<nsInt64>(i);
+      writer.WriteVarInt(iIndex - iPrevIndex);
+      iPrevIndex = iIndex;
+    }
+  }
+
+  static bool ReadPoints(IO::JPHByteReader& reader, nsUInt32 uiDataSize, nsDynamicArray<nsVec3>& out_points)
+  {
+    nsUInt64 uiNumPoints = 0;
+    if (!reader.ReadVarUInt(uiNumPoints) || uiNumPoints * sizeof(nsVec3) > uiDataSize)
+      return false;
+
+    out_points.SetCountUninitialized(static_cast<nsUInt32>(uiNumPoints));
+    return reader.ReadBytes(out_points.GetData(), out_points.GetCount() * sizeof(nsVec3));
+  }
+
+  /// Reads the lines or triangles of a frame. Colors that are not in the frame are removed, unchanged ones are kept.
+  static bool ReadColorLists(IO::JPHByteReader& reader, nsUInt32 uiDataSize, nsHashTable<nsUInt32, nsDynamicArray<nsVec3>>& inout_lists)
+  {
+    nsUInt64 uiNumColors = 0;
+    if (!reader.ReadVarUInt(uiNumColors) || uiNumColors > uiDataSize)
+      return false;
+
+    nsHashTable<nsUInt32, nsDynamicArray<nsVec3>> lists;
+    lists.Reserve(static_cast<nsUInt32>(uiNumColors));
+
+    for (nsUInt64 i = 0; i < uiNumColors; ++i)
+    {
+      nsUInt32 uiColor = 0;
+      nsUInt8 uiUnchanged = 0;
+      if (!reader.Read(uiColor) || !reader.Read(uiUnchanged))
+        return false;
+
+      nsDynamicArray<nsVec3>& points = lists[uiColor];
+
+      if (uiUnchanged != 0)
+      {
+        nsDynamicArray<nsVec3>* pPrevPoints = inout_lists.GetValue(uiColor);
+        if (pPrevPoints == nullptr)
+          return false;
+
+        points.Swap(*pPrevPoints);
+      }
+      else if (!ReadPoints(reader, uiDataSize, points))
+      {
+        return false;
+      }
+    }
+
+    inout_lists.Swap(lists);
+    return true;
+  }
+} // namespace JPHDebugRendererDetail
+
+namespace JDebug::API
+{
+#ifdef JPH_DEBUG_RENDERER
+
+  /// The serialized batches. Shared with the batch handles, since Jolt caches some batches in shapes that can outlive the renderer.
+  struct JPHDebugRenderer::BatchRegistry : public JPH::RefTarget<BatchRegistry>
+  {
+    JPH_OVERRIDE_NEW_DELETE
+
+    struct Entry
+    {
+      nsDynamicArray<nsUInt8> m_Data;
+      bool m_bSent = false;
+    };
+
+    nsUInt32 Add(nsDynamicArray<nsUInt8>& inout_data)
+    {
+      NS_LOCK(m_Mutex);
+
+      const nsUInt32 uiID = m_uiNextID++;
+      m_Batches[uiID].m_Data.Swap(inout_data);
+      m_PendingIDs.PushBack(uiID);
+      return uiID;
+    }
+
+    void Remove(nsUInt32 uiID)
+    {
+      NS_LOCK(m_Mutex);
+
+      Entry entry;
+      if (!m_Batches.Remove(uiID, &entry))
+        return;
+
+      if (entry.m_bSent)
+        m_RemovedIDs.PushBack(uiID);
+      else
+        m_PendingIDs.RemoveAndCopy(uiID);
+    }
+
+    nsMutex m_Mutex;
+    nsUInt32 m_uiNextID = 0;
+    nsHashTable<nsUInt32, Entry> m_Batches;
+    nsDynamicArray<nsUInt32> m_PendingIDs; ///< Batches that were created but not sent yet.
+    nsDynamicArray<nsUInt32> m_RemovedIDs; ///< Sent batches that were destroyed since the last frame.
+  };
+
+  /// What Jolt keeps of a batch, only its ID.
+  class JPHDebugRenderer::BatchHandle : public JPH::RefTargetVirtual
+  {
+  public:
+    JPH_OVERRIDE_NEW_DELETE
+
+    BatchHandle(BatchRegistry* pRegistry, nsUInt32 uiID)
+      : m_pRegistry(pRegistry)
+      , m_uiID(uiID)
+    {
+    }
+
+    ~BatchHandle() { m_pRegistry->Remove(m_uiID); }
+
+    virtual void AddRef() override { m_iRefCount.Increment(); }
+
+    virtual void Release() override
+    {
+      if (m_iRefCount.Decrement() == 0)
+        delete this;
+    }
+
+    nsUInt32 GetID() const { return m_uiID; }
+
+  private:
+    JPH::Ref<BatchRegistry> m_pRegistry;
+    nsUInt32 m_uiID = 0;
+    nsAtomicInteger32 m_iRefCount;
+  };
+
+  JPHDebugRenderer::JPHDebugRenderer()
+  {
+    m_pRegistry = new BatchRegistry();
+
+    // creates the predefined shapes, so it needs the registry
+    Initialize();
+  }
+
+  JPHDebugRenderer::~JPHDebugRenderer() = default;
+
+  void JPHDebugRenderer::SetCameraPosition(const nsVec3& in_vPosition)
+  {
+    NS_LOCK(m_Mutex);
+
+    m_vCameraPosition = JPH::Vec3(in_vPosition.x, in_vPosition.y, in_vPosition.z);
+    m_bHasCamera = true;
+  }
+
+  void JPHDebugRenderer::RequestKeyframe()
+  {
+    NS_LOCK(m_Mutex);
+
+    m_bKeyframeRequested = true;
+  }
+
+  nsUInt32 JPHDebugRenderer::GetNumBatches() const
+  {
+    NS_LOCK(m_pRegistry->m_Mutex);
+
+    return m_pRegistry->m_Batches.GetCount();
+  }
+
+  void JPHDebugRenderer::DrawLine(JPH::RVec3Arg inFrom, JPH::RVec3Arg inTo, JPH::ColorArg inColor)
+  {
+    using namespace JPHDebugRendererDetail;
+
+    NS_LOCK(m_Mutex);
+
+    nsDynamicArray<nsVec3>& points = m_Lines[inColor.GetUInt32()].m_Points;
+    points.PushBack(ToVec3(inFrom));
+    points.PushBack(ToVec3(inTo));
+  }
+
+  void JPHDebugRenderer::DrawTriangle(JPH::RVec3Arg inV1, JPH::RVec3Arg inV2, JPH::RVec3Arg inV3, JPH::ColorArg inColor, ECastShadow inCastShadow)
+  {
+    using namespace JPHDebugRendererDetail;
+
+    NS_LOCK(m_Mutex);
+
+    nsHashTable<nsUInt32, ColorList>& triangles = inCastShadow == ECastShadow::On ? m_ShadowCastingTriangles : m_Triangles;
+    nsDynamicArray<nsVec3>& points = triangles[inColor.GetUInt32()].m_Points;
+    points.PushBack(ToVec3(inV1));
+    points.PushBack(ToVec3(inV2));
+    points.PushBack(ToVec3(inV3));
+  }
+
+  JPH::DebugRenderer::Batch JPHDebugRenderer::CreateTriangleBatch(const Triangle* inTriangles, int inTriangleCount)
+  {
+    NS_PROFILE_SCOPE("JPHDebugRenderer::CreateTriangleBatch");
+
+    static_assert(sizeof(Triangle) == 3 * sizeof(Vertex), "The vertices of consecutive triangles must be contiguous");
+
+    // the triangles do not share vertices, so they are written as a vertex list without indices
+    nsDynamicArray<nsUInt8> data;
+    JPHDebugRendererDetail::WriteBatch(data, inTriangleCount > 0 ? inTriangles->mV : nullptr, static_cast<nsUInt32>(inTriangleCount) * 3, nullptr, 0);
+
+    return new BatchHandle(m_pRegistry, m_pRegistry->Add(data));
+  }
+
+  JPH::DebugRenderer::Batch JPHDebugRenderer::CreateTriangleBatch(const Vertex* inVertices, int inVertexCount, const JPH::uint32* inIndices, int inIndexCount)
+  {
+    NS_PROFILE_SCOPE("JPHDebugRenderer::CreateTriangleBatch");
+
+    nsDynamicArray<nsUInt8> data;
+    JPHDebugRendererDetail::WriteBatch(data, inVertices, static_cast<nsUInt32>(inVertexCount), inIndices, static_cast<nsUInt32>(inIndexCount));
+
+    return new BatchHandle(m_pRegistry, m_pRegistry->Add(data));
+  }
+
+  void JPHDebugRenderer::DrawGeometry(JPH::RMat44Arg inModelMatrix, const JPH::AABox& inWorldSpaceBounds, float inLODScaleSq, JPH::ColorArg inModelColor, const GeometryRef& inGeometry, ECullMode inCullMode, ECastShadow inCastShadow, EDrawMode inDrawMode)
+  {
+    DebugDrawFormat::GeometryInstance instance;
+
+    const JPH::Vec3 vAxisX = inModelMatrix.GetAxisX();
+    const JPH::Vec3 vAxisY = inModelMatrix.GetAxisY();
+    const JPH::Vec3 vAxisZ = inModelMatrix.GetAxisZ();
+    const JPH::RVec3 vTranslation = inModelMatrix.GetTranslation();
+
+    const float transform[12] = {
+      vAxisX.GetX(), vAxisX.GetY(), vAxisX.GetZ(),
+      vAxisY.GetX(), vAxisY.GetY(), vAxisY.GetZ(),
+      vAxisZ.GetX(), vAxisZ.GetY(), vAxisZ.GetZ(),
+      static_cast<float>(vTranslation.GetX()), static_cast<float>(vTranslation.GetY()), static_cast<float>(vTranslation.GetZ())};
+    nsMemoryUtils::Copy(instance.m_Transform, transform, 12);
+
+    instance.m_uiColor = inModelColor.GetUInt32();
+    instance.m_uiCullMode = static_cast<nsUInt8>(inCullMode);
+    instance.m_uiDrawMode = static_cast<nsUInt8>(inDrawMode);
+    instance.m_uiCastShadow = static_cast<nsUInt8>(inCastShadow);
+
+    NS_LOCK(m_Mutex);
+
+    const LOD& lod = m_bHasCamera ? inGeometry->GetLOD(m_vCameraPosition, inWorldSpaceBounds, inLODScaleSq) : inGeometry->mLODs[0];
+    instance.m_uiBatchID = static_cast<const BatchHandle*>(lod.mTriangleBatch.GetPtr())->GetID();
+
+    m_Instances.PushBack(instance);
+  }
+
+  void JPHDebugRenderer::DrawText3D(JPH::RVec3Arg inPosition, const std::string_view& inString, JPH::ColorArg inColor, float inHeight)
+  {
+    NS_LOCK(m_Mutex);
+
+    Text& text = m_Texts.ExpandAndGetRef();
+    text.m_vPosition = JPHDebugRendererDetail::ToVec3(inPosition);
+    text.m_uiColor = inColor.GetUInt32();
+    text.m_fHeight = inHeight;
+    text.m_sText = nsStringView(inString.data(), inString.data() + inString.size());
+  }
+
+  bool JPHDebugRenderer::EncodeFrame(nsUInt64 in_uiStepIndex, nsDynamicArray<nsUInt8>& out_data)
+  {
+    NS_PROFILE_SCOPE("JPHDebugRenderer::EncodeFrame");
+
+    NS_LOCK(m_Mutex);
+
+    const bool bKeyframe = m_bKeyframeRequested;
+    m_bKeyframeRequested = false;
+
+    out_data.Clear();
+    IO::JPHByteWriter writer(out_data);
+
+    DebugDrawFormat::FrameHeader header;
+    header.m_uiFlags = bKeyframe ? DebugDrawFormat::Frame_Keyframe : 0;
+    header.m_uiStepIndex = in_uiStepIndex;
+    writer.Write(header);
+
+    // batches, only the new ones unless the client starts over
+    {
+      BatchRegistry& registry = *m_pRegistry;
+      NS_LOCK(registry.m_Mutex);
+
+      if (bKeyframe)
+      {
+        registry.m_PendingIDs.Clear();
+        registry.m_RemovedIDs.Clear();
+
+        for (auto it : registry.m_Batches)
+        {
+          registry.m_PendingIDs.PushBack(it.Key());
+        }
+      }
+
+      writer.WriteVarUInt(registry.m_PendingIDs.GetCount());
+
+      for (nsUInt32 uiID : registry.m_PendingIDs)
+      {
+        BatchRegistry::Entry& entry = *registry.m_Batches.GetValue(uiID);
+        entry.m_bSent = true;
+
+        writer.WriteVarUInt(uiID);
+        writer.WriteBytes(entry.m_Data.GetData(), entry.m_Data.GetCount());
+      }
+
+      writer.WriteVarUInt(registry.m_RemovedIDs.GetCount());
+
+      for (nsUInt32 uiID : registry.m_RemovedIDs)
+      {
+        writer.WriteVarUInt(uiID);
+      }
+
+      registry.m_PendingIDs.Clear();
+      registry.m_RemovedIDs.Clear();
+
+      nsStats::SetStat("JDebug/DebugDraw/Batches", registry.m_Batches.GetCount());
+    }
+
+    // instances, as runs of unchanged and changed ones
+    {
+      const nsUInt32 uiNumInstances = m_Instances.GetCount();
+      const nsUInt32 uiNumComparable = bKeyframe ? 0 : nsMath::Min(uiNumInstances, m_PrevInstances.GetCount());
+
+      auto IsUnchanged = [&](nsUInt32 i)
+      {
+        return i < uiNumComparable && nsMemoryUtils::RawByteCompare(&m_Instances[i], &m_PrevInstances[i], sizeof(DebugDrawFormat::GeometryInstance)) == 0;
+      };
+
+      writer.WriteVarUInt(uiNumInstances);
+      m_uiNumUnchangedInstances = 0;
+
+      for (nsUInt32 i = 0; i < uiNumInstances;)
+      {
+        const nsUInt32 uiUnchangedStart = i;
+        while (i < uiNumInstances && IsUnchanged(i))
+          ++i;
+
+        const nsUInt32 uiChangedStart = i;
+        while (i < uiNumInstances && !IsUnchanged(i))
+          ++i;
+
+        writer.WriteVarUInt(uiChangedStart - uiUnchangedStart);
+        writer.WriteVarUInt(i - uiChangedStart);
+        writer.WriteBytes(m_Instances.GetData() + uiChangedStart, (i - uiChangedStart) * sizeof(DebugDrawFormat::GeometryInstance));
+
+        m_uiNumUnchangedInstances += uiChangedStart - uiUnchangedStart;
+      }
+
+      m_PrevInstances.Swap(m_Instances);
+      m_Instances.Clear();
+    }
+
+    WriteColorLists(out_data, m_Lines, bKeyframe);
+    WriteColorLists(out_data, m_Triangles, bKeyframe);
+    WriteColorLists(out_data, m_ShadowCastingTriangles, bKeyframe);
+
+    writer.WriteVarUInt(m_Texts.GetCount());
+
+    for (const Text& text : m_Texts)
+    {
+      writer.Write(text.m_vPosition);
+      writer.Write(text.m_uiColor);
+      writer.Write(text.m_fHeight);
+      writer.WriteVarUInt(text.m_sText.GetElementCount());
+      writer.WriteBytes(text.m_sText.GetData(), text.m_sText.GetElementCount());
+    }
+
+    m_Texts.Clear();
+
+    nsStats::SetStat("JDebug/DebugDraw/Instances", m_PrevInstances.GetCount());
+    nsStats::SetStat("JDebug/DebugDraw/Unchanged Instances", m_uiNumUnchangedInstances);
+    nsStats::SetStat("JDebug/DebugDraw/Frame Bytes", out_data.GetCount());
+
+    return bKeyframe;
+  }
+
+  void JPHDebugRenderer::WriteColorLists(nsDynamicArray<nsUInt8>& out_data, nsHashTable<nsUInt32, ColorList>& inout_lists, bool bKeyframe)
+  {
+    IO::JPHByteWriter writer(out_data);
+
+    nsUInt32 uiNumColors = 0;
+    for (auto it = inout_lists.GetIterator(); it.IsValid();)
+    {
+      ColorList& list = it.Value();
+
+      // colors that were neither drawn in this frame nor in the last one are forgotten
+      if (list.m_Points.IsEmpty() && list.m_PrevPoints.IsEmpty())
+      {
+        it = inout_lists.Remove(it);
+        continue;
+      }
+
+      if (!list.m_Points.IsEmpty())
+        ++uiNumColors;
+
+      ++it;
+    }
+
+    writer.WriteVarUInt(uiNumColors);
+
+    for (auto it : inout_lists)
+    {
+      ColorList& list = it.Value();
+
+      if (!list.m_Points.IsEmpty())
+      {
+        const bool bUnchanged = !bKeyframe && list.m_Points == list.m_PrevPoints;
+
+        writer.Write<nsUInt32>(it.Key());
+        writer.Write<nsUInt8>(bUnchanged ? 1 : 0);
+
+        if (!bUnchanged)
+        {
+          writer.WriteVarUInt(list.m_Points.GetCount());
+          writer.WriteBytes(list.m_Points.GetData(), list.m_Points.GetCount() * sizeof(nsVec3));
+        }
+      }
+
+      list.m_PrevPoints.Swap(list.m_Points);
+      list.m_Points.Clear();
+    }
+  }
+
+  void JPHDebugRenderer::DiscardFrame()
+  {
+    NS_LOCK(m_Mutex);
+
+    m_Instances.Clear();
+    m_Texts.Clear();
+
+    for (auto it : m_Lines)
+    {
+      it.Value().m_Points.Clear();
+    }
+
+    for (auto it : m_Triangles)
+    {
+      it.Value().m_Points.Clear();
+    }
+
+    for (auto it : m_ShadowCastingTriangles)
+    {
+      it.Value().m_Points.Clear();
+    }
+  }
+
+#endif
+
+  nsResult JPHDebugDrawDecoder::DecodeFrame(nsArrayPtr<const nsUInt8> in_data)
+  {
+    using namespace JPHDebugRendererDetail;
+
+    IO::JPHByteReader reader(in_data);
+    const nsUInt32 uiDataSize = in_data.GetCount();
+
+    DebugDrawFormat::FrameHeader header;
+    if (!reader.Read(header) || header.m_uiMagic != DebugDrawFormat::s_uiFrameMagic || header.m_uiVersion != DebugDrawFormat::s_uiFrameVersion)
+      return NS_FAILURE;
+
+    const bool bKeyframe = (header.m_uiFlags & DebugDrawFormat::Frame_Keyframe) != 0;
+
+    if (!bKeyframe && !m_bHasKeyframe)
+      return NS_FAILURE;
+
+    if (bKeyframe)
+    {
+      Reset();
+      m_bHasKeyframe = true;
+    }
+
+    m_uiStepIndex = header.m_uiStepIndex;
+
+    nsUInt64 uiNumNewBatches = 0;
+    if (!reader.ReadVarUInt(uiNumNewBatches))
+      return NS_FAILURE;
+
+    for (nsUInt64 uiBatch = 0; uiBatch < uiNumNewBatches; ++uiBatch)
+    {
+      nsUInt64 uiID = 0;
+      nsUInt64 uiNumVertices = 0;
+      nsUInt64 uiNumIndices = 0;
+      if (!reader.ReadVarUInt(uiID) || !reader.ReadVarUInt(uiNumVertices) || !reader.ReadVarUInt(uiNumIndices) || uiNumVertices > uiDataSize || uiNumIndices > uiDataSize)
+        return NS_FAILURE;
+
+      Batch& batch = m_Batches[static_cast<nsUInt32>(uiID)];
+      batch.m_Positions.SetCountUninitialized(static_cast<nsUInt32>(uiNumVertices));
+      batch.m_Normals.SetCountUninitialized(static_cast<nsUInt32>(uiNumVertices));
+      batch.m_Colors.SetCountUninitialized(static_cast<nsUInt32>(uiNumVertices));
+      batch.m_Indices.SetCountUninitialized(static_cast<nsUInt32>(uiNumIndices));
+
+      for (nsUInt32 i = 0; i < batch.m_Positions.GetCount(); ++i)
+      {
+        nsInt8 normal[3];
+        if (!reader.Read(batch.m_Positions[i]) || !reader.ReadBytes(normal, sizeof(normal)) || !reader.Read(batch.m_Colors[i]))
+          return NS_FAILURE;
+
+        batch.m_Normals[i] = nsVec3(normal[0], normal[1], normal[2]) / 127.0f;
+      }
+
+      nsInt64 iIndex = 0;
+      for (nsUInt32& uiIndex : batch.m_Indices)
+      {
+        nsInt64 iDelta = 0;
+        if (!reader.ReadVarInt(iDelta))
+          return NS_FAILURE;
+
+        iIndex += iDelta;
+        if (iIndex < 0 || iIndex >= static_cast<nsInt64>(uiNumVertices))
+          return NS_FAILURE;
+
+        uiIndex = static_cast<nsUInt32>(iIndex);
+      }
+    }
+
+    nsUInt64 uiNumRemovedBatches = 0;
+    if (!reader.ReadVarUInt(uiNumRemovedBatches))
+      return NS_FAILURE;
+
+    for (nsUInt64 uiBatch = 0; uiBatch < uiNumRemovedBatches; ++uiBatch)
+    {
+      nsUInt64 uiID = 0;
+      if (!reader.ReadVarUInt(uiID))
+        return NS_FAILURE;
+
+      m_Batches.Remove(static_cast<nsUInt32>(uiID));
+    }
+
+    // unchanged instances are taken from the same index of the previous frame, all others are in the frame
+    const nsUInt32 uiNumPrevInstances = m_Instances.GetCount();
+
+    nsUInt64 uiNumInstances = 0;
+    if (!reader.ReadVarUInt(uiNumInstances) || uiNumInstances > uiNumPrevInstances + uiDataSize / sizeof(DebugDrawFormat::GeometryInstance))
+      return NS_FAILURE;
+
+    m_Instances.SetCount(static_cast<nsUInt32>(uiNumInstances));
+
+    for (nsUInt32 i = 0; i < m_Instances.GetCount();)
+    {
+      nsUInt64 uiNumUnchanged = 0;
+      nsUInt64 uiNumChanged = 0;
+      if (!reader.ReadVarUInt(uiNumUnchanged) || !reader.ReadVarUInt(uiNumChanged) || uiNumUnchanged + uiNumChanged == 0)
+        return NS_FAILURE;
+
+      if (i + uiNumUnchanged > uiNumPrevInstances || i + uiNumUnchanged + uiNumChanged > m_Instances.GetCount())
+        return NS_FAILURE;
+
+      i += static_cast<nsUInt32>(uiNumUnchanged);
+
+      if (!reader.ReadBytes(m_Instances.GetData() + i, static_cast<nsUInt32>(uiNumChanged) * sizeof(DebugDrawFormat::GeometryInstance)))
+        return NS_FAILURE;
+
+      i += static_cast<nsUInt32>(uiNumChanged);
+    }
+
+    if (!ReadColorLists(reader, uiDataSize, m_Lines) || !ReadColorLists(reader, uiDataSize, m_Triangles) || !ReadColorLists(reader, uiDataSize, m_ShadowCastingTriangles))
+      return NS_FAILURE;
+
+    nsUInt64 uiNumTexts = 0;
+    if (!reader.ReadVarUInt(uiNumTexts) || uiNumTexts > uiDataSize)
+      return NS_FAILURE;
+
+    m_Texts.SetCount(static_cast<nsUInt32>(uiNumTexts));
+
+    nsDynamicArray<char> textScratch;
+    for (Text& text : m_Texts)
+    {
+      nsUInt64 uiLength = 0;
+      if (!reader.Read(text.m_vPosition) || !reader.Read(text.m_uiColor) || !reader.Read(text.m_fHeight) || !reader.ReadVarUInt(uiLength) || uiLength > uiDataSize)
+        return NS_FAILURE;
+
+      textScratch.SetCountUninitialized(static_cast<nsUInt32>(uiLength));
+      if (!reader.ReadBytes(textScratch.GetData(), textScratch.GetCount()))
+        return NS_FAILURE;
+
+      text.m_sText = nsStringView(textScratch.GetData(), textScratch.GetData() + textScratch.GetCount());
+    }
+
+    return NS_SUCCESS;
+  }
+
+  void JPHDebugDrawDecoder::Reset()
+  {
+    m_bHasKeyframe = false;
+    m_uiStepIndex = 0;
+    m_Batches.Clear();
+    m_Instances.Clear();
+    m_Lines.Clear();
+    m_Triangles.Clear();
+    m_ShadowCastingTriangles.Clear();
+    m_Texts.Clear();
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHDebugRenderer);
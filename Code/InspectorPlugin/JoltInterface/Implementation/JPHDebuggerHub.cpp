@@ -0,0 +1,259 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Threading/TaskSystem.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHDebuggerHub.h>
+#include <InspectorPlugin/JoltInterface/JPHDebuggerInterface.h>
+#include <InspectorPlugin/JoltInterface/JPHProtocol.h>
+
+namespace JPHDebuggerHubDetail
+{
+  /// Copies the rest of a telemetry message.
+  static void ReadRemainingBytes(nsStreamReader& inout_reader, nsDynamicArray<nsUInt8>& out_data)
+  {
+    out_data.Clear();
+
+    nsUInt8 buffer[1024];
+    while (const nsUInt64 uiRead = inout_reader.ReadBytes(buffer, sizeof(buffer)))
+    {
+      out_data.PushBackRange(nsArrayPtr<const nsUInt8>(buffer, static_cast<nsUInt32>(uiRead)));
+    }
+  }
+} // namespace JPHDebuggerHubDetail
+
+namespace JDebug::API
+{
+  JPHDebuggerHub::JPHDebuggerHub()
+  {
+    nsTelemetry::AddEventHandler(nsMakeDelegate(&JPHDebuggerHub::TelemetryEventHandler, this));
+    JPHDebuggerInterface::AcceptTelemetryMessages(true);
+
+    m_bClientConnected = nsTelemetry::IsConnectedToClient();
+  }
+
+  JPHDebuggerHub::~JPHDebuggerHub()
+  {
+    while (!m_Streams.IsEmpty())
+    {
+      Unregister(*m_Streams.PeekBack().m_pInterface);
+    }
+
+    JPHDebuggerInterface::AcceptTelemetryMessages(false);
+    nsTelemetry::RemoveEventHandler(nsMakeDelegate(&JPHDebuggerHub::TelemetryEventHandler, this));
+  }
+
+  nsUInt32 JPHDebuggerHub::Register(JPHDebuggerInterface& ref_interface, nsStringView in_sName)
+  {
+    NS_ASSERT_DEV(ref_interface.m_pHub == nullptr, "The interface is already registered with a hub");
+
+    NS_LOCK(m_Mutex);
+
+    const nsUInt32 uiStreamID = m_uiNextStreamID++;
+
+    Stream& stream = m_Streams.ExpandAndGetRef();
+    stream.m_pInterface = &ref_interface;
+    stream.m_sName = in_sName;
+    stream.m_bSubscribed = !m_bClientSubscribed;
+    m_StreamIDs.PushBack(uiStreamID);
+    m_bStreamListChanged = true;
+
+    ref_interface.m_pHub = this;
+    ref_interface.m_uiStreamID = uiStreamID;
+    return uiStreamID;
+  }
+
+  void JPHDebuggerHub::Unregister(JPHDebuggerInterface& ref_interface)
+  {
+    NS_LOCK(m_Mutex);
+
+    for (nsUInt32 i = 0; i < m_Streams.GetCount(); ++i)
+    {
+      if (m_Streams[i].m_pInterface == &ref_interface)
+      {
+        m_Streams.RemoveAtAndCopy(i);
+        m_StreamIDs.RemoveAtAndCopy(i);
+        m_bStreamListChanged = true;
+        break;
+      }
+    }
+
+    ref_interface.m_pHub = nullptr;
+    ref_interface.m_uiStreamID = 0;
+  }
+
+  nsUInt32 JPHDebuggerHub::GetNumStreams() const
+  {
+    NS_LOCK(m_Mutex);
+
+    return m_Streams.GetCount();
+  }
+
+  void JPHDebuggerHub::SetSubscription(nsArrayPtr<const nsUInt32> in_streamIDs)
+  {
+    NS_LOCK(m_Mutex);
+
+    m_bClientSubscribed = true;
+
+    for (nsUInt32 i = 0; i < m_Streams.GetCount(); ++i)
+    {
+      m_Streams[i].m_bSubscribed = in_streamIDs.Contains(m_StreamIDs[i]);
+    }
+  }
+
+  bool JPHDebuggerHub::IsSubscribed(nsUInt32 in_uiStreamID) const
+  {
+    NS_LOCK(m_Mutex);
+
+    const Stream* pStream = const_cast<JPHDebuggerHub*>(this)->FindStream(in_uiStreamID);
+    return m_bClientConnected && pStream != nullptr && pStream->m_bSubscribed;
+  }
+
+  void JPHDebuggerHub::FrameEnd()
+  {
+    NS_PROFILE_SCOPE("JPHDebuggerHub::FrameEnd");
+
+    {
+      NS_LOCK(m_Mutex);
+
+      m_FrameScratch.Clear();
+      for (const Stream& stream : m_Streams)
+      {
+        m_FrameScratch.PushBack(stream.m_pInterface);
+      }
+    }
+
+    // one task per system, the captures inside wait for their own tasks, so the tasks may nest
+    nsParallelForParams params;
+    params.m_uiBinSize = 1;
+    params.m_uiMaxTasksPerThread = 1;
+
+    JPHDebuggerInterface** pInterfaces = m_FrameScratch.GetData();
+
+    nsTaskSystem::ParallelForIndexed(
+      0, m_FrameScratch.GetCount(), [pInterfaces](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+      {
+        for (nsUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+        {
+          pInterfaces[i]->FrameEnd();
+        }
+      },
+      "JoltDebuggerFrameEnd", nsTaskNesting::Maybe, params);
+  }
+
+  void JPHDebuggerHub::ProcessClientMessages()
+  {
+    NS_LOCK(m_Mutex);
+
+    if (m_bConnectionChanged.Set(false))
+    {
+      // a new client starts out watching everything, until it subscribes
+      m_bClientConnected = nsTelemetry::IsConnectedToClient();
+      m_bClientSubscribed = false;
+      m_bStreamListChanged = true;
+
+      for (Stream& stream : m_Streams)
+      {
+        stream.m_bSubscribed = true;
+        stream.m_Messages.Clear();
+      }
+    }
+
+    if (m_bStreamListChanged && m_bClientConnected)
+    {
+      m_bStreamListChanged = false;
+      SendStreamList();
+    }
+
+    nsTelemetryMessage msg;
+
+    while (nsTelemetry::RetrieveMessage(Protocol::s_uiSystemID, msg).Succeeded())
+    {
+      nsStreamReader& reader = msg.GetReader();
+
+      if (msg.GetMessageID() == Protocol::s_uiMsgSubscribe)
+      {
+        nsUInt32 uiCount = 0;
+        reader >> uiCount;
+
+        nsDynamicArray<nsUInt32> streamIDs;
+        streamIDs.SetCountUninitialized(nsMath::Min(uiCount, m_uiNextStreamID));
+
+        if (uiCount < m_uiNextStreamID && reader.ReadBytes(streamIDs.GetData(), uiCount * sizeof(nsUInt32)) == uiCount * sizeof(nsUInt32))
+        {
+          m_bClientSubscribed = true;
+
+          for (nsUInt32 i = 0; i < m_Streams.GetCount(); ++i)
+          {
+            m_Streams[i].m_bSubscribed = streamIDs.Contains(m_StreamIDs[i]);
+          }
+        }
+        else
+        {
+          nsLog::Warning("JPHDebuggerHub: Ignoring a malformed subscription.");
+        }
+      }
+      else if (msg.GetMessageID() == Protocol::s_uiMsgStream)
+      {
+        nsUInt32 uiStreamID = 0;
+        nsUInt32 uiMessageID = 0;
+        reader >> uiStreamID;
+        reader >> uiMessageID;
+
+        // messages for streams that are gone are dropped
+        if (Stream* pStream = FindStream(uiStreamID))
+        {
+          Message& message = pStream->m_Messages.ExpandAndGetRef();
+          message.m_uiMessageID = uiMessageID;
+          JPHDebuggerHubDetail::ReadRemainingBytes(reader, message.m_Data);
+        }
+      }
+    }
+  }
+
+  void JPHDebuggerHub::RetrieveMessages(nsUInt32 in_uiStreamID, nsDynamicArray<Message>& out_messages)
+  {
+    NS_LOCK(m_Mutex);
+
+    out_messages.Clear();
+
+    if (Stream* pStream = FindStream(in_uiStreamID))
+    {
+      out_messages.Swap(pStream->m_Messages);
+    }
+  }
+
+  JPHDebuggerHub::Stream* JPHDebuggerHub::FindStream(nsUInt32 uiStreamID)
+  {
+    const nsUInt32 uiIndex = m_StreamIDs.IndexOf(uiStreamID);
+    return uiIndex != nsInvalidIndex ? &m_Streams[uiIndex] : nullptr;
+  }
+
+  void JPHDebuggerHub::SendStreamList()
+  {
+    nsDynamicArray<nsUInt8> message;
+    IO::JPHByteWriter writer(message);
+    writer.Write(m_Streams.GetCount());
+
+    for (nsUInt32 i = 0; i < m_Streams.GetCount(); ++i)
+    {
+      const nsString& sName = m_Streams[i].m_sName;
+
+      writer.Write(m_StreamIDs[i]);
+      writer.Write(sName.GetElementCount());
+      writer.WriteBytes(sName.GetData(), sName.GetElementCount());
+    }
+
+    nsTelemetry::Broadcast(nsTelemetry::Reliable, Protocol::s_uiSystemID, Protocol::s_uiMsgStreamList, message.GetData(), message.GetCount());
+  }
+
+  void JPHDebuggerHub::TelemetryEventHandler(const nsTelemetry::TelemetryEventData& e)
+  {
+    // called on the telemetry thread with the telemetry mutex held, only flag the change here, it is handled in ProcessClientMessages()
+    if (e.m_EventType == nsTelemetry::TelemetryEventData::ConnectedToClient || e.m_EventType == nsTelemetry::TelemetryEventData::DisconnectedFromClient)
+    {
+      m_bConnectionChanged = true;
+    }
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHDebuggerHub);
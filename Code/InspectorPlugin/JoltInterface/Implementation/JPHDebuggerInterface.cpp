@@ -1,4 +1,1363 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHCaptureWriter.h>
+#include <InspectorPlugin/JoltInterface/JPHContactRecorder.h>
+#include <InspectorPlugin/JoltInterface/JPHDebugRenderer.h>
 #include <InspectorPlugin/JoltInterface/JPHDebuggerInterface.h>
+#include <InspectorPlugin/JoltInterface/JPHFlightRecorder.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileManager.h>
+#include <InspectorPlugin/JoltInterface/JPHProtocol.h>
+#include <InspectorPlugin/JoltInterface/JPHQueryRecorder.h>
+#include <InspectorPlugin/JoltInterface/JPHReplayEngine.h>
+#include <InspectorPlugin/JoltInterface/JPHTaskJobSystem.h>
 #include <Jolt/Physics/Body/BodyInterface.h>
+#include <Jolt/Physics/Body/BodyLockInterface.h>
 #include <Jolt/Physics/Body/BodyManager.h>
+#include <Jolt/Physics/Constraints/Constraint.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JPHDebuggerInterfaceDetail
+{
+  /// Number of body slots processed by a single capture task.
+  static constexpr nsUInt32 s_uiCaptureBinSize = 4096;
+
+  /// Placeholder in JPHBodySnapshot::m_ShapeIDs for shapes that still have to be registered in the dictionary.
+  static constexpr nsUInt32 s_uiUnresolvedShapeID = JDebug::API::JPHShapeDictionary::s_uiInvalidShapeID - 1;
+
+  /// Shared by all capture tasks, kept in one struct so the lambdas stay small enough for the delegate's inline storage.
+  struct CaptureContext
+  {
+    JDebug::API::JPHBodySnapshot* m_pSnapshot = nullptr;
+    const JDebug::API::JPHShapeDictionary* m_pShapes = nullptr;
+    const JPH::Shape** m_pUnresolvedShapes = nullptr; ///< Per slot, written for shapes that are not in the dictionary yet.
+    nsAtomicInteger32 m_iNumUnresolvedShapes;
+  };
+
+  static void CaptureBody(const JPH::Body& body, nsUInt32 uiSlot, CaptureContext& ctx)
+  {
+    JDebug::API::JPHBodySnapshot& snapshot = *ctx.m_pSnapshot;
+    snapshot.CaptureBody(body, uiSlot);
+
+    // registering a shape triangulates it and modifies the dictionary, that happens on the calling thread afterwards
+    const JPH::Shape* pShape = body.GetShape();
+    nsUInt32 uiShapeID = ctx.m_pShapes->FindShapeID(pShape);
+
+    if (uiShapeID == JDebug::API::JPHShapeDictionary::s_uiInvalidShapeID && pShape != nullptr)
+    {
+      ctx.m_pUnresolvedShapes[uiSlot] = pShape;
+      ctx.m_iNumUnresolvedShapes.Increment();
+      uiShapeID = s_uiUnresolvedShapeID;
+    }
+
+    snapshot.m_ShapeIDs[uiSlot] = uiShapeID;
+  }
+} // namespace JPHDebuggerInterfaceDetail
+
+namespace JDebug::API
+{
+  JPHDebuggerInterface::JPHDebuggerInterface()
+  {
+    nsTelemetry::AddEventHandler(nsMakeDelegate(&JPHDebuggerInterface::TelemetryEventHandler, this));
+    AcceptTelemetryMessages(true);
+  }
+
+  JPHDebuggerInterface::JPHDebuggerInterface(const JPH::PhysicsSystem& in_physicssystem, const JPH::BodyManager* in_manager)
+    : m_pInterface(&in_physicssystem.GetBodyInterfaceNoLock())
+    , m_pManager(in_manager)
+    , m_pPhysicsSystem(&in_physicssystem)
+  {
+    nsTelemetry::AddEventHandler(nsMakeDelegate(&JPHDebuggerInterface::TelemetryEventHandler, this));
+    AcceptTelemetryMessages(true);
+  }
+
+  JPHDebuggerInterface::~JPHDebuggerInterface()
+  {
+    if (m_pHub != nullptr)
+      m_pHub->Unregister(*this);
+
+    SetJobSystem(nullptr);
+
+    // other interfaces and the hub keep receiving messages, the last one stops it
+    AcceptTelemetryMessages(false);
+    nsTelemetry::RemoveEventHandler(nsMakeDelegate(&JPHDebuggerInterface::TelemetryEventHandler, this));
+  }
+
+  void JPHDebuggerInterface::AcceptTelemetryMessages(bool in_bAccept)
+  {
+    static nsMutex s_Mutex;
+    static nsUInt32 s_uiNumUsers = 0;
+
+    NS_LOCK(s_Mutex);
+
+    if (in_bAccept && s_uiNumUsers++ == 0)
+    {
+      nsTelemetry::AcceptMessagesForSystem(Protocol::s_uiSystemID, true);
+    }
+    else if (!in_bAccept && --s_uiNumUsers == 0)
+    {
+      nsTelemetry::AcceptMessagesForSystem(Protocol::s_uiSystemID, false);
+    }
+  }
+
+  void JPHDebuggerInterface::SetBodyInterface(const JPH::BodyInterface& in_interface)
+  {
+    m_pInterface = &in_interface;
+  }
+
+  void JPHDebuggerInterface::SetBodyManager(const JPH::BodyManager& in_manager)
+  {
+    m_pManager = &in_manager;
+  }
+
+  void JPHDebuggerInterface::SetNetworkConnectionLink(const std::string& in_link)
+  {
+    m_sNetworkConnectionLink = in_link;
+  }
+
+  void JPHDebuggerInterface::SetInstructionLevel(JDInstructionLevel in_level)
+  {
+    m_eInstructionLevel = in_level;
+  }
+
+  void JPHDebuggerInterface::SetCaptureWriter(JPHCaptureWriter* in_pWriter)
+  {
+    m_pCaptureWriter = in_pWriter;
+
+    // a capture has to start with a keyframe and needs all shapes again
+    m_FrameEncoder.RequestKeyframe();
+    m_SoftBodyEncoder.RequestKeyframe();
+    RequestDebugDrawKeyframe();
+    m_bCaptureHasShapes = false;
+    m_bCaptureHasScene = false;
+  }
+
+  void JPHDebuggerInterface::SetFlightRecorder(JPHFlightRecorder* in_pRecorder)
+  {
+    m_pFlightRecorder = in_pRecorder;
+
+    // the recorder needs all shapes, it asks for a keyframe itself
+    m_bFlightRecorderHasShapes = false;
+  }
+
+  void JPHDebuggerInterface::SetContactRecorder(JPHContactRecorder* in_pRecorder)
+  {
+    m_pContactRecorder = in_pRecorder;
+  }
+
+  void JPHDebuggerInterface::SetQueryRecorder(JPHQueryRecorder* in_pRecorder)
+  {
+    m_pQueryRecorder = in_pRecorder;
+  }
+
+  void JPHDebuggerInterface::SetStateCaptureSettings(const JPHStateCaptureSettings& in_settings)
+  {
+    m_StateCaptureSettings = in_settings;
+    m_bCaptureHasScene = false;
+  }
+
+  void JPHDebuggerInterface::SetSoftBodyCaptureSettings(const JPHSoftBodyCaptureSettings& in_settings)
+  {
+    if (!in_settings.m_bEnabled)
+    {
+      // releases the soft body settings the encoder holds on to
+      m_SoftBodyEncoder.Reset();
+    }
+
+    m_SoftBodyEncoder.SetSettings(in_settings);
+  }
+
+  void JPHDebuggerInterface::SetDebugRenderer(JPHDebugRenderer* in_pRenderer)
+  {
+#ifndef JPH_DEBUG_RENDERER
+    NS_ASSERT_DEV(in_pRenderer == nullptr, "Jolt is built without JPH_DEBUG_RENDERER");
+#endif
+
+    m_pDebugRenderer = in_pRenderer;
+
+    // the renderer may have sent its batches to someone else before
+    RequestDebugDrawKeyframe();
+  }
+
+  void JPHDebuggerInterface::EnableSleepTracking(JPH::PhysicsSystem& inout_system)
+  {
+    NS_ASSERT_DEV(&inout_system == m_pPhysicsSystem, "Sleep tracking needs the physics system the interface was created with");
+
+    m_ActivationTracker.Attach(inout_system);
+
+    // the transitions before attaching are unknown, so both snapshots start out with all bodies
+    m_uiNumFullCapturesPending = 2;
+    m_PreviousTransitions.Clear();
+    m_FrameEncoder.SetChangeTracking(true);
+  }
+
+  void JPHDebuggerInterface::DisableSleepTracking()
+  {
+    m_ActivationTracker.Detach();
+    m_FrameEncoder.SetChangeTracking(false);
+  }
+
+  void JPHDebuggerInterface::SetStepStatisticsEnabled(bool in_bEnabled)
+  {
+    m_bStepStatisticsEnabled = in_bEnabled;
+    m_StepStatistics = JPHStepStatistics();
+    m_StepMonitor.SetTimingEnabled(in_bEnabled);
+  }
+
+  void JPHDebuggerInterface::SetJobSystem(JPHTaskJobSystem* in_pJobSystem)
+  {
+    if (m_pJobSystem != nullptr)
+      m_pJobSystem->SetStepMonitor(nullptr);
+
+    m_pJobSystem = in_pJobSystem;
+
+    if (m_pJobSystem != nullptr)
+      m_pJobSystem->SetStepMonitor(&m_StepMonitor);
+  }
+
+  void JPHDebuggerInterface::SetConstraintMonitorSettings(const JPHConstraintMonitorSettings& in_settings)
+  {
+    m_ConstraintMonitorSettings = in_settings;
+    m_ConstraintStatistics = JPHConstraintStatistics();
+  }
+
+  nsBitflags<JPHFrameContent> JPHDebuggerInterface::GetFrameContent(JDInstructionLevel in_level)
+  {
+    switch (in_level)
+    {
+      case JDInstructionLevel::JDIL_All:
+        return JPHFrameContent::State | JPHFrameContent::Position | JPHFrameContent::Rotation | JPHFrameContent::Velocity | JPHFrameContent::Shape;
+
+      case JDInstructionLevel::JDIL_Line:
+        // the rotation is sent along with the position, a position alone is not enough to draw a body
+        return JPHFrameContent::State | JPHFrameContent::Position | JPHFrameContent::Rotation | JPHFrameContent::Shape;
+
+      case JDInstructionLevel::JDIL_Function:
+        return JPHFrameContent::State;
+    }
+
+    NS_ASSERT_NOT_IMPLEMENTED;
+    return JPHFrameContent::State;
+  }
+
+  void JPHDebuggerInterface::FrameStart()
+  {
+    m_FrameStartTime = nsTime::Now();
+    PreFrameStart();
+  }
+
+  void JPHDebuggerInterface::FrameEnd()
+  {
+    const nsTime stepTime = m_FrameStartTime.IsPositive() ? nsTime::Now() - m_FrameStartTime : nsTime::MakeZero();
+
+    PreFrameEnd();
+
+    // the connection decides whether the frame is published, which decides how much the capture may cost
+    UpdateConnectionState();
+
+    const bool bPublishing = m_bClientConnected || (m_pCaptureWriter != nullptr && m_pCaptureWriter->IsRunning()) || IsFlightRecording();
+
+    if (IsFlightRecording() && m_pFlightRecorder->IsKeyframeNeeded())
+    {
+      // the soft bodies and the debug drawing follow the keyframe of the bodies
+      m_FrameEncoder.RequestKeyframe();
+    }
+
+    if (bPublishing && !m_bWasPublishing)
+    {
+      m_CaptureThrottle.Reset();
+    }
+
+    m_bWasPublishing = bPublishing;
+
+    const nsTime frameBudget = m_CaptureThrottle.ComputeFrameBudget(stepTime);
+    const bool bThrottled = bPublishing && frameBudget.IsPositive();
+    bool bPublishFrame = bPublishing;
+
+    if (bThrottled)
+    {
+      bPublishFrame = BeginThrottledFrame(frameBudget);
+    }
+    else
+    {
+      m_eFrameInstructionLevel = m_eInstructionLevel;
+      m_FrameEncoder.SetToleranceScale(1.0f);
+      m_FrameEncoder.SetSendRate(1);
+      m_ClientFrameEncoder.SetToleranceScale(1.0f);
+      m_ClientFrameEncoder.SetSendRate(1);
+    }
+
+    // a keyframe resends all bodies, so with sleep tracking it captures all of them, including sleeping bodies that changed unnoticed
+    m_bFullCaptureRequested = bPublishFrame && IsKeyframePending(GetFrameContent(m_eFrameInstructionLevel));
+
+    // a skipped frame needs no snapshot, unless the state hash of every step is needed
+    const bool bCaptureSnapshot = bPublishFrame || !bThrottled || m_StateHashSettings.m_bEnabled;
+
+    if (bCaptureSnapshot)
+    {
+      m_uiCurrentSnapshot ^= 1;
+      CaptureSnapshot(m_Snapshots[m_uiCurrentSnapshot]);
+    }
+
+    if (m_StateHashSettings.m_bEnabled)
+    {
+      m_StateHash.Compute(GetCurrentSnapshot(), m_StateHashSettings.m_uiSlotsPerRange);
+    }
+
+    // new shapes are sent even with a skipped frame, the next published frame may reference them
+    const nsTime shapesStartTime = nsTime::Now();
+    PublishShapes();
+    const nsTime shapesTime = nsTime::Now() - shapesStartTime;
+
+    if (m_pContactRecorder != nullptr)
+    {
+      // always collect, the buffers may hold contacts from a step that was recorded before the client disconnected
+      m_pContactRecorder->CollectContacts();
+    }
+
+    if (m_pQueryRecorder != nullptr)
+    {
+      // like the contacts, the records of a skipped frame are dropped
+      m_pQueryRecorder->CollectRecords();
+    }
+
+    if (m_bStepStatisticsEnabled && m_pPhysicsSystem != nullptr)
+    {
+      m_StepMonitor.Collect(*m_pPhysicsSystem, m_pContactRecorder, m_StepStatistics);
+    }
+
+    if (bPublishFrame && m_ConstraintMonitorSettings.m_bEnabled && m_pPhysicsSystem != nullptr)
+    {
+      // unlike the step statistics this visits every constraint, so it is only done for frames that may be published
+      m_ConstraintMonitor.Collect(*m_pPhysicsSystem, m_ConstraintMonitorSettings, m_ConstraintStatistics);
+    }
+
+    if (!m_BodyDetailRequests.IsEmpty())
+    {
+      // answered whether or not the frame is published, the client waits for the reply
+      PublishBodyDetails();
+    }
+
+    if (bPublishFrame && bThrottled)
+    {
+      const JPHBodySnapshot& snapshot = GetCurrentSnapshot();
+      const nsTime captureTime = snapshot.m_CaptureDuration + shapesTime;
+      const nsBitflags<JPHFrameContent> content = GetFrameContent(m_eFrameInstructionLevel);
+      const bool bKeyframe = IsKeyframePending(content);
+
+      // the capture may have taken longer than predicted, only publish if the rest still fits
+      if (m_CaptureThrottle.CanPublish(frameBudget, captureTime, m_uiNumCapturedSlots, bKeyframe))
+      {
+        const nsTime publishStartTime = nsTime::Now();
+        EncodeAndPublishFrame();
+        m_CaptureThrottle.EndFrame(captureTime, nsTime::Now() - publishStartTime, m_uiNumCapturedSlots, bKeyframe);
+      }
+      else
+      {
+        m_CaptureThrottle.SkipFrame(captureTime, m_uiNumCapturedSlots);
+      }
+    }
+    else if (bPublishFrame)
+    {
+      EncodeAndPublishFrame();
+    }
+
+    if (bThrottled)
+    {
+      m_CaptureThrottle.PublishStats(false);
+    }
+
+    if (m_pContactRecorder != nullptr)
+    {
+      // takes effect in the next step, nobody needs the contacts while nothing is published
+      m_pContactRecorder->SetRecording(bPublishing);
+    }
+
+    if (m_pQueryRecorder != nullptr)
+    {
+      m_pQueryRecorder->SetRecording(bPublishing);
+    }
+
+    if (m_pFlightRecorder != nullptr)
+    {
+      CheckFlightRecorderTriggers(stepTime, bCaptureSnapshot);
+    }
+
+#ifdef JPH_DEBUG_RENDERER
+    if (m_pDebugRenderer != nullptr)
+    {
+      // nothing to do if the frame was encoded, otherwise the next frame must not contain what was drawn in this one
+      m_pDebugRenderer->DiscardFrame();
+    }
+#endif
+
+    ++m_uiStepIndex;
+  }
+
+  bool JPHDebuggerInterface::BeginThrottledFrame(nsTime frameBudget)
+  {
+    // the most detailed instruction level each fidelity allows, JDIL_Function is the least detailed one
+    static constexpr JDInstructionLevel s_MaxLevel[JPHCaptureFidelity::ENUM_COUNT] = {
+      JDInstructionLevel::JDIL_All, JDInstructionLevel::JDIL_All, JDInstructionLevel::JDIL_Line, JDInstructionLevel::JDIL_Line, JDInstructionLevel::JDIL_Function};
+
+    JDInstructionLevel levels[JPHCaptureFidelity::ENUM_COUNT];
+    bool keyframePending[JPHCaptureFidelity::ENUM_COUNT];
+
+    for (nsUInt32 i = 0; i < JPHCaptureFidelity::ENUM_COUNT; ++i)
+    {
+      levels[i] = nsMath::Max(m_eInstructionLevel, s_MaxLevel[i]);
+
+      const nsBitflags<JPHFrameContent> content = GetFrameContent(levels[i]);
+      keyframePending[i] = IsKeyframePending(content);
+    }
+
+    // the snapshot of the last frame is a good enough guess for the size of this one, unless there was none yet
+    nsUInt32 uiNumSlots = GetCurrentSnapshot().GetSlotCount();
+
+    if (IsSleepTrackingEnabled() && m_uiNumFullCapturesPending == 0)
+      uiNumSlots = m_pPhysicsSystem->GetNumActiveBodies(JPH::EBodyType::RigidBody) + m_pPhysicsSystem->GetNumActiveBodies(JPH::EBodyType::SoftBody);
+    else if (m_pManager != nullptr)
+      uiNumSlots = static_cast<nsUInt32>(m_pManager->GetBodies().size());
+    else if (m_pPhysicsSystem != nullptr)
+      uiNumSlots = nsMath::Max(uiNumSlots, m_pPhysicsSystem->GetNumBodies());
+
+    const bool bFits = m_CaptureThrottle.BeginFrame(frameBudget, uiNumSlots, keyframePending);
+
+    const JPHCaptureFidelity::Enum eFidelity = m_CaptureThrottle.GetFidelity();
+    const float fToleranceScale = eFidelity >= JPHCaptureFidelity::RelaxedTolerances ? m_CaptureThrottle.GetBudget().m_fToleranceScale : 1.0f;
+    const nsUInt32 uiSendRate = JPHCaptureFidelity::GetSendRate(eFidelity);
+
+    m_eFrameInstructionLevel = levels[eFidelity];
+    m_FrameEncoder.SetToleranceScale(fToleranceScale);
+    m_FrameEncoder.SetSendRate(uiSendRate);
+    m_ClientFrameEncoder.SetToleranceScale(fToleranceScale);
+    m_ClientFrameEncoder.SetSendRate(uiSendRate);
+
+    return bFits;
+  }
+
+  bool JPHDebuggerInterface::IsKeyframePending(nsBitflags<JPHFrameContent> content) const
+  {
+    // mirrors the choice of encoders in EncodeAndPublishFrame(), switching between them requests keyframes from both
+    const bool bCapturing = (m_pCaptureWriter != nullptr && m_pCaptureWriter->IsRunning()) || IsFlightRecording();
+    const bool bFilterClient = m_bClientConnected && m_InterestFilter.IsActive();
+
+    const bool bFilterCapture = m_AggregationSettings.m_bEnabled && m_AggregationSettings.m_bAggregateCapture && m_InterestFilter.IsActive();
+
+    if (bFilterClient != m_bClientFiltered || bFilterCapture != m_bCaptureFiltered)
+      return true;
+
+    if (bFilterClient && m_ClientFrameEncoder.IsKeyframePending(content))
+      return true;
+
+    return (bCapturing || !bFilterClient) && m_FrameEncoder.IsKeyframePending(content);
+  }
+
+  void JPHDebuggerInterface::EncodeAndPublishFrame()
+  {
+    const JPHBodySnapshot& snapshot = GetCurrentSnapshot();
+    const nsBitflags<JPHFrameContent> content = GetFrameContent(m_eFrameInstructionLevel);
+    const bool bCapturing = m_pCaptureWriter != nullptr && m_pCaptureWriter->IsRunning();
+    const bool bFlightRecording = IsFlightRecording();
+
+    // the capture gets all bodies unless they are aggregated, a filtered client needs its own encoder, since the encoders track what their receiver knows
+    const bool bFilterClient = m_bClientConnected && m_InterestFilter.IsActive();
+
+    if (bFilterClient != m_bClientFiltered)
+    {
+      // the client switches to the other encoder, which does not know what the client has seen so far
+      m_bClientFiltered = bFilterClient;
+      m_FrameEncoder.RequestKeyframe();
+      m_ClientFrameEncoder.RequestKeyframe();
+    }
+
+    // with aggregation the capture may be limited to the interest set as well, switching changes which bodies it knows
+    const bool bFilterCapture = m_AggregationSettings.m_bEnabled && m_AggregationSettings.m_bAggregateCapture && m_InterestFilter.IsActive();
+
+    if (bFilterCapture != m_bCaptureFiltered)
+    {
+      m_bCaptureFiltered = bFilterCapture;
+      m_FrameEncoder.RequestKeyframe();
+    }
+
+    if (bFilterClient || bFilterCapture)
+    {
+      m_InterestFilter.Update(m_pPhysicsSystem, snapshot);
+
+      // with sleep tracking, a sleeping body that enters or leaves the set is not among the captured slots
+      if (bFilterCapture)
+        m_FrameEncoder.AddChangedSlots(m_InterestFilter.GetChangedSlots());
+    }
+
+    if (bFilterClient)
+    {
+      // the settings only consist of numbers, changing the quantization forces a keyframe, so only do that when they actually differ
+      if (nsMemoryUtils::RawByteCompare(&m_ClientFrameEncoder.GetSettings(), &m_FrameEncoder.GetSettings(), sizeof(JPHFrameEncoderSettings)) != 0)
+        m_ClientFrameEncoder.SetSettings(m_FrameEncoder.GetSettings());
+
+      m_ClientFrameEncoder.EncodeFrame(snapshot, content, m_ClientEncodedFrame, m_InterestFilter.GetMask());
+    }
+
+    bool bKeyframe = false;
+
+    if (bCapturing || bFlightRecording || !bFilterClient)
+    {
+      bKeyframe = m_FrameEncoder.EncodeFrame(snapshot, content, m_EncodedFrame, bFilterCapture ? m_InterestFilter.GetMask() : nsArrayPtr<const nsUInt8>());
+    }
+
+    const bool bAggregates = m_AggregationSettings.m_bEnabled && (bFilterClient || bFilterCapture);
+
+    if (bAggregates)
+    {
+      m_Aggregator.Aggregate(m_pPhysicsSystem, snapshot, m_InterestFilter.GetMask(), m_AggregationSettings, m_AggregateGrid);
+      m_AggregateGrid.Write(m_AggregateData);
+    }
+
+    m_FrameRecords.Clear();
+
+    if (m_pContactRecorder != nullptr)
+    {
+      JPHContactRecorder::WriteContacts(m_pContactRecorder->GetContacts(), m_pContactRecorder->GetNumDroppedContacts(), m_ContactData);
+      IO::JPHPVDFileManager::AppendRecord(m_FrameRecords, IO::JPHPVDRecordType::Contacts, m_ContactData);
+    }
+
+    if (m_pQueryRecorder != nullptr)
+    {
+      JPHQueryRecorder::WriteRecords(m_pQueryRecorder->GetRecords(), m_pQueryRecorder->GetTotals(), m_pQueryRecorder->GetNumDroppedRecords(), m_QueryData);
+      IO::JPHPVDFileManager::AppendRecord(m_FrameRecords, IO::JPHPVDRecordType::Queries, m_QueryData);
+    }
+
+    if (m_StateHashSettings.m_bEnabled)
+    {
+      m_StateHash.Write(m_StateHashData);
+      IO::JPHPVDFileManager::AppendRecord(m_FrameRecords, IO::JPHPVDRecordType::StateHash, m_StateHashData);
+    }
+
+    if (m_bStepStatisticsEnabled)
+    {
+      m_StepStatistics.Write(m_StepStatisticsData);
+      IO::JPHPVDFileManager::AppendRecord(m_FrameRecords, IO::JPHPVDRecordType::StepStatistics, m_StepStatisticsData);
+    }
+
+    const bool bConstraints = m_ConstraintMonitorSettings.m_bEnabled && m_pPhysicsSystem != nullptr;
+
+    if (bConstraints)
+    {
+      m_ConstraintStatistics.Write(m_ConstraintData);
+      IO::JPHPVDFileManager::AppendRecord(m_FrameRecords, IO::JPHPVDRecordType::Constraints, m_ConstraintData);
+    }
+
+    if (bAggregates && bFilterCapture)
+    {
+      IO::JPHPVDFileManager::AppendRecord(m_FrameRecords, IO::JPHPVDRecordType::Aggregates, m_AggregateData);
+    }
+
+    bool bSoftBodies = false;
+
+    if (m_SoftBodyEncoder.GetSettings().m_bEnabled && content.IsSet(JPHFrameContent::Position))
+    {
+      // playback of the capture can start at any keyframe, so those need the soft bodies in full
+      bSoftBodies = EncodeSoftBodies((bCapturing || bFlightRecording) && bKeyframe);
+
+      if (bSoftBodies)
+        IO::JPHPVDFileManager::AppendRecord(m_FrameRecords, IO::JPHPVDRecordType::SoftBodies, m_SoftBodyData);
+    }
+
+#ifdef JPH_DEBUG_RENDERER
+    if (m_pDebugRenderer != nullptr)
+    {
+      // like the soft bodies, playback starting at a keyframe needs all batches
+      if ((bCapturing || bFlightRecording) && bKeyframe)
+        m_pDebugRenderer->RequestKeyframe();
+
+      m_pDebugRenderer->EncodeFrame(m_uiStepIndex, m_DebugDrawData);
+      IO::JPHPVDFileManager::AppendRecord(m_FrameRecords, IO::JPHPVDRecordType::DebugDraw, m_DebugDrawData);
+    }
+#endif
+
+    // the simulation state builds on the scene written into the capture file before, the flight recorder only takes the records of the step
+    const nsUInt32 uiNumStepRecordBytes = m_FrameRecords.GetCount();
+
+    if (bCapturing)
+    {
+      CaptureSimulationState();
+    }
+
+    if (m_bClientConnected)
+    {
+      // delta frames build on each other, so they have to arrive reliably
+      const nsDynamicArray<nsUInt8>& clientFrame = bFilterClient ? m_ClientEncodedFrame : m_EncodedFrame;
+      Send(nsTelemetry::Reliable, Protocol::s_uiMsgFrame, clientFrame.GetData(), clientFrame.GetCount());
+
+      if (m_pContactRecorder != nullptr)
+      {
+        m_ContactMessage.Clear();
+        IO::JPHByteWriter(m_ContactMessage).Write(m_uiStepIndex);
+        m_ContactMessage.PushBackRange(m_ContactData);
+
+        Send(nsTelemetry::Unreliable, Protocol::s_uiMsgContacts, m_ContactMessage.GetData(), m_ContactMessage.GetCount());
+      }
+
+      if (m_pQueryRecorder != nullptr)
+      {
+        m_QueryMessage.Clear();
+        IO::JPHByteWriter(m_QueryMessage).Write(m_uiStepIndex);
+        m_QueryMessage.PushBackRange(m_QueryData);
+
+        Send(nsTelemetry::Unreliable, Protocol::s_uiMsgQueries, m_QueryMessage.GetData(), m_QueryMessage.GetCount());
+      }
+
+      if (m_StateHashSettings.m_bEnabled)
+      {
+        m_StateHashMessage.Clear();
+        IO::JPHByteWriter(m_StateHashMessage).Write(m_uiStepIndex);
+        m_StateHashMessage.PushBackRange(m_StateHashData);
+
+        Send(nsTelemetry::Reliable, Protocol::s_uiMsgStateHash, m_StateHashMessage.GetData(), m_StateHashMessage.GetCount());
+      }
+
+      if (m_bStepStatisticsEnabled)
+      {
+        m_StepStatisticsMessage.Clear();
+        IO::JPHByteWriter(m_StepStatisticsMessage).Write(m_uiStepIndex);
+        m_StepStatisticsMessage.PushBackRange(m_StepStatisticsData);
+
+        Send(nsTelemetry::Unreliable, Protocol::s_uiMsgStepStatistics, m_StepStatisticsMessage.GetData(), m_StepStatisticsMessage.GetCount());
+      }
+
+      if (bConstraints)
+      {
+        m_ConstraintMessage.Clear();
+        IO::JPHByteWriter(m_ConstraintMessage).Write(m_uiStepIndex);
+        m_ConstraintMessage.PushBackRange(m_ConstraintData);
+
+        Send(nsTelemetry::Unreliable, Protocol::s_uiMsgConstraints, m_ConstraintMessage.GetData(), m_ConstraintMessage.GetCount());
+      }
+
+      if (bAggregates && bFilterClient)
+      {
+        m_AggregateMessage.Clear();
+        IO::JPHByteWriter(m_AggregateMessage).Write(m_uiStepIndex);
+        m_AggregateMessage.PushBackRange(m_AggregateData);
+
+        Send(nsTelemetry::Unreliable, Protocol::s_uiMsgAggregates, m_AggregateMessage.GetData(), m_AggregateMessage.GetCount());
+      }
+
+      if (bSoftBodies)
+      {
+        Send(nsTelemetry::Reliable, Protocol::s_uiMsgSoftBodies, m_SoftBodyData.GetData(), m_SoftBodyData.GetCount());
+      }
+
+      if (m_pDebugRenderer != nullptr)
+      {
+        Send(nsTelemetry::Reliable, Protocol::s_uiMsgDebugDraw, m_DebugDrawData.GetData(), m_DebugDrawData.GetCount());
+      }
+    }
+
+    if (bFlightRecording)
+    {
+      m_pFlightRecorder->Record(m_EncodedFrame, m_FrameRecords.GetArrayPtr().GetSubArray(0, uiNumStepRecordBytes), m_uiStepIndex, bKeyframe);
+    }
+
+    if (bCapturing)
+    {
+      // the frame buffer is handed over, not copied, m_EncodedFrame must not be used afterwards
+      if (!m_pCaptureWriter->Push(m_EncodedFrame, m_uiStepIndex, bKeyframe, m_FrameRecords))
+      {
+        // the capture lost a frame, the following deltas are useless without a new keyframe
+        m_FrameEncoder.RequestKeyframe();
+        m_SoftBodyEncoder.RequestKeyframe();
+        RequestDebugDrawKeyframe();
+
+        // the lost frame may have held the scene the following states build on
+        m_bCaptureHasScene = false;
+      }
+    }
+  }
+
+  bool JPHDebuggerInterface::EncodeSoftBodies(bool bKeyframe)
+  {
+    NS_PROFILE_SCOPE("JPHDebuggerInterface::EncodeSoftBodies");
+
+    if (bKeyframe)
+    {
+      m_SoftBodyEncoder.RequestKeyframe();
+    }
+    else if (m_uiStepIndex % nsMath::Max(m_SoftBodyEncoder.GetSettings().m_uiSampleInterval, 1u) != 0)
+    {
+      return false;
+    }
+
+    const JPHBodySnapshot& snapshot = GetCurrentSnapshot();
+    const nsUInt32 uiNumSlots = snapshot.GetSlotCount();
+
+    nsUInt32 uiNumSoftBodies = 0;
+    for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+    {
+      if ((snapshot.m_States[uiSlot] & JPHBodySnapshot::JPHBodyStateFlags::SoftBody) != 0)
+        ++uiNumSoftBodies;
+    }
+
+    // a frame without bodies is only needed to tell the receivers that the last ones were removed
+    if (uiNumSoftBodies == 0 && m_SoftBodyEncoder.GetNumBodies() == 0)
+      return false;
+
+    m_SoftBodyEncoder.BeginFrame(m_uiStepIndex, m_SoftBodyData);
+
+    for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots && uiNumSoftBodies > 0; ++uiSlot)
+    {
+      if ((snapshot.m_States[uiSlot] & JPHBodySnapshot::JPHBodyStateFlags::SoftBody) == 0)
+        continue;
+
+      --uiNumSoftBodies;
+
+      const JPH::Body* pBody = nullptr;
+
+      if (m_pManager != nullptr)
+      {
+        const JPH::BodyVector& bodies = m_pManager->GetBodies();
+
+        if (uiSlot < bodies.size() && JPH::BodyManager::sIsValidBodyPointer(bodies[uiSlot]))
+          pBody = bodies[uiSlot];
+      }
+      else if (m_pPhysicsSystem != nullptr)
+      {
+        pBody = m_pPhysicsSystem->GetBodyLockInterfaceNoLock().TryGetBody(JPH::BodyID(snapshot.m_BodyIDs[uiSlot]));
+      }
+
+      if (pBody != nullptr && pBody->IsSoftBody())
+      {
+        m_SoftBodyEncoder.EncodeBody(*pBody);
+      }
+    }
+
+    m_SoftBodyEncoder.EndFrame();
+    return true;
+  }
+
+  void JPHDebuggerInterface::RequestDebugDrawKeyframe()
+  {
+#ifdef JPH_DEBUG_RENDERER
+    if (m_pDebugRenderer != nullptr)
+      m_pDebugRenderer->RequestKeyframe();
+#endif
+  }
+
+  bool JPHDebuggerInterface::IsFlightRecording() const
+  {
+    return m_pFlightRecorder != nullptr && m_pFlightRecorder->IsRecording();
+  }
+
+  void JPHDebuggerInterface::CheckFlightRecorderTriggers(nsTime stepTime, bool bSnapshotCaptured)
+  {
+    m_pFlightRecorder->CheckStepTime(stepTime);
+
+    if (bSnapshotCaptured)
+    {
+      // with sleep tracking only the copied bodies can have changed, an empty list then means that all of them are asleep
+      if (!m_bCapturedChangedBodies)
+        m_pFlightRecorder->CheckBodies(GetCurrentSnapshot());
+      else if (!m_ChangedSlots.IsEmpty())
+        m_pFlightRecorder->CheckBodies(GetCurrentSnapshot(), m_ChangedSlots);
+    }
+
+    if (m_pContactRecorder != nullptr)
+    {
+      m_pFlightRecorder->CheckContacts(m_pContactRecorder->GetContacts());
+    }
+
+    // the frame of this step is recorded already, a dump that starts now contains it
+    m_pFlightRecorder->Update();
+  }
+
+  void JPHDebuggerInterface::CaptureSimulationState()
+  {
+    if (m_StateCaptureSettings.m_uiInterval == 0 || m_pPhysicsSystem == nullptr)
+      return;
+
+    // the scene has to be written again when bodies or constraints were added, removed or changed their shape or motion type
+    const JPHBodySnapshot& snapshot = GetCurrentSnapshot();
+    nsUInt64 uiSceneHash = nsHashingUtils::xxHash64(snapshot.m_BodyIDs.GetData(), snapshot.m_BodyIDs.GetCount() * sizeof(nsUInt32));
+    uiSceneHash = nsHashingUtils::xxHash64(snapshot.m_ShapeIDs.GetData(), snapshot.m_ShapeIDs.GetCount() * sizeof(nsUInt32), uiSceneHash);
+    uiSceneHash = nsHashingUtils::xxHash64(snapshot.m_MotionTypes.GetData(), snapshot.m_MotionTypes.GetCount(), uiSceneHash);
+    uiSceneHash = nsHashingUtils::xxHash64(snapshot.m_ObjectLayers.GetData(), snapshot.m_ObjectLayers.GetCount() * sizeof(nsUInt32), uiSceneHash);
+
+    for (const JPH::Ref<JPH::Constraint>& pConstraint : m_pPhysicsSystem->GetConstraints())
+    {
+      const JPH::Constraint* pRawConstraint = pConstraint.GetPtr();
+      uiSceneHash = nsHashingUtils::xxHash64(&pRawConstraint, sizeof(pRawConstraint), uiSceneHash);
+    }
+
+    if (m_bSceneUnsupported && uiSceneHash == m_uiSceneHash)
+      return;
+
+    const bool bSceneChanged = !m_bCaptureHasScene || uiSceneHash != m_uiSceneHash;
+
+    if (!bSceneChanged && m_uiStepIndex - m_uiLastStateStep < m_StateCaptureSettings.m_uiInterval)
+      return;
+
+    if (bSceneChanged)
+    {
+      m_uiSceneHash = uiSceneHash;
+
+      if (JPHReplayEngine::WriteSceneRecord(*m_pPhysicsSystem, m_FrameRecords).Failed())
+      {
+        // try again once the scene changes
+        m_bCaptureHasScene = false;
+        m_bSceneUnsupported = true;
+
+        nsLog::Warning("JPHDebuggerInterface: The physics system holds constraints that cannot be replayed, no simulation state is captured.");
+        return;
+      }
+
+      m_bCaptureHasScene = true;
+      m_bSceneUnsupported = false;
+    }
+
+    JPHReplayEngine::WriteStateRecord(*m_pPhysicsSystem, m_StateCaptureSettings, m_FrameRecords);
+    m_uiLastStateStep = m_uiStepIndex;
+  }
+
+  void JPHDebuggerInterface::UpdateConnectionState()
+  {
+    if (m_pHub != nullptr)
+    {
+      // a subscription that arrived with the messages takes effect in this frame
+      m_pHub->ProcessClientMessages();
+    }
+
+    // with a hub, the client only counts as connected while it watches this system
+    const bool bConnected = m_pHub != nullptr ? m_pHub->IsSubscribed(m_uiStreamID) : nsTelemetry::IsConnectedToClient();
+
+    if (bConnected != m_bClientConnected)
+    {
+      m_bClientConnected = bConnected;
+
+      if (bConnected)
+      {
+        // the client may have watched this system before, it starts over like a new connection
+        m_bResyncRequested = true;
+        OnJDebuggerConnect();
+      }
+      else
+      {
+        OnJDebuggerDisconnect();
+      }
+    }
+
+    if (m_bResyncRequested.Set(false))
+    {
+      m_FrameEncoder.RequestKeyframe();
+      m_ClientFrameEncoder.RequestKeyframe();
+      m_SoftBodyEncoder.RequestKeyframe();
+      RequestDebugDrawKeyframe();
+      m_bClientHasShapes = false;
+
+      // a new client starts out seeing everything, until it sends its own interest set
+      m_InterestFilter.SetInterestSet(JPHInterestSet());
+
+      // nobody waits for the replies to the requests of the previous client anymore
+      m_BodyDetailRequests.Clear();
+    }
+
+    ProcessClientMessages();
+  }
+
+  void JPHDebuggerInterface::ProcessClientMessages()
+  {
+    if (m_pHub != nullptr)
+    {
+      m_pHub->RetrieveMessages(m_uiStreamID, m_HubMessages);
+
+      for (const JPHDebuggerHub::Message& message : m_HubMessages)
+      {
+        nsRawMemoryStreamReader reader(message.m_Data.GetData(), message.m_Data.GetCount());
+        HandleClientMessage(message.m_uiMessageID, reader);
+      }
+
+      return;
+    }
+
+    nsTelemetryMessage msg;
+
+    while (nsTelemetry::RetrieveMessage(Protocol::s_uiSystemID, msg).Succeeded())
+    {
+      HandleClientMessage(msg.GetMessageID(), msg.GetReader());
+    }
+  }
+
+  void JPHDebuggerInterface::HandleClientMessage(nsUInt32 uiMessageID, nsStreamReader& inout_reader)
+  {
+    if (uiMessageID == Protocol::s_uiMsgInterest)
+    {
+      JPHInterestSet interestSet;
+
+      if (interestSet.Read(inout_reader).Succeeded())
+        m_InterestFilter.SetInterestSet(interestSet);
+      else
+        nsLog::Warning("JPHDebuggerInterface: Ignoring a malformed interest set.");
+    }
+    else if (uiMessageID == Protocol::s_uiMsgBodyDetailRequest)
+    {
+      nsUInt32 uiCount = 0;
+      inout_reader >> uiCount;
+
+      nsDynamicArray<nsUInt32> bodyIDs;
+      bodyIDs.SetCountUninitialized(nsMath::Min(uiCount, s_uiMaxQueuedBodyDetails));
+
+      if (uiCount <= s_uiMaxQueuedBodyDetails && inout_reader.ReadBytes(bodyIDs.GetData(), uiCount * sizeof(nsUInt32)) == uiCount * sizeof(nsUInt32))
+        RequestBodyDetails(bodyIDs);
+      else
+        nsLog::Warning("JPHDebuggerInterface: Ignoring a malformed body detail request.");
+    }
+    else if (uiMessageID == Protocol::s_uiMsgQuerySettings)
+    {
+      nsUInt32 uiSampleInterval = 0;
+      nsUInt64 uiSlowQueryThresholdNs = 0;
+      inout_reader >> uiSampleInterval;
+      inout_reader >> uiSlowQueryThresholdNs;
+
+      if (m_pQueryRecorder != nullptr)
+      {
+        JPHQueryRecorderSettings settings = m_pQueryRecorder->GetSettings();
+        settings.m_uiSampleInterval = uiSampleInterval;
+        settings.m_SlowQueryThreshold = nsTime::MakeFromNanoseconds(static_cast<double>(uiSlowQueryThresholdNs));
+        m_pQueryRecorder->SetSettings(settings);
+      }
+    }
+  }
+
+  void JPHDebuggerInterface::RequestBodyDetails(nsArrayPtr<const nsUInt32> in_bodyIDs)
+  {
+    for (nsUInt32 uiBodyID : in_bodyIDs)
+    {
+      if (m_BodyDetailRequests.GetCount() >= s_uiMaxQueuedBodyDetails)
+      {
+        nsLog::Warning("JPHDebuggerInterface: More than {} bodies are waiting for their details, dropping the rest of the request.", s_uiMaxQueuedBodyDetails);
+        return;
+      }
+
+      if (!m_BodyDetailRequests.Contains(uiBodyID))
+        m_BodyDetailRequests.PushBack(uiBodyID);
+    }
+  }
+
+  void JPHDebuggerInterface::PublishBodyDetails()
+  {
+    if (m_pPhysicsSystem == nullptr)
+    {
+      m_BodyDetailRequests.Clear();
+      return;
+    }
+
+    const nsUInt32 uiNumBodies = nsMath::Min(m_BodyDetailRequests.GetCount(), s_uiMaxBodyDetailsPerStep);
+
+    m_BodyDetails.m_uiStepIndex = m_uiStepIndex;
+    m_BodyDetailResolver.Resolve(*m_pPhysicsSystem, &m_ShapeDictionary, m_pContactRecorder, m_BodyDetailRequests.GetArrayPtr().GetSubArray(0, uiNumBodies), m_BodyDetails);
+    m_BodyDetailRequests.RemoveAtAndCopy(0, uiNumBodies);
+
+    if (m_bClientConnected)
+    {
+      m_BodyDetails.Write(m_BodyDetailData);
+      Send(nsTelemetry::Reliable, Protocol::s_uiMsgBodyDetails, m_BodyDetailData.GetData(), m_BodyDetailData.GetCount());
+    }
+  }
+
+  void JPHDebuggerInterface::Send(nsTelemetry::TransmitMode mode, nsUInt32 uiMessageID, const void* pData, nsUInt32 uiNumBytes)
+  {
+    if (m_pHub == nullptr)
+    {
+      nsTelemetry::Broadcast(mode, Protocol::s_uiSystemID, uiMessageID, pData, uiNumBytes);
+      return;
+    }
+
+    // tagged with the stream, so the client can tell the systems apart
+    m_StreamMessage.Clear();
+    IO::JPHByteWriter writer(m_StreamMessage);
+    writer.Write(m_uiStreamID);
+    writer.Write(uiMessageID);
+    writer.WriteBytes(pData, uiNumBytes);
+
+    nsTelemetry::Broadcast(mode, Protocol::s_uiSystemID, Protocol::s_uiMsgStream, m_StreamMessage.GetData(), m_StreamMessage.GetCount());
+  }
+
+  void JPHDebuggerInterface::SetInterestSet(const JPHInterestSet& in_set)
+  {
+    m_InterestFilter.SetInterestSet(in_set);
+  }
+
+  void JPHDebuggerInterface::PublishShapes()
+  {
+    const bool bCapturing = m_pCaptureWriter != nullptr && m_pCaptureWriter->IsRunning();
+
+    // a new client or capture needs every shape that is still in use, otherwise only the new ones are sent
+    if (m_bClientConnected)
+    {
+      if (!m_bClientHasShapes)
+      {
+        m_ShapeDictionary.GetShapeIDs(m_ShapeIDScratch);
+        SendShapes(m_ShapeIDScratch, true, false, false);
+        m_bClientHasShapes = true;
+      }
+      else
+      {
+        SendShapes(m_NewShapeIDs, true, false, false);
+      }
+    }
+
+    if (bCapturing)
+    {
+      if (!m_bCaptureHasShapes)
+      {
+        m_ShapeDictionary.GetShapeIDs(m_ShapeIDScratch);
+        SendShapes(m_ShapeIDScratch, false, true, false);
+        m_bCaptureHasShapes = true;
+      }
+      else
+      {
+        SendShapes(m_NewShapeIDs, false, true, false);
+      }
+    }
+
+    // the recorder keeps the shapes for its dumps even while it is paused
+    if (m_pFlightRecorder != nullptr)
+    {
+      if (!m_bFlightRecorderHasShapes)
+      {
+        m_ShapeDictionary.GetShapeIDs(m_ShapeIDScratch);
+        SendShapes(m_ShapeIDScratch, false, false, true);
+        m_bFlightRecorderHasShapes = true;
+      }
+      else
+      {
+        SendShapes(m_NewShapeIDs, false, false, true);
+      }
+    }
+
+    m_bClientHasShapes &= m_bClientConnected;
+    m_bCaptureHasShapes &= bCapturing;
+    m_NewShapeIDs.Clear();
+
+    // the capture keeps all shapes, IDs are never reused, so only the client and the flight recorder are told about released shapes
+    m_ShapeDictionary.EvictReleasedShapes(m_ShapeIDScratch);
+
+    if (m_pFlightRecorder != nullptr)
+    {
+      for (nsUInt32 uiShapeID : m_ShapeIDScratch)
+      {
+        m_pFlightRecorder->ReleaseShape(uiShapeID, m_uiStepIndex);
+      }
+    }
+
+    if (m_bClientConnected && !m_ShapeIDScratch.IsEmpty())
+    {
+      nsDynamicArray<nsUInt8> message;
+      IO::JPHByteWriter writer(message);
+      writer.Write(m_ShapeIDScratch.GetCount());
+
+      for (nsUInt32 uiShapeID : m_ShapeIDScratch)
+      {
+        writer.Write(uiShapeID);
+      }
+
+      Send(nsTelemetry::Reliable, Protocol::s_uiMsgShapeRemove, message.GetData(), message.GetCount());
+    }
+  }
+
+  void JPHDebuggerInterface::SendShapes(nsArrayPtr<const nsUInt32> shapeIDs, bool bToClient, bool bToCapture, bool bToFlightRecorder)
+  {
+    for (nsUInt32 uiShapeID : shapeIDs)
+    {
+      const nsArrayPtr<const nsUInt8> data = m_ShapeDictionary.GetGeometryData(uiShapeID);
+
+      if (bToClient)
+      {
+        Send(nsTelemetry::Reliable, Protocol::s_uiMsgShapeAdd, data.GetPtr(), data.GetCount());
+      }
+
+      if (bToCapture)
+      {
+        m_pCaptureWriter->PushShape(uiShapeID, data);
+      }
+
+      if (bToFlightRecorder)
+      {
+        m_pFlightRecorder->RecordShape(uiShapeID, data);
+      }
+    }
+  }
+
+  void JPHDebuggerInterface::RegisterNewShapes(JPHBodySnapshot& inout_snapshot)
+  {
+    for (nsUInt32 uiSlot = 0; uiSlot < inout_snapshot.GetSlotCount(); ++uiSlot)
+    {
+      if (!inout_snapshot.IsValid(uiSlot) || inout_snapshot.m_ShapeIDs[uiSlot] != JPHDebuggerInterfaceDetail::s_uiUnresolvedShapeID)
+        continue;
+
+      bool bNewGeometry = false;
+      inout_snapshot.m_ShapeIDs[uiSlot] = m_ShapeDictionary.RegisterShape(m_UnresolvedShapes[uiSlot], bNewGeometry);
+
+      if (bNewGeometry)
+      {
+        m_NewShapeIDs.PushBack(inout_snapshot.m_ShapeIDs[uiSlot]);
+      }
+    }
+  }
+
+  void JPHDebuggerInterface::TelemetryEventHandler(const nsTelemetry::TelemetryEventData& e)
+  {
+    // called on the telemetry thread, only flag the change here and handle it in FrameEnd()
+    if (e.m_EventType == nsTelemetry::TelemetryEventData::ConnectedToClient)
+    {
+      m_bResyncRequested = true;
+    }
+  }
+
+  void JPHDebuggerInterface::CaptureSnapshot(JPHBodySnapshot& out_snapshot)
+  {
+    NS_PROFILE_SCOPE("JPHDebuggerInterface::CaptureSnapshot");
+
+    const nsTime startTime = nsTime::Now();
+    out_snapshot.m_uiStepIndex = m_uiStepIndex;
+
+    if (IsSleepTrackingEnabled())
+    {
+      m_ActivationTracker.RetrieveTransitions(m_Transitions);
+
+      // a new or removed body is not necessarily reported as a transition
+      if (!FindAddedAndRemovedBodies(out_snapshot.GetSlotCount()) || m_bFullCaptureRequested)
+        m_uiNumFullCapturesPending = 2;
+
+      if (m_uiNumFullCapturesPending == 0)
+      {
+        CaptureChangedBodies(out_snapshot);
+
+        m_FrameEncoder.AddChangedSlots(m_ChangedSlots);
+        m_PreviousTransitions.Swap(m_Transitions);
+        m_uiNumCapturedSlots = m_ChangedSlots.GetCount();
+        m_bCapturedChangedBodies = true;
+
+        out_snapshot.m_CaptureDuration = nsTime::Now() - startTime;
+        return;
+      }
+
+      --m_uiNumFullCapturesPending;
+      m_FrameEncoder.InvalidateAllSlots();
+      m_PreviousTransitions.Swap(m_Transitions);
+    }
+
+    nsParallelForParams params;
+    params.m_uiBinSize = JPHDebuggerInterfaceDetail::s_uiCaptureBinSize;
+    params.m_uiMaxTasksPerThread = 2;
+
+    JPHDebuggerInterfaceDetail::CaptureContext ctx;
+    ctx.m_pSnapshot = &out_snapshot;
+    ctx.m_pShapes = &m_ShapeDictionary;
+
+    if (m_pManager != nullptr)
+    {
+      // Walk the body array directly, the slot of a body is its position in that array.
+      const JPH::BodyVector& bodies = m_pManager->GetBodies();
+      out_snapshot.SetSlotCount(static_cast<nsUInt32>(bodies.size()));
+
+      m_UnresolvedShapes.SetCountUninitialized(out_snapshot.GetSlotCount());
+      ctx.m_pUnresolvedShapes = m_UnresolvedShapes.GetData();
+
+      nsTaskSystem::ParallelForIndexed(
+        0, static_cast<nsUInt32>(bodies.size()), [&bodies, &ctx](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+        {
+          for (nsUInt32 uiSlot = uiStartIndex; uiSlot < uiEndIndex; ++uiSlot)
+          {
+            const JPH::Body* pBody = bodies[uiSlot];
+
+            if (JPH::BodyManager::sIsValidBodyPointer(pBody))
+              JPHDebuggerInterfaceDetail::CaptureBody(*pBody, uiSlot, ctx);
+            else
+              ctx.m_pSnapshot->ClearSlot(uiSlot);
+          }
+        },
+        "JoltCaptureSnapshot", nsTaskNesting::Never, params);
+    }
+    else if (m_pPhysicsSystem != nullptr)
+    {
+      // Without a body manager we only get a list of body IDs, which is not sorted by slot.
+      m_pPhysicsSystem->GetBodies(m_BodyIDScratch);
+
+      nsUInt32 uiNumSlots = 0;
+      for (const JPH::BodyID& id : m_BodyIDScratch)
+      {
+        uiNumSlots = nsMath::Max(uiNumSlots, id.GetIndex() + 1);
+      }
+
+      out_snapshot.SetSlotCount(uiNumSlots);
+      out_snapshot.ClearSlots();
+
+      m_UnresolvedShapes.SetCountUninitialized(uiNumSlots);
+      ctx.m_pUnresolvedShapes = m_UnresolvedShapes.GetData();
+
+      const JPH::BodyLockInterface& lockInterface = m_pPhysicsSystem->GetBodyLockInterfaceNoLock();
+      const JPH::Array<JPH::BodyID>& ids = m_BodyIDScratch;
+
+      nsTaskSystem::ParallelForIndexed(
+        0, static_cast<nsUInt32>(ids.size()), [&ids, &lockInterface, &ctx](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+        {
+          for (nsUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+          {
+            if (const JPH::Body* pBody = lockInterface.TryGetBody(ids[i]))
+            {
+              JPHDebuggerInterfaceDetail::CaptureBody(*pBody, ids[i].GetIndex(), ctx);
+            }
+          }
+        },
+        "JoltCaptureSnapshot", nsTaskNesting::Never, params);
+
+      // slots that were not written by the loop above are free, give them a defined body ID
+      for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+      {
+        if (!out_snapshot.IsValid(uiSlot))
+          out_snapshot.m_BodyIDs[uiSlot] = JPH::BodyID::cInvalidBodyID;
+      }
+    }
+
+    if (ctx.m_iNumUnresolvedShapes > 0)
+    {
+      RegisterNewShapes(out_snapshot);
+    }
+
+    m_uiNumCapturedSlots = out_snapshot.GetSlotCount();
+    m_bCapturedChangedBodies = false;
+    out_snapshot.m_CaptureDuration = nsTime::Now() - startTime;
+  }
+
+  bool JPHDebuggerInterface::FindAddedAndRemovedBodies(nsUInt32 uiNumSlots)
+  {
+    NS_PROFILE_SCOPE("JPHDebuggerInterface::FindAddedAndRemovedBodies");
+
+    // sorted by slot, a body that replaced another one in the same slot has a new sequence number
+    m_pPhysicsSystem->GetBodies(m_BodyIDScratch);
+
+    const nsUInt32 uiNumUsedSlots = m_BodyIDScratch.empty() ? 0 : m_BodyIDScratch.back().GetIndex() + 1;
+
+    if (m_SlotMembers.GetCount() < uiNumUsedSlots)
+      m_SlotMembers.SetCount(uiNumUsedSlots, JPH::BodyID::cInvalidBodyID);
+
+    auto RemoveMembers = [this](nsUInt32 uiStartSlot, nsUInt32 uiEndSlot)
+    {
+      for (nsUInt32 uiSlot = uiStartSlot; uiSlot < uiEndSlot; ++uiSlot)
+      {
+        if (m_SlotMembers[uiSlot] != JPH::BodyID::cInvalidBodyID)
+        {
+          // the body is gone, the capture clears its slot
+          m_Transitions.PushBack(JPH::BodyID(m_SlotMembers[uiSlot]));
+          m_SlotMembers[uiSlot] = JPH::BodyID::cInvalidBodyID;
+        }
+      }
+    };
+
+    nsUInt32 uiNextSlot = 0;
+
+    for (const JPH::BodyID& id : m_BodyIDScratch)
+    {
+      const nsUInt32 uiSlot = id.GetIndex();
+      RemoveMembers(uiNextSlot, uiSlot);
+
+      if (m_SlotMembers[uiSlot] != id.GetIndexAndSequenceNumber())
+      {
+        m_Transitions.PushBack(id);
+        m_SlotMembers[uiSlot] = id.GetIndexAndSequenceNumber();
+      }
+
+      uiNextSlot = uiSlot + 1;
+    }
+
+    RemoveMembers(uiNextSlot, m_SlotMembers.GetCount());
+
+    return uiNumUsedSlots <= uiNumSlots;
+  }
+
+  void JPHDebuggerInterface::CaptureChangedBodies(JPHBodySnapshot& out_snapshot)
+  {
+    NS_PROFILE_SCOPE("JPHDebuggerInterface::CaptureChangedBodies");
+
+    // the snapshot was last written two captures ago, it misses what changed in both captures since, which
+    // is what is awake now and everything that woke up or fell asleep in between
+    const nsUInt32 uiNumSlots = out_snapshot.GetSlotCount();
+
+    if (m_SlotStamps.GetCount() < uiNumSlots)
+      m_SlotStamps.SetCount(uiNumSlots, 0);
+
+    if (++m_uiCaptureStamp == 0)
+    {
+      nsMemoryUtils::ZeroFill(m_SlotStamps.GetData(), m_SlotStamps.GetCount());
+      m_uiCaptureStamp = 1;
+    }
+
+    m_ChangedBodies.Clear();
+    m_ChangedSlots.Clear();
+
+    auto AddBody = [this, uiNumSlots](const JPH::BodyID& id)
+    {
+      const nsUInt32 uiSlot = id.GetIndex();
+
+      if (uiSlot < uiNumSlots && m_SlotStamps[uiSlot] != m_uiCaptureStamp)
+      {
+        m_SlotStamps[uiSlot] = m_uiCaptureStamp;
+        m_ChangedBodies.PushBack(id);
+        m_ChangedSlots.PushBack(uiSlot);
+      }
+    };
+
+    // nothing modifies the bodies during FrameEnd(), so the unsafe list is stable
+    for (JPH::EBodyType eType : {JPH::EBodyType::RigidBody, JPH::EBodyType::SoftBody})
+    {
+      const JPH::BodyID* pActiveBodies = m_pPhysicsSystem->GetActiveBodiesUnsafe(eType);
+      const nsUInt32 uiNumActiveBodies = m_pPhysicsSystem->GetNumActiveBodies(eType);
+
+      for (nsUInt32 i = 0; i < uiNumActiveBodies; ++i)
+        AddBody(pActiveBodies[i]);
+    }
+
+    for (const JPH::BodyID& id : m_Transitions)
+      AddBody(id);
+
+    for (const JPH::BodyID& id : m_PreviousTransitions)
+      AddBody(id);
+
+    JPHDebuggerInterfaceDetail::CaptureContext ctx;
+    ctx.m_pSnapshot = &out_snapshot;
+    ctx.m_pShapes = &m_ShapeDictionary;
+
+    m_UnresolvedShapes.SetCountUninitialized(uiNumSlots);
+    ctx.m_pUnresolvedShapes = m_UnresolvedShapes.GetData();
+
+    nsParallelForParams params;
+    params.m_uiBinSize = JPHDebuggerInterfaceDetail::s_uiCaptureBinSize;
+    params.m_uiMaxTasksPerThread = 2;
+
+    const JPH::BodyLockInterface& lockInterface = m_pPhysicsSystem->GetBodyLockInterfaceNoLock();
+    const JPH::BodyID* pBodies = m_ChangedBodies.GetData();
+
+    nsTaskSystem::ParallelForIndexed(
+      0, m_ChangedBodies.GetCount(), [pBodies, &lockInterface, &ctx](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+      {
+        for (nsUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+        {
+          const JPH::BodyID id = pBodies[i];
+
+          if (const JPH::Body* pBody = lockInterface.TryGetBody(id))
+            JPHDebuggerInterfaceDetail::CaptureBody(*pBody, id.GetIndex(), ctx);
+          else if (ctx.m_pSnapshot->m_BodyIDs[id.GetIndex()] == id.GetIndexAndSequenceNumber())
+            ctx.m_pSnapshot->ClearSlot(id.GetIndex());
+        }
+      },
+      "JoltCaptureChangedBodies", nsTaskNesting::Never, params);
+
+    if (ctx.m_iNumUnresolvedShapes > 0)
+    {
+      RegisterNewShapes(out_snapshot);
+    }
+  }
+} // namespace JDebug::API
 
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHDebuggerInterface);
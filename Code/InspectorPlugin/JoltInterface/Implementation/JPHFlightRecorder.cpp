@@ -0,0 +1,549 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Core/Console/ConsoleFunction.h>
+#include <Foundation/Time/Timestamp.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileManager.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHContactRecorder.h>
+#include <InspectorPlugin/JoltInterface/JPHFlightRecorder.h>
+
+NS_ENUMERABLE_CLASS_IMPLEMENTATION(JDebug::API::JPHFlightRecorder);
+
+namespace JPHFlightRecorderDetail
+{
+  /// The handler that was installed before the first recorder was created, called after the recorders have dumped.
+  static nsAssertHandler s_PreviousAssertHandler = nullptr;
+  static nsUInt32 s_uiNumRecorders = 0;
+
+  /// Set on the thread that writes a dump, an assert during the dump must not wait for the dump to finish.
+  static thread_local bool s_bWritingDump = false;
+
+  static JDebug::API::JPHFlightRecorderTrigger CheckBody(const JDebug::API::JPHBodySnapshot& snapshot, nsUInt32 uiSlot, float fMaxSpeedSquared, bool bCheckNaN)
+  {
+    if (!snapshot.IsValid(uiSlot))
+      return JDebug::API::JPHFlightRecorderTrigger::None;
+
+    const nsVec3& vPosition = snapshot.m_Positions[uiSlot];
+    const nsQuat& qRotation = snapshot.m_Rotations[uiSlot];
+    const nsVec3& vLinearVelocity = snapshot.m_LinearVelocities[uiSlot];
+    const nsVec3& vAngularVelocity = snapshot.m_AngularVelocities[uiSlot];
+
+    if (bCheckNaN)
+    {
+      // a single NaN or infinite component makes the sum non-finite as well
+      const float fSum = vPosition.x + vPosition.y + vPosition.z + qRotation.x + qRotation.y + qRotation.z + qRotation.w + vLinearVelocity.x + vLinearVelocity.y + vLinearVelocity.z + vAngularVelocity.x + vAngularVelocity.y + vAngularVelocity.z;
+
+      if (!nsMath::IsFinite(fSum))
+        return JDebug::API::JPHFlightRecorderTrigger::NaN;
+    }
+
+    if (vLinearVelocity.GetLengthSquared() > fMaxSpeedSquared)
+      return JDebug::API::JPHFlightRecorderTrigger::Velocity;
+
+    return JDebug::API::JPHFlightRecorderTrigger::None;
+  }
+
+  static void DumpAllRecorders()
+  {
+    for (JDebug::API::JPHFlightRecorder* pRecorder = JDebug::API::JPHFlightRecorder::GetFirstInstance(); pRecorder != nullptr; pRecorder = pRecorder->GetNextInstance())
+    {
+      pRecorder->TriggerDump(JDebug::API::JPHFlightRecorderTrigger::Manual);
+    }
+  }
+
+  static nsConsoleFunction<void()> s_ConFunc_DumpPhysicsFlightRecorder("DumpPhysicsFlightRecorder", "()", &DumpAllRecorders);
+} // namespace JPHFlightRecorderDetail
+
+namespace JDebug::API
+{
+  JPHFlightRecorder::DumpThread::DumpThread(JPHFlightRecorder* pOwner, JPHFlightRecorderTrigger eTrigger)
+    : nsThread("JDebug Flight Recorder Dump")
+    , m_pOwner(pOwner)
+    , m_eTrigger(eTrigger)
+  {
+  }
+
+  nsUInt32 JPHFlightRecorder::DumpThread::Run()
+  {
+    m_pOwner->WriteDump(m_eTrigger);
+    m_pOwner->m_bDumpFinished = true;
+    return 0;
+  }
+
+  JPHFlightRecorder::JPHFlightRecorder()
+  {
+    // the handler is shared by all recorders, it is installed with the first one
+    if (JPHFlightRecorderDetail::s_uiNumRecorders++ == 0)
+    {
+      JPHFlightRecorderDetail::s_PreviousAssertHandler = nsGetAssertHandler();
+      nsSetAssertHandler(&JPHFlightRecorder::AssertHandler);
+    }
+
+    SetSettings(JPHFlightRecorderSettings());
+  }
+
+  JPHFlightRecorder::~JPHFlightRecorder()
+  {
+    WaitForDump();
+
+    // somebody else may have installed a handler in the meantime, which then still calls ours
+    if (--JPHFlightRecorderDetail::s_uiNumRecorders == 0 && nsGetAssertHandler() == &JPHFlightRecorder::AssertHandler)
+    {
+      nsSetAssertHandler(JPHFlightRecorderDetail::s_PreviousAssertHandler);
+    }
+  }
+
+  void JPHFlightRecorder::SetSettings(const JPHFlightRecorderSettings& in_settings)
+  {
+    WaitForDump();
+
+    NS_LOCK(m_RingMutex);
+
+    m_Settings = in_settings;
+    m_Settings.m_uiMaxFrames = nsMath::Max(m_Settings.m_uiMaxFrames, 2u);
+
+    // everything is allocated here, recording only copies into it
+    m_Buffer.Clear();
+    m_Buffer.Compact();
+    m_Buffer.SetCountUninitialized(m_Settings.m_uiMemoryBudget);
+
+    m_Frames.Clear();
+    m_Frames.SetCount(m_Settings.m_uiMaxFrames);
+
+    ClearRing();
+  }
+
+  void JPHFlightRecorder::TriggerDump(JPHFlightRecorderTrigger in_eTrigger)
+  {
+    if (m_bDumping)
+      return;
+
+    m_iPendingTrigger.TestAndSet(static_cast<nsInt32>(JPHFlightRecorderTrigger::None), static_cast<nsInt32>(in_eTrigger));
+  }
+
+  bool JPHFlightRecorder::IsKeyframeNeeded() const
+  {
+    return m_uiNumKeyframes == 0 || nsTime::Now() - m_LastKeyframeTime > m_Settings.m_Duration * 0.5;
+  }
+
+  void JPHFlightRecorder::Record(nsArrayPtr<const nsUInt8> in_data, nsArrayPtr<const nsUInt8> in_records, nsUInt64 in_uiStepIndex, bool in_bKeyframe)
+  {
+    NS_PROFILE_SCOPE("JPHFlightRecorder::Record");
+
+    NS_LOCK(m_RingMutex);
+
+    if (m_bDumping)
+      return;
+
+    // a delta frame is useless without the keyframe it builds on
+    if (!in_bKeyframe && m_uiNumKeyframes == 0)
+      return;
+
+    const nsUInt32 uiSize = in_data.GetCount() + in_records.GetCount();
+
+    if (uiSize > m_Buffer.GetCount())
+    {
+      // the following frames build on this one, they are useless without it
+      ClearRing();
+      return;
+    }
+
+    const nsTime now = nsTime::Now();
+
+    // frames are never split, if the frame does not fit behind the newest one, it starts over at the beginning of the buffer
+    nsUInt32 uiOffset = m_uiWriteOffset;
+    if (uiOffset + uiSize > m_Buffer.GetCount())
+      uiOffset = 0;
+
+    while (m_uiNumFrames > 0 && (m_uiNumFrames == m_Frames.GetCount() || !IsRangeFree(uiOffset, uiSize)))
+    {
+      DropOldestFrames(1);
+    }
+
+    // the ring has to start with a keyframe, the delta frames behind a dropped keyframe cannot be decoded anymore
+    while (m_uiNumFrames > 0 && !GetFrame(0).m_bKeyframe)
+    {
+      DropOldestFrames(1);
+    }
+
+    if (!in_bKeyframe && m_uiNumKeyframes == 0)
+      return;
+
+    nsMemoryUtils::RawByteCopy(m_Buffer.GetData() + uiOffset, in_data.GetPtr(), in_data.GetCount());
+    nsMemoryUtils::RawByteCopy(m_Buffer.GetData() + uiOffset + in_data.GetCount(), in_records.GetPtr(), in_records.GetCount());
+
+    FrameEntry& frame = GetFrame(m_uiNumFrames);
+    frame.m_uiStepIndex = in_uiStepIndex;
+    frame.m_RecordTime = now;
+    frame.m_uiOffset = uiOffset;
+    frame.m_uiDataSize = in_data.GetCount();
+    frame.m_uiRecordsSize = in_records.GetCount();
+    frame.m_bKeyframe = in_bKeyframe;
+
+    ++m_uiNumFrames;
+    m_uiWriteOffset = uiOffset + uiSize;
+
+    if (in_bKeyframe)
+    {
+      ++m_uiNumKeyframes;
+      m_LastKeyframeTime = now;
+    }
+
+    // frames older than the duration are only dropped together with the delta frames that build on them,
+    // so the ring keeps the last keyframe before the duration and everything after it
+    const nsTime windowStart = now - m_Settings.m_Duration;
+
+    while (GetFrame(0).m_RecordTime < windowStart)
+    {
+      nsUInt32 uiNextKeyframe = 1;
+      while (uiNextKeyframe < m_uiNumFrames && !GetFrame(uiNextKeyframe).m_bKeyframe)
+      {
+        ++uiNextKeyframe;
+      }
+
+      if (uiNextKeyframe == m_uiNumFrames || GetFrame(uiNextKeyframe).m_RecordTime > windowStart)
+        break;
+
+      DropOldestFrames(uiNextKeyframe);
+    }
+
+    DropReleasedShapes(GetFrame(0).m_uiStepIndex);
+  }
+
+  void JPHFlightRecorder::RecordShape(nsUInt32 in_uiShapeID, nsArrayPtr<const nsUInt8> in_data)
+  {
+    NS_LOCK(m_ShapeMutex);
+
+    // the interface sends all shapes again when the recorder is attached again
+    m_Shapes[in_uiShapeID] = in_data;
+  }
+
+  void JPHFlightRecorder::ReleaseShape(nsUInt32 in_uiShapeID, nsUInt64 in_uiStepIndex)
+  {
+    NS_LOCK(m_ShapeMutex);
+
+    if (!m_Shapes.Contains(in_uiShapeID))
+      return;
+
+    NS_ASSERT_DEV(m_ReleasedShapes.IsEmpty() || m_ReleasedShapes.PeekBack().m_uiStepIndex <= in_uiStepIndex, "Shapes have to be released in step order.");
+
+    ReleasedShape& shape = m_ReleasedShapes.ExpandAndGetRef();
+    shape.m_uiShapeID = in_uiShapeID;
+    shape.m_uiStepIndex = in_uiStepIndex;
+  }
+
+  nsUInt32 JPHFlightRecorder::GetNumShapes() const
+  {
+    NS_LOCK(m_ShapeMutex);
+    return m_Shapes.GetCount();
+  }
+
+  void JPHFlightRecorder::CheckStepTime(nsTime in_stepTime)
+  {
+    if (m_Settings.m_MaxStepTime.IsPositive() && in_stepTime > m_Settings.m_MaxStepTime)
+    {
+      TriggerAutomaticDump(JPHFlightRecorderTrigger::StepTime);
+    }
+  }
+
+  void JPHFlightRecorder::CheckBodies(const JPHBodySnapshot& in_snapshot, nsArrayPtr<const nsUInt32> in_slots)
+  {
+    const bool bCheckVelocity = m_Settings.m_fMaxLinearVelocity > 0.0f;
+
+    if (!bCheckVelocity && !m_Settings.m_bDumpOnNaN)
+      return;
+
+    NS_PROFILE_SCOPE("JPHFlightRecorder::CheckBodies");
+
+    const float fMaxSpeedSquared = bCheckVelocity ? nsMath::Square(m_Settings.m_fMaxLinearVelocity) : nsMath::MaxValue<float>();
+    const nsUInt32 uiNumSlots = in_snapshot.GetSlotCount();
+    const nsUInt32 uiNumChecked = in_slots.IsEmpty() ? uiNumSlots : in_slots.GetCount();
+
+    for (nsUInt32 i = 0; i < uiNumChecked; ++i)
+    {
+      const nsUInt32 uiSlot = in_slots.IsEmpty() ? i : in_slots[i];
+
+      if (uiSlot >= uiNumSlots)
+        continue;
+
+      const JPHFlightRecorderTrigger eTrigger = JPHFlightRecorderDetail::CheckBody(in_snapshot, uiSlot, fMaxSpeedSquared, m_Settings.m_bDumpOnNaN);
+
+      if (eTrigger != JPHFlightRecorderTrigger::None)
+      {
+        TriggerAutomaticDump(eTrigger);
+        return;
+      }
+    }
+  }
+
+  void JPHFlightRecorder::CheckContacts(nsArrayPtr<const JPHContactRecord> in_contacts)
+  {
+    if (m_Settings.m_fMaxPenetration <= 0.0f)
+      return;
+
+    for (const JPHContactRecord& contact : in_contacts)
+    {
+      if (contact.m_fPenetration > m_Settings.m_fMaxPenetration)
+      {
+        TriggerAutomaticDump(JPHFlightRecorderTrigger::Penetration);
+        return;
+      }
+    }
+  }
+
+  void JPHFlightRecorder::Update()
+  {
+    FinishDump();
+
+    const JPHFlightRecorderTrigger eTrigger = static_cast<JPHFlightRecorderTrigger>(static_cast<nsInt32>(m_iPendingTrigger));
+
+    if (eTrigger == JPHFlightRecorderTrigger::None || m_bDumping)
+      return;
+
+    const nsTime now = nsTime::Now();
+
+    if (m_TriggerTime.IsZero())
+    {
+      m_TriggerTime = now;
+    }
+
+    // a manual dump is written right away, automatic ones keep recording to show what the trigger led to
+    if (eTrigger != JPHFlightRecorderTrigger::Manual && now - m_TriggerTime < m_Settings.m_PostTriggerDuration)
+      return;
+
+    {
+      NS_LOCK(m_RingMutex);
+
+      // an assert may have started a dump on another thread
+      if (m_bDumping.Set(true))
+        return;
+    }
+
+    m_pDumpThread = NS_DEFAULT_NEW(DumpThread, this, eTrigger);
+    m_pDumpThread->Start();
+  }
+
+  void JPHFlightRecorder::WaitForDump()
+  {
+    while (m_bDumping && !m_bDumpFinished)
+    {
+      nsThreadUtils::Sleep(nsTime::MakeFromMilliseconds(1));
+    }
+
+    FinishDump();
+  }
+
+  const char* JPHFlightRecorder::GetTriggerName(JPHFlightRecorderTrigger in_eTrigger)
+  {
+    switch (in_eTrigger)
+    {
+      case JPHFlightRecorderTrigger::None:
+        return "None";
+      case JPHFlightRecorderTrigger::Manual:
+        return "Manual";
+      case JPHFlightRecorderTrigger::Assert:
+        return "Assert";
+      case JPHFlightRecorderTrigger::StepTime:
+        return "StepTime";
+      case JPHFlightRecorderTrigger::Velocity:
+        return "Velocity";
+      case JPHFlightRecorderTrigger::Penetration:
+        return "Penetration";
+      case JPHFlightRecorderTrigger::NaN:
+        return "NaN";
+    }
+
+    NS_ASSERT_NOT_IMPLEMENTED;
+    return "";
+  }
+
+  bool JPHFlightRecorder::AssertHandler(const char* szSourceFile, nsUInt32 uiLine, const char* szFunction, const char* szExpression, const char* szAssertMsg)
+  {
+    for (JPHFlightRecorder* pRecorder = GetFirstInstance(); pRecorder != nullptr; pRecorder = pRecorder->GetNextInstance())
+    {
+      if (pRecorder->m_Settings.m_bDumpOnAssert)
+        pRecorder->DumpFromAssert();
+    }
+
+    if (JPHFlightRecorderDetail::s_PreviousAssertHandler == nullptr)
+      return true;
+
+    return JPHFlightRecorderDetail::s_PreviousAssertHandler(szSourceFile, uiLine, szFunction, szExpression, szAssertMsg);
+  }
+
+  bool JPHFlightRecorder::IsRangeFree(nsUInt32 uiOffset, nsUInt32 uiSize) const
+  {
+    if (m_uiNumFrames == 0)
+      return true;
+
+    // the frames occupy the bytes from the oldest frame up to m_uiWriteOffset, possibly wrapping around the end of the buffer
+    const nsUInt32 uiOldest = m_Frames[m_uiFirstFrame].m_uiOffset;
+
+    if (uiOldest < m_uiWriteOffset)
+      return uiOffset >= m_uiWriteOffset || uiOffset + uiSize <= uiOldest;
+
+    return uiOffset >= m_uiWriteOffset && uiOffset + uiSize <= uiOldest;
+  }
+
+  void JPHFlightRecorder::DropOldestFrames(nsUInt32 uiNumFrames)
+  {
+    for (nsUInt32 i = 0; i < uiNumFrames; ++i)
+    {
+      if (GetFrame(0).m_bKeyframe)
+        --m_uiNumKeyframes;
+
+      m_uiFirstFrame = (m_uiFirstFrame + 1) % m_Frames.GetCount();
+      --m_uiNumFrames;
+    }
+
+    if (m_uiNumFrames == 0)
+    {
+      m_uiFirstFrame = 0;
+      m_uiWriteOffset = 0;
+    }
+  }
+
+  void JPHFlightRecorder::ClearRing()
+  {
+    m_uiFirstFrame = 0;
+    m_uiNumFrames = 0;
+    m_uiWriteOffset = 0;
+    m_uiNumKeyframes = 0;
+  }
+
+  void JPHFlightRecorder::DropReleasedShapes(nsUInt64 uiOldestStep)
+  {
+    NS_LOCK(m_ShapeMutex);
+
+    // a frame of the release step may still reference the shape, only later ones cannot
+    nsUInt32 uiNumDropped = 0;
+    while (uiNumDropped < m_ReleasedShapes.GetCount() && m_ReleasedShapes[uiNumDropped].m_uiStepIndex < uiOldestStep)
+    {
+      m_Shapes.Remove(m_ReleasedShapes[uiNumDropped].m_uiShapeID);
+      ++uiNumDropped;
+    }
+
+    if (uiNumDropped > 0)
+    {
+      m_ReleasedShapes.RemoveAtAndCopy(0, uiNumDropped);
+    }
+  }
+
+  void JPHFlightRecorder::FinishDump()
+  {
+    if (!m_bDumpFinished.Set(false))
+      return;
+
+    if (m_pDumpThread != nullptr)
+    {
+      m_pDumpThread->Join();
+      m_pDumpThread.Clear();
+    }
+
+    {
+      // recording was paused, the frames after the dump do not build on the ones in the ring
+      NS_LOCK(m_RingMutex);
+      ClearRing();
+    }
+
+    m_iPendingTrigger = static_cast<nsInt32>(JPHFlightRecorderTrigger::None);
+    m_TriggerTime = nsTime::MakeZero();
+    m_LastDumpTime = nsTime::Now();
+    m_bDumping = false;
+  }
+
+  void JPHFlightRecorder::TriggerAutomaticDump(JPHFlightRecorderTrigger eTrigger)
+  {
+    if (m_iNumDumps > 0 && nsTime::Now() - m_LastDumpTime < m_Settings.m_TriggerCooldown)
+      return;
+
+    TriggerDump(eTrigger);
+  }
+
+  void JPHFlightRecorder::DumpFromAssert()
+  {
+    // the dump itself asserted, it is written as far as possible
+    if (JPHFlightRecorderDetail::s_bWritingDump)
+      return;
+
+    {
+      NS_LOCK(m_RingMutex);
+
+      if (m_bDumping.Set(true))
+      {
+        // a dump is already being written, the process must not end before it is done
+        while (!m_bDumpFinished)
+        {
+          nsThreadUtils::Sleep(nsTime::MakeFromMilliseconds(1));
+        }
+
+        return;
+      }
+    }
+
+    WriteDump(JPHFlightRecorderTrigger::Assert);
+    m_bDumpFinished = true;
+  }
+
+  void JPHFlightRecorder::WriteDump(JPHFlightRecorderTrigger eTrigger)
+  {
+    NS_PROFILE_SCOPE("JPHFlightRecorder::WriteDump");
+
+    if (m_uiNumFrames == 0)
+    {
+      nsLog::Warning("JPHFlightRecorder: Nothing was recorded yet, the '{}' dump is skipped.", GetTriggerName(eTrigger));
+      return;
+    }
+
+    JPHFlightRecorderDetail::s_bWritingDump = true;
+
+    const nsDateTime dt = nsDateTime::MakeFromTimestamp(nsTimestamp::CurrentTimestamp());
+
+    nsStringBuilder sPath = m_Settings.m_sDumpDirectory;
+    sPath.AppendPath("FlightRecorder_");
+    sPath.AppendFormat("{0}-{1}-{2}_{3}-{4}-{5}-{6}_{7}.jdcap", dt.GetYear(), nsArgU(dt.GetMonth(), 2, true), nsArgU(dt.GetDay(), 2, true), nsArgU(dt.GetHour(), 2, true), nsArgU(dt.GetMinute(), 2, true), nsArgU(dt.GetSecond(), 2, true), nsArgU(dt.GetMicroseconds() / 1000, 3, true), GetTriggerName(eTrigger));
+
+    nsOSFile file;
+    if (nsOSFile::CreateDirectoryStructure(m_Settings.m_sDumpDirectory).Failed() || file.Open(sPath, nsFileOpenMode::Write).Failed())
+    {
+      nsLog::Error("JPHFlightRecorder: Failed to create '{}'.", sPath);
+      JPHFlightRecorderDetail::s_bWritingDump = false;
+      return;
+    }
+
+    {
+      IO::JPHPVDFileManager sink(file);
+
+      {
+        // every frame may reference any shape that was recorded before it
+        NS_LOCK(m_ShapeMutex);
+
+        for (auto it = m_Shapes.GetIterator(); it.IsValid(); ++it)
+        {
+          sink.WriteShapeGeometry(it.Key(), it.Value());
+        }
+      }
+
+      for (nsUInt32 i = 0; i < m_uiNumFrames; ++i)
+      {
+        const FrameEntry& frame = GetFrame(i);
+
+        sink.BeginFrame(frame.m_uiStepIndex, frame.m_bKeyframe);
+        sink.WriteEncodedFrame(m_Buffer.GetArrayPtr().GetSubArray(frame.m_uiOffset, frame.m_uiDataSize));
+        sink.WriteRecords(m_Buffer.GetArrayPtr().GetSubArray(frame.m_uiOffset + frame.m_uiDataSize, frame.m_uiRecordsSize));
+        sink.EndFrame();
+      }
+
+      sink.Close();
+    }
+
+    file.Close();
+    m_iNumDumps.Increment();
+
+    nsLog::Info("JPHFlightRecorder: Dumped steps {} to {} ({}) to '{}'.", GetFrame(0).m_uiStepIndex, GetFrame(m_uiNumFrames - 1).m_uiStepIndex, GetTriggerName(eTrigger), sPath);
+
+    JPHFlightRecorderDetail::s_bWritingDump = false;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHFlightRecorder);
@@ -0,0 +1,633 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Math/BoundingBox.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHFrameEncoder.h>
+#include <InspectorPlugin/JoltInterface/JPHShapeDictionary.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/BodyID.h>
+
+namespace JPHFrameEncoderDetail
+{
+  using StateFlags = JDebug::API::JPHBodySnapshot::JPHBodyStateFlags;
+  using Encoder = JDebug::API::JPHFrameEncoder;
+
+  static constexpr nsUInt32 s_uiChangeMaskBinSize = 4096;
+
+  /// Fixed size part of every frame.
+  struct FrameHeader
+  {
+    nsUInt32 m_uiMagic;
+    nsUInt8 m_uiVersion;
+    nsUInt8 m_uiFlags;
+    nsUInt8 m_uiContent;
+    nsUInt8 m_uiReserved;
+    nsUInt64 m_uiStepIndex;
+    nsUInt32 m_uiNumSlots;
+    nsUInt32 m_uiNumRecords;
+    float m_fPositionQuantum;
+    float m_fVelocityQuantum;
+    nsInt32 m_Origin[3];
+    nsUInt32 m_uiPadding;
+  };
+
+  static_assert(sizeof(FrameHeader) == 48, "FrameHeader must not contain implicit padding, it is written to the stream as is");
+
+  static nsUInt8 GetFieldsForContent(nsBitflags<JDebug::API::JPHFrameContent> content)
+  {
+    nsUInt8 uiFields = Encoder::Field_State;
+    uiFields |= content.IsSet(JDebug::API::JPHFrameContent::Position) ? Encoder::Field_Position : 0;
+    uiFields |= content.IsSet(JDebug::API::JPHFrameContent::Rotation) ? Encoder::Field_Rotation : 0;
+    uiFields |= content.IsSet(JDebug::API::JPHFrameContent::Velocity) ? (Encoder::Field_LinearVelocity | Encoder::Field_AngularVelocity) : 0;
+    uiFields |= content.IsSet(JDebug::API::JPHFrameContent::Shape) ? Encoder::Field_Shape : 0;
+    return uiFields;
+  }
+
+  NS_ALWAYS_INLINE nsVec3I32 Quantize(const nsVec3& v, float fInvQuantum)
+  {
+    using namespace JDebug::API::IO;
+    return nsVec3I32(QuantizeFixed(v.x, fInvQuantum), QuantizeFixed(v.y, fInvQuantum), QuantizeFixed(v.z, fInvQuantum));
+  }
+
+  NS_ALWAYS_INLINE nsVec3 Dequantize(const nsVec3I32& v, float fQuantum)
+  {
+    return nsVec3(static_cast<float>(v.x) * fQuantum, static_cast<float>(v.y) * fQuantum, static_cast<float>(v.z) * fQuantum);
+  }
+
+  NS_ALWAYS_INLINE bool DiffersBy(const nsVec3I32& a, const nsVec3I32& b, nsInt32 iTolerance)
+  {
+    // quantized values span 2^31, so their difference is taken in 64 bit
+    return nsMath::Abs(static_cast<nsInt64>(a.x) - b.x) > iTolerance || nsMath::Abs(static_cast<nsInt64>(a.y) - b.y) > iTolerance ||
+           nsMath::Abs(static_cast<nsInt64>(a.z) - b.z) > iTolerance;
+  }
+
+  /// Writes v relative to vBase, use a zero base for absolute values.
+  NS_ALWAYS_INLINE void WriteVec3I32(JDebug::API::IO::JPHByteWriter& writer, const nsVec3I32& v, const nsVec3I32& vBase)
+  {
+    writer.WriteVarInt(static_cast<nsInt64>(v.x) - vBase.x);
+    writer.WriteVarInt(static_cast<nsInt64>(v.y) - vBase.y);
+    writer.WriteVarInt(static_cast<nsInt64>(v.z) - vBase.z);
+  }
+
+  /// QuantizeFixed() clamps to this, a value beyond it can only come from corrupt data.
+  static constexpr nsInt64 s_iQuantizedLimit = nsInt64(1) << 30;
+
+  NS_ALWAYS_INLINE bool IsQuantized(nsInt64 iValue)
+  {
+    return iValue >= -s_iQuantizedLimit && iValue <= s_iQuantizedLimit;
+  }
+
+  /// Reads a vector written by WriteVec3I32() with the same base. Fails if a component is outside of the range of QuantizeFixed().
+  NS_ALWAYS_INLINE bool ReadVec3I32(JDebug::API::IO::JPHByteReader& reader, const nsVec3I32& vBase, nsVec3I32& out_v)
+  {
+    nsInt64 x = 0, y = 0, z = 0;
+    if (!reader.ReadVarInt(x) || !reader.ReadVarInt(y) || !reader.ReadVarInt(z))
+      return false;
+
+    // valid differences are at most twice the limit, checking that first keeps the sums from overflowing
+    if (!IsQuantized(x / 2) || !IsQuantized(y / 2) || !IsQuantized(z / 2))
+      return false;
+
+    x += vBase.x;
+    y += vBase.y;
+    z += vBase.z;
+
+    if (!IsQuantized(x) || !IsQuantized(y) || !IsQuantized(z))
+      return false;
+
+    out_v.Set(static_cast<nsInt32>(x), static_cast<nsInt32>(y), static_cast<nsInt32>(z));
+    return true;
+  }
+
+  /// Whether the slot holds a body that is streamed, bodies outside of the interest mask look like empty slots to the client.
+  NS_ALWAYS_INLINE bool IsIncluded(const JDebug::API::JPHBodySnapshot& snapshot, const nsUInt8* pInterestMask, nsUInt32 uiSlot)
+  {
+    return snapshot.IsValid(uiSlot) && (pInterestMask == nullptr || pInterestMask[uiSlot] != 0);
+  }
+
+  template <typename T>
+  void GrowArray(nsDynamicArray<T>& ref_array, nsUInt32 uiCount, const T& initValue)
+  {
+    if (ref_array.GetCount() < uiCount)
+    {
+      ref_array.SetCount(uiCount, initValue);
+    }
+  }
+} // namespace JPHFrameEncoderDetail
+
+namespace JDebug::API
+{
+  JPHFrameEncoder::JPHFrameEncoder() = default;
+  JPHFrameEncoder::~JPHFrameEncoder() = default;
+
+  void JPHFrameEncoder::SetSettings(const JPHFrameEncoderSettings& in_settings)
+  {
+    // the client dequantizes with the values of the keyframe, the tolerances only decide which bodies are written
+    if (in_settings.m_fPositionQuantum != m_Settings.m_fPositionQuantum || in_settings.m_fVelocityQuantum != m_Settings.m_fVelocityQuantum ||
+        in_settings.m_fOriginGridSize != m_Settings.m_fOriginGridSize)
+    {
+      m_bKeyframeRequested = true;
+    }
+
+    m_Settings = in_settings;
+  }
+
+  bool JPHFrameEncoder::IsKeyframePending(nsBitflags<JPHFrameContent> in_content) const
+  {
+    if (m_bKeyframeRequested || m_LastContent != in_content)
+      return true;
+
+    return m_Settings.m_uiKeyframeInterval > 0 && m_uiFramesSinceKeyframe + 1 >= m_Settings.m_uiKeyframeInterval;
+  }
+
+  void JPHFrameEncoder::SetChangeTracking(bool in_bEnabled)
+  {
+    if (m_bChangeTracking == in_bEnabled)
+      return;
+
+    // the slots that changed while tracking was off are unknown
+    m_bChangeTracking = in_bEnabled;
+    m_bCheckAllSlots = true;
+  }
+
+  void JPHFrameEncoder::AddChangedSlots(nsArrayPtr<const nsUInt32> in_slots)
+  {
+    if (!m_bChangeTracking)
+      return;
+
+    for (nsUInt32 uiSlot : in_slots)
+    {
+      if (uiSlot >= m_SlotChanged.GetCount())
+        m_SlotChanged.SetCount(nsMath::Max(uiSlot + 1, m_SlotChanged.GetCount() * 2), 0);
+
+      if (m_SlotChanged[uiSlot] == 0)
+      {
+        m_SlotChanged[uiSlot] = 1;
+        m_ChangedSlots.PushBack(uiSlot);
+      }
+    }
+  }
+
+  void JPHFrameEncoder::UpdateChangedSlots(nsUInt32 uiNumSlots, bool bCheckedAll)
+  {
+    // slots the send rate skipped stay for a later frame, slots that do not exist anymore are dropped
+    const nsUInt32 uiSendPhase = m_uiFrameCounter % m_uiSendRate;
+    nsUInt32 uiNumKept = 0;
+
+    for (nsUInt32 uiSlot : m_ChangedSlots)
+    {
+      if (!bCheckedAll && m_uiSendRate > 1 && uiSlot < uiNumSlots && uiSlot % m_uiSendRate != uiSendPhase)
+        m_ChangedSlots[uiNumKept++] = uiSlot;
+      else
+        m_SlotChanged[uiSlot] = 0;
+    }
+
+    m_ChangedSlots.SetCountUninitialized(uiNumKept);
+  }
+
+  void JPHFrameEncoder::ResizeSentState(nsUInt32 uiNumSlots)
+  {
+    using namespace JPHFrameEncoderDetail;
+
+    GrowArray<nsUInt32>(m_SentBodyIDs, uiNumSlots, JPH::BodyID::cInvalidBodyID);
+    GrowArray<nsUInt8>(m_SentStates, uiNumSlots, 0);
+    GrowArray<nsUInt8>(m_SentMotionTypes, uiNumSlots, 0);
+    GrowArray<nsUInt32>(m_SentObjectLayers, uiNumSlots, 0);
+    GrowArray<nsUInt32>(m_SentShapeIDs, uiNumSlots, JPHShapeDictionary::s_uiInvalidShapeID);
+    GrowArray<nsVec3I32>(m_SentPositions, uiNumSlots, nsVec3I32(0, 0, 0));
+    GrowArray<nsQuat>(m_SentRotations, uiNumSlots, nsQuat::MakeIdentity());
+    GrowArray<nsVec3I32>(m_SentLinearVelocities, uiNumSlots, nsVec3I32(0, 0, 0));
+    GrowArray<nsVec3I32>(m_SentAngularVelocities, uiNumSlots, nsVec3I32(0, 0, 0));
+
+    m_ChangeMasks.SetCountUninitialized(uiNumSlots);
+  }
+
+  void JPHFrameEncoder::ComputeChangeMasks(const JPHBodySnapshot& in_snapshot, const nsUInt8* pInterestMask, const nsUInt32* pSlots, nsUInt32 uiNumChecked, nsUInt32 uiSendRate, bool bKeyframe)
+  {
+    using namespace JPHFrameEncoderDetail;
+
+    // kept in one struct, so the lambda below stays small enough for the delegate's inline storage
+    struct Context
+    {
+      const nsUInt8* m_pInterestMask;
+      const nsUInt32* m_pSlots;
+      nsUInt8 m_uiFields;
+      float m_fInvVelocityQuantum;
+      float m_fPositionToleranceSqr;
+      float m_fMinRotationDot;
+      nsInt32 m_iVelocityTolerance;
+      nsUInt32 m_uiSendRate;
+      nsUInt32 m_uiSendPhase;
+    };
+
+    Context ctx;
+    ctx.m_pInterestMask = pInterestMask;
+    ctx.m_pSlots = pSlots;
+    ctx.m_uiFields = GetFieldsForContent(m_LastContent);
+    ctx.m_fInvVelocityQuantum = 1.0f / m_Settings.m_fVelocityQuantum;
+    ctx.m_fPositionToleranceSqr = nsMath::Square(m_Settings.m_fPositionTolerance * m_fToleranceScale);
+    ctx.m_fMinRotationDot = 1.0f - m_Settings.m_fRotationTolerance * m_fToleranceScale;
+    ctx.m_iVelocityTolerance = static_cast<nsInt32>(m_Settings.m_fVelocityTolerance * m_fToleranceScale * ctx.m_fInvVelocityQuantum);
+    ctx.m_uiSendRate = uiSendRate;
+    ctx.m_uiSendPhase = m_uiFrameCounter % uiSendRate;
+
+    auto computeMasks = [this, &in_snapshot, &ctx, bKeyframe](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+    {
+      for (nsUInt32 i = uiStartIndex; i < uiEndIndex; ++i)
+      {
+        const nsUInt32 uiSlot = ctx.m_pSlots != nullptr ? ctx.m_pSlots[i] : i;
+        const bool bValid = IsIncluded(in_snapshot, ctx.m_pInterestMask, uiSlot);
+        const bool bWasValid = (m_SentStates[uiSlot] & StateFlags::Valid) != 0;
+
+        if (bKeyframe)
+        {
+          m_ChangeMasks[uiSlot] = bValid ? ctx.m_uiFields : 0;
+          continue;
+        }
+
+        // the slot is checked in another frame, the sent state stays as it is, so nothing is lost
+        if (ctx.m_uiSendRate > 1 && uiSlot % ctx.m_uiSendRate != ctx.m_uiSendPhase)
+        {
+          m_ChangeMasks[uiSlot] = 0;
+          continue;
+        }
+
+        if (!bValid)
+        {
+          // removed bodies only need to tell the client that the slot is empty now
+          m_ChangeMasks[uiSlot] = bWasValid ? Field_State : 0;
+          continue;
+        }
+
+        if (!bWasValid || m_SentBodyIDs[uiSlot] != in_snapshot.m_BodyIDs[uiSlot])
+        {
+          m_ChangeMasks[uiSlot] = ctx.m_uiFields;
+          continue;
+        }
+
+        nsUInt8 uiMask = 0;
+
+        if (m_SentStates[uiSlot] != in_snapshot.m_States[uiSlot] || m_SentMotionTypes[uiSlot] != in_snapshot.m_MotionTypes[uiSlot] ||
+            m_SentObjectLayers[uiSlot] != in_snapshot.m_ObjectLayers[uiSlot])
+        {
+          uiMask |= Field_State;
+        }
+
+        if ((ctx.m_uiFields & Field_Position) != 0)
+        {
+          const nsVec3 vSent = Dequantize(m_SentPositions[uiSlot], m_Settings.m_fPositionQuantum);
+          if ((vSent - in_snapshot.m_Positions[uiSlot]).GetLengthSquared() > ctx.m_fPositionToleranceSqr)
+            uiMask |= Field_Position;
+        }
+
+        if ((ctx.m_uiFields & Field_Rotation) != 0)
+        {
+          if (nsMath::Abs(m_SentRotations[uiSlot].Dot(in_snapshot.m_Rotations[uiSlot])) < ctx.m_fMinRotationDot)
+            uiMask |= Field_Rotation;
+        }
+
+        if ((ctx.m_uiFields & Field_LinearVelocity) != 0)
+        {
+          if (DiffersBy(Quantize(in_snapshot.m_LinearVelocities[uiSlot], ctx.m_fInvVelocityQuantum), m_SentLinearVelocities[uiSlot], ctx.m_iVelocityTolerance))
+            uiMask |= Field_LinearVelocity;
+
+          if (DiffersBy(Quantize(in_snapshot.m_AngularVelocities[uiSlot], ctx.m_fInvVelocityQuantum), m_SentAngularVelocities[uiSlot], ctx.m_iVelocityTolerance))
+            uiMask |= Field_AngularVelocity;
+        }
+
+        if ((ctx.m_uiFields & Field_Shape) != 0 && m_SentShapeIDs[uiSlot] != in_snapshot.m_ShapeIDs[uiSlot])
+        {
+          uiMask |= Field_Shape;
+        }
+
+        // a state record resets the body on the client, so it has to carry all fields
+        m_ChangeMasks[uiSlot] = (uiMask & Field_State) != 0 ? ctx.m_uiFields : uiMask;
+      }
+    };
+
+    nsParallelForParams params;
+    params.m_uiBinSize = s_uiChangeMaskBinSize;
+    params.m_uiMaxTasksPerThread = 2;
+
+    nsTaskSystem::ParallelForIndexed(0, uiNumChecked, computeMasks, "JoltEncodeChangeMasks", nsTaskNesting::Never, params);
+  }
+
+  bool JPHFrameEncoder::EncodeFrame(const JPHBodySnapshot& in_snapshot, nsBitflags<JPHFrameContent> in_content, nsDynamicArray<nsUInt8>& out_data, nsArrayPtr<const nsUInt8> in_interestMask)
+  {
+    NS_PROFILE_SCOPE("JPHFrameEncoder::EncodeFrame");
+
+    using namespace JPHFrameEncoderDetail;
+
+    const nsUInt32 uiNumSlots = in_snapshot.GetSlotCount();
+
+    NS_ASSERT_DEV(in_interestMask.IsEmpty() || in_interestMask.GetCount() >= uiNumSlots, "The interest mask needs an entry per slot ({} < {}).", in_interestMask.GetCount(), uiNumSlots);
+    const nsUInt8* pInterestMask = in_interestMask.IsEmpty() ? nullptr : in_interestMask.GetPtr();
+
+    if (m_LastContent != in_content)
+    {
+      m_LastContent = in_content;
+      m_bKeyframeRequested = true;
+    }
+
+    const bool bPeriodicKeyframe = m_Settings.m_uiKeyframeInterval > 0 && m_uiFramesSinceKeyframe + 1 >= m_Settings.m_uiKeyframeInterval;
+    const bool bKeyframe = m_bKeyframeRequested || bPeriodicKeyframe;
+
+    m_bKeyframeRequested = false;
+    m_uiFramesSinceKeyframe = bKeyframe ? 0 : m_uiFramesSinceKeyframe + 1;
+    ++m_uiFrameCounter;
+
+    ResizeSentState(uiNumSlots);
+
+    // with change tracking, a delta frame only looks at the slots that may have changed, in ascending order
+    const bool bCheckAll = !m_bChangeTracking || m_bCheckAllSlots || bKeyframe;
+    const nsUInt32* pSlots = nullptr;
+    nsUInt32 uiNumChecked = uiNumSlots;
+
+    if (!bCheckAll)
+    {
+      m_ChangedSlots.Sort();
+
+      // slots beyond the snapshot belong to removed bodies, which a smaller snapshot already removes
+      uiNumChecked = 0;
+      while (uiNumChecked < m_ChangedSlots.GetCount() && m_ChangedSlots[uiNumChecked] < uiNumSlots)
+        ++uiNumChecked;
+
+      pSlots = m_ChangedSlots.GetData();
+    }
+
+    // checking every slot with change tracking happens rarely, it must not miss the slots the send rate skips
+    ComputeChangeMasks(in_snapshot, pInterestMask, pSlots, uiNumChecked, m_bChangeTracking && bCheckAll ? 1 : m_uiSendRate, bKeyframe);
+
+    const float fInvPositionQuantum = 1.0f / m_Settings.m_fPositionQuantum;
+    const float fInvVelocityQuantum = 1.0f / m_Settings.m_fVelocityQuantum;
+
+    FrameHeader header;
+    header.m_uiMagic = s_uiFrameMagic;
+    header.m_uiVersion = s_uiFrameVersion;
+    header.m_uiFlags = bKeyframe ? Frame_Keyframe : 0;
+    header.m_uiContent = in_content.GetValue();
+    header.m_uiReserved = 0;
+    header.m_uiPadding = 0;
+    header.m_uiStepIndex = in_snapshot.m_uiStepIndex;
+    header.m_uiNumSlots = uiNumSlots;
+    header.m_uiNumRecords = 0;
+    header.m_fPositionQuantum = m_Settings.m_fPositionQuantum;
+    header.m_fVelocityQuantum = m_Settings.m_fVelocityQuantum;
+
+    // Keyframes and new bodies store their positions relative to an origin near the bodies, so the values stay small.
+    // The origin is snapped to a coarse grid, so it is stable across frames.
+    nsVec3I32 vOrigin(0, 0, 0);
+    {
+      nsBoundingBox bounds = nsBoundingBox::MakeInvalid();
+      for (nsUInt32 i = 0; i < uiNumChecked; ++i)
+      {
+        const nsUInt32 uiSlot = pSlots != nullptr ? pSlots[i] : i;
+
+        if ((m_ChangeMasks[uiSlot] & Field_State) != 0 && IsIncluded(in_snapshot, pInterestMask, uiSlot))
+          bounds.ExpandToInclude(in_snapshot.m_Positions[uiSlot]);
+      }
+
+      if (bounds.IsValid())
+      {
+        const float fGrid = m_Settings.m_fOriginGridSize;
+        const nsVec3 vCenter = bounds.GetCenter();
+        const nsVec3 vSnapped(nsMath::Round(vCenter.x / fGrid) * fGrid, nsMath::Round(vCenter.y / fGrid) * fGrid, nsMath::Round(vCenter.z / fGrid) * fGrid);
+        vOrigin = Quantize(vSnapped, fInvPositionQuantum);
+      }
+    }
+
+    header.m_Origin[0] = vOrigin.x;
+    header.m_Origin[1] = vOrigin.y;
+    header.m_Origin[2] = vOrigin.z;
+
+    out_data.Clear();
+    IO::JPHByteWriter writer(out_data);
+    writer.Write(header);
+
+    nsUInt32 uiNumRecords = 0;
+    nsUInt32 uiNextSlot = 0;
+
+    for (nsUInt32 i = 0; i < uiNumChecked; ++i)
+    {
+      const nsUInt32 uiSlot = pSlots != nullptr ? pSlots[i] : i;
+      const nsUInt8 uiMask = m_ChangeMasks[uiSlot];
+
+      if (uiMask == 0)
+      {
+        if (bKeyframe)
+          m_SentStates[uiSlot] = 0;
+
+        continue;
+      }
+
+      writer.WriteVarUInt(uiSlot - uiNextSlot);
+      writer.Write(uiMask);
+      uiNextSlot = uiSlot + 1;
+      ++uiNumRecords;
+
+      if ((uiMask & Field_State) != 0)
+      {
+        const bool bValid = IsIncluded(in_snapshot, pInterestMask, uiSlot);
+
+        m_SentBodyIDs[uiSlot] = bValid ? in_snapshot.m_BodyIDs[uiSlot] : JPH::BodyID::cInvalidBodyID;
+        m_SentStates[uiSlot] = bValid ? in_snapshot.m_States[uiSlot] : 0;
+        m_SentMotionTypes[uiSlot] = in_snapshot.m_MotionTypes[uiSlot];
+        m_SentObjectLayers[uiSlot] = in_snapshot.m_ObjectLayers[uiSlot];
+
+        writer.Write(m_SentBodyIDs[uiSlot]);
+        writer.Write(m_SentStates[uiSlot]);
+        writer.Write(m_SentMotionTypes[uiSlot]);
+        writer.WriteVarUInt(m_SentObjectLayers[uiSlot]);
+      }
+
+      if ((uiMask & Field_Position) != 0)
+      {
+        const nsVec3I32 vPosition = Quantize(in_snapshot.m_Positions[uiSlot], fInvPositionQuantum);
+        const nsVec3I32& vBase = (uiMask & Field_State) != 0 ? vOrigin : m_SentPositions[uiSlot];
+        WriteVec3I32(writer, vPosition, vBase);
+        m_SentPositions[uiSlot] = vPosition;
+      }
+
+      if ((uiMask & Field_Rotation) != 0)
+      {
+        const nsUInt32 uiPacked = IO::PackQuatSmallestThree(in_snapshot.m_Rotations[uiSlot]);
+        writer.Write(uiPacked);
+
+        // remember what the client will decode, so the tolerance check compares against the same value
+        m_SentRotations[uiSlot] = IO::UnpackQuatSmallestThree(uiPacked);
+      }
+
+      if ((uiMask & Field_LinearVelocity) != 0)
+      {
+        m_SentLinearVelocities[uiSlot] = Quantize(in_snapshot.m_LinearVelocities[uiSlot], fInvVelocityQuantum);
+        WriteVec3I32(writer, m_SentLinearVelocities[uiSlot], nsVec3I32::MakeZero());
+      }
+
+      if ((uiMask & Field_AngularVelocity) != 0)
+      {
+        m_SentAngularVelocities[uiSlot] = Quantize(in_snapshot.m_AngularVelocities[uiSlot], fInvVelocityQuantum);
+        WriteVec3I32(writer, m_SentAngularVelocities[uiSlot], nsVec3I32::MakeZero());
+      }
+
+      if ((uiMask & Field_Shape) != 0)
+      {
+        // shifted by one, so the invalid ID wraps around to zero and takes a single byte
+        m_SentShapeIDs[uiSlot] = in_snapshot.m_ShapeIDs[uiSlot];
+        writer.WriteVarUInt(static_cast<nsUInt32>(m_SentShapeIDs[uiSlot] + 1));
+      }
+    }
+
+    header.m_uiNumRecords = uiNumRecords;
+    writer.Patch(0, header);
+
+    if (m_bChangeTracking)
+    {
+      UpdateChangedSlots(uiNumSlots, bCheckAll);
+      m_bCheckAllSlots = false;
+    }
+
+    m_uiNumEncodedBodies = uiNumRecords;
+    return bKeyframe;
+  }
+
+  void JPHFrameDecoder::Reset()
+  {
+    m_bHasKeyframe = false;
+  }
+
+  nsResult JPHFrameDecoder::DecodeFrame(nsArrayPtr<const nsUInt8> in_data, JPHBodySnapshot& inout_snapshot, nsDynamicArray<nsUInt32>* out_pDecodedSlots)
+  {
+    using namespace JPHFrameEncoderDetail;
+
+    if (out_pDecodedSlots != nullptr)
+    {
+      out_pDecodedSlots->Clear();
+    }
+
+    IO::JPHByteReader reader(in_data);
+
+    FrameHeader header;
+    if (!reader.Read(header) || header.m_uiMagic != JPHFrameEncoder::s_uiFrameMagic || header.m_uiVersion != JPHFrameEncoder::s_uiFrameVersion)
+      return NS_FAILURE;
+
+    // slots are body indices, anything larger is corrupt and must not be allocated
+    if (header.m_uiNumSlots > JPH::BodyID::cMaxBodyIndex + 1)
+      return NS_FAILURE;
+
+    // the origin is quantized like the positions
+    if (!IsQuantized(header.m_Origin[0]) || !IsQuantized(header.m_Origin[1]) || !IsQuantized(header.m_Origin[2]))
+      return NS_FAILURE;
+
+    const bool bKeyframe = (header.m_uiFlags & JPHFrameEncoder::Frame_Keyframe) != 0;
+
+    if (!bKeyframe && !m_bHasKeyframe)
+      return NS_FAILURE;
+
+    const nsUInt32 uiPrevSlots = inout_snapshot.GetSlotCount();
+    inout_snapshot.SetSlotCount(header.m_uiNumSlots);
+    GrowArray<nsVec3I32>(m_Positions, header.m_uiNumSlots, nsVec3I32(0, 0, 0));
+
+    if (bKeyframe)
+    {
+      inout_snapshot.ClearSlots();
+      m_bHasKeyframe = true;
+    }
+    else
+    {
+      for (nsUInt32 uiSlot = uiPrevSlots; uiSlot < header.m_uiNumSlots; ++uiSlot)
+        inout_snapshot.ClearSlot(uiSlot);
+    }
+
+    inout_snapshot.m_uiStepIndex = header.m_uiStepIndex;
+
+    const nsVec3I32 vOrigin(header.m_Origin[0], header.m_Origin[1], header.m_Origin[2]);
+    nsUInt32 uiNextSlot = 0;
+
+    for (nsUInt32 uiRecord = 0; uiRecord < header.m_uiNumRecords; ++uiRecord)
+    {
+      nsUInt64 uiSkip = 0;
+      nsUInt8 uiMask = 0;
+      if (!reader.ReadVarUInt(uiSkip) || !reader.Read(uiMask))
+        return NS_FAILURE;
+
+      const nsUInt64 uiSlot = uiNextSlot + uiSkip;
+      if (uiSlot >= header.m_uiNumSlots)
+        return NS_FAILURE;
+
+      uiNextSlot = static_cast<nsUInt32>(uiSlot) + 1;
+
+      if (out_pDecodedSlots != nullptr)
+      {
+        out_pDecodedSlots->PushBack(static_cast<nsUInt32>(uiSlot));
+      }
+
+      if ((uiMask & JPHFrameEncoder::Field_State) != 0)
+      {
+        nsUInt64 uiLayer = 0;
+        reader.Read(inout_snapshot.m_BodyIDs[uiSlot]);
+        reader.Read(inout_snapshot.m_States[uiSlot]);
+        reader.Read(inout_snapshot.m_MotionTypes[uiSlot]);
+        reader.ReadVarUInt(uiLayer);
+        inout_snapshot.m_ObjectLayers[uiSlot] = static_cast<nsUInt32>(uiLayer);
+
+        // fields that are not part of the stream get defined values when a body first shows up
+        inout_snapshot.m_Positions[uiSlot].SetZero();
+        inout_snapshot.m_Rotations[uiSlot] = nsQuat::MakeIdentity();
+        inout_snapshot.m_LinearVelocities[uiSlot].SetZero();
+        inout_snapshot.m_AngularVelocities[uiSlot].SetZero();
+        inout_snapshot.m_ShapeIDs[uiSlot] = JPHShapeDictionary::s_uiInvalidShapeID;
+        m_Positions[uiSlot] = vOrigin;
+      }
+
+      if ((uiMask & JPHFrameEncoder::Field_Position) != 0)
+      {
+        const nsVec3I32 vBase = (uiMask & JPHFrameEncoder::Field_State) != 0 ? vOrigin : m_Positions[uiSlot];
+
+        if (!ReadVec3I32(reader, vBase, m_Positions[uiSlot]))
+          return NS_FAILURE;
+
+        inout_snapshot.m_Positions[uiSlot] = Dequantize(m_Positions[uiSlot], header.m_fPositionQuantum);
+      }
+
+      if ((uiMask & JPHFrameEncoder::Field_Rotation) != 0)
+      {
+        nsUInt32 uiPacked = 0;
+        reader.Read(uiPacked);
+        inout_snapshot.m_Rotations[uiSlot] = IO::UnpackQuatSmallestThree(uiPacked);
+      }
+
+      if ((uiMask & JPHFrameEncoder::Field_LinearVelocity) != 0)
+      {
+        nsVec3I32 vVelocity;
+        if (!ReadVec3I32(reader, nsVec3I32::MakeZero(), vVelocity))
+          return NS_FAILURE;
+
+        inout_snapshot.m_LinearVelocities[uiSlot] = Dequantize(vVelocity, header.m_fVelocityQuantum);
+      }
+
+      if ((uiMask & JPHFrameEncoder::Field_AngularVelocity) != 0)
+      {
+        nsVec3I32 vVelocity;
+        if (!ReadVec3I32(reader, nsVec3I32::MakeZero(), vVelocity))
+          return NS_FAILURE;
+
+        inout_snapshot.m_AngularVelocities[uiSlot] = Dequantize(vVelocity, header.m_fVelocityQuantum);
+      }
+
+      if ((uiMask & JPHFrameEncoder::Field_Shape) != 0)
+      {
+        nsUInt64 uiShapeID = 0;
+        reader.ReadVarUInt(uiShapeID);
+        inout_snapshot.m_ShapeIDs[uiSlot] = static_cast<nsUInt32>(uiShapeID - 1);
+      }
+
+      if (reader.HasFailed())
+        return NS_FAILURE;
+    }
+
+    return NS_SUCCESS;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHFrameEncoder);
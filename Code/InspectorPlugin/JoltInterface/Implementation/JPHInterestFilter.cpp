@@ -0,0 +1,222 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/IO/Stream.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHInterestFilter.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhaseQuery.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JPHInterestFilterDetail
+{
+  static constexpr nsUInt8 s_uiHitMargin = 1;
+  static constexpr nsUInt8 s_uiHitRegion = 2;
+
+  /// Writes the hits of a broad phase query straight into the per slot array, so nothing is allocated.
+  class MarkHitsCollector final : public JPH::CollideShapeBodyCollector
+  {
+  public:
+    MarkHitsCollector(nsArrayPtr<nsUInt8> hits, nsUInt8 uiMark)
+      : m_Hits(hits)
+      , m_uiMark(uiMark)
+    {
+    }
+
+    virtual void AddHit(const JPH::BodyID& inBodyID) override
+    {
+      const nsUInt32 uiSlot = inBodyID.GetIndex();
+
+      // bodies added after the snapshot was taken are not part of the frame anyway
+      if (uiSlot < m_Hits.GetCount())
+        m_Hits[uiSlot] = nsMath::Max(m_Hits[uiSlot], m_uiMark);
+    }
+
+  private:
+    nsArrayPtr<nsUInt8> m_Hits;
+    nsUInt8 m_uiMark = 0;
+  };
+
+  class LayerMaskFilter final : public JPH::ObjectLayerFilter
+  {
+  public:
+    explicit LayerMaskFilter(const JDebug::API::JPHInterestSet& set)
+      : m_Set(set)
+    {
+    }
+
+    virtual bool ShouldCollide(JPH::ObjectLayer inLayer) const override
+    {
+      return m_Set.IsLayerSelected(static_cast<nsUInt32>(inLayer));
+    }
+
+  private:
+    const JDebug::API::JPHInterestSet& m_Set;
+  };
+
+  static JPH::AABox ToAABox(const nsBoundingBox& box)
+  {
+    return JPH::AABox(JPH::Vec3(box.m_vMin.x, box.m_vMin.y, box.m_vMin.z), JPH::Vec3(box.m_vMax.x, box.m_vMax.y, box.m_vMax.z));
+  }
+} // namespace JPHInterestFilterDetail
+
+namespace JDebug::API
+{
+  nsResult JPHInterestSet::Write(nsStreamWriter& inout_stream) const
+  {
+    inout_stream << s_uiVersion;
+    inout_stream << m_uiObjectLayerMask;
+    NS_SUCCEED_OR_RETURN(inout_stream.WriteArray(m_Regions));
+    NS_SUCCEED_OR_RETURN(inout_stream.WriteArray(m_BodyIDs));
+
+    return NS_SUCCESS;
+  }
+
+  nsResult JPHInterestSet::Read(nsStreamReader& inout_stream)
+  {
+    nsUInt8 uiVersion = 0;
+    inout_stream >> uiVersion;
+
+    if (uiVersion != s_uiVersion)
+      return NS_FAILURE;
+
+    inout_stream >> m_uiObjectLayerMask;
+    NS_SUCCEED_OR_RETURN(inout_stream.ReadArray(m_Regions));
+    NS_SUCCEED_OR_RETURN(inout_stream.ReadArray(m_BodyIDs));
+
+    return NS_SUCCESS;
+  }
+
+  JPHInterestFilter::JPHInterestFilter() = default;
+  JPHInterestFilter::~JPHInterestFilter() = default;
+
+  void JPHInterestFilter::SetInterestSet(const JPHInterestSet& in_set)
+  {
+    m_InterestSet = in_set;
+  }
+
+  void JPHInterestFilter::Update(const JPH::PhysicsSystem* in_pPhysicsSystem, const JPHBodySnapshot& in_snapshot)
+  {
+    NS_PROFILE_SCOPE("JPHInterestFilter::Update");
+
+    using namespace JPHInterestFilterDetail;
+
+    const nsUInt32 uiNumSlots = in_snapshot.GetSlotCount();
+
+    m_Hits.SetCountUninitialized(uiNumSlots);
+    m_Mask.SetCount(uiNumSlots, 0);
+    m_ChangedSlots.Clear();
+
+    if (m_TimeToLive.GetCount() < uiNumSlots)
+      m_TimeToLive.SetCount(uiNumSlots, 0);
+
+    if (m_InterestSet.m_Regions.IsEmpty() && m_InterestSet.m_BodyIDs.IsEmpty())
+    {
+      // only the layer mask filters, that does not need any hysteresis
+      for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+      {
+        m_Hits[uiSlot] = m_InterestSet.IsLayerSelected(in_snapshot.m_ObjectLayers[uiSlot]) ? s_uiHitRegion : 0;
+      }
+    }
+    else
+    {
+      nsMemoryUtils::ZeroFill(m_Hits.GetData(), uiNumSlots);
+
+      MarkRegions(in_pPhysicsSystem, in_snapshot);
+
+      for (nsUInt32 uiBodyID : m_InterestSet.m_BodyIDs)
+      {
+        const nsUInt32 uiSlot = JPH::BodyID(uiBodyID).GetIndex();
+
+        if (uiSlot < uiNumSlots && in_snapshot.m_BodyIDs[uiSlot] == uiBodyID)
+          m_Hits[uiSlot] = s_uiHitRegion;
+      }
+    }
+
+    const nsUInt8 uiTimeToLive = static_cast<nsUInt8>(nsMath::Min<nsUInt32>(m_Settings.m_uiLingerSteps + 1u, 255u));
+
+    m_uiNumSelectedBodies = 0;
+
+    for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+    {
+      nsUInt8& uiSlotTimeToLive = m_TimeToLive[uiSlot];
+
+      if (!in_snapshot.IsValid(uiSlot))
+      {
+        // the slot may be reused by another body, which must not inherit the state
+        uiSlotTimeToLive = 0;
+      }
+      else if (m_Hits[uiSlot] == s_uiHitRegion || (m_Hits[uiSlot] == s_uiHitMargin && uiSlotTimeToLive > 0))
+      {
+        uiSlotTimeToLive = uiTimeToLive;
+      }
+      else if (uiSlotTimeToLive > 0)
+      {
+        --uiSlotTimeToLive;
+      }
+
+      const nsUInt8 uiMask = uiSlotTimeToLive > 0 ? 1 : 0;
+
+      if (m_Mask[uiSlot] != uiMask)
+      {
+        m_Mask[uiSlot] = uiMask;
+        m_ChangedSlots.PushBack(uiSlot);
+      }
+
+      m_uiNumSelectedBodies += uiMask;
+    }
+  }
+
+  void JPHInterestFilter::MarkRegions(const JPH::PhysicsSystem* pPhysicsSystem, const JPHBodySnapshot& snapshot)
+  {
+    using namespace JPHInterestFilterDetail;
+
+    const float fMargin = nsMath::Max(0.0f, m_Settings.m_fRegionMargin);
+
+    if (pPhysicsSystem != nullptr)
+    {
+      const JPH::BroadPhaseQuery& query = pPhysicsSystem->GetBroadPhaseQuery();
+      const LayerMaskFilter layerFilter(m_InterestSet);
+
+      MarkHitsCollector marginCollector(m_Hits.GetArrayPtr(), s_uiHitMargin);
+      MarkHitsCollector regionCollector(m_Hits.GetArrayPtr(), s_uiHitRegion);
+
+      for (const nsBoundingBox& region : m_InterestSet.m_Regions)
+      {
+        nsBoundingBox expanded = region;
+        expanded.Grow(nsVec3(fMargin));
+
+        query.CollideAABox(ToAABox(expanded), marginCollector, {}, layerFilter);
+        query.CollideAABox(ToAABox(region), regionCollector, {}, layerFilter);
+      }
+
+      return;
+    }
+
+    // without a physics system only the body positions are known
+    for (nsUInt32 uiSlot = 0; uiSlot < snapshot.GetSlotCount(); ++uiSlot)
+    {
+      if (!snapshot.IsValid(uiSlot) || !m_InterestSet.IsLayerSelected(snapshot.m_ObjectLayers[uiSlot]))
+        continue;
+
+      const nsVec3& vPosition = snapshot.m_Positions[uiSlot];
+
+      for (const nsBoundingBox& region : m_InterestSet.m_Regions)
+      {
+        if (region.Contains(vPosition))
+        {
+          m_Hits[uiSlot] = s_uiHitRegion;
+          break;
+        }
+
+        nsBoundingBox expanded = region;
+        expanded.Grow(nsVec3(fMargin));
+
+        if (expanded.Contains(vPosition))
+          m_Hits[uiSlot] = s_uiHitMargin;
+      }
+    }
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHInterestFilter);
@@ -0,0 +1,202 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHJobSystemBenchmark.h>
+#include <InspectorPlugin/JoltInterface/JPHMemory.h>
+#include <InspectorPlugin/JoltInterface/JPHTaskJobSystem.h>
+
+#include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JDebug::API
+{
+  namespace JPHJobSystemBenchmarkDetail
+  {
+    static constexpr JPH::ObjectLayer s_StaticLayer = 0;
+    static constexpr JPH::ObjectLayer s_DynamicLayer = 1;
+    static constexpr JPH::uint s_uiMaxJobs = JPH::cMaxPhysicsJobs;
+    static constexpr JPH::uint s_uiMaxBarriers = JPH::cMaxPhysicsBarriers;
+
+    class BroadPhaseLayers final : public JPH::BroadPhaseLayerInterface
+    {
+    public:
+      virtual JPH::uint GetNumBroadPhaseLayers() const override { return 2; }
+      virtual JPH::BroadPhaseLayer GetBroadPhaseLayer(JPH::ObjectLayer inLayer) const override { return JPH::BroadPhaseLayer(static_cast<JPH::uint8>(inLayer)); }
+
+#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
+      virtual const char* GetBroadPhaseLayerName(JPH::BroadPhaseLayer inLayer) const override
+      {
+        return inLayer == JPH::BroadPhaseLayer(s_StaticLayer) ? "Static" : "Dynamic";
+      }
+#endif
+    };
+
+    class ObjectVsBroadPhaseFilter final : public JPH::ObjectVsBroadPhaseLayerFilter
+    {
+    public:
+      virtual bool ShouldCollide(JPH::ObjectLayer inLayer1, JPH::BroadPhaseLayer inLayer2) const override
+      {
+        return inLayer1 == s_DynamicLayer || inLayer2 == JPH::BroadPhaseLayer(s_DynamicLayer);
+      }
+    };
+
+    class ObjectPairFilter final : public JPH::ObjectLayerPairFilter
+    {
+    public:
+      virtual bool ShouldCollide(JPH::ObjectLayer inLayer1, JPH::ObjectLayer inLayer2) const override
+      {
+        return inLayer1 == s_DynamicLayer || inLayer2 == s_DynamicLayer;
+      }
+    };
+
+    struct StepTimes
+    {
+      nsTime m_Average;
+      nsTime m_Min;
+    };
+
+    /// Builds a floor with piles of boxes above it, then measures the step times with the given job system.
+    static StepTimes SimulateScene(const JPHJobSystemBenchmarkSettings& settings, JPH::JobSystem& jobSystem)
+    {
+      const BroadPhaseLayers broadPhaseLayers;
+      const ObjectVsBroadPhaseFilter objectVsBroadPhaseFilter;
+      const ObjectPairFilter objectPairFilter;
+
+      const JPH::uint uiMaxBodies = settings.m_uiNumBodies + 1;
+
+      JPH::PhysicsSystem physicsSystem;
+
+      {
+        JPHMemory::ScopedCategory category(JPHAllocationCategory::Contacts);
+        physicsSystem.Init(uiMaxBodies, 0, uiMaxBodies, uiMaxBodies * 4, broadPhaseLayers, objectVsBroadPhaseFilter, objectPairFilter);
+      }
+
+      JPH::TempAllocatorImpl tempAllocator(64 * 1024 * 1024);
+      JPH::BodyInterface& bodyInterface = physicsSystem.GetBodyInterfaceNoLock();
+
+      // piles of 8 boxes in a square grid, so contacts and islands are formed once they land
+      const nsUInt32 uiNumPiles = nsMath::Max(1u, settings.m_uiNumBodies / 8);
+      const nsUInt32 uiGridSize = static_cast<nsUInt32>(nsMath::Ceil(nsMath::Sqrt(static_cast<float>(uiNumPiles))));
+      const float fSpacing = 3.0f;
+      const float fHalfExtent = 0.5f * uiGridSize * fSpacing + 10.0f;
+
+      JPH::RefConst<JPH::Shape> pFloor;
+      JPH::RefConst<JPH::Shape> pBox;
+
+      {
+        JPHMemory::ScopedCategory category(JPHAllocationCategory::Shapes);
+        pFloor = new JPH::BoxShape(JPH::Vec3(fHalfExtent, 1.0f, fHalfExtent));
+        pBox = new JPH::BoxShape(JPH::Vec3::sReplicate(0.5f));
+      }
+
+      {
+        // CreateAndAddBody() also inserts into the broad phase, the bodies are the larger part
+        JPHMemory::ScopedCategory category(JPHAllocationCategory::Bodies);
+
+        bodyInterface.CreateAndAddBody(JPH::BodyCreationSettings(pFloor, JPH::RVec3(0, -1, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Static, s_StaticLayer), JPH::EActivation::DontActivate);
+
+        for (nsUInt32 i = 0; i < settings.m_uiNumBodies; ++i)
+        {
+          const nsUInt32 uiPile = i / 8;
+          const nsUInt32 uiLevel = i % 8;
+
+          const float x = (static_cast<float>(uiPile % uiGridSize) - 0.5f * uiGridSize) * fSpacing;
+          const float z = (static_cast<float>(uiPile / uiGridSize) - 0.5f * uiGridSize) * fSpacing;
+          const float y = 1.0f + uiLevel * 1.2f;
+
+          // slightly rotated, so the piles topple
+          const JPH::Quat rotation = JPH::Quat::sRotation(JPH::Vec3::sAxisY(), 0.1f * uiLevel) * JPH::Quat::sRotation(JPH::Vec3::sAxisX(), 0.05f * (uiPile % 5));
+
+          bodyInterface.CreateAndAddBody(JPH::BodyCreationSettings(pBox, JPH::RVec3(x, y, z), rotation, JPH::EMotionType::Dynamic, s_DynamicLayer), JPH::EActivation::Activate);
+        }
+      }
+
+      {
+        JPHMemory::ScopedCategory category(JPHAllocationCategory::BroadPhase);
+        physicsSystem.OptimizeBroadPhase();
+      }
+
+      for (nsUInt32 i = 0; i < settings.m_uiNumWarmupSteps; ++i)
+      {
+        physicsSystem.Update(settings.m_fDeltaTime, 1, &tempAllocator, &jobSystem);
+      }
+
+      StepTimes times;
+      times.m_Min = nsTime::MakeFromHours(1);
+
+      nsTime totalTime;
+
+      for (nsUInt32 i = 0; i < settings.m_uiNumSteps; ++i)
+      {
+        const nsTime startTime = nsTime::Now();
+        physicsSystem.Update(settings.m_fDeltaTime, 1, &tempAllocator, &jobSystem);
+        const nsTime stepTime = nsTime::Now() - startTime;
+
+        totalTime += stepTime;
+        times.m_Min = nsMath::Min(times.m_Min, stepTime);
+      }
+
+      times.m_Average = totalTime / static_cast<double>(nsMath::Max(1u, settings.m_uiNumSteps));
+      return times;
+    }
+  } // namespace JPHJobSystemBenchmarkDetail
+
+  void JPHJobSystemBenchmark::Run(const JPHJobSystemBenchmarkSettings& in_settings, nsDynamicArray<JPHJobSystemBenchmarkResult>& out_results)
+  {
+    using namespace JPHJobSystemBenchmarkDetail;
+
+    NS_LOG_BLOCK("JPHJobSystemBenchmark");
+
+    out_results.Clear();
+
+    const nsUInt32 uiPrevShortWorkers = nsTaskSystem::GetNumAllocatedWorkerThreads(nsWorkerThreadType::ShortTasks);
+    const nsUInt32 uiPrevLongWorkers = nsTaskSystem::GetNumAllocatedWorkerThreads(nsWorkerThreadType::LongTasks);
+
+    for (nsUInt32 uiNumThreads = 2; uiNumThreads <= in_settings.m_uiMaxThreads; uiNumThreads *= 2)
+    {
+      JPHJobSystemBenchmarkResult& result = out_results.ExpandAndGetRef();
+      result.m_uiNumThreads = uiNumThreads;
+
+      {
+        JPH::JobSystemThreadPool threadPool(s_uiMaxJobs, s_uiMaxBarriers, static_cast<int>(uiNumThreads) - 1);
+
+        const StepTimes times = SimulateScene(in_settings, threadPool);
+        result.m_ThreadPoolAverage = times.m_Average;
+        result.m_ThreadPoolMin = times.m_Min;
+      }
+
+      {
+        nsTaskSystem::SetWorkerThreadCount(static_cast<nsInt32>(uiNumThreads) - 1, static_cast<nsInt32>(uiPrevLongWorkers));
+
+        JPHTaskJobSystem taskJobSystem(s_uiMaxJobs, s_uiMaxBarriers, in_settings.m_eTaskPriority);
+
+        const StepTimes times = SimulateScene(in_settings, taskJobSystem);
+        result.m_TaskSystemAverage = times.m_Average;
+        result.m_TaskSystemMin = times.m_Min;
+      }
+
+      nsLog::Dev("{} threads done", uiNumThreads);
+    }
+
+    nsTaskSystem::SetWorkerThreadCount(static_cast<nsInt32>(uiPrevShortWorkers), static_cast<nsInt32>(uiPrevLongWorkers));
+  }
+
+  void JPHJobSystemBenchmark::LogResults(nsArrayPtr<const JPHJobSystemBenchmarkResult> in_results)
+  {
+    NS_LOG_BLOCK("JPHJobSystemBenchmark Results");
+
+    nsLog::Info("Threads | ThreadPool avg / min (ms) | TaskSystem avg / min (ms) | Speedup");
+
+    for (const JPHJobSystemBenchmarkResult& result : in_results)
+    {
+      const double fSpeedup = result.m_TaskSystemAverage.IsPositive() ? result.m_ThreadPoolAverage.GetSeconds() / result.m_TaskSystemAverage.GetSeconds() : 0.0;
+
+      nsLog::Info("{} | {} / {} | {} / {} | {}", nsArgI(result.m_uiNumThreads, 7), nsArgF(result.m_ThreadPoolAverage.GetMilliseconds(), 3), nsArgF(result.m_ThreadPoolMin.GetMilliseconds(), 3),
+        nsArgF(result.m_TaskSystemAverage.GetMilliseconds(), 3), nsArgF(result.m_TaskSystemMin.GetMilliseconds(), 3), nsArgF(fSpeedup, 2));
+    }
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHJobSystemBenchmark);
@@ -0,0 +1,185 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Memory/CommonAllocators.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <InspectorPlugin/JoltInterface/JPHMemory.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Core/Memory.h>
+
+namespace JPHMemoryDetail
+{
+  using JPHAllocationCategory = JDebug::API::JPHAllocationCategory;
+
+  /// Stored right in front of every block, the offset leads back to what the allocator returned.
+  struct BlockHeader
+  {
+    nsUInt32 m_uiOffset;
+    JPHAllocationCategory::Enum m_eCategory;
+  };
+
+  /// JPH::Allocate() has to return memory that is suitably aligned for any type, like malloc() does.
+  static constexpr size_t s_uiMinAlignment = 16;
+  static_assert(sizeof(BlockHeader) <= s_uiMinAlignment);
+
+  static nsProxyAllocator* s_pRootAllocator = nullptr;
+  static nsProxyAllocator* s_pAllocators[JPHAllocationCategory::ENUM_COUNT] = {};
+  static nsAtomicInteger64 s_iNumLiveAllocations;
+
+  /// The category of the innermost JPHMemory::ScopedCategory of the thread.
+  static thread_local JPHAllocationCategory::Enum t_eCategory = JPHAllocationCategory::Default;
+
+  static void* AllocateBlock(size_t uiSize, size_t uiAlign, JPHAllocationCategory::Enum eCategory)
+  {
+    // the header lives in the padding in front of the block, which is a whole alignment unit so the block stays aligned
+    uiAlign = nsMath::Max(uiAlign, s_uiMinAlignment);
+
+    nsUInt8* pMemory = static_cast<nsUInt8*>(s_pAllocators[eCategory]->Allocate(uiSize + uiAlign, uiAlign));
+    nsUInt8* pBlock = pMemory + uiAlign;
+
+    BlockHeader* pHeader = reinterpret_cast<BlockHeader*>(pBlock) - 1;
+    pHeader->m_uiOffset = static_cast<nsUInt32>(uiAlign);
+    pHeader->m_eCategory = eCategory;
+
+    s_iNumLiveAllocations.Increment();
+    return pBlock;
+  }
+
+  static void FreeBlock(void* pBlock)
+  {
+    if (pBlock == nullptr)
+      return;
+
+    const BlockHeader* pHeader = reinterpret_cast<const BlockHeader*>(pBlock) - 1;
+    s_pAllocators[pHeader->m_eCategory]->Deallocate(static_cast<nsUInt8*>(pBlock) - pHeader->m_uiOffset);
+
+    s_iNumLiveAllocations.Decrement();
+  }
+
+  static void* Allocate(size_t uiSize)
+  {
+    return AllocateBlock(uiSize, s_uiMinAlignment, t_eCategory);
+  }
+
+  static void* Reallocate(void* pBlock, size_t uiOldSize, size_t uiNewSize)
+  {
+    if (pBlock == nullptr)
+      return Allocate(uiNewSize);
+
+    // a growing array stays in the category it was created in
+    const BlockHeader* pHeader = reinterpret_cast<const BlockHeader*>(pBlock) - 1;
+    void* pNewBlock = AllocateBlock(uiNewSize, s_uiMinAlignment, pHeader->m_eCategory);
+
+    nsMemoryUtils::Copy(static_cast<nsUInt8*>(pNewBlock), static_cast<const nsUInt8*>(pBlock), nsMath::Min(uiOldSize, uiNewSize));
+    FreeBlock(pBlock);
+
+    return pNewBlock;
+  }
+
+  static void* AlignedAllocate(size_t uiSize, size_t uiAlignment)
+  {
+    return AllocateBlock(uiSize, uiAlignment, t_eCategory);
+  }
+} // namespace JPHMemoryDetail
+
+namespace JDebug::API
+{
+  const char* JPHAllocationCategory::GetName(Enum in_eCategory)
+  {
+    switch (in_eCategory)
+    {
+      case General:
+        return "General";
+      case Bodies:
+        return "Bodies";
+      case Shapes:
+        return "Shapes";
+      case BroadPhase:
+        return "BroadPhase";
+      case Contacts:
+        return "Contacts";
+      default:
+        return "Unknown";
+    }
+  }
+
+  JPHMemory::ScopedCategory::ScopedCategory(JPHAllocationCategory::Enum eCategory)
+  {
+    m_ePreviousCategory = JPHMemoryDetail::t_eCategory;
+    JPHMemoryDetail::t_eCategory = eCategory;
+  }
+
+  JPHMemory::ScopedCategory::~ScopedCategory()
+  {
+    JPHMemoryDetail::t_eCategory = m_ePreviousCategory;
+  }
+
+  void JPHMemory::Install()
+  {
+#ifdef JPH_DISABLE_CUSTOM_ALLOCATOR
+    nsLog::Warning("JPHMemory: Jolt was built with JPH_DISABLE_CUSTOM_ALLOCATOR, its allocations cannot be tracked.");
+#else
+    using namespace JPHMemoryDetail;
+
+    if (s_pRootAllocator != nullptr)
+      return;
+
+    // Jolt asks for alignments above 16 bytes (JPH_CACHE_LINE_SIZE), the default allocator does not provide them
+    s_pRootAllocator = NS_DEFAULT_NEW(nsProxyAllocator, "Jolt", nsFoundation::GetAlignedAllocator());
+
+    nsStringBuilder sName;
+    for (nsUInt32 i = 0; i < JPHAllocationCategory::ENUM_COUNT; ++i)
+    {
+      sName.SetFormat("Jolt/{}", JPHAllocationCategory::GetName(static_cast<JPHAllocationCategory::Enum>(i)));
+      s_pAllocators[i] = NS_DEFAULT_NEW(nsProxyAllocator, sName, s_pRootAllocator);
+    }
+
+    JPH::Allocate = &JPHMemoryDetail::Allocate;
+    JPH::Reallocate = &JPHMemoryDetail::Reallocate;
+    JPH::Free = &JPHMemoryDetail::FreeBlock;
+    JPH::AlignedAllocate = &JPHMemoryDetail::AlignedAllocate;
+    JPH::AlignedFree = &JPHMemoryDetail::FreeBlock;
+#endif
+  }
+
+  void JPHMemory::Uninstall()
+  {
+    using namespace JPHMemoryDetail;
+
+    if (s_pRootAllocator == nullptr)
+      return;
+
+    if (s_iNumLiveAllocations > 0)
+    {
+      nsLog::Error("JPHMemory: {} Jolt allocations are still alive, the allocation hooks stay installed.", static_cast<nsInt64>(s_iNumLiveAllocations));
+      return;
+    }
+
+    // the plugin may get unloaded, Jolt must not keep pointers into it
+    JPH::RegisterDefaultAllocator();
+
+    for (nsProxyAllocator*& pAllocator : s_pAllocators)
+    {
+      NS_DEFAULT_DELETE(pAllocator);
+    }
+
+    NS_DEFAULT_DELETE(s_pRootAllocator);
+  }
+
+  bool JPHMemory::IsInstalled()
+  {
+    return JPHMemoryDetail::s_pRootAllocator != nullptr;
+  }
+
+  nsAllocator* JPHMemory::GetAllocator(JPHAllocationCategory::Enum in_eCategory)
+  {
+    return JPHMemoryDetail::s_pAllocators[in_eCategory];
+  }
+
+  nsUInt64 JPHMemory::GetNumLiveAllocations()
+  {
+    return static_cast<nsUInt64>(static_cast<nsInt64>(JPHMemoryDetail::s_iNumLiveAllocations));
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHMemory);
@@ -0,0 +1,104 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Profiling/Profiling.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <InspectorPlugin/JoltInterface/JPHProfilerBridge.h>
+#include <InspectorPlugin/JoltInterface/JPHStepStatistics.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Core/Profiler.h>
+
+namespace JPHProfilerBridgeDetail
+{
+  using JPHStepMonitor = JDebug::API::JPHStepMonitor;
+
+  /// What is stored in the user data block of an ExternalProfileMeasurement while it is running.
+  struct MeasurementData
+  {
+    const char* m_szName; ///< Only set if the scope is forwarded to the profiling system.
+    nsTime m_BeginTime;
+    nsUInt8 m_uiPhase; ///< The JPHStepPhase the scope is timed for, or JPHStepMonitor::s_uiNoPhase.
+  };
+
+  static nsAtomicBool s_bInstalled;
+
+#if defined(JPH_EXTERNAL_PROFILE)
+  NS_ALWAYS_INLINE void StartMeasurement(const char* szName, JPH::uint8* pUserData)
+  {
+    static_assert(sizeof(MeasurementData) <= 64, "ExternalProfileMeasurement only provides 64 bytes of user data");
+
+    MeasurementData* pData = reinterpret_cast<MeasurementData*>(pUserData);
+#  if NS_ENABLED(NS_USE_PROFILING)
+    pData->m_szName = s_bInstalled ? szName : nullptr;
+#  else
+    pData->m_szName = nullptr;
+#  endif
+    pData->m_uiPhase = JPHStepMonitor::IsAnyTimingEnabled() ? JPHStepMonitor::FindPhase(szName) : JPHStepMonitor::s_uiNoPhase;
+
+    // step statistics stay enabled in shipping builds, scopes nobody is interested in must not query the clock
+    if (pData->m_szName != nullptr || pData->m_uiPhase != JPHStepMonitor::s_uiNoPhase)
+    {
+      pData->m_BeginTime = nsTime::Now();
+    }
+  }
+
+  NS_ALWAYS_INLINE void EndMeasurement(JPH::uint8* pUserData)
+  {
+    const MeasurementData* pData = reinterpret_cast<const MeasurementData*>(pUserData);
+
+    if (pData->m_szName == nullptr && pData->m_uiPhase == JPHStepMonitor::s_uiNoPhase)
+      return;
+
+    const nsTime endTime = nsTime::Now();
+
+    if (pData->m_uiPhase != JPHStepMonitor::s_uiNoPhase)
+    {
+      JPHStepMonitor::AddPhaseMeasurement(pData->m_uiPhase, pData->m_BeginTime, endTime);
+    }
+
+#  if NS_ENABLED(NS_USE_PROFILING)
+    // Jolt passes string literals (or __FUNCTION__), so the name can be referenced without a copy until AddCPUScope() stores it
+    if (pData->m_szName != nullptr)
+    {
+      nsProfilingSystem::AddCPUScope(pData->m_szName, nullptr, pData->m_BeginTime, endTime, nsTime::MakeZero());
+    }
+#  endif
+  }
+#endif
+} // namespace JPHProfilerBridgeDetail
+
+namespace JDebug::API
+{
+  void JPHProfilerBridge::Install()
+  {
+#if defined(JPH_EXTERNAL_PROFILE)
+    if (!JPHProfilerBridgeDetail::s_bInstalled.TestAndSet(false, true))
+      return;
+
+    JPH::ProfileStartMeasurement = [](const char* szName, JPH::uint32, JPH::uint8* pUserData)
+    { JPHProfilerBridgeDetail::StartMeasurement(szName, pUserData); };
+
+    JPH::ProfileEndMeasurement = [](JPH::uint8* pUserData)
+    { JPHProfilerBridgeDetail::EndMeasurement(pUserData); };
+#endif
+  }
+
+  void JPHProfilerBridge::Uninstall()
+  {
+#if defined(JPH_EXTERNAL_PROFILE)
+    if (!JPHProfilerBridgeDetail::s_bInstalled.TestAndSet(true, false))
+      return;
+
+    // the plugin may get unloaded, Jolt must not keep pointers into it
+    JPH::ProfileStartMeasurement = [](const char*, JPH::uint32, JPH::uint8*) {};
+    JPH::ProfileEndMeasurement = [](JPH::uint8*) {};
+#endif
+  }
+
+  bool JPHProfilerBridge::IsInstalled()
+  {
+    return JPHProfilerBridgeDetail::s_bInstalled;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHProfilerBridge);
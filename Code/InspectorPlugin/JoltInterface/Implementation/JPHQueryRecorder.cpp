@@ -0,0 +1,615 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHQueryRecorder.h>
+#include <Jolt/Geometry/OrientedBox.h>
+#include <Jolt/Physics/Collision/AABoxCast.h>
+#include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/RayCast.h>
+#include <Jolt/Physics/Collision/ShapeCast.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JPHQueryRecorderDetail
+{
+  /// The tag of the innermost JPHQueryRecorder::ScopedTag of the thread.
+  static thread_local const char* t_szTag = nullptr;
+
+  /// Queries of the thread since the last sampled one, shared by all recorders.
+  static thread_local nsUInt32 t_uiSampleCounter = 0;
+
+  static nsVec3 ToVec3(JPH::Vec3Arg v)
+  {
+    return nsVec3(v.GetX(), v.GetY(), v.GetZ());
+  }
+
+  /// Counts the results of a query, all calls are forwarded to the collector of the application.
+  template <class CollectorType>
+  class CountingCollector final : public CollectorType
+  {
+  public:
+    using ResultType = typename CollectorType::ResultType;
+
+    explicit CountingCollector(CollectorType& ref_collector)
+      : CollectorType(ref_collector)
+      , m_Collector(ref_collector)
+    {
+    }
+
+    virtual void Reset() override
+    {
+      CollectorType::Reset();
+      m_Collector.Reset();
+    }
+
+    virtual void OnBody(const JPH::Body& inBody) override { m_Collector.OnBody(inBody); }
+
+    virtual void SetUserData(JPH::uint64 inUserData) override { m_Collector.SetUserData(inUserData); }
+
+    virtual void AddHit(const ResultType& inResult) override
+    {
+      ++m_uiNumHits;
+
+      m_Collector.SetContext(this->GetContext());
+      m_Collector.AddHit(inResult);
+
+      // the collector decides how many more hits it wants, the query only looks at this one
+      this->ResetEarlyOutFraction(m_Collector.GetEarlyOutFraction());
+    }
+
+    CollectorType& m_Collector;
+    nsUInt32 m_uiNumHits = 0;
+  };
+
+  /// Counts the bodies the broad phase passes to the narrow phase, and the ones the body filter of the application rejects.
+  class CountingBodyFilter final : public JPH::BodyFilter
+  {
+  public:
+    explicit CountingBodyFilter(const JPH::BodyFilter& filter)
+      : m_Filter(filter)
+    {
+    }
+
+    virtual bool ShouldCollide(const JPH::BodyID& inBodyID) const override
+    {
+      ++m_uiNumCandidates;
+
+      if (m_Filter.ShouldCollide(inBodyID))
+        return true;
+
+      ++m_uiNumFiltered;
+      return false;
+    }
+
+    virtual bool ShouldCollideLocked(const JPH::Body& inBody) const override
+    {
+      if (m_Filter.ShouldCollideLocked(inBody))
+        return true;
+
+      ++m_uiNumFiltered;
+      return false;
+    }
+
+    const JPH::BodyFilter& m_Filter;
+    mutable nsUInt32 m_uiNumCandidates = 0;
+    mutable nsUInt32 m_uiNumFiltered = 0;
+  };
+
+  static nsVec3 GetShapeExtents(const JPH::Shape* pShape, JPH::Vec3Arg vScale)
+  {
+    return ToVec3(pShape->GetLocalBounds().GetExtent() * vScale.Abs());
+  }
+} // namespace JPHQueryRecorderDetail
+
+namespace JDebug::API
+{
+  JPHQueryRecorder::ScopedTag::ScopedTag(const char* szTag)
+  {
+    m_szPreviousTag = JPHQueryRecorderDetail::t_szTag;
+    JPHQueryRecorderDetail::t_szTag = szTag;
+  }
+
+  JPHQueryRecorder::ScopedTag::~ScopedTag()
+  {
+    JPHQueryRecorderDetail::t_szTag = m_szPreviousTag;
+  }
+
+  JPHQueryRecorder::JPHQueryRecorder()
+  {
+    m_BroadPhase.m_pRecorder = this;
+    m_bRecording = true;
+
+    SetSettings(JPHQueryRecorderSettings());
+  }
+
+  JPHQueryRecorder::~JPHQueryRecorder() = default;
+
+  void JPHQueryRecorder::Attach(const JPH::PhysicsSystem& in_system, bool in_bLockBodies)
+  {
+    m_pNarrowPhase = in_bLockBodies ? &in_system.GetNarrowPhaseQuery() : &in_system.GetNarrowPhaseQueryNoLock();
+    m_BroadPhase.m_pQuery = &in_system.GetBroadPhaseQuery();
+  }
+
+  void JPHQueryRecorder::SetSettings(const JPHQueryRecorderSettings& in_settings)
+  {
+    NS_LOCK(m_Mutex);
+
+    m_Settings = in_settings;
+    m_Settings.m_uiNumBroadPhaseLayers = nsMath::Min(m_Settings.m_uiNumBroadPhaseLayers, 32u);
+    m_Settings.m_uiNumObjectLayers = nsMath::Min(m_Settings.m_uiNumObjectLayers, 64u);
+
+    m_iSampleInterval = static_cast<nsInt32>(nsMath::Min<nsUInt32>(in_settings.m_uiSampleInterval, nsMath::MaxValue<nsInt32>()));
+    m_iSlowQueryThresholdNs = static_cast<nsInt64>(in_settings.m_SlowQueryThreshold.GetNanoseconds());
+  }
+
+  JPHQueryRecorderSettings JPHQueryRecorder::GetSettings() const
+  {
+    NS_LOCK(m_Mutex);
+
+    return m_Settings;
+  }
+
+  JPHQueryRecorder::QueryInfo JPHQueryRecorder::BeginQuery(JPHQueryType eType, const JPH::BroadPhaseLayerFilter& broadPhaseLayerFilter, const JPH::ObjectLayerFilter& objectLayerFilter)
+  {
+    QueryInfo info;
+    info.m_eType = eType;
+    info.m_pBroadPhaseLayerFilter = &broadPhaseLayerFilter;
+    info.m_pObjectLayerFilter = &objectLayerFilter;
+    info.m_StartTime = nsTime::Now();
+    return info;
+  }
+
+  void JPHQueryRecorder::EndQuery(const QueryInfo& info) const
+  {
+    using namespace JPHQueryRecorderDetail;
+
+    const nsInt64 iDurationNs = static_cast<nsInt64>((nsTime::Now() - info.m_StartTime).GetNanoseconds());
+
+    m_QueryCounts[(int)info.m_eType].Increment();
+    m_QueryDurations[(int)info.m_eType].Add(iDurationNs);
+
+    nsUInt8 uiFlags = 0;
+
+    const nsInt32 iSampleInterval = m_iSampleInterval;
+    if (iSampleInterval > 0 && ++t_uiSampleCounter >= static_cast<nsUInt32>(iSampleInterval))
+    {
+      t_uiSampleCounter = 0;
+      uiFlags |= JPHQueryRecord::Sampled;
+    }
+
+    const nsInt64 iSlowQueryThresholdNs = m_iSlowQueryThresholdNs;
+    if (iSlowQueryThresholdNs > 0 && iDurationNs > iSlowQueryThresholdNs)
+    {
+      uiFlags |= JPHQueryRecord::Slow;
+    }
+
+    if (uiFlags == 0)
+      return;
+
+    NS_LOCK(m_Mutex);
+
+    // slow queries get their own budget, a burst of samples must not push them out
+    nsDynamicArray<JPHQueryRecord>& records = (uiFlags & JPHQueryRecord::Slow) ? m_SlowRecords : m_SampledRecords;
+
+    if (records.GetCount() >= m_Settings.m_uiMaxRecords)
+    {
+      ++m_uiNumPendingDropped;
+      return;
+    }
+
+    JPHQueryRecord& record = records.ExpandAndGetRef();
+    record.m_uiDurationNs = static_cast<nsUInt32>(nsMath::Min<nsInt64>(iDurationNs, nsMath::MaxValue<nsUInt32>()));
+    record.m_uiNumCandidates = info.m_uiNumCandidates;
+    record.m_uiNumFiltered = info.m_uiNumFiltered;
+    record.m_uiNumHits = info.m_uiNumHits;
+    record.m_vPosition = info.m_vPosition;
+    record.m_vDirection = info.m_vDirection;
+    record.m_vExtents = info.m_vExtents;
+    record.m_eType = info.m_eType;
+    record.m_uiFlags = uiFlags;
+    record.m_uiShapeSubType = info.m_pShape != nullptr ? static_cast<nsUInt8>(info.m_pShape->GetSubType()) : JPHQueryRecord::s_uiNoShape;
+    record.m_sTag = t_szTag != nullptr ? t_szTag : "";
+
+    // the query is over, evaluating the filters here does not affect its timing
+    record.m_uiBroadPhaseLayerMask = 0;
+    for (nsUInt32 i = 0; i < m_Settings.m_uiNumBroadPhaseLayers; ++i)
+    {
+      if (info.m_pBroadPhaseLayerFilter->ShouldCollide(JPH::BroadPhaseLayer(static_cast<JPH::BroadPhaseLayer::Type>(i))))
+        record.m_uiBroadPhaseLayerMask |= 1u << i;
+    }
+
+    record.m_uiObjectLayerMask = 0;
+    for (nsUInt32 i = 0; i < m_Settings.m_uiNumObjectLayers; ++i)
+    {
+      if (info.m_pObjectLayerFilter->ShouldCollide(static_cast<JPH::ObjectLayer>(i)))
+        record.m_uiObjectLayerMask |= nsUInt64(1) << i;
+    }
+  }
+
+  void JPHQueryRecorder::CollectRecords()
+  {
+    NS_PROFILE_SCOPE("JPHQueryRecorder::CollectRecords");
+
+    m_Records.Clear();
+
+    {
+      NS_LOCK(m_Mutex);
+
+      // the swap hands the old buffer to the slow records, so neither allocates once the record count is stable
+      m_Records.Swap(m_SlowRecords);
+      m_Records.PushBackRange(m_SampledRecords);
+      m_SampledRecords.Clear();
+
+      m_uiNumDroppedRecords = m_uiNumPendingDropped;
+      m_uiNumPendingDropped = 0;
+    }
+
+    for (nsUInt32 i = 0; i < (nsUInt32)JPHQueryType::ENUM_COUNT; ++i)
+    {
+      m_Totals[i].m_uiNumQueries = static_cast<nsUInt32>(m_QueryCounts[i].Set(0));
+      m_Totals[i].m_uiDurationNs = static_cast<nsUInt64>(m_QueryDurations[i].Set(0));
+    }
+
+    m_Records.Sort([](const JPHQueryRecord& a, const JPHQueryRecord& b)
+      { return a.m_uiDurationNs > b.m_uiDurationNs; });
+  }
+
+  bool JPHQueryRecorder::CastRay(const JPH::RRayCast& inRay, JPH::RayCastResult& ioHit, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter, const JPH::BodyFilter& inBodyFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pNarrowPhase != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_bRecording)
+      return m_pNarrowPhase->CastRay(inRay, ioHit, inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter);
+
+    JPHQueryRecorderDetail::CountingBodyFilter bodyFilter(inBodyFilter);
+
+    QueryInfo info = BeginQuery(JPHQueryType::CastRay, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    const bool bHit = m_pNarrowPhase->CastRay(inRay, ioHit, inBroadPhaseLayerFilter, inObjectLayerFilter, bodyFilter);
+
+    info.m_uiNumCandidates = bodyFilter.m_uiNumCandidates;
+    info.m_uiNumFiltered = bodyFilter.m_uiNumFiltered;
+    info.m_uiNumHits = bHit ? 1 : 0;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(JPH::Vec3(inRay.mOrigin));
+    info.m_vDirection = JPHQueryRecorderDetail::ToVec3(inRay.mDirection);
+    EndQuery(info);
+
+    return bHit;
+  }
+
+  void JPHQueryRecorder::CastRay(const JPH::RRayCast& inRay, const JPH::RayCastSettings& inRayCastSettings, JPH::CastRayCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter, const JPH::BodyFilter& inBodyFilter, const JPH::ShapeFilter& inShapeFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pNarrowPhase != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_bRecording)
+      return m_pNarrowPhase->CastRay(inRay, inRayCastSettings, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter, inShapeFilter);
+
+    JPHQueryRecorderDetail::CountingBodyFilter bodyFilter(inBodyFilter);
+    JPHQueryRecorderDetail::CountingCollector<JPH::CastRayCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::CastRayCollector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pNarrowPhase->CastRay(inRay, inRayCastSettings, collector, inBroadPhaseLayerFilter, inObjectLayerFilter, bodyFilter, inShapeFilter);
+
+    info.m_uiNumCandidates = bodyFilter.m_uiNumCandidates;
+    info.m_uiNumFiltered = bodyFilter.m_uiNumFiltered;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(JPH::Vec3(inRay.mOrigin));
+    info.m_vDirection = JPHQueryRecorderDetail::ToVec3(inRay.mDirection);
+    EndQuery(info);
+  }
+
+  void JPHQueryRecorder::CollidePoint(JPH::RVec3Arg inPoint, JPH::CollidePointCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter, const JPH::BodyFilter& inBodyFilter, const JPH::ShapeFilter& inShapeFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pNarrowPhase != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_bRecording)
+      return m_pNarrowPhase->CollidePoint(inPoint, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter, inShapeFilter);
+
+    JPHQueryRecorderDetail::CountingBodyFilter bodyFilter(inBodyFilter);
+    JPHQueryRecorderDetail::CountingCollector<JPH::CollidePointCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::CollidePoint, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pNarrowPhase->CollidePoint(inPoint, collector, inBroadPhaseLayerFilter, inObjectLayerFilter, bodyFilter, inShapeFilter);
+
+    info.m_uiNumCandidates = bodyFilter.m_uiNumCandidates;
+    info.m_uiNumFiltered = bodyFilter.m_uiNumFiltered;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(JPH::Vec3(inPoint));
+    EndQuery(info);
+  }
+
+  void JPHQueryRecorder::CollideShape(const JPH::Shape* inShape, JPH::Vec3Arg inShapeScale, JPH::RMat44Arg inCenterOfMassTransform, const JPH::CollideShapeSettings& inCollideShapeSettings, JPH::RVec3Arg inBaseOffset, JPH::CollideShapeCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter, const JPH::BodyFilter& inBodyFilter, const JPH::ShapeFilter& inShapeFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pNarrowPhase != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_bRecording)
+      return m_pNarrowPhase->CollideShape(inShape, inShapeScale, inCenterOfMassTransform, inCollideShapeSettings, inBaseOffset, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter, inShapeFilter);
+
+    JPHQueryRecorderDetail::CountingBodyFilter bodyFilter(inBodyFilter);
+    JPHQueryRecorderDetail::CountingCollector<JPH::CollideShapeCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::CollideShape, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pNarrowPhase->CollideShape(inShape, inShapeScale, inCenterOfMassTransform, inCollideShapeSettings, inBaseOffset, collector, inBroadPhaseLayerFilter, inObjectLayerFilter, bodyFilter, inShapeFilter);
+
+    info.m_uiNumCandidates = bodyFilter.m_uiNumCandidates;
+    info.m_uiNumFiltered = bodyFilter.m_uiNumFiltered;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_pShape = inShape;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(JPH::Vec3(inCenterOfMassTransform.GetTranslation()));
+    info.m_vExtents = JPHQueryRecorderDetail::GetShapeExtents(inShape, inShapeScale);
+    EndQuery(info);
+  }
+
+  void JPHQueryRecorder::CastShape(const JPH::RShapeCast& inShapeCast, const JPH::ShapeCastSettings& inShapeCastSettings, JPH::RVec3Arg inBaseOffset, JPH::CastShapeCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter, const JPH::BodyFilter& inBodyFilter, const JPH::ShapeFilter& inShapeFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pNarrowPhase != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_bRecording)
+      return m_pNarrowPhase->CastShape(inShapeCast, inShapeCastSettings, inBaseOffset, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter, inShapeFilter);
+
+    JPHQueryRecorderDetail::CountingBodyFilter bodyFilter(inBodyFilter);
+    JPHQueryRecorderDetail::CountingCollector<JPH::CastShapeCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::CastShape, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pNarrowPhase->CastShape(inShapeCast, inShapeCastSettings, inBaseOffset, collector, inBroadPhaseLayerFilter, inObjectLayerFilter, bodyFilter, inShapeFilter);
+
+    info.m_uiNumCandidates = bodyFilter.m_uiNumCandidates;
+    info.m_uiNumFiltered = bodyFilter.m_uiNumFiltered;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_pShape = inShapeCast.mShape;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(JPH::Vec3(inShapeCast.mCenterOfMassStart.GetTranslation()));
+    info.m_vDirection = JPHQueryRecorderDetail::ToVec3(inShapeCast.mDirection);
+    info.m_vExtents = JPHQueryRecorderDetail::GetShapeExtents(inShapeCast.mShape, inShapeCast.mScale);
+    EndQuery(info);
+  }
+
+  void JPHQueryRecorder::CollectTransformedShapes(const JPH::AABox& inBox, JPH::TransformedShapeCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter, const JPH::BodyFilter& inBodyFilter, const JPH::ShapeFilter& inShapeFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pNarrowPhase != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_bRecording)
+      return m_pNarrowPhase->CollectTransformedShapes(inBox, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter, inBodyFilter, inShapeFilter);
+
+    JPHQueryRecorderDetail::CountingBodyFilter bodyFilter(inBodyFilter);
+    JPHQueryRecorderDetail::CountingCollector<JPH::TransformedShapeCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::CollectTransformedShapes, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pNarrowPhase->CollectTransformedShapes(inBox, collector, inBroadPhaseLayerFilter, inObjectLayerFilter, bodyFilter, inShapeFilter);
+
+    info.m_uiNumCandidates = bodyFilter.m_uiNumCandidates;
+    info.m_uiNumFiltered = bodyFilter.m_uiNumFiltered;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(inBox.GetCenter());
+    info.m_vExtents = JPHQueryRecorderDetail::ToVec3(inBox.GetExtent());
+    EndQuery(info);
+  }
+
+  void JPHQueryRecorder::BroadPhase::CastRay(const JPH::RayCast& inRay, JPH::RayCastBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pQuery != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_pRecorder->m_bRecording)
+      return m_pQuery->CastRay(inRay, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    JPHQueryRecorderDetail::CountingCollector<JPH::RayCastBodyCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::BroadPhaseCastRay, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pQuery->CastRay(inRay, collector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    info.m_uiNumCandidates = collector.m_uiNumHits;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(inRay.mOrigin);
+    info.m_vDirection = JPHQueryRecorderDetail::ToVec3(inRay.mDirection);
+    m_pRecorder->EndQuery(info);
+  }
+
+  void JPHQueryRecorder::BroadPhase::CollideAABox(const JPH::AABox& inBox, JPH::CollideShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pQuery != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_pRecorder->m_bRecording)
+      return m_pQuery->CollideAABox(inBox, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    JPHQueryRecorderDetail::CountingCollector<JPH::CollideShapeBodyCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::BroadPhaseCollideAABox, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pQuery->CollideAABox(inBox, collector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    info.m_uiNumCandidates = collector.m_uiNumHits;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(inBox.GetCenter());
+    info.m_vExtents = JPHQueryRecorderDetail::ToVec3(inBox.GetExtent());
+    m_pRecorder->EndQuery(info);
+  }
+
+  void JPHQueryRecorder::BroadPhase::CollideSphere(JPH::Vec3Arg inCenter, float inRadius, JPH::CollideShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pQuery != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_pRecorder->m_bRecording)
+      return m_pQuery->CollideSphere(inCenter, inRadius, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    JPHQueryRecorderDetail::CountingCollector<JPH::CollideShapeBodyCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::BroadPhaseCollideSphere, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pQuery->CollideSphere(inCenter, inRadius, collector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    info.m_uiNumCandidates = collector.m_uiNumHits;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(inCenter);
+    info.m_vExtents.Set(inRadius, 0.0f, 0.0f);
+    m_pRecorder->EndQuery(info);
+  }
+
+  void JPHQueryRecorder::BroadPhase::CollidePoint(JPH::Vec3Arg inPoint, JPH::CollideShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pQuery != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_pRecorder->m_bRecording)
+      return m_pQuery->CollidePoint(inPoint, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    JPHQueryRecorderDetail::CountingCollector<JPH::CollideShapeBodyCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::BroadPhaseCollidePoint, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pQuery->CollidePoint(inPoint, collector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    info.m_uiNumCandidates = collector.m_uiNumHits;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(inPoint);
+    m_pRecorder->EndQuery(info);
+  }
+
+  void JPHQueryRecorder::BroadPhase::CollideOrientedBox(const JPH::OrientedBox& inBox, JPH::CollideShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pQuery != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_pRecorder->m_bRecording)
+      return m_pQuery->CollideOrientedBox(inBox, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    JPHQueryRecorderDetail::CountingCollector<JPH::CollideShapeBodyCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::BroadPhaseCollideBox, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pQuery->CollideOrientedBox(inBox, collector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    info.m_uiNumCandidates = collector.m_uiNumHits;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(inBox.mOrientation.GetTranslation());
+    info.m_vExtents = JPHQueryRecorderDetail::ToVec3(inBox.mHalfExtents);
+    m_pRecorder->EndQuery(info);
+  }
+
+  void JPHQueryRecorder::BroadPhase::CastAABox(const JPH::AABoxCast& inBox, JPH::CastShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter, const JPH::ObjectLayerFilter& inObjectLayerFilter) const
+  {
+    NS_ASSERT_DEBUG(m_pQuery != nullptr, "The recorder is not attached to a physics system");
+
+    if (!m_pRecorder->m_bRecording)
+      return m_pQuery->CastAABox(inBox, ioCollector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    JPHQueryRecorderDetail::CountingCollector<JPH::CastShapeBodyCollector> collector(ioCollector);
+
+    QueryInfo info = BeginQuery(JPHQueryType::BroadPhaseCastAABox, inBroadPhaseLayerFilter, inObjectLayerFilter);
+    m_pQuery->CastAABox(inBox, collector, inBroadPhaseLayerFilter, inObjectLayerFilter);
+
+    info.m_uiNumCandidates = collector.m_uiNumHits;
+    info.m_uiNumHits = collector.m_uiNumHits;
+    info.m_vPosition = JPHQueryRecorderDetail::ToVec3(inBox.mBox.GetCenter());
+    info.m_vDirection = JPHQueryRecorderDetail::ToVec3(inBox.mDirection);
+    info.m_vExtents = JPHQueryRecorderDetail::ToVec3(inBox.mBox.GetExtent());
+    m_pRecorder->EndQuery(info);
+  }
+
+  void JPHQueryRecorder::WriteRecords(nsArrayPtr<const JPHQueryRecord> in_records, nsArrayPtr<const JPHQueryTotals> in_totals, nsUInt32 in_uiNumDropped, nsDynamicArray<nsUInt8>& out_data)
+  {
+    out_data.Clear();
+
+    IO::JPHByteWriter writer(out_data);
+    writer.Write(static_cast<nsUInt8>(in_totals.GetCount()));
+
+    for (const JPHQueryTotals& totals : in_totals)
+    {
+      writer.WriteVarUInt(totals.m_uiNumQueries);
+      writer.WriteVarUInt(totals.m_uiDurationNs);
+    }
+
+    writer.WriteVarUInt(in_uiNumDropped);
+    writer.WriteVarUInt(in_records.GetCount());
+
+    for (const JPHQueryRecord& record : in_records)
+    {
+      writer.Write(record.m_eType);
+      writer.Write(record.m_uiFlags);
+      writer.Write(record.m_uiShapeSubType);
+      writer.WriteVarUInt(record.m_uiDurationNs);
+      writer.WriteVarUInt(record.m_uiNumCandidates);
+      writer.WriteVarUInt(record.m_uiNumFiltered);
+      writer.WriteVarUInt(record.m_uiNumHits);
+      writer.Write(record.m_uiBroadPhaseLayerMask);
+      writer.Write(record.m_uiObjectLayerMask);
+      writer.Write(record.m_vPosition);
+      writer.Write(record.m_vDirection);
+      writer.Write(record.m_vExtents);
+      writer.WriteVarUInt(record.m_sTag.GetElementCount());
+      writer.WriteBytes(record.m_sTag.GetData(), record.m_sTag.GetElementCount());
+    }
+  }
+
+  nsResult JPHQueryRecorder::ReadRecords(nsArrayPtr<const nsUInt8> in_data, nsDynamicArray<JPHQueryRecord>& out_records, nsDynamicArray<JPHQueryTotals>& out_totals, nsUInt32& out_uiNumDropped)
+  {
+    out_records.Clear();
+    out_totals.Clear();
+    out_totals.SetCount((nsUInt32)JPHQueryType::ENUM_COUNT);
+
+    IO::JPHByteReader reader(in_data);
+    nsUInt64 uiValue = 0;
+
+    nsUInt8 uiNumTypes = 0;
+    reader.Read(uiNumTypes);
+
+    for (nsUInt32 i = 0; i < uiNumTypes; ++i)
+    {
+      nsUInt64 uiNumQueries = 0;
+      nsUInt64 uiDurationNs = 0;
+      reader.ReadVarUInt(uiNumQueries);
+      reader.ReadVarUInt(uiDurationNs);
+
+      if (i < out_totals.GetCount())
+      {
+        out_totals[i].m_uiNumQueries = static_cast<nsUInt32>(uiNumQueries);
+        out_totals[i].m_uiDurationNs = uiDurationNs;
+      }
+    }
+
+    reader.ReadVarUInt(uiValue);
+    out_uiNumDropped = static_cast<nsUInt32>(uiValue);
+
+    nsUInt64 uiNumRecords = 0;
+    reader.ReadVarUInt(uiNumRecords);
+
+    // every record takes more than 40 bytes, a larger count can only come from corrupt data
+    if (reader.HasFailed() || uiNumRecords > in_data.GetCount() / 40)
+      return NS_FAILURE;
+
+    out_records.Reserve(static_cast<nsUInt32>(uiNumRecords));
+
+    nsStringBuilder sTag;
+
+    for (nsUInt64 i = 0; i < uiNumRecords; ++i)
+    {
+      JPHQueryRecord& record = out_records.ExpandAndGetRef();
+      reader.Read(record.m_eType);
+      reader.Read(record.m_uiFlags);
+      reader.Read(record.m_uiShapeSubType);
+
+      reader.ReadVarUInt(uiValue);
+      record.m_uiDurationNs = static_cast<nsUInt32>(uiValue);
+      reader.ReadVarUInt(uiValue);
+      record.m_uiNumCandidates = static_cast<nsUInt32>(uiValue);
+      reader.ReadVarUInt(uiValue);
+      record.m_uiNumFiltered = static_cast<nsUInt32>(uiValue);
+      reader.ReadVarUInt(uiValue);
+      record.m_uiNumHits = static_cast<nsUInt32>(uiValue);
+
+      reader.Read(record.m_uiBroadPhaseLayerMask);
+      reader.Read(record.m_uiObjectLayerMask);
+      reader.Read(record.m_vPosition);
+      reader.Read(record.m_vDirection);
+      reader.Read(record.m_vExtents);
+
+      nsUInt64 uiTagLength = 0;
+      reader.ReadVarUInt(uiTagLength);
+
+      if (reader.HasFailed() || record.m_eType >= JPHQueryType::ENUM_COUNT || uiTagLength > in_data.GetCount())
+        return NS_FAILURE;
+
+      const nsUInt32 uiTagOffset = reader.GetOffset();
+
+      if (!reader.Skip(static_cast<nsUInt32>(uiTagLength)))
+        return NS_FAILURE;
+
+      sTag = nsStringView(reinterpret_cast<const char*>(in_data.GetPtr()) + uiTagOffset, static_cast<nsUInt32>(uiTagLength));
+      record.m_sTag = sTag;
+    }
+
+    return NS_SUCCESS;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHQueryRecorder);
@@ -0,0 +1,525 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHJoltStreams.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileManager.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileReader.h>
+#include <InspectorPlugin/JoltInterface/JPHMemory.h>
+#include <InspectorPlugin/JoltInterface/JPHReplayEngine.h>
+#include <InspectorPlugin/JoltInterface/JPHShapeDictionary.h>
+#include <InspectorPlugin/JoltInterface/JPHTaskJobSystem.h>
+
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Body/BodyLockInterface.h>
+#include <Jolt/Physics/Constraints/TwoBodyConstraint.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/SoftBody/SoftBodyCreationSettings.h>
+#include <Jolt/Physics/StateRecorderImpl.h>
+
+namespace JPHReplayEngineDetail
+{
+  static constexpr nsUInt32 s_uiStateRecordVersion = 1;
+  static constexpr nsUInt32 s_uiSceneRecordVersion = 1;
+
+  /// Memory of one body slot in a JPHBodySnapshot, used to keep the cache within its budget.
+  static constexpr nsUInt64 s_uiSnapshotBytesPerSlot = 3 * sizeof(nsUInt32) + 3 * sizeof(nsVec3) + sizeof(nsQuat) + 2 * sizeof(nsUInt8);
+
+  /// Finds the first record of the given type in a frame payload.
+  static nsArrayPtr<const nsUInt8> FindRecord(nsArrayPtr<const nsUInt8> payload, JDebug::API::IO::JPHPVDRecordType eType)
+  {
+    nsDynamicArray<JDebug::API::IO::JPHPVDFileReader::Record> records;
+    if (JDebug::API::IO::JPHPVDFileReader::GetRecords(payload, records).Failed())
+      return {};
+
+    for (const JDebug::API::IO::JPHPVDFileReader::Record& record : records)
+    {
+      if (record.m_eType == eType)
+        return record.m_Data;
+    }
+
+    return {};
+  }
+} // namespace JPHReplayEngineDetail
+
+namespace JDebug::API
+{
+  JPHReplayEngine::JPHReplayEngine() = default;
+
+  JPHReplayEngine::~JPHReplayEngine()
+  {
+    Close();
+  }
+
+  void JPHReplayEngine::WriteStateRecord(const JPH::PhysicsSystem& in_system, const JPHStateCaptureSettings& in_settings, nsDynamicArray<nsUInt8>& inout_records)
+  {
+    NS_PROFILE_SCOPE("JPHReplayEngine::WriteStateRecord");
+
+    JPH::StateRecorderImpl recorder;
+    in_system.SaveState(recorder);
+    const std::string state = recorder.GetData();
+
+    nsDynamicArray<nsUInt8> record;
+    IO::JPHByteWriter writer(record);
+    writer.Write(JPHReplayEngineDetail::s_uiStateRecordVersion);
+    writer.Write(in_settings.m_fDeltaTime);
+    writer.Write(in_settings.m_iCollisionSteps);
+    writer.WriteBytes(state.data(), static_cast<nsUInt32>(state.size()));
+
+    IO::JPHPVDFileManager::AppendRecord(inout_records, IO::JPHPVDRecordType::PhysicsState, record);
+  }
+
+  nsResult JPHReplayEngine::WriteSceneRecord(const JPH::PhysicsSystem& in_system, nsDynamicArray<nsUInt8>& inout_records)
+  {
+    NS_PROFILE_SCOPE("JPHReplayEngine::WriteSceneRecord");
+
+    // the state refers to constraints by their index in the system, so skipping one would shift all that follow
+    const JPH::Constraints constraints = in_system.GetConstraints();
+    for (const JPH::Ref<JPH::Constraint>& pConstraint : constraints)
+    {
+      if (pConstraint->GetType() != JPH::EConstraintType::TwoBodyConstraint)
+        return NS_FAILURE;
+    }
+
+    JPH::BodyIDVector bodyIDs;
+    in_system.GetBodies(bodyIDs);
+
+    // only bodies in the broad phase are part of the saved state
+    const JPH::BodyLockInterfaceNoLock& lockInterface = in_system.GetBodyLockInterfaceNoLock();
+    nsDynamicArray<const JPH::Body*> bodies;
+    bodies.Reserve(static_cast<nsUInt32>(bodyIDs.size()));
+
+    for (const JPH::BodyID& bodyID : bodyIDs)
+    {
+      const JPH::Body* pBody = lockInterface.TryGetBody(bodyID);
+
+      if (pBody != nullptr && pBody->IsInBroadPhase())
+        bodies.PushBack(pBody);
+    }
+
+    nsDynamicArray<nsUInt8> record;
+    IO::JPHJoltStreamOut stream(record);
+    stream.Write(JPHReplayEngineDetail::s_uiSceneRecordVersion);
+    stream.Write(static_cast<nsUInt32>(in_system.GetMaxBodies()));
+    stream.Write(static_cast<nsUInt32>(sizeof(JPH::PhysicsSettings)));
+    stream.WriteBytes(&in_system.GetPhysicsSettings(), sizeof(JPH::PhysicsSettings));
+
+    {
+      // most of what Jolt allocates for the capture are the maps that deduplicate the shapes and materials
+      JPHMemory::ScopedCategory category(JPHAllocationCategory::Shapes);
+
+      JPH::BodyCreationSettings::ShapeToIDMap shapeMap;
+      JPH::BodyCreationSettings::MaterialToIDMap materialMap;
+      JPH::BodyCreationSettings::GroupFilterToIDMap groupFilterMap;
+      JPH::SoftBodyCreationSettings::SharedSettingsToIDMap sharedSettingsMap;
+
+      stream.Write(bodies.GetCount());
+      for (const JPH::Body* pBody : bodies)
+      {
+        stream.Write(pBody->GetID().GetIndexAndSequenceNumber());
+        stream.Write(static_cast<nsUInt8>(pBody->IsSoftBody() ? 1 : 0));
+
+        if (pBody->IsSoftBody())
+          pBody->GetSoftBodyCreationSettings().SaveWithChildren(stream, &sharedSettingsMap, &materialMap, &groupFilterMap);
+        else
+          pBody->GetBodyCreationSettings().SaveWithChildren(stream, &shapeMap, &materialMap, &groupFilterMap);
+      }
+    }
+
+    stream.Write(static_cast<nsUInt32>(constraints.size()));
+    for (const JPH::Ref<JPH::Constraint>& pConstraint : constraints)
+    {
+      const JPH::TwoBodyConstraint* pTwoBodyConstraint = static_cast<const JPH::TwoBodyConstraint*>(pConstraint.GetPtr());
+
+      // bodies that are fixed to the world are attached to Body::sFixedToWorld, which has an invalid ID
+      stream.Write(pTwoBodyConstraint->GetBody1()->GetID().GetIndexAndSequenceNumber());
+      stream.Write(pTwoBodyConstraint->GetBody2()->GetID().GetIndexAndSequenceNumber());
+      pConstraint->GetConstraintSettings()->SaveBinaryState(stream);
+    }
+
+    IO::JPHPVDFileManager::AppendRecord(inout_records, IO::JPHPVDRecordType::PhysicsScene, record);
+    return NS_SUCCESS;
+  }
+
+  nsResult JPHReplayEngine::Open(const IO::JPHPVDFileReader& in_reader, const JPHReplaySettings& in_settings)
+  {
+    Close();
+
+    if (in_settings.m_pBroadPhaseLayerInterface == nullptr || in_settings.m_pObjectVsBroadPhaseLayerFilter == nullptr || in_settings.m_pObjectLayerPairFilter == nullptr)
+    {
+      nsLog::Error("JPHReplayEngine: The layer interfaces of the captured physics system are required for re-simulation.");
+      return NS_FAILURE;
+    }
+
+    if (!in_reader.IsOpen())
+      return NS_FAILURE;
+
+    m_pReader = &in_reader;
+    m_Settings = in_settings;
+
+    m_pTempAllocator = std::make_unique<JPHArenaTempAllocator>(in_settings.m_uiTempAllocatorSize);
+    m_pJobSystem = std::make_unique<JPHTaskJobSystem>(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers);
+
+    return NS_SUCCESS;
+  }
+
+  void JPHReplayEngine::Close()
+  {
+    DestroyScene();
+
+    m_Cache.Clear();
+    m_CacheLookup.Clear();
+    m_uiCacheBytes = 0;
+    m_uiUseCounter = 0;
+    m_uiNumSimulatedSteps = 0;
+
+    m_pJobSystem.reset();
+    m_pTempAllocator.reset();
+    m_pReader = nullptr;
+  }
+
+  JPHTempAllocatorStats JPHReplayEngine::GetTempAllocatorStats() const
+  {
+    return m_pTempAllocator != nullptr ? m_pTempAllocator->GetStats() : JPHTempAllocatorStats();
+  }
+
+  bool JPHReplayEngine::CanSimulate(nsUInt64 in_uiStepIndex) const
+  {
+    if (m_pReader == nullptr)
+      return false;
+
+    const nsUInt32 uiFrame = m_pReader->FindFrame(in_uiStepIndex);
+    return uiFrame != nsInvalidIndex && m_pReader->FindFrameWithFlags(uiFrame, IO::PVDFrame_PhysicsState) != nsInvalidIndex;
+  }
+
+  const JPHBodySnapshot* JPHReplayEngine::GetStep(nsUInt64 in_uiStepIndex)
+  {
+    if (m_pReader == nullptr)
+      return nullptr;
+
+    if (CacheEntry** ppEntry = m_CacheLookup.GetValue(in_uiStepIndex))
+    {
+      (*ppEntry)->m_uiLastUse = ++m_uiUseCounter;
+      return &(*ppEntry)->m_Snapshot;
+    }
+
+    const nsUInt32 uiFrame = m_pReader->FindFrame(in_uiStepIndex);
+    if (uiFrame == nsInvalidIndex)
+      return nullptr;
+
+    const nsUInt32 uiStateFrame = m_pReader->FindFrameWithFlags(uiFrame, IO::PVDFrame_PhysicsState);
+    if (uiStateFrame == nsInvalidIndex)
+      return nullptr;
+
+    // continue the current simulation if it started from the same state and has not passed the step yet
+    if (m_pSystem == nullptr || m_uiStateFrame != uiStateFrame || m_uiSimStep > in_uiStepIndex)
+    {
+      if (RestoreState(uiStateFrame).Failed())
+      {
+        DestroyScene();
+        return nullptr;
+      }
+
+      CaptureSimulatedStep();
+    }
+
+    NS_PROFILE_SCOPE("JPHReplayEngine::Simulate");
+
+    while (m_uiSimStep < in_uiStepIndex)
+    {
+      const JPH::EPhysicsUpdateError eError = m_pSystem->Update(m_fDeltaTime, m_iCollisionSteps, m_pTempAllocator.get(), m_pJobSystem.get());
+
+      if (eError != JPH::EPhysicsUpdateError::None)
+      {
+        nsLog::Warning("JPHReplayEngine: Step {} overflowed a buffer of the replay system ({}), increase the limits in JPHReplaySettings.", m_uiSimStep + 1, static_cast<nsUInt32>(eError));
+      }
+
+      ++m_uiSimStep;
+      ++m_uiNumSimulatedSteps;
+
+      // every step is cached, so scrubbing back within the interval is free
+      CaptureSimulatedStep();
+    }
+
+    return &(*m_CacheLookup.GetValue(in_uiStepIndex))->m_Snapshot;
+  }
+
+  nsResult JPHReplayEngine::RestoreState(nsUInt32 uiStateFrame)
+  {
+    using namespace JPHReplayEngineDetail;
+
+    NS_PROFILE_SCOPE("JPHReplayEngine::RestoreState");
+
+    // the scene is only written when the bodies or constraints change, it may be many frames before the state
+    const nsUInt32 uiSceneFrame = m_pReader->FindFrameWithFlags(uiStateFrame, IO::PVDFrame_PhysicsScene);
+    if (uiSceneFrame == nsInvalidIndex)
+    {
+      nsLog::Error("JPHReplayEngine: The capture holds no scene before frame {}.", uiStateFrame);
+      return NS_FAILURE;
+    }
+
+    if (m_pSystem == nullptr || uiSceneFrame != m_uiSceneFrame)
+    {
+      DestroyScene();
+
+      NS_SUCCEED_OR_RETURN(m_pReader->ReadFrame(uiSceneFrame, m_Payload));
+      NS_SUCCEED_OR_RETURN(BuildScene(FindRecord(m_Payload, IO::JPHPVDRecordType::PhysicsScene)));
+
+      m_uiSceneFrame = uiSceneFrame;
+    }
+
+    NS_SUCCEED_OR_RETURN(m_pReader->ReadFrame(uiStateFrame, m_Payload));
+    const nsArrayPtr<const nsUInt8> stateData = FindRecord(m_Payload, IO::JPHPVDRecordType::PhysicsState);
+
+    IO::JPHByteReader reader(stateData);
+    nsUInt32 uiVersion = 0;
+    reader.Read(uiVersion);
+    reader.Read(m_fDeltaTime);
+    reader.Read(m_iCollisionSteps);
+
+    if (reader.HasFailed() || uiVersion != s_uiStateRecordVersion)
+      return NS_FAILURE;
+
+    JPH::StateRecorderImpl recorder;
+    recorder.WriteBytes(stateData.GetPtr() + reader.GetOffset(), stateData.GetCount() - reader.GetOffset());
+    recorder.Rewind();
+
+    if (!m_pSystem->RestoreState(recorder))
+    {
+      nsLog::Error("JPHReplayEngine: The state in frame {} does not match the scene in frame {}.", uiStateFrame, uiSceneFrame);
+      return NS_FAILURE;
+    }
+
+    m_uiStateFrame = uiStateFrame;
+    m_uiSimStep = m_pReader->GetFrameInfo(uiStateFrame).m_uiStepIndex;
+    return NS_SUCCESS;
+  }
+
+  nsResult JPHReplayEngine::BuildScene(nsArrayPtr<const nsUInt8> sceneData)
+  {
+    using namespace JPHReplayEngineDetail;
+
+    NS_PROFILE_SCOPE("JPHReplayEngine::BuildScene");
+
+    IO::JPHJoltStreamIn stream(sceneData);
+
+    nsUInt32 uiVersion = 0;
+    nsUInt32 uiMaxBodies = 0;
+    nsUInt32 uiSettingsSize = 0;
+    stream.Read(uiVersion);
+    stream.Read(uiMaxBodies);
+    stream.Read(uiSettingsSize);
+
+    if (stream.IsFailed() || uiVersion != s_uiSceneRecordVersion)
+      return NS_FAILURE;
+
+    m_pSystem = std::make_unique<JPH::PhysicsSystem>();
+
+    {
+      // most of what Init() allocates are the contact caches, sized by the body pair and contact constraint limits
+      JPHMemory::ScopedCategory category(JPHAllocationCategory::Contacts);
+      m_pSystem->Init(uiMaxBodies, 0, m_Settings.m_uiMaxBodyPairs, m_Settings.m_uiMaxContactConstraints, *m_Settings.m_pBroadPhaseLayerInterface, *m_Settings.m_pObjectVsBroadPhaseLayerFilter, *m_Settings.m_pObjectLayerPairFilter);
+    }
+
+    m_pSystem->SetContactListener(m_Settings.m_pContactListener);
+
+    // the settings are stored as is, a capture from a different Jolt version keeps the defaults
+    if (uiSettingsSize == sizeof(JPH::PhysicsSettings))
+    {
+      JPH::PhysicsSettings physicsSettings;
+      stream.ReadBytes(&physicsSettings, sizeof(physicsSettings));
+      m_pSystem->SetPhysicsSettings(physicsSettings);
+    }
+    else
+    {
+      nsDynamicArray<nsUInt8> skipped;
+      skipped.SetCountUninitialized(uiSettingsSize);
+      stream.ReadBytes(skipped.GetData(), uiSettingsSize);
+    }
+
+    JPH::BodyCreationSettings::IDToShapeMap shapeMap;
+    JPH::BodyCreationSettings::IDToMaterialMap materialMap;
+    JPH::BodyCreationSettings::IDToGroupFilterMap groupFilterMap;
+    JPH::SoftBodyCreationSettings::IDToSharedSettingsMap sharedSettingsMap;
+
+    JPH::BodyInterface& bodyInterface = m_pSystem->GetBodyInterfaceNoLock();
+
+    nsUInt32 uiNumBodies = 0;
+    stream.Read(uiNumBodies);
+
+    for (nsUInt32 i = 0; i < uiNumBodies && !stream.IsFailed(); ++i)
+    {
+      nsUInt32 uiBodyID = 0;
+      nsUInt8 uiSoftBody = 0;
+      stream.Read(uiBodyID);
+      stream.Read(uiSoftBody);
+
+      // the state refers to bodies by ID, so every body has to get the ID it had in the captured system
+      const JPH::BodyID bodyID(uiBodyID);
+      JPH::Body* pBody = nullptr;
+
+      if (uiSoftBody != 0)
+      {
+        JPH::SoftBodyCreationSettings::SBCSResult result;
+        {
+          JPHMemory::ScopedCategory category(JPHAllocationCategory::Shapes);
+          result = JPH::SoftBodyCreationSettings::sRestoreWithChildren(stream, sharedSettingsMap, materialMap, groupFilterMap);
+        }
+
+        if (result.HasError())
+          return NS_FAILURE;
+
+        JPHMemory::ScopedCategory category(JPHAllocationCategory::Bodies);
+        pBody = bodyInterface.CreateSoftBodyWithID(bodyID, result.Get());
+      }
+      else
+      {
+        JPH::BodyCreationSettings::BCSResult result;
+        {
+          JPHMemory::ScopedCategory category(JPHAllocationCategory::Shapes);
+          result = JPH::BodyCreationSettings::sRestoreWithChildren(stream, shapeMap, materialMap, groupFilterMap);
+        }
+
+        if (result.HasError())
+          return NS_FAILURE;
+
+        JPHMemory::ScopedCategory category(JPHAllocationCategory::Bodies);
+        pBody = bodyInterface.CreateBodyWithID(bodyID, result.Get());
+      }
+
+      if (pBody == nullptr)
+        return NS_FAILURE;
+
+      // the restored state decides which bodies are awake
+      JPHMemory::ScopedCategory category(JPHAllocationCategory::BroadPhase);
+      bodyInterface.AddBody(bodyID, JPH::EActivation::DontActivate);
+    }
+
+    {
+      // bodies were added one by one, without this the broad phase queries of the first steps are very slow
+      JPHMemory::ScopedCategory category(JPHAllocationCategory::BroadPhase);
+      m_pSystem->OptimizeBroadPhase();
+    }
+
+    const JPH::BodyLockInterfaceNoLock& lockInterface = m_pSystem->GetBodyLockInterfaceNoLock();
+
+    nsUInt32 uiNumConstraints = 0;
+    stream.Read(uiNumConstraints);
+
+    for (nsUInt32 i = 0; i < uiNumConstraints && !stream.IsFailed(); ++i)
+    {
+      nsUInt32 uiBodyIDs[2] = {};
+      stream.Read(uiBodyIDs[0]);
+      stream.Read(uiBodyIDs[1]);
+
+      JPH::Body* pBodies[2] = {};
+      for (nsUInt32 b = 0; b < 2; ++b)
+      {
+        const JPH::BodyID bodyID(uiBodyIDs[b]);
+        pBodies[b] = bodyID.IsInvalid() ? &JPH::Body::sFixedToWorld : lockInterface.TryGetBody(bodyID);
+      }
+
+      const JPH::ConstraintSettings::ConstraintResult result = JPH::ConstraintSettings::sRestoreFromBinaryState(stream);
+      if (result.HasError() || pBodies[0] == nullptr || pBodies[1] == nullptr)
+        return NS_FAILURE;
+
+      // only two body constraints are written, see WriteSceneRecord(), any other type comes from a corrupt or foreign file
+      const JPH::ConstraintSettings* pRestored = result.Get().GetPtr();
+      if (pRestored == nullptr || !pRestored->GetRTTI()->IsKindOf(JPH_RTTI(JPH::TwoBodyConstraintSettings)))
+        return NS_FAILURE;
+
+      const JPH::TwoBodyConstraintSettings* pSettings = static_cast<const JPH::TwoBodyConstraintSettings*>(pRestored);
+      m_pSystem->AddConstraint(pSettings->Create(*pBodies[0], *pBodies[1]));
+    }
+
+    return stream.IsFailed() ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  void JPHReplayEngine::DestroyScene()
+  {
+    m_pSystem.reset();
+    m_uiSceneFrame = nsInvalidIndex;
+    m_uiStateFrame = nsInvalidIndex;
+    m_uiSimStep = 0;
+  }
+
+  JPHBodySnapshot& JPHReplayEngine::AddToCache(nsUInt64 uiStepIndex, nsUInt32 uiNumSlots)
+  {
+    const nsUInt64 uiEntryBytes = uiNumSlots * JPHReplayEngineDetail::s_uiSnapshotBytesPerSlot;
+
+    nsUniquePtr<CacheEntry> pEntry;
+
+    // evict the least recently used snapshots, their memory is reused for the new one
+    while (!m_Cache.IsEmpty() && m_uiCacheBytes + uiEntryBytes > m_Settings.m_uiCacheSize)
+    {
+      nsUInt32 uiOldest = 0;
+      for (nsUInt32 i = 1; i < m_Cache.GetCount(); ++i)
+      {
+        if (m_Cache[i]->m_uiLastUse < m_Cache[uiOldest]->m_uiLastUse)
+          uiOldest = i;
+      }
+
+      m_uiCacheBytes -= m_Cache[uiOldest]->m_Snapshot.GetSlotCount() * JPHReplayEngineDetail::s_uiSnapshotBytesPerSlot;
+      m_CacheLookup.Remove(m_Cache[uiOldest]->m_uiStepIndex);
+
+      pEntry = std::move(m_Cache[uiOldest]);
+      m_Cache.RemoveAtAndSwap(uiOldest);
+    }
+
+    if (pEntry == nullptr)
+    {
+      pEntry = NS_DEFAULT_NEW(CacheEntry);
+    }
+
+    pEntry->m_uiStepIndex = uiStepIndex;
+    pEntry->m_uiLastUse = ++m_uiUseCounter;
+    pEntry->m_Snapshot.SetSlotCount(uiNumSlots);
+    m_uiCacheBytes += uiEntryBytes;
+
+    CacheEntry* pResult = pEntry.Borrow();
+    m_CacheLookup.Insert(uiStepIndex, pResult);
+    m_Cache.PushBack(std::move(pEntry));
+
+    return pResult->m_Snapshot;
+  }
+
+  void JPHReplayEngine::CaptureSimulatedStep()
+  {
+    if (m_CacheLookup.Contains(m_uiSimStep))
+      return;
+
+    m_pSystem->GetBodies(m_BodyIDScratch);
+
+    nsUInt32 uiNumSlots = 0;
+    for (const JPH::BodyID& bodyID : m_BodyIDScratch)
+    {
+      uiNumSlots = nsMath::Max(uiNumSlots, bodyID.GetIndex() + 1);
+    }
+
+    JPHBodySnapshot& snapshot = AddToCache(m_uiSimStep, uiNumSlots);
+    snapshot.m_uiStepIndex = m_uiSimStep;
+    snapshot.ClearSlots();
+
+    const nsTime startTime = nsTime::Now();
+    const JPH::BodyLockInterfaceNoLock& lockInterface = m_pSystem->GetBodyLockInterfaceNoLock();
+
+    for (const JPH::BodyID& bodyID : m_BodyIDScratch)
+    {
+      if (const JPH::Body* pBody = lockInterface.TryGetBody(bodyID))
+      {
+        snapshot.CaptureBody(*pBody, bodyID.GetIndex());
+      }
+    }
+
+    for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+    {
+      if (!snapshot.IsValid(uiSlot))
+        snapshot.m_BodyIDs[uiSlot] = JPH::BodyID::cInvalidBodyID;
+
+      snapshot.m_ShapeIDs[uiSlot] = JPHShapeDictionary::s_uiInvalidShapeID;
+    }
+
+    snapshot.m_CaptureDuration = nsTime::Now() - startTime;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHReplayEngine);
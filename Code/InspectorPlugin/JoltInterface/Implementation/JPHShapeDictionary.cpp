@@ -0,0 +1,357 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/IO/CompressedStreamZstd.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/Math/BoundingBox.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileFormat.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileReader.h>
+#include <InspectorPlugin/JoltInterface/JPHShapeDictionary.h>
+
+namespace JPHShapeDictionaryDetail
+{
+  /// Triangles requested per GetTrianglesNext() call.
+  static constexpr nsUInt32 s_uiTriangleBatch = 256;
+
+  static constexpr float s_fQuantizationSteps = 65535.0f;
+
+  /// The longest encoding of one index delta, see JPHByteWriter::WriteVarInt().
+  static constexpr nsUInt64 s_uiMaxIndexBytes = 10;
+
+  /// Fixed size part of the geometry data.
+  struct GeometryHeader
+  {
+    nsUInt32 m_uiShapeID;
+    nsUInt8 m_uiVersion;
+    nsUInt8 m_uiType;
+    nsUInt8 m_uiSubType;
+    nsUInt8 m_uiCompression;
+    float m_fBoundsMin[3];
+    float m_fBoundsMax[3];
+    nsUInt32 m_uiNumVertices;
+    nsUInt32 m_uiNumTriangles;
+    nsUInt32 m_uiPayloadSize;
+  };
+
+  static_assert(sizeof(GeometryHeader) == 44, "GeometryHeader must not contain implicit padding, it is written to the stream as is");
+
+  NS_ALWAYS_INLINE nsUInt16 QuantizeAxis(float fValue, float fMin, float fScale)
+  {
+    return static_cast<nsUInt16>(nsMath::Clamp((fValue - fMin) * fScale + 0.5f, 0.0f, s_fQuantizationSteps));
+  }
+} // namespace JPHShapeDictionaryDetail
+
+namespace JDebug::API
+{
+  JPHShapeDictionary::JPHShapeDictionary() = default;
+  JPHShapeDictionary::~JPHShapeDictionary() = default;
+
+  nsUInt32 JPHShapeDictionary::FindShapeID(const JPH::Shape* in_pShape) const
+  {
+    if (const ShapeEntry* pEntry = m_Shapes.GetValue(in_pShape))
+      return pEntry->m_uiID;
+
+    return s_uiInvalidShapeID;
+  }
+
+  nsUInt32 JPHShapeDictionary::RegisterShape(const JPH::Shape* in_pShape, bool& out_bNewGeometry)
+  {
+    NS_PROFILE_SCOPE("JPHShapeDictionary::RegisterShape");
+
+    out_bNewGeometry = false;
+
+    if (in_pShape == nullptr)
+      return s_uiInvalidShapeID;
+
+    if (const ShapeEntry* pEntry = m_Shapes.GetValue(in_pShape))
+      return pEntry->m_uiID;
+
+    nsDynamicArray<nsUInt8> data;
+    EncodeGeometry(*in_pShape, m_uiNextID, data);
+
+    // the hash covers everything but the ID, which is the first member of the header
+    const nsUInt64 uiContentHash = nsHashingUtils::xxHash64(data.GetData() + sizeof(nsUInt32), data.GetCount() - sizeof(nsUInt32));
+
+    ShapeEntry shapeEntry;
+    shapeEntry.m_pShape = in_pShape;
+
+    if (m_GeometryByHash.TryGetValue(uiContentHash, shapeEntry.m_uiID))
+    {
+      m_Geometries[shapeEntry.m_uiID].m_uiNumShapes++;
+    }
+    else
+    {
+      shapeEntry.m_uiID = m_uiNextID++;
+
+      GeometryEntry& geometry = m_Geometries[shapeEntry.m_uiID];
+      geometry.m_uiContentHash = uiContentHash;
+      geometry.m_uiNumShapes = 1;
+      geometry.m_Data.Swap(data);
+
+      m_GeometryByHash.Insert(uiContentHash, shapeEntry.m_uiID);
+      out_bNewGeometry = true;
+    }
+
+    const nsUInt32 uiID = shapeEntry.m_uiID;
+    m_Shapes.Insert(in_pShape, std::move(shapeEntry));
+    return uiID;
+  }
+
+  void JPHShapeDictionary::EvictReleasedShapes(nsDynamicArray<nsUInt32>& out_removedIDs)
+  {
+    out_removedIDs.Clear();
+
+    for (auto it = m_Shapes.GetIterator(); it.IsValid();)
+    {
+      // our own reference is the only one left, no body can use the shape anymore
+      if (it.Value().m_pShape->GetRefCount() > 1)
+      {
+        it.Next();
+        continue;
+      }
+
+      const nsUInt32 uiID = it.Value().m_uiID;
+      GeometryEntry& geometry = m_Geometries[uiID];
+
+      if (--geometry.m_uiNumShapes == 0)
+      {
+        m_GeometryByHash.Remove(geometry.m_uiContentHash);
+        m_Geometries.Remove(uiID);
+        out_removedIDs.PushBack(uiID);
+      }
+
+      it = m_Shapes.Remove(it);
+    }
+  }
+
+  nsArrayPtr<const nsUInt8> JPHShapeDictionary::GetGeometryData(nsUInt32 in_uiShapeID) const
+  {
+    if (const GeometryEntry* pEntry = m_Geometries.GetValue(in_uiShapeID))
+      return pEntry->m_Data;
+
+    return {};
+  }
+
+  void JPHShapeDictionary::GetShapeIDs(nsDynamicArray<nsUInt32>& out_shapeIDs) const
+  {
+    out_shapeIDs.Clear();
+    out_shapeIDs.Reserve(m_Geometries.GetCount());
+
+    for (auto it = m_Geometries.GetIterator(); it.IsValid(); ++it)
+    {
+      out_shapeIDs.PushBack(it.Key());
+    }
+  }
+
+  void JPHShapeDictionary::Clear()
+  {
+    m_Shapes.Clear();
+    m_Geometries.Clear();
+    m_GeometryByHash.Clear();
+  }
+
+  void JPHShapeDictionary::Triangulate(const JPH::Shape& shape)
+  {
+    using namespace JPHShapeDictionaryDetail;
+
+    m_Triangles.Clear();
+
+    // the center of mass is passed as position, so the vertices end up relative to the body position, same as the body transforms
+    JPH::Shape::GetTrianglesContext context;
+    shape.GetTrianglesStart(context, JPH::AABox::sBiggest(), shape.GetCenterOfMass(), JPH::Quat::sIdentity(), JPH::Vec3::sReplicate(1.0f));
+
+    for (;;)
+    {
+      const nsUInt32 uiOffset = m_Triangles.GetCount();
+
+      if (uiOffset / 3 >= m_Settings.m_uiMaxTriangles)
+      {
+        nsLog::Warning("JPHShapeDictionary: Shape with more than {} triangles, the geometry is truncated.", m_Settings.m_uiMaxTriangles);
+        break;
+      }
+
+      m_Triangles.SetCount(uiOffset + s_uiTriangleBatch * 3);
+
+      const int iNumTriangles = shape.GetTrianglesNext(context, s_uiTriangleBatch, m_Triangles.GetData() + uiOffset);
+      m_Triangles.SetCount(uiOffset + iNumTriangles * 3);
+
+      if (iNumTriangles == 0)
+        break;
+    }
+  }
+
+  void JPHShapeDictionary::EncodeGeometry(const JPH::Shape& shape, nsUInt32 uiID, nsDynamicArray<nsUInt8>& out_data)
+  {
+    using namespace JPHShapeDictionaryDetail;
+
+    Triangulate(shape);
+
+    nsBoundingBox bounds = nsBoundingBox::MakeInvalid();
+    for (const JPH::Float3& v : m_Triangles)
+    {
+      bounds.ExpandToInclude(nsVec3(v.x, v.y, v.z));
+    }
+
+    if (!bounds.IsValid())
+    {
+      bounds = nsBoundingBox::MakeFromMinMax(nsVec3::MakeZero(), nsVec3::MakeZero());
+    }
+
+    // zero extents (e.g. a flat plane) would divide by zero
+    const nsVec3 vExtents = bounds.GetExtents().CompMax(nsVec3(nsMath::SmallEpsilon<float>()));
+    const nsVec3 vScale = nsVec3(s_fQuantizationSteps).CompDiv(vExtents);
+
+    // vertices are shared between triangles, deduplicate them on their quantized position
+    m_VertexLookup.Clear();
+    m_Payload.Clear();
+
+    nsDynamicArray<nsUInt32> indices;
+    indices.Reserve(m_Triangles.GetCount());
+
+    IO::JPHByteWriter vertexWriter(m_Payload);
+
+    for (const JPH::Float3& v : m_Triangles)
+    {
+      const nsUInt16 x = QuantizeAxis(v.x, bounds.m_vMin.x, vScale.x);
+      const nsUInt16 y = QuantizeAxis(v.y, bounds.m_vMin.y, vScale.y);
+      const nsUInt16 z = QuantizeAxis(v.z, bounds.m_vMin.z, vScale.z);
+      const nsUInt64 uiKey = static_cast<nsUInt64>(x) | (static_cast<nsUInt64>(y) << 16) | (static_cast<nsUInt64>(z) << 32);
+
+      nsUInt32 uiIndex = m_VertexLookup.GetCount();
+      if (nsUInt32* pExisting = m_VertexLookup.GetValue(uiKey))
+      {
+        uiIndex = *pExisting;
+      }
+      else
+      {
+        m_VertexLookup.Insert(uiKey, uiIndex);
+        vertexWriter.Write(x);
+        vertexWriter.Write(y);
+        vertexWriter.Write(z);
+      }
+
+      indices.PushBack(uiIndex);
+    }
+
+    // consecutive triangles mostly reference nearby vertices, so the deltas stay small
+    nsInt64 iPrevIndex = 0;
+    for (nsUInt32 uiIndex : indices)
+    {
+      vertexWriter.WriteVarInt(static_cast<nsInt64>(uiIndex) - iPrevIndex);
+      iPrevIndex = uiIndex;
+    }
+
+    GeometryHeader header;
+    header.m_uiShapeID = uiID;
+    header.m_uiVersion = s_uiGeometryVersion;
+    header.m_uiType = static_cast<nsUInt8>(shape.GetType());
+    header.m_uiSubType = static_cast<nsUInt8>(shape.GetSubType());
+    header.m_uiCompression = static_cast<nsUInt8>(IO::JPHPVDCompression::None);
+    header.m_fBoundsMin[0] = bounds.m_vMin.x;
+    header.m_fBoundsMin[1] = bounds.m_vMin.y;
+    header.m_fBoundsMin[2] = bounds.m_vMin.z;
+    header.m_fBoundsMax[0] = bounds.m_vMax.x;
+    header.m_fBoundsMax[1] = bounds.m_vMax.y;
+    header.m_fBoundsMax[2] = bounds.m_vMax.z;
+    header.m_uiNumVertices = m_VertexLookup.GetCount();
+    header.m_uiNumTriangles = indices.GetCount() / 3;
+    header.m_uiPayloadSize = m_Payload.GetCount();
+
+    nsArrayPtr<const nsUInt8> payload = m_Payload;
+
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+    if (m_Payload.GetCount() >= m_Settings.m_uiMinCompressedSize)
+    {
+      m_Compressed.Clear();
+      nsMemoryStreamContainerWrapperStorage<nsDynamicArray<nsUInt8>> storage(&m_Compressed);
+      nsMemoryStreamWriter memoryWriter(&storage);
+
+      if (m_pCompressor == nullptr)
+      {
+        m_pCompressor = NS_DEFAULT_NEW(nsCompressedStreamWriterZstd);
+      }
+
+      m_pCompressor->SetOutputStream(&memoryWriter, 0, nsCompressedStreamWriterZstd::Compression::Default, 32);
+      m_pCompressor->WriteBytes(m_Payload.GetData(), m_Payload.GetCount()).IgnoreResult();
+      m_pCompressor->FinishCompressedStream().IgnoreResult();
+
+      if (m_Compressed.GetCount() < m_Payload.GetCount())
+      {
+        header.m_uiCompression = static_cast<nsUInt8>(IO::JPHPVDCompression::Zstd);
+        payload = m_Compressed;
+      }
+    }
+#endif
+
+    out_data.Clear();
+    out_data.Reserve(sizeof(GeometryHeader) + payload.GetCount());
+
+    IO::JPHByteWriter writer(out_data);
+    writer.Write(header);
+    writer.WriteBytes(payload.GetPtr(), payload.GetCount());
+  }
+
+  nsResult JPHShapeDictionary::DecodeGeometry(nsArrayPtr<const nsUInt8> in_data, JPHShapeGeometry& out_geometry)
+  {
+    using namespace JPHShapeDictionaryDetail;
+
+    IO::JPHByteReader headerReader(in_data);
+
+    GeometryHeader header;
+    if (!headerReader.Read(header) || header.m_uiVersion != s_uiGeometryVersion)
+      return NS_FAILURE;
+
+    out_geometry.m_uiShapeID = header.m_uiShapeID;
+    out_geometry.m_uiType = header.m_uiType;
+    out_geometry.m_uiSubType = header.m_uiSubType;
+    out_geometry.m_vBoundsMin.Set(header.m_fBoundsMin[0], header.m_fBoundsMin[1], header.m_fBoundsMin[2]);
+    out_geometry.m_vBoundsMax.Set(header.m_fBoundsMax[0], header.m_fBoundsMax[1], header.m_fBoundsMax[2]);
+
+    // every vertex takes 6 bytes and every index 1 to 10, a payload size that does not fit the counts is corrupt
+    const nsUInt64 uiVertexBytes = static_cast<nsUInt64>(header.m_uiNumVertices) * 3 * sizeof(nsUInt16);
+    const nsUInt64 uiNumIndices = static_cast<nsUInt64>(header.m_uiNumTriangles) * 3;
+
+    if (header.m_uiPayloadSize < uiVertexBytes + uiNumIndices || header.m_uiPayloadSize > uiVertexBytes + uiNumIndices * s_uiMaxIndexBytes)
+      return NS_FAILURE;
+
+    nsDynamicArray<nsUInt8> payload;
+    NS_SUCCEED_OR_RETURN(IO::JPHPVDFileReader::DecompressPayload(static_cast<IO::JPHPVDCompression>(header.m_uiCompression), in_data.GetSubArray(sizeof(GeometryHeader)), header.m_uiPayloadSize, payload));
+
+    const nsVec3 vMin = out_geometry.m_vBoundsMin;
+    const nsVec3 vStep = (out_geometry.m_vBoundsMax - vMin).CompMax(nsVec3(nsMath::SmallEpsilon<float>())) / s_fQuantizationSteps;
+
+    IO::JPHByteReader reader(payload);
+
+    out_geometry.m_Vertices.SetCountUninitialized(header.m_uiNumVertices);
+    for (nsVec3& v : out_geometry.m_Vertices)
+    {
+      nsUInt16 x = 0, y = 0, z = 0;
+      reader.Read(x);
+      reader.Read(y);
+      reader.Read(z);
+      v = vMin + nsVec3(x, y, z).CompMul(vStep);
+    }
+
+    out_geometry.m_Indices.SetCountUninitialized(static_cast<nsUInt32>(uiNumIndices));
+
+    nsInt64 iIndex = 0;
+    for (nsUInt32& uiIndex : out_geometry.m_Indices)
+    {
+      nsInt64 iDelta = 0;
+      if (!reader.ReadVarInt(iDelta))
+        return NS_FAILURE;
+
+      iIndex += iDelta;
+      if (iIndex < 0 || iIndex >= static_cast<nsInt64>(header.m_uiNumVertices))
+        return NS_FAILURE;
+
+      uiIndex = static_cast<nsUInt32>(iIndex);
+    }
+
+    // the payload size is part of the header, bytes beyond the last index mean it does not match the counts
+    return reader.HasFailed() || !reader.IsAtEnd() ? NS_FAILURE : NS_SUCCESS;
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHShapeDictionary);
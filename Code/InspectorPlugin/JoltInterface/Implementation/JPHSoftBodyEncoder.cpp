@@ -0,0 +1,491 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/SimdMath/SimdVec4i.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHSoftBodyEncoder.h>
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/SoftBody/SoftBodyMotionProperties.h>
+
+namespace JPHSoftBodyEncoderDetail
+{
+  using Encoder = JDebug::API::JPHSoftBodyEncoder;
+
+  /// Fixed size part of every frame.
+  struct FrameHeader
+  {
+    nsUInt32 m_uiMagic;
+    nsUInt8 m_uiVersion;
+    nsUInt8 m_uiFlags;
+    nsUInt16 m_uiReserved;
+    nsUInt64 m_uiStepIndex;
+    nsUInt32 m_uiNumBodies;
+    nsUInt32 m_uiPadding;
+  };
+
+  static_assert(sizeof(FrameHeader) == 24, "FrameHeader must not contain implicit padding, it is written to the stream as is");
+
+  static constexpr float s_fMaxQuantized = 65535.0f;
+
+  /// Bounds smaller than this per axis are grown to it, a flat cloth would otherwise have no extent to quantize in.
+  static constexpr float s_fMinExtent = 0.01f;
+
+  /// Bounds are recomputed once they are this many times larger than the vertices need, to keep the precision up.
+  static constexpr float s_fShrinkFactor = 2.0f;
+
+  /// A zig-zag encoded delta of two 16 bit values has at most 17 bits, three varint bytes.
+  static constexpr nsUInt32 s_uiMaxDeltaBytes = 3;
+
+  NS_ALWAYS_INLINE nsUInt8* WriteVarUInt(nsUInt8* pOut, nsUInt32 uiValue)
+  {
+    while (uiValue >= 0x80)
+    {
+      *pOut++ = static_cast<nsUInt8>(uiValue | 0x80);
+      uiValue >>= 7;
+    }
+
+    *pOut++ = static_cast<nsUInt8>(uiValue);
+    return pOut;
+  }
+
+  NS_ALWAYS_INLINE nsSimdVec4f LoadPosition(const JPH::SoftBodyMotionProperties::Vertex& vertex)
+  {
+    return nsSimdVec4f(vertex.mPosition.GetX(), vertex.mPosition.GetY(), vertex.mPosition.GetZ(), 0.0f);
+  }
+
+  NS_ALWAYS_INLINE nsSimdVec4i Quantize(const nsSimdVec4f& vPosition, const nsSimdVec4f& vMin, const nsSimdVec4f& vScale)
+  {
+    const nsSimdVec4f vScaled = (vPosition - vMin).CompMul(vScale) + nsSimdVec4f(0.5f);
+    return nsSimdVec4i::Truncate(vScaled).CompMax(nsSimdVec4i::MakeZero()).CompMin(nsSimdVec4i(static_cast<nsInt32>(s_fMaxQuantized)));
+  }
+} // namespace JPHSoftBodyEncoderDetail
+
+namespace JDebug::API
+{
+  JPHSoftBodyEncoder::JPHSoftBodyEncoder() = default;
+  JPHSoftBodyEncoder::~JPHSoftBodyEncoder() = default;
+
+  void JPHSoftBodyEncoder::Reset()
+  {
+    NS_ASSERT_DEV(!m_bFrameOpen, "Reset() cannot be called while a frame is encoded.");
+
+    m_Bodies.Clear();
+    m_Topologies.Clear();
+    m_bKeyframeRequested = true;
+  }
+
+  void JPHSoftBodyEncoder::BeginFrame(nsUInt64 in_uiStepIndex, nsDynamicArray<nsUInt8>& out_data)
+  {
+    using namespace JPHSoftBodyEncoderDetail;
+
+    NS_ASSERT_DEV(!m_bFrameOpen, "EndFrame() has not been called for the previous frame.");
+
+    m_bFrameOpen = true;
+    m_bKeyframe = m_bKeyframeRequested;
+    m_bKeyframeRequested = false;
+    m_uiNumFrameBodies = 0;
+    m_uiNumEncodedVertices = 0;
+    ++m_uiFrameCounter;
+
+    if (m_bKeyframe)
+    {
+      // the decoder starts over, everything has to be sent again
+      m_Bodies.Clear();
+
+      for (auto it : m_Topologies)
+        it.Value().m_bSent = false;
+    }
+
+    for (auto it : m_Topologies)
+      it.Value().m_bUsed = false;
+
+    out_data.Clear();
+    m_pData = &out_data;
+
+    FrameHeader header = {};
+    header.m_uiMagic = s_uiFrameMagic;
+    header.m_uiVersion = s_uiFrameVersion;
+    header.m_uiFlags = m_bKeyframe ? Frame_Keyframe : 0;
+    header.m_uiStepIndex = in_uiStepIndex;
+
+    IO::JPHByteWriter(out_data).Write(header);
+    m_uiNumBodiesOffset = offsetof(FrameHeader, m_uiNumBodies);
+  }
+
+  void JPHSoftBodyEncoder::EncodeBody(const JPH::Body& in_body)
+  {
+    using namespace JPHSoftBodyEncoderDetail;
+
+    NS_ASSERT_DEV(m_bFrameOpen, "Bodies can only be encoded between BeginFrame() and EndFrame().");
+    NS_ASSERT_DEV(in_body.IsSoftBody(), "Only soft bodies have vertices.");
+
+    const JPH::SoftBodyMotionProperties& motion = *static_cast<const JPH::SoftBodyMotionProperties*>(in_body.GetMotionProperties());
+    const JPH::SoftBodySharedSettings* pSettings = motion.GetSettings();
+    const JPH::Array<JPH::SoftBodyMotionProperties::Vertex>& vertices = motion.GetVertices();
+    const nsUInt32 uiNumVertices = static_cast<nsUInt32>(vertices.size());
+
+    bool bTopologyExisted = false;
+    Topology& topology = m_Topologies.FindOrAdd(pSettings, &bTopologyExisted);
+
+    if (!bTopologyExisted)
+    {
+      topology.m_pSettings = pSettings;
+      topology.m_uiID = m_uiNextTopologyID++;
+    }
+
+    topology.m_bUsed = true;
+
+    const nsUInt32 uiBodyID = in_body.GetID().GetIndexAndSequenceNumber();
+
+    bool bBodyExisted = false;
+    BodyState& state = m_Bodies.FindOrAdd(uiBodyID, &bBodyExisted);
+
+    NS_ASSERT_DEV(!bBodyExisted || state.m_uiLastFrame != m_uiFrameCounter, "The body was already encoded in this frame.");
+    state.m_uiLastFrame = m_uiFrameCounter;
+
+    // the vertex bounds decide whether the quantization bounds still fit
+    nsSimdVec4f vMin(nsMath::MaxValue<float>());
+    nsSimdVec4f vMax(-nsMath::MaxValue<float>());
+
+    for (const JPH::SoftBodyMotionProperties::Vertex& vertex : vertices)
+    {
+      const nsSimdVec4f vPosition = LoadPosition(vertex);
+      vMin = vMin.CompMin(vPosition);
+      vMax = vMax.CompMax(vPosition);
+    }
+
+    if (vertices.empty())
+    {
+      vMin = nsSimdVec4f::MakeZero();
+      vMax = nsSimdVec4f::MakeZero();
+    }
+
+    nsSimdVec4f vBoundsMin;
+    nsSimdVec4f vBoundsMax;
+    vBoundsMin.Load<4>(state.m_BoundsMin);
+    vBoundsMax.Load<4>(state.m_BoundsMax);
+
+    const nsSimdVec4f vExtent = (vMax - vMin).CompMax(nsSimdVec4f(s_fMinExtent));
+    const nsSimdVec4f vMargin = vExtent * m_Settings.m_fBoundsMargin;
+
+    bool bNewBounds = !bBodyExisted || state.m_uiTopologyID != topology.m_uiID || state.m_uiNumVertices != uiNumVertices;
+    bNewBounds = bNewBounds || (vMin < vBoundsMin).AnySet<3>() || (vMax > vBoundsMax).AnySet<3>();
+    bNewBounds = bNewBounds || ((vBoundsMax - vBoundsMin) > (vExtent + vMargin + vMargin) * s_fShrinkFactor).AnySet<3>();
+
+    if (bNewBounds)
+    {
+      vBoundsMin = vMin - vMargin;
+      vBoundsMax = vMax + vMargin;
+      vBoundsMin.Store<4>(state.m_BoundsMin);
+      vBoundsMax.Store<4>(state.m_BoundsMax);
+
+      state.m_uiTopologyID = topology.m_uiID;
+      state.m_uiNumVertices = uiNumVertices;
+      state.m_Quantized.SetCountUninitialized(uiNumVertices * 4);
+    }
+
+    nsUInt8 uiFlags = bNewBounds ? Body_Bounds : 0;
+    uiFlags |= topology.m_bSent ? 0 : Body_Topology;
+
+    const JPH::RVec3 vCenterOfMass = in_body.GetCenterOfMassPosition();
+
+    IO::JPHByteWriter writer(*m_pData);
+    writer.Write<nsUInt32>(uiBodyID);
+    const nsUInt32 uiFlagsOffset = writer.GetOffset();
+    writer.Write<nsUInt8>(uiFlags);
+    writer.WriteVarUInt(topology.m_uiID);
+    writer.Write<float>(static_cast<float>(vCenterOfMass.GetX()));
+    writer.Write<float>(static_cast<float>(vCenterOfMass.GetY()));
+    writer.Write<float>(static_cast<float>(vCenterOfMass.GetZ()));
+
+    if (!topology.m_bSent)
+    {
+      WriteTopology(*pSettings);
+      topology.m_bSent = true;
+    }
+
+    const nsSimdVec4f vScale = nsSimdVec4f(s_fMaxQuantized).CompDiv(vBoundsMax - vBoundsMin);
+    nsInt32* pQuantized = state.m_Quantized.GetData();
+
+    if (bNewBounds)
+    {
+      writer.WriteBytes(state.m_BoundsMin, sizeof(float) * 3);
+      writer.WriteBytes(state.m_BoundsMax, sizeof(float) * 3);
+
+      const nsUInt32 uiOffset = m_pData->GetCount();
+      m_pData->SetCountUninitialized(uiOffset + uiNumVertices * 3 * sizeof(nsUInt16));
+      nsUInt16* pOut = reinterpret_cast<nsUInt16*>(m_pData->GetData() + uiOffset);
+
+      for (nsUInt32 i = 0; i < uiNumVertices; ++i)
+      {
+        const nsSimdVec4i vQuantized = Quantize(LoadPosition(vertices[i]), vBoundsMin, vScale);
+        vQuantized.Store<4>(pQuantized + i * 4);
+
+        pOut[i * 3 + 0] = static_cast<nsUInt16>(pQuantized[i * 4 + 0]);
+        pOut[i * 3 + 1] = static_cast<nsUInt16>(pQuantized[i * 4 + 1]);
+        pOut[i * 3 + 2] = static_cast<nsUInt16>(pQuantized[i * 4 + 2]);
+      }
+    }
+    else
+    {
+      // reserve the worst case, so the varints can be written without bounds checks
+      const nsUInt32 uiOffset = m_pData->GetCount();
+      m_pData->SetCountUninitialized(uiOffset + uiNumVertices * 3 * s_uiMaxDeltaBytes);
+      nsUInt8* pStart = m_pData->GetData() + uiOffset;
+      nsUInt8* pOut = pStart;
+
+      nsSimdVec4i vAnyChange = nsSimdVec4i::MakeZero();
+      nsInt32 zigZag[4];
+
+      for (nsUInt32 i = 0; i < uiNumVertices; ++i)
+      {
+        const nsSimdVec4i vQuantized = Quantize(LoadPosition(vertices[i]), vBoundsMin, vScale);
+
+        nsSimdVec4i vPrevious;
+        vPrevious.Load<4>(pQuantized + i * 4);
+        vQuantized.Store<4>(pQuantized + i * 4);
+
+        const nsSimdVec4i vDelta = vQuantized - vPrevious;
+        const nsSimdVec4i vZigZag = (vDelta << 1) ^ (vDelta >> 31);
+        vAnyChange |= vZigZag;
+        vZigZag.Store<4>(zigZag);
+
+        pOut = WriteVarUInt(pOut, static_cast<nsUInt32>(zigZag[0]));
+        pOut = WriteVarUInt(pOut, static_cast<nsUInt32>(zigZag[1]));
+        pOut = WriteVarUInt(pOut, static_cast<nsUInt32>(zigZag[2]));
+      }
+
+      if ((vAnyChange == nsSimdVec4i::MakeZero()).AllSet<3>())
+      {
+        // nothing moved by a quantization step, e.g. because the body sleeps
+        m_pData->SetCountUninitialized(uiOffset);
+        writer.Patch<nsUInt8>(uiFlagsOffset, uiFlags | Body_Unchanged);
+      }
+      else
+      {
+        m_pData->SetCountUninitialized(uiOffset + static_cast<nsUInt32>(pOut - pStart));
+      }
+    }
+
+    ++m_uiNumFrameBodies;
+    m_uiNumEncodedVertices += uiNumVertices;
+  }
+
+  void JPHSoftBodyEncoder::WriteTopology(const JPH::SoftBodySharedSettings& settings)
+  {
+    IO::JPHByteWriter writer(*m_pData);
+    writer.WriteVarUInt(settings.mVertices.size());
+    writer.WriteVarUInt(settings.mFaces.size());
+
+    // neighboring faces share vertices, so the index deltas are mostly small
+    nsInt64 iPrevIndex = 0;
+
+    for (const JPH::SoftBodySharedSettings::Face& face : settings.mFaces)
+    {
+      for (nsUInt32 i = 0; i < 3; ++i)
+      {
+        writer.WriteVarInt(static_cast<nsInt64>(face.mVertex[i]) - iPrevIndex);
+        iPrevIndex = face.mVertex[i];
+      }
+    }
+  }
+
+  bool JPHSoftBodyEncoder::EndFrame()
+  {
+    NS_ASSERT_DEV(m_bFrameOpen, "BeginFrame() has not been called.");
+    m_bFrameOpen = false;
+
+    IO::JPHByteWriter(*m_pData).Patch<nsUInt32>(m_uiNumBodiesOffset, m_uiNumFrameBodies);
+    m_pData = nullptr;
+
+    // bodies that were not written are gone, the decoder drops them as well
+    for (auto it = m_Bodies.GetIterator(); it.IsValid();)
+    {
+      if (it.Value().m_uiLastFrame != m_uiFrameCounter)
+        it = m_Bodies.Remove(it);
+      else
+        ++it;
+    }
+
+    // IDs are never reused, so a released topology is simply sent again under a new ID if it shows up again
+    for (auto it = m_Topologies.GetIterator(); it.IsValid();)
+    {
+      if (!it.Value().m_bUsed)
+        it = m_Topologies.Remove(it);
+      else
+        ++it;
+    }
+
+    return m_bKeyframe;
+  }
+
+  nsResult JPHSoftBodyDecoder::DecodeFrame(nsArrayPtr<const nsUInt8> in_data)
+  {
+    using namespace JPHSoftBodyEncoderDetail;
+
+    IO::JPHByteReader reader(in_data);
+
+    FrameHeader header;
+    if (!reader.Read(header) || header.m_uiMagic != JPHSoftBodyEncoder::s_uiFrameMagic || header.m_uiVersion != JPHSoftBodyEncoder::s_uiFrameVersion)
+      return NS_FAILURE;
+
+    const bool bKeyframe = (header.m_uiFlags & JPHSoftBodyEncoder::Frame_Keyframe) != 0;
+
+    if (!bKeyframe && !m_bHasKeyframe)
+      return NS_FAILURE;
+
+    if (bKeyframe)
+    {
+      m_Topologies.Clear();
+      m_Bodies.Clear();
+      m_bHasKeyframe = true;
+    }
+
+    m_uiStepIndex = header.m_uiStepIndex;
+    m_BodyIDScratch.Clear();
+
+    for (nsUInt32 uiBody = 0; uiBody < header.m_uiNumBodies; ++uiBody)
+    {
+      nsUInt32 uiBodyID = 0;
+      nsUInt8 uiFlags = 0;
+      nsUInt64 uiTopologyID = 0;
+      nsVec3 vCenterOfMass;
+
+      if (!reader.Read(uiBodyID) || !reader.Read(uiFlags) || !reader.ReadVarUInt(uiTopologyID) || !reader.Read(vCenterOfMass))
+        return NS_FAILURE;
+
+      if (uiTopologyID > nsMath::MaxValue<nsUInt32>())
+        return NS_FAILURE;
+
+      if ((uiFlags & JPHSoftBodyEncoder::Body_Topology) != 0)
+      {
+        // topology IDs are never reused, so a known one is never sent again
+        bool bTopologyExisted = false;
+        Topology& topology = m_Topologies.FindOrAdd(static_cast<nsUInt32>(uiTopologyID), &bTopologyExisted);
+
+        if (bTopologyExisted)
+          return NS_FAILURE;
+
+        nsUInt64 uiNumVertices = 0;
+        nsUInt64 uiNumFaces = 0;
+
+        // every index takes at least one byte
+        if (!reader.ReadVarUInt(uiNumVertices) || !reader.ReadVarUInt(uiNumFaces) || uiNumVertices > nsMath::MaxValue<nsUInt32>() ||
+            uiNumFaces > (in_data.GetCount() - reader.GetOffset()) / 3)
+          return NS_FAILURE;
+
+        topology.m_uiNumVertices = static_cast<nsUInt32>(uiNumVertices);
+        topology.m_Indices.SetCountUninitialized(static_cast<nsUInt32>(uiNumFaces * 3));
+
+        nsInt64 iIndex = 0;
+        for (nsUInt32& uiIndex : topology.m_Indices)
+        {
+          nsInt64 iDelta = 0;
+          if (!reader.ReadVarInt(iDelta))
+            return NS_FAILURE;
+
+          // checked before adding, a corrupt delta must not overflow
+          if (iDelta < -iIndex || iDelta >= static_cast<nsInt64>(uiNumVertices) - iIndex)
+            return NS_FAILURE;
+
+          iIndex += iDelta;
+          uiIndex = static_cast<nsUInt32>(iIndex);
+        }
+      }
+
+      const Topology* pTopology = m_Topologies.GetValue(static_cast<nsUInt32>(uiTopologyID));
+      if (pTopology == nullptr)
+        return NS_FAILURE;
+
+      const nsUInt32 uiNumVertices = pTopology->m_uiNumVertices;
+
+      bool bBodyExisted = false;
+      Body& body = m_Bodies.FindOrAdd(uiBodyID, &bBodyExisted);
+      body.m_vCenterOfMass = vCenterOfMass;
+      m_BodyIDScratch.PushBack(uiBodyID);
+
+      if ((uiFlags & JPHSoftBodyEncoder::Body_Bounds) != 0)
+      {
+        nsVec3 vBoundsMax;
+        if (!reader.Read(body.m_vBoundsMin) || !reader.Read(vBoundsMax) ||
+            static_cast<nsUInt64>(uiNumVertices) * 3 * sizeof(nsUInt16) > in_data.GetCount() - reader.GetOffset())
+          return NS_FAILURE;
+
+        body.m_uiTopologyID = static_cast<nsUInt32>(uiTopologyID);
+        body.m_vQuantum = (vBoundsMax - body.m_vBoundsMin) / s_fMaxQuantized;
+        body.m_Quantized.SetCountUninitialized(uiNumVertices * 3);
+
+        if (!reader.ReadBytes(body.m_Quantized.GetData(), uiNumVertices * 3 * sizeof(nsUInt16)))
+          return NS_FAILURE;
+      }
+      else
+      {
+        // deltas need the positions of the previous frame
+        if (!bBodyExisted || body.m_uiTopologyID != uiTopologyID || body.m_Quantized.GetCount() != uiNumVertices * 3)
+          return NS_FAILURE;
+
+        if ((uiFlags & JPHSoftBodyEncoder::Body_Unchanged) != 0)
+          continue;
+
+        for (nsUInt16& uiValue : body.m_Quantized)
+        {
+          nsInt64 iDelta = 0;
+          if (!reader.ReadVarInt(iDelta))
+            return NS_FAILURE;
+
+          uiValue = static_cast<nsUInt16>(uiValue + static_cast<nsUInt64>(iDelta));
+        }
+      }
+
+      body.m_Positions.SetCountUninitialized(uiNumVertices);
+
+      for (nsUInt32 i = 0; i < uiNumVertices; ++i)
+      {
+        const nsVec3 vQuantized(body.m_Quantized[i * 3 + 0], body.m_Quantized[i * 3 + 1], body.m_Quantized[i * 3 + 2]);
+        body.m_Positions[i] = body.m_vBoundsMin + vQuantized.CompMul(body.m_vQuantum);
+      }
+    }
+
+    if (!reader.IsAtEnd())
+      return NS_FAILURE;
+
+    // bodies that are not in the frame were removed
+    if (m_BodyIDScratch.GetCount() != m_Bodies.GetCount())
+    {
+      for (auto it = m_Bodies.GetIterator(); it.IsValid();)
+      {
+        if (!m_BodyIDScratch.Contains(it.Key()))
+          it = m_Bodies.Remove(it);
+        else
+          ++it;
+      }
+    }
+
+    // the encoder releases topologies no body uses anymore
+    for (auto it = m_Topologies.GetIterator(); it.IsValid();)
+    {
+      bool bUsed = false;
+
+      for (auto itBody : m_Bodies)
+      {
+        bUsed = bUsed || itBody.Value().m_uiTopologyID == it.Key();
+      }
+
+      if (!bUsed)
+        it = m_Topologies.Remove(it);
+      else
+        ++it;
+    }
+
+    return NS_SUCCESS;
+  }
+
+  void JPHSoftBodyDecoder::Reset()
+  {
+    m_bHasKeyframe = false;
+    m_uiStepIndex = 0;
+    m_Topologies.Clear();
+    m_Bodies.Clear();
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHSoftBodyEncoder);
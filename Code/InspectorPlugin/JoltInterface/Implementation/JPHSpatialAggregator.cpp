@@ -0,0 +1,366 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHSpatialAggregator.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/Body/BodyLockInterface.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JPHSpatialAggregatorDetail
+{
+  /// Number of body slots binned by a single task.
+  static constexpr nsUInt32 s_uiSlotsPerChunk = 16384;
+
+  /// Cell coordinates are packed into 21 bits per axis, x in the highest bits, so ordering the keys orders the cells by x, then y, then z.
+  static constexpr nsUInt32 s_uiCoordBits = 21;
+  static constexpr nsInt32 s_iCoordBias = 1 << (s_uiCoordBits - 1);
+  static constexpr nsUInt64 s_uiCoordMask = (nsUInt64(1) << s_uiCoordBits) - 1;
+
+  /// Doubling the cell size more often than this merges all of the coordinate range into a single cell.
+  static constexpr nsUInt32 s_uiMaxLevel = s_uiCoordBits;
+
+  /// Shared by all binning tasks, kept in one struct so the lambda stays small enough for the delegate's inline storage.
+  struct AggregateContext
+  {
+    const JDebug::API::JPHBodySnapshot* m_pSnapshot = nullptr;
+    const nsUInt8* m_pInterestMask = nullptr;
+    const JPH::BodyLockInterface* m_pLockInterface = nullptr;
+    nsUInt32 m_uiNumSlots = 0;
+    nsUInt32 m_uiMaxCells = 0;
+    float m_fInvCellSize = 0.0f;
+    nsAtomicInteger32 m_iMinLevel; ///< The highest level any chunk had to coarsen to so far, the merged grid is at least that coarse.
+  };
+
+  static nsUInt64 PackCoords(nsInt32 x, nsInt32 y, nsInt32 z)
+  {
+    return (static_cast<nsUInt64>(x + s_iCoordBias) << (2 * s_uiCoordBits)) | (static_cast<nsUInt64>(y + s_iCoordBias) << s_uiCoordBits) | static_cast<nsUInt64>(z + s_iCoordBias);
+  }
+
+  static nsVec3I32 UnpackCoords(nsUInt64 uiKey)
+  {
+    return nsVec3I32(static_cast<nsInt32>((uiKey >> (2 * s_uiCoordBits)) & s_uiCoordMask) - s_iCoordBias,
+      static_cast<nsInt32>((uiKey >> s_uiCoordBits) & s_uiCoordMask) - s_iCoordBias, static_cast<nsInt32>(uiKey & s_uiCoordMask) - s_iCoordBias);
+  }
+
+  /// The key of the cell that contains the given one after doubling the cell size uiLevels times. The shift rounds towards negative infinity.
+  static nsUInt64 CoarsenKey(nsUInt64 uiKey, nsUInt32 uiLevels)
+  {
+    const nsVec3I32 coords = UnpackCoords(uiKey);
+    return PackCoords(coords.x >> uiLevels, coords.y >> uiLevels, coords.z >> uiLevels);
+  }
+
+  /// Applies a coordinate difference read from untrusted data, fails if the result does not fit into 32 bit.
+  static bool AddCoordDelta(nsInt32 iPrevious, nsInt64 iDelta, nsInt32& out_iCoord)
+  {
+    // a valid difference is at most 2^32 in either direction, checking it first keeps the sum from overflowing
+    if (iDelta < -(nsInt64(1) << 32) || iDelta > (nsInt64(1) << 32))
+      return false;
+
+    const nsInt64 iCoord = iPrevious + iDelta;
+
+    if (iCoord < nsMath::MinValue<nsInt32>() || iCoord > nsMath::MaxValue<nsInt32>())
+      return false;
+
+    out_iCoord = static_cast<nsInt32>(iCoord);
+    return true;
+  }
+
+  static nsInt32 GetCellCoord(float fPosition, float fInvCellSize)
+  {
+    // positions too far out for the key all end up in the outermost cells
+    const float fCell = nsMath::Clamp(nsMath::Floor(fPosition * fInvCellSize), static_cast<float>(-s_iCoordBias), static_cast<float>(s_iCoordBias - 1));
+    return static_cast<nsInt32>(fCell);
+  }
+
+  /// Linear plus rotational kinetic energy of a dynamic body, the inertia tensor is diagonal in the space of GetInertiaRotation().
+  static float GetKineticEnergy(const JPH::Body& body, const nsVec3& vLinearVelocity, const nsVec3& vAngularVelocity)
+  {
+    const JPH::MotionProperties* pMotion = body.GetMotionPropertiesUnchecked();
+    const float fInvMass = pMotion->GetInverseMassUnchecked();
+    float fEnergy = fInvMass > 0.0f ? 0.5f * vLinearVelocity.GetLengthSquared() / fInvMass : 0.0f;
+
+    const JPH::Vec3 vInvInertia = pMotion->GetInverseInertiaDiagonal();
+    const JPH::Vec3 vLocalAngular = (body.GetRotation() * pMotion->GetInertiaRotation()).InverseRotate(JPH::Vec3(vAngularVelocity.x, vAngularVelocity.y, vAngularVelocity.z));
+
+    for (nsUInt32 i = 0; i < 3; ++i)
+    {
+      if (vInvInertia[i] > 0.0f)
+        fEnergy += 0.5f * vLocalAngular[i] * vLocalAngular[i] / vInvInertia[i];
+    }
+
+    return fEnergy;
+  }
+} // namespace JPHSpatialAggregatorDetail
+
+namespace JDebug::API
+{
+  void JPHAggregateGrid::Write(nsDynamicArray<nsUInt8>& out_data) const
+  {
+    out_data.Clear();
+
+    IO::JPHByteWriter writer(out_data);
+    writer.Write(m_fCellSize);
+    writer.Write(m_uiLevel);
+    writer.WriteVarUInt(m_uiNumBodies);
+    writer.WriteVarUInt(m_Cells.GetCount());
+
+    nsVec3I32 previousCoords = nsVec3I32::MakeZero();
+
+    for (const JPHAggregateCell& cell : m_Cells)
+    {
+      writer.WriteVarInt(static_cast<nsInt64>(cell.m_Coords.x) - previousCoords.x);
+      writer.WriteVarInt(static_cast<nsInt64>(cell.m_Coords.y) - previousCoords.y);
+      writer.WriteVarInt(static_cast<nsInt64>(cell.m_Coords.z) - previousCoords.z);
+      writer.WriteVarUInt(cell.m_uiNumBodies);
+      writer.WriteVarUInt(cell.m_uiNumActiveBodies);
+      writer.Write(cell.m_Bounds.m_vMin);
+      writer.Write(cell.m_Bounds.m_vMax);
+      writer.Write(cell.m_vMeanVelocity);
+      writer.Write(cell.m_fMaxKineticEnergy);
+
+      previousCoords = cell.m_Coords;
+    }
+  }
+
+  nsResult JPHAggregateGrid::Read(nsArrayPtr<const nsUInt8> in_data)
+  {
+    *this = JPHAggregateGrid();
+
+    IO::JPHByteReader reader(in_data);
+    nsUInt64 uiValue = 0;
+    nsInt64 iValue = 0;
+
+    reader.Read(m_fCellSize);
+    reader.Read(m_uiLevel);
+    reader.ReadVarUInt(uiValue);
+    m_uiNumBodies = static_cast<nsUInt32>(uiValue);
+
+    if (uiValue > nsMath::MaxValue<nsUInt32>())
+      return NS_FAILURE;
+
+    reader.ReadVarUInt(uiValue);
+
+    // every cell takes at least 45 bytes, don't trust the count before checking it against the data that is actually there
+    if (reader.HasFailed() || uiValue > (in_data.GetCount() - reader.GetOffset()) / 45)
+      return NS_FAILURE;
+
+    m_Cells.SetCount(static_cast<nsUInt32>(uiValue));
+
+    nsVec3I32 previousCoords = nsVec3I32::MakeZero();
+
+    for (JPHAggregateCell& cell : m_Cells)
+    {
+      reader.ReadVarInt(iValue);
+      const bool bValidX = JPHSpatialAggregatorDetail::AddCoordDelta(previousCoords.x, iValue, cell.m_Coords.x);
+      reader.ReadVarInt(iValue);
+      const bool bValidY = JPHSpatialAggregatorDetail::AddCoordDelta(previousCoords.y, iValue, cell.m_Coords.y);
+      reader.ReadVarInt(iValue);
+      const bool bValidZ = JPHSpatialAggregatorDetail::AddCoordDelta(previousCoords.z, iValue, cell.m_Coords.z);
+
+      if (!bValidX || !bValidY || !bValidZ)
+        return NS_FAILURE;
+
+      reader.ReadVarUInt(uiValue);
+      cell.m_uiNumBodies = static_cast<nsUInt32>(uiValue);
+
+      if (uiValue > nsMath::MaxValue<nsUInt32>())
+        return NS_FAILURE;
+
+      reader.ReadVarUInt(uiValue);
+      cell.m_uiNumActiveBodies = static_cast<nsUInt32>(uiValue);
+
+      if (uiValue > cell.m_uiNumBodies)
+        return NS_FAILURE;
+
+      reader.Read(cell.m_Bounds.m_vMin);
+      reader.Read(cell.m_Bounds.m_vMax);
+      reader.Read(cell.m_vMeanVelocity);
+      reader.Read(cell.m_fMaxKineticEnergy);
+
+      previousCoords = cell.m_Coords;
+    }
+
+    return (reader.HasFailed() || !reader.IsAtEnd()) ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  void JPHSpatialAggregator::CellAccumulator::Merge(const CellAccumulator& other)
+  {
+    m_uiNumBodies += other.m_uiNumBodies;
+    m_uiNumActiveBodies += other.m_uiNumActiveBodies;
+    m_Bounds.ExpandToInclude(other.m_Bounds);
+    m_vVelocitySum += other.m_vVelocitySum;
+    m_fMaxKineticEnergy = nsMath::Max(m_fMaxKineticEnergy, other.m_fMaxKineticEnergy);
+  }
+
+  JPHSpatialAggregator::JPHSpatialAggregator() = default;
+  JPHSpatialAggregator::~JPHSpatialAggregator() = default;
+
+  void JPHSpatialAggregator::Coarsen(CellTable& ref_cells, nsUInt32 uiLevels)
+  {
+    if (uiLevels == 0)
+      return;
+
+    CellTable coarseCells;
+    coarseCells.Reserve(ref_cells.GetCount());
+
+    for (auto it : ref_cells)
+    {
+      coarseCells.FindOrAdd(JPHSpatialAggregatorDetail::CoarsenKey(it.Key(), uiLevels), nullptr).Merge(it.Value());
+    }
+
+    ref_cells.Swap(coarseCells);
+  }
+
+  void JPHSpatialAggregator::Aggregate(const JPH::PhysicsSystem* in_pPhysicsSystem, const JPHBodySnapshot& in_snapshot, nsArrayPtr<const nsUInt8> in_interestMask,
+    const JPHAggregationSettings& in_settings, JPHAggregateGrid& out_grid)
+  {
+    NS_PROFILE_SCOPE("JPHSpatialAggregator::Aggregate");
+
+    using namespace JPHSpatialAggregatorDetail;
+
+    const nsUInt32 uiNumSlots = nsMath::Min(in_snapshot.GetSlotCount(), in_interestMask.GetCount());
+    const nsUInt32 uiNumChunks = (uiNumSlots + s_uiSlotsPerChunk - 1) / s_uiSlotsPerChunk;
+    const nsUInt32 uiMaxCells = nsMath::Max(in_settings.m_uiMaxCells, 1u);
+    const float fCellSize = nsMath::Max(in_settings.m_fCellSize, 0.001f);
+
+    m_ChunkCells.SetCount(uiNumChunks);
+    m_ChunkLevels.SetCount(uiNumChunks);
+
+    AggregateContext context;
+    context.m_pSnapshot = &in_snapshot;
+    context.m_pInterestMask = in_interestMask.GetPtr();
+    context.m_pLockInterface = in_pPhysicsSystem != nullptr ? &in_pPhysicsSystem->GetBodyLockInterfaceNoLock() : nullptr;
+    context.m_uiNumSlots = uiNumSlots;
+    context.m_uiMaxCells = uiMaxCells;
+    context.m_fInvCellSize = 1.0f / fCellSize;
+
+    nsParallelForParams params;
+    params.m_uiBinSize = 1;
+    params.m_uiMaxTasksPerThread = 2;
+
+    nsTaskSystem::ParallelForIndexed(
+      0, uiNumChunks, [this, &context](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+      {
+        const JPHBodySnapshot& snapshot = *context.m_pSnapshot;
+
+        for (nsUInt32 uiChunk = uiStartIndex; uiChunk < uiEndIndex; ++uiChunk)
+        {
+          CellTable& cells = m_ChunkCells[uiChunk];
+          // finer levels than another chunk needed would be merged away anyway
+          nsUInt32 uiLevel = static_cast<nsUInt32>(context.m_iMinLevel);
+          cells.Clear();
+
+          const nsUInt32 uiFirstSlot = uiChunk * s_uiSlotsPerChunk;
+          const nsUInt32 uiEndSlot = nsMath::Min(uiFirstSlot + s_uiSlotsPerChunk, context.m_uiNumSlots);
+
+          for (nsUInt32 uiSlot = uiFirstSlot; uiSlot < uiEndSlot; ++uiSlot)
+          {
+            if (context.m_pInterestMask[uiSlot] != 0 || !snapshot.IsValid(uiSlot))
+              continue;
+
+            const nsVec3& vPosition = snapshot.m_Positions[uiSlot];
+
+            if (!vPosition.IsValid())
+              continue;
+
+            // binned at the finest level and shifted, so the cell is exactly the one coarsening would have put the body in
+            const nsUInt64 uiKey = PackCoords(GetCellCoord(vPosition.x, context.m_fInvCellSize) >> uiLevel, GetCellCoord(vPosition.y, context.m_fInvCellSize) >> uiLevel,
+              GetCellCoord(vPosition.z, context.m_fInvCellSize) >> uiLevel);
+            CellAccumulator& cell = cells.FindOrAdd(uiKey, nullptr);
+
+            ++cell.m_uiNumBodies;
+            cell.m_uiNumActiveBodies += snapshot.IsActive(uiSlot) ? 1 : 0;
+            cell.m_vVelocitySum += snapshot.m_LinearVelocities[uiSlot];
+
+            const JPH::Body* pBody = context.m_pLockInterface != nullptr ? context.m_pLockInterface->TryGetBody(JPH::BodyID(snapshot.m_BodyIDs[uiSlot])) : nullptr;
+
+            if (pBody != nullptr)
+            {
+              const JPH::AABox& bounds = pBody->GetWorldSpaceBounds();
+              cell.m_Bounds.ExpandToInclude(nsBoundingBox::MakeFromMinMax(nsVec3(bounds.mMin.GetX(), bounds.mMin.GetY(), bounds.mMin.GetZ()), nsVec3(bounds.mMax.GetX(), bounds.mMax.GetY(), bounds.mMax.GetZ())));
+
+              if (pBody->IsDynamic())
+                cell.m_fMaxKineticEnergy = nsMath::Max(cell.m_fMaxKineticEnergy, GetKineticEnergy(*pBody, snapshot.m_LinearVelocities[uiSlot], snapshot.m_AngularVelocities[uiSlot]));
+            }
+            else
+            {
+              cell.m_Bounds.ExpandToInclude(vPosition);
+            }
+
+            // if this chunk alone occupies too many cells, the final grid is coarser anyway, coarsening now keeps the memory bounded
+            if (cells.GetCount() > context.m_uiMaxCells && uiLevel < s_uiMaxLevel)
+            {
+              const nsUInt32 uiNewLevel = nsMath::Max(uiLevel + 1, static_cast<nsUInt32>(context.m_iMinLevel));
+              Coarsen(cells, uiNewLevel - uiLevel);
+              uiLevel = uiNewLevel;
+              context.m_iMinLevel.Max(static_cast<nsInt32>(uiLevel));
+            }
+          }
+
+          m_ChunkLevels[uiChunk] = static_cast<nsUInt8>(uiLevel);
+        }
+      },
+      "JoltSpatialAggregation", nsTaskNesting::Never, params);
+
+    // merged in chunk order, so the sums do not depend on which task finished first
+    nsUInt32 uiLevel = 0;
+
+    for (nsUInt8 uiChunkLevel : m_ChunkLevels)
+    {
+      uiLevel = nsMath::Max<nsUInt32>(uiLevel, uiChunkLevel);
+    }
+
+    m_MergedCells.Clear();
+
+    for (nsUInt32 uiChunk = 0; uiChunk < uiNumChunks; ++uiChunk)
+    {
+      const nsUInt32 uiLevelDifference = uiLevel - m_ChunkLevels[uiChunk];
+
+      for (auto it : m_ChunkCells[uiChunk])
+      {
+        m_MergedCells.FindOrAdd(CoarsenKey(it.Key(), uiLevelDifference), nullptr).Merge(it.Value());
+      }
+    }
+
+    while (m_MergedCells.GetCount() > uiMaxCells && uiLevel < s_uiMaxLevel)
+    {
+      Coarsen(m_MergedCells, 1);
+      ++uiLevel;
+    }
+
+    m_SortedKeys.Clear();
+    m_SortedKeys.Reserve(m_MergedCells.GetCount());
+
+    for (auto it : m_MergedCells)
+    {
+      m_SortedKeys.PushBack(it.Key());
+    }
+
+    m_SortedKeys.Sort();
+
+    out_grid.m_fCellSize = fCellSize * static_cast<float>(nsUInt64(1) << uiLevel);
+    out_grid.m_uiLevel = static_cast<nsUInt8>(uiLevel);
+    out_grid.m_uiNumBodies = 0;
+    out_grid.m_Cells.SetCount(m_SortedKeys.GetCount());
+
+    for (nsUInt32 i = 0; i < m_SortedKeys.GetCount(); ++i)
+    {
+      const CellAccumulator& accumulator = *m_MergedCells.GetValue(m_SortedKeys[i]);
+      JPHAggregateCell& cell = out_grid.m_Cells[i];
+
+      cell.m_Coords = UnpackCoords(m_SortedKeys[i]);
+      cell.m_uiNumBodies = accumulator.m_uiNumBodies;
+      cell.m_uiNumActiveBodies = accumulator.m_uiNumActiveBodies;
+      cell.m_Bounds = accumulator.m_Bounds;
+      cell.m_vMeanVelocity = accumulator.m_vVelocitySum / static_cast<float>(accumulator.m_uiNumBodies);
+      cell.m_fMaxKineticEnergy = accumulator.m_fMaxKineticEnergy;
+
+      out_grid.m_uiNumBodies += accumulator.m_uiNumBodies;
+    }
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHSpatialAggregator);
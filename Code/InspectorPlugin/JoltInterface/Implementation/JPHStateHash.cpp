@@ -0,0 +1,416 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Algorithm/HashingUtils.h>
+#include <Foundation/Containers/HybridArray.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileReader.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHFrameEncoder.h>
+#include <InspectorPlugin/JoltInterface/JPHStateHash.h>
+
+namespace JPHStateHashDetail
+{
+  /// Number of ranges hashed by a single task.
+  static constexpr nsUInt32 s_uiRangesPerTask = 4;
+
+  /// The body fields in the order of JPHStateHashField, for log output.
+  static constexpr const char* s_szFieldNames[JDebug::API::JPHStateHash::s_uiNumFields] = {"Identity", "Position", "Rotation", "LinearVelocity", "AngularVelocity"};
+
+  /// The identity of a body, gathered into one struct so it is hashed as one block.
+  struct BodyIdentity
+  {
+    nsUInt32 m_uiBodyID;
+    nsUInt32 m_uiObjectLayer;
+    nsUInt8 m_uiMotionType;
+    nsUInt8 m_uiState;
+    nsUInt8 m_uiPadding[2];
+  };
+
+  /// Hashes the values of all valid bodies in [uiFirstSlot, uiEndSlot). Unused slots hold stale data, so they are skipped.
+  template <typename T>
+  static nsUInt64 HashField(const JDebug::API::JPHBodySnapshot& snapshot, const nsDynamicArray<T>& values, nsUInt32 uiFirstSlot, nsUInt32 uiEndSlot, nsHybridArray<nsUInt8, 16384>& ref_scratch)
+  {
+    ref_scratch.Clear();
+
+    for (nsUInt32 uiSlot = uiFirstSlot; uiSlot < uiEndSlot; ++uiSlot)
+    {
+      if (snapshot.IsValid(uiSlot))
+      {
+        const nsUInt32 uiOffset = ref_scratch.GetCount();
+        ref_scratch.SetCountUninitialized(uiOffset + sizeof(T));
+        nsMemoryUtils::Copy(ref_scratch.GetData() + uiOffset, reinterpret_cast<const nsUInt8*>(&values[uiSlot]), sizeof(T));
+      }
+    }
+
+    return nsHashingUtils::xxHash64(ref_scratch.GetData(), ref_scratch.GetCount());
+  }
+
+  static void HashRange(const JDebug::API::JPHBodySnapshot& snapshot, nsUInt32 uiFirstSlot, nsUInt32 uiEndSlot, nsUInt64* pOutHashes)
+  {
+    // large enough for the positions of a default sized range, so hashing does not allocate
+    nsHybridArray<nsUInt8, 16384> scratch;
+
+    for (nsUInt32 uiSlot = uiFirstSlot; uiSlot < uiEndSlot; ++uiSlot)
+    {
+      if (snapshot.IsValid(uiSlot))
+      {
+        BodyIdentity identity;
+        identity.m_uiBodyID = snapshot.m_BodyIDs[uiSlot];
+        identity.m_uiObjectLayer = snapshot.m_ObjectLayers[uiSlot];
+        identity.m_uiMotionType = snapshot.m_MotionTypes[uiSlot];
+        identity.m_uiState = snapshot.m_States[uiSlot];
+        identity.m_uiPadding[0] = 0;
+        identity.m_uiPadding[1] = 0;
+
+        scratch.PushBackRange(nsArrayPtr<const nsUInt8>(reinterpret_cast<const nsUInt8*>(&identity), sizeof(BodyIdentity)));
+      }
+    }
+
+    pOutHashes[0] = nsHashingUtils::xxHash64(scratch.GetData(), scratch.GetCount());
+
+    pOutHashes[1] = HashField(snapshot, snapshot.m_Positions, uiFirstSlot, uiEndSlot, scratch);
+    pOutHashes[2] = HashField(snapshot, snapshot.m_Rotations, uiFirstSlot, uiEndSlot, scratch);
+    pOutHashes[3] = HashField(snapshot, snapshot.m_LinearVelocities, uiFirstSlot, uiEndSlot, scratch);
+    pOutHashes[4] = HashField(snapshot, snapshot.m_AngularVelocities, uiFirstSlot, uiEndSlot, scratch);
+  }
+
+  /// Finds the first record of the given type in a frame payload.
+  static nsArrayPtr<const nsUInt8> FindRecord(nsArrayPtr<const nsUInt8> payload, JDebug::API::IO::JPHPVDRecordType eType, nsDynamicArray<JDebug::API::IO::JPHPVDFileReader::Record>& ref_records)
+  {
+    if (JDebug::API::IO::JPHPVDFileReader::GetRecords(payload, ref_records).Failed())
+      return {};
+
+    for (const JDebug::API::IO::JPHPVDFileReader::Record& record : ref_records)
+    {
+      if (record.m_eType == eType)
+        return record.m_Data;
+    }
+
+    return {};
+  }
+
+  /// Everything needed to read the hashes and states of one capture.
+  struct CaptureCursor
+  {
+    const JDebug::API::IO::JPHPVDFileReader* m_pReader = nullptr;
+    nsDynamicArray<nsUInt8> m_Payload;
+    nsDynamicArray<JDebug::API::IO::JPHPVDFileReader::Record> m_Records;
+    nsUInt32* m_pNumFramesRead = nullptr;
+
+    nsResult ReadHash(nsUInt32 uiFrame, JDebug::API::JPHStateHash& out_hash)
+    {
+      NS_SUCCEED_OR_RETURN(m_pReader->ReadFrame(uiFrame, m_Payload));
+      ++(*m_pNumFramesRead);
+
+      return out_hash.Read(FindRecord(m_Payload, JDebug::API::IO::JPHPVDRecordType::StateHash, m_Records));
+    }
+
+    nsResult DecodeState(nsUInt32 uiFrame, JDebug::API::JPHBodySnapshot& out_snapshot)
+    {
+      JDebug::API::JPHFrameDecoder decoder;
+
+      for (nsUInt32 uiDecodeFrame = m_pReader->GetKeyframe(uiFrame); uiDecodeFrame <= uiFrame; ++uiDecodeFrame)
+      {
+        NS_SUCCEED_OR_RETURN(m_pReader->ReadFrame(uiDecodeFrame, m_Payload));
+        ++(*m_pNumFramesRead);
+
+        const nsArrayPtr<const nsUInt8> frame = FindRecord(m_Payload, JDebug::API::IO::JPHPVDRecordType::EncodedFrame, m_Records);
+        NS_SUCCEED_OR_RETURN(decoder.DecodeFrame(frame, out_snapshot));
+      }
+
+      return NS_SUCCESS;
+    }
+  };
+
+  /// Returns the fields in which the decoded bodies in the given slot differ.
+  static nsUInt8 CompareBodies(const JDebug::API::JPHBodySnapshot& a, const JDebug::API::JPHBodySnapshot& b, nsUInt32 uiSlot)
+  {
+    const bool bValidA = uiSlot < a.GetSlotCount() && a.IsValid(uiSlot);
+    const bool bValidB = uiSlot < b.GetSlotCount() && b.IsValid(uiSlot);
+
+    if (!bValidA && !bValidB)
+      return 0;
+
+    if (bValidA != bValidB)
+      return JDebug::API::StateHash_Identity;
+
+    nsUInt8 uiFields = 0;
+
+    if (a.m_BodyIDs[uiSlot] != b.m_BodyIDs[uiSlot] || a.m_States[uiSlot] != b.m_States[uiSlot] || a.m_MotionTypes[uiSlot] != b.m_MotionTypes[uiSlot] ||
+        a.m_ObjectLayers[uiSlot] != b.m_ObjectLayers[uiSlot])
+      uiFields |= JDebug::API::StateHash_Identity;
+
+    if (a.m_Positions[uiSlot] != b.m_Positions[uiSlot])
+      uiFields |= JDebug::API::StateHash_Position;
+
+    if (a.m_Rotations[uiSlot] != b.m_Rotations[uiSlot])
+      uiFields |= JDebug::API::StateHash_Rotation;
+
+    if (a.m_LinearVelocities[uiSlot] != b.m_LinearVelocities[uiSlot])
+      uiFields |= JDebug::API::StateHash_LinearVelocity;
+
+    if (a.m_AngularVelocities[uiSlot] != b.m_AngularVelocities[uiSlot])
+      uiFields |= JDebug::API::StateHash_AngularVelocity;
+
+    return uiFields;
+  }
+} // namespace JPHStateHashDetail
+
+namespace JDebug::API
+{
+  void JPHStateHash::Compute(const JPHBodySnapshot& in_snapshot, nsUInt32 in_uiSlotsPerRange)
+  {
+    NS_PROFILE_SCOPE("JPHStateHash::Compute");
+
+    m_uiSlotsPerRange = nsMath::Max(in_uiSlotsPerRange, 1u);
+    m_uiNumSlots = in_snapshot.GetSlotCount();
+
+    const nsUInt32 uiNumRanges = (m_uiNumSlots + m_uiSlotsPerRange - 1) / m_uiSlotsPerRange;
+    m_SubHashes.SetCountUninitialized(uiNumRanges * s_uiNumFields);
+
+    nsParallelForParams params;
+    params.m_uiBinSize = JPHStateHashDetail::s_uiRangesPerTask;
+    params.m_uiMaxTasksPerThread = 2;
+
+    nsTaskSystem::ParallelForIndexed(
+      0, uiNumRanges, [this, &in_snapshot](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+      {
+        for (nsUInt32 uiRange = uiStartIndex; uiRange < uiEndIndex; ++uiRange)
+        {
+          const nsUInt32 uiFirstSlot = uiRange * m_uiSlotsPerRange;
+          const nsUInt32 uiEndSlot = nsMath::Min(uiFirstSlot + m_uiSlotsPerRange, m_uiNumSlots);
+
+          JPHStateHashDetail::HashRange(in_snapshot, uiFirstSlot, uiEndSlot, m_SubHashes.GetData() + uiRange * s_uiNumFields);
+        }
+      },
+      "JoltStateHash", nsTaskNesting::Never, params);
+
+    m_uiRootHash = nsHashingUtils::xxHash64(m_SubHashes.GetData(), m_SubHashes.GetCount() * sizeof(nsUInt64), m_uiNumSlots);
+  }
+
+  void JPHStateHash::Write(nsDynamicArray<nsUInt8>& out_data) const
+  {
+    out_data.Clear();
+
+    IO::JPHByteWriter writer(out_data);
+    writer.Write(m_uiRootHash);
+    writer.Write(m_uiSlotsPerRange);
+    writer.Write(m_uiNumSlots);
+    writer.Write(GetNumRanges());
+    writer.WriteBytes(m_SubHashes.GetData(), m_SubHashes.GetCount() * sizeof(nsUInt64));
+  }
+
+  nsResult JPHStateHash::Read(nsArrayPtr<const nsUInt8> in_data)
+  {
+    IO::JPHByteReader reader(in_data);
+
+    nsUInt32 uiNumRanges = 0;
+    reader.Read(m_uiRootHash);
+    reader.Read(m_uiSlotsPerRange);
+    reader.Read(m_uiNumSlots);
+    reader.Read(uiNumRanges);
+
+    // don't trust the count before checking it against the data that is actually there
+    if (reader.HasFailed() || m_uiSlotsPerRange == 0 || static_cast<nsUInt64>(uiNumRanges) * s_uiNumFields * sizeof(nsUInt64) > in_data.GetCount() - reader.GetOffset())
+      return NS_FAILURE;
+
+    // FindDivergence() derives the slots of a range from the slot count, so both have to agree
+    if (uiNumRanges != (static_cast<nsUInt64>(m_uiNumSlots) + m_uiSlotsPerRange - 1) / m_uiSlotsPerRange)
+      return NS_FAILURE;
+
+    m_SubHashes.SetCountUninitialized(uiNumRanges * s_uiNumFields);
+    reader.ReadBytes(m_SubHashes.GetData(), m_SubHashes.GetCount() * sizeof(nsUInt64));
+
+    return (reader.HasFailed() || !reader.IsAtEnd()) ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  nsResult JPHStateHashCompare::FindDivergence(const IO::JPHPVDFileReader& in_first, const IO::JPHPVDFileReader& in_second, JPHDivergenceReport& out_report)
+  {
+    NS_PROFILE_SCOPE("JPHStateHashCompare::FindDivergence");
+
+    out_report = JPHDivergenceReport();
+
+    // only the seek tables are needed to find the steps both captures hold
+    nsDynamicArray<nsUInt32> commonFrames[2];
+
+    for (nsUInt32 uiFrame = 0; uiFrame < in_first.GetNumFrames(); ++uiFrame)
+    {
+      const nsUInt64 uiStepIndex = in_first.GetFrameInfo(uiFrame).m_uiStepIndex;
+      const nsUInt32 uiSecondFrame = in_second.FindFrame(uiStepIndex);
+
+      if (uiSecondFrame != nsInvalidIndex && in_second.GetFrameInfo(uiSecondFrame).m_uiStepIndex == uiStepIndex)
+      {
+        commonFrames[0].PushBack(uiFrame);
+        commonFrames[1].PushBack(uiSecondFrame);
+      }
+    }
+
+    if (commonFrames[0].IsEmpty())
+    {
+      nsLog::Error("JPHStateHashCompare: The captures have no steps in common.");
+      return NS_FAILURE;
+    }
+
+    JPHStateHashDetail::CaptureCursor cursors[2];
+    cursors[0].m_pReader = &in_first;
+    cursors[1].m_pReader = &in_second;
+    cursors[0].m_pNumFramesRead = &out_report.m_uiNumFramesRead;
+    cursors[1].m_pNumFramesRead = &out_report.m_uiNumFramesRead;
+
+    JPHStateHash hashes[2];
+
+    auto Matches = [&](nsUInt32 uiCommonIndex, bool& out_bMatches) -> nsResult
+    {
+      for (nsUInt32 i = 0; i < 2; ++i)
+      {
+        if (cursors[i].ReadHash(commonFrames[i][uiCommonIndex], hashes[i]).Failed())
+        {
+          nsLog::Error("JPHStateHashCompare: Step {} of capture {} holds no state hash.", in_first.GetFrameInfo(commonFrames[0][uiCommonIndex]).m_uiStepIndex, i + 1);
+          return NS_FAILURE;
+        }
+      }
+
+      out_bMatches = hashes[0].m_uiRootHash == hashes[1].m_uiRootHash;
+      return NS_SUCCESS;
+    };
+
+    bool bMatches = false;
+    NS_SUCCEED_OR_RETURN(Matches(commonFrames[0].GetCount() - 1, bMatches));
+
+    if (bMatches)
+      return NS_SUCCESS;
+
+    // invariant: the step at uiHigh diverges, all steps before uiLow match
+    nsUInt32 uiLow = 0;
+    nsUInt32 uiHigh = commonFrames[0].GetCount() - 1;
+
+    while (uiLow < uiHigh)
+    {
+      const nsUInt32 uiMid = uiLow + (uiHigh - uiLow) / 2;
+      NS_SUCCEED_OR_RETURN(Matches(uiMid, bMatches));
+
+      if (bMatches)
+        uiLow = uiMid + 1;
+      else
+        uiHigh = uiMid;
+    }
+
+    out_report.m_bDiverged = true;
+    out_report.m_uiStepIndex = in_first.GetFrameInfo(commonFrames[0][uiHigh]).m_uiStepIndex;
+
+    if (uiHigh > 0)
+    {
+      out_report.m_bHasMatchingStep = true;
+      out_report.m_uiLastMatchingStep = in_first.GetFrameInfo(commonFrames[0][uiHigh - 1]).m_uiStepIndex;
+    }
+
+    // the last probe was not necessarily the divergent step
+    NS_SUCCEED_OR_RETURN(Matches(uiHigh, bMatches));
+
+    if (hashes[0].m_uiSlotsPerRange != hashes[1].m_uiSlotsPerRange)
+    {
+      nsLog::Warning("JPHStateHashCompare: The captures use different hash ranges, the divergent bodies cannot be narrowed down.");
+      return NS_SUCCESS;
+    }
+
+    // a range that only exists in one capture differs in all fields
+    const nsUInt32 uiNumRanges = nsMath::Max(hashes[0].GetNumRanges(), hashes[1].GetNumRanges());
+    const nsUInt32 uiNumSlots = nsMath::Max(hashes[0].m_uiNumSlots, hashes[1].m_uiNumSlots);
+
+    for (nsUInt32 uiRange = 0; uiRange < uiNumRanges; ++uiRange)
+    {
+      nsUInt8 uiFields = 0;
+
+      for (nsUInt32 uiField = 0; uiField < JPHStateHash::s_uiNumFields; ++uiField)
+      {
+        if (uiRange >= hashes[0].GetNumRanges() || uiRange >= hashes[1].GetNumRanges() || hashes[0].GetSubHash(uiRange, uiField) != hashes[1].GetSubHash(uiRange, uiField))
+          uiFields |= static_cast<nsUInt8>(NS_BIT(uiField));
+      }
+
+      if (uiFields != 0)
+      {
+        JPHDivergentRange& range = out_report.m_Ranges.ExpandAndGetRef();
+        range.m_uiFirstSlot = uiRange * hashes[0].m_uiSlotsPerRange;
+        range.m_uiNumSlots = nsMath::Min(hashes[0].m_uiSlotsPerRange, uiNumSlots - range.m_uiFirstSlot);
+        range.m_uiFields = uiFields;
+      }
+    }
+
+    // the hashes only tell the range, the decoded frames tell the bodies
+    JPHBodySnapshot states[2];
+
+    for (nsUInt32 i = 0; i < 2; ++i)
+    {
+      if (cursors[i].DecodeState(commonFrames[i][uiHigh], states[i]).Failed())
+      {
+        nsLog::Warning("JPHStateHashCompare: The frame of step {} cannot be decoded, the divergent bodies cannot be narrowed down.", out_report.m_uiStepIndex);
+        return NS_SUCCESS;
+      }
+    }
+
+    for (const JPHDivergentRange& range : out_report.m_Ranges)
+    {
+      for (nsUInt32 uiSlot = range.m_uiFirstSlot; uiSlot < range.m_uiFirstSlot + range.m_uiNumSlots; ++uiSlot)
+      {
+        const nsUInt8 uiFields = JPHStateHashDetail::CompareBodies(states[0], states[1], uiSlot) & range.m_uiFields;
+
+        if (uiFields == 0)
+          continue;
+
+        JPHDivergentBody& body = out_report.m_Bodies.ExpandAndGetRef();
+        body.m_uiSlot = uiSlot;
+        body.m_uiBodyIDs[0] = uiSlot < states[0].GetSlotCount() ? states[0].m_BodyIDs[uiSlot] : nsInvalidIndex;
+        body.m_uiBodyIDs[1] = uiSlot < states[1].GetSlotCount() ? states[1].m_BodyIDs[uiSlot] : nsInvalidIndex;
+        body.m_uiFields = uiFields;
+      }
+    }
+
+    return NS_SUCCESS;
+  }
+
+  void JPHStateHashCompare::LogReport(const JPHDivergenceReport& in_report)
+  {
+    if (!in_report.m_bDiverged)
+    {
+      nsLog::Info("The captures do not diverge ({} frames read).", in_report.m_uiNumFramesRead);
+      return;
+    }
+
+    NS_LOG_BLOCK("Capture divergence");
+
+    if (in_report.m_bHasMatchingStep)
+      nsLog::Info("First divergent step: {}, last matching step: {} ({} frames read)", in_report.m_uiStepIndex, in_report.m_uiLastMatchingStep, in_report.m_uiNumFramesRead);
+    else
+      nsLog::Info("First divergent step: {}, the captures differ from their first common step on ({} frames read)", in_report.m_uiStepIndex, in_report.m_uiNumFramesRead);
+
+    auto FormatFields = [](nsUInt8 uiFields, nsStringBuilder& out_sFields)
+    {
+      out_sFields.Clear();
+
+      for (nsUInt32 uiField = 0; uiField < JPHStateHash::s_uiNumFields; ++uiField)
+      {
+        if ((uiFields & NS_BIT(uiField)) != 0)
+          out_sFields.AppendWithSeparator(", ", JPHStateHashDetail::s_szFieldNames[uiField]);
+      }
+    };
+
+    nsStringBuilder sFields;
+
+    for (const JPHDivergentRange& range : in_report.m_Ranges)
+    {
+      FormatFields(range.m_uiFields, sFields);
+      nsLog::Info("Slots {} - {}: {}", range.m_uiFirstSlot, range.m_uiFirstSlot + range.m_uiNumSlots - 1, sFields);
+    }
+
+    for (const JPHDivergentBody& body : in_report.m_Bodies)
+    {
+      FormatFields(body.m_uiFields, sFields);
+      nsLog::Info("Slot {}, body {} / {}: {}", body.m_uiSlot, nsArgU(body.m_uiBodyIDs[0], 8, true, 16), nsArgU(body.m_uiBodyIDs[1], 8, true, 16), sFields);
+    }
+
+    if (in_report.m_Bodies.IsEmpty())
+      nsLog::Info("The values differ below the quantization of the captured frames, no body can be named.");
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHStateHash);
@@ -0,0 +1,417 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHContactRecorder.h>
+#include <InspectorPlugin/JoltInterface/JPHStepStatistics.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/BodyLockInterface.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+namespace JPHStepStatisticsDetail
+{
+  using JPHStepPhase = JDebug::API::JPHStepPhase;
+
+  struct PhaseJob
+  {
+    const char* m_szJobName;
+    JPHStepPhase::Enum m_ePhase;
+  };
+
+  /// The job names PhysicsSystem::Update() passes to JobSystem::CreateJob().
+  static constexpr PhaseJob s_PhaseJobs[] = {
+    {"UpdateBroadPhasePrepare", JPHStepPhase::BroadPhase},
+    {"UpdateBroadPhaseFinalize", JPHStepPhase::BroadPhase},
+    {"FindCollisions", JPHStepPhase::NarrowPhase},
+    {"DetermineActiveConstraints", JPHStepPhase::Constraints},
+    {"SetupVelocityConstraints", JPHStepPhase::Constraints},
+    {"BuildIslandsFromConstraints", JPHStepPhase::Islands},
+    {"FinalizeIslands", JPHStepPhase::Islands},
+    {"BodySetIslandIndex", JPHStepPhase::Islands},
+    {"SolveVelocityConstraints", JPHStepPhase::SolveVelocity},
+    {"ApplyGravity", JPHStepPhase::Integrate},
+    {"PreIntegrateVelocity", JPHStepPhase::Integrate},
+    {"IntegrateVelocity", JPHStepPhase::Integrate},
+    {"PostIntegrateVelocity", JPHStepPhase::Integrate},
+    {"FindCCDContacts", JPHStepPhase::CCD},
+    {"ResolveCCDContacts", JPHStepPhase::CCD},
+    {"SolvePositionConstraints", JPHStepPhase::SolvePosition},
+    {"SoftBodyPrepare", JPHStepPhase::SoftBody},
+    {"SoftBodyCollide", JPHStepPhase::SoftBody},
+    {"SoftBodySimulate", JPHStepPhase::SoftBody},
+    {"SoftBodyFinalize", JPHStepPhase::SoftBody},
+    {"StepListeners", JPHStepPhase::Listeners},
+    {"ContactRemovedCallbacks", JPHStepPhase::Listeners},
+  };
+
+  static constexpr const char* s_szPhaseNames[JPHStepPhase::ENUM_COUNT] = {
+    "Broad Phase", "Narrow Phase", "Constraints", "Islands", "Solve Velocity", "Integrate", "CCD", "Solve Position", "Soft Bodies", "Listeners"};
+
+  /// Scope names are string literals, so their address identifies them. Entries are (address << 8) | (phase + 1), 0 is empty.
+  static constexpr nsUInt32 s_uiNameCacheSize = 256;
+  static constexpr nsUInt32 s_uiMaxProbes = 8;
+  static nsAtomicInteger64 s_NameCache[s_uiNameCacheSize];
+
+  /// The monitor the jobs of the calling thread are timed for, set by JPHTaskJobSystem.
+  static thread_local JDebug::API::JPHStepMonitor* tl_pThreadMonitor = nullptr;
+
+  /// How many monitors have timing enabled, the profiler bridge only looks up scopes while this is not zero.
+  static nsAtomicInteger32 s_iNumTimedMonitors;
+
+  /// Receives the jobs of threads without a monitor while exactly one monitor has timing enabled.
+  /// Only changes in SetTimingEnabled(), which must not be called while a physics system is updated.
+  static JDebug::API::JPHStepMonitor* s_pSoleTimedMonitor = nullptr;
+  static JDebug::API::JPHStepMonitor* s_pFirstTimedMonitor = nullptr;
+  static nsMutex s_TimedMonitorsMutex;
+
+  static nsUInt8 ResolvePhase(const char* szScopeName)
+  {
+    for (const PhaseJob& job : s_PhaseJobs)
+    {
+      if (nsStringUtils::IsEqual(szScopeName, job.m_szJobName))
+        return static_cast<nsUInt8>(job.m_ePhase);
+    }
+
+    return JDebug::API::JPHStepMonitor::s_uiNoPhase;
+  }
+
+  static nsUInt32 GetIslandBucket(nsUInt32 uiIslandSize)
+  {
+    // 1 -> 0, 2-3 -> 1, 4-7 -> 2, ...
+    return nsMath::Min(nsMath::Log2i(uiIslandSize), JDebug::API::JPHStepStatistics::s_uiNumIslandBuckets - 1);
+  }
+} // namespace JPHStepStatisticsDetail
+
+namespace JDebug::API
+{
+  const char* JPHStepPhase::GetName(Enum in_ePhase)
+  {
+    return in_ePhase < ENUM_COUNT ? JPHStepStatisticsDetail::s_szPhaseNames[in_ePhase] : "";
+  }
+
+  void JPHStepStatistics::Write(nsDynamicArray<nsUInt8>& out_data) const
+  {
+    out_data.Clear();
+
+    IO::JPHByteWriter writer(out_data);
+    writer.Write<nsUInt8>(JPHStepPhase::ENUM_COUNT);
+
+    for (const JPHStepPhaseTiming& phase : m_Phases)
+    {
+      writer.WriteVarUInt(static_cast<nsUInt64>(phase.m_CpuTime.GetNanoseconds()));
+      writer.WriteVarUInt(static_cast<nsUInt64>(phase.m_WallTime.GetNanoseconds()));
+      writer.WriteVarUInt(phase.m_uiNumJobs);
+    }
+
+    writer.WriteVarUInt(static_cast<nsUInt64>(m_StepTime.GetNanoseconds()));
+    writer.WriteVarUInt(m_uiNumBodies);
+    writer.WriteVarUInt(m_uiNumActiveBodies);
+    writer.WriteVarUInt(m_uiNumActiveSoftBodies);
+    writer.WriteVarUInt(m_uiNumIslands);
+    writer.WriteVarUInt(m_uiLargestIsland);
+    writer.Write<nsUInt8>(s_uiNumIslandBuckets);
+
+    for (nsUInt32 uiCount : m_IslandSizes)
+    {
+      writer.WriteVarUInt(uiCount);
+    }
+
+    writer.WriteVarUInt(m_uiNumBodyPairs);
+    writer.WriteVarUInt(m_uiNumContactConstraints);
+    writer.WriteVarUInt(m_uiNumCCDBodies);
+    writer.WriteVarUInt(m_uiNumVelocitySteps);
+    writer.WriteVarUInt(m_uiNumPositionSteps);
+  }
+
+  nsResult JPHStepStatistics::Read(nsArrayPtr<const nsUInt8> in_data)
+  {
+    *this = JPHStepStatistics();
+
+    IO::JPHByteReader reader(in_data);
+    nsUInt64 uiValue = 0;
+
+    auto ReadCount = [&](nsUInt32& out_uiCount)
+    {
+      reader.ReadVarUInt(uiValue);
+      out_uiCount = static_cast<nsUInt32>(uiValue);
+    };
+
+    auto ReadTime = [&](nsTime& out_time)
+    {
+      reader.ReadVarUInt(uiValue);
+      out_time = nsTime::MakeFromNanoseconds(static_cast<double>(uiValue));
+    };
+
+    nsUInt8 uiNumPhases = 0;
+    reader.Read(uiNumPhases);
+
+    for (nsUInt32 i = 0; i < uiNumPhases && !reader.HasFailed(); ++i)
+    {
+      JPHStepPhaseTiming phase;
+      ReadTime(phase.m_CpuTime);
+      ReadTime(phase.m_WallTime);
+      ReadCount(phase.m_uiNumJobs);
+
+      if (i < JPHStepPhase::ENUM_COUNT)
+        m_Phases[i] = phase;
+    }
+
+    ReadTime(m_StepTime);
+    ReadCount(m_uiNumBodies);
+    ReadCount(m_uiNumActiveBodies);
+    ReadCount(m_uiNumActiveSoftBodies);
+    ReadCount(m_uiNumIslands);
+    ReadCount(m_uiLargestIsland);
+
+    nsUInt8 uiNumBuckets = 0;
+    reader.Read(uiNumBuckets);
+
+    for (nsUInt32 i = 0; i < uiNumBuckets && !reader.HasFailed(); ++i)
+    {
+      nsUInt32 uiCount = 0;
+      ReadCount(uiCount);
+
+      // a writer with more buckets splits the largest ones further, they all belong into the last bucket here
+      m_IslandSizes[nsMath::Min(i, s_uiNumIslandBuckets - 1)] += uiCount;
+    }
+
+    ReadCount(m_uiNumBodyPairs);
+    ReadCount(m_uiNumContactConstraints);
+    ReadCount(m_uiNumCCDBodies);
+    ReadCount(m_uiNumVelocitySteps);
+    ReadCount(m_uiNumPositionSteps);
+
+    return reader.HasFailed() ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  JPHStepMonitor::JPHStepMonitor()
+  {
+    ResetPhases();
+  }
+
+  JPHStepMonitor::~JPHStepMonitor()
+  {
+    SetTimingEnabled(false);
+  }
+
+  void JPHStepMonitor::SetTimingEnabled(bool in_bEnabled)
+  {
+    using namespace JPHStepStatisticsDetail;
+
+    if (static_cast<bool>(m_bTimingEnabled) == in_bEnabled)
+      return;
+
+    NS_LOCK(s_TimedMonitorsMutex);
+
+    if (in_bEnabled)
+    {
+      ResetPhases();
+
+      m_pNextTimedMonitor = s_pFirstTimedMonitor;
+      s_pFirstTimedMonitor = this;
+      s_iNumTimedMonitors.Increment();
+    }
+    else
+    {
+      JPHStepMonitor** ppLink = &s_pFirstTimedMonitor;
+      while (*ppLink != this)
+      {
+        ppLink = &(*ppLink)->m_pNextTimedMonitor;
+      }
+
+      *ppLink = m_pNextTimedMonitor;
+      m_pNextTimedMonitor = nullptr;
+      s_iNumTimedMonitors.Decrement();
+    }
+
+    m_bTimingEnabled = in_bEnabled;
+    s_pSoleTimedMonitor = s_iNumTimedMonitors == 1 ? s_pFirstTimedMonitor : nullptr;
+  }
+
+  bool JPHStepMonitor::IsAnyTimingEnabled()
+  {
+    return JPHStepStatisticsDetail::s_iNumTimedMonitors > 0;
+  }
+
+  JPHStepMonitor* JPHStepMonitor::SetThreadMonitor(JPHStepMonitor* in_pMonitor)
+  {
+    JPHStepMonitor* pPrevious = JPHStepStatisticsDetail::tl_pThreadMonitor;
+    JPHStepStatisticsDetail::tl_pThreadMonitor = in_pMonitor;
+    return pPrevious;
+  }
+
+  nsUInt8 JPHStepMonitor::FindPhase(const char* in_szScopeName)
+  {
+    using namespace JPHStepStatisticsDetail;
+
+    if (in_szScopeName == nullptr)
+      return s_uiNoPhase;
+
+    const nsUInt64 uiAddress = reinterpret_cast<nsUInt64>(in_szScopeName);
+    const nsUInt32 uiStart = static_cast<nsUInt32>((uiAddress * 0x9E3779B97F4A7C15ull) >> 56);
+
+    for (nsUInt32 uiProbe = 0; uiProbe < s_uiMaxProbes; ++uiProbe)
+    {
+      nsAtomicInteger64& entry = s_NameCache[(uiStart + uiProbe) % s_uiNameCacheSize];
+      const nsUInt64 uiEntry = static_cast<nsUInt64>(static_cast<nsInt64>(entry));
+
+      if (uiEntry == 0)
+      {
+        // first time this scope is seen, racing threads resolve it to the same value, so losing the race is fine
+        const nsUInt8 uiPhase = ResolvePhase(in_szScopeName);
+        entry.TestAndSet(0, static_cast<nsInt64>((uiAddress << 8) | static_cast<nsUInt8>(uiPhase + 1)));
+        return uiPhase;
+      }
+
+      if ((uiEntry >> 8) == uiAddress)
+        return static_cast<nsUInt8>((uiEntry & 0xFF) - 1);
+    }
+
+    // the neighborhood is full, this only happens with many distinct scope names
+    return ResolvePhase(in_szScopeName);
+  }
+
+  void JPHStepMonitor::AddPhaseMeasurement(nsUInt8 in_uiPhase, nsTime in_beginTime, nsTime in_endTime)
+  {
+    JPHStepMonitor* pMonitor = JPHStepStatisticsDetail::tl_pThreadMonitor;
+
+    if (pMonitor == nullptr)
+      pMonitor = JPHStepStatisticsDetail::s_pSoleTimedMonitor;
+
+    if (pMonitor == nullptr || !pMonitor->m_bTimingEnabled)
+      return;
+
+    pMonitor->AddPhase(in_uiPhase, static_cast<nsInt64>(in_beginTime.GetNanoseconds()), static_cast<nsInt64>(in_endTime.GetNanoseconds()));
+  }
+
+  void JPHStepMonitor::ResetPhases()
+  {
+    for (PhaseAccumulator& phase : m_Phases)
+    {
+      phase.m_iCpuNanoseconds = 0;
+      phase.m_iFirstBeginNanoseconds = nsMath::MaxValue<nsInt64>();
+      phase.m_iLastEndNanoseconds = 0;
+      phase.m_iNumJobs = 0;
+    }
+  }
+
+  void JPHStepMonitor::AddPhase(nsUInt8 uiPhase, nsInt64 iBegin, nsInt64 iEnd)
+  {
+    PhaseAccumulator& phase = m_Phases[uiPhase];
+
+    phase.m_iCpuNanoseconds.Add(iEnd - iBegin);
+    phase.m_iFirstBeginNanoseconds.Min(iBegin);
+    phase.m_iLastEndNanoseconds.Max(iEnd);
+    phase.m_iNumJobs.Increment();
+  }
+
+  void JPHStepMonitor::Collect(const JPH::PhysicsSystem& in_system, const JPHContactRecorder* in_pContactRecorder, JPHStepStatistics& out_statistics)
+  {
+    NS_PROFILE_SCOPE("JPHStepMonitor::Collect");
+
+    out_statistics = JPHStepStatistics();
+
+    if (m_bTimingEnabled)
+    {
+      nsInt64 iStepBegin = nsMath::MaxValue<nsInt64>();
+      nsInt64 iStepEnd = 0;
+
+      for (nsUInt32 i = 0; i < JPHStepPhase::ENUM_COUNT; ++i)
+      {
+        const PhaseAccumulator& accumulator = m_Phases[i];
+        JPHStepPhaseTiming& phase = out_statistics.m_Phases[i];
+
+        phase.m_uiNumJobs = static_cast<nsUInt32>(accumulator.m_iNumJobs);
+
+        if (phase.m_uiNumJobs == 0)
+          continue;
+
+        const nsInt64 iBegin = accumulator.m_iFirstBeginNanoseconds;
+        const nsInt64 iEnd = accumulator.m_iLastEndNanoseconds;
+
+        phase.m_CpuTime = nsTime::MakeFromNanoseconds(static_cast<double>(static_cast<nsInt64>(accumulator.m_iCpuNanoseconds)));
+        phase.m_WallTime = nsTime::MakeFromNanoseconds(static_cast<double>(iEnd - iBegin));
+
+        iStepBegin = nsMath::Min(iStepBegin, iBegin);
+        iStepEnd = nsMath::Max(iStepEnd, iEnd);
+      }
+
+      if (iStepEnd > iStepBegin)
+        out_statistics.m_StepTime = nsTime::MakeFromNanoseconds(static_cast<double>(iStepEnd - iStepBegin));
+
+      ResetPhases();
+    }
+
+    out_statistics.m_uiNumBodies = in_system.GetNumBodies();
+    out_statistics.m_uiNumActiveBodies = in_system.GetNumActiveBodies(JPH::EBodyType::RigidBody);
+    out_statistics.m_uiNumActiveSoftBodies = in_system.GetNumActiveBodies(JPH::EBodyType::SoftBody);
+
+    if (in_pContactRecorder != nullptr)
+    {
+      out_statistics.m_uiNumBodyPairs = in_pContactRecorder->GetNumBodyPairs();
+      out_statistics.m_uiNumContactConstraints = in_pContactRecorder->GetNumContactConstraints();
+    }
+
+    CollectIslands(in_system, out_statistics);
+  }
+
+  void JPHStepMonitor::CollectIslands(const JPH::PhysicsSystem& system, JPHStepStatistics& inout_statistics)
+  {
+    const JPH::PhysicsSettings& settings = system.GetPhysicsSettings();
+    inout_statistics.m_uiNumVelocitySteps = inout_statistics.m_uiNumActiveBodies > 0 ? settings.mNumVelocitySteps : 0;
+    inout_statistics.m_uiNumPositionSteps = inout_statistics.m_uiNumActiveBodies > 0 ? settings.mNumPositionSteps : 0;
+
+    // island indices are below the number of active bodies, bodies that woke up during the step still have an old index
+    const nsUInt32 uiNumActive = inout_statistics.m_uiNumActiveBodies;
+    m_IslandSizes.Clear();
+    m_IslandSizes.SetCount(uiNumActive);
+
+    const JPH::BodyID* pActiveBodies = system.GetActiveBodiesUnsafe(JPH::EBodyType::RigidBody);
+    const JPH::BodyLockInterface& lockInterface = system.GetBodyLockInterfaceNoLock();
+    nsUInt32 uiNumStaleIndices = 0;
+
+    for (nsUInt32 i = 0; i < uiNumActive; ++i)
+    {
+      const JPH::Body* pBody = lockInterface.TryGetBody(pActiveBodies[i]);
+
+      if (pBody == nullptr)
+        continue;
+
+      const JPH::MotionProperties* pMotion = pBody->GetMotionPropertiesUnchecked();
+      const nsUInt32 uiIsland = pMotion->GetIslandIndexInternal();
+
+      if (uiIsland < uiNumActive)
+        ++m_IslandSizes[uiIsland];
+      else
+        ++uiNumStaleIndices;
+
+      if (pMotion->GetMotionQuality() == JPH::EMotionQuality::LinearCast)
+        ++inout_statistics.m_uiNumCCDBodies;
+
+      // islands use the largest override of their bodies, 0 means the default
+      inout_statistics.m_uiNumVelocitySteps = nsMath::Max<nsUInt32>(inout_statistics.m_uiNumVelocitySteps, pMotion->GetNumVelocityStepsOverride());
+      inout_statistics.m_uiNumPositionSteps = nsMath::Max<nsUInt32>(inout_statistics.m_uiNumPositionSteps, pMotion->GetNumPositionStepsOverride());
+    }
+
+    for (nsUInt32 uiSize : m_IslandSizes)
+    {
+      if (uiSize == 0)
+        continue;
+
+      ++inout_statistics.m_uiNumIslands;
+      ++inout_statistics.m_IslandSizes[JPHStepStatisticsDetail::GetIslandBucket(uiSize)];
+      inout_statistics.m_uiLargestIsland = nsMath::Max(inout_statistics.m_uiLargestIsland, uiSize);
+    }
+
+    // a body that woke up during the step was not solved with the others, it counts as its own island
+    inout_statistics.m_uiNumIslands += uiNumStaleIndices;
+    inout_statistics.m_IslandSizes[0] += uiNumStaleIndices;
+
+    if (uiNumStaleIndices > 0)
+      inout_statistics.m_uiLargestIsland = nsMath::Max(inout_statistics.m_uiLargestIsland, 1u);
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHStepStatistics);
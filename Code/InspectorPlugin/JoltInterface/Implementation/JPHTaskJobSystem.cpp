@@ -0,0 +1,149 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHStepStatistics.h>
+#include <InspectorPlugin/JoltInterface/JPHTaskJobSystem.h>
+
+namespace JDebug::API
+{
+  /**
+   * @brief Executes one Jolt job. Returned to the pool of its job system when the task system reports it as finished.
+   */
+  class JPHTaskJobSystem::JobTask final : public nsTask
+  {
+  public:
+    Job* m_pJob = nullptr;
+    JPHStepMonitor* m_pStepMonitor = nullptr;
+
+  private:
+    virtual void Execute() override
+    {
+      JPHStepMonitor* pPreviousMonitor = JPHStepMonitor::SetThreadMonitor(m_pStepMonitor);
+
+      // does nothing if a thread waiting on the barrier executed the job already
+      m_pJob->Execute();
+      m_pJob->Release();
+      m_pJob = nullptr;
+
+      JPHStepMonitor::SetThreadMonitor(pPreviousMonitor);
+    }
+  };
+
+  JPHTaskJobSystem::JPHTaskJobSystem(JPH::uint in_uiMaxJobs, JPH::uint in_uiMaxBarriers, nsTaskPriority::Enum in_ePriority)
+  {
+    Init(in_uiMaxJobs, in_uiMaxBarriers, in_ePriority);
+  }
+
+  JPHTaskJobSystem::~JPHTaskJobSystem()
+  {
+    // the tasks reference jobs in m_Jobs, it must not go away before they are done
+    nsTaskSystem::WaitForCondition([this]()
+      { return m_iTasksInFlight == 0; });
+  }
+
+  void JPHTaskJobSystem::Init(JPH::uint in_uiMaxJobs, JPH::uint in_uiMaxBarriers, nsTaskPriority::Enum in_ePriority)
+  {
+    JobSystemWithBarrier::Init(in_uiMaxBarriers);
+
+    m_Jobs.Init(in_uiMaxJobs, in_uiMaxJobs);
+    m_ePriority = in_ePriority;
+  }
+
+  int JPHTaskJobSystem::GetMaxConcurrency() const
+  {
+    return static_cast<int>(nsTaskSystem::GetNumAllocatedWorkerThreads(nsWorkerThreadType::ShortTasks)) + 1;
+  }
+
+  JPH::JobHandle JPHTaskJobSystem::CreateJob(const char* in_szName, JPH::ColorArg in_color, const JobFunction& in_jobFunction, JPH::uint32 in_uiNumDependencies)
+  {
+    JPH::uint32 uiIndex = m_Jobs.ConstructObject(in_szName, in_color, this, in_jobFunction, in_uiNumDependencies);
+
+    NS_ASSERT_DEV(uiIndex != AvailableJobs::cInvalidObjectIndex, "JPHTaskJobSystem: all jobs are in use, increase the maximum number of jobs.");
+
+    while (uiIndex == AvailableJobs::cInvalidObjectIndex)
+    {
+      // wait for running jobs to free their slots
+      nsThreadUtils::YieldTimeSlice();
+      uiIndex = m_Jobs.ConstructObject(in_szName, in_color, this, in_jobFunction, in_uiNumDependencies);
+    }
+
+    Job* pJob = &m_Jobs.Get(uiIndex);
+
+    // the handle keeps a reference, the job is queued below and may complete right away
+    JobHandle handle(pJob);
+
+    if (in_uiNumDependencies == 0)
+    {
+      QueueJob(pJob);
+    }
+
+    return handle;
+  }
+
+  void JPHTaskJobSystem::WaitForJobs(Barrier* in_pBarrier)
+  {
+    // the waiting thread executes jobs of the barrier as well
+    JPHStepMonitor* pPreviousMonitor = JPHStepMonitor::SetThreadMonitor(m_pStepMonitor);
+    JobSystemWithBarrier::WaitForJobs(in_pBarrier);
+    JPHStepMonitor::SetThreadMonitor(pPreviousMonitor);
+  }
+
+  void JPHTaskJobSystem::QueueJob(Job* in_pJob)
+  {
+    StartJobTask(in_pJob);
+  }
+
+  void JPHTaskJobSystem::QueueJobs(Job** in_pJobs, JPH::uint in_uiNumJobs)
+  {
+    for (JPH::uint i = 0; i < in_uiNumJobs; ++i)
+    {
+      StartJobTask(in_pJobs[i]);
+    }
+  }
+
+  void JPHTaskJobSystem::FreeJob(Job* in_pJob)
+  {
+    m_Jobs.DestructObject(in_pJob);
+  }
+
+  void JPHTaskJobSystem::StartJobTask(Job* pJob)
+  {
+    // the task holds a reference until it ran, the job may be executed and released by a barrier in the meantime
+    pJob->AddRef();
+
+    nsSharedPtr<JobTask> pTask;
+
+    {
+      NS_LOCK(m_TaskPoolMutex);
+
+      if (!m_FreeTasks.IsEmpty())
+      {
+        pTask = m_FreeTasks.PeekBack();
+        m_FreeTasks.PopBack();
+      }
+    }
+
+    if (pTask == nullptr)
+    {
+      pTask = NS_DEFAULT_NEW(JobTask);
+      pTask->ConfigureTask("JoltJob", nsTaskNesting::Never, nsMakeDelegate(&JPHTaskJobSystem::OnJobTaskFinished, this));
+    }
+
+    pTask->m_pJob = pJob;
+    pTask->m_pStepMonitor = m_pStepMonitor;
+
+    m_iTasksInFlight.Increment();
+    nsTaskSystem::StartSingleTask(pTask, m_ePriority);
+  }
+
+  void JPHTaskJobSystem::OnJobTaskFinished(const nsSharedPtr<nsTask>& pTask)
+  {
+    {
+      NS_LOCK(m_TaskPoolMutex);
+      m_FreeTasks.PushBack(pTask.Downcast<JobTask>());
+    }
+
+    m_iTasksInFlight.Decrement();
+  }
+} // namespace JDebug::API
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Implementation_JPHTaskJobSystem);
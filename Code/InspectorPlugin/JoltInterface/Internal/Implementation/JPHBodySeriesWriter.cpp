@@ -0,0 +1,202 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/IO/ChunkStream.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHBodySeriesWriter.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/BodyID.h>
+
+namespace JDebug::API::IO
+{
+  JPHBodySeriesWriter::JPHBodySeriesWriter() = default;
+  JPHBodySeriesWriter::~JPHBodySeriesWriter() = default;
+
+  void JPHBodySeriesWriter::Reset()
+  {
+    m_Decoder.Reset();
+    m_Snapshot.SetSlotCount(0);
+    m_SlotBodyIDs.Clear();
+    m_Samples.Clear();
+    m_uiChunkFirstStep = 0;
+    m_uiChunkLastStep = 0;
+    m_uiNumChunkSteps = 0;
+    m_Index.Clear();
+  }
+
+  void JPHBodySeriesWriter::AddFrame(nsUInt64 in_uiStepIndex, nsArrayPtr<const nsUInt8> in_encodedFrame, bool in_bKeyframe)
+  {
+    NS_PROFILE_SCOPE("JPHBodySeriesWriter::AddFrame");
+
+    if (m_Decoder.DecodeFrame(in_encodedFrame, m_Snapshot, &m_DecodedSlots).Failed())
+      return;
+
+    if (m_uiNumChunkSteps == 0)
+    {
+      m_uiChunkFirstStep = in_uiStepIndex;
+    }
+
+    m_uiChunkLastStep = in_uiStepIndex;
+    ++m_uiNumChunkSteps;
+
+    const nsUInt32 uiStepOffset = static_cast<nsUInt32>(in_uiStepIndex - m_uiChunkFirstStep);
+    const nsUInt32 uiNumSlots = m_Snapshot.GetSlotCount();
+
+    // slots beyond the new slot count are gone, whatever they held was removed
+    for (nsUInt32 uiSlot = uiNumSlots; uiSlot < m_SlotBodyIDs.GetCount(); ++uiSlot)
+    {
+      if (m_SlotBodyIDs[uiSlot] != JPH::BodyID::cInvalidBodyID)
+        AddRemovedSample(m_SlotBodyIDs[uiSlot], uiStepOffset);
+    }
+
+    m_SlotBodyIDs.SetCount(uiNumSlots, JPH::BodyID::cInvalidBodyID);
+
+    if (in_bKeyframe)
+    {
+      // a keyframe contains all bodies, a slot that is not in it is free
+      for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+      {
+        AddSample(uiSlot, uiStepOffset);
+      }
+    }
+    else
+    {
+      for (nsUInt32 uiSlot : m_DecodedSlots)
+      {
+        AddSample(uiSlot, uiStepOffset);
+      }
+    }
+  }
+
+  void JPHBodySeriesWriter::AddSample(nsUInt32 uiSlot, nsUInt32 uiStepOffset)
+  {
+    const bool bValid = m_Snapshot.IsValid(uiSlot);
+    const nsUInt32 uiBodyID = bValid ? m_Snapshot.m_BodyIDs[uiSlot] : JPH::BodyID::cInvalidBodyID;
+
+    // the slot was reused or freed, the body that was in it before ends here
+    if (m_SlotBodyIDs[uiSlot] != uiBodyID && m_SlotBodyIDs[uiSlot] != JPH::BodyID::cInvalidBodyID)
+    {
+      AddRemovedSample(m_SlotBodyIDs[uiSlot], uiStepOffset);
+    }
+
+    m_SlotBodyIDs[uiSlot] = uiBodyID;
+
+    if (!bValid)
+      return;
+
+    Sample& sample = m_Samples.ExpandAndGetRef();
+    sample.m_uiBodyID = uiBodyID;
+    sample.m_uiStepOffset = uiStepOffset;
+    sample.m_vPosition = m_Snapshot.m_Positions[uiSlot];
+    sample.m_uiRotation = PackQuatSmallestThree(m_Snapshot.m_Rotations[uiSlot]);
+    sample.m_vLinearVelocity = m_Snapshot.m_LinearVelocities[uiSlot];
+    sample.m_vAngularVelocity = m_Snapshot.m_AngularVelocities[uiSlot];
+    sample.m_uiState = m_Snapshot.m_States[uiSlot];
+  }
+
+  void JPHBodySeriesWriter::AddRemovedSample(nsUInt32 uiBodyID, nsUInt32 uiStepOffset)
+  {
+    Sample& sample = m_Samples.ExpandAndGetRef();
+    sample.m_uiBodyID = uiBodyID;
+    sample.m_uiStepOffset = uiStepOffset;
+    sample.m_vPosition.SetZero();
+    sample.m_uiRotation = PackQuatSmallestThree(nsQuat::MakeIdentity());
+    sample.m_vLinearVelocity.SetZero();
+    sample.m_vAngularVelocity.SetZero();
+    sample.m_uiState = 0;
+  }
+
+  void JPHBodySeriesWriter::WriteChunk(nsChunkStreamWriter& inout_chunkWriter, nsUInt64 in_uiChunkOffset)
+  {
+    NS_PROFILE_SCOPE("JPHBodySeriesWriter::WriteChunk");
+
+    static_assert(PVDFormat::s_uiBodyIndexMask == JPH::BodyID::cMaxBodyIndex);
+
+    const nsUInt32 uiNumSamples = m_Samples.GetCount();
+
+    nsUInt32 uiFirstIndex = PVDFormat::s_uiBodyIndexMask;
+    nsUInt32 uiLastIndex = 0;
+    for (const Sample& sample : m_Samples)
+    {
+      uiFirstIndex = nsMath::Min(uiFirstIndex, sample.m_uiBodyID & PVDFormat::s_uiBodyIndexMask);
+      uiLastIndex = nsMath::Max(uiLastIndex, sample.m_uiBodyID & PVDFormat::s_uiBodyIndexMask);
+    }
+
+    const nsUInt32 uiNumIndices = uiNumSamples > 0 ? uiLastIndex - uiFirstIndex + 1 : 0;
+
+    // counting sort by body index, the samples of each index stay in step order
+    m_Directory.Clear();
+    m_Directory.SetCount(uiNumIndices + 1, 0);
+
+    for (const Sample& sample : m_Samples)
+    {
+      ++m_Directory[(sample.m_uiBodyID & PVDFormat::s_uiBodyIndexMask) - uiFirstIndex + 1];
+    }
+
+    for (nsUInt32 i = 1; i <= uiNumIndices; ++i)
+    {
+      m_Directory[i] += m_Directory[i - 1];
+    }
+
+    m_SampleOrder.SetCountUninitialized(uiNumSamples);
+    for (nsUInt32 i = 0; i < uiNumSamples; ++i)
+    {
+      m_SampleOrder[m_Directory[(m_Samples[i].m_uiBodyID & PVDFormat::s_uiBodyIndexMask) - uiFirstIndex]++] = i;
+    }
+
+    // the scatter moved every entry to the start of the next index, shift them back
+    for (nsUInt32 i = uiNumIndices; i > 0; --i)
+    {
+      m_Directory[i] = m_Directory[i - 1];
+    }
+
+    m_Directory[0] = 0;
+
+    NS_ASSERT_DEBUG(nsStringUtils::GetStringElementCount(PVDFormat::s_szBodySeriesChunk) + 20 == s_uiChunkPrefixSize, "s_uiChunkPrefixSize does not match the chunk name.");
+
+    inout_chunkWriter.BeginChunk(PVDFormat::s_szBodySeriesChunk, PVDFormat::s_uiBodySeriesChunkVersion);
+
+    m_WriteBuffer.Clear();
+    JPHByteWriter writer(m_WriteBuffer);
+
+    writer.Write(m_uiChunkFirstStep);
+    writer.Write(m_uiChunkLastStep);
+    writer.Write(uiFirstIndex);
+    writer.Write(uiNumIndices);
+    writer.Write(uiNumSamples);
+    writer.WriteBytes(m_Directory.GetData(), m_Directory.GetCount() * sizeof(nsUInt32));
+
+    for (nsUInt32 uiSample : m_SampleOrder)
+    {
+      const Sample& sample = m_Samples[uiSample];
+      writer.Write(sample.m_uiBodyID);
+      writer.Write(sample.m_uiStepOffset);
+      writer.Write(sample.m_vPosition);
+      writer.Write(sample.m_uiRotation);
+      writer.Write(sample.m_vLinearVelocity);
+      writer.Write(sample.m_vAngularVelocity);
+      writer.Write(sample.m_uiState);
+
+      if (m_WriteBuffer.GetCount() >= 64 * 1024)
+      {
+        inout_chunkWriter.WriteBytes(m_WriteBuffer.GetData(), m_WriteBuffer.GetCount()).IgnoreResult();
+        m_WriteBuffer.Clear();
+      }
+    }
+
+    inout_chunkWriter.WriteBytes(m_WriteBuffer.GetData(), m_WriteBuffer.GetCount()).IgnoreResult();
+    inout_chunkWriter.EndChunk();
+
+    JPHPVDSeriesIndexEntry& entry = m_Index.ExpandAndGetRef();
+    entry.m_uiFirstStepIndex = m_uiChunkFirstStep;
+    entry.m_uiLastStepIndex = m_uiChunkLastStep;
+    entry.m_uiChunkOffset = in_uiChunkOffset;
+    entry.m_uiFirstBodyIndex = uiFirstIndex;
+    entry.m_uiNumBodyIndices = uiNumIndices;
+
+    m_Samples.Clear();
+    m_uiNumChunkSteps = 0;
+  }
+} // namespace JDebug::API::IO
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Internal_Implementation_JPHBodySeriesWriter);
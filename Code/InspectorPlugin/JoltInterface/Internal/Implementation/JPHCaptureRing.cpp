@@ -0,0 +1,103 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHCaptureRing.h>
+
+namespace JDebug::API::IO
+{
+  void JPHCaptureFrame::Swap(JPHCaptureFrame& other)
+  {
+    m_Data.Swap(other.m_Data);
+    m_Records.Swap(other.m_Records);
+    nsMath::Swap(m_uiStepIndex, other.m_uiStepIndex);
+    nsMath::Swap(m_uiSequence, other.m_uiSequence);
+    nsMath::Swap(m_EnqueueTime, other.m_EnqueueTime);
+    nsMath::Swap(m_bKeyframe, other.m_bKeyframe);
+  }
+
+  JPHCaptureRing::JPHCaptureRing(nsUInt32 in_uiCapacity)
+  {
+    const nsUInt32 uiCapacity = nsMath::PowerOfTwo_Ceil(nsMath::Max(in_uiCapacity, 2u));
+    m_uiMask = uiCapacity - 1;
+
+    m_Cells.SetCount(uiCapacity);
+    for (nsUInt32 i = 0; i < uiCapacity; ++i)
+    {
+      m_Cells[i].m_iSequence = i;
+    }
+  }
+
+  JPHCaptureRing::~JPHCaptureRing() = default;
+
+  bool JPHCaptureRing::TryPush(JPHCaptureFrame& inout_frame)
+  {
+    nsInt64 iPosition = m_iPushPosition;
+
+    while (true)
+    {
+      Cell& cell = m_Cells[static_cast<nsUInt32>(iPosition) & m_uiMask];
+      const nsInt64 iDifference = cell.m_iSequence - iPosition;
+
+      if (iDifference == 0)
+      {
+        // the cell is free, try to claim it
+        if (m_iPushPosition.TestAndSet(iPosition, iPosition + 1))
+        {
+          cell.m_Frame.Swap(inout_frame);
+          cell.m_iSequence = iPosition + 1;
+          return true;
+        }
+
+        iPosition = m_iPushPosition;
+      }
+      else if (iDifference < 0)
+      {
+        // the cell still holds a frame from the previous round, the ring is full
+        return false;
+      }
+      else
+      {
+        iPosition = m_iPushPosition;
+      }
+    }
+  }
+
+  bool JPHCaptureRing::TryPop(JPHCaptureFrame& inout_frame)
+  {
+    nsInt64 iPosition = m_iPopPosition;
+
+    while (true)
+    {
+      Cell& cell = m_Cells[static_cast<nsUInt32>(iPosition) & m_uiMask];
+      const nsInt64 iDifference = cell.m_iSequence - (iPosition + 1);
+
+      if (iDifference == 0)
+      {
+        if (m_iPopPosition.TestAndSet(iPosition, iPosition + 1))
+        {
+          cell.m_Frame.Swap(inout_frame);
+          cell.m_iSequence = iPosition + GetCapacity();
+          return true;
+        }
+
+        iPosition = m_iPopPosition;
+      }
+      else if (iDifference < 0)
+      {
+        // nothing has been written into the cell yet, the ring is empty
+        return false;
+      }
+      else
+      {
+        iPosition = m_iPopPosition;
+      }
+    }
+  }
+
+  nsUInt32 JPHCaptureRing::GetCount() const
+  {
+    const nsInt64 iCount = static_cast<nsInt64>(m_iPushPosition) - static_cast<nsInt64>(m_iPopPosition);
+    return static_cast<nsUInt32>(nsMath::Clamp<nsInt64>(iCount, 0, GetCapacity()));
+  }
+} // namespace JDebug::API::IO
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Internal_Implementation_JPHCaptureRing);
@@ -0,0 +1,518 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/IO/CompressedStreamZstd.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHBodySeriesWriter.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileManager.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHConstraintStatistics.h>
+#include <InspectorPlugin/JoltInterface/JPHSoftBodyEncoder.h>
+#include <Jolt/Physics/Body/Body.h>
+#include <Jolt/Physics/Character/Character.h>
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+#include <Jolt/Physics/Constraints/Constraint.h>
+
+namespace JPHPVDFileManagerDetail
+{
+  static void WriteVec3(JDebug::API::IO::JPHByteWriter& writer, JPH::Vec3Arg v)
+  {
+    writer.Write(nsVec3(v.GetX(), v.GetY(), v.GetZ()));
+  }
+
+  static void WriteRVec3(JDebug::API::IO::JPHByteWriter& writer, JPH::RVec3Arg v)
+  {
+    writer.Write(nsVec3(static_cast<float>(v.GetX()), static_cast<float>(v.GetY()), static_cast<float>(v.GetZ())));
+  }
+
+  static void WriteQuat(JDebug::API::IO::JPHByteWriter& writer, JPH::QuatArg q)
+  {
+    writer.Write(nsQuat(q.GetX(), q.GetY(), q.GetZ(), q.GetW()));
+  }
+} // namespace JPHPVDFileManagerDetail
+
+namespace JDebug::API::IO
+{
+  JPHPVDFileStreamWriter::JPHPVDFileStreamWriter(nsOSFile& ref_file)
+    : m_File(ref_file)
+  {
+  }
+
+  nsResult JPHPVDFileStreamWriter::WriteBytes(const void* pWriteBuffer, nsUInt64 uiBytesToWrite)
+  {
+    m_uiOffset += uiBytesToWrite;
+    return m_File.Write(pWriteBuffer, uiBytesToWrite);
+  }
+
+  JPHPVDFileManager::JPHPVDFileManager() = default;
+
+  JPHPVDFileManager::JPHPVDFileManager(nsOSFile& inout_file)
+  {
+    Open(inout_file);
+  }
+
+  JPHPVDFileManager::~JPHPVDFileManager()
+  {
+    Close();
+  }
+
+  void JPHPVDFileManager::Open(nsOSFile& inout_file)
+  {
+    Close();
+
+    m_pFileWriter = NS_DEFAULT_NEW(JPHPVDFileStreamWriter, inout_file);
+    m_pChunkWriter = NS_DEFAULT_NEW(nsChunkStreamWriter, *m_pFileWriter);
+
+    m_pChunkWriter->BeginStream(PVDFormat::s_uiStreamVersion);
+
+    if (m_bBodySeriesEnabled)
+    {
+      if (m_pBodySeries == nullptr)
+      {
+        m_pBodySeries = NS_DEFAULT_NEW(JPHBodySeriesWriter);
+      }
+
+      m_pBodySeries->Reset();
+    }
+    else
+    {
+      m_pBodySeries.Clear();
+    }
+
+    m_pChunkWriter->BeginChunk(PVDFormat::s_szCaptureChunk, PVDFormat::s_uiCaptureChunkVersion);
+    {
+      const nsUInt8 uiJoltVersion[3] = {JPH_VERSION_MAJOR, JPH_VERSION_MINOR, JPH_VERSION_PATCH};
+      m_pChunkWriter->WriteBytes(uiJoltVersion, sizeof(uiJoltVersion)).IgnoreResult();
+
+#ifdef JPH_DOUBLE_PRECISION
+      const nsUInt8 uiDoublePrecision = 1;
+#else
+      const nsUInt8 uiDoublePrecision = 0;
+#endif
+      *m_pChunkWriter << uiDoublePrecision;
+    }
+    m_pChunkWriter->EndChunk();
+  }
+
+  void JPHPVDFileManager::Close()
+  {
+    if (!IsOpen())
+      return;
+
+    if (m_bFrameOpen)
+    {
+      EndFrame();
+    }
+
+    // entries may have been added after the last frame, the index references all dictionary chunks so write them anyway
+    WriteDictionaryChunk();
+
+    if (m_pBodySeries != nullptr && m_pBodySeries->HasPendingSamples())
+    {
+      WriteBodySeriesChunk();
+    }
+
+    JPHPVDFileFooter footer;
+    footer.m_uiIndexChunkOffset = m_pFileWriter->GetOffset();
+
+    WriteIndexChunk();
+    m_pChunkWriter->EndStream();
+
+    m_pFileWriter->WriteBytes(&footer, sizeof(footer)).IgnoreResult();
+    m_pFileWriter->Flush().IgnoreResult();
+
+    m_pChunkWriter.Clear();
+    m_pFileWriter.Clear();
+
+    m_FrameIndex.Clear();
+    m_DictionaryChunkOffsets.Clear();
+    m_StringIDs.Clear();
+    m_ShapeIDs.Clear();
+    m_PendingDictionary.Clear();
+    m_uiNumPendingEntries = 0;
+    m_uiNextDictionaryID = 0;
+    m_uiLastKeyframeIndex = 0;
+
+    if (m_pSoftBodyEncoder != nullptr)
+    {
+      m_pSoftBodyEncoder->Reset();
+    }
+
+    if (m_pBodySeries != nullptr)
+    {
+      m_pBodySeries->Reset();
+    }
+  }
+
+  void JPHPVDFileManager::BeginFrame(nsUInt64 in_uiStepIndex, bool in_bKeyframe)
+  {
+    NS_ASSERT_DEV(IsOpen(), "No capture file has been opened.");
+    NS_ASSERT_DEV(!m_bFrameOpen, "EndFrame() has not been called for the previous frame.");
+    NS_ASSERT_DEV(m_FrameIndex.IsEmpty() || m_FrameIndex.PeekBack().m_uiStepIndex < in_uiStepIndex, "Step indices must be increasing.");
+
+    m_bFrameOpen = true;
+    m_FrameData.Clear();
+
+    m_CurrentFrame = {};
+    m_CurrentFrame.m_uiStepIndex = in_uiStepIndex;
+    m_CurrentFrame.m_uiFlags = in_bKeyframe ? PVDFrame_Keyframe : 0;
+
+    if (in_bKeyframe && m_pSoftBodyEncoder != nullptr)
+    {
+      // playback may start here, so the soft bodies have to be complete as well
+      m_pSoftBodyEncoder->RequestKeyframe();
+    }
+  }
+
+  void JPHPVDFileManager::EndFrame()
+  {
+    NS_ASSERT_DEV(m_bFrameOpen, "BeginFrame() has not been called.");
+
+    // soft bodies that were written before and are missing now were removed, the record tells the reader so
+    if (m_pSoftBodyEncoder != nullptr && (m_bSoftBodyFrameOpen || m_pSoftBodyEncoder->GetNumBodies() > 0))
+    {
+      if (!m_bSoftBodyFrameOpen)
+      {
+        m_pSoftBodyEncoder->BeginFrame(m_CurrentFrame.m_uiStepIndex, m_SoftBodyData);
+      }
+
+      m_bSoftBodyFrameOpen = false;
+      m_pSoftBodyEncoder->EndFrame();
+
+      BeginRecord(JPHPVDRecordType::SoftBodies);
+      m_RecordData.PushBackRange(m_SoftBodyData);
+      EndRecord();
+    }
+
+    m_bFrameOpen = false;
+
+    // the frame may reference dictionary entries that were added while it was collected, those have to be in the file first
+    WriteDictionaryChunk();
+    WriteFrameChunk();
+
+    if (m_pBodySeries != nullptr && m_pBodySeries->IsChunkFull())
+    {
+      WriteBodySeriesChunk();
+    }
+  }
+
+  void JPHPVDFileManager::WriteEncodedFrame(nsArrayPtr<const nsUInt8> in_data)
+  {
+    BeginRecord(JPHPVDRecordType::EncodedFrame);
+    JPHByteWriter(m_RecordData).WriteBytes(in_data.GetPtr(), in_data.GetCount());
+    EndRecord();
+
+    if (m_pBodySeries != nullptr)
+    {
+      m_pBodySeries->AddFrame(m_CurrentFrame.m_uiStepIndex, in_data, (m_CurrentFrame.m_uiFlags & PVDFrame_Keyframe) != 0);
+    }
+  }
+
+  void JPHPVDFileManager::WriteRecords(nsArrayPtr<const nsUInt8> in_records)
+  {
+    NS_ASSERT_DEV(m_bFrameOpen, "Records can only be written between BeginFrame() and EndFrame().");
+
+    m_FrameData.PushBackRange(in_records);
+
+    // the seek table tells the replay which frames it can start from, without decompressing them
+    JPHByteReader reader(in_records);
+    while (!reader.IsAtEnd())
+    {
+      JPHPVDRecordType eType = JPHPVDRecordType::EncodedFrame;
+      nsUInt64 uiSize = 0;
+      reader.Read(eType);
+      reader.ReadVarUInt(uiSize);
+
+      if (reader.HasFailed() || !reader.Skip(static_cast<nsUInt32>(uiSize)))
+        break;
+
+      if (eType == JPHPVDRecordType::PhysicsState)
+        m_CurrentFrame.m_uiFlags |= PVDFrame_PhysicsState;
+      else if (eType == JPHPVDRecordType::PhysicsScene)
+        m_CurrentFrame.m_uiFlags |= PVDFrame_PhysicsScene;
+    }
+  }
+
+  void JPHPVDFileManager::AppendRecord(nsDynamicArray<nsUInt8>& inout_records, JPHPVDRecordType in_type, nsArrayPtr<const nsUInt8> in_data)
+  {
+    JPHByteWriter writer(inout_records);
+    writer.Write(in_type);
+    writer.WriteVarUInt(in_data.GetCount());
+    writer.WriteBytes(in_data.GetPtr(), in_data.GetCount());
+  }
+
+  void JPHPVDFileManager::WriteBodyData(const JPH::Body& in_data)
+  {
+    using namespace JPHPVDFileManagerDetail;
+    using StateFlags = JPHBodySnapshot::JPHBodyStateFlags;
+
+    nsUInt8 uiState = StateFlags::Valid;
+    uiState |= in_data.IsActive() ? StateFlags::Active : 0;
+    uiState |= in_data.IsSensor() ? StateFlags::Sensor : 0;
+    uiState |= in_data.IsSoftBody() ? StateFlags::SoftBody : 0;
+
+    BeginRecord(JPHPVDRecordType::Body);
+
+    JPHByteWriter writer(m_RecordData);
+    writer.Write<nsUInt32>(in_data.GetID().GetIndexAndSequenceNumber());
+    writer.Write<nsUInt32>(GetShapeID(in_data.GetShape()));
+    writer.Write<nsUInt8>(static_cast<nsUInt8>(in_data.GetMotionType()));
+    writer.Write<nsUInt8>(uiState);
+    writer.WriteVarUInt(static_cast<nsUInt64>(in_data.GetObjectLayer()));
+    WriteRVec3(writer, in_data.GetPosition());
+    WriteQuat(writer, in_data.GetRotation());
+    WriteVec3(writer, in_data.GetLinearVelocity());
+    WriteVec3(writer, in_data.GetAngularVelocity());
+    writer.Write<float>(in_data.GetFriction());
+    writer.Write<float>(in_data.GetRestitution());
+    writer.Write<nsUInt64>(in_data.GetUserData());
+
+    EndRecord();
+  }
+
+  void JPHPVDFileManager::WriteCharacterData(const JPH::Character& in_data)
+  {
+    using namespace JPHPVDFileManagerDetail;
+
+    JPH::RVec3 vPosition;
+    JPH::Quat qRotation;
+    in_data.GetPositionAndRotation(vPosition, qRotation);
+
+    BeginRecord(JPHPVDRecordType::Character);
+
+    JPHByteWriter writer(m_RecordData);
+    writer.Write<nsUInt32>(in_data.GetBodyID().GetIndexAndSequenceNumber());
+    writer.Write<nsUInt32>(GetShapeID(in_data.GetShape()));
+    WriteRVec3(writer, vPosition);
+    WriteQuat(writer, qRotation);
+    WriteVec3(writer, in_data.GetLinearVelocity());
+    writer.Write<nsUInt8>(static_cast<nsUInt8>(in_data.GetGroundState()));
+    writer.Write<nsUInt32>(in_data.GetGroundBodyID().GetIndexAndSequenceNumber());
+    WriteVec3(writer, in_data.GetGroundNormal());
+
+    EndRecord();
+  }
+
+  void JPHPVDFileManager::WriteConstraintData(const JPH::Constraint& in_data)
+  {
+    JPHConstraintDiagnostics diagnostics;
+    JPHConstraintMonitor::Measure(in_data, nullptr, diagnostics);
+
+    nsUInt8 uiFlags = 0;
+    uiFlags |= in_data.GetEnabled() ? 1 : 0;
+    uiFlags |= in_data.IsActive() ? 2 : 0;
+
+    BeginRecord(JPHPVDRecordType::Constraint);
+
+    JPHByteWriter writer(m_RecordData);
+    writer.Write<nsUInt8>(static_cast<nsUInt8>(in_data.GetType()));
+    writer.Write<nsUInt8>(diagnostics.m_uiSubType);
+    writer.Write<nsUInt8>(uiFlags);
+    writer.Write<nsUInt32>(diagnostics.m_uiBodyIDs[0]);
+    writer.Write<nsUInt32>(diagnostics.m_uiBodyIDs[1]);
+    writer.Write<nsUInt64>(diagnostics.m_uiUserData);
+    writer.Write<float>(diagnostics.m_fLinearImpulse);
+    writer.Write<float>(diagnostics.m_fAngularImpulse);
+    writer.Write<float>(diagnostics.m_fPositionError);
+    writer.WriteVarUInt(diagnostics.m_uiNumVelocitySteps);
+    writer.WriteVarUInt(diagnostics.m_uiNumPositionSteps);
+
+    EndRecord();
+  }
+
+  void JPHPVDFileManager::WriteSoftBodyShapeData(const JPH::Body& in_data)
+  {
+    NS_ASSERT_DEV(m_bFrameOpen, "Records can only be written between BeginFrame() and EndFrame().");
+
+    if (m_pSoftBodyEncoder == nullptr)
+    {
+      m_pSoftBodyEncoder = NS_DEFAULT_NEW(JPHSoftBodyEncoder);
+    }
+
+    if (!m_bSoftBodyFrameOpen)
+    {
+      m_bSoftBodyFrameOpen = true;
+      m_pSoftBodyEncoder->BeginFrame(m_CurrentFrame.m_uiStepIndex, m_SoftBodyData);
+    }
+
+    m_pSoftBodyEncoder->EncodeBody(in_data);
+  }
+
+  nsUInt32 JPHPVDFileManager::GetStringID(nsStringView in_sString)
+  {
+    nsUInt32 uiID = 0;
+    if (m_StringIDs.TryGetValue(in_sString, uiID))
+      return uiID;
+
+    uiID = m_uiNextDictionaryID++;
+    m_StringIDs.Insert(in_sString, uiID);
+
+    JPHByteWriter writer(m_PendingDictionary);
+    writer.Write(JPHPVDDictionaryEntryType::String);
+    writer.Write(uiID);
+    writer.Write(in_sString.GetElementCount());
+    writer.WriteBytes(in_sString.GetStartPointer(), in_sString.GetElementCount());
+    ++m_uiNumPendingEntries;
+
+    return uiID;
+  }
+
+  nsUInt32 JPHPVDFileManager::GetShapeID(const JPH::Shape* in_pShape)
+  {
+    using namespace JPHPVDFileManagerDetail;
+
+    if (in_pShape == nullptr)
+      return PVDFormat::s_uiInvalidDictionaryID;
+
+    nsUInt32 uiID = 0;
+    if (m_ShapeIDs.TryGetValue(in_pShape, uiID))
+      return uiID;
+
+    uiID = m_uiNextDictionaryID++;
+    m_ShapeIDs.Insert(in_pShape, uiID);
+
+    const JPH::AABox bounds = in_pShape->GetLocalBounds();
+
+    JPHByteWriter writer(m_PendingDictionary);
+    writer.Write(JPHPVDDictionaryEntryType::Shape);
+    writer.Write(uiID);
+    writer.Write<nsUInt8>(static_cast<nsUInt8>(in_pShape->GetType()));
+    writer.Write<nsUInt8>(static_cast<nsUInt8>(in_pShape->GetSubType()));
+    WriteVec3(writer, bounds.mMin);
+    WriteVec3(writer, bounds.mMax);
+    WriteVec3(writer, in_pShape->GetCenterOfMass());
+    writer.Write<nsUInt64>(in_pShape->GetUserData());
+    ++m_uiNumPendingEntries;
+
+    return uiID;
+  }
+
+  void JPHPVDFileManager::WriteShapeGeometry(nsUInt32 in_uiShapeID, nsArrayPtr<const nsUInt8> in_data)
+  {
+    JPHByteWriter writer(m_PendingDictionary);
+    writer.Write(JPHPVDDictionaryEntryType::ShapeGeometry);
+    writer.Write(in_uiShapeID);
+    writer.Write(in_data.GetCount());
+    writer.WriteBytes(in_data.GetPtr(), in_data.GetCount());
+    ++m_uiNumPendingEntries;
+  }
+
+  void JPHPVDFileManager::BeginRecord(JPHPVDRecordType type)
+  {
+    NS_ASSERT_DEV(m_bFrameOpen, "Records can only be written between BeginFrame() and EndFrame().");
+
+    m_eRecordType = type;
+    m_RecordData.Clear();
+  }
+
+  void JPHPVDFileManager::EndRecord()
+  {
+    AppendRecord(m_FrameData, m_eRecordType, m_RecordData);
+  }
+
+  void JPHPVDFileManager::WriteDictionaryChunk()
+  {
+    if (m_uiNumPendingEntries == 0)
+      return;
+
+    m_DictionaryChunkOffsets.PushBack(m_pFileWriter->GetOffset());
+
+    m_pChunkWriter->BeginChunk(PVDFormat::s_szDictionaryChunk, PVDFormat::s_uiDictionaryChunkVersion);
+    *m_pChunkWriter << m_uiNumPendingEntries;
+    m_pChunkWriter->WriteBytes(m_PendingDictionary.GetData(), m_PendingDictionary.GetCount()).IgnoreResult();
+    m_pChunkWriter->EndChunk();
+
+    m_PendingDictionary.Clear();
+    m_uiNumPendingEntries = 0;
+  }
+
+  void JPHPVDFileManager::WriteFrameChunk()
+  {
+    NS_PROFILE_SCOPE("JPHPVDFileManager::WriteFrameChunk");
+
+    JPHPVDCompression eCompression = JPHPVDCompression::None;
+    nsArrayPtr<const nsUInt8> payload = m_FrameData;
+
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+    {
+      m_CompressedData.Clear();
+      nsMemoryStreamContainerWrapperStorage<nsDynamicArray<nsUInt8>> storage(&m_CompressedData);
+      nsMemoryStreamWriter memoryWriter(&storage);
+
+      if (m_pCompressor == nullptr)
+      {
+        m_pCompressor = NS_DEFAULT_NEW(nsCompressedStreamWriterZstd);
+      }
+
+      // frames are compressed on the capture writer thread (see JPHCaptureWriter), a single zstd thread keeps up with it
+      // and zstd worker threads would only compete with the task system
+      m_pCompressor->SetOutputStream(&memoryWriter, 0, nsCompressedStreamWriterZstd::Compression::Default, 32);
+      m_pCompressor->WriteBytes(m_FrameData.GetData(), m_FrameData.GetCount()).IgnoreResult();
+      m_pCompressor->FinishCompressedStream().IgnoreResult();
+
+      eCompression = JPHPVDCompression::Zstd;
+      payload = m_CompressedData;
+    }
+#endif
+
+    const nsUInt32 uiFrameIndex = m_FrameIndex.GetCount();
+    if ((m_CurrentFrame.m_uiFlags & PVDFrame_Keyframe) != 0)
+    {
+      m_uiLastKeyframeIndex = uiFrameIndex;
+    }
+
+    m_CurrentFrame.m_uiChunkOffset = m_pFileWriter->GetOffset();
+    m_CurrentFrame.m_uiKeyframeIndex = m_uiLastKeyframeIndex;
+    m_FrameIndex.PushBack(m_CurrentFrame);
+
+    m_pChunkWriter->BeginChunk(PVDFormat::s_szFrameChunk, PVDFormat::s_uiFrameChunkVersion);
+    *m_pChunkWriter << m_CurrentFrame.m_uiStepIndex;
+    *m_pChunkWriter << m_CurrentFrame.m_uiFlags;
+    *m_pChunkWriter << static_cast<nsUInt8>(eCompression);
+    *m_pChunkWriter << m_FrameData.GetCount();
+    m_pChunkWriter->WriteBytes(payload.GetPtr(), payload.GetCount()).IgnoreResult();
+    m_pChunkWriter->EndChunk();
+  }
+
+  void JPHPVDFileManager::WriteBodySeriesChunk()
+  {
+    m_pBodySeries->WriteChunk(*m_pChunkWriter, m_pFileWriter->GetOffset());
+  }
+
+  void JPHPVDFileManager::WriteIndexChunk()
+  {
+    m_pChunkWriter->BeginChunk(PVDFormat::s_szIndexChunk, PVDFormat::s_uiIndexChunkVersion);
+
+    *m_pChunkWriter << m_FrameIndex.GetCount();
+    for (const JPHPVDFrameIndexEntry& entry : m_FrameIndex)
+    {
+      *m_pChunkWriter << entry.m_uiStepIndex;
+      *m_pChunkWriter << entry.m_uiChunkOffset;
+      *m_pChunkWriter << entry.m_uiKeyframeIndex;
+      *m_pChunkWriter << entry.m_uiFlags;
+    }
+
+    *m_pChunkWriter << m_DictionaryChunkOffsets.GetCount();
+    for (nsUInt64 uiOffset : m_DictionaryChunkOffsets)
+    {
+      *m_pChunkWriter << uiOffset;
+    }
+
+    const nsUInt32 uiNumSeriesChunks = m_pBodySeries != nullptr ? m_pBodySeries->GetIndex().GetCount() : 0;
+    *m_pChunkWriter << uiNumSeriesChunks;
+
+    for (nsUInt32 i = 0; i < uiNumSeriesChunks; ++i)
+    {
+      const JPHPVDSeriesIndexEntry& entry = m_pBodySeries->GetIndex()[i];
+      *m_pChunkWriter << entry.m_uiFirstStepIndex;
+      *m_pChunkWriter << entry.m_uiLastStepIndex;
+      *m_pChunkWriter << entry.m_uiChunkOffset;
+      *m_pChunkWriter << entry.m_uiFirstBodyIndex;
+      *m_pChunkWriter << entry.m_uiNumBodyIndices;
+    }
+
+    m_pChunkWriter->EndChunk();
+  }
+} // namespace JDebug::API::IO
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Internal_Implementation_JPHPVDFileManager);
@@ -0,0 +1,635 @@
+#include <InspectorPlugin/InspectorPluginPCH.h>
+
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Types/ScopeExit.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHBodySeriesWriter.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileReader.h>
+
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+#  include <zstd/zstd.h>
+#endif
+
+namespace JPHPVDFileReaderDetail
+{
+  /// "BGNCHNK2" followed by the u16 stream version, the first chunk starts right after it.
+  static constexpr nsUInt64 s_uiStreamHeaderSize = 10;
+
+  /// u64 step, u8 flags, u8 compression, u32 uncompressed size
+  static constexpr nsUInt32 s_uiFrameHeaderSize = 14;
+
+  /// Smallest step in which DecompressPayload() grows its output.
+  static constexpr nsUInt32 s_uiMinDecompressGrowth = 64 * 1024;
+
+  /// Everything the tasks of JPHPVDFileReader::ReadBodySeries() need, so the lambda only captures a single reference.
+  struct SeriesQuery
+  {
+    const JDebug::API::IO::JPHPVDFileReader* m_pReader = nullptr;
+    nsDynamicArray<JDebug::API::IO::JPHPVDBodySample>* m_pChunkSamples = nullptr;
+    nsUInt32 m_uiFirstChunk = 0;
+    nsUInt32 m_uiBodyID = 0;
+    nsUInt64 m_uiFirstStep = 0;
+    nsUInt64 m_uiLastStep = 0;
+    nsAtomicBool m_bFailed;
+  };
+} // namespace JPHPVDFileReaderDetail
+
+namespace JDebug::API::IO
+{
+  JPHPVDFileReader::JPHPVDFileReader() = default;
+  JPHPVDFileReader::~JPHPVDFileReader() = default;
+
+  nsResult JPHPVDFileReader::Open(nsStringView in_sAbsolutePath)
+  {
+    Close();
+
+#if NS_ENABLED(NS_SUPPORTS_MEMORY_MAPPED_FILE)
+    if (m_File.Open(in_sAbsolutePath, nsMemoryMappedFile::Mode::ReadOnly).Failed())
+    {
+      nsLog::Error("Failed to map capture file '{}'.", in_sAbsolutePath);
+      return NS_FAILURE;
+    }
+
+    m_pData = static_cast<const nsUInt8*>(m_File.GetReadPointer());
+    m_uiFileSize = m_File.GetFileSize();
+
+    JPHPVDFileFooter footer;
+    if (m_uiFileSize < JPHPVDFileReaderDetail::s_uiStreamHeaderSize + sizeof(footer))
+    {
+      nsLog::Error("'{}' is not a capture file.", in_sAbsolutePath);
+      Close();
+      return NS_FAILURE;
+    }
+
+    nsMemoryUtils::RawByteCopy(&footer, m_pData + m_uiFileSize - sizeof(footer), sizeof(footer));
+
+    if (nsMemoryUtils::Compare(m_pData, reinterpret_cast<const nsUInt8*>("BGNCHNK2"), 8) != 0 || footer.m_uiMagic != PVDFormat::s_uiFooterMagic)
+    {
+      nsLog::Error("'{}' is not a capture file or the capture was not closed properly.", in_sAbsolutePath);
+      Close();
+      return NS_FAILURE;
+    }
+
+    nsDynamicArray<nsUInt64> dictionaryOffsets;
+
+    if (ReadCaptureChunk().Failed() || ReadIndexChunk(footer.m_uiIndexChunkOffset, dictionaryOffsets).Failed())
+    {
+      nsLog::Error("The capture file '{}' is corrupt.", in_sAbsolutePath);
+      Close();
+      return NS_FAILURE;
+    }
+
+    for (nsUInt64 uiOffset : dictionaryOffsets)
+    {
+      if (ReadDictionaryChunk(uiOffset).Failed())
+      {
+        nsLog::Error("The dictionary of capture file '{}' is corrupt.", in_sAbsolutePath);
+        Close();
+        return NS_FAILURE;
+      }
+    }
+
+    return NS_SUCCESS;
+#else
+    nsLog::Error("Reading capture files requires memory mapped file support, which is not available on this platform.");
+    return NS_FAILURE;
+#endif
+  }
+
+  void JPHPVDFileReader::Close()
+  {
+    m_File.Close();
+    m_pData = nullptr;
+    m_uiFileSize = 0;
+    m_FrameIndex.Clear();
+    m_bContiguousSteps = false;
+    m_SeriesIndex.Clear();
+    m_Strings.Clear();
+    m_Shapes.Clear();
+    m_ShapeGeometry.Clear();
+  }
+
+  nsUInt32 JPHPVDFileReader::FindFrame(nsUInt64 in_uiStepIndex) const
+  {
+    if (m_FrameIndex.IsEmpty() || in_uiStepIndex < m_FrameIndex[0].m_uiStepIndex)
+      return nsInvalidIndex;
+
+    const nsUInt64 uiDistance = in_uiStepIndex - m_FrameIndex[0].m_uiStepIndex;
+
+    if (m_bContiguousSteps)
+    {
+      return static_cast<nsUInt32>(nsMath::Min<nsUInt64>(uiDistance, m_FrameIndex.GetCount() - 1));
+    }
+
+    // find the last frame with a step index <= in_uiStepIndex
+    nsUInt32 uiFirst = 0;
+    nsUInt32 uiCount = m_FrameIndex.GetCount();
+
+    while (uiCount > 0)
+    {
+      const nsUInt32 uiHalf = uiCount / 2;
+
+      if (m_FrameIndex[uiFirst + uiHalf].m_uiStepIndex <= in_uiStepIndex)
+      {
+        uiFirst += uiHalf + 1;
+        uiCount -= uiHalf + 1;
+      }
+      else
+      {
+        uiCount = uiHalf;
+      }
+    }
+
+    return uiFirst - 1;
+  }
+
+  nsUInt32 JPHPVDFileReader::FindFrameWithFlags(nsUInt32 in_uiFrame, nsUInt8 in_uiFlags) const
+  {
+    for (nsUInt32 uiFrame = in_uiFrame + 1; uiFrame > 0; --uiFrame)
+    {
+      if ((m_FrameIndex[uiFrame - 1].m_uiFlags & in_uiFlags) != 0)
+        return uiFrame - 1;
+    }
+
+    return nsInvalidIndex;
+  }
+
+  nsResult JPHPVDFileReader::ReadFrame(nsUInt32 in_uiFrame, nsDynamicArray<nsUInt8>& out_payload) const
+  {
+    NS_PROFILE_SCOPE("JPHPVDFileReader::ReadFrame");
+
+    nsUInt32 uiVersion = 0;
+    nsArrayPtr<const nsUInt8> chunkData;
+    NS_SUCCEED_OR_RETURN(ReadChunkAt(m_FrameIndex[in_uiFrame].m_uiChunkOffset, PVDFormat::s_szFrameChunk, uiVersion, chunkData));
+
+    if (uiVersion != PVDFormat::s_uiFrameChunkVersion || chunkData.GetCount() < JPHPVDFileReaderDetail::s_uiFrameHeaderSize)
+      return NS_FAILURE;
+
+    JPHByteReader reader(chunkData);
+    nsUInt64 uiStepIndex = 0;
+    nsUInt8 uiFlags = 0;
+    JPHPVDCompression eCompression = JPHPVDCompression::None;
+    nsUInt32 uiUncompressedSize = 0;
+    reader.Read(uiStepIndex);
+    reader.Read(uiFlags);
+    reader.Read(eCompression);
+    reader.Read(uiUncompressedSize);
+
+    return DecompressPayload(eCompression, chunkData.GetSubArray(JPHPVDFileReaderDetail::s_uiFrameHeaderSize), uiUncompressedSize, out_payload);
+  }
+
+  nsResult JPHPVDFileReader::DecompressPayload(JPHPVDCompression in_eCompression, nsArrayPtr<const nsUInt8> in_storedData, nsUInt32 in_uiUncompressedSize, nsDynamicArray<nsUInt8>& out_payload)
+  {
+    out_payload.Clear();
+
+    switch (in_eCompression)
+    {
+      case JPHPVDCompression::None:
+        if (in_storedData.GetCount() != in_uiUncompressedSize)
+          return NS_FAILURE;
+
+        out_payload = in_storedData;
+        return NS_SUCCESS;
+
+      case JPHPVDCompression::Zstd:
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+      {
+        // nsCompressedStreamReaderZstd asserts on truncated or corrupt input, so the chunks written by
+        // nsCompressedStreamWriterZstd (u16 size and the compressed bytes, terminated by a zero size) are fed to zstd directly
+        ZSTD_DStream* pStream = ZSTD_createDStream();
+        NS_SCOPE_EXIT(ZSTD_freeDStream(pStream));
+        ZSTD_initDStream(pStream);
+
+        nsUInt32 uiDecompressed = 0;
+        size_t uiPending = 1; // zero once the frame is complete and fully flushed
+
+        auto Decompress = [&](ZSTD_inBuffer& inout_input) -> bool
+        {
+          if (uiDecompressed == out_payload.GetCount() && uiDecompressed < in_uiUncompressedSize)
+          {
+            const nsUInt32 uiGrowth = nsMath::Max(uiDecompressed, JPHPVDFileReaderDetail::s_uiMinDecompressGrowth);
+            out_payload.SetCountUninitialized(nsMath::Min(in_uiUncompressedSize, uiDecompressed + uiGrowth));
+          }
+
+          ZSTD_outBuffer output = {out_payload.GetData() + uiDecompressed, out_payload.GetCount() - uiDecompressed, 0};
+          const size_t uiInputPos = inout_input.pos;
+
+          uiPending = ZSTD_decompressStream(pStream, &output, &inout_input);
+          uiDecompressed += static_cast<nsUInt32>(output.pos);
+
+          // without any progress, the output is full although the stream holds more data
+          return !ZSTD_isError(uiPending) && (inout_input.pos != uiInputPos || output.pos != 0);
+        };
+
+        JPHByteReader reader(in_storedData);
+
+        while (true)
+        {
+          nsUInt16 uiChunkSize = 0;
+          if (!reader.Read(uiChunkSize))
+            return NS_FAILURE;
+
+          if (uiChunkSize == 0)
+            break;
+
+          ZSTD_inBuffer input = {in_storedData.GetPtr() + reader.GetOffset(), uiChunkSize, 0};
+          if (!reader.Skip(uiChunkSize))
+            return NS_FAILURE;
+
+          while (input.pos < input.size)
+          {
+            if (!Decompress(input))
+              return NS_FAILURE;
+          }
+        }
+
+        ZSTD_inBuffer noInput = {nullptr, 0, 0};
+        while (uiPending != 0)
+        {
+          if (!Decompress(noInput))
+            return NS_FAILURE;
+        }
+
+        return reader.IsAtEnd() && uiDecompressed == in_uiUncompressedSize ? NS_SUCCESS : NS_FAILURE;
+      }
+#else
+        nsLog::Error("The data is zstd compressed, but zstd support is not available.");
+        return NS_FAILURE;
+#endif
+    }
+
+    return NS_FAILURE;
+  }
+
+  nsResult JPHPVDFileReader::GetRecords(nsArrayPtr<const nsUInt8> in_payload, nsDynamicArray<Record>& out_records)
+  {
+    out_records.Clear();
+
+    JPHByteReader reader(in_payload);
+    while (!reader.IsAtEnd())
+    {
+      Record& record = out_records.ExpandAndGetRef();
+
+      nsUInt64 uiSize = 0;
+      reader.Read(record.m_eType);
+      reader.ReadVarUInt(uiSize);
+
+      if (reader.HasFailed() || uiSize > in_payload.GetCount() - reader.GetOffset())
+        return NS_FAILURE;
+
+      record.m_Data = in_payload.GetSubArray(reader.GetOffset(), static_cast<nsUInt32>(uiSize));
+      reader.Skip(static_cast<nsUInt32>(uiSize));
+    }
+
+    return NS_SUCCESS;
+  }
+
+  nsResult JPHPVDFileReader::ReadBodySeries(nsUInt32 in_uiBodyID, nsUInt64 in_uiFirstStep, nsUInt64 in_uiLastStep, nsDynamicArray<JPHPVDBodySample>& out_samples) const
+  {
+    NS_PROFILE_SCOPE("JPHPVDFileReader::ReadBodySeries");
+
+    out_samples.Clear();
+
+    if (!HasBodySeries())
+      return NS_FAILURE;
+
+    // the chunks are in step order, find the first one that ends at or after the first step
+    nsUInt32 uiFirst = 0;
+    nsUInt32 uiCount = m_SeriesIndex.GetCount();
+
+    while (uiCount > 0)
+    {
+      const nsUInt32 uiHalf = uiCount / 2;
+
+      if (m_SeriesIndex[uiFirst + uiHalf].m_uiLastStepIndex < in_uiFirstStep)
+      {
+        uiFirst += uiHalf + 1;
+        uiCount -= uiHalf + 1;
+      }
+      else
+      {
+        uiCount = uiHalf;
+      }
+    }
+
+    nsUInt32 uiEnd = uiFirst;
+    while (uiEnd < m_SeriesIndex.GetCount() && m_SeriesIndex[uiEnd].m_uiFirstStepIndex <= in_uiLastStep)
+    {
+      ++uiEnd;
+    }
+
+    // On a file that is not cached the page faults dominate, visiting the chunks in parallel keeps several reads in flight.
+    // Each chunk writes into its own array, so the samples can be concatenated in step order afterwards.
+    nsDynamicArray<nsDynamicArray<JPHPVDBodySample>> chunkSamples;
+    chunkSamples.SetCount(uiEnd - uiFirst);
+
+    JPHPVDFileReaderDetail::SeriesQuery query;
+    query.m_pReader = this;
+    query.m_pChunkSamples = chunkSamples.GetData();
+    query.m_uiFirstChunk = uiFirst;
+    query.m_uiBodyID = in_uiBodyID;
+    query.m_uiFirstStep = in_uiFirstStep;
+    query.m_uiLastStep = in_uiLastStep;
+
+    nsParallelForParams params;
+    params.m_uiBinSize = 8;
+    params.m_uiMaxTasksPerThread = 4;
+
+    nsTaskSystem::ParallelForIndexed(
+      uiFirst, uiEnd - uiFirst, [&query](nsUInt32 uiStartIndex, nsUInt32 uiEndIndex)
+      {
+        for (nsUInt32 uiChunk = uiStartIndex; uiChunk < uiEndIndex; ++uiChunk)
+        {
+          if (query.m_pReader->ReadBodySeriesChunk(query.m_pReader->m_SeriesIndex[uiChunk], query.m_uiBodyID, query.m_uiFirstStep, query.m_uiLastStep, query.m_pChunkSamples[uiChunk - query.m_uiFirstChunk]).Failed())
+            query.m_bFailed = true;
+        }
+      },
+      "JoltReadBodySeries", nsTaskNesting::Never, params);
+
+    if (query.m_bFailed)
+      return NS_FAILURE;
+
+    for (const nsDynamicArray<JPHPVDBodySample>& samples : chunkSamples)
+    {
+      out_samples.PushBackRange(samples);
+    }
+
+    return NS_SUCCESS;
+  }
+
+  nsStringView JPHPVDFileReader::GetString(nsUInt32 in_uiID) const
+  {
+    if (const nsString* pString = m_Strings.GetValue(in_uiID))
+      return *pString;
+
+    return {};
+  }
+
+  const JPHPVDFileReader::ShapeInfo* JPHPVDFileReader::GetShape(nsUInt32 in_uiID) const
+  {
+    return m_Shapes.GetValue(in_uiID);
+  }
+
+  nsArrayPtr<const nsUInt8> JPHPVDFileReader::GetShapeGeometry(nsUInt32 in_uiShapeID) const
+  {
+    nsArrayPtr<const nsUInt8> data;
+    m_ShapeGeometry.TryGetValue(in_uiShapeID, data);
+    return data;
+  }
+
+  nsResult JPHPVDFileReader::ReadChunkAt(nsUInt64 uiOffset, nsStringView sExpectedName, nsUInt32& out_uiVersion, nsArrayPtr<const nsUInt8>& out_data) const
+  {
+    if (uiOffset >= m_uiFileSize)
+      return NS_FAILURE;
+
+    // chunks are limited to 4GB by nsChunkStreamWriter, so a 32 bit view is enough to reach the end of any chunk
+    const nsUInt32 uiViewSize = static_cast<nsUInt32>(nsMath::Min<nsUInt64>(m_uiFileSize - uiOffset, nsMath::MaxValue<nsUInt32>()));
+    const nsArrayPtr<const nsUInt8> view(m_pData + uiOffset, uiViewSize);
+    JPHByteReader reader(view);
+
+    // mirrors nsChunkStreamWriter::BeginChunk() / EndChunk(): tag, name, version, size, data
+    char szTag[8];
+    nsUInt32 uiNameLength = 0;
+    reader.ReadBytes(szTag, 8);
+    reader.Read(uiNameLength);
+
+    if (reader.HasFailed() || nsMemoryUtils::Compare(szTag, "NXT CHNK", 8) != 0 || uiNameLength != sExpectedName.GetElementCount())
+      return NS_FAILURE;
+
+    const nsUInt32 uiNameOffset = reader.GetOffset();
+    if (!reader.Skip(uiNameLength) || nsMemoryUtils::Compare(reinterpret_cast<const char*>(view.GetPtr() + uiNameOffset), sExpectedName.GetStartPointer(), uiNameLength) != 0)
+      return NS_FAILURE;
+
+    nsUInt32 uiDataSize = 0;
+    reader.Read(out_uiVersion);
+    reader.Read(uiDataSize);
+
+    const nsUInt32 uiDataOffset = reader.GetOffset();
+    if (!reader.Skip(uiDataSize))
+      return NS_FAILURE;
+
+    out_data = view.GetSubArray(uiDataOffset, uiDataSize);
+    return NS_SUCCESS;
+  }
+
+  nsResult JPHPVDFileReader::ReadCaptureChunk()
+  {
+    nsUInt32 uiVersion = 0;
+    nsArrayPtr<const nsUInt8> data;
+    NS_SUCCEED_OR_RETURN(ReadChunkAt(JPHPVDFileReaderDetail::s_uiStreamHeaderSize, PVDFormat::s_szCaptureChunk, uiVersion, data));
+
+    JPHByteReader reader(data);
+    reader.ReadBytes(m_uiJoltVersion, sizeof(m_uiJoltVersion));
+
+    return reader.HasFailed() ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  nsResult JPHPVDFileReader::ReadIndexChunk(nsUInt64 uiOffset, nsDynamicArray<nsUInt64>& out_dictionaryOffsets)
+  {
+    nsUInt32 uiVersion = 0;
+    nsArrayPtr<const nsUInt8> data;
+    NS_SUCCEED_OR_RETURN(ReadChunkAt(uiOffset, PVDFormat::s_szIndexChunk, uiVersion, data));
+
+    if (uiVersion < 1 || uiVersion > PVDFormat::s_uiIndexChunkVersion)
+      return NS_FAILURE;
+
+    JPHByteReader reader(data);
+
+    nsUInt32 uiNumFrames = 0;
+    reader.Read(uiNumFrames);
+
+    // each entry takes 21 bytes, don't trust the count before allocating
+    if (reader.HasFailed() || static_cast<nsUInt64>(uiNumFrames) * 21 > data.GetCount())
+      return NS_FAILURE;
+
+    m_FrameIndex.SetCount(uiNumFrames);
+    m_bContiguousSteps = true;
+
+    for (nsUInt32 i = 0; i < uiNumFrames; ++i)
+    {
+      JPHPVDFrameIndexEntry& entry = m_FrameIndex[i];
+      reader.Read(entry.m_uiStepIndex);
+      reader.Read(entry.m_uiChunkOffset);
+      reader.Read(entry.m_uiKeyframeIndex);
+      reader.Read(entry.m_uiFlags);
+
+      if (entry.m_uiKeyframeIndex > i)
+        return NS_FAILURE;
+
+      m_bContiguousSteps &= entry.m_uiStepIndex == m_FrameIndex[0].m_uiStepIndex + i;
+    }
+
+    nsUInt32 uiNumDictionaryChunks = 0;
+    reader.Read(uiNumDictionaryChunks);
+
+    if (reader.HasFailed() || static_cast<nsUInt64>(uiNumDictionaryChunks) * sizeof(nsUInt64) > data.GetCount())
+      return NS_FAILURE;
+
+    out_dictionaryOffsets.SetCount(uiNumDictionaryChunks);
+    for (nsUInt64& uiDictionaryOffset : out_dictionaryOffsets)
+    {
+      reader.Read(uiDictionaryOffset);
+    }
+
+    if (uiVersion >= 2)
+    {
+      nsUInt32 uiNumSeriesChunks = 0;
+      reader.Read(uiNumSeriesChunks);
+
+      // each entry takes 32 bytes
+      if (reader.HasFailed() || static_cast<nsUInt64>(uiNumSeriesChunks) * 32 > data.GetCount())
+        return NS_FAILURE;
+
+      m_SeriesIndex.SetCount(uiNumSeriesChunks);
+      for (JPHPVDSeriesIndexEntry& entry : m_SeriesIndex)
+      {
+        reader.Read(entry.m_uiFirstStepIndex);
+        reader.Read(entry.m_uiLastStepIndex);
+        reader.Read(entry.m_uiChunkOffset);
+        reader.Read(entry.m_uiFirstBodyIndex);
+        reader.Read(entry.m_uiNumBodyIndices);
+
+        // ReadBodySeriesChunk() computes the directory position from the entry alone
+        constexpr nsUInt64 uiMinChunkSize = JPHBodySeriesWriter::s_uiChunkPrefixSize + JPHBodySeriesWriter::s_uiChunkHeaderSize;
+        constexpr nsUInt64 uiNumBodyIndices = static_cast<nsUInt64>(PVDFormat::s_uiBodyIndexMask) + 1;
+
+        if (entry.m_uiChunkOffset > m_uiFileSize || m_uiFileSize - entry.m_uiChunkOffset < uiMinChunkSize || entry.m_uiFirstStepIndex > entry.m_uiLastStepIndex ||
+            static_cast<nsUInt64>(entry.m_uiFirstBodyIndex) + entry.m_uiNumBodyIndices > uiNumBodyIndices)
+          return NS_FAILURE;
+      }
+    }
+
+    return reader.HasFailed() ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  nsResult JPHPVDFileReader::ReadDictionaryChunk(nsUInt64 uiOffset)
+  {
+    nsUInt32 uiVersion = 0;
+    nsArrayPtr<const nsUInt8> data;
+    NS_SUCCEED_OR_RETURN(ReadChunkAt(uiOffset, PVDFormat::s_szDictionaryChunk, uiVersion, data));
+
+    if (uiVersion != PVDFormat::s_uiDictionaryChunkVersion)
+      return NS_FAILURE;
+
+    JPHByteReader reader(data);
+
+    nsUInt32 uiNumEntries = 0;
+    reader.Read(uiNumEntries);
+
+    for (nsUInt32 i = 0; i < uiNumEntries && !reader.HasFailed(); ++i)
+    {
+      JPHPVDDictionaryEntryType eType = JPHPVDDictionaryEntryType::String;
+      nsUInt32 uiID = 0;
+      reader.Read(eType);
+      reader.Read(uiID);
+
+      switch (eType)
+      {
+        case JPHPVDDictionaryEntryType::String:
+        {
+          nsUInt32 uiLength = 0;
+          reader.Read(uiLength);
+
+          const char* szString = reinterpret_cast<const char*>(data.GetPtr() + reader.GetOffset());
+          if (!reader.Skip(uiLength))
+            return NS_FAILURE;
+
+          m_Strings.Insert(uiID, nsStringView(szString, uiLength));
+          break;
+        }
+
+        case JPHPVDDictionaryEntryType::Shape:
+        {
+          ShapeInfo shape;
+          reader.Read(shape.m_uiType);
+          reader.Read(shape.m_uiSubType);
+          reader.Read(shape.m_vLocalBoundsMin);
+          reader.Read(shape.m_vLocalBoundsMax);
+          reader.Read(shape.m_vCenterOfMass);
+          reader.Read(shape.m_uiUserData);
+          m_Shapes.Insert(uiID, shape);
+          break;
+        }
+
+        case JPHPVDDictionaryEntryType::ShapeGeometry:
+        {
+          nsUInt32 uiSize = 0;
+          reader.Read(uiSize);
+
+          const nsUInt64 uiDataOffset = reader.GetOffset();
+          if (!reader.Skip(uiSize))
+            return NS_FAILURE;
+
+          m_ShapeGeometry.Insert(uiID, data.GetSubArray(static_cast<nsUInt32>(uiDataOffset), uiSize));
+          break;
+        }
+
+        default:
+          return NS_FAILURE;
+      }
+    }
+
+    return reader.HasFailed() ? NS_FAILURE : NS_SUCCESS;
+  }
+
+  nsResult JPHPVDFileReader::ReadBodySeriesChunk(const JPHPVDSeriesIndexEntry& entry, nsUInt32 uiBodyID, nsUInt64 uiFirstStep, nsUInt64 uiLastStep, nsDynamicArray<JPHPVDBodySample>& out_samples) const
+  {
+    const nsUInt32 uiBodyIndex = uiBodyID & PVDFormat::s_uiBodyIndexMask;
+
+    if (uiBodyIndex < entry.m_uiFirstBodyIndex || uiBodyIndex - entry.m_uiFirstBodyIndex >= entry.m_uiNumBodyIndices)
+      return NS_SUCCESS;
+
+    // The table has everything needed to locate the directory entry, the chunk header is not read.
+    // Checking it would cost a page fault per chunk, which is what dominates a query on a file that is not cached.
+    const nsUInt64 uiDirectoryOffset = entry.m_uiChunkOffset + JPHBodySeriesWriter::s_uiChunkPrefixSize + JPHBodySeriesWriter::s_uiChunkHeaderSize;
+    const nsUInt64 uiSamplesOffset = uiDirectoryOffset + (static_cast<nsUInt64>(entry.m_uiNumBodyIndices) + 1) * sizeof(nsUInt32);
+    const nsUInt64 uiEntryOffset = uiDirectoryOffset + static_cast<nsUInt64>(uiBodyIndex - entry.m_uiFirstBodyIndex) * sizeof(nsUInt32);
+
+    if (uiSamplesOffset > m_uiFileSize)
+      return NS_FAILURE;
+
+    // the first sample of this body index and of the next one
+    nsUInt32 uiRange[2] = {};
+    nsMemoryUtils::RawByteCopy(uiRange, m_pData + uiEntryOffset, sizeof(uiRange));
+
+    if (uiRange[0] > uiRange[1] || uiSamplesOffset + static_cast<nsUInt64>(uiRange[1]) * JPHBodySeriesWriter::s_uiSampleSize > m_uiFileSize)
+      return NS_FAILURE;
+
+    for (nsUInt32 uiSample = uiRange[0]; uiSample < uiRange[1]; ++uiSample)
+    {
+      const nsUInt8* pSample = m_pData + uiSamplesOffset + static_cast<nsUInt64>(uiSample) * JPHBodySeriesWriter::s_uiSampleSize;
+
+      nsUInt32 uiSampleBodyID = 0;
+      nsUInt32 uiStepOffset = 0;
+      nsMemoryUtils::RawByteCopy(&uiSampleBodyID, pSample, sizeof(nsUInt32));
+      nsMemoryUtils::RawByteCopy(&uiStepOffset, pSample + 4, sizeof(nsUInt32));
+
+      // the body index may have been used by another body in this range
+      if (uiSampleBodyID != uiBodyID)
+        continue;
+
+      const nsUInt64 uiStepIndex = entry.m_uiFirstStepIndex + uiStepOffset;
+      if (uiStepIndex < uiFirstStep)
+        continue;
+
+      // the samples of a body index are in step order
+      if (uiStepIndex > uiLastStep)
+        break;
+
+      nsUInt32 uiRotation = 0;
+      JPHPVDBodySample& sample = out_samples.ExpandAndGetRef();
+      sample.m_uiStepIndex = uiStepIndex;
+      nsMemoryUtils::RawByteCopy(&sample.m_vPosition, pSample + 8, sizeof(nsVec3));
+      nsMemoryUtils::RawByteCopy(&uiRotation, pSample + 20, sizeof(nsUInt32));
+      nsMemoryUtils::RawByteCopy(&sample.m_vLinearVelocity, pSample + 24, sizeof(nsVec3));
+      nsMemoryUtils::RawByteCopy(&sample.m_vAngularVelocity, pSample + 36, sizeof(nsVec3));
+      sample.m_qRotation = UnpackQuatSmallestThree(uiRotation);
+      sample.m_uiState = pSample[48];
+    }
+
+    return NS_SUCCESS;
+  }
+} // namespace JDebug::API::IO
+
+NS_STATICLINK_FILE(InspectorPlugin, InspectorPlugin_JoltInterface_Internal_Implementation_JPHPVDFileReader);
@@ -0,0 +1,129 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+
+/*
+ *   JPHBodySeriesWriter.h
+ *
+ *   Builds the per-body time series ("JDSeries" chunks) of a capture file from the encoded frames.
+ *
+ *   A series chunk covers a range of steps and stores the samples of that range grouped by body index:
+ *
+ *     u64 first step, u64 last step, u32 first body index F, u32 body index count C, u32 sample count N
+ *     (C + 1) x u32   index of the first sample of body index F + i, the last entry is N
+ *     N x sample      u32 body ID, u32 step relative to the first step, nsVec3 position, u32 rotation (smallest-three packed),
+ *                     nsVec3 linear velocity, nsVec3 angular velocity, u8 state
+ *
+ *   The directory is indexed by body index, so the entry of a body is found without a search, and the samples of a body index
+ *   are stored next to each other in step order. Extracting the history of a body therefore touches about two pages per chunk.
+ *   A body index that was reused by another body within the range holds the samples of both, they are told apart by the body ID.
+ */
+
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileFormat.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHFrameEncoder.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+class nsChunkStreamWriter;
+
+namespace JDebug::API::IO
+{
+  /**
+   * @class JPHBodySeriesWriter
+   * @brief Decodes the encoded frames of a capture and collects the state of every sent body into series chunks.
+   *
+   * Runs on the capture writer thread together with JPHPVDFileManager, the physics thread does not pay for it.
+   * Samples are collected until a chunk covers s_uiMaxStepsPerChunk steps or holds s_uiMaxSamplesPerChunk samples,
+   * which bounds the memory that is needed (about 60 MB) independent of the length of the capture. Larger chunks mean fewer
+   * chunks a query has to visit.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHBodySeriesWriter
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHBodySeriesWriter);
+
+  public:
+    static constexpr nsUInt32 s_uiMaxStepsPerChunk = 1024;
+    static constexpr nsUInt32 s_uiMaxSamplesPerChunk = 1024 * 1024;
+
+    /// Size of the chunk data before the directory, and of one sample, see the layout above.
+    static constexpr nsUInt32 s_uiChunkHeaderSize = 28;
+    static constexpr nsUInt32 s_uiSampleSize = 4 + 4 + 12 + 4 + 12 + 12 + 1;
+
+    /// Size of the header nsChunkStreamWriter writes in front of the chunk data: tag, name length, name, version and size.
+    /// JPHPVDFileReader uses it to jump straight to the directory of a chunk.
+    static constexpr nsUInt32 s_uiChunkPrefixSize = 8 + 4 + 8 + 4 + 4;
+
+  public:
+    JPHBodySeriesWriter();
+    ~JPHBodySeriesWriter();
+
+    /**
+     * @brief Forgets all decoded state and collected samples, e.g. when a new capture starts.
+     */
+    void Reset();
+
+    /**
+     * @brief Decodes an encoded frame and adds a sample for every body it contains, and for every body it removed.
+     *
+     * Frames that cannot be decoded, e.g. delta frames before the first keyframe, are ignored.
+     */
+    void AddFrame(nsUInt64 in_uiStepIndex, nsArrayPtr<const nsUInt8> in_encodedFrame, bool in_bKeyframe);
+
+    /**
+     * @brief Returns whether the collected samples should be written as a chunk now.
+     */
+    bool IsChunkFull() const { return m_uiNumChunkSteps >= s_uiMaxStepsPerChunk || m_Samples.GetCount() >= s_uiMaxSamplesPerChunk; }
+
+    /**
+     * @brief Returns whether samples were collected since the last chunk was written.
+     */
+    bool HasPendingSamples() const { return !m_Samples.IsEmpty(); }
+
+    /**
+     * @brief Writes the collected samples as a "JDSeries" chunk and adds it to the series chunk table.
+     * @param inout_chunkWriter The chunk stream of the capture. No chunk may be open.
+     * @param in_uiChunkOffset The byte offset at which the chunk starts in the file.
+     */
+    void WriteChunk(nsChunkStreamWriter& inout_chunkWriter, nsUInt64 in_uiChunkOffset);
+
+    /**
+     * @brief Returns the table of all chunks written so far.
+     */
+    const nsDynamicArray<JPHPVDSeriesIndexEntry>& GetIndex() const { return m_Index; }
+
+  private:
+    struct Sample
+    {
+      nsUInt32 m_uiBodyID;
+      nsUInt32 m_uiStepOffset;
+      nsVec3 m_vPosition;
+      nsUInt32 m_uiRotation;
+      nsVec3 m_vLinearVelocity;
+      nsVec3 m_vAngularVelocity;
+      nsUInt8 m_uiState;
+    };
+
+    void AddSample(nsUInt32 uiSlot, nsUInt32 uiStepOffset);
+    void AddRemovedSample(nsUInt32 uiBodyID, nsUInt32 uiStepOffset);
+
+    JPHFrameDecoder m_Decoder;
+    JPHBodySnapshot m_Snapshot;
+    nsDynamicArray<nsUInt32> m_DecodedSlots;
+    nsDynamicArray<nsUInt32> m_SlotBodyIDs; ///< The body each slot held after the previous frame, to notice removed bodies.
+
+    nsDynamicArray<Sample> m_Samples; ///< Samples of the chunk that is being collected, in step order.
+    nsUInt64 m_uiChunkFirstStep = 0;
+    nsUInt64 m_uiChunkLastStep = 0;
+    nsUInt32 m_uiNumChunkSteps = 0;
+
+    nsDynamicArray<nsUInt32> m_Directory;   ///< First sample of each body index, built with a counting sort.
+    nsDynamicArray<nsUInt32> m_SampleOrder; ///< Sample indices sorted by body index.
+    nsDynamicArray<nsUInt8> m_WriteBuffer;  ///< Collects the samples in pieces, so they are handed to the chunk writer in a few large writes.
+    nsDynamicArray<JPHPVDSeriesIndexEntry> m_Index;
+  };
+} // namespace JDebug::API::IO
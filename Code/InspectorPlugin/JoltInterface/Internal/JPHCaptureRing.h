@@ -0,0 +1,95 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+
+/*
+ *   JPHCaptureRing.h
+ *
+ *   Bounded lock-free queue that hands encoded frames from the physics thread to the capture writer thread.
+ */
+
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Time/Time.h>
+
+namespace JDebug::API::IO
+{
+  /**
+   * @brief One frame in flight between the physics thread and the capture writer.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHCaptureFrame
+  {
+    nsDynamicArray<nsUInt8> m_Data;    ///< The encoded frame.
+    nsDynamicArray<nsUInt8> m_Records; ///< Further records of the step, already in the capture record format (see JPHPVDRecordType).
+    nsUInt64 m_uiStepIndex = 0;        ///< The physics step the frame belongs to.
+    nsUInt64 m_uiSequence = 0;         ///< Consecutive push counter, a gap means that frames were dropped in between.
+    nsTime m_EnqueueTime;              ///< When the frame was pushed, to measure the write latency.
+    bool m_bKeyframe = false;          ///< Whether the frame can be decoded on its own.
+
+    /// Exchanges the content with another frame. The buffers are swapped, not copied, so their capacity is recycled.
+    void Swap(JPHCaptureFrame& other);
+  };
+
+  /**
+   * @class JPHCaptureRing
+   * @brief Fixed size multi-producer / multi-consumer queue of capture frames (D. Vyukov's bounded queue).
+   *
+   * Frames are moved in and out by swapping buffers with the caller, so once every slot was used no memory is allocated anymore.
+   * There is one producer (the physics thread) and one consumer (the writer thread), but the producer also acts
+   * as a second consumer to drop the oldest frame when the ring is full, which is why the multi-consumer variant is used.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHCaptureRing
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHCaptureRing);
+
+  public:
+    /**
+     * @brief Creates a ring with the given capacity, which is rounded up to a power of two.
+     */
+    explicit JPHCaptureRing(nsUInt32 in_uiCapacity);
+    ~JPHCaptureRing();
+
+    /**
+     * @brief Moves the frame into the ring.
+     * @param inout_frame The frame to add. Receives a recycled buffer on success, is unchanged on failure.
+     * @return False if the ring is full.
+     */
+    bool TryPush(JPHCaptureFrame& inout_frame);
+
+    /**
+     * @brief Takes the oldest frame out of the ring.
+     * @param inout_frame Receives the frame, its previous buffer is recycled in the ring.
+     * @return False if the ring is empty.
+     */
+    bool TryPop(JPHCaptureFrame& inout_frame);
+
+    /**
+     * @brief Returns the number of queued frames. Only a snapshot, the value may already be outdated.
+     */
+    nsUInt32 GetCount() const;
+
+    /**
+     * @brief Returns the maximum number of frames in the ring.
+     */
+    nsUInt32 GetCapacity() const { return m_uiMask + 1; }
+
+  private:
+    struct Cell
+    {
+      nsAtomicInteger64 m_iSequence;
+      JPHCaptureFrame m_Frame;
+    };
+
+    nsDynamicArray<Cell> m_Cells;
+    nsUInt32 m_uiMask = 0;
+
+    // push and pop positions are written by different threads, keep them on separate cache lines
+    nsAtomicInteger64 m_iPushPosition;
+    nsUInt8 m_Padding[64 - sizeof(nsAtomicInteger64)];
+    nsAtomicInteger64 m_iPopPosition;
+  };
+} // namespace JDebug::API::IO
@@ -0,0 +1,242 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+
+/*
+ *   JPHEncodingUtils.h
+ *
+ *   Small helpers shared by everything that produces or consumes the binary JDebug physics streams:
+ *   variable length integers, zig-zag encoding and quaternion packing.
+ */
+
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Math/Math.h>
+#include <Foundation/Math/Quat.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+namespace JDebug::API::IO
+{
+  /**
+   * @brief Appends raw bytes to a growing byte buffer.
+   */
+  class JPHByteWriter
+  {
+  public:
+    explicit JPHByteWriter(nsDynamicArray<nsUInt8>& ref_data)
+      : m_Data(ref_data)
+    {
+    }
+
+    NS_ALWAYS_INLINE void WriteBytes(const void* pData, nsUInt32 uiNumBytes)
+    {
+      const nsUInt32 uiOffset = m_Data.GetCount();
+      m_Data.SetCountUninitialized(uiOffset + uiNumBytes);
+      nsMemoryUtils::RawByteCopy(m_Data.GetData() + uiOffset, pData, uiNumBytes);
+    }
+
+    template <typename T>
+    NS_ALWAYS_INLINE void Write(const T& value)
+    {
+      WriteBytes(&value, sizeof(T));
+    }
+
+    /// Writes an unsigned integer in LEB128 format, small values take a single byte.
+    NS_ALWAYS_INLINE void WriteVarUInt(nsUInt64 uiValue)
+    {
+      while (uiValue >= 0x80)
+      {
+        m_Data.PushBack(static_cast<nsUInt8>(uiValue | 0x80));
+        uiValue >>= 7;
+      }
+
+      m_Data.PushBack(static_cast<nsUInt8>(uiValue));
+    }
+
+    /// Writes a signed integer zig-zag encoded, so that small negative values also take a single byte.
+    NS_ALWAYS_INLINE void WriteVarInt(nsInt64 iValue)
+    {
+      WriteVarUInt((static_cast<nsUInt64>(iValue) << 1) ^ static_cast<nsUInt64>(iValue >> 63));
+    }
+
+    /// Returns the current write position, e.g. to patch a value later.
+    NS_ALWAYS_INLINE nsUInt32 GetOffset() const { return m_Data.GetCount(); }
+
+    template <typename T>
+    NS_ALWAYS_INLINE void Patch(nsUInt32 uiOffset, const T& value)
+    {
+      nsMemoryUtils::RawByteCopy(m_Data.GetData() + uiOffset, &value, sizeof(T));
+    }
+
+  private:
+    nsDynamicArray<nsUInt8>& m_Data;
+  };
+
+  /**
+   * @brief Reads data written by JPHByteWriter. All reads are bounds checked, after the first failure every further read fails as well.
+   */
+  class JPHByteReader
+  {
+  public:
+    explicit JPHByteReader(nsArrayPtr<const nsUInt8> data)
+      : m_Data(data)
+    {
+    }
+
+    NS_ALWAYS_INLINE bool ReadBytes(void* pData, nsUInt32 uiNumBytes)
+    {
+      if (uiNumBytes > m_Data.GetCount() - m_uiOffset)
+      {
+        m_bFailed = true;
+        m_uiOffset = m_Data.GetCount();
+        return false;
+      }
+
+      nsMemoryUtils::RawByteCopy(pData, m_Data.GetPtr() + m_uiOffset, uiNumBytes);
+      m_uiOffset += uiNumBytes;
+      return true;
+    }
+
+    template <typename T>
+    NS_ALWAYS_INLINE bool Read(T& out_value)
+    {
+      return ReadBytes(&out_value, sizeof(T));
+    }
+
+    /// Advances the read position without copying anything.
+    NS_ALWAYS_INLINE bool Skip(nsUInt32 uiNumBytes)
+    {
+      if (uiNumBytes > m_Data.GetCount() - m_uiOffset)
+      {
+        m_bFailed = true;
+        m_uiOffset = m_Data.GetCount();
+        return false;
+      }
+
+      m_uiOffset += uiNumBytes;
+      return true;
+    }
+
+    NS_ALWAYS_INLINE bool ReadVarUInt(nsUInt64& out_uiValue)
+    {
+      out_uiValue = 0;
+
+      for (nsUInt32 uiShift = 0; uiShift < 64; uiShift += 7)
+      {
+        if (m_uiOffset >= m_Data.GetCount())
+          break;
+
+        const nsUInt8 uiByte = m_Data[m_uiOffset++];
+        out_uiValue |= static_cast<nsUInt64>(uiByte & 0x7F) << uiShift;
+
+        if ((uiByte & 0x80) == 0)
+          return true;
+      }
+
+      m_bFailed = true;
+      return false;
+    }
+
+    NS_ALWAYS_INLINE bool ReadVarInt(nsInt64& out_iValue)
+    {
+      nsUInt64 uiValue = 0;
+      const bool bResult = ReadVarUInt(uiValue);
+      out_iValue = static_cast<nsInt64>(uiValue >> 1) ^ -static_cast<nsInt64>(uiValue & 1);
+      return bResult;
+    }
+
+    NS_ALWAYS_INLINE nsUInt32 GetOffset() const { return m_uiOffset; }
+    NS_ALWAYS_INLINE bool IsAtEnd() const { return m_uiOffset >= m_Data.GetCount(); }
+    NS_ALWAYS_INLINE bool HasFailed() const { return m_bFailed; }
+
+  private:
+    nsArrayPtr<const nsUInt8> m_Data;
+    nsUInt32 m_uiOffset = 0;
+    bool m_bFailed = false;
+  };
+
+  /**
+   * @brief Packs a normalized quaternion into 32 bits using the smallest-three encoding.
+   *
+   * The largest component is dropped (its index is stored in the top two bits) and the remaining three are stored with 10 bits each.
+   * The precision is about 0.003 radians, which is plenty for visualization.
+   */
+  inline nsUInt32 PackQuatSmallestThree(const nsQuat& q)
+  {
+    const float values[4] = {q.x, q.y, q.z, q.w};
+
+    nsUInt32 uiLargest = 0;
+    for (nsUInt32 i = 1; i < 4; ++i)
+    {
+      if (nsMath::Abs(values[i]) > nsMath::Abs(values[uiLargest]))
+        uiLargest = i;
+    }
+
+    // q and -q are the same rotation, make sure the dropped component is positive so it can be reconstructed
+    const float fSign = values[uiLargest] < 0.0f ? -1.0f : 1.0f;
+
+    nsUInt32 uiResult = uiLargest << 30;
+    nsUInt32 uiShift = 20;
+
+    for (nsUInt32 i = 0; i < 4; ++i)
+    {
+      if (i == uiLargest)
+        continue;
+
+      // the remaining components are within [-1/sqrt(2), 1/sqrt(2)], map them symmetrically to [0, 1022] so that zero is exact
+      const float fNormalized = nsMath::Clamp(values[i] * fSign * nsMath::Sqrt(2.0f), -1.0f, 1.0f);
+      uiResult |= static_cast<nsUInt32>(nsMath::Round(fNormalized * 511.0f) + 511.0f) << uiShift;
+      uiShift -= 10;
+    }
+
+    return uiResult;
+  }
+
+  /**
+   * @brief Reverses PackQuatSmallestThree().
+   */
+  inline nsQuat UnpackQuatSmallestThree(nsUInt32 uiPacked)
+  {
+    const nsUInt32 uiLargest = uiPacked >> 30;
+
+    float values[4];
+    float fSumSquared = 0.0f;
+    nsUInt32 uiShift = 20;
+
+    for (nsUInt32 i = 0; i < 4; ++i)
+    {
+      if (i == uiLargest)
+        continue;
+
+      const float fNormalized = (static_cast<float>((uiPacked >> uiShift) & 0x3FF) - 511.0f) / 511.0f;
+      values[i] = fNormalized / nsMath::Sqrt(2.0f);
+      fSumSquared += values[i] * values[i];
+      uiShift -= 10;
+    }
+
+    values[uiLargest] = nsMath::Sqrt(nsMath::Max(0.0f, 1.0f - fSumSquared));
+
+    return nsQuat(values[0], values[1], values[2], values[3]);
+  }
+
+  /**
+   * @brief Converts a float into a fixed point value with the given quantum.
+   *
+   * Out of range values are clamped to +/-2^30, decoders reject anything beyond that as corrupt. NaN becomes zero.
+   */
+  NS_ALWAYS_INLINE nsInt32 QuantizeFixed(float fValue, float fInvQuantum)
+  {
+    constexpr float fLimit = static_cast<float>(1 << 30);
+
+    const float fScaled = nsMath::Round(fValue * fInvQuantum);
+
+    // converting NaN or a value outside the range of the integer is undefined
+    if (nsMath::IsNaN(fScaled))
+      return 0;
+
+    return static_cast<nsInt32>(nsMath::Clamp(fScaled, -fLimit, fLimit));
+  }
+} // namespace JDebug::API::IO
@@ -0,0 +1,69 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+
+/*
+ *   JPHJoltStreams.h
+ *
+ *   Adapters between Jolt's binary serialization (JPH::StreamOut / JPH::StreamIn) and the byte buffers of the JDebug streams,
+ *   so settings that Jolt serializes itself can be stored in capture records without going through std::stringstream.
+ */
+
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Core/StreamIn.h>
+#include <Jolt/Core/StreamOut.h>
+
+namespace JDebug::API::IO
+{
+  /**
+   * @brief A JPH::StreamOut that appends to a byte buffer.
+   */
+  class JPHJoltStreamOut final : public JPH::StreamOut
+  {
+  public:
+    explicit JPHJoltStreamOut(nsDynamicArray<nsUInt8>& ref_data)
+      : m_Writer(ref_data)
+    {
+    }
+
+    virtual void WriteBytes(const void* inData, size_t inNumBytes) override { m_Writer.WriteBytes(inData, static_cast<nsUInt32>(inNumBytes)); }
+    virtual bool IsFailed() const override { return false; }
+
+  private:
+    JPHByteWriter m_Writer;
+  };
+
+  /**
+   * @brief A JPH::StreamIn that reads from a byte buffer. Reading past the end fails the stream instead of reading garbage.
+   */
+  class JPHJoltStreamIn final : public JPH::StreamIn
+  {
+  public:
+    explicit JPHJoltStreamIn(nsArrayPtr<const nsUInt8> data)
+      : m_Reader(data)
+    {
+    }
+
+    virtual void ReadBytes(void* outData, size_t inNumBytes) override
+    {
+      if (!m_Reader.ReadBytes(outData, static_cast<nsUInt32>(inNumBytes)))
+      {
+        // Jolt does not check every read, hand out zeros so a corrupt record can't produce uninitialized values
+        nsMemoryUtils::ZeroFill(static_cast<nsUInt8*>(outData), inNumBytes);
+      }
+    }
+
+    // like std::istream, end of file is only reported once a read went past the end, Jolt checks it after reading the last value
+    virtual bool IsEOF() const override { return m_Reader.HasFailed(); }
+    virtual bool IsFailed() const override { return m_Reader.HasFailed(); }
+
+  private:
+    JPHByteReader m_Reader;
+  };
+} // namespace JDebug::API::IO
@@ -0,0 +1,165 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+
+/*
+ *   JPHPVDFileFormat.h
+ *
+ *   Layout of JDebug capture files, shared by JPHPVDFileManager (writer) and JPHPVDFileReader.
+ *
+ *   A capture is a regular nsChunkStreamWriter stream followed by a fixed size footer:
+ *
+ *     "BGNCHNK2" u16 stream version
+ *     Chunk "JDCapture"     once, describes the capture
+ *     Chunk "JDDictionary"  any number, new string and shape entries, always written before the first frame that uses them
+ *     Chunk "JDFrame"       one per captured step, the records of the step, zstd compressed
+ *     Chunk "JDSeries"      optional, any number, the body states of a range of steps grouped by body, see JPHBodySeriesWriter
+ *     Chunk "JDIndex"       once, the frame seek table, the offsets of all dictionary chunks and the series chunk table
+ *     "END CHNK"
+ *     JPHPVDFileFooter
+ *
+ *   The file is append-only, nothing is ever patched. A reader locates the index through the footer and can then jump
+ *   to any frame directly. The series chunks are interleaved with the frame chunks, they let a reader extract the history
+ *   of a single body without decoding any frame.
+ */
+
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Math/Quat.h>
+#include <Foundation/Math/Vec3.h>
+
+namespace JDebug::API::IO
+{
+  namespace PVDFormat
+  {
+    static constexpr nsUInt16 s_uiStreamVersion = 1;
+
+    static constexpr const char* s_szCaptureChunk = "JDCapture";
+    static constexpr const char* s_szDictionaryChunk = "JDDictionary";
+    static constexpr const char* s_szFrameChunk = "JDFrame";
+    static constexpr const char* s_szIndexChunk = "JDIndex";
+    static constexpr const char* s_szBodySeriesChunk = "JDSeries";
+
+    static constexpr nsUInt32 s_uiCaptureChunkVersion = 1;
+    static constexpr nsUInt32 s_uiDictionaryChunkVersion = 1;
+    static constexpr nsUInt32 s_uiFrameChunkVersion = 1;
+    static constexpr nsUInt32 s_uiIndexChunkVersion = 2; ///< Version 2 appended the series chunk table.
+    static constexpr nsUInt32 s_uiBodySeriesChunkVersion = 1;
+
+    static constexpr nsUInt32 s_uiFooterMagic = 'JDIX';
+
+    /// Extracts JPH::BodyID::GetIndex() from JPH::BodyID::GetIndexAndSequenceNumber().
+    static constexpr nsUInt32 s_uiBodyIndexMask = 0x007FFFFF;
+
+    /// An ID that references nothing in the dictionary, e.g. a body without a shape.
+    static constexpr nsUInt32 s_uiInvalidDictionaryID = 0xFFFFFFFF;
+  } // namespace PVDFormat
+
+  /**
+   * @brief How the payload of a frame chunk is stored.
+   */
+  enum class JPHPVDCompression : nsUInt8
+  {
+    None, ///< The payload follows the frame header as is.
+    Zstd, ///< The payload is a stream written by nsCompressedStreamWriterZstd.
+  };
+
+  /**
+   * @brief Flags of a frame chunk.
+   */
+  enum JPHPVDFrameFlags : nsUInt8
+  {
+    PVDFrame_Keyframe = NS_BIT(0),     ///< The frame does not depend on previous frames, playback can start here.
+    PVDFrame_PhysicsState = NS_BIT(1), ///< The frame holds a PhysicsState record, re-simulation can start here.
+    PVDFrame_PhysicsScene = NS_BIT(2), ///< The frame holds a PhysicsScene record.
+  };
+
+  /**
+   * @brief Type of an entry in a dictionary chunk.
+   */
+  enum class JPHPVDDictionaryEntryType : nsUInt8
+  {
+    String,        ///< u32 ID, nsString
+    Shape,         ///< u32 ID, u8 type, u8 sub type, nsVec3 local bounds min, nsVec3 local bounds max, nsVec3 center of mass, u64 user data
+    ShapeGeometry, ///< u32 JPHShapeDictionary ID, u32 size, geometry data as described in JPHShapeDictionary. Referenced by encoded frames.
+  };
+
+  /**
+   * @brief Type of a record inside the payload of a frame chunk.
+   *
+   * A payload is a sequence of records, each one is a u8 type, a varuint byte count and the record data.
+   * Readers skip records they do not know, so new record types can be added without breaking old readers.
+   */
+  enum class JPHPVDRecordType : nsUInt8
+  {
+    EncodedFrame,   ///< A frame written by JPHFrameEncoder.
+    Body,           ///< Written by JPHPVDFileManager::WriteBodyData().
+    Character,      ///< Written by JPHPVDFileManager::WriteCharacterData().
+    Contacts,       ///< The contacts of the step, written by JPHContactRecorder::WriteContacts().
+    PhysicsState,   ///< The full simulation state after the step, written by JPHReplayEngine::WriteStateRecord().
+    PhysicsScene,   ///< The bodies and constraints needed to restore a PhysicsState, written by JPHReplayEngine::WriteSceneRecord().
+    StateHash,      ///< The hash of the exact body state after the step, written by JPHStateHash::Write().
+    StepStatistics, ///< Phase timing and counters of the step, written by JPHStepStatistics::Write().
+    SoftBodies,     ///< The vertices of all soft bodies, a frame written by JPHSoftBodyEncoder. Delta coded against the last SoftBodies record.
+    DebugDraw,      ///< What was drawn through a JPHDebugRenderer, a frame written by JPHDebugRenderer::EncodeFrame(). Delta coded against the last DebugDraw record.
+    Queries,        ///< The collision queries recorded during the step, written by JPHQueryRecorder::WriteRecords().
+    Constraint,     ///< Written by JPHPVDFileManager::WriteConstraintData().
+    Constraints,    ///< The most stressed constraints of the step and a histogram of all of them, written by JPHConstraintStatistics::Write().
+    Aggregates,     ///< The bodies outside the interest set summarized in grid cells, written by JPHAggregateGrid::Write(). Only present if the frames were limited to the interest set.
+  };
+
+  /**
+   * @brief One entry of the frame seek table.
+   */
+  struct JPHPVDFrameIndexEntry
+  {
+    nsUInt64 m_uiStepIndex = 0;     ///< The physics step the frame was captured in.
+    nsUInt64 m_uiChunkOffset = 0;   ///< Byte offset of the frame chunk from the start of the file.
+    nsUInt32 m_uiKeyframeIndex = 0; ///< Index of the closest keyframe at or before this frame.
+    nsUInt8 m_uiFlags = 0;          ///< JPHPVDFrameFlags
+  };
+
+  /**
+   * @brief One entry of the series chunk table.
+   *
+   * The body index range is kept in the table, so a reader can locate the directory entry of a body without reading the chunk header.
+   */
+  struct JPHPVDSeriesIndexEntry
+  {
+    nsUInt64 m_uiFirstStepIndex = 0; ///< The first step that has samples in the chunk.
+    nsUInt64 m_uiLastStepIndex = 0;  ///< The last step that has samples in the chunk.
+    nsUInt64 m_uiChunkOffset = 0;    ///< Byte offset of the "JDSeries" chunk from the start of the file.
+    nsUInt32 m_uiFirstBodyIndex = 0; ///< The smallest JPH::BodyID::GetIndex() that has samples in the chunk.
+    nsUInt32 m_uiNumBodyIndices = 0; ///< Number of directory entries, one per body index from m_uiFirstBodyIndex on.
+  };
+
+  /**
+   * @brief The state of one body after a step, as stored in the series chunks.
+   *
+   * A sample is only stored for steps in which the body was sent, i.e. it moved further than the encoder tolerances, and for keyframes.
+   * The body keeps its state until the next sample. The values carry the quantization of the encoded frames.
+   */
+  struct JPHPVDBodySample
+  {
+    nsUInt64 m_uiStepIndex = 0;
+    nsVec3 m_vPosition = nsVec3::MakeZero();
+    nsQuat m_qRotation = nsQuat::MakeIdentity();
+    nsVec3 m_vLinearVelocity = nsVec3::MakeZero();
+    nsVec3 m_vAngularVelocity = nsVec3::MakeZero();
+    nsUInt8 m_uiState = 0; ///< JPHBodySnapshot::JPHBodyStateFlags, zero once the body was removed.
+  };
+
+  /**
+   * @brief The fixed size block at the very end of a capture file.
+   */
+  struct JPHPVDFileFooter
+  {
+    nsUInt64 m_uiIndexChunkOffset = 0; ///< Byte offset of the "JDIndex" chunk.
+    nsUInt32 m_uiMagic = PVDFormat::s_uiFooterMagic;
+    nsUInt32 m_uiPadding = 0;
+  };
+
+  static_assert(sizeof(JPHPVDFileFooter) == 16);
+} // namespace JDebug::API::IO
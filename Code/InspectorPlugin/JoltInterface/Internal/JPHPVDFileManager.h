@@ -5,73 +5,251 @@
  */
 
 /*
-*   JPHPVDFileManager.h
-*   
-*   JPHPVDFileManager is responsible for managing and writing data to a file.
-*   It provides functions to write body, character, constraint, and soft body shape data.
-*/
+ *   JPHPVDFileManager.h
+ *
+ *   JPHPVDFileManager is responsible for managing and writing data to a capture file.
+ *   It provides functions to write body, character, constraint, and soft body shape data.
+ *   The file layout is described in JPHPVDFileFormat.h, captures are read back with JPHPVDFileReader.
+ */
 
 #pragma once
 #include <InspectorPlugin/InspectorPluginDLL.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileFormat.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/IO/ChunkStream.h>
 #include <Foundation/Math/Math.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Types/UniquePtr.h>
 #include <Jolt/Jolt.h>
 
 class nsOSFile;
-class nsAbstractObjectGraph;
+class nsCompressedStreamWriterZstd;
 
 namespace JPH
 {
-    class Body;
-    class Character;
-    class Constraint;
-    class SoftBodyShape;
-}
+  class Body;
+  class Character;
+  class Constraint;
+  class Shape;
+} // namespace JPH
+
+namespace JDebug::API
+{
+  class JPHSoftBodyEncoder;
+} // namespace JDebug::API
 
 namespace JDebug::API::IO
 {
-    class NS_INSPECTORPLUGIN_DLL JPHPVDFileManager
-    {
-        public:
-            /**
-             * @brief Default constructor.
-             */
-            JPHPVDFileManager() = default;
-
-            /**
-             * @brief Constructor.
-             * @param in_file The file to manage and write data to.
-             */
-            explicit JPHPVDFileManager(const nsOSFile& in_file);
-
-            /**
-             * @brief Destructor.
-             */
-            virtual ~JPHPVDFileManager();
-
-            /**
-             * @brief Writes body data to the file.
-             * @param in_data The body data to write.
-             */
-            void WriteBodyData(const JPH::Body& in_data);
-            
-            /**
-             * @brief Writes character data to the file.
-             * @param in_data The character data to write.
-             */
-            void WriteCharacterData(const JPH::Character& in_data);
-
-            /**
-             * @brief Writes constraint data to the file.
-             * @param in_data The constraint data to write.
-             */
-            void WriteConstraintData(const JPH::Constraint& in_data);
-
-            /**
-             * @brief Writes soft body shape data to the file.
-             * @param in_data The soft body shape data to write.
-             */
-            void WriteSoftBodyShapeData(const JPH::SoftBodyShape& in_data);
-        private:
-            nsAbstractObjectGraph* m_pGraph; ///< The object graph. this is used to write data to the file.
-    };
-}
\ No newline at end of file
+  class JPHBodySeriesWriter;
+
+  /**
+   * @brief Stream writer that forwards to an nsOSFile and keeps track of the number of written bytes.
+   *
+   * The file manager needs absolute offsets of its chunks for the seek table, nsOSFile::GetFilePosition() would be a system call per query.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHPVDFileStreamWriter : public nsStreamWriter
+  {
+  public:
+    explicit JPHPVDFileStreamWriter(nsOSFile& ref_file);
+
+    virtual nsResult WriteBytes(const void* pWriteBuffer, nsUInt64 uiBytesToWrite) override;
+
+    /// Returns the offset from the start of the file at which the next byte will be written.
+    nsUInt64 GetOffset() const { return m_uiOffset; }
+
+  private:
+    nsOSFile& m_File;
+    nsUInt64 m_uiOffset = 0;
+  };
+
+  /**
+   * @class JPHPVDFileManager
+   * @brief Writes an append-only, seekable capture file.
+   *
+   * Data is written frame by frame: everything between BeginFrame() and EndFrame() is collected as records,
+   * compressed and written as one chunk. Strings and shapes are stored once in dictionary chunks and referenced by ID.
+   * When the capture is closed, a seek table with the offset of every frame is appended, so a reader can jump to any frame
+   * without parsing the file.
+   *
+   * The class is not thread safe. While a JPHCaptureWriter writes into it, only the writer thread may touch it, see JPHCaptureWriter::Start().
+   * The static AppendRecord() is the exception, it only works on the buffer that is passed in.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHPVDFileManager
+  {
+  public:
+    /**
+     * @brief Default constructor. Open() has to be called before anything can be written.
+     */
+    JPHPVDFileManager();
+
+    /**
+     * @brief Constructor. Starts a capture in the given file.
+     * @param inout_file The file to manage and write data to. Must be opened for writing and outlive the capture.
+     */
+    explicit JPHPVDFileManager(nsOSFile& inout_file);
+
+    /**
+     * @brief Destructor. Finishes the capture, if it is still open.
+     */
+    virtual ~JPHPVDFileManager();
+
+    /**
+     * @brief Starts a new capture in the given file. The file must be opened for writing and outlive the capture.
+     */
+    void Open(nsOSFile& inout_file);
+
+    /**
+     * @brief Writes the frame index and the footer. The file is not closed, but nothing can be written anymore.
+     */
+    void Close();
+
+    /**
+     * @brief Returns whether a capture is currently being written.
+     */
+    bool IsOpen() const { return m_pChunkWriter != nullptr; }
+
+    /**
+     * @brief Enables the per-body time series ("JDSeries" chunks), which JPHPVDFileReader::ReadBodySeries() uses to extract the
+     *        history of a single body without decoding the frames. Takes effect with the next Open().
+     *
+     * The encoded frames are decoded a second time while they are written, and each sent body adds about 45 bytes to the file.
+     */
+    void SetBodySeriesEnabled(bool in_bEnable) { m_bBodySeriesEnabled = in_bEnable; }
+
+    /**
+     * @brief Returns whether the per-body time series is written for new captures.
+     */
+    bool IsBodySeriesEnabled() const { return m_bBodySeriesEnabled; }
+
+    /**
+     * @brief Starts collecting the records of a frame.
+     * @param in_uiStepIndex The physics step the data belongs to. Step indices must be increasing.
+     * @param in_bKeyframe Whether the frame can be decoded without previous frames.
+     */
+    void BeginFrame(nsUInt64 in_uiStepIndex, bool in_bKeyframe);
+
+    /**
+     * @brief Compresses the collected records and appends them to the file.
+     */
+    void EndFrame();
+
+    /**
+     * @brief Writes a frame produced by JPHFrameEncoder into the current frame.
+     * @param in_data The encoded frame.
+     */
+    void WriteEncodedFrame(nsArrayPtr<const nsUInt8> in_data);
+
+    /**
+     * @brief Writes records that were formatted with AppendRecord() into the current frame.
+     *
+     * PhysicsState and PhysicsScene records are also flagged in the seek table, see JPHPVDFrameFlags.
+     */
+    void WriteRecords(nsArrayPtr<const nsUInt8> in_records);
+
+    /**
+     * @brief Appends a record in the frame payload format, so records can be prepared on another thread and written with WriteRecords().
+     */
+    static void AppendRecord(nsDynamicArray<nsUInt8>& inout_records, JPHPVDRecordType in_type, nsArrayPtr<const nsUInt8> in_data);
+
+    /**
+     * @brief Writes body data to the file.
+     * @param in_data The body data to write.
+     */
+    void WriteBodyData(const JPH::Body& in_data);
+
+    /**
+     * @brief Writes character data to the file.
+     * @param in_data The character data to write.
+     */
+    void WriteCharacterData(const JPH::Character& in_data);
+
+    /**
+     * @brief Writes constraint data to the file.
+     *
+     * The record holds the type, the bodies and what the solver did with the constraint in the last step, see JPHConstraintMonitor::Measure().
+     * The physics settings are not known here, so the step counts are the largest override of the constraint and its bodies, zero meaning the default.
+     * Layout: u8 type, u8 sub type, u8 flags (1 enabled, 2 active), u32 body ID 1 and 2, u64 user data,
+     * float linear impulse, angular impulse and position error, varuint velocity and position step count.
+     * @param in_data The constraint data to write.
+     */
+    void WriteConstraintData(const JPH::Constraint& in_data);
+
+    /**
+     * @brief Writes the vertices of a soft body to the file.
+     *
+     * All soft bodies written in a frame are collected into one SoftBodies record by a JPHSoftBodyEncoder, so the topology of each body
+     * is only stored once and the positions are delta coded against the previous frame. Keyframes contain all positions in full.
+     * Soft bodies that were written in the previous frame but not in this one are treated as removed.
+     * The vertices are not reachable through the JPH::SoftBodyShape, which is why the body is passed in.
+     * @param in_data The soft body to write.
+     */
+    void WriteSoftBodyShapeData(const JPH::Body& in_data);
+
+    /**
+     * @brief Returns the dictionary ID of the given string, adding it to the dictionary if necessary.
+     */
+    nsUInt32 GetStringID(nsStringView in_sString);
+
+    /**
+     * @brief Returns the dictionary ID of the given shape, adding it to the dictionary if necessary.
+     */
+    nsUInt32 GetShapeID(const JPH::Shape* in_pShape);
+
+    /**
+     * @brief Adds the geometry of a JPHShapeDictionary entry to the dictionary. Its ID is the one the encoded frames refer to.
+     */
+    void WriteShapeGeometry(nsUInt32 in_uiShapeID, nsArrayPtr<const nsUInt8> in_data);
+
+    /**
+     * @brief Returns the number of frames written so far.
+     */
+    nsUInt32 GetNumFrames() const { return m_FrameIndex.GetCount(); }
+
+    /**
+     * @brief Returns the number of bytes written to the file so far.
+     */
+    nsUInt64 GetFileSize() const { return m_pFileWriter != nullptr ? m_pFileWriter->GetOffset() : 0; }
+
+  private:
+    void BeginRecord(JPHPVDRecordType type);
+    void EndRecord();
+    void WriteDictionaryChunk();
+    void WriteFrameChunk();
+    void WriteBodySeriesChunk();
+    void WriteIndexChunk();
+
+    nsUniquePtr<JPHPVDFileStreamWriter> m_pFileWriter;
+    nsUniquePtr<nsChunkStreamWriter> m_pChunkWriter;
+
+    // The frame that is currently being collected.
+    bool m_bFrameOpen = false;
+    JPHPVDFrameIndexEntry m_CurrentFrame;
+    nsDynamicArray<nsUInt8> m_FrameData;   ///< Uncompressed records of the current frame.
+    nsDynamicArray<nsUInt8> m_RecordData;  ///< Data of the record that is currently being written.
+    JPHPVDRecordType m_eRecordType = JPHPVDRecordType::EncodedFrame;
+    nsDynamicArray<nsUInt8> m_CompressedData;
+    nsUniquePtr<nsCompressedStreamWriterZstd> m_pCompressor; ///< Reused for all frames, creating a zstd context is not cheap.
+
+    // Soft bodies of the current frame, written as one record when the frame ends.
+    nsUniquePtr<JPHSoftBodyEncoder> m_pSoftBodyEncoder;
+    nsDynamicArray<nsUInt8> m_SoftBodyData;
+    bool m_bSoftBodyFrameOpen = false;
+
+    // Per-body time series, only created while enabled.
+    bool m_bBodySeriesEnabled = false;
+    nsUniquePtr<JPHBodySeriesWriter> m_pBodySeries;
+
+    // Dictionary state. Entries that were added since the last dictionary chunk are serialized into m_PendingDictionary.
+    nsHashTable<nsString, nsUInt32> m_StringIDs;
+    nsHashTable<const JPH::Shape*, nsUInt32> m_ShapeIDs;
+    nsUInt32 m_uiNextDictionaryID = 0;
+    nsUInt32 m_uiNumPendingEntries = 0;
+    nsDynamicArray<nsUInt8> m_PendingDictionary;
+
+    // Seek table, written when the capture is closed.
+    nsDynamicArray<JPHPVDFrameIndexEntry> m_FrameIndex;
+    nsDynamicArray<nsUInt64> m_DictionaryChunkOffsets;
+    nsUInt32 m_uiLastKeyframeIndex = 0;
+  };
+} // namespace JDebug::API::IO
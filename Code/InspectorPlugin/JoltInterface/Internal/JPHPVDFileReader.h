@@ -0,0 +1,190 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+
+/*
+ *   JPHPVDFileReader.h
+ *
+ *   Random access to capture files written by JPHPVDFileManager.
+ *   The file is memory mapped, only the seek table and the dictionary are parsed up front.
+ */
+
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileFormat.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/IO/MemoryMappedFile.h>
+#include <Foundation/Math/Vec3.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+namespace JDebug::API::IO
+{
+  /**
+   * @class JPHPVDFileReader
+   * @brief Reads capture files through a memory mapping.
+   *
+   * Opening a capture only parses the footer, the frame index and the dictionary. Any frame can then be located in O(1)
+   * (or O(log n) if steps were skipped during capture) and decompressed on its own, without touching the rest of the file.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHPVDFileReader
+  {
+  public:
+    /**
+     * @brief A shape entry of the capture dictionary.
+     */
+    struct ShapeInfo
+    {
+      nsUInt8 m_uiType = 0;    ///< JPH::EShapeType
+      nsUInt8 m_uiSubType = 0; ///< JPH::EShapeSubType
+      nsVec3 m_vLocalBoundsMin = nsVec3::MakeZero();
+      nsVec3 m_vLocalBoundsMax = nsVec3::MakeZero();
+      nsVec3 m_vCenterOfMass = nsVec3::MakeZero();
+      nsUInt64 m_uiUserData = 0;
+    };
+
+    /**
+     * @brief One record of a decompressed frame. The data points into the buffer that was passed to GetRecords().
+     */
+    struct Record
+    {
+      JPHPVDRecordType m_eType = JPHPVDRecordType::EncodedFrame;
+      nsArrayPtr<const nsUInt8> m_Data;
+    };
+
+  public:
+    JPHPVDFileReader();
+    ~JPHPVDFileReader();
+
+    /**
+     * @brief Maps the given capture file and reads its index and dictionary.
+     * @param in_sAbsolutePath Absolute path of the capture file.
+     * @return NS_FAILURE if the file cannot be mapped, was not finalized or is corrupt.
+     */
+    nsResult Open(nsStringView in_sAbsolutePath);
+
+    /**
+     * @brief Unmaps the file and clears all cached data.
+     */
+    void Close();
+
+    /**
+     * @brief Returns whether a capture is currently open.
+     */
+    bool IsOpen() const { return m_pData != nullptr; }
+
+    /**
+     * @brief Returns the number of frames in the capture.
+     */
+    nsUInt32 GetNumFrames() const { return m_FrameIndex.GetCount(); }
+
+    /**
+     * @brief Returns the seek table entry of the given frame.
+     */
+    const JPHPVDFrameIndexEntry& GetFrameInfo(nsUInt32 in_uiFrame) const { return m_FrameIndex[in_uiFrame]; }
+
+    /**
+     * @brief Returns the frame that holds the given step, or the last frame before it if that step was not captured.
+     * @return nsInvalidIndex if the step lies before the first frame.
+     */
+    nsUInt32 FindFrame(nsUInt64 in_uiStepIndex) const;
+
+    /**
+     * @brief Returns the closest keyframe at or before the given frame. Decoding has to start there.
+     */
+    nsUInt32 GetKeyframe(nsUInt32 in_uiFrame) const { return m_FrameIndex[in_uiFrame].m_uiKeyframeIndex; }
+
+    /**
+     * @brief Returns the closest frame at or before the given one that has any of the given JPHPVDFrameFlags.
+     * @return nsInvalidIndex if there is no such frame.
+     */
+    nsUInt32 FindFrameWithFlags(nsUInt32 in_uiFrame, nsUInt8 in_uiFlags) const;
+
+    /**
+     * @brief Decompresses the records of a frame.
+     * @param in_uiFrame Index of the frame.
+     * @param out_payload Receives the uncompressed records, see GetRecords().
+     */
+    nsResult ReadFrame(nsUInt32 in_uiFrame, nsDynamicArray<nsUInt8>& out_payload) const;
+
+    /**
+     * @brief Restores data that was stored with the given compression, e.g. a frame payload or JPHShapeDictionary geometry.
+     *
+     * Zstd data is the output of nsCompressedStreamWriterZstd. The data may come from a corrupt file or a peer, so it is fully validated,
+     * and the output only grows with what the stream actually decompresses to, not with the stored size.
+     * @param in_eCompression How the data was compressed.
+     * @param in_storedData The stored bytes, nothing else may follow them.
+     * @param in_uiUncompressedSize The size the data has to decompress to.
+     * @param out_payload Receives the uncompressed data.
+     * @return NS_FAILURE if the data is truncated, corrupt, or does not decompress to exactly the expected size.
+     */
+    static nsResult DecompressPayload(JPHPVDCompression in_eCompression, nsArrayPtr<const nsUInt8> in_storedData, nsUInt32 in_uiUncompressedSize, nsDynamicArray<nsUInt8>& out_payload);
+
+    /**
+     * @brief Splits a payload returned by ReadFrame() into its records.
+     */
+    static nsResult GetRecords(nsArrayPtr<const nsUInt8> in_payload, nsDynamicArray<Record>& out_records);
+
+    /**
+     * @brief Returns a string of the dictionary, or an empty string for unknown IDs.
+     */
+    nsStringView GetString(nsUInt32 in_uiID) const;
+
+    /**
+     * @brief Returns a shape of the dictionary, or nullptr for unknown IDs.
+     */
+    const ShapeInfo* GetShape(nsUInt32 in_uiID) const;
+
+    /**
+     * @brief Returns the geometry of a JPHShapeDictionary ID as referenced by encoded frames, or an empty array for unknown IDs.
+     *
+     * The data points into the mapped file, JPHShapeDictionary::DecodeGeometry() turns it into a triangle mesh.
+     */
+    nsArrayPtr<const nsUInt8> GetShapeGeometry(nsUInt32 in_uiShapeID) const;
+
+    /**
+     * @brief Returns whether the capture contains the per-body time series, see JPHPVDFileManager::SetBodySeriesEnabled().
+     */
+    bool HasBodySeries() const { return !m_SeriesIndex.IsEmpty(); }
+
+    /**
+     * @brief Reads the history of one body from the per-body time series, without decoding any frame.
+     *
+     * Only the series chunks that overlap the step range are looked at, and of those only the samples of the body.
+     * @param in_uiBodyID JPH::BodyID::GetIndexAndSequenceNumber() of the body.
+     * @param in_uiFirstStep The first step of interest.
+     * @param in_uiLastStep The last step of interest (inclusive).
+     * @param out_samples Receives the samples in step order. A sample exists for every step in which the body was sent, see JPHPVDBodySample.
+     * @return NS_FAILURE if the capture has no time series or a chunk is corrupt.
+     */
+    nsResult ReadBodySeries(nsUInt32 in_uiBodyID, nsUInt64 in_uiFirstStep, nsUInt64 in_uiLastStep, nsDynamicArray<JPHPVDBodySample>& out_samples) const;
+
+    /**
+     * @brief Returns the Jolt version (major, minor, patch) of the application that wrote the capture.
+     */
+    const nsUInt8* GetJoltVersion() const { return m_uiJoltVersion; }
+
+  private:
+    nsResult ReadChunkAt(nsUInt64 uiOffset, nsStringView sExpectedName, nsUInt32& out_uiVersion, nsArrayPtr<const nsUInt8>& out_data) const;
+    nsResult ReadCaptureChunk();
+    nsResult ReadIndexChunk(nsUInt64 uiOffset, nsDynamicArray<nsUInt64>& out_dictionaryOffsets);
+    nsResult ReadDictionaryChunk(nsUInt64 uiOffset);
+    nsResult ReadBodySeriesChunk(const JPHPVDSeriesIndexEntry& entry, nsUInt32 uiBodyID, nsUInt64 uiFirstStep, nsUInt64 uiLastStep, nsDynamicArray<JPHPVDBodySample>& out_samples) const;
+
+    nsMemoryMappedFile m_File;
+    const nsUInt8* m_pData = nullptr;
+    nsUInt64 m_uiFileSize = 0;
+
+    nsUInt8 m_uiJoltVersion[3] = {};
+    nsDynamicArray<JPHPVDFrameIndexEntry> m_FrameIndex;
+    bool m_bContiguousSteps = false; ///< If every step was captured, a frame index can be computed from the step index directly.
+    nsDynamicArray<JPHPVDSeriesIndexEntry> m_SeriesIndex;
+
+    nsHashTable<nsUInt32, nsString> m_Strings;
+    nsHashTable<nsUInt32, ShapeInfo> m_Shapes;
+    nsHashTable<nsUInt32, nsArrayPtr<const nsUInt8>> m_ShapeGeometry;
+  };
+} // namespace JDebug::API::IO
@@ -0,0 +1,79 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/BodyActivationListener.h>
+#include <Jolt/Physics/Body/BodyID.h>
+
+namespace JPH
+{
+  class PhysicsSystem;
+}
+
+namespace JDebug::API
+{
+  /**
+   * @class JPHActivationTracker
+   * @brief A JPH::BodyActivationListener that remembers which bodies woke up or fell asleep since it was last asked.
+   *
+   * Together with the active body list of the physics system, this tells which bodies can have changed in a step, without
+   * looking at the sleeping ones. Bodies that are changed without waking them up, e.g. with EActivation::DontActivate, are not reported.
+   *
+   * Jolt calls the listener from its jobs, the transitions are collected under a mutex, a step only has few of them.
+   * All callbacks are forwarded to the chained listener, which is usually the one the application had installed before.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHActivationTracker final : public JPH::BodyActivationListener
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHActivationTracker);
+
+  public:
+    JPHActivationTracker();
+    ~JPHActivationTracker();
+
+    /**
+     * @brief Installs the tracker as body activation listener of the physics system and chains the listener that was installed before.
+     *
+     * Must not be called while the physics system is updated.
+     */
+    void Attach(JPH::PhysicsSystem& inout_system);
+
+    /**
+     * @brief Restores the chained listener on the physics system the tracker was attached to.
+     */
+    void Detach();
+
+    /**
+     * @brief Returns whether the tracker is attached to a physics system.
+     */
+    bool IsAttached() const { return m_pAttachedSystem != nullptr; }
+
+    /**
+     * @brief Returns the listener that receives all callbacks after the tracker.
+     */
+    JPH::BodyActivationListener* GetChainedListener() const { return m_pChainedListener; }
+
+    /**
+     * @brief Moves the bodies that were activated or deactivated since the last call into out_bodies. Bodies may be listed more than once.
+     */
+    void RetrieveTransitions(nsDynamicArray<JPH::BodyID>& out_bodies);
+
+  public:
+    // JPH::BodyActivationListener
+    virtual void OnBodyActivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData) override;
+    virtual void OnBodyDeactivated(const JPH::BodyID& inBodyID, JPH::uint64 inBodyUserData) override;
+
+  private:
+    JPH::BodyActivationListener* m_pChainedListener = nullptr;
+    JPH::PhysicsSystem* m_pAttachedSystem = nullptr;
+
+    nsMutex m_Mutex;
+    nsDynamicArray<JPH::BodyID> m_Transitions; ///< Bodies that woke up or fell asleep since the last RetrieveTransitions().
+  };
+} // namespace JDebug::API
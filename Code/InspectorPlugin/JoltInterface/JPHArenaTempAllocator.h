@@ -0,0 +1,71 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Memory/CommonAllocators.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Core/TempAllocator.h>
+
+namespace JDebug::API
+{
+  /**
+   * @struct JPHTempAllocatorStats
+   * @brief Usage of a JPHArenaTempAllocator, see JPHArenaTempAllocator::GetStats().
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHTempAllocatorStats
+  {
+    nsUInt32 m_uiCapacity = 0;               ///< Size of the arena in bytes.
+    nsUInt32 m_uiUsed = 0;                   ///< Bytes of the arena that are currently allocated.
+    nsUInt64 m_uiHighWaterMark = 0;          ///< Most bytes that were allocated at the same time, arena and heap together. The capacity that would have avoided all fallbacks.
+    nsUInt64 m_uiNumAllocations = 0;         ///< Allocations since construction or the last ResetStats().
+    nsUInt64 m_uiNumFallbackAllocations = 0; ///< Allocations that did not fit into the arena and went to the heap.
+    nsUInt64 m_uiFallbackBytes = 0;          ///< Bytes of the fallback allocations that are currently alive.
+    nsUInt64 m_uiFallbackHighWaterMark = 0;  ///< Most bytes of fallback allocations that were alive at the same time.
+  };
+
+  /**
+   * @class JPHArenaTempAllocator
+   * @brief A JPH::TempAllocator that allocates from one block of memory and falls back to the heap instead of aborting when it is full.
+   *
+   * Works like JPH::TempAllocatorImpl: Jolt frees temporary memory in reverse order, so the arena is a stack. The arena and the fallback
+   * allocations come from a "Jolt/TempAllocator" proxy allocator, so they show up in nsMemoryTracker. A fallback allocation costs a heap
+   * allocation in the middle of the step, the first one after construction or ResetStats() logs a warning with the capacity that
+   * would have been needed. The high-water mark tells how large the arena has to be for the worlds that were simulated.
+   *
+   * Like JPH::TempAllocatorImpl it is not thread safe, Jolt never uses it from two threads at the same time.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHArenaTempAllocator final : public JPH::TempAllocator
+  {
+  public:
+    /**
+     * @brief Allocates the arena.
+     * @param in_uiCapacity Size of the arena in bytes.
+     * @param in_pParent The allocator the arena comes from. Defaults to the aligned allocator, Jolt needs JPH_RVECTOR_ALIGNMENT.
+     */
+    explicit JPHArenaTempAllocator(nsUInt32 in_uiCapacity, nsAllocator* in_pParent = nullptr);
+    ~JPHArenaTempAllocator();
+
+    virtual void* Allocate(JPH::uint inSize) override;
+    virtual void Free(void* inAddress, JPH::uint inSize) override;
+
+    /**
+     * @brief Returns the current usage and the statistics since construction or the last ResetStats().
+     */
+    const JPHTempAllocatorStats& GetStats() const { return m_Stats; }
+
+    /**
+     * @brief Resets the high-water marks and counters to the current usage, e.g. after a level was loaded.
+     */
+    void ResetStats();
+
+  private:
+    nsProxyAllocator m_Allocator;
+    nsUInt8* m_pArena = nullptr;
+    JPHTempAllocatorStats m_Stats;
+    bool m_bFallbackReported = false;
+  };
+} // namespace JDebug::API
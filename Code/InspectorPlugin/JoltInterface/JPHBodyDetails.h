@@ -0,0 +1,144 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Math/BoundingBox.h>
+#include <Foundation/Math/Quat.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <InspectorPlugin/JoltInterface/JPHContactRecorder.h>
+
+namespace JPH
+{
+  class Body;
+  class PhysicsSystem;
+} // namespace JPH
+
+namespace JDebug::API
+{
+  class JPHShapeDictionary;
+
+  /**
+   * @struct JPHBodyContactDetail
+   * @brief One contact of a body, seen from that body.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHBodyContactDetail
+  {
+    nsUInt32 m_uiOtherBodyID = 0;                      ///< JPH::BodyID::GetIndexAndSequenceNumber() of the body that is touched.
+    nsUInt32 m_uiSubShapeID = 0;                       ///< JPH::SubShapeID::GetValue() on this body.
+    nsUInt32 m_uiOtherSubShapeID = 0;                  ///< JPH::SubShapeID::GetValue() on the other body.
+    nsVec3 m_vNormal = nsVec3::MakeZero();             ///< World space normal, pointing from this body to the other one.
+    float m_fPenetration = 0.0f;                       ///< Penetration depth along the normal.
+    float m_fImpulse = 0.0f;                           ///< Estimated normal impulse, see JPHContactRecorder.
+    JPHContactEvent m_eEvent = JPHContactEvent::Added; ///< The callback that reported the contact.
+    nsUInt8 m_uiFlags = 0;                             ///< JPHContactRecord::Flags
+  };
+
+  /**
+   * @struct JPHBodyDetail
+   * @brief Everything about one body that is not part of the frames, fetched on demand, see JPHBodyDetailResolver.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHBodyDetail
+  {
+    nsUInt32 m_uiBodyID = 0;                            ///< JPH::BodyID::GetIndexAndSequenceNumber() as requested.
+    bool m_bFound = false;                              ///< Whether the body exists. All other members are only set if it does.
+    bool m_bActive = false;                             ///< Whether the body is awake.
+    bool m_bSensor = false;                             ///< Whether the body is a sensor.
+    bool m_bAllowSleeping = false;                      ///< Whether the body may go to sleep. Always false for static bodies.
+    nsUInt8 m_uiMotionType = 0;                         ///< JPH::EMotionType
+    nsUInt8 m_uiMotionQuality = 0;                      ///< JPH::EMotionQuality, zero for static bodies.
+    nsUInt32 m_uiObjectLayer = 0;                       ///< JPH::ObjectLayer
+    nsUInt64 m_uiUserData = 0;                          ///< JPH::Body::GetUserData()
+    nsUInt32 m_uiCollisionGroupID = 0;                  ///< JPH::CollisionGroup::GetGroupID()
+    nsUInt32 m_uiCollisionSubGroupID = 0;               ///< JPH::CollisionGroup::GetSubGroupID()
+    bool m_bHasGroupFilter = false;                     ///< Whether the collision group has a filter, only then the group IDs matter.
+    float m_fFriction = 0.0f;                           ///< Friction coefficient.
+    float m_fRestitution = 0.0f;                        ///< Restitution coefficient.
+    float m_fMass = 0.0f;                               ///< Mass in kg, zero for bodies with infinite mass.
+    nsVec3 m_vInertiaDiagonal = nsVec3::MakeZero();     ///< Principal moments of inertia in kg m^2, zero on axes with infinite inertia.
+    nsQuat m_qInertiaRotation = nsQuat::MakeIdentity(); ///< Rotation from the principal axes to the space of the body.
+    float m_fLinearDamping = 0.0f;                      ///< Linear damping, zero for static bodies.
+    float m_fAngularDamping = 0.0f;                     ///< Angular damping, zero for static bodies.
+    float m_fGravityFactor = 0.0f;                      ///< Gravity factor, zero for static bodies.
+    float m_fMaxLinearVelocity = 0.0f;                  ///< Velocity clamp in m/s, zero for static bodies.
+    float m_fMaxAngularVelocity = 0.0f;                 ///< Velocity clamp in rad/s, zero for static bodies.
+    nsVec3 m_vCenterOfMass = nsVec3::MakeZero();        ///< World space center of mass.
+    nsUInt32 m_uiShapeID = 0;                           ///< ID of the shape in the JPHShapeDictionary, JPHShapeDictionary::s_uiInvalidShapeID if it was never streamed.
+    nsUInt8 m_uiShapeType = 0;                          ///< JPH::EShapeType
+    nsUInt8 m_uiShapeSubType = 0;                       ///< JPH::EShapeSubType
+    nsBoundingBox m_ShapeBounds;                        ///< Local bounds of the shape, relative to the center of mass.
+    float m_fShapeVolume = 0.0f;                        ///< Volume of the shape in m^3.
+    nsDynamicArray<JPHBodyContactDetail> m_Contacts;    ///< The contacts of the body in the step, as far as the JPHContactRecorder kept them.
+  };
+
+  /**
+   * @struct JPHBodyDetailBatch
+   * @brief The details of all bodies requested during one step.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHBodyDetailBatch
+  {
+    nsUInt64 m_uiStepIndex = 0;              ///< The step the details were taken after.
+    bool m_bHasContacts = false;             ///< Whether a contact recorder was attached. Without it, the contact lists are empty.
+    nsDynamicArray<JPHBodyDetail> m_Details; ///< One entry per requested body, in the order of the requests.
+
+    /**
+     * @brief Serializes the batch for the network stream.
+     *
+     * Layout: u64 step index, u8 flags (bit 0: has contacts), varuint body count, per body: u32 body ID, u8 flags (bit 0: found,
+     * bit 1: active, bit 2: sensor, bit 3: allow sleeping, bit 4: has group filter). Found bodies continue with u8 motion type, u8 motion quality,
+     * varuint object layer, u64 user data, u32 collision group and sub group ID, float friction, restitution and mass, float3 inertia diagonal,
+     * float4 inertia rotation, float linear and angular damping, gravity factor, max linear and angular velocity, float3 center of mass,
+     * u32 shape ID, u8 shape type and sub type, float3 shape bounds min and max, float shape volume, varuint contact count, per contact:
+     * u32 other body ID, u32 sub shape ID, u32 other sub shape ID, float3 normal, float penetration, float impulse, u8 event, u8 flags.
+     */
+    void Write(nsDynamicArray<nsUInt8>& out_data) const;
+
+    /**
+     * @brief Reads data written by Write().
+     */
+    nsResult Read(nsArrayPtr<const nsUInt8> in_data);
+  };
+
+  /**
+   * @class JPHBodyDetailResolver
+   * @brief Looks up the details of requested bodies after a physics step.
+   *
+   * The frames only carry what changes every step. Mass properties, materials, collision groups and contacts are only needed for the
+   * few bodies the user inspects, so the client asks for them with Protocol::s_uiMsgBodyDetailRequest. JPHDebuggerInterface queues the
+   * requests and resolves all of them once per step, in one batch, instead of pushing the details of every body every frame.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHBodyDetailResolver
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHBodyDetailResolver);
+
+  public:
+    JPHBodyDetailResolver();
+    ~JPHBodyDetailResolver();
+
+    /**
+     * @brief Reads the details of the given bodies.
+     *
+     * Locks every body for reading through the locking body lock interface, so it must not be called while the calling thread holds a body lock.
+     * @param in_system The physics system the bodies belong to.
+     * @param in_pShapeDictionary Provides the shape IDs. If nullptr, the shape IDs are JPHShapeDictionary::s_uiInvalidShapeID.
+     * @param in_pContactRecorder Provides the contacts of the step. If nullptr, the contact lists are empty.
+     * @param in_bodyIDs JPH::BodyID::GetIndexAndSequenceNumber() of the bodies, each ID should be listed once. IDs of removed bodies result in
+     *                   entries that are not found.
+     * @param inout_batch Receives one entry per ID, the step index is left untouched.
+     */
+    void Resolve(const JPH::PhysicsSystem& in_system, const JPHShapeDictionary* in_pShapeDictionary, const JPHContactRecorder* in_pContactRecorder,
+      nsArrayPtr<const nsUInt32> in_bodyIDs, JPHBodyDetailBatch& inout_batch);
+
+    /**
+     * @brief Fills everything but the contacts from a body. m_uiBodyID and m_Contacts are left untouched.
+     */
+    static void ReadBody(const JPH::Body& in_body, const JPHShapeDictionary* in_pShapeDictionary, JPHBodyDetail& out_detail);
+
+  private:
+    nsHashTable<nsUInt32, nsUInt32> m_DetailIndices; ///< Body ID to its entry in the batch, to sort the contacts in with one pass.
+  };
+} // namespace JDebug::API
@@ -0,0 +1,105 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Math/Quat.h>
+#include <Foundation/Math/Vec3.h>
+#include <Foundation/Time/Time.h>
+
+namespace JPH
+{
+  class Body;
+}
+
+namespace JDebug::API
+{
+  /**
+   * @struct JPHBodySnapshot
+   * @brief Structure-of-arrays copy of the simulation state of all bodies after one physics step.
+   *
+   * All arrays are indexed by the body slot, which is the index part of the JPH::BodyID. Slot N therefore refers to the
+   * same body in two consecutive snapshots as long as its body ID did not change, which is what the frame encoder relies on
+   * to compute deltas. Unused slots have the JPHBodyStateFlags::Valid bit cleared.
+   *
+   * The arrays only ever grow, so a snapshot that is reused every step does not allocate in the steady state.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHBodySnapshot
+  {
+    /**
+     * @brief Bits stored per body in m_States.
+     */
+    struct JPHBodyStateFlags
+    {
+      using StorageType = nsUInt8;
+
+      enum Enum : nsUInt8
+      {
+        Valid = NS_BIT(0),    ///< The slot holds a body.
+        Active = NS_BIT(1),   ///< The body is awake. Bodies without this bit are sleeping or static.
+        Sensor = NS_BIT(2),   ///< The body is a sensor.
+        SoftBody = NS_BIT(3), ///< The body is a soft body.
+
+        Default = 0
+      };
+    };
+
+    /**
+     * @brief Resizes all arrays to hold the given number of body slots.
+     *
+     * Memory is only reallocated when the slot count grows beyond the current capacity.
+     * @param in_uiNumSlots The number of body slots.
+     */
+    void SetSlotCount(nsUInt32 in_uiNumSlots);
+
+    /**
+     * @brief Marks all slots as unused and resets everything they hold, so unused slots compare and hash the same in every snapshot.
+     */
+    void ClearSlots();
+
+    /**
+     * @brief Marks one slot as unused and resets everything it holds, see ClearSlots().
+     *
+     * Different slots may be cleared from different threads at the same time.
+     */
+    void ClearSlot(nsUInt32 in_uiSlot);
+
+    /**
+     * @brief Copies the state of a body into the given slot. The shape ID is left untouched, it depends on the dictionary the caller uses.
+     *
+     * Different slots may be written from different threads at the same time.
+     */
+    void CaptureBody(const JPH::Body& in_body, nsUInt32 in_uiSlot);
+
+    /**
+     * @brief Returns the number of body slots in this snapshot.
+     */
+    nsUInt32 GetSlotCount() const { return m_BodyIDs.GetCount(); }
+
+    /**
+     * @brief Returns whether the given slot holds a body.
+     */
+    bool IsValid(nsUInt32 in_uiSlot) const { return (m_States[in_uiSlot] & JPHBodyStateFlags::Valid) != 0; }
+
+    /**
+     * @brief Returns whether the body in the given slot is awake.
+     */
+    bool IsActive(nsUInt32 in_uiSlot) const { return (m_States[in_uiSlot] & JPHBodyStateFlags::Active) != 0; }
+
+    nsUInt64 m_uiStepIndex = 0; ///< The physics step this snapshot was captured in.
+    nsTime m_CaptureDuration;   ///< How long it took to capture this snapshot.
+
+    nsDynamicArray<nsUInt32> m_BodyIDs;         ///< JPH::BodyID::GetIndexAndSequenceNumber(), or JPH::BodyID::cInvalidBodyID for unused slots.
+    nsDynamicArray<nsVec3> m_Positions;         ///< World space position of the body.
+    nsDynamicArray<nsQuat> m_Rotations;         ///< World space rotation of the body.
+    nsDynamicArray<nsVec3> m_LinearVelocities;  ///< Linear velocity of the center of mass.
+    nsDynamicArray<nsVec3> m_AngularVelocities; ///< Angular velocity.
+    nsDynamicArray<nsUInt8> m_MotionTypes;      ///< JPH::EMotionType.
+    nsDynamicArray<nsUInt8> m_States;           ///< Combination of JPHBodyStateFlags.
+    nsDynamicArray<nsUInt32> m_ObjectLayers;    ///< JPH::ObjectLayer.
+    nsDynamicArray<nsUInt32> m_ShapeIDs;        ///< ID of the body's shape in the JPHShapeDictionary, JPHShapeDictionary::s_uiInvalidShapeID for unused slots.
+  };
+} // namespace JDebug::API
@@ -0,0 +1,184 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Time/Time.h>
+
+namespace JDebug::API
+{
+  /**
+   * @brief The fidelity levels JPHCaptureThrottle steps through, from the most to the least expensive one.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHCaptureFidelity
+  {
+    using StorageType = nsUInt8;
+
+    enum Enum : nsUInt8
+    {
+      Full,              ///< The configured instruction level and encoder settings.
+      RelaxedTolerances, ///< The encoder tolerances are widened by JPHCaptureBudget::m_fToleranceScale.
+      NoVelocities,      ///< Additionally, velocities are not sent (at most JDIL_Line).
+      HalfRate,          ///< Additionally, each body is only checked for changes every second frame.
+      StatesOnly,        ///< Only body states are sent (JDIL_Function), each body is checked every fourth frame.
+
+      ENUM_COUNT,
+      Default = Full
+    };
+
+    /**
+     * @brief Returns the display name of a level.
+     */
+    static const char* GetName(Enum in_eFidelity);
+
+    /**
+     * @brief Returns the encoder send rate of a level, see JPHFrameEncoder::SetSendRate().
+     */
+    static nsUInt32 GetSendRate(Enum in_eFidelity);
+  };
+
+  /**
+   * @struct JPHCaptureBudget
+   * @brief The CPU time the debugger may spend in JPHDebuggerInterface::FrameEnd() to capture, encode and publish a frame.
+   *
+   * If both limits are set, the smaller one applies. Without any limit the debugger is not throttled.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHCaptureBudget
+  {
+    bool m_bEnabled = false;                                    ///< Whether the capture is throttled at all.
+    nsTime m_MaxTime = nsTime::MakeFromMicroseconds(500);       ///< Absolute budget per frame, zero for none.
+    float m_fMaxStepFraction = 0.03f;                           ///< Budget as a fraction of the time between FrameStart() and FrameEnd(), zero for none.
+    float m_fRestoreThreshold = 0.6f;                           ///< Fidelity is raised once the next higher level is predicted to stay below this fraction of the budget.
+    nsUInt32 m_uiRestoreDelay = 30;                             ///< Frames in a row that need headroom before fidelity is raised by one level.
+    float m_fToleranceScale = 4.0f;                             ///< Factor for the encoder tolerances from JPHCaptureFidelity::RelaxedTolerances on.
+    nsTime m_StatsInterval = nsTime::MakeFromMilliseconds(250); ///< How often the throttle state is published through nsStats.
+  };
+
+  /**
+   * @class JPHCaptureThrottle
+   * @brief Keeps the cost of capturing and publishing debugger frames within a JPHCaptureBudget.
+   *
+   * The throttle learns how long the snapshot capture and the encoding of a frame take per body slot, separately for each fidelity level
+   * and for delta frames and keyframes. Before a frame is captured it predicts the cost of the frame at each level and picks the
+   * most detailed level that fits into the budget. If no level fits, the frame is skipped, the encoder keeps comparing against what it sent
+   * last, so nothing is lost but time resolution. Fidelity drops right away, but is only raised again after the next higher level fit with
+   * headroom for a number of frames, so the level does not flip back and forth at the edge of the budget.
+   *
+   * The first frame after Reset() is not representative, it sends all shapes and grows the buffers, so it is not learned from.
+   * Levels that were not measured yet are estimated from measured ones with fixed relative weights. Publishing is only started if the
+   * measured capture time leaves room for it, so a frame can only exceed the budget by the part of the capture that was underestimated.
+   * While frames are skipped, the estimates slowly decrease, so the capture is eventually tried again to learn whether the cost went down.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHCaptureThrottle
+  {
+  public:
+    JPHCaptureThrottle();
+
+    /**
+     * @brief Changes the budget. Keeps the learned costs.
+     */
+    void SetBudget(const JPHCaptureBudget& in_budget);
+
+    /**
+     * @brief Starts over at full fidelity, called when publishing starts. Keeps the learned costs, the first frame drops to the level they allow.
+     */
+    void Reset();
+
+    /**
+     * @brief Returns the budget.
+     */
+    const JPHCaptureBudget& GetBudget() const { return m_Budget; }
+
+    /**
+     * @brief Computes the budget of the current frame.
+     * @param in_stepTime The time the application spent on the step, zero if unknown.
+     * @return The budget, or zero if the frame is not limited.
+     */
+    nsTime ComputeFrameBudget(nsTime in_stepTime) const;
+
+    /**
+     * @brief Picks the fidelity for the current frame.
+     *
+     * @param in_frameBudget The result of ComputeFrameBudget().
+     * @param in_uiNumSlots The number of body slots that will be captured.
+     * @param in_keyframePending Per fidelity level, whether the encoder would write a keyframe at that level.
+     * @return False if the frame has to be skipped, nothing should be captured or published then. The frame is counted as skipped.
+     */
+    bool BeginFrame(nsTime in_frameBudget, nsUInt32 in_uiNumSlots, const bool (&in_keyframePending)[JPHCaptureFidelity::ENUM_COUNT]);
+
+    /**
+     * @brief Returns whether the publishing part still fits after the capture took the given time. If not, the frame should be skipped.
+     */
+    bool CanPublish(nsTime in_frameBudget, nsTime in_captureTime, nsUInt32 in_uiNumSlots, bool in_bKeyframe) const;
+
+    /**
+     * @brief Reports the cost of a frame that BeginFrame() allowed and that was published.
+     * @param in_captureTime Time spent capturing the snapshot.
+     * @param in_publishTime Time spent encoding and publishing the frame.
+     * @param in_uiNumSlots The number of body slots of the snapshot.
+     * @param in_bKeyframe Whether the published frame was a keyframe.
+     */
+    void EndFrame(nsTime in_captureTime, nsTime in_publishTime, nsUInt32 in_uiNumSlots, bool in_bKeyframe);
+
+    /**
+     * @brief Reports a frame that was captured but then skipped, because CanPublish() returned false.
+     */
+    void SkipFrame(nsTime in_captureTime, nsUInt32 in_uiNumSlots);
+
+    /**
+     * @brief Returns the fidelity picked by the last BeginFrame().
+     */
+    JPHCaptureFidelity::Enum GetFidelity() const { return m_eFidelity; }
+
+    /**
+     * @brief Returns the number of frames skipped since the throttle was created.
+     */
+    nsUInt64 GetNumSkippedFrames() const { return m_uiNumSkippedFrames; }
+
+    /**
+     * @brief Returns the number of frames that exceeded their budget after all, because the prediction was too low.
+     */
+    nsUInt64 GetNumFramesOverBudget() const { return m_uiNumFramesOverBudget; }
+
+    /**
+     * @brief Publishes the throttle state through nsStats, at most once per JPHCaptureBudget::m_StatsInterval.
+     */
+    void PublishStats(bool in_bForce);
+
+  private:
+    /// Learned cost per body slot, in nanoseconds.
+    struct CostEstimate
+    {
+      double m_fAverage = 0.0;
+      double m_fPeak = 0.0;
+      bool m_bMeasured = false;
+
+      void AddSample(double fValue);
+      void Tick();
+      void Lower();
+      double GetPrediction() const { return nsMath::Max(m_fAverage, m_fPeak); }
+    };
+
+    template <typename Func>
+    void ForEachEstimate(Func func);
+    double PredictCapture(nsUInt32 uiNumSlots) const;
+    double PredictPublish(JPHCaptureFidelity::Enum eFidelity, bool bKeyframe, nsUInt32 uiNumSlots) const;
+
+    JPHCaptureBudget m_Budget;
+    JPHCaptureFidelity::Enum m_eFidelity = JPHCaptureFidelity::Full;
+    nsUInt32 m_uiFramesWithHeadroom = 0;
+    bool m_bWarmUp = true; ///< The first frame after Reset() sends all shapes and grows the buffers, it is not used for the estimates.
+
+    CostEstimate m_Capture;
+    CostEstimate m_Publish[JPHCaptureFidelity::ENUM_COUNT][2]; ///< Per level, delta frames and keyframes.
+
+    nsTime m_FrameBudget;
+    nsTime m_LastCost;
+    nsTime m_MaxCost; ///< Largest frame cost since the stats were last published.
+    nsUInt64 m_uiNumSkippedFrames = 0;
+    nsUInt64 m_uiNumFramesOverBudget = 0;
+    nsTime m_LastStatsTime;
+  };
+} // namespace JDebug::API
@@ -0,0 +1,145 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Threading/ThreadSignal.h>
+#include <Foundation/Types/UniquePtr.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHCaptureRing.h>
+
+namespace JDebug::API
+{
+  namespace IO
+  {
+    class JPHPVDFileManager;
+  }
+
+  /**
+   * @brief What JPHCaptureWriter::Push() does when the queue is full.
+   */
+  enum class JPHCaptureBackpressure : nsUInt8
+  {
+    DropOldest, ///< Discard the oldest queued frame. The capture loses older data but stays as recent as possible.
+    DropNewest, ///< Discard the frame that is being pushed.
+    Stall,      ///< Block the physics thread until the writer made room. Nothing is lost, but a slow disk slows down the simulation.
+  };
+
+  /**
+   * @struct JPHCaptureWriterSettings
+   * @brief Configuration of JPHCaptureWriter.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHCaptureWriterSettings
+  {
+    nsUInt32 m_uiQueueCapacity = 64;                                             ///< Number of frames that can be in flight, rounded up to a power of two.
+    JPHCaptureBackpressure m_eBackpressure = JPHCaptureBackpressure::DropOldest; ///< What to do when the queue is full.
+    nsTime m_StatsInterval = nsTime::MakeFromMilliseconds(250);                  ///< How often the queue statistics are published through nsStats.
+  };
+
+  /**
+   * @class JPHCaptureWriter
+   * @brief Writes encoded frames into a capture file on a dedicated thread.
+   *
+   * The physics thread only moves the frame into a lock-free ring, so neither a slow disk nor compression add to the step time
+   * (unless JPHCaptureBackpressure::Stall is selected). Dropped frames leave a gap in the delta chain, the writer therefore
+   * skips frames after a gap until the next keyframe, and Push() reports drops so the producer can request a keyframe right away.
+   *
+   * The writer thread publishes "JDebug/Capture/Queue Depth", "JDebug/Capture/Dropped Frames" and "JDebug/Capture/Write Latency" through nsStats.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHCaptureWriter
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHCaptureWriter);
+
+  public:
+    JPHCaptureWriter();
+    ~JPHCaptureWriter();
+
+    /**
+     * @brief Starts the writer thread.
+     * @param inout_sink The capture file to write into. Must be open and must not be accessed by anyone else until Stop() returns.
+     * @param in_settings Queue size and backpressure policy.
+     */
+    void Start(IO::JPHPVDFileManager& inout_sink, const JPHCaptureWriterSettings& in_settings = JPHCaptureWriterSettings());
+
+    /**
+     * @brief Writes all queued frames and stops the writer thread. The capture file is not closed.
+     */
+    void Stop();
+
+    /**
+     * @brief Returns whether the writer thread is running.
+     */
+    bool IsRunning() const { return m_pThread != nullptr; }
+
+    /**
+     * @brief Queues an encoded frame for writing. Must only be called from one thread.
+     * @param inout_data The encoded frame. The buffer is swapped into the queue, afterwards it holds a recycled buffer with undefined content.
+     * @param in_uiStepIndex The physics step the frame belongs to.
+     * @param in_bKeyframe Whether the frame can be decoded on its own.
+     * @param in_records Further records of the step, e.g. contacts, formatted with IO::JPHPVDFileManager::AppendRecord(). They are copied.
+     * @return False if a frame had to be dropped. The next pushed frame should be a keyframe, otherwise the writer skips frames until one arrives.
+     */
+    bool Push(nsDynamicArray<nsUInt8>& inout_data, nsUInt64 in_uiStepIndex, bool in_bKeyframe, nsArrayPtr<const nsUInt8> in_records = nsArrayPtr<const nsUInt8>());
+
+    /**
+     * @brief Queues the geometry of a JPHShapeDictionary entry, it is written into the capture before the next frame.
+     *
+     * Shapes bypass the frame queue and are never dropped, since every later frame may reference them. Can be called from any thread.
+     */
+    void PushShape(nsUInt32 in_uiShapeID, nsArrayPtr<const nsUInt8> in_data);
+
+    /**
+     * @brief Returns the number of frames that were dropped or skipped since Start().
+     */
+    nsUInt32 GetNumDroppedFrames() const { return static_cast<nsUInt32>(m_iDroppedFrames); }
+
+  private:
+    class WriterThread : public nsThread
+    {
+    public:
+      WriterThread(JPHCaptureWriter* pOwner);
+
+    private:
+      virtual nsUInt32 Run() override;
+
+      JPHCaptureWriter* m_pOwner = nullptr;
+    };
+
+    nsUInt32 RunWriter();
+    void WriteQueuedFrames();
+    void WritePendingShapes();
+    void PublishStats(bool bForce);
+
+    JPHCaptureWriterSettings m_Settings;
+    IO::JPHPVDFileManager* m_pSink = nullptr;
+    nsUniquePtr<IO::JPHCaptureRing> m_pRing;
+    nsUniquePtr<WriterThread> m_pThread;
+
+    nsThreadSignal m_FramesAvailable;
+    nsThreadSignal m_SpaceAvailable;
+    nsAtomicBool m_bStopRequested;
+    nsAtomicInteger32 m_iDroppedFrames;
+
+    // shapes are rare, a mutex is good enough
+    nsMutex m_ShapeMutex;
+    nsDynamicArray<nsUInt8> m_PendingShapes; ///< u32 ID, u32 size and the data of every queued shape.
+    nsAtomicBool m_bShapesPending;
+
+    // only accessed by the producer
+    IO::JPHCaptureFrame m_PushFrame;
+    IO::JPHCaptureFrame m_DropFrame;
+    nsUInt64 m_uiNextPushSequence = 0;
+
+    // only accessed by the writer thread
+    IO::JPHCaptureFrame m_WriteFrame;
+    nsDynamicArray<nsUInt8> m_WriteShapes;
+    nsUInt64 m_uiNextWriteSequence = 0;
+    bool m_bWaitForKeyframe = false;
+    nsTime m_LastStatsTime;
+    nsTime m_MaxWriteLatency;
+  };
+} // namespace JDebug::API
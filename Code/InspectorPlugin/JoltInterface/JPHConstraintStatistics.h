@@ -0,0 +1,177 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Constraints/ConstraintManager.h>
+
+namespace JPH
+{
+  class PhysicsSystem;
+  struct PhysicsSettings;
+} // namespace JPH
+
+namespace JDebug::API
+{
+  /**
+   * @brief The value constraints are ranked by, see JPHConstraintMonitor.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHConstraintStressMetric
+  {
+    using StorageType = nsUInt8;
+
+    enum Enum : nsUInt8
+    {
+      LinearImpulse,  ///< JPHConstraintDiagnostics::m_fLinearImpulse, finds constraints that hold the most weight or are pulled apart.
+      AngularImpulse, ///< JPHConstraintDiagnostics::m_fAngularImpulse, finds joints that are twisted against their limits or motors.
+      PositionError,  ///< JPHConstraintDiagnostics::m_fPositionError, finds constraints the solver could not satisfy.
+
+      ENUM_COUNT,
+      Default = LinearImpulse
+    };
+
+    /**
+     * @brief Returns the display name of a metric.
+     */
+    static const char* GetName(Enum in_eMetric);
+  };
+
+  /**
+   * @struct JPHConstraintMonitorSettings
+   * @brief Configuration of the constraint diagnostics of JPHDebuggerInterface.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHConstraintMonitorSettings
+  {
+    bool m_bEnabled = false;                                                        ///< Whether the constraints are measured after the step. They are streamed and captured along with the frames.
+    nsUInt32 m_uiMaxRanked = 32;                                                    ///< How many of the most stressed constraints are kept with all their diagnostics.
+    JPHConstraintStressMetric::Enum m_eMetric = JPHConstraintStressMetric::Default; ///< The value the constraints are ranked and binned by.
+  };
+
+  /**
+   * @struct JPHConstraintDiagnostics
+   * @brief What the solver did with one constraint in the last step.
+   *
+   * The impulses are the lambdas the solver accumulated over all velocity steps, i.e. the impulse the constraint applied during the step.
+   * Constraints that consist of several parts, e.g. a hinge with limits and a motor, report the length of all linear and all angular parts.
+   * Vehicles report the suspension, longitudinal and lateral impulses of their wheels as linear impulse.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHConstraintDiagnostics
+  {
+    nsUInt32 m_uiConstraintIndex = 0;  ///< Index in PhysicsSystem::GetConstraints(). Only valid for the step, removing a constraint moves others.
+    nsUInt32 m_uiBodyIDs[2] = {};      ///< The constrained bodies, JPH::BodyID::cInvalidBodyID if there is no second body.
+    nsUInt64 m_uiUserData = 0;         ///< Constraint::GetUserData(), lets the application identify the constraint.
+    nsUInt8 m_uiSubType = 0;           ///< JPH::EConstraintSubType.
+    float m_fLinearImpulse = 0.0f;     ///< Length of the accumulated linear lambdas in N s.
+    float m_fAngularImpulse = 0.0f;    ///< Length of the accumulated angular lambdas in N m s.
+    float m_fPositionError = 0.0f;     ///< Distance between the attachment points that should coincide, in meters. Zero for types that are not measured.
+    nsUInt32 m_uiNumVelocitySteps = 0; ///< Velocity steps the constraint was solved with at least, see JPHConstraintMonitor.
+    nsUInt32 m_uiNumPositionSteps = 0; ///< Position steps the constraint was solved with at least, see JPHConstraintMonitor.
+
+    /**
+     * @brief Returns the value of the given metric.
+     */
+    float GetStress(JPHConstraintStressMetric::Enum in_eMetric) const;
+  };
+
+  /**
+   * @struct JPHConstraintStatistics
+   * @brief The most stressed constraints of one step and a histogram of all of them, see JPHConstraintMonitor.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHConstraintStatistics
+  {
+    /// Stress values are counted in power of two buckets. Bucket i holds values in [2^(i + s_iFirstBucketExponent), 2^(i + s_iFirstBucketExponent + 1)),
+    /// the first bucket also holds smaller values and zero, the last one also holds larger values.
+    static constexpr nsUInt32 s_uiNumBuckets = 32;
+    static constexpr nsInt32 s_iFirstBucketExponent = -20;
+
+    JPHConstraintStressMetric::Enum m_eMetric = JPHConstraintStressMetric::Default; ///< The metric m_Ranked and m_Histogram are based on.
+    nsUInt32 m_uiNumConstraints = 0;                                                ///< All constraints in the physics system.
+    nsUInt32 m_uiNumActiveConstraints = 0;                                          ///< Constraints that were solved in the step. Only these are ranked and binned.
+    float m_fMaxStress = 0.0f;                                                      ///< The largest stress value of an active constraint.
+    float m_fTotalStress = 0.0f;                                                    ///< Sum of the stress values of all active constraints.
+    float m_fMaxPositionError = 0.0f;                                               ///< The largest position error of an active constraint, independent of the metric.
+    nsUInt32 m_Histogram[s_uiNumBuckets] = {};                                      ///< Number of active constraints per stress bucket.
+    nsDynamicArray<JPHConstraintDiagnostics> m_Ranked;                              ///< The most stressed active constraints, most stressed first.
+
+    /**
+     * @brief Returns the histogram bucket of a stress value.
+     */
+    static nsUInt32 GetBucket(float in_fStress);
+
+    /**
+     * @brief Serializes the statistics for the network stream and the capture file.
+     *
+     * Layout: u8 metric, varuint constraint and active constraint count, float max stress, total stress and max position error,
+     * i8 exponent of the first bucket, u8 bucket count, varuint constraints per bucket, varuint ranked count, per ranked constraint:
+     * varuint constraint index, u8 sub type, u32 body ID 1 and 2, u64 user data, float linear impulse, angular impulse and position error,
+     * varuint velocity and position step count.
+     */
+    void Write(nsDynamicArray<nsUInt8>& out_data) const;
+
+    /**
+     * @brief Reads data written by Write(). Buckets are matched by their exponent, buckets outside the range of this version are clamped.
+     */
+    nsResult Read(nsArrayPtr<const nsUInt8> in_data);
+  };
+
+  /**
+   * @class JPHConstraintMonitor
+   * @brief Measures all constraints after a physics step and keeps the most stressed ones.
+   *
+   * The constraints are measured in chunks on the nsTaskSystem. Every chunk keeps its own shortlist and histogram, which are merged
+   * at the end, so the size of the result only depends on the length of the shortlist, not on the number of constraints.
+   *
+   * Jolt solves all constraints of an island with the same number of steps, the largest of all bodies and constraints in the island.
+   * The island of a constraint is not tracked, so the steps are the ones its own override and the overrides of its bodies ask for,
+   * which is the minimum the constraint was solved with.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHConstraintMonitor
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHConstraintMonitor);
+
+  public:
+    JPHConstraintMonitor();
+    ~JPHConstraintMonitor();
+
+    /**
+     * @brief Measures the constraints of the step that was just simulated.
+     *
+     * Must be called after PhysicsSystem::Update() and while no other thread modifies the bodies or constraints.
+     * @param in_system The physics system that was updated.
+     * @param in_settings The number of ranked constraints and the metric.
+     * @param out_statistics Receives the statistics.
+     */
+    void Collect(const JPH::PhysicsSystem& in_system, const JPHConstraintMonitorSettings& in_settings, JPHConstraintStatistics& out_statistics);
+
+    /**
+     * @brief Measures a single constraint. m_uiConstraintIndex is left untouched.
+     * @param in_constraint The constraint, its bodies must not be modified at the same time.
+     * @param in_pSettings The settings of the physics system, for the default step counts. Without them the step counts are the largest
+     *                     override, zero meaning the default.
+     * @param out_diagnostics Receives the measurements.
+     */
+    static void Measure(const JPH::Constraint& in_constraint, const JPH::PhysicsSettings* in_pSettings, JPHConstraintDiagnostics& out_diagnostics);
+
+  private:
+    /// What one task found in its range of constraints.
+    struct ChunkResult
+    {
+      nsUInt32 m_uiNumActive = 0;
+      nsUInt32 m_uiNumRanked = 0;
+      float m_fMaxStress = 0.0f;
+      float m_fTotalStress = 0.0f;
+      float m_fMaxPositionError = 0.0f;
+      nsUInt32 m_Histogram[JPHConstraintStatistics::s_uiNumBuckets] = {};
+    };
+
+    nsDynamicArray<ChunkResult> m_ChunkResults;        ///< Per chunk, reused between steps.
+    nsDynamicArray<JPHConstraintDiagnostics> m_Ranked; ///< The shortlists of all chunks, m_uiMaxRanked entries per chunk.
+    JPH::Constraints m_Constraints;                    ///< The constraints of the step, the storage is reused between steps.
+  };
+} // namespace JDebug::API
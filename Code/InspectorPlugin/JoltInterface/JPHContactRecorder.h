@@ -0,0 +1,222 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Math/Vec3.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Threading/ThreadUtils.h>
+#include <Foundation/Types/UniquePtr.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Collision/ContactListener.h>
+
+namespace JPH
+{
+  class PhysicsSystem;
+}
+
+namespace JDebug::API
+{
+  /**
+   * @brief The contact callback a JPHContactRecord was created in.
+   */
+  enum class JPHContactEvent : nsUInt8
+  {
+    Added,     ///< JPH::ContactListener::OnContactAdded()
+    Persisted, ///< JPH::ContactListener::OnContactPersisted()
+    Removed,   ///< JPH::ContactListener::OnContactRemoved(), only the body and sub shape IDs are known.
+  };
+
+  /**
+   * @struct JPHContactRecord
+   * @brief One contact manifold between two bodies, as reported to the contact listener during a physics step.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHContactRecord
+  {
+    /// Manifolds with more points are cut down to this many, Jolt reduces most manifolds to four points anyway.
+    static constexpr nsUInt32 s_uiMaxPoints = 4;
+
+    enum Flags : nsUInt8
+    {
+      Sensor = NS_BIT(0),      ///< The contact was treated as a sensor contact, there is no collision response.
+      Speculative = NS_BIT(1), ///< The penetration is negative, the bodies may not actually touch.
+    };
+
+    nsUInt32 m_uiBodyID1 = 0;                          ///< JPH::BodyID::GetIndexAndSequenceNumber() of the first body.
+    nsUInt32 m_uiBodyID2 = 0;                          ///< JPH::BodyID::GetIndexAndSequenceNumber() of the second body.
+    nsUInt32 m_uiSubShapeID1 = 0;                      ///< JPH::SubShapeID::GetValue() on the first body.
+    nsUInt32 m_uiSubShapeID2 = 0;                      ///< JPH::SubShapeID::GetValue() on the second body.
+    nsVec3 m_vNormal;                                  ///< World space normal, pointing from body 1 to body 2.
+    float m_fPenetration = 0.0f;                       ///< Penetration depth along the normal.
+    float m_fImpulse = 0.0f;                           ///< Estimated normal impulse, see JPHContactRecorder.
+    nsVec3 m_vPoints[s_uiMaxPoints];                   ///< World space contact points, halfway between the surfaces of both bodies.
+    JPHContactEvent m_eEvent = JPHContactEvent::Added; ///< The callback that reported the contact.
+    nsUInt8 m_uiFlags = 0;                             ///< Flags
+    nsUInt8 m_uiNumPoints = 0;                         ///< Number of valid entries in m_vPoints.
+  };
+
+  /**
+   * @struct JPHContactRecorderSettings
+   * @brief Configuration of JPHContactRecorder.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHContactRecorderSettings
+  {
+    nsUInt32 m_uiMaxContacts = 4096; ///< Contacts per step that are kept, the ones with the largest impulse win. 0 keeps all contacts.
+    bool m_bRecordPersisted = true;  ///< Whether persisting contacts are recorded, not only added and removed ones.
+  };
+
+  /**
+   * @class JPHContactRecorder
+   * @brief A JPH::ContactListener that records the contacts of every physics step for the debugger.
+   *
+   * Jolt calls the contact listener from all of its narrow phase jobs at the same time. Every thread therefore appends
+   * to its own buffer, which it finds through a thread local cache, the recorder mutex is only taken the first time a thread
+   * reports a contact. CollectContacts() merges the buffers after the step, sorts the result by body pair, so that
+   * it does not depend on the thread scheduling, and keeps the contacts with the largest impulse if there are too many.
+   *
+   * Jolt solves contacts after the listener was called, so the real impulses are not known to it. m_fImpulse is the
+   * approach speed along the normal times the effective mass of the body pair, computed from the velocities at the time of the callback.
+   * That is the impulse needed to stop the bodies, which is what ranks contacts that cause jitter in a stack.
+   *
+   * All callbacks are forwarded to the chained listener, which is usually the one the application had installed before.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHContactRecorder final : public JPH::ContactListener
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHContactRecorder);
+
+  public:
+    JPHContactRecorder();
+    ~JPHContactRecorder();
+
+    /**
+     * @brief Installs the recorder as contact listener of the physics system and chains the listener that was installed before.
+     *
+     * Must not be called while the physics system is updated.
+     */
+    void Attach(JPH::PhysicsSystem& inout_system);
+
+    /**
+     * @brief Restores the chained listener on the physics system the recorder was attached to.
+     */
+    void Detach();
+
+    /**
+     * @brief Sets the listener that receives all callbacks after the recorder, may be nullptr.
+     */
+    void SetChainedListener(JPH::ContactListener* in_pListener) { m_pChainedListener = in_pListener; }
+
+    /**
+     * @brief Returns the listener that receives all callbacks after the recorder.
+     */
+    JPH::ContactListener* GetChainedListener() const { return m_pChainedListener; }
+
+    /**
+     * @brief Changes the settings. Must not be called while the physics system is updated.
+     */
+    void SetSettings(const JPHContactRecorderSettings& in_settings) { m_Settings = in_settings; }
+
+    /**
+     * @brief Returns the current settings.
+     */
+    const JPHContactRecorderSettings& GetSettings() const { return m_Settings; }
+
+    /**
+     * @brief Enables or disables recording. Callbacks are still forwarded while disabled. Must not be called while the physics system is updated.
+     */
+    void SetRecording(bool in_bRecording) { m_bRecording = in_bRecording; }
+
+    /**
+     * @brief Returns whether contacts are recorded.
+     */
+    bool IsRecording() const { return m_bRecording; }
+
+    /**
+     * @brief Merges the contacts that were recorded since the last call and clears the per thread buffers.
+     *
+     * Must be called after PhysicsSystem::Update() and not concurrently to it.
+     */
+    void CollectContacts();
+
+    /**
+     * @brief Returns the contacts merged by the last CollectContacts(), sorted by body pair.
+     */
+    nsArrayPtr<const JPHContactRecord> GetContacts() const { return m_Contacts; }
+
+    /**
+     * @brief Returns the number of contacts the last CollectContacts() discarded because of the m_uiMaxContacts budget.
+     */
+    nsUInt32 GetNumDroppedContacts() const { return m_uiNumDroppedContacts; }
+
+    /**
+     * @brief Returns the number of body pairs whose shapes touched during the steps before the last CollectContacts().
+     *
+     * Jolt reports the manifolds of a body pair one after another on the same thread, a pair is counted whenever it differs
+     * from the previous pair of the thread. Counted also while recording is disabled.
+     */
+    nsUInt32 GetNumBodyPairs() const { return m_uiNumBodyPairs; }
+
+    /**
+     * @brief Returns the number of contact manifolds that were turned into contact constraints during the steps before the last CollectContacts().
+     *
+     * Sensor contacts are not counted. Counted also while recording is disabled.
+     */
+    nsUInt32 GetNumContactConstraints() const { return m_uiNumContactConstraints; }
+
+    /**
+     * @brief Serializes contacts for the network stream and the capture file.
+     *
+     * Layout: u32 contact count, u32 dropped count, per contact: u32 body ID 1, u32 body ID 2, u32 sub shape ID 1, u32 sub shape ID 2,
+     * u8 JPHContactEvent, u8 flags, u8 point count, and unless the event is Removed: float[3] normal, float penetration, float impulse,
+     * float[3] per point.
+     * @param in_contacts The contacts to write.
+     * @param in_uiNumDropped The number of contacts that did not fit into the budget.
+     * @param out_data Receives the data, existing content is replaced.
+     */
+    static void WriteContacts(nsArrayPtr<const JPHContactRecord> in_contacts, nsUInt32 in_uiNumDropped, nsDynamicArray<nsUInt8>& out_data);
+
+    /**
+     * @brief Reads data written by WriteContacts().
+     * @return NS_FAILURE if the data is corrupt.
+     */
+    static nsResult ReadContacts(nsArrayPtr<const nsUInt8> in_data, nsDynamicArray<JPHContactRecord>& out_contacts, nsUInt32& out_uiNumDropped);
+
+  public:
+    // JPH::ContactListener
+    virtual JPH::ValidateResult OnContactValidate(const JPH::Body& inBody1, const JPH::Body& inBody2, JPH::RVec3Arg inBaseOffset, const JPH::CollideShapeResult& inCollisionResult) override;
+    virtual void OnContactAdded(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings) override;
+    virtual void OnContactPersisted(const JPH::Body& inBody1, const JPH::Body& inBody2, const JPH::ContactManifold& inManifold, JPH::ContactSettings& ioSettings) override;
+    virtual void OnContactRemoved(const JPH::SubShapeIDPair& inSubShapePair) override;
+
+  private:
+    struct ThreadBuffer
+    {
+      nsThreadID m_ThreadID = {};
+      nsDynamicArray<JPHContactRecord> m_Contacts;
+      nsUInt64 m_uiLastBodyPair = 0;
+      nsUInt32 m_uiNumBodyPairs = 0;
+      nsUInt32 m_uiNumManifolds = 0;
+    };
+
+    ThreadBuffer& GetThreadBuffer();
+    void CountManifold(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactSettings& settings);
+    void RecordManifold(const JPH::Body& body1, const JPH::Body& body2, const JPH::ContactManifold& manifold, const JPH::ContactSettings& settings, JPHContactEvent eEvent);
+
+    JPHContactRecorderSettings m_Settings;
+    JPH::ContactListener* m_pChainedListener = nullptr;
+    JPH::PhysicsSystem* m_pAttachedSystem = nullptr;
+    bool m_bRecording = true;
+    nsUInt32 m_uiRecorderID = 0; ///< Unique per instance, so a thread local cache never matches a destroyed recorder at the same address.
+
+    nsMutex m_BufferMutex; ///< Only protects adding buffers, the buffers themselves are owned by one thread each.
+    nsDynamicArray<nsUniquePtr<ThreadBuffer>> m_Buffers;
+
+    nsDynamicArray<JPHContactRecord> m_Contacts;
+    nsUInt32 m_uiNumDroppedContacts = 0;
+    nsUInt32 m_uiNumBodyPairs = 0;
+    nsUInt32 m_uiNumContactConstraints = 0;
+  };
+} // namespace JDebug::API
@@ -0,0 +1,275 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Jolt/Jolt.h>
+
+#ifdef JPH_DEBUG_RENDERER
+#  include <Jolt/Renderer/DebugRenderer.h>
+#endif
+
+namespace JDebug::API
+{
+  /**
+   * @brief Layout of the frames written by JPHDebugRenderer.
+   *
+   *   FrameHeader
+   *   varuint count, per new batch:      varuint ID, varuint vertex count, varuint index count (zero for unindexed batches),
+   *                                      per vertex nsVec3 position, 3 x i8 normal, u32 color, indices as zig-zag varint deltas
+   *   varuint count, per removed batch:  varuint ID
+   *   varuint instance count, then runs until all instances are covered:
+   *                                      varuint unchanged count (same as the instance at that index in the previous frame),
+   *                                      varuint changed count, changed count x GeometryInstance
+   *   varuint count, per line color:     u32 color, u8 unchanged, if not unchanged: varuint point count, nsVec3 per point, two per line
+   *   varuint count, per triangle color: u32 color, u8 unchanged, if not unchanged: varuint point count, nsVec3 per point, three per triangle
+   *   the same again for the triangles that cast shadows
+   *   varuint count, per text:           nsVec3 position, u32 color, float height, varuint length, UTF-8 bytes
+   *
+   *   Colors that are missing in a frame were not drawn in it.
+   */
+  namespace DebugDrawFormat
+  {
+    static constexpr nsUInt32 s_uiFrameMagic = 'JDDR';
+    static constexpr nsUInt8 s_uiFrameVersion = 2;
+
+    /**
+     * @brief Bits of the frame header flags.
+     */
+    enum FrameFlags : nsUInt8
+    {
+      Frame_Keyframe = NS_BIT(0), ///< All live batches are sent again and nothing refers to the previous frame.
+    };
+
+    /**
+     * @brief Fixed size part of every frame.
+     */
+    struct FrameHeader
+    {
+      nsUInt32 m_uiMagic = s_uiFrameMagic;
+      nsUInt8 m_uiVersion = s_uiFrameVersion;
+      nsUInt8 m_uiFlags = 0;
+      nsUInt16 m_uiReserved = 0;
+      nsUInt64 m_uiStepIndex = 0;
+    };
+
+    static_assert(sizeof(FrameHeader) == 16, "FrameHeader must not contain implicit padding, it is written to the stream as is");
+
+    /**
+     * @brief One DrawGeometry() call, written to the stream as is.
+     */
+    struct GeometryInstance
+    {
+      float m_Transform[12];      ///< Columns of the model matrix: X, Y and Z axis, translation.
+      nsUInt32 m_uiColor = 0;     ///< JPH::Color::GetUInt32()
+      nsUInt32 m_uiBatchID = 0;   ///< The batch of the selected LOD.
+      nsUInt8 m_uiCullMode = 0;   ///< JPH::DebugRenderer::ECullMode
+      nsUInt8 m_uiDrawMode = 0;   ///< JPH::DebugRenderer::EDrawMode
+      nsUInt8 m_uiCastShadow = 0; ///< JPH::DebugRenderer::ECastShadow
+      nsUInt8 m_uiPadding = 0;
+    };
+
+    static_assert(sizeof(GeometryInstance) == 60, "GeometryInstance must not contain implicit padding, it is written to the stream as is");
+  } // namespace DebugDrawFormat
+
+#ifdef JPH_DEBUG_RENDERER
+
+  /**
+   * @class JPHDebugRenderer
+   * @brief A JPH::DebugRenderer that records what Jolt draws into a compact command stream, so it can be viewed remotely.
+   *
+   * Pass it to PhysicsSystem::DrawBodies(), DrawConstraints() and the like, then hand it to JPHDebuggerInterface::SetDebugRenderer(),
+   * which encodes the recorded frame in FrameEnd() and sends it to the client and the capture.
+   *
+   * Triangle batches are serialized once when Jolt creates them and sent once, DrawGeometry() only records the batch ID,
+   * the transform and the color. Instances that are identical to the instance at the same position in the previous frame are
+   * written as a run length, as are line and triangle lists that did not change, so a frame of mostly sleeping bodies costs
+   * little more than its instance count. Lines and triangles are merged into one list per color.
+   *
+   * All draw functions can be called from any thread. Without a camera position, DrawGeometry() always uses the most detailed LOD.
+   * Only one renderer should be used per application, since Jolt caches the batches of some shapes in the shape.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHDebugRenderer : public JPH::DebugRenderer
+  {
+  public:
+    JPHDebugRenderer();
+    ~JPHDebugRenderer();
+
+    /**
+     * @brief Sets the position that LODs are selected for. Without one, the most detailed LOD is used.
+     */
+    void SetCameraPosition(const nsVec3& in_vPosition);
+
+    /**
+     * @brief Forces the next frame to be a keyframe, e.g. because a new client connected.
+     */
+    void RequestKeyframe();
+
+    /**
+     * @brief Writes everything that was drawn since the last call into a frame and starts a new one.
+     * @param in_uiStepIndex The physics step the frame belongs to.
+     * @param out_data Receives the encoded frame. Existing content is replaced.
+     * @return True if the frame is a keyframe.
+     */
+    bool EncodeFrame(nsUInt64 in_uiStepIndex, nsDynamicArray<nsUInt8>& out_data);
+
+    /**
+     * @brief Discards everything that was drawn since the last EncodeFrame(), e.g. because the frame is not published.
+     */
+    void DiscardFrame();
+
+    /**
+     * @brief Returns the number of batches that are currently alive.
+     */
+    nsUInt32 GetNumBatches() const;
+
+    /**
+     * @brief Returns the number of geometry instances of the last encoded frame that were unchanged since the frame before.
+     */
+    nsUInt32 GetNumUnchangedInstances() const { return m_uiNumUnchangedInstances; }
+
+    // JPH::DebugRenderer
+    virtual void DrawLine(JPH::RVec3Arg inFrom, JPH::RVec3Arg inTo, JPH::ColorArg inColor) override;
+    virtual void DrawTriangle(JPH::RVec3Arg inV1, JPH::RVec3Arg inV2, JPH::RVec3Arg inV3, JPH::ColorArg inColor, ECastShadow inCastShadow) override;
+    virtual Batch CreateTriangleBatch(const Triangle* inTriangles, int inTriangleCount) override;
+    virtual Batch CreateTriangleBatch(const Vertex* inVertices, int inVertexCount, const JPH::uint32* inIndices, int inIndexCount) override;
+    virtual void DrawGeometry(JPH::RMat44Arg inModelMatrix, const JPH::AABox& inWorldSpaceBounds, float inLODScaleSq, JPH::ColorArg inModelColor, const GeometryRef& inGeometry, ECullMode inCullMode, ECastShadow inCastShadow, EDrawMode inDrawMode) override;
+    virtual void DrawText3D(JPH::RVec3Arg inPosition, const std::string_view& inString, JPH::ColorArg inColor, float inHeight) override;
+
+  private:
+    struct BatchRegistry;
+    class BatchHandle;
+
+    struct Text
+    {
+      nsVec3 m_vPosition;
+      nsUInt32 m_uiColor;
+      float m_fHeight;
+      nsString m_sText;
+    };
+
+    /// Merged lines or triangles of one color, the current frame and the one before.
+    struct ColorList
+    {
+      nsDynamicArray<nsVec3> m_Points;
+      nsDynamicArray<nsVec3> m_PrevPoints;
+    };
+
+    void WriteColorLists(nsDynamicArray<nsUInt8>& out_data, nsHashTable<nsUInt32, ColorList>& inout_lists, bool bKeyframe);
+
+    mutable nsMutex m_Mutex;
+    JPH::Ref<BatchRegistry> m_pRegistry; ///< Shared with the batches, which can outlive the renderer.
+    bool m_bKeyframeRequested = true;
+    bool m_bHasCamera = false;
+    JPH::Vec3 m_vCameraPosition = JPH::Vec3::sZero();
+
+    nsDynamicArray<DebugDrawFormat::GeometryInstance> m_Instances;
+    nsDynamicArray<DebugDrawFormat::GeometryInstance> m_PrevInstances;
+    nsHashTable<nsUInt32, ColorList> m_Lines;
+    nsHashTable<nsUInt32, ColorList> m_Triangles;
+    nsHashTable<nsUInt32, ColorList> m_ShadowCastingTriangles;
+    nsDynamicArray<Text> m_Texts;
+    nsUInt32 m_uiNumUnchangedInstances = 0;
+  };
+
+#endif
+
+  /**
+   * @class JPHDebugDrawDecoder
+   * @brief Reconstructs the draw commands from frames written by JPHDebugRenderer.
+   *
+   * Frames build on each other, so all frames since the last keyframe have to be decoded in order.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHDebugDrawDecoder
+  {
+  public:
+    /**
+     * @brief A triangle batch as sent by the renderer.
+     */
+    struct Batch
+    {
+      nsDynamicArray<nsVec3> m_Positions;
+      nsDynamicArray<nsVec3> m_Normals;
+      nsDynamicArray<nsUInt32> m_Colors;
+      nsDynamicArray<nsUInt32> m_Indices; ///< Three per triangle. Empty if every three consecutive vertices form a triangle.
+    };
+
+    /**
+     * @brief A text as sent by the renderer.
+     */
+    struct Text
+    {
+      nsVec3 m_vPosition;
+      nsUInt32 m_uiColor;
+      float m_fHeight;
+      nsString m_sText;
+    };
+
+    /**
+     * @brief Decodes a frame.
+     * @return NS_FAILURE if the data is corrupt or a delta frame arrives before the first keyframe.
+     */
+    nsResult DecodeFrame(nsArrayPtr<const nsUInt8> in_data);
+
+    /**
+     * @brief Forgets all decoded state. The next frame must be a keyframe.
+     */
+    void Reset();
+
+    /**
+     * @brief Returns the step index of the last decoded frame.
+     */
+    nsUInt64 GetStepIndex() const { return m_uiStepIndex; }
+
+    /**
+     * @brief Returns the batch with the given ID, or nullptr if it is not known.
+     */
+    const Batch* GetBatch(nsUInt32 in_uiBatchID) const { return m_Batches.GetValue(in_uiBatchID); }
+
+    /**
+     * @brief Returns the number of known batches.
+     */
+    nsUInt32 GetNumBatches() const { return m_Batches.GetCount(); }
+
+    /**
+     * @brief Returns the geometry instances of the last decoded frame.
+     */
+    const nsDynamicArray<DebugDrawFormat::GeometryInstance>& GetInstances() const { return m_Instances; }
+
+    /**
+     * @brief Returns the lines of the last decoded frame, two points per line, by color.
+     */
+    const nsHashTable<nsUInt32, nsDynamicArray<nsVec3>>& GetLines() const { return m_Lines; }
+
+    /**
+     * @brief Returns the triangles of the last decoded frame that don't cast shadows, three points per triangle, by color.
+     */
+    const nsHashTable<nsUInt32, nsDynamicArray<nsVec3>>& GetTriangles() const { return m_Triangles; }
+
+    /**
+     * @brief Returns the triangles of the last decoded frame that cast shadows, three points per triangle, by color.
+     */
+    const nsHashTable<nsUInt32, nsDynamicArray<nsVec3>>& GetShadowCastingTriangles() const { return m_ShadowCastingTriangles; }
+
+    /**
+     * @brief Returns the texts of the last decoded frame.
+     */
+    const nsDynamicArray<Text>& GetTexts() const { return m_Texts; }
+
+  private:
+    bool m_bHasKeyframe = false;
+    nsUInt64 m_uiStepIndex = 0;
+    nsHashTable<nsUInt32, Batch> m_Batches;
+    nsDynamicArray<DebugDrawFormat::GeometryInstance> m_Instances;
+    nsHashTable<nsUInt32, nsDynamicArray<nsVec3>> m_Lines;
+    nsHashTable<nsUInt32, nsDynamicArray<nsVec3>> m_Triangles;
+    nsHashTable<nsUInt32, nsDynamicArray<nsVec3>> m_ShadowCastingTriangles;
+    nsDynamicArray<Text> m_Texts;
+  };
+} // namespace JDebug::API
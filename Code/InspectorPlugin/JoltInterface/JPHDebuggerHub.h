@@ -0,0 +1,122 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Communication/Telemetry.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+namespace JDebug::API
+{
+  class JPHDebuggerInterface;
+
+  /**
+   * @class JPHDebuggerHub
+   * @brief Serves many JPHDebuggerInterface instances, one per PhysicsSystem, over one telemetry connection.
+   *
+   * Every registered interface becomes a stream with its own ID. Its messages are sent wrapped in Protocol::s_uiMsgStream, so the client
+   * can tell the systems apart, and the shapes, frames and encoders of each stream stay independent. The client learns about the streams
+   * from Protocol::s_uiMsgStreamList and picks the ones it wants to watch with Protocol::s_uiMsgSubscribe. Until it does, a client watches
+   * all streams, so clients that do not know about streams still get data. An interface whose stream is not subscribed behaves as if no
+   * client was connected, so it does not encode anything, unless it writes a capture.
+   *
+   * FrameEnd() ends the frame of all registered interfaces at once, spread over the worker threads of the nsTaskSystem, so a server that
+   * steps all of its systems before publishing shares one pool of encoder threads among them. Interfaces can also keep calling their own
+   * FrameEnd() from the thread that steps their system. Each interface collects its own step statistics, to time the phases of
+   * systems that are stepped at the same time, give each of them a JPHTaskJobSystem of its own, see JPHDebuggerInterface::SetJobSystem().
+   *
+   * Register() and Unregister() must not be called while any registered interface is in FrameEnd().
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHDebuggerHub
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHDebuggerHub);
+
+  public:
+    /**
+     * @brief A client message that was addressed to one stream.
+     */
+    struct Message
+    {
+      nsUInt32 m_uiMessageID = 0;
+      nsDynamicArray<nsUInt8> m_Data;
+    };
+
+    JPHDebuggerHub();
+    ~JPHDebuggerHub();
+
+    /**
+     * @brief Adds an interface as a new stream. The interface must not be registered with another hub.
+     * @param in_sName Shown to the client, e.g. the name of the match the system belongs to.
+     * @return The stream ID. IDs start at 1 and are never reused.
+     */
+    nsUInt32 Register(JPHDebuggerInterface& ref_interface, nsStringView in_sName);
+
+    /**
+     * @brief Removes the stream of an interface. Happens automatically when the interface is destroyed.
+     */
+    void Unregister(JPHDebuggerInterface& ref_interface);
+
+    /**
+     * @brief Returns the number of registered interfaces.
+     */
+    nsUInt32 GetNumStreams() const;
+
+    /**
+     * @brief Replaces the set of streams the client watches, as if the client had sent Protocol::s_uiMsgSubscribe.
+     */
+    void SetSubscription(nsArrayPtr<const nsUInt32> in_streamIDs);
+
+    /**
+     * @brief Returns whether a client is connected and watches the given stream.
+     */
+    bool IsSubscribed(nsUInt32 in_uiStreamID) const;
+
+    /**
+     * @brief Calls JPHDebuggerInterface::FrameEnd() of all registered interfaces, in parallel on the nsTaskSystem.
+     *
+     * Must be called after all systems were stepped and while no other thread modifies their bodies.
+     */
+    void FrameEnd();
+
+    /**
+     * @brief Retrieves the client messages of the connection, handles the ones for the hub and queues the others per stream.
+     *
+     * Called by the interfaces while they end their frame, the application does not need to call it.
+     */
+    void ProcessClientMessages();
+
+    /**
+     * @brief Moves the queued client messages of a stream into out_messages.
+     */
+    void RetrieveMessages(nsUInt32 in_uiStreamID, nsDynamicArray<Message>& out_messages);
+
+  private:
+    struct Stream
+    {
+      JPHDebuggerInterface* m_pInterface = nullptr;
+      nsString m_sName;
+      bool m_bSubscribed = true;
+      nsDynamicArray<Message> m_Messages; ///< Client messages for this stream that the interface did not retrieve yet.
+    };
+
+    Stream* FindStream(nsUInt32 uiStreamID);
+    void SendStreamList();
+    void TelemetryEventHandler(const nsTelemetry::TelemetryEventData& e);
+
+    mutable nsMutex m_Mutex;
+    nsUInt32 m_uiNextStreamID = 1;
+    nsDynamicArray<nsUInt32> m_StreamIDs; ///< Parallel to m_Streams.
+    nsDynamicArray<Stream> m_Streams;
+    bool m_bClientConnected = false;
+    bool m_bClientSubscribed = false; ///< Whether the client picked its streams, before that it watches all of them.
+    nsAtomicBool m_bConnectionChanged; ///< Set from the telemetry thread when a client connects or disconnects.
+    bool m_bStreamListChanged = true;  ///< The client has to be told about the streams, because it connected or they changed.
+    nsDynamicArray<JPHDebuggerInterface*> m_FrameScratch;
+  };
+} // namespace JDebug::API
@@ -5,23 +5,53 @@
  */
 #pragma once
 #include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Communication/Telemetry.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <InspectorPlugin/JoltInterface/JPHActivationTracker.h>
+#include <InspectorPlugin/JoltInterface/JPHBodyDetails.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHCaptureThrottle.h>
+#include <InspectorPlugin/JoltInterface/JPHConstraintStatistics.h>
+#include <InspectorPlugin/JoltInterface/JPHDebuggerHub.h>
+#include <InspectorPlugin/JoltInterface/JPHFrameEncoder.h>
+#include <InspectorPlugin/JoltInterface/JPHInterestFilter.h>
+#include <InspectorPlugin/JoltInterface/JPHReplayEngine.h>
+#include <InspectorPlugin/JoltInterface/JPHShapeDictionary.h>
+#include <InspectorPlugin/JoltInterface/JPHSoftBodyEncoder.h>
+#include <InspectorPlugin/JoltInterface/JPHSpatialAggregator.h>
+#include <InspectorPlugin/JoltInterface/JPHStateHash.h>
+#include <InspectorPlugin/JoltInterface/JPHStepStatistics.h>
 #include <Jolt/Jolt.h>
 
+#include <Jolt/Physics/Body/BodyID.h>
+
 namespace JPH
 {
   class BodyInterface;
   class BodyManager;
   class PhysicsSystem;
+  class Shape;
 } // namespace JPH
 
 namespace JDebug::API
 {
+  class JPHCaptureWriter;
+  class JPHContactRecorder;
+  class JPHDebugRenderer;
+  class JPHFlightRecorder;
+  class JPHQueryRecorder;
+  class JPHTaskJobSystem;
+
   /**
    * @class JPHDebuggerInterface
    * @brief Interface for the JDebugger to interact with the Jolt Physics System.
    */
   class NS_INSPECTORPLUGIN_DLL JPHDebuggerInterface
   {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHDebuggerInterface);
+
+    friend class JPHDebuggerHub;
+
   public:
     /**
      * @enum JDInstructionLevel
@@ -38,7 +68,7 @@ namespace JDebug::API
     /**
      * @brief Default constructor.
      */
-    JPHDebuggerInterface() = default;
+    JPHDebuggerInterface();
 
     /**
      * @brief Constructor.
@@ -76,6 +106,297 @@ namespace JDebug::API
      */
     void SetInstructionLevel(JDInstructionLevel in_level);
 
+    /**
+     * @brief Returns the instruction level for network communication.
+     */
+    JDInstructionLevel GetInstructionLevel() const { return m_eInstructionLevel; }
+
+    /**
+     * @brief Returns which body fields are streamed for the given instruction level.
+     */
+    static nsBitflags<JPHFrameContent> GetFrameContent(JDInstructionLevel in_level);
+
+    /**
+     * @brief Returns the frame encoder, e.g. to change its quantization settings. The encoder of a filtered client uses the same settings.
+     */
+    JPHFrameEncoder& GetFrameEncoder() { return m_FrameEncoder; }
+
+    /**
+     * @brief Replaces the set of bodies that are streamed to the client. The capture writer receives all bodies, unless the aggregation
+     * settings say otherwise.
+     *
+     * The Inspector sends its interest set with Protocol::s_uiMsgInterest, a newly connected client starts out with all bodies.
+     */
+    void SetInterestSet(const JPHInterestSet& in_set);
+
+    /**
+     * @brief Returns the filter that resolves the interest set of the client, e.g. to change its hysteresis.
+     */
+    JPHInterestFilter& GetInterestFilter() { return m_InterestFilter; }
+
+    /**
+     * @brief Enables summarizing the bodies outside the interest set in a sparse grid, see JPHSpatialAggregator.
+     *
+     * Only has an effect while an interest set is active. The grid is streamed to a filtered client along with its frames, optionally
+     * the capture and the flight recorder are limited to the interest set as well and store the grid instead of the other bodies,
+     * which keeps the bandwidth and encode cost of very large worlds bounded by the interest set and the cell budget.
+     */
+    void SetAggregationSettings(const JPHAggregationSettings& in_settings) { m_AggregationSettings = in_settings; }
+
+    /**
+     * @brief Returns the aggregation settings.
+     */
+    const JPHAggregationSettings& GetAggregationSettings() const { return m_AggregationSettings; }
+
+    /**
+     * @brief Returns the grid of the last published frame, only up to date while bodies are aggregated.
+     */
+    const JPHAggregateGrid& GetAggregateGrid() const { return m_AggregateGrid; }
+
+    /**
+     * @brief Queues bodies whose details are resolved at the end of the next step, like a Protocol::s_uiMsgBodyDetailRequest of the client.
+     *
+     * Requires the interface to be created with a physics system. All bodies queued until the end of a step are resolved in one batch,
+     * at most s_uiMaxBodyDetailsPerStep of them, the rest follows in the next steps. Bodies that are already queued are not queued again.
+     * The batch is sent to the client if one is connected and is available through GetBodyDetails() either way.
+     * @param in_bodyIDs JPH::BodyID::GetIndexAndSequenceNumber() of the bodies.
+     */
+    void RequestBodyDetails(nsArrayPtr<const nsUInt32> in_bodyIDs);
+
+    /**
+     * @brief Returns the body details resolved in the last step that had requests.
+     */
+    const JPHBodyDetailBatch& GetBodyDetails() const { return m_BodyDetails; }
+
+    /// The number of bodies whose details are resolved per step, bounds the time spent under the body locks and the size of a reply.
+    static constexpr nsUInt32 s_uiMaxBodyDetailsPerStep = 256;
+
+    /// Requests beyond this many queued bodies are dropped, a client cannot make the queue grow without bounds.
+    static constexpr nsUInt32 s_uiMaxQueuedBodyDetails = 4096;
+
+    /**
+     * @brief Returns the dictionary that assigns IDs to the shapes of the captured bodies.
+     */
+    const JPHShapeDictionary& GetShapeDictionary() const { return m_ShapeDictionary; }
+
+    /**
+     * @brief Sets a capture writer that receives every encoded frame, independent of whether a client is connected.
+     * @param in_pWriter The writer, or nullptr to stop capturing. The writer must outlive this interface or be reset first.
+     */
+    void SetCaptureWriter(JPHCaptureWriter* in_pWriter);
+
+    /**
+     * @brief Returns the capture writer, if any.
+     */
+    JPHCaptureWriter* GetCaptureWriter() const { return m_pCaptureWriter; }
+
+    /**
+     * @brief Sets a flight recorder that keeps the last seconds of frames in memory and dumps them into a capture file on a trigger.
+     *
+     * While the recorder is set, every frame is encoded as if a capture was running, and FrameEnd() checks the step time, the bodies and
+     * the contacts of the contact recorder against the triggers of the recorder. The simulation state of SetStateCaptureSettings()
+     * is not recorded, only the capture writer receives it.
+     * @param in_pRecorder The recorder, or nullptr. It must outlive this interface or be reset first.
+     */
+    void SetFlightRecorder(JPHFlightRecorder* in_pRecorder);
+
+    /**
+     * @brief Returns the flight recorder, if any.
+     */
+    JPHFlightRecorder* GetFlightRecorder() const { return m_pFlightRecorder; }
+
+    /**
+     * @brief Sets a contact recorder whose contacts are streamed and captured along with every frame.
+     *
+     * The recorder has to be attached to the physics system (see JPHContactRecorder::Attach()), the interface only collects its contacts
+     * in FrameEnd() and turns recording off while neither a client is connected nor a capture is running.
+     * @param in_pRecorder The recorder, or nullptr. It must outlive this interface or be reset first.
+     */
+    void SetContactRecorder(JPHContactRecorder* in_pRecorder);
+
+    /**
+     * @brief Returns the contact recorder, if any.
+     */
+    JPHContactRecorder* GetContactRecorder() const { return m_pContactRecorder; }
+
+    /**
+     * @brief Sets a query recorder whose records are streamed and captured along with every frame.
+     *
+     * The interface collects the records in FrameEnd(), turns recording off while neither a client is connected nor a capture is running,
+     * and applies the sampling the client sends with Protocol::s_uiMsgQuerySettings.
+     * @param in_pRecorder The recorder, or nullptr. It must outlive this interface or be reset first.
+     */
+    void SetQueryRecorder(JPHQueryRecorder* in_pRecorder);
+
+    /**
+     * @brief Returns the query recorder, if any.
+     */
+    JPHQueryRecorder* GetQueryRecorder() const { return m_pQueryRecorder; }
+
+    /**
+     * @brief Enables capturing the full simulation state, so JPHReplayEngine can re-simulate any step of the capture.
+     *
+     * Requires the interface to be created with a physics system. Whenever the bodies or constraints change, the scene and the state
+     * are captured right away, so the replay never has to simulate across such a change.
+     */
+    void SetStateCaptureSettings(const JPHStateCaptureSettings& in_settings);
+
+    /**
+     * @brief Returns the state capture settings.
+     */
+    const JPHStateCaptureSettings& GetStateCaptureSettings() const { return m_StateCaptureSettings; }
+
+    /**
+     * @brief Enables hashing the exact state of all bodies after every step.
+     *
+     * The hash is streamed to the client and captured along with every frame, JPHStateHashCompare finds the first step in which
+     * two captures diverge. It is computed in FrameEnd() even while nothing is published, so a lockstep application can compare
+     * GetStateHash() with its peers.
+     */
+    void SetStateHashSettings(const JPHStateHashSettings& in_settings) { m_StateHashSettings = in_settings; }
+
+    /**
+     * @brief Returns the state hash settings.
+     */
+    const JPHStateHashSettings& GetStateHashSettings() const { return m_StateHashSettings; }
+
+    /**
+     * @brief Returns the hash of the snapshot captured by the last FrameEnd(), only up to date if state hashing is enabled.
+     */
+    const JPHStateHash& GetStateHash() const { return m_StateHash; }
+
+    /**
+     * @brief Enables the phase timing and counters of every step, see JPHStepMonitor.
+     *
+     * Requires the interface to be created with a physics system, the contact counts also need a contact recorder.
+     * The statistics are collected in FrameEnd() even while nothing is published, they are cheap enough to stay enabled
+     * in shipping builds. If several interfaces time their steps, each physics system needs its own job system, see SetJobSystem().
+     */
+    void SetStepStatisticsEnabled(bool in_bEnabled);
+
+    /**
+     * @brief Sets the job system the physics system is updated with, so the phase timing only counts the jobs of this system.
+     *
+     * Only needed if several interfaces have step statistics enabled, see JPHStepMonitor. The job system must outlive the interface
+     * or be replaced by nullptr before it is destroyed. Must not be called while the physics system is updated.
+     */
+    void SetJobSystem(JPHTaskJobSystem* in_pJobSystem);
+
+    /**
+     * @brief Returns the job system set by SetJobSystem().
+     */
+    JPHTaskJobSystem* GetJobSystem() const { return m_pJobSystem; }
+
+    /**
+     * @brief Returns whether step statistics are collected.
+     */
+    bool IsStepStatisticsEnabled() const { return m_bStepStatisticsEnabled; }
+
+    /**
+     * @brief Returns the statistics collected by the last FrameEnd(), only up to date if step statistics are enabled.
+     */
+    const JPHStepStatistics& GetStepStatistics() const { return m_StepStatistics; }
+
+    /**
+     * @brief Enables the per constraint solver diagnostics, see JPHConstraintMonitor.
+     *
+     * Requires the interface to be created with a physics system. The constraints are measured in FrameEnd() for every published frame,
+     * only the most stressed ones and a histogram of all of them are streamed and captured, so the cost stays bounded with many constraints.
+     */
+    void SetConstraintMonitorSettings(const JPHConstraintMonitorSettings& in_settings);
+
+    /**
+     * @brief Returns the constraint diagnostics settings.
+     */
+    const JPHConstraintMonitorSettings& GetConstraintMonitorSettings() const { return m_ConstraintMonitorSettings; }
+
+    /**
+     * @brief Returns the constraint statistics of the last published frame, only up to date if the constraint diagnostics are enabled.
+     */
+    const JPHConstraintStatistics& GetConstraintStatistics() const { return m_ConstraintStatistics; }
+
+    /**
+     * @brief Enables streaming and capturing the vertices of soft bodies, see JPHSoftBodyEncoder.
+     *
+     * The vertices are sent every JPHSoftBodyCaptureSettings::m_uiSampleInterval steps, and along with every keyframe of the capture,
+     * so playback can start at any keyframe. Nothing is sent while the instruction level does not include positions.
+     * Soft bodies are not subject to the interest set of the client.
+     */
+    void SetSoftBodyCaptureSettings(const JPHSoftBodyCaptureSettings& in_settings);
+
+    /**
+     * @brief Returns the soft body capture settings.
+     */
+    const JPHSoftBodyCaptureSettings& GetSoftBodyCaptureSettings() const { return m_SoftBodyEncoder.GetSettings(); }
+
+    /**
+     * @brief Sets a debug renderer whose draw commands are streamed and captured along with every frame.
+     *
+     * Draw into it between FrameStart() and FrameEnd(), e.g. with PhysicsSystem::DrawBodies(). FrameEnd() encodes what was drawn
+     * and sends it to the client and the capture. What is drawn in a frame that is not published is discarded.
+     * Only available if Jolt is built with JPH_DEBUG_RENDERER.
+     * @param in_pRenderer The renderer, or nullptr. It must outlive this interface or be reset first.
+     */
+    void SetDebugRenderer(JPHDebugRenderer* in_pRenderer);
+
+    /**
+     * @brief Returns the debug renderer, if any.
+     */
+    JPHDebugRenderer* GetDebugRenderer() const { return m_pDebugRenderer; }
+
+    /**
+     * @brief Limits the time FrameEnd() spends on capturing and publishing frames, see JPHCaptureThrottle.
+     *
+     * While a client is connected or a capture is running, the instruction level, the encoder tolerances and the rate at which
+     * bodies are checked for changes are reduced as far as needed to stay within the budget, and restored once there is headroom again.
+     * The instruction level set with SetInstructionLevel() is the most detailed one used. Frames that do not fit even at the lowest
+     * fidelity are not published, their snapshot is not captured either, unless state hashing needs it.
+     */
+    void SetCaptureBudget(const JPHCaptureBudget& in_budget) { m_CaptureThrottle.SetBudget(in_budget); }
+
+    /**
+     * @brief Returns the capture budget.
+     */
+    const JPHCaptureBudget& GetCaptureBudget() const { return m_CaptureThrottle.GetBudget(); }
+
+    /**
+     * @brief Returns the throttle, which knows the current fidelity and how many frames were skipped.
+     */
+    const JPHCaptureThrottle& GetCaptureThrottle() const { return m_CaptureThrottle; }
+
+    /**
+     * @brief Installs a JPHActivationTracker on the physics system, so FrameEnd() only captures and encodes the bodies that are awake.
+     *
+     * Every step then copies the active bodies of the physics system and the bodies that woke up or fell asleep since the last step,
+     * sleeping bodies are sent once when they fall asleep. The cost of a frame depends on the number of awake bodies, not on
+     * the number of bodies. Bodies that were added or removed are found by comparing the body IDs with the last step, which reads the ID
+     * of every body but nothing else. All bodies are captured when new slots were used and for every keyframe, e.g. when a client connects,
+     * so sleeping bodies that were changed without waking them up show up with the next keyframe.
+     * A client with an interest set is still encoded by checking every body.
+     * @param inout_system The physics system this interface was created with. Must not be updated during the call.
+     */
+    void EnableSleepTracking(JPH::PhysicsSystem& inout_system);
+
+    /**
+     * @brief Removes the activation listener again, FrameEnd() captures all bodies in every step.
+     */
+    void DisableSleepTracking();
+
+    /**
+     * @brief Returns whether only awake bodies are captured, see EnableSleepTracking().
+     */
+    bool IsSleepTrackingEnabled() const { return m_ActivationTracker.IsAttached(); }
+
+    /**
+     * @brief Returns the hub this interface was registered with, if any, see JPHDebuggerHub::Register().
+     */
+    JPHDebuggerHub* GetHub() const { return m_pHub; }
+
+    /**
+     * @brief Returns the stream ID within the hub, or zero without a hub.
+     */
+    nsUInt32 GetStreamID() const { return m_uiStreamID; }
+
     /**
      * @brief This function is called when the JDebugger disconnects.
      *
@@ -141,14 +462,196 @@ namespace JDebug::API
     virtual void PreFrameStart() = 0;
 
   public:
+    /**
+     * @brief Ends the current frame.
+     *
+     * Calls PreFrameEnd() and then captures the state of all bodies into the current snapshot buffer.
+     * Shapes that were not seen before are added to the shape dictionary and their geometry is sent before the frame,
+     * shapes that are not used anymore are evicted.
+     * If a client is connected or a capture writer is set, the snapshot is encoded according to the instruction level
+     * and sent to the client and handed to the capture writer, together with the contacts of the contact recorder, if one is set,
+     * and the state hash, if enabled.
+     * Writing the capture happens on the writer's own thread.
+     * With a capture budget, the time between FrameStart() and FrameEnd() is taken as the step time.
+     * Must be called after PhysicsSystem::Update() and while no other thread modifies the bodies.
+     */
     void FrameEnd();
+
+    /**
+     * @brief Starts a new frame.
+     *
+     * Calls PreFrameStart() and remembers the time for the capture budget.
+     */
     void FrameStart();
 
+    /**
+     * @brief Returns the snapshot captured by the last FrameEnd().
+     */
+    const JPHBodySnapshot& GetCurrentSnapshot() const { return m_Snapshots[m_uiCurrentSnapshot]; }
+
+    /**
+     * @brief Returns the snapshot captured by the FrameEnd() before the last one.
+     */
+    const JPHBodySnapshot& GetPreviousSnapshot() const { return m_Snapshots[m_uiCurrentSnapshot ^ 1]; }
+
+    /**
+     * @brief Returns the number of physics steps captured so far.
+     */
+    nsUInt64 GetStepIndex() const { return m_uiStepIndex; }
+
+  protected:
+    /**
+     * @brief Copies the state of all bodies into the given snapshot.
+     *
+     * The body array is split into chunks that are processed in parallel on the nsTaskSystem.
+     * @param out_snapshot The snapshot to fill.
+     */
+    void CaptureSnapshot(JPHBodySnapshot& out_snapshot);
+
+    /**
+     * @brief Copies the state of the awake bodies and of the bodies that woke up or fell asleep recently into the given snapshot.
+     *
+     * The snapshot must hold the state of all other bodies already, which is the case if it was filled by the FrameEnd() before the last one.
+     * @param out_snapshot The snapshot to update.
+     */
+    void CaptureChangedBodies(JPHBodySnapshot& out_snapshot);
+
+    /**
+     * @brief Adds the bodies that were added or removed since the last call to m_Transitions, they need not wake up or fall asleep.
+     * @param uiNumSlots The slot count of the snapshot that is captured next.
+     * @return False if a body uses a slot beyond uiNumSlots, then all bodies have to be captured.
+     */
+    bool FindAddedAndRemovedBodies(nsUInt32 uiNumSlots);
+
+    /**
+     * @brief Encodes the current snapshot, broadcasts it over nsTelemetry if a client is connected and queues it on the capture writer.
+     */
+    void EncodeAndPublishFrame();
+
   private:
-    JPH::BodyInterface* m_pInterface;       ///< The body interface.
-    JPH::BodyManager* m_pManager = nullptr; ///< The body manager. This can be null, we will just replace those calls with PhysicsSystem calls.
-    JPH::PhysicsSystem* m_pPhysicsSystem;   ///< The Jolt Physics System.
-    std::string m_sNetworkConnectionLink;   ///< The network connection link.
-    JDInstructionLevel m_eInstructionLevel; ///< The instruction level for network communication.
+    /// Reference counts nsTelemetry::AcceptMessagesForSystem() for all interfaces and hubs.
+    static void AcceptTelemetryMessages(bool in_bAccept);
+
+    void UpdateConnectionState();
+    void ProcessClientMessages();
+    void HandleClientMessage(nsUInt32 uiMessageID, nsStreamReader& inout_reader);
+    void Send(nsTelemetry::TransmitMode mode, nsUInt32 uiMessageID, const void* pData, nsUInt32 uiNumBytes);
+    void RegisterNewShapes(JPHBodySnapshot& inout_snapshot);
+    void PublishShapes();
+    void SendShapes(nsArrayPtr<const nsUInt32> shapeIDs, bool bToClient, bool bToCapture, bool bToFlightRecorder);
+    void TelemetryEventHandler(const nsTelemetry::TelemetryEventData& e);
+    void CaptureSimulationState();
+    bool BeginThrottledFrame(nsTime frameBudget);
+    bool IsKeyframePending(nsBitflags<JPHFrameContent> content) const;
+    bool EncodeSoftBodies(bool bKeyframe);
+    void RequestDebugDrawKeyframe();
+    void PublishBodyDetails();
+    bool IsFlightRecording() const;
+    void CheckFlightRecorderTriggers(nsTime stepTime, bool bSnapshotCaptured);
+
+    const JPH::BodyInterface* m_pInterface = nullptr;                      ///< The body interface.
+    const JPH::BodyManager* m_pManager = nullptr;                          ///< The body manager. This can be null, we will just replace those calls with PhysicsSystem calls.
+    const JPH::PhysicsSystem* m_pPhysicsSystem = nullptr;                  ///< The Jolt Physics System.
+    std::string m_sNetworkConnectionLink;                                  ///< The network connection link.
+    JDInstructionLevel m_eInstructionLevel = JDInstructionLevel::JDIL_All; ///< The instruction level for network communication.
+
+    JPHBodySnapshot m_Snapshots[2];          ///< Double buffered body state, so the previous step is available for delta computations.
+    nsUInt32 m_uiCurrentSnapshot = 0;        ///< Index into m_Snapshots of the snapshot captured last.
+    nsUInt64 m_uiStepIndex = 0;              ///< Number of captured physics steps.
+    JPH::Array<JPH::BodyID> m_BodyIDScratch; ///< Reused body ID list, for captures without a body manager and for finding added and removed bodies.
+
+    JPHFrameEncoder m_FrameEncoder;                 ///< Turns snapshots into delta compressed frames.
+    nsDynamicArray<nsUInt8> m_EncodedFrame;         ///< The last encoded frame, reused to avoid allocations.
+    JPHCaptureWriter* m_pCaptureWriter = nullptr;   ///< Receives encoded frames for the capture file, optional.
+    JPHFlightRecorder* m_pFlightRecorder = nullptr; ///< Keeps the last encoded frames in memory, optional.
+    bool m_bClientConnected = false;                ///< Whether OnJDebuggerConnect() was called last (as opposed to OnJDebuggerDisconnect()).
+    nsAtomicBool m_bResyncRequested;                ///< Set from the telemetry thread when a client connects, the next frame will be a keyframe.
+
+    JPHDebuggerHub* m_pHub = nullptr;                      ///< The hub this interface is a stream of, if any, see JPHDebuggerHub::Register().
+    nsUInt32 m_uiStreamID = 0;                             ///< The ID of the stream within m_pHub.
+    nsDynamicArray<nsUInt8> m_StreamMessage;               ///< A message wrapped for the hub, reused to avoid allocations.
+    nsDynamicArray<JPHDebuggerHub::Message> m_HubMessages; ///< Client messages retrieved from the hub.
+
+    JPHShapeDictionary m_ShapeDictionary;                 ///< Geometry of all shapes that are used by bodies, referenced by ID in the frames.
+    nsDynamicArray<const JPH::Shape*> m_UnresolvedShapes; ///< Per slot, shapes that were not in the dictionary during the parallel capture.
+    nsDynamicArray<nsUInt32> m_NewShapeIDs;               ///< Geometry that was added during the current FrameEnd().
+    nsDynamicArray<nsUInt32> m_ShapeIDScratch;            ///< Reused list for resends and evictions.
+    bool m_bClientHasShapes = false;                      ///< Whether all dictionary shapes were sent to the connected client.
+    bool m_bCaptureHasShapes = false;                     ///< Whether all dictionary shapes were handed to the running capture writer.
+    bool m_bFlightRecorderHasShapes = false;              ///< Whether all dictionary shapes were handed to the flight recorder.
+
+    JPHInterestFilter m_InterestFilter;           ///< Selects the bodies that are streamed to the client.
+    JPHFrameEncoder m_ClientFrameEncoder;         ///< Encodes the frames of a client with an interest set, the capture always uses m_FrameEncoder.
+    nsDynamicArray<nsUInt8> m_ClientEncodedFrame; ///< The last frame encoded by m_ClientFrameEncoder.
+    bool m_bClientFiltered = false;               ///< Whether the client was served by m_ClientFrameEncoder in the last frame.
+    bool m_bCaptureFiltered = false;              ///< Whether m_FrameEncoder was limited to the interest set in the last frame.
+
+    JPHAggregationSettings m_AggregationSettings; ///< Whether and how the bodies outside the interest set are aggregated.
+    JPHSpatialAggregator m_Aggregator;            ///< Builds m_AggregateGrid.
+    JPHAggregateGrid m_AggregateGrid;             ///< The bodies outside the interest set in the current step.
+    nsDynamicArray<nsUInt8> m_AggregateData;      ///< m_AggregateGrid serialized.
+    nsDynamicArray<nsUInt8> m_AggregateMessage;   ///< Step index and grid, sent to the client.
+
+    JPHContactRecorder* m_pContactRecorder = nullptr; ///< Records the contacts of each step, optional.
+    nsDynamicArray<nsUInt8> m_ContactData;            ///< The contacts of the current step, serialized.
+    nsDynamicArray<nsUInt8> m_ContactMessage;         ///< Step index and contacts, sent to the client.
+    nsDynamicArray<nsUInt8> m_FrameRecords;           ///< Records that are captured along with the encoded frame.
+
+    JPHQueryRecorder* m_pQueryRecorder = nullptr; ///< Records the collision queries of the application, optional.
+    nsDynamicArray<nsUInt8> m_QueryData;          ///< The queries of the current step, serialized.
+    nsDynamicArray<nsUInt8> m_QueryMessage;       ///< Step index and queries, sent to the client.
+
+    JPHStateCaptureSettings m_StateCaptureSettings; ///< How often the simulation state is captured for the replay.
+    nsUInt64 m_uiLastStateStep = 0;                 ///< The step the simulation state was last captured in.
+    nsUInt64 m_uiSceneHash = 0;                     ///< Identifies the bodies and constraints that were last written as scene.
+    bool m_bCaptureHasScene = false;                ///< Whether the running capture holds a scene and state that later states can build on.
+    bool m_bSceneUnsupported = false;               ///< Whether the scene with m_uiSceneHash cannot be replayed, so it is not tried again.
+
+    JPHStateHashSettings m_StateHashSettings;   ///< Whether and how the state of every step is hashed.
+    JPHStateHash m_StateHash;                   ///< The hash of the current snapshot.
+    nsDynamicArray<nsUInt8> m_StateHashData;    ///< m_StateHash serialized.
+    nsDynamicArray<nsUInt8> m_StateHashMessage; ///< Step index and state hash, sent to the client.
+
+    bool m_bStepStatisticsEnabled = false;           ///< Whether step statistics are collected.
+    JPHStepMonitor m_StepMonitor;                    ///< Collects m_StepStatistics.
+    JPHTaskJobSystem* m_pJobSystem = nullptr;        ///< Routes the phase timing of its jobs to m_StepMonitor, optional.
+    JPHStepStatistics m_StepStatistics;              ///< The statistics of the current step.
+    nsDynamicArray<nsUInt8> m_StepStatisticsData;    ///< m_StepStatistics serialized.
+    nsDynamicArray<nsUInt8> m_StepStatisticsMessage; ///< Step index and statistics, sent to the client.
+
+    JPHConstraintMonitorSettings m_ConstraintMonitorSettings; ///< Whether and how the constraints are measured.
+    JPHConstraintMonitor m_ConstraintMonitor;                 ///< Collects m_ConstraintStatistics.
+    JPHConstraintStatistics m_ConstraintStatistics;           ///< The constraint statistics of the current step.
+    nsDynamicArray<nsUInt8> m_ConstraintData;                 ///< m_ConstraintStatistics serialized.
+    nsDynamicArray<nsUInt8> m_ConstraintMessage;              ///< Step index and constraint statistics, sent to the client.
+
+    nsDynamicArray<nsUInt32> m_BodyDetailRequests; ///< Bodies whose details are resolved at the end of the step, in the order they were requested.
+    JPHBodyDetailResolver m_BodyDetailResolver;    ///< Builds m_BodyDetails.
+    JPHBodyDetailBatch m_BodyDetails;              ///< The last resolved batch.
+    nsDynamicArray<nsUInt8> m_BodyDetailData;      ///< m_BodyDetails serialized, sent to the client.
+
+    JPHSoftBodyEncoder m_SoftBodyEncoder;   ///< Encodes the vertices of all soft bodies, for the client and the capture alike.
+    nsDynamicArray<nsUInt8> m_SoftBodyData; ///< The last frame encoded by m_SoftBodyEncoder.
+
+    JPHDebugRenderer* m_pDebugRenderer = nullptr; ///< Records what is drawn during the step, if set.
+    nsDynamicArray<nsUInt8> m_DebugDrawData;      ///< The last frame encoded by m_pDebugRenderer.
+
+    JPHCaptureThrottle m_CaptureThrottle;                                       ///< Keeps capturing and publishing within the capture budget.
+    JDInstructionLevel m_eFrameInstructionLevel = JDInstructionLevel::JDIL_All; ///< The instruction level of the current frame, reduced by the throttle.
+    nsTime m_FrameStartTime;                                                    ///< When FrameStart() was last called.
+    bool m_bWasPublishing = false;                                              ///< Whether the last frame was published to anyone.
+
+    JPHActivationTracker m_ActivationTracker;          ///< Reports the bodies that woke up or fell asleep, attached while sleep tracking is enabled.
+    nsDynamicArray<JPH::BodyID> m_Transitions;         ///< Bodies that woke up or fell asleep since the last capture.
+    nsDynamicArray<JPH::BodyID> m_PreviousTransitions; ///< The transitions of the capture before, the other snapshot did not see them.
+    nsDynamicArray<JPH::BodyID> m_ChangedBodies;       ///< The bodies copied by CaptureChangedBodies().
+    nsDynamicArray<nsUInt32> m_ChangedSlots;           ///< The slots of m_ChangedBodies, handed to the frame encoder.
+    nsDynamicArray<nsUInt32> m_SlotStamps;             ///< Per slot, the capture it was last added to m_ChangedBodies in, to skip duplicates.
+    nsUInt32 m_uiCaptureStamp = 0;                     ///< Counts the captures of changed bodies, compared with m_SlotStamps.
+    nsDynamicArray<nsUInt32> m_SlotMembers;            ///< Per slot, the body ID of the last capture or JPH::BodyID::cInvalidBodyID.
+    nsUInt32 m_uiNumFullCapturesPending = 0;           ///< Captures that have to copy all bodies, one per snapshot.
+    nsUInt32 m_uiNumCapturedSlots = 0;                 ///< The number of slots the last capture copied.
+    bool m_bCapturedChangedBodies = false;             ///< Whether the last capture only copied the slots in m_ChangedSlots.
+    bool m_bFullCaptureRequested = false;              ///< Set by FrameEnd() before a keyframe, which resends all bodies.
   };
 } // namespace JDebug::API
\ No newline at end of file
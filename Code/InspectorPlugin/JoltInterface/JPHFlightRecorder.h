@@ -0,0 +1,248 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/Map.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Threading/Thread.h>
+#include <Foundation/Time/Time.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Foundation/Types/UniquePtr.h>
+#include <Foundation/Utilities/EnumerableClass.h>
+
+namespace JDebug::API
+{
+  struct JPHBodySnapshot;
+  struct JPHContactRecord;
+
+  /**
+   * @brief Why JPHFlightRecorder dumped its ring, also part of the file name of the dump.
+   */
+  enum class JPHFlightRecorderTrigger : nsUInt8
+  {
+    None,
+    Manual,      ///< TriggerDump() or the "DumpPhysicsFlightRecorder" console function.
+    Assert,      ///< An NS_ASSERT failed.
+    StepTime,    ///< A step took longer than JPHFlightRecorderSettings::m_MaxStepTime.
+    Velocity,    ///< A body moved faster than JPHFlightRecorderSettings::m_fMaxLinearVelocity.
+    Penetration, ///< A contact penetrated deeper than JPHFlightRecorderSettings::m_fMaxPenetration.
+    NaN,         ///< The position, rotation or velocity of a body was not finite.
+  };
+
+  /**
+   * @struct JPHFlightRecorderSettings
+   * @brief Size of the ring and the conditions that dump it, see JPHFlightRecorder.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHFlightRecorderSettings
+  {
+    nsTime m_Duration = nsTime::MakeFromSeconds(10);           ///< How far back the ring reaches, older frames are dropped.
+    nsUInt32 m_uiMemoryBudget = 64 * 1024 * 1024;              ///< Size of the ring in bytes. When it is full, frames are dropped even if they are younger than m_Duration. Shapes are kept on top of this, see JPHFlightRecorder::RecordShape().
+    nsUInt32 m_uiMaxFrames = 4096;                             ///< Number of frames the ring can hold.
+    nsString m_sDumpDirectory;                                 ///< Absolute directory the dumps are written to, created if necessary.
+    nsTime m_PostTriggerDuration = nsTime::MakeFromSeconds(1); ///< How long an automatic trigger keeps recording before the dump, so the dump shows what happened next.
+    nsTime m_TriggerCooldown = nsTime::MakeFromSeconds(30);    ///< Automatic triggers are ignored for this long after a dump, so a lasting condition does not dump over and over.
+    nsTime m_MaxStepTime;                                      ///< Dump when a step takes longer than this. Zero disables the trigger.
+    float m_fMaxLinearVelocity = 0.0f;                         ///< Dump when a body moves faster than this, in meters per second. Zero disables the trigger.
+    float m_fMaxPenetration = 0.0f;                            ///< Dump when a contact penetrates deeper than this, in meters. Needs a contact recorder. Zero disables the trigger.
+    bool m_bDumpOnNaN = true;                                  ///< Dump when the position, rotation or velocity of a body is not finite.
+    bool m_bDumpOnAssert = true;                               ///< Dump right away when an NS_ASSERT fails, before the assert handler runs.
+  };
+
+  /**
+   * @class JPHFlightRecorder
+   * @brief Keeps the last seconds of encoded frames in memory and writes them into a capture file when something goes wrong.
+   *
+   * Attach it with JPHDebuggerInterface::SetFlightRecorder(), the interface then encodes every frame even while no client is connected
+   * and no capture is running, and hands it to Record() together with the records of the step. Frames are copied into a ring that is
+   * allocated up front, so recording does not allocate. The oldest retained frame is always a keyframe: frames older than m_Duration are
+   * only dropped together with the delta frames that build on them, and the recorder asks for a keyframe through IsKeyframeNeeded()
+   * whenever the newest one is older than half of m_Duration, or the ring lost its last one.
+   *
+   * A dump writes the ring into "<m_sDumpDirectory>/FlightRecorder_<date>_<time>_<trigger>.jdcap", a regular capture file that starts
+   * with a keyframe and holds every shape the frames reference. It is written on a separate thread, recording pauses until it is done
+   * and starts over with an empty ring. Assert dumps are written on the asserting thread instead, since the process may not survive the assert.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHFlightRecorder : public nsEnumerable<JPHFlightRecorder>
+  {
+    NS_DECLARE_ENUMERABLE_CLASS(JPHFlightRecorder);
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHFlightRecorder);
+
+  public:
+    JPHFlightRecorder();
+    ~JPHFlightRecorder();
+
+    /**
+     * @brief Allocates the ring for the given settings. Waits for a running dump, the recorded frames are discarded.
+     */
+    void SetSettings(const JPHFlightRecorderSettings& in_settings);
+
+    /**
+     * @brief Returns the current settings.
+     */
+    const JPHFlightRecorderSettings& GetSettings() const { return m_Settings; }
+
+    /**
+     * @brief Requests a dump, it is started by the next Update(). Can be called from any thread.
+     *
+     * Only the first trigger counts, further ones are ignored until the dump is done.
+     */
+    void TriggerDump(JPHFlightRecorderTrigger in_eTrigger = JPHFlightRecorderTrigger::Manual);
+
+    /**
+     * @brief Returns whether frames are recorded, which is not the case while a dump is written.
+     */
+    bool IsRecording() const { return !m_bDumping; }
+
+    /**
+     * @brief Returns whether the next recorded frame should be a keyframe, see the class description.
+     */
+    bool IsKeyframeNeeded() const;
+
+    /**
+     * @brief Copies a frame into the ring, dropping the oldest frames as needed. Does nothing while a dump is written.
+     *
+     * Delta frames are dropped while the ring holds no keyframe they could build on.
+     * @param in_data The frame encoded by JPHFrameEncoder.
+     * @param in_records Further records of the step, formatted with IO::JPHPVDFileManager::AppendRecord().
+     * @param in_uiStepIndex The physics step the frame belongs to.
+     * @param in_bKeyframe Whether the frame can be decoded on its own.
+     */
+    void Record(nsArrayPtr<const nsUInt8> in_data, nsArrayPtr<const nsUInt8> in_records, nsUInt64 in_uiStepIndex, bool in_bKeyframe);
+
+    /**
+     * @brief Stores the geometry of a JPHShapeDictionary entry for all future dumps. Recording an ID again replaces its geometry.
+     *
+     * The geometry is not part of JPHFlightRecorderSettings::m_uiMemoryBudget, since a dump needs every shape its frames reference.
+     * It is kept until ReleaseShape() was called and the ring holds no frame anymore that may reference the shape.
+     */
+    void RecordShape(nsUInt32 in_uiShapeID, nsArrayPtr<const nsUInt8> in_data);
+
+    /**
+     * @brief Tells the recorder that no body uses the shape anymore since the given step, e.g. after JPHShapeDictionary::EvictReleasedShapes().
+     *
+     * The geometry is dropped once the oldest frame in the ring was recorded after that step. Steps have to be passed in increasing order.
+     */
+    void ReleaseShape(nsUInt32 in_uiShapeID, nsUInt64 in_uiStepIndex);
+
+    /**
+     * @brief Triggers a dump if the step took longer than JPHFlightRecorderSettings::m_MaxStepTime.
+     */
+    void CheckStepTime(nsTime in_stepTime);
+
+    /**
+     * @brief Triggers a dump if a body is faster than JPHFlightRecorderSettings::m_fMaxLinearVelocity or its state is not finite.
+     * @param in_snapshot The snapshot of the step.
+     * @param in_slots The slots that changed since the last check, e.g. the awake bodies. All slots are checked if this is empty.
+     */
+    void CheckBodies(const JPHBodySnapshot& in_snapshot, nsArrayPtr<const nsUInt32> in_slots = nsArrayPtr<const nsUInt32>());
+
+    /**
+     * @brief Triggers a dump if a contact penetrates deeper than JPHFlightRecorderSettings::m_fMaxPenetration.
+     */
+    void CheckContacts(nsArrayPtr<const JPHContactRecord> in_contacts);
+
+    /**
+     * @brief Starts the dump of a pending trigger once its post trigger time is over, and resumes recording after a dump.
+     *
+     * Must be called on the thread that calls Record(), JPHDebuggerInterface::FrameEnd() does that.
+     */
+    void Update();
+
+    /**
+     * @brief Blocks until a running dump is written.
+     */
+    void WaitForDump();
+
+    /**
+     * @brief Returns the number of frames in the ring.
+     */
+    nsUInt32 GetNumFrames() const { return m_uiNumFrames; }
+
+    /**
+     * @brief Returns the number of shapes whose geometry is kept for the dumps.
+     */
+    nsUInt32 GetNumShapes() const;
+
+    /**
+     * @brief Returns the number of dumps written so far.
+     */
+    nsUInt32 GetNumDumps() const { return static_cast<nsUInt32>(m_iNumDumps); }
+
+    /**
+     * @brief Returns the name of a trigger, as used in the file name of a dump.
+     */
+    static const char* GetTriggerName(JPHFlightRecorderTrigger in_eTrigger);
+
+  private:
+    struct FrameEntry
+    {
+      nsUInt64 m_uiStepIndex = 0;
+      nsTime m_RecordTime;
+      nsUInt32 m_uiOffset = 0; ///< Where the frame starts in m_Buffer, the records follow the encoded frame.
+      nsUInt32 m_uiDataSize = 0;
+      nsUInt32 m_uiRecordsSize = 0;
+      bool m_bKeyframe = false;
+    };
+
+    struct ReleasedShape
+    {
+      nsUInt32 m_uiShapeID = 0;
+      nsUInt64 m_uiStepIndex = 0;
+    };
+
+    class DumpThread : public nsThread
+    {
+    public:
+      DumpThread(JPHFlightRecorder* pOwner, JPHFlightRecorderTrigger eTrigger);
+
+    private:
+      virtual nsUInt32 Run() override;
+
+      JPHFlightRecorder* m_pOwner = nullptr;
+      JPHFlightRecorderTrigger m_eTrigger = JPHFlightRecorderTrigger::None;
+    };
+
+    static bool AssertHandler(const char* szSourceFile, nsUInt32 uiLine, const char* szFunction, const char* szExpression, const char* szAssertMsg);
+
+    FrameEntry& GetFrame(nsUInt32 uiIndex) { return m_Frames[(m_uiFirstFrame + uiIndex) % m_Frames.GetCount()]; }
+    bool IsRangeFree(nsUInt32 uiOffset, nsUInt32 uiSize) const;
+    void DropOldestFrames(nsUInt32 uiNumFrames);
+    void ClearRing();
+    void DropReleasedShapes(nsUInt64 uiOldestStep);
+    void FinishDump();
+    void TriggerAutomaticDump(JPHFlightRecorderTrigger eTrigger);
+    void DumpFromAssert();
+    void WriteDump(JPHFlightRecorderTrigger eTrigger);
+
+    JPHFlightRecorderSettings m_Settings;
+
+    // The ring, only accessed under m_RingMutex or by the dump while m_bDumping is set.
+    nsMutex m_RingMutex;
+    nsDynamicArray<nsUInt8> m_Buffer;    ///< Frame data, m_Settings.m_uiMemoryBudget bytes.
+    nsDynamicArray<FrameEntry> m_Frames; ///< Circular, m_Settings.m_uiMaxFrames entries.
+    nsUInt32 m_uiFirstFrame = 0;         ///< The oldest frame in m_Frames, always a keyframe.
+    nsUInt32 m_uiNumFrames = 0;
+    nsUInt32 m_uiWriteOffset = 0; ///< Where the newest frame ends in m_Buffer.
+    nsUInt32 m_uiNumKeyframes = 0;
+    nsTime m_LastKeyframeTime;
+
+    // Shapes are rare, a mutex is good enough.
+    mutable nsMutex m_ShapeMutex;
+    nsMap<nsUInt32, nsDynamicArray<nsUInt8>> m_Shapes; ///< Geometry by shape ID, in the order the IDs were handed out.
+    nsDynamicArray<ReleasedShape> m_ReleasedShapes;   ///< Shapes that are dropped once the ring moved past their step, oldest first.
+
+    nsAtomicBool m_bDumping;
+    nsAtomicBool m_bDumpFinished;
+    nsAtomicInteger32 m_iPendingTrigger; ///< JPHFlightRecorderTrigger
+    nsAtomicInteger32 m_iNumDumps;
+    nsUniquePtr<DumpThread> m_pDumpThread;
+    nsTime m_TriggerTime;  ///< When Update() first saw the pending trigger.
+    nsTime m_LastDumpTime; ///< When the last dump was done, for the cooldown of automatic triggers.
+  };
+} // namespace JDebug::API
@@ -0,0 +1,224 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Foundation/Types/Bitflags.h>
+
+namespace JDebug::API
+{
+  /**
+   * @brief Which parts of the body state are written into an encoded frame.
+   */
+  NS_DECLARE_FLAGS(nsUInt8, JPHFrameContent, State, Position, Rotation, Velocity, Shape);
+
+  /**
+   * @struct JPHFrameEncoderSettings
+   * @brief Quantization and delta tolerances used by JPHFrameEncoder.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHFrameEncoderSettings
+  {
+    nsUInt32 m_uiKeyframeInterval = 120;       ///< Every N-th frame contains all bodies. 0 disables periodic keyframes.
+    float m_fPositionQuantum = 1.0f / 1024.0f; ///< Size of one fixed point step for positions, in meters.
+    float m_fPositionTolerance = 0.002f;       ///< A body is only resent if it moved further than this, in meters.
+    float m_fRotationTolerance = 0.0005f;      ///< A body is only resent if 1 - |dot(q0, q1)| of its rotation exceeds this.
+    float m_fVelocityQuantum = 1.0f / 256.0f;  ///< Size of one fixed point step for velocities, in meters (or radians) per second.
+    float m_fVelocityTolerance = 0.02f;        ///< A velocity is only resent if any component changed more than this.
+    float m_fOriginGridSize = 256.0f;          ///< The per-frame origin is snapped to this grid, so it rarely changes.
+  };
+
+  /**
+   * @class JPHFrameEncoder
+   * @brief Encodes JPHBodySnapshot data into a compact, delta compressed binary frame.
+   *
+   * Transforms are quantized (smallest-three quaternions, fixed point positions relative to a per-frame origin) and only
+   * bodies whose state changed by more than the configured tolerance since they were last sent are written.
+   * Every m_uiKeyframeInterval frames a keyframe with all bodies is emitted, so a client can (re)synchronize.
+   *
+   * The tolerances are checked against the last transmitted value, not the previous step, so slowly drifting bodies
+   * are still resent once they accumulated enough error.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHFrameEncoder
+  {
+  public:
+    /**
+     * @brief Bits of the per-body field mask in an encoded frame.
+     */
+    enum FieldMask : nsUInt8
+    {
+      Field_State = NS_BIT(0),
+      Field_Position = NS_BIT(1),
+      Field_Rotation = NS_BIT(2),
+      Field_LinearVelocity = NS_BIT(3),
+      Field_AngularVelocity = NS_BIT(4),
+      Field_Shape = NS_BIT(5),
+    };
+
+    /**
+     * @brief Bits of the frame header flags.
+     */
+    enum FrameFlags : nsUInt8
+    {
+      Frame_Keyframe = NS_BIT(0),
+    };
+
+    static constexpr nsUInt32 s_uiFrameMagic = 'JDFR';
+    static constexpr nsUInt8 s_uiFrameVersion = 2;
+
+  public:
+    JPHFrameEncoder();
+    ~JPHFrameEncoder();
+
+    /**
+     * @brief Changes the settings. Changing the quantization or the origin grid forces the next frame to be a keyframe,
+     *        the tolerances and the keyframe interval take effect right away.
+     */
+    void SetSettings(const JPHFrameEncoderSettings& in_settings);
+
+    /**
+     * @brief Returns the current settings.
+     */
+    const JPHFrameEncoderSettings& GetSettings() const { return m_Settings; }
+
+    /**
+     * @brief Forces the next encoded frame to be a keyframe, e.g. because a new client connected.
+     */
+    void RequestKeyframe() { m_bKeyframeRequested = true; }
+
+    /**
+     * @brief Returns whether the next frame encoded with the given content will be a keyframe.
+     */
+    bool IsKeyframePending(nsBitflags<JPHFrameContent> in_content) const;
+
+    /**
+     * @brief Multiplies all tolerances of the settings, e.g. to send fewer bodies while the debugger is over its budget. 1 by default.
+     */
+    void SetToleranceScale(float in_fScale) { m_fToleranceScale = in_fScale; }
+
+    /**
+     * @brief Returns the factor the tolerances are multiplied with.
+     */
+    float GetToleranceScale() const { return m_fToleranceScale; }
+
+    /**
+     * @brief Only checks every N-th body slot for changes in a delta frame, a different set of slots in each frame.
+     *
+     * Each body is then sent at most every N frames, which cuts the cost of delta frames by about N. Keyframes always contain all bodies.
+     * 1 by default.
+     */
+    void SetSendRate(nsUInt32 in_uiRate) { m_uiSendRate = nsMath::Max(in_uiRate, 1u); }
+
+    /**
+     * @brief Returns the send rate, see SetSendRate().
+     */
+    nsUInt32 GetSendRate() const { return m_uiSendRate; }
+
+    /**
+     * @brief Makes delta frames only check the slots passed to AddChangedSlots(), instead of every slot. Off by default.
+     *
+     * Meant for callers that know which bodies can have changed, e.g. because only awake bodies move. The cost of a delta frame
+     * then depends on the number of changed slots, not on the number of bodies. Keyframes still contain all bodies.
+     * Turning it on makes the next delta frame check every slot once.
+     */
+    void SetChangeTracking(bool in_bEnabled);
+
+    /**
+     * @brief Returns whether change tracking is enabled, see SetChangeTracking().
+     */
+    bool IsChangeTrackingEnabled() const { return m_bChangeTracking; }
+
+    /**
+     * @brief Adds slots the next delta frame has to check, only used with change tracking. Accumulates until the slots were checked.
+     *
+     * Slots that a send rate above 1 skips in a frame are kept for the frame that checks them.
+     */
+    void AddChangedSlots(nsArrayPtr<const nsUInt32> in_slots);
+
+    /**
+     * @brief Makes the next delta frame check every slot once, e.g. because bodies may have changed without the caller knowing which.
+     */
+    void InvalidateAllSlots() { m_bCheckAllSlots = true; }
+
+    /**
+     * @brief Encodes the given snapshot.
+     * @param in_snapshot The body state of the current step.
+     * @param in_content Which fields to write. Changing this forces a keyframe.
+     * @param out_data Receives the encoded frame. Existing content is replaced.
+     * @param in_interestMask Optional, one entry per slot. Bodies with a zero entry are treated as if their slot was empty,
+     *                        so they are removed on the client when they leave the mask and sent in full when they enter it.
+     * @return True if the frame is a keyframe.
+     */
+    bool EncodeFrame(const JPHBodySnapshot& in_snapshot, nsBitflags<JPHFrameContent> in_content, nsDynamicArray<nsUInt8>& out_data, nsArrayPtr<const nsUInt8> in_interestMask = nsArrayPtr<const nsUInt8>());
+
+    /**
+     * @brief Returns the number of bodies written into the last encoded frame.
+     */
+    nsUInt32 GetNumEncodedBodies() const { return m_uiNumEncodedBodies; }
+
+  private:
+    void ComputeChangeMasks(const JPHBodySnapshot& in_snapshot, const nsUInt8* pInterestMask, const nsUInt32* pSlots, nsUInt32 uiNumChecked, nsUInt32 uiSendRate, bool bKeyframe);
+    void UpdateChangedSlots(nsUInt32 uiNumSlots, bool bCheckedAll);
+    void ResizeSentState(nsUInt32 uiNumSlots);
+
+    JPHFrameEncoderSettings m_Settings;
+    nsBitflags<JPHFrameContent> m_LastContent;
+    bool m_bKeyframeRequested = true;
+    nsUInt32 m_uiFramesSinceKeyframe = 0;
+    nsUInt32 m_uiNumEncodedBodies = 0;
+    float m_fToleranceScale = 1.0f;
+    nsUInt32 m_uiSendRate = 1;
+    nsUInt32 m_uiFrameCounter = 0; ///< Selects the slots that are checked in a frame with a send rate above 1.
+
+    bool m_bChangeTracking = false;          ///< Whether delta frames only check m_ChangedSlots.
+    bool m_bCheckAllSlots = true;            ///< Whether the next delta frame has to check every slot, even with change tracking.
+    nsDynamicArray<nsUInt32> m_ChangedSlots; ///< The slots the next delta frame checks with change tracking, without duplicates.
+    nsDynamicArray<nsUInt8> m_SlotChanged;   ///< Per slot, whether it is in m_ChangedSlots.
+
+    // Per slot change masks of the frame that is currently being encoded.
+    nsDynamicArray<nsUInt8> m_ChangeMasks;
+
+    // The state the client knows about, per slot. This is the quantized state, so encoder and decoder agree exactly.
+    nsDynamicArray<nsUInt32> m_SentBodyIDs;
+    nsDynamicArray<nsUInt8> m_SentStates;
+    nsDynamicArray<nsUInt8> m_SentMotionTypes;
+    nsDynamicArray<nsUInt32> m_SentObjectLayers;
+    nsDynamicArray<nsUInt32> m_SentShapeIDs;
+    nsDynamicArray<nsVec3I32> m_SentPositions;
+    nsDynamicArray<nsQuat> m_SentRotations;
+    nsDynamicArray<nsVec3I32> m_SentLinearVelocities;
+    nsDynamicArray<nsVec3I32> m_SentAngularVelocities;
+  };
+
+  /**
+   * @class JPHFrameDecoder
+   * @brief Applies frames written by JPHFrameEncoder to a JPHBodySnapshot.
+   *
+   * Delta frames only contain changed bodies, so the same snapshot has to be passed in for consecutive frames.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHFrameDecoder
+  {
+  public:
+    /**
+     * @brief Decodes a frame into the given snapshot.
+     * @param in_data The encoded frame.
+     * @param inout_snapshot The state after the previous frame, receives the updated state.
+     * @param out_pDecodedSlots Optional, receives the slots the frame contained records for, in increasing order.
+     *        A keyframe contains all valid bodies, slots that are missing from it are free.
+     * @return NS_FAILURE if the data is corrupt or a delta frame arrives before the first keyframe.
+     */
+    nsResult DecodeFrame(nsArrayPtr<const nsUInt8> in_data, JPHBodySnapshot& inout_snapshot, nsDynamicArray<nsUInt32>* out_pDecodedSlots = nullptr);
+
+    /**
+     * @brief Forgets all decoded state. The next frame must be a keyframe.
+     */
+    void Reset();
+
+  private:
+    bool m_bHasKeyframe = false;
+    nsDynamicArray<nsVec3I32> m_Positions; ///< Quantized positions per slot, delta frames are relative to these.
+  };
+} // namespace JDebug::API
@@ -0,0 +1,150 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Math/BoundingBox.h>
+
+class nsStreamReader;
+class nsStreamWriter;
+
+namespace JPH
+{
+  class PhysicsSystem;
+}
+
+namespace JDebug::API
+{
+  struct JPHBodySnapshot;
+
+  /**
+   * @struct JPHInterestSet
+   * @brief Describes which bodies a client wants to see, sent by the Inspector with Protocol::s_uiMsgInterest.
+   *
+   * A body is of interest if it overlaps one of the regions and its object layer is in the layer mask, or if it is listed explicitly.
+   * Without regions and explicit bodies, all bodies whose layer is in the mask are of interest.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHInterestSet
+  {
+    static constexpr nsUInt64 s_uiAllLayers = 0xFFFFFFFFFFFFFFFFull;
+    static constexpr nsUInt8 s_uiVersion = 1;
+
+    nsDynamicArray<nsBoundingBox> m_Regions;     ///< World space boxes, e.g. the view of the client.
+    nsUInt64 m_uiObjectLayerMask = s_uiAllLayers; ///< Bit N selects object layer N. Layers 64 and above are always selected.
+    nsDynamicArray<nsUInt32> m_BodyIDs;          ///< JPH::BodyID::GetIndexAndSequenceNumber() of bodies that are always included.
+
+    /**
+     * @brief Returns whether the set selects all bodies, i.e. there is nothing to filter.
+     */
+    bool SelectsAll() const { return m_Regions.IsEmpty() && m_BodyIDs.IsEmpty() && m_uiObjectLayerMask == s_uiAllLayers; }
+
+    /**
+     * @brief Returns whether the given object layer is in the layer mask.
+     */
+    bool IsLayerSelected(nsUInt32 in_uiObjectLayer) const { return in_uiObjectLayer >= 64 || (m_uiObjectLayerMask & (nsUInt64(1) << in_uiObjectLayer)) != 0; }
+
+    /**
+     * @brief Writes the set in the format of the Protocol::s_uiMsgInterest message.
+     */
+    nsResult Write(nsStreamWriter& inout_stream) const;
+
+    /**
+     * @brief Reads a set written by Write().
+     */
+    nsResult Read(nsStreamReader& inout_stream);
+  };
+
+  /**
+   * @struct JPHInterestFilterSettings
+   * @brief Hysteresis of JPHInterestFilter.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHInterestFilterSettings
+  {
+    float m_fRegionMargin = 2.0f; ///< A body enters at the region bounds, but only leaves once it is further outside than this, in meters.
+    nsUInt8 m_uiLingerSteps = 30; ///< A body that left the interest set is still streamed for this many steps, in case it comes back.
+  };
+
+  /**
+   * @class JPHInterestFilter
+   * @brief Resolves a JPHInterestSet to a per slot mask of the bodies that are streamed to the client.
+   *
+   * The regions are looked up through the broad phase of the physics system (BroadPhaseQuery::CollideAABox()), so the cost
+   * depends on the number of bodies inside the regions, not on the total number of bodies.
+   * To avoid bodies popping in and out at the border of a region, a body only leaves the set once it is m_fRegionMargin outside
+   * of the region, and after that it is kept for another m_uiLingerSteps steps.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHInterestFilter
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHInterestFilter);
+
+  public:
+    JPHInterestFilter();
+    ~JPHInterestFilter();
+
+    /**
+     * @brief Changes the hysteresis settings.
+     */
+    void SetSettings(const JPHInterestFilterSettings& in_settings) { m_Settings = in_settings; }
+
+    /**
+     * @brief Returns the hysteresis settings.
+     */
+    const JPHInterestFilterSettings& GetSettings() const { return m_Settings; }
+
+    /**
+     * @brief Replaces the interest set. Bodies that were of interest before still linger as configured.
+     */
+    void SetInterestSet(const JPHInterestSet& in_set);
+
+    /**
+     * @brief Returns the current interest set.
+     */
+    const JPHInterestSet& GetInterestSet() const { return m_InterestSet; }
+
+    /**
+     * @brief Returns whether the filter removes any bodies, i.e. whether GetMask() has to be applied.
+     */
+    bool IsActive() const { return !m_InterestSet.SelectsAll(); }
+
+    /**
+     * @brief Resolves the interest set for the given snapshot.
+     *
+     * Must be called while no other thread modifies the bodies.
+     * @param in_pPhysicsSystem Used for the region queries. If nullptr, the body positions in the snapshot are tested against the regions instead.
+     * @param in_snapshot The snapshot that is going to be encoded.
+     */
+    void Update(const JPH::PhysicsSystem* in_pPhysicsSystem, const JPHBodySnapshot& in_snapshot);
+
+    /**
+     * @brief Returns the mask computed by the last Update(). Non-zero entries mark slots of bodies that are of interest.
+     */
+    nsArrayPtr<const nsUInt8> GetMask() const { return m_Mask; }
+
+    /**
+     * @brief Returns the slots whose mask entry changed in the last Update(), e.g. for JPHFrameEncoder::AddChangedSlots().
+     *
+     * A body that enters or leaves the set has to be sent or removed even if it is asleep. New slots count as changed if they are of interest.
+     */
+    nsArrayPtr<const nsUInt32> GetChangedSlots() const { return m_ChangedSlots; }
+
+    /**
+     * @brief Returns the number of bodies that were of interest in the last Update().
+     */
+    nsUInt32 GetNumSelectedBodies() const { return m_uiNumSelectedBodies; }
+
+  private:
+    void MarkRegions(const JPH::PhysicsSystem* pPhysicsSystem, const JPHBodySnapshot& snapshot);
+
+    JPHInterestFilterSettings m_Settings;
+    JPHInterestSet m_InterestSet;
+
+    nsDynamicArray<nsUInt8> m_Hits;       ///< Per slot, 0 = not hit, 1 = hit by a region including its margin, 2 = hit by a region.
+    nsDynamicArray<nsUInt8> m_TimeToLive; ///< Per slot, steps until the body leaves the set, 0 if it is not of interest.
+    nsDynamicArray<nsUInt8> m_Mask;
+    nsDynamicArray<nsUInt32> m_ChangedSlots; ///< The slots whose m_Mask entry differs from the Update() before.
+    nsUInt32 m_uiNumSelectedBodies = 0;
+  };
+} // namespace JDebug::API
@@ -0,0 +1,67 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Time/Time.h>
+
+namespace JDebug::API
+{
+  /**
+   * @struct JPHJobSystemBenchmarkSettings
+   * @brief Configuration of JPHJobSystemBenchmark.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHJobSystemBenchmarkSettings
+  {
+    nsUInt32 m_uiNumBodies = 4096;                                         ///< Number of dynamic boxes that are dropped onto a floor.
+    nsUInt32 m_uiNumWarmupSteps = 10;                                      ///< Steps that are simulated but not measured.
+    nsUInt32 m_uiNumSteps = 120;                                           ///< Steps that are measured.
+    float m_fDeltaTime = 1.0f / 60.0f;                                     ///< Time step of the simulation.
+    nsUInt32 m_uiMaxThreads = 32;                                          ///< Thread counts from 2 up to this value are measured in powers of two.
+    nsTaskPriority::Enum m_eTaskPriority = nsTaskPriority::EarlyThisFrame; ///< Priority of the JPHTaskJobSystem jobs.
+  };
+
+  /**
+   * @brief Step times of both job systems for one thread count.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHJobSystemBenchmarkResult
+  {
+    nsUInt32 m_uiNumThreads = 0; ///< Threads that execute jobs, including the thread that calls PhysicsSystem::Update().
+    nsTime m_ThreadPoolAverage;  ///< Average step time with JPH::JobSystemThreadPool.
+    nsTime m_ThreadPoolMin;      ///< Fastest step with JPH::JobSystemThreadPool.
+    nsTime m_TaskSystemAverage;  ///< Average step time with JPHTaskJobSystem.
+    nsTime m_TaskSystemMin;      ///< Fastest step with JPHTaskJobSystem.
+  };
+
+  /**
+   * @class JPHJobSystemBenchmark
+   * @brief Compares the physics step time of JPHTaskJobSystem and JPH::JobSystemThreadPool.
+   *
+   * For every thread count the same scene is built twice and simulated with either job system. The thread pool gets
+   * one thread less than the thread count, because the calling thread helps, the task system is configured to the same number of short task workers.
+   * A single thread is not measured, since the task system always keeps at least one worker and would not be comparable to a pool without workers.
+   * The worker configuration of the task system is restored afterwards.
+   *
+   * Jolt has to be initialized (allocator, factory and JPH::RegisterTypes()) before the benchmark runs.
+   * Nothing else should use the task system while the benchmark runs, since it changes the number of worker threads.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHJobSystemBenchmark
+  {
+  public:
+    /**
+     * @brief Runs the benchmark for 2, 4, 8, ... up to the configured number of threads.
+     * @param in_settings The scene and the thread counts.
+     * @param out_results Receives one entry per thread count.
+     */
+    static void Run(const JPHJobSystemBenchmarkSettings& in_settings, nsDynamicArray<JPHJobSystemBenchmarkResult>& out_results);
+
+    /**
+     * @brief Writes the results as a table to nsLog.
+     */
+    static void LogResults(nsArrayPtr<const JPHJobSystemBenchmarkResult> in_results);
+  };
+} // namespace JDebug::API
@@ -0,0 +1,108 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+
+class nsAllocator;
+
+namespace JDebug::API
+{
+  /**
+   * @brief The nsAllocator a Jolt allocation is attributed to, see JPHMemory.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHAllocationCategory
+  {
+    using StorageType = nsUInt8;
+
+    enum Enum : nsUInt8
+    {
+      General,    ///< Everything that is not made inside a JPHMemory::ScopedCategory, e.g. the allocations of the physics step.
+      Bodies,     ///< Bodies, motion properties and the body manager.
+      Shapes,     ///< Shapes, materials and the data they are built from.
+      BroadPhase, ///< The broad phase trees and the layers.
+      Contacts,   ///< The contact caches and the contact constraint manager.
+
+      ENUM_COUNT,
+      Default = General
+    };
+
+    /**
+     * @brief Returns the display name of a category, the allocator of the category is called "Jolt/<name>".
+     */
+    static const char* GetName(Enum in_eCategory);
+  };
+
+  /**
+   * @class JPHMemory
+   * @brief Routes Jolt's global allocation functions into nsAllocators, so Jolt's memory shows up in nsMemoryTracker.
+   *
+   * Install() replaces JPH::Allocate, JPH::Reallocate, JPH::Free, JPH::AlignedAllocate and JPH::AlignedFree. Every allocation then goes
+   * through the proxy allocator of one JPHAllocationCategory, all of them children of a "Jolt" proxy allocator. Jolt does not say what an
+   * allocation is for, so the category is the one of the innermost ScopedCategory on the calling thread, General without one.
+   * The category is stored in front of each block, so a block is always freed through the allocator it came from.
+   *
+   * Jolt allocates on its own while building objects, so the category follows the code that calls into Jolt, e.g. restoring a shape
+   * under Shapes, creating bodies under Bodies and adding them to the broad phase under BroadPhase. PhysicsSystem::Init() allocates for
+   * all parts at once, the contact caches are the largest of them, so it is attributed to Contacts.
+   *
+   * The plugin scopes the Jolt objects it creates itself: the replay scene in JPHReplayEngine, the shape maps of the scene capture and
+   * the scene of JPHJobSystemBenchmark. Constraints and the allocations of the physics step stay in General. The physics system of the
+   * application is only attributed if the application wraps its own calls, e.g. PhysicsSystem::Init() in a Contacts scope and body creation
+   * in a Bodies scope; otherwise all of it lands in General.
+   *
+   * Jolt does not track where a block came from, so Install() has to run before the first Jolt allocation, in place of
+   * JPH::RegisterDefaultAllocator(), and Uninstall() after the last Jolt object is gone, including the JPH::Factory.
+   * Unlike the profiler bridge it is therefore not installed by the plugin, the application decides.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHMemory
+  {
+  public:
+    /**
+     * @brief Attributes the Jolt allocations of the current thread to a category while the scope is alive. Scopes can be nested.
+     */
+    class NS_INSPECTORPLUGIN_DLL ScopedCategory
+    {
+      NS_DISALLOW_COPY_AND_ASSIGN(ScopedCategory);
+
+    public:
+      explicit ScopedCategory(JPHAllocationCategory::Enum eCategory);
+      ~ScopedCategory();
+
+    private:
+      JPHAllocationCategory::Enum m_ePreviousCategory = JPHAllocationCategory::Default;
+    };
+
+    /**
+     * @brief Creates the allocators and routes Jolt's allocations into them. Must be called before Jolt allocates anything.
+     *
+     * Does nothing if Jolt was built with JPH_DISABLE_CUSTOM_ALLOCATOR.
+     */
+    static void Install();
+
+    /**
+     * @brief Restores Jolt's default allocation functions and destroys the allocators.
+     *
+     * Blocks allocated through the hooks cannot be freed by Jolt's default functions, so while any of them is alive
+     * this logs an error and leaves the hooks installed.
+     */
+    static void Uninstall();
+
+    /**
+     * @brief Returns whether Jolt's allocations are currently routed into the allocators.
+     */
+    static bool IsInstalled();
+
+    /**
+     * @brief Returns the allocator of a category, nullptr while the hooks are not installed.
+     */
+    static nsAllocator* GetAllocator(JPHAllocationCategory::Enum in_eCategory);
+
+    /**
+     * @brief Returns the number of blocks allocated through the hooks that were not freed yet.
+     */
+    static nsUInt64 GetNumLiveAllocations();
+  };
+} // namespace JDebug::API
@@ -0,0 +1,46 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+
+namespace JDebug::API
+{
+  /**
+   * @class JPHProfilerBridge
+   * @brief Forwards Jolt's JPH_PROFILE scopes into nsProfilingSystem.
+   *
+   * Jolt is built with JPH_EXTERNAL_PROFILE, so every JPH_PROFILE scope becomes an ExternalProfileMeasurement.
+   * The bridge turns each measurement into an nsProfilingSystem CPU scope on the calling thread, so Jolt's jobs
+   * (broadphase, narrowphase, solver, islands) show up next to the engine scopes in a profiling capture.
+   *
+   * The measurement callbacks are function pointers in Jolt that do nothing by default, Install() replaces them and
+   * Uninstall() restores the no-ops, so Jolt links without the plugin and the plugin can be unloaded.
+   * The bridge also hands the scopes of the step phases to JPHStepMonitor while its timing is enabled, that part
+   * works without NS_USE_PROFILING as well.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHProfilerBridge
+  {
+  public:
+    /**
+     * @brief Starts forwarding Jolt profiling scopes. Called on plugin startup.
+     *
+     * Must not be called while a physics update is running, a scope that started before and ends after the call would be malformed.
+     */
+    static void Install();
+
+    /**
+     * @brief Stops forwarding Jolt profiling scopes. Called on plugin shutdown.
+     *
+     * Same as Install(), this must not be called while a physics update is running.
+     */
+    static void Uninstall();
+
+    /**
+     * @brief Returns whether Jolt scopes are currently forwarded.
+     */
+    static bool IsInstalled();
+  };
+} // namespace JDebug::API
@@ -0,0 +1,91 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+
+/*
+ *   JPHProtocol.h
+ *
+ *   Telemetry system and message IDs used between the JDebug Jolt interface (server) and the Inspector (client).
+ *   Message payloads are documented next to the code that writes them.
+ */
+
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+
+namespace JDebug::API::Protocol
+{
+  /// The nsTelemetry system ID of all Jolt debugger messages.
+  static constexpr nsUInt32 s_uiSystemID = 'JOLT';
+
+  /// Server -> Client: One frame encoded by JPHFrameEncoder.
+  static constexpr nsUInt32 s_uiMsgFrame = 'FRAM';
+
+  /// Server -> Client: The geometry of one shape, see JPHShapeDictionary for the layout.
+  /// Sent before the first frame that references the shape, and for all known shapes when a client connects.
+  static constexpr nsUInt32 s_uiMsgShapeAdd = 'SHPA';
+
+  /// Server -> Client: u32 count, then count u32 IDs of shapes that were released. IDs are never reused.
+  static constexpr nsUInt32 s_uiMsgShapeRemove = 'SHPR';
+
+  /// Server -> Client: u64 step index, then the contacts of that step as written by JPHContactRecorder::WriteContacts().
+  /// Sent after the frame of the step. Each message is complete on its own, so it is sent unreliably.
+  static constexpr nsUInt32 s_uiMsgContacts = 'CNTC';
+
+  /// Server -> Client: u64 step index, then the JPHStateHash of that step as written by JPHStateHash::Write().
+  /// Sent after the frame of the step, reliably, so a client can compare every step with another run.
+  static constexpr nsUInt32 s_uiMsgStateHash = 'HASH';
+
+  /// Server -> Client: u64 step index, then the JPHStepStatistics of that step as written by JPHStepStatistics::Write().
+  /// Sent after the frame of the step. Each message is complete on its own, so it is sent unreliably.
+  static constexpr nsUInt32 s_uiMsgStepStatistics = 'STEP';
+
+  /// Server -> Client: The vertices of all soft bodies, a frame written by JPHSoftBodyEncoder. Sent after the frame of the step,
+  /// only every JPHSoftBodyCaptureSettings::m_uiSampleInterval steps. Delta frames build on each other, so it is sent reliably.
+  static constexpr nsUInt32 s_uiMsgSoftBodies = 'SOFT';
+
+  /// Server -> Client: What was drawn through the JPHDebugRenderer during the step, a frame written by JPHDebugRenderer::EncodeFrame().
+  /// Sent after the frame of the step. Batches are only sent once and delta frames build on each other, so it is sent reliably.
+  static constexpr nsUInt32 s_uiMsgDebugDraw = 'DRAW';
+
+  /// Server -> Client: u64 step index, then the queries recorded during that step as written by JPHQueryRecorder::WriteRecords().
+  /// Sent after the frame of the step. Each message is complete on its own, so it is sent unreliably.
+  static constexpr nsUInt32 s_uiMsgQueries = 'QURY';
+
+  /// Server -> Client: u64 step index, then the JPHConstraintStatistics of that step as written by JPHConstraintStatistics::Write().
+  /// Sent after the frame of the step. Each message is complete on its own, so it is sent unreliably.
+  static constexpr nsUInt32 s_uiMsgConstraints = 'CSTR';
+
+  /// Server -> Client: u64 step index, then the JPHAggregateGrid of that step as written by JPHAggregateGrid::Write(). Only sent while
+  /// the client has an interest set and aggregation is enabled, it summarizes the bodies missing from the frame of the step.
+  /// Each message is complete on its own, so it is sent unreliably.
+  static constexpr nsUInt32 s_uiMsgAggregates = 'AGGR';
+
+  /// Client -> Server: u32 sample interval, u64 slow query threshold in nanoseconds. Changes the sampling of the JPHQueryRecorder,
+  /// the other settings are kept.
+  static constexpr nsUInt32 s_uiMsgQuerySettings = 'QCFG';
+
+  /// Client -> Server: A JPHInterestSet, see JPHInterestSet::Write(). Only the selected bodies are streamed to the client from then on.
+  static constexpr nsUInt32 s_uiMsgInterest = 'INTR';
+
+  /// Client -> Server: u32 count, then count u32 JPH::BodyID::GetIndexAndSequenceNumber(). Asks for the details of these bodies, which are
+  /// resolved at the end of the next step and answered with s_uiMsgBodyDetails, see JPHDebuggerInterface::RequestBodyDetails().
+  static constexpr nsUInt32 s_uiMsgBodyDetailRequest = 'BDRQ';
+
+  /// Server -> Client: The details of the bodies requested with s_uiMsgBodyDetailRequest, all bodies resolved in one step as written by
+  /// JPHBodyDetailBatch::Write(). Only sent in reply to a request, and reliably, since the client waits for it.
+  static constexpr nsUInt32 s_uiMsgBodyDetails = 'BDTL';
+
+  /// Server -> Client: The physics systems of a JPHDebuggerHub. u32 count, per system u32 stream ID, u32 name length, UTF-8 name.
+  /// Sent when a client connects and whenever systems are added or removed.
+  static constexpr nsUInt32 s_uiMsgStreamList = 'STRL';
+
+  /// Client -> Server: u32 count, then count u32 stream IDs. Replaces the set of systems of a JPHDebuggerHub the client watches.
+  /// A newly connected client watches all of them until it sends this.
+  static constexpr nsUInt32 s_uiMsgSubscribe = 'SUBS';
+
+  /// Both directions: u32 stream ID, u32 message ID, then the payload of that message. With a JPHDebuggerHub, all messages of
+  /// a physics system are wrapped like this in both directions, the transmit mode is the one of the wrapped message.
+  static constexpr nsUInt32 s_uiMsgStream = 'STRM';
+} // namespace JDebug::API::Protocol
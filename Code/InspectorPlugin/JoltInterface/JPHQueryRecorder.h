@@ -0,0 +1,277 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Math/Vec3.h>
+#include <Foundation/Strings/String.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Time/Time.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Collision/BroadPhase/BroadPhaseQuery.h>
+#include <Jolt/Physics/Collision/NarrowPhaseQuery.h>
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+
+namespace JPH
+{
+  class PhysicsSystem;
+  class RayCastSettings;
+  class ShapeCastSettings;
+} // namespace JPH
+
+namespace JDebug::API
+{
+  /**
+   * @brief The query function a JPHQueryRecord was created for.
+   */
+  enum class JPHQueryType : nsUInt8
+  {
+    CastRay,                  ///< NarrowPhaseQuery::CastRay() for the closest hit.
+    CastRayCollector,         ///< NarrowPhaseQuery::CastRay() with a collector.
+    CollidePoint,             ///< NarrowPhaseQuery::CollidePoint()
+    CollideShape,             ///< NarrowPhaseQuery::CollideShape()
+    CastShape,                ///< NarrowPhaseQuery::CastShape()
+    CollectTransformedShapes, ///< NarrowPhaseQuery::CollectTransformedShapes()
+    BroadPhaseCastRay,        ///< BroadPhaseQuery::CastRay()
+    BroadPhaseCollideAABox,   ///< BroadPhaseQuery::CollideAABox()
+    BroadPhaseCollideSphere,  ///< BroadPhaseQuery::CollideSphere()
+    BroadPhaseCollidePoint,   ///< BroadPhaseQuery::CollidePoint()
+    BroadPhaseCollideBox,     ///< BroadPhaseQuery::CollideOrientedBox()
+    BroadPhaseCastAABox,      ///< BroadPhaseQuery::CastAABox()
+
+    ENUM_COUNT
+  };
+
+  /**
+   * @struct JPHQueryRecord
+   * @brief One query that was recorded by JPHQueryRecorder, because it was sampled or slow.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHQueryRecord
+  {
+    /// m_uiShapeSubType of queries without a shape.
+    static constexpr nsUInt8 s_uiNoShape = 0xFF;
+
+    enum Flags : nsUInt8
+    {
+      Sampled = NS_BIT(0), ///< The query was picked by the sample interval.
+      Slow = NS_BIT(1),    ///< The query took longer than the slow query threshold.
+    };
+
+    nsUInt32 m_uiDurationNs = 0;                  ///< Time spent in the query.
+    nsUInt32 m_uiNumCandidates = 0;               ///< Bodies the broad phase passed to the body filter, for broad phase queries the hits.
+    nsUInt32 m_uiNumFiltered = 0;                 ///< Candidates the body filter rejected.
+    nsUInt32 m_uiNumHits = 0;                     ///< Results passed to the collector, 0 or 1 for the closest hit ray cast.
+    nsUInt32 m_uiBroadPhaseLayerMask = 0;         ///< Bit per broad phase layer the filter accepts, see JPHQueryRecorderSettings::m_uiNumBroadPhaseLayers.
+    nsUInt64 m_uiObjectLayerMask = 0;             ///< Bit per object layer the filter accepts, see JPHQueryRecorderSettings::m_uiNumObjectLayers.
+    nsVec3 m_vPosition;                           ///< Origin of rays and casts, the point or the center of the volume otherwise.
+    nsVec3 m_vDirection;                          ///< Direction and length of rays and casts, zero otherwise.
+    nsVec3 m_vExtents;                            ///< Half extents of the query shape or box, the radius of a sphere in x.
+    JPHQueryType m_eType = JPHQueryType::CastRay; ///< The query function.
+    nsUInt8 m_uiFlags = 0;                        ///< Flags
+    nsUInt8 m_uiShapeSubType = s_uiNoShape;       ///< JPH::EShapeSubType of the query shape, if any.
+    nsString m_sTag;                              ///< The tag of the JPHQueryRecorder::ScopedTag active on the calling thread.
+  };
+
+  /**
+   * @struct JPHQueryTotals
+   * @brief Number and duration of all queries of one type, recorded or not.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHQueryTotals
+  {
+    nsUInt32 m_uiNumQueries = 0;
+    nsUInt64 m_uiDurationNs = 0;
+  };
+
+  /**
+   * @struct JPHQueryRecorderSettings
+   * @brief Configuration of JPHQueryRecorder.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHQueryRecorderSettings
+  {
+    nsUInt32 m_uiSampleInterval = 1000;                              ///< Every N-th query of a thread is recorded. 0 records no samples.
+    nsTime m_SlowQueryThreshold = nsTime::MakeFromMicroseconds(100); ///< Queries that take longer are always recorded. Zero disables it.
+    nsUInt32 m_uiMaxRecords = 256;                                   ///< Sampled and slow records kept per frame, each. More are counted as dropped.
+    nsUInt32 m_uiNumBroadPhaseLayers = 0;                            ///< Broad phase layers the filter of a recorded query is evaluated for, at most 32.
+    nsUInt32 m_uiNumObjectLayers = 0;                                ///< Object layers the filter of a recorded query is evaluated for, at most 64.
+  };
+
+  /**
+   * @class JPHQueryRecorder
+   * @brief Times the collision queries of the application and records the sampled and the slow ones for the debugger.
+   *
+   * The recorder has the same query functions as JPH::NarrowPhaseQuery, and GetBroadPhaseQuery() returns a JPH::BroadPhaseQuery,
+   * so code that should be profiled calls its queries through the recorder instead of through the physics system. While recording,
+   * every query is timed and counted per type. Every JPHQueryRecorderSettings::m_uiSampleInterval-th query of a thread, and every
+   * query slower than the threshold, is recorded with its candidate and hit counts, which are collected by wrapping the body filter
+   * and the collector of the query. The layer masks the filters accept are only evaluated for recorded queries, after the query was timed.
+   *
+   * The interval and the threshold can be changed while the application runs, JPHDebuggerInterface applies the ones the client sends
+   * with Protocol::s_uiMsgQuerySettings. While not recording, the queries are forwarded without any overhead but a branch.
+   *
+   * All query functions can be called from any thread, also while the physics system is updated.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHQueryRecorder
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHQueryRecorder);
+
+  public:
+    /**
+     * @brief Sets the tag of the queries the current thread makes while the scope is alive, e.g. the name of the gameplay system.
+     *
+     * The tag must be a string that outlives the scope, usually a literal. Scopes can be nested.
+     */
+    class NS_INSPECTORPLUGIN_DLL ScopedTag
+    {
+      NS_DISALLOW_COPY_AND_ASSIGN(ScopedTag);
+
+    public:
+      explicit ScopedTag(const char* szTag);
+      ~ScopedTag();
+
+    private:
+      const char* m_szPreviousTag = nullptr;
+    };
+
+  public:
+    JPHQueryRecorder();
+    ~JPHQueryRecorder();
+
+    /**
+     * @brief Forwards all queries to the physics system.
+     * @param in_bLockBodies Whether the queries go through PhysicsSystem::GetNarrowPhaseQuery() or GetNarrowPhaseQueryNoLock().
+     */
+    void Attach(const JPH::PhysicsSystem& in_system, bool in_bLockBodies = true);
+
+    /**
+     * @brief Changes the settings. Can be called at any time, queries that run at the same time may still use the old interval and threshold.
+     */
+    void SetSettings(const JPHQueryRecorderSettings& in_settings);
+
+    /**
+     * @brief Returns the current settings.
+     */
+    JPHQueryRecorderSettings GetSettings() const;
+
+    /**
+     * @brief Enables or disables recording. Queries are still forwarded while disabled.
+     */
+    void SetRecording(bool in_bRecording) { m_bRecording = in_bRecording; }
+
+    /**
+     * @brief Returns whether queries are timed and recorded.
+     */
+    bool IsRecording() const { return m_bRecording; }
+
+    /**
+     * @brief Returns a broad phase query that records its queries like the narrow phase queries of the recorder.
+     */
+    const JPH::BroadPhaseQuery& GetBroadPhaseQuery() const { return m_BroadPhase; }
+
+    /**
+     * @brief Moves the records and totals since the last call into GetRecords() and GetTotals().
+     *
+     * Records are sorted by duration, slowest first. Can be called while queries run.
+     */
+    void CollectRecords();
+
+    /**
+     * @brief Returns the records collected by the last CollectRecords().
+     */
+    nsArrayPtr<const JPHQueryRecord> GetRecords() const { return m_Records; }
+
+    /**
+     * @brief Returns the totals per JPHQueryType collected by the last CollectRecords().
+     */
+    nsArrayPtr<const JPHQueryTotals> GetTotals() const { return nsMakeArrayPtr(m_Totals); }
+
+    /**
+     * @brief Returns the number of records the last CollectRecords() did not get because of the m_uiMaxRecords budget.
+     */
+    nsUInt32 GetNumDroppedRecords() const { return m_uiNumDroppedRecords; }
+
+    /**
+     * @brief Serializes records and totals for the network stream and the capture file.
+     *
+     * Layout: u8 type count, per type varuint query count, varuint duration in ns, varuint dropped count, varuint record count,
+     * per record: u8 JPHQueryType, u8 flags, u8 shape sub type, varuint duration in ns, varuint candidates, varuint filtered, varuint hits,
+     * u32 broad phase layer mask, u64 object layer mask, float[3] position, float[3] direction, float[3] extents, varuint tag length, UTF-8 tag.
+     */
+    static void WriteRecords(nsArrayPtr<const JPHQueryRecord> in_records, nsArrayPtr<const JPHQueryTotals> in_totals, nsUInt32 in_uiNumDropped, nsDynamicArray<nsUInt8>& out_data);
+
+    /**
+     * @brief Reads data written by WriteRecords(). Totals of types this version does not know are ignored.
+     * @param out_totals Receives one entry per JPHQueryType.
+     * @return NS_FAILURE if the data is corrupt.
+     */
+    static nsResult ReadRecords(nsArrayPtr<const nsUInt8> in_data, nsDynamicArray<JPHQueryRecord>& out_records, nsDynamicArray<JPHQueryTotals>& out_totals, nsUInt32& out_uiNumDropped);
+
+  public:
+    // JPH::NarrowPhaseQuery
+    bool CastRay(const JPH::RRayCast& inRay, JPH::RayCastResult& ioHit, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}, const JPH::BodyFilter& inBodyFilter = {}) const;
+    void CastRay(const JPH::RRayCast& inRay, const JPH::RayCastSettings& inRayCastSettings, JPH::CastRayCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}, const JPH::BodyFilter& inBodyFilter = {}, const JPH::ShapeFilter& inShapeFilter = {}) const;
+    void CollidePoint(JPH::RVec3Arg inPoint, JPH::CollidePointCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}, const JPH::BodyFilter& inBodyFilter = {}, const JPH::ShapeFilter& inShapeFilter = {}) const;
+    void CollideShape(const JPH::Shape* inShape, JPH::Vec3Arg inShapeScale, JPH::RMat44Arg inCenterOfMassTransform, const JPH::CollideShapeSettings& inCollideShapeSettings, JPH::RVec3Arg inBaseOffset, JPH::CollideShapeCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}, const JPH::BodyFilter& inBodyFilter = {}, const JPH::ShapeFilter& inShapeFilter = {}) const;
+    void CastShape(const JPH::RShapeCast& inShapeCast, const JPH::ShapeCastSettings& inShapeCastSettings, JPH::RVec3Arg inBaseOffset, JPH::CastShapeCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}, const JPH::BodyFilter& inBodyFilter = {}, const JPH::ShapeFilter& inShapeFilter = {}) const;
+    void CollectTransformedShapes(const JPH::AABox& inBox, JPH::TransformedShapeCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}, const JPH::BodyFilter& inBodyFilter = {}, const JPH::ShapeFilter& inShapeFilter = {}) const;
+
+  private:
+    /// Forwards to the broad phase of the physics system and reports to the recorder.
+    class BroadPhase final : public JPH::BroadPhaseQuery
+    {
+    public:
+      virtual void CastRay(const JPH::RayCast& inRay, JPH::RayCastBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}) const override;
+      virtual void CollideAABox(const JPH::AABox& inBox, JPH::CollideShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}) const override;
+      virtual void CollideSphere(JPH::Vec3Arg inCenter, float inRadius, JPH::CollideShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}) const override;
+      virtual void CollidePoint(JPH::Vec3Arg inPoint, JPH::CollideShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}) const override;
+      virtual void CollideOrientedBox(const JPH::OrientedBox& inBox, JPH::CollideShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}) const override;
+      virtual void CastAABox(const JPH::AABoxCast& inBox, JPH::CastShapeBodyCollector& ioCollector, const JPH::BroadPhaseLayerFilter& inBroadPhaseLayerFilter = {}, const JPH::ObjectLayerFilter& inObjectLayerFilter = {}) const override;
+
+      JPHQueryRecorder* m_pRecorder = nullptr;
+      const JPH::BroadPhaseQuery* m_pQuery = nullptr;
+    };
+
+    /// What is known about a query after it ran.
+    struct QueryInfo
+    {
+      JPHQueryType m_eType = JPHQueryType::CastRay;
+      nsTime m_StartTime;
+      const JPH::BroadPhaseLayerFilter* m_pBroadPhaseLayerFilter = nullptr;
+      const JPH::ObjectLayerFilter* m_pObjectLayerFilter = nullptr;
+      const JPH::Shape* m_pShape = nullptr;
+      nsUInt32 m_uiNumCandidates = 0;
+      nsUInt32 m_uiNumFiltered = 0;
+      nsUInt32 m_uiNumHits = 0;
+      nsVec3 m_vPosition = nsVec3::MakeZero();
+      nsVec3 m_vDirection = nsVec3::MakeZero();
+      nsVec3 m_vExtents = nsVec3::MakeZero();
+    };
+
+    static QueryInfo BeginQuery(JPHQueryType eType, const JPH::BroadPhaseLayerFilter& broadPhaseLayerFilter, const JPH::ObjectLayerFilter& objectLayerFilter);
+    void EndQuery(const QueryInfo& info) const;
+
+    const JPH::NarrowPhaseQuery* m_pNarrowPhase = nullptr;
+    BroadPhase m_BroadPhase;
+    nsAtomicBool m_bRecording;
+
+    nsAtomicInteger32 m_iSampleInterval;       ///< m_Settings.m_uiSampleInterval, read by the query threads.
+    nsAtomicInteger64 m_iSlowQueryThresholdNs; ///< m_Settings.m_SlowQueryThreshold, read by the query threads.
+    mutable nsAtomicInteger32 m_QueryCounts[(int)JPHQueryType::ENUM_COUNT];
+    mutable nsAtomicInteger64 m_QueryDurations[(int)JPHQueryType::ENUM_COUNT];
+
+    mutable nsMutex m_Mutex;                                 ///< Protects the settings and the pending records.
+    JPHQueryRecorderSettings m_Settings;                     ///< Settings
+    mutable nsDynamicArray<JPHQueryRecord> m_SampledRecords; ///< Sampled queries since the last CollectRecords() that were not slow.
+    mutable nsDynamicArray<JPHQueryRecord> m_SlowRecords;    ///< Slow queries since the last CollectRecords().
+    mutable nsUInt32 m_uiNumPendingDropped = 0;              ///< Records that did not fit since the last CollectRecords().
+
+    nsDynamicArray<JPHQueryRecord> m_Records;
+    JPHQueryTotals m_Totals[(int)JPHQueryType::ENUM_COUNT];
+    nsUInt32 m_uiNumDroppedRecords = 0;
+  };
+} // namespace JDebug::API
@@ -0,0 +1,193 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Types/UniquePtr.h>
+#include <InspectorPlugin/JoltInterface/JPHArenaTempAllocator.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Body/BodyID.h>
+
+#include <memory>
+
+namespace JPH
+{
+  class BroadPhaseLayerInterface;
+  class ContactListener;
+  class JobSystem;
+  class ObjectLayerPairFilter;
+  class ObjectVsBroadPhaseLayerFilter;
+  class PhysicsSystem;
+} // namespace JPH
+
+namespace JDebug::API
+{
+  namespace IO
+  {
+    class JPHPVDFileReader;
+  }
+
+  /**
+   * @struct JPHStateCaptureSettings
+   * @brief Controls how often JPHDebuggerInterface stores the full simulation state in a capture, see JPHReplayEngine.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHStateCaptureSettings
+  {
+    nsUInt32 m_uiInterval = 0;         ///< A PhysicsState record is captured every N steps, re-simulating any step costs at most N - 1 steps. 0 disables state capture.
+    float m_fDeltaTime = 1.0f / 60.0f; ///< The delta time the application passes to PhysicsSystem::Update(), the replay steps with it.
+    nsInt32 m_iCollisionSteps = 1;     ///< The collision steps the application passes to PhysicsSystem::Update().
+  };
+
+  /**
+   * @struct JPHReplaySettings
+   * @brief Everything JPHReplayEngine needs to build its physics system that cannot be stored in the capture.
+   *
+   * The layer interfaces are application code, they have to be the same ones the captured physics system was initialized with.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHReplaySettings
+  {
+    const JPH::BroadPhaseLayerInterface* m_pBroadPhaseLayerInterface = nullptr;           ///< Required.
+    const JPH::ObjectVsBroadPhaseLayerFilter* m_pObjectVsBroadPhaseLayerFilter = nullptr; ///< Required.
+    const JPH::ObjectLayerPairFilter* m_pObjectLayerPairFilter = nullptr;                 ///< Required.
+    JPH::ContactListener* m_pContactListener = nullptr;                                   ///< Optional, needed if the application's listener changes contact settings.
+    nsUInt32 m_uiMaxBodyPairs = 65536;                                                    ///< Passed to PhysicsSystem::Init(), should match the captured system.
+    nsUInt32 m_uiMaxContactConstraints = 10240;                                           ///< Passed to PhysicsSystem::Init(), should match the captured system.
+    nsUInt32 m_uiTempAllocatorSize = 32 * 1024 * 1024;                                    ///< Size of the temp allocator used for stepping, in bytes. Steps that need more fall back to the heap.
+    nsUInt64 m_uiCacheSize = 256 * 1024 * 1024;                                           ///< Memory budget of the simulated snapshot cache, in bytes.
+  };
+
+  /**
+   * @class JPHReplayEngine
+   * @brief Re-simulates any step of a capture from the closest full state the capture holds.
+   *
+   * If JPHStateCaptureSettings::m_uiInterval is set, JPHDebuggerInterface stores the complete simulation state
+   * (PhysicsSystem::SaveState() through a JPH::StateRecorderImpl) every N steps, and a description of all bodies and constraints
+   * whenever they change. The replay engine builds a headless physics system from that description, restores the closest state
+   * at or before the requested step and steps forward from there. Every step it simulates is kept in a cache,
+   * so scrubbing back and forth within a state interval does not simulate anything again, and a random seek never simulates
+   * more than the interval.
+   *
+   * Jolt is deterministic for the same input, but the broad phase of the replay system is built from scratch, so pairs can be found in
+   * a different order than in the captured system. The re-simulated steps therefore match the captured ones closely, not bit for bit.
+   * Modifications the application made from the outside (added forces, moved bodies, ...) are not replayed and show up as a divergence
+   * until the next state. Added or removed bodies and constraints force a new state in the capture.
+   *
+   * Only two body constraints can be restored, captures of systems with other constraints (e.g. vehicles) contain no state.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHReplayEngine
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHReplayEngine);
+
+  public:
+    JPHReplayEngine();
+    ~JPHReplayEngine();
+
+    /**
+     * @brief Appends a PhysicsState record with the full state of the physics system, see IO::JPHPVDFileManager::AppendRecord().
+     *
+     * Layout: u32 version, float delta time, i32 collision steps, the data of PhysicsSystem::SaveState().
+     * Must be called while no other thread modifies the physics system.
+     */
+    static void WriteStateRecord(const JPH::PhysicsSystem& in_system, const JPHStateCaptureSettings& in_settings, nsDynamicArray<nsUInt8>& inout_records);
+
+    /**
+     * @brief Appends a PhysicsScene record that describes all bodies and constraints of the physics system.
+     *
+     * Layout: u32 version, u32 max bodies, u32 size and bytes of JPH::PhysicsSettings, u32 body count, per body: u32 body ID,
+     * u8 1 for soft bodies, the Jolt binary body creation settings, then u32 constraint count, per constraint: u32 body ID 1, u32 body ID 2
+     * and the Jolt binary constraint settings. Shapes, materials and group filters are only written once per record.
+     * @return NS_FAILURE if the system holds constraints that cannot be restored, nothing is written then.
+     */
+    static nsResult WriteSceneRecord(const JPH::PhysicsSystem& in_system, nsDynamicArray<nsUInt8>& inout_records);
+
+    /**
+     * @brief Prepares re-simulation of the given capture. The reader must stay open until Close() is called.
+     */
+    nsResult Open(const IO::JPHPVDFileReader& in_reader, const JPHReplaySettings& in_settings);
+
+    /**
+     * @brief Destroys the physics system and clears the cache.
+     */
+    void Close();
+
+    /**
+     * @brief Returns whether a capture is open.
+     */
+    bool IsOpen() const { return m_pReader != nullptr; }
+
+    /**
+     * @brief Returns whether the capture holds a state at or before the given step, i.e. whether the step can be simulated.
+     */
+    bool CanSimulate(nsUInt64 in_uiStepIndex) const;
+
+    /**
+     * @brief Returns the re-simulated state of all bodies after the given step.
+     *
+     * Shape IDs are not known to the replay, all entries of m_ShapeIDs are JPHShapeDictionary::s_uiInvalidShapeID.
+     * @return The snapshot, valid until the next call, or nullptr if the step cannot be simulated.
+     */
+    const JPHBodySnapshot* GetStep(nsUInt64 in_uiStepIndex);
+
+    /**
+     * @brief Returns the headless physics system, which is at GetSimulatedStep(), e.g. to inspect contacts or constraints.
+     */
+    const JPH::PhysicsSystem* GetPhysicsSystem() const { return m_pSystem.get(); }
+
+    /**
+     * @brief Returns the step the physics system is currently at, only meaningful if GetPhysicsSystem() is not nullptr.
+     */
+    nsUInt64 GetSimulatedStep() const { return m_uiSimStep; }
+
+    /**
+     * @brief Returns the number of physics steps simulated since Open(), to judge how well the cache works.
+     */
+    nsUInt64 GetNumSimulatedSteps() const { return m_uiNumSimulatedSteps; }
+
+    /**
+     * @brief Returns the usage of the temp allocator the replay steps with, to size JPHReplaySettings::m_uiTempAllocatorSize.
+     */
+    JPHTempAllocatorStats GetTempAllocatorStats() const;
+
+  private:
+    struct CacheEntry
+    {
+      nsUInt64 m_uiStepIndex = 0;
+      nsUInt64 m_uiLastUse = 0;
+      JPHBodySnapshot m_Snapshot;
+    };
+
+    nsResult RestoreState(nsUInt32 uiStateFrame);
+    nsResult BuildScene(nsArrayPtr<const nsUInt8> sceneData);
+    void DestroyScene();
+    JPHBodySnapshot& AddToCache(nsUInt64 uiStepIndex, nsUInt32 uiNumSlots);
+    void CaptureSimulatedStep();
+
+    const IO::JPHPVDFileReader* m_pReader = nullptr;
+    JPHReplaySettings m_Settings;
+
+    // Jolt objects use Jolt's allocator (JPH_OVERRIDE_NEW_DELETE), they can't be created with NS_DEFAULT_NEW
+    std::unique_ptr<JPHArenaTempAllocator> m_pTempAllocator;
+    std::unique_ptr<JPH::JobSystem> m_pJobSystem;
+    std::unique_ptr<JPH::PhysicsSystem> m_pSystem;
+    nsUInt32 m_uiSceneFrame = nsInvalidIndex; ///< The frame whose PhysicsScene record m_pSystem was built from.
+    nsUInt32 m_uiStateFrame = nsInvalidIndex; ///< The frame whose PhysicsState record the simulation started from.
+    nsUInt64 m_uiSimStep = 0;
+    float m_fDeltaTime = 0.0f;
+    nsInt32 m_iCollisionSteps = 1;
+    nsUInt64 m_uiNumSimulatedSteps = 0;
+
+    nsDynamicArray<nsUInt8> m_Payload; ///< Scratch buffer for decompressed frames.
+
+    nsDynamicArray<nsUniquePtr<CacheEntry>> m_Cache;
+    nsHashTable<nsUInt64, CacheEntry*> m_CacheLookup;
+    nsUInt64 m_uiCacheBytes = 0;
+    nsUInt64 m_uiUseCounter = 0;
+    JPH::Array<JPH::BodyID> m_BodyIDScratch;
+  };
+} // namespace JDebug::API
@@ -0,0 +1,175 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Math/Vec3.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Foundation/Types/UniquePtr.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+
+class nsCompressedStreamWriterZstd;
+
+NS_DEFINE_AS_POD_TYPE(JPH::Float3);
+
+namespace JDebug::API
+{
+  /**
+   * @struct JPHShapeGeometry
+   * @brief Decoded triangle mesh of a dictionary shape.
+   *
+   * Vertices are in the space of the body, i.e. relative to JPH::Body::GetPosition(), not to the center of mass.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHShapeGeometry
+  {
+    nsUInt32 m_uiShapeID = 0;                 ///< The dictionary ID of the shape.
+    nsUInt8 m_uiType = 0;                     ///< JPH::EShapeType
+    nsUInt8 m_uiSubType = 0;                  ///< JPH::EShapeSubType
+    nsVec3 m_vBoundsMin = nsVec3::MakeZero(); ///< Minimum of all vertices.
+    nsVec3 m_vBoundsMax = nsVec3::MakeZero(); ///< Maximum of all vertices.
+    nsDynamicArray<nsVec3> m_Vertices;        ///< Unique vertices, quantized to 16 bits per axis within the bounds.
+    nsDynamicArray<nsUInt32> m_Indices;       ///< Three indices per triangle, counter clockwise.
+  };
+
+  /**
+   * @struct JPHShapeDictionarySettings
+   * @brief Configuration of JPHShapeDictionary.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHShapeDictionarySettings
+  {
+    nsUInt32 m_uiMaxTriangles = 1024 * 1024; ///< Shapes with more triangles (e.g. huge height fields) are truncated.
+    nsUInt32 m_uiMinCompressedSize = 256;    ///< Geometry smaller than this many bytes is not compressed.
+  };
+
+  /**
+   * @class JPHShapeDictionary
+   * @brief Assigns 32-bit IDs to JPH::Shape instances and holds their triangulated geometry, so it only has to be sent once.
+   *
+   * Shapes are keyed by pointer. A new pointer is triangulated through Shape::GetTrianglesStart() / GetTrianglesNext(),
+   * the vertices are deduplicated, quantized to 16 bits within the bounds of the shape and the result is zstd compressed.
+   * Shapes whose geometry hashes to the same content share one ID, so e.g. identical convex hulls that were created
+   * separately are only stored once.
+   *
+   * The dictionary keeps a reference to every registered shape, that way a pointer cannot be reused by a different shape
+   * while it is registered. EvictReleasedShapes() drops shapes that nobody else references anymore. IDs are never reused,
+   * so a capture file can refer to any ID that was ever handed out.
+   *
+   * The geometry data of an ID has the following layout:
+   *   u32 shape ID, u8 version, u8 JPH::EShapeType, u8 JPH::EShapeSubType, u8 compression (IO::JPHPVDCompression),
+   *   nsVec3 bounds min, nsVec3 bounds max, u32 vertex count, u32 triangle count, u32 uncompressed payload size,
+   *   payload: u16[3] per vertex, quantized within the bounds, then 3 indices per triangle, each one a zigzag varint delta to the previous index.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHShapeDictionary
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHShapeDictionary);
+
+  public:
+    /// The ID of bodies without a shape.
+    static constexpr nsUInt32 s_uiInvalidShapeID = 0xFFFFFFFF;
+
+    static constexpr nsUInt8 s_uiGeometryVersion = 1;
+
+  public:
+    JPHShapeDictionary();
+    ~JPHShapeDictionary();
+
+    /**
+     * @brief Changes the triangulation settings. Only affects shapes that are registered afterwards.
+     */
+    void SetSettings(const JPHShapeDictionarySettings& in_settings) { m_Settings = in_settings; }
+
+    /**
+     * @brief Returns the current settings.
+     */
+    const JPHShapeDictionarySettings& GetSettings() const { return m_Settings; }
+
+    /**
+     * @brief Returns the ID of an already registered shape.
+     *
+     * Only reads the dictionary, so it can be called from multiple threads at once, as long as no shape is registered or evicted at the same time.
+     * @return s_uiInvalidShapeID if the shape is not registered (or nullptr).
+     */
+    nsUInt32 FindShapeID(const JPH::Shape* in_pShape) const;
+
+    /**
+     * @brief Returns the ID of the shape and registers it first, if necessary.
+     * @param in_pShape The shape, may be nullptr.
+     * @param out_bNewGeometry Set to true if the shape got an ID whose geometry has not been seen before and therefore has to be sent.
+     * @return s_uiInvalidShapeID for nullptr.
+     */
+    nsUInt32 RegisterShape(const JPH::Shape* in_pShape, bool& out_bNewGeometry);
+
+    /**
+     * @brief Drops all shapes that are only referenced by the dictionary anymore.
+     * @param out_removedIDs Receives the IDs whose geometry is not used by any shape anymore. Existing content is replaced.
+     */
+    void EvictReleasedShapes(nsDynamicArray<nsUInt32>& out_removedIDs);
+
+    /**
+     * @brief Returns the geometry data of an ID, in the layout described above. Empty for unknown IDs.
+     */
+    nsArrayPtr<const nsUInt8> GetGeometryData(nsUInt32 in_uiShapeID) const;
+
+    /**
+     * @brief Returns the IDs of all geometry that is currently in the dictionary, e.g. to resend it to a new client.
+     */
+    void GetShapeIDs(nsDynamicArray<nsUInt32>& out_shapeIDs) const;
+
+    /**
+     * @brief Returns the number of registered shape pointers.
+     */
+    nsUInt32 GetNumShapes() const { return m_Shapes.GetCount(); }
+
+    /**
+     * @brief Returns the number of unique geometries.
+     */
+    nsUInt32 GetNumGeometries() const { return m_Geometries.GetCount(); }
+
+    /**
+     * @brief Releases all shapes. IDs keep counting up, they are never reused.
+     */
+    void Clear();
+
+    /**
+     * @brief Decodes geometry data as returned by GetGeometryData().
+     * @return NS_FAILURE if the data is corrupt or uses an unknown version.
+     */
+    static nsResult DecodeGeometry(nsArrayPtr<const nsUInt8> in_data, JPHShapeGeometry& out_geometry);
+
+  private:
+    struct ShapeEntry
+    {
+      JPH::RefConst<JPH::Shape> m_pShape; ///< Keeps the pointer from being reused while it is registered.
+      nsUInt32 m_uiID = s_uiInvalidShapeID;
+    };
+
+    struct GeometryEntry
+    {
+      nsUInt64 m_uiContentHash = 0;
+      nsUInt32 m_uiNumShapes = 0; ///< Registered shape pointers that use this geometry.
+      nsDynamicArray<nsUInt8> m_Data;
+    };
+
+    void Triangulate(const JPH::Shape& shape);
+    void EncodeGeometry(const JPH::Shape& shape, nsUInt32 uiID, nsDynamicArray<nsUInt8>& out_data);
+
+    JPHShapeDictionarySettings m_Settings;
+    nsHashTable<const JPH::Shape*, ShapeEntry> m_Shapes;
+    nsHashTable<nsUInt32, GeometryEntry> m_Geometries;
+    nsHashTable<nsUInt64, nsUInt32> m_GeometryByHash;
+    nsUInt32 m_uiNextID = 0;
+
+    // scratch data of the triangulation, kept to avoid allocations
+    nsDynamicArray<JPH::Float3> m_Triangles;
+    nsHashTable<nsUInt64, nsUInt32> m_VertexLookup;
+    nsDynamicArray<nsUInt8> m_Payload;
+    nsDynamicArray<nsUInt8> m_Compressed;
+    nsUniquePtr<nsCompressedStreamWriterZstd> m_pCompressor;
+  };
+} // namespace JDebug::API
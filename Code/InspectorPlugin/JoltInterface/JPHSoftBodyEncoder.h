@@ -0,0 +1,221 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Physics/SoftBody/SoftBodySharedSettings.h>
+
+namespace JPH
+{
+  class Body;
+} // namespace JPH
+
+namespace JDebug::API
+{
+  /**
+   * @struct JPHSoftBodyCaptureSettings
+   * @brief Configuration of the soft body vertex stream of JPHDebuggerInterface.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHSoftBodyCaptureSettings
+  {
+    bool m_bEnabled = false;         ///< Whether the vertices of soft bodies are streamed and captured.
+    nsUInt32 m_uiSampleInterval = 1; ///< Vertices are only sent every N-th step. Keyframes of the body stream always contain them.
+    float m_fBoundsMargin = 0.25f;   ///< The quantization bounds are the vertex bounds grown by this fraction of their size, so they rarely change.
+  };
+
+  /**
+   * @class JPHSoftBodyEncoder
+   * @brief Encodes the vertices of soft bodies into a compact, delta compressed stream.
+   *
+   * The topology (vertex count and faces) of each SoftBodySharedSettings is sent once, all bodies that share the settings refer to it by ID.
+   * Vertex positions are relative to the center of mass of the body and quantized to 16 bits per axis within bounds that enclose all
+   * vertices of the body. Those bounds are only changed, and all positions are sent in full, once a vertex leaves them or they became
+   * much larger than needed. In between, only the difference of each quantized position to the previous frame is written as varints,
+   * so a resting cloth costs three bytes per vertex and a sleeping one nothing at all.
+   *
+   * A frame always contains all soft bodies that still exist, bodies that are missing were removed.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHSoftBodyEncoder
+  {
+  public:
+    /**
+     * @brief Bits of the frame header flags.
+     */
+    enum FrameFlags : nsUInt8
+    {
+      Frame_Keyframe = NS_BIT(0), ///< All topologies and bodies are sent in full, the decoder forgets what it knew.
+    };
+
+    /**
+     * @brief Bits of the per-body flags.
+     */
+    enum BodyFlags : nsUInt8
+    {
+      Body_Topology = NS_BIT(0),  ///< The topology is sent along with the body.
+      Body_Bounds = NS_BIT(1),    ///< New quantization bounds and all positions follow, instead of deltas.
+      Body_Unchanged = NS_BIT(2), ///< No vertex moved by a quantization step, no positions follow.
+    };
+
+    static constexpr nsUInt32 s_uiFrameMagic = 'JDSB';
+    static constexpr nsUInt8 s_uiFrameVersion = 1;
+
+  public:
+    JPHSoftBodyEncoder();
+    ~JPHSoftBodyEncoder();
+
+    /**
+     * @brief Changes the settings. Only the bounds margin is used by the encoder, it takes effect when bounds are recomputed.
+     */
+    void SetSettings(const JPHSoftBodyCaptureSettings& in_settings) { m_Settings = in_settings; }
+
+    /**
+     * @brief Returns the settings.
+     */
+    const JPHSoftBodyCaptureSettings& GetSettings() const { return m_Settings; }
+
+    /**
+     * @brief Forces the next frame to be a keyframe, e.g. because a new client connected.
+     */
+    void RequestKeyframe() { m_bKeyframeRequested = true; }
+
+    /**
+     * @brief Forgets all bodies and releases all topologies. The next frame is a keyframe.
+     */
+    void Reset();
+
+    /**
+     * @brief Starts a frame.
+     * @param in_uiStepIndex The physics step the vertices belong to.
+     * @param out_data Receives the encoded frame. Existing content is replaced.
+     */
+    void BeginFrame(nsUInt64 in_uiStepIndex, nsDynamicArray<nsUInt8>& out_data);
+
+    /**
+     * @brief Writes the vertices of a soft body into the current frame. Each body may only be written once per frame.
+     */
+    void EncodeBody(const JPH::Body& in_body);
+
+    /**
+     * @brief Finishes the frame. Bodies that were not written since BeginFrame() are forgotten, as are topologies no body uses anymore.
+     * @return True if the frame is a keyframe.
+     */
+    bool EndFrame();
+
+    /**
+     * @brief Returns the number of bodies that were written into the last frame, and are known to the decoder after it.
+     */
+    nsUInt32 GetNumBodies() const { return m_Bodies.GetCount(); }
+
+    /**
+     * @brief Returns the number of vertices whose positions were written into the last frame.
+     */
+    nsUInt32 GetNumEncodedVertices() const { return m_uiNumEncodedVertices; }
+
+  private:
+    struct Topology
+    {
+      JPH::RefConst<JPH::SoftBodySharedSettings> m_pSettings; ///< Keeps the pointer from being reused while the topology is known.
+      nsUInt32 m_uiID = 0;
+      bool m_bSent = false;
+      bool m_bUsed = false;
+    };
+
+    struct BodyState
+    {
+      nsUInt32 m_uiTopologyID = 0;
+      nsUInt32 m_uiNumVertices = 0;
+      nsUInt64 m_uiLastFrame = 0;
+      float m_BoundsMin[4] = {};
+      float m_BoundsMax[4] = {};
+      nsDynamicArray<nsInt32> m_Quantized; ///< Four values per vertex, the last one is unused, so they can be loaded as nsSimdVec4i.
+    };
+
+    void WriteTopology(const JPH::SoftBodySharedSettings& settings);
+
+    JPHSoftBodyCaptureSettings m_Settings;
+    bool m_bKeyframeRequested = true;
+    bool m_bFrameOpen = false;
+    bool m_bKeyframe = false;
+    nsUInt64 m_uiFrameCounter = 0;
+    nsUInt32 m_uiNumEncodedVertices = 0;
+    nsUInt32 m_uiNumBodiesOffset = 0; ///< Where the body count of the current frame is patched in.
+    nsUInt32 m_uiNumFrameBodies = 0;
+    nsDynamicArray<nsUInt8>* m_pData = nullptr;
+
+    nsUInt32 m_uiNextTopologyID = 0;
+    nsHashTable<const JPH::SoftBodySharedSettings*, Topology> m_Topologies;
+    nsHashTable<nsUInt32, BodyState> m_Bodies; ///< Per body ID, what the decoder knows.
+  };
+
+  /**
+   * @class JPHSoftBodyDecoder
+   * @brief Reconstructs the soft body vertices from frames written by JPHSoftBodyEncoder.
+   *
+   * Delta frames build on each other, so all frames since the last keyframe have to be decoded in order.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHSoftBodyDecoder
+  {
+  public:
+    /**
+     * @brief A topology as sent by the encoder.
+     */
+    struct Topology
+    {
+      nsUInt32 m_uiNumVertices = 0;
+      nsDynamicArray<nsUInt32> m_Indices; ///< Three vertex indices per face.
+    };
+
+    /**
+     * @brief The decoded state of one soft body.
+     */
+    struct Body
+    {
+      nsUInt32 m_uiTopologyID = 0;
+      nsVec3 m_vCenterOfMass = nsVec3::MakeZero();
+      nsDynamicArray<nsVec3> m_Positions; ///< Vertex positions relative to the center of mass, dequantized.
+
+      nsVec3 m_vBoundsMin = nsVec3::MakeZero(); ///< Quantization bounds, sent along with absolute positions.
+      nsVec3 m_vQuantum = nsVec3::MakeZero();   ///< Size of one quantization step per axis.
+      nsDynamicArray<nsUInt16> m_Quantized;     ///< Three quantized values per vertex, delta frames are relative to these.
+    };
+
+    /**
+     * @brief Decodes a frame.
+     * @return NS_FAILURE if the data is corrupt or a delta frame arrives before the first keyframe.
+     */
+    nsResult DecodeFrame(nsArrayPtr<const nsUInt8> in_data);
+
+    /**
+     * @brief Forgets all decoded state. The next frame must be a keyframe.
+     */
+    void Reset();
+
+    /**
+     * @brief Returns the step index of the last decoded frame.
+     */
+    nsUInt64 GetStepIndex() const { return m_uiStepIndex; }
+
+    /**
+     * @brief Returns the topology with the given ID, or nullptr if it is not known.
+     */
+    const Topology* GetTopology(nsUInt32 in_uiTopologyID) const { return m_Topologies.GetValue(in_uiTopologyID); }
+
+    /**
+     * @brief Returns all bodies of the last decoded frame, by body ID.
+     */
+    const nsHashTable<nsUInt32, Body>& GetBodies() const { return m_Bodies; }
+
+  private:
+    bool m_bHasKeyframe = false;
+    nsUInt64 m_uiStepIndex = 0;
+    nsDynamicArray<nsUInt32> m_BodyIDScratch;
+    nsHashTable<nsUInt32, Topology> m_Topologies;
+    nsHashTable<nsUInt32, Body> m_Bodies;
+  };
+} // namespace JDebug::API
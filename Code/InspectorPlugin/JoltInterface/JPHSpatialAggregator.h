@@ -0,0 +1,138 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Containers/HashTable.h>
+#include <Foundation/Math/BoundingBox.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+namespace JPH
+{
+  class PhysicsSystem;
+}
+
+namespace JDebug::API
+{
+  struct JPHBodySnapshot;
+
+  /**
+   * @struct JPHAggregationSettings
+   * @brief Configuration of the spatial aggregation of JPHDebuggerInterface, see JPHSpatialAggregator.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHAggregationSettings
+  {
+    bool m_bEnabled = false;          ///< Whether bodies outside the interest set are summarized in grid cells instead of being left out.
+    bool m_bAggregateCapture = false; ///< Whether the capture and the flight recorder are also limited to the interest set, with all other bodies aggregated.
+    float m_fCellSize = 16.0f;        ///< Edge length of the finest grid cells in meters.
+    nsUInt32 m_uiMaxCells = 2048;     ///< If more cells are occupied, the cell size is doubled until they fit. Bounds the size of the grid.
+  };
+
+  /**
+   * @struct JPHAggregateCell
+   * @brief Summary of all aggregated bodies whose position lies in one grid cell.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHAggregateCell
+  {
+    nsVec3I32 m_Coords = nsVec3I32::MakeZero();  ///< The cell covers [m_Coords * cell size, (m_Coords + 1) * cell size).
+    nsUInt32 m_uiNumBodies = 0;                  ///< Bodies in the cell.
+    nsUInt32 m_uiNumActiveBodies = 0;            ///< Bodies in the cell that are awake.
+    nsBoundingBox m_Bounds;                      ///< World space bounds of the bodies, may reach beyond the cell.
+    nsVec3 m_vMeanVelocity = nsVec3::MakeZero(); ///< Average linear velocity of the bodies.
+    float m_fMaxKineticEnergy = 0.0f;            ///< Largest linear plus rotational kinetic energy of a dynamic body in the cell, in joules.
+  };
+
+  /**
+   * @struct JPHAggregateGrid
+   * @brief The occupied cells of a sparse grid over all aggregated bodies of one step.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHAggregateGrid
+  {
+    float m_fCellSize = 0.0f;                 ///< Edge length of the cells, JPHAggregationSettings::m_fCellSize times 2^m_uiLevel.
+    nsUInt8 m_uiLevel = 0;                    ///< How often the cell size was doubled to stay within JPHAggregationSettings::m_uiMaxCells.
+    nsUInt32 m_uiNumBodies = 0;               ///< All aggregated bodies.
+    nsDynamicArray<JPHAggregateCell> m_Cells; ///< The occupied cells, ordered by x, then y, then z.
+
+    /**
+     * @brief Serializes the grid for the network stream and the capture file.
+     *
+     * Layout: float cell size, u8 level, varuint body count, varuint cell count, per cell: varint x, y and z as difference to the
+     * previous cell, varuint body and active body count, float3 bounds min and max, float3 mean velocity, float max kinetic energy.
+     */
+    void Write(nsDynamicArray<nsUInt8>& out_data) const;
+
+    /**
+     * @brief Reads data written by Write().
+     */
+    nsResult Read(nsArrayPtr<const nsUInt8> in_data);
+  };
+
+  /**
+   * @class JPHSpatialAggregator
+   * @brief Summarizes the bodies outside the interest set of a client in a sparse grid, so large worlds stay cheap to stream and capture.
+   *
+   * Streaming every body individually stops scaling with hundreds of thousands of bodies. With an interest set, the bodies inside
+   * the regions of the client are streamed as usual, all others are binned into grid cells by their position. Each occupied cell
+   * is sent as one summary, so the size of the result depends on the number of occupied cells, which JPHAggregationSettings::m_uiMaxCells
+   * bounds by coarsening the grid, instead of on the number of bodies.
+   *
+   * The snapshot is binned in parallel on the nsTaskSystem, every task fills its own hash map of cells, which are merged afterwards
+   * in a fixed order, so the result does not depend on the scheduling. A task whose map alone exceeds the budget coarsens it right away,
+   * which keeps the memory bounded and loses nothing, since the merged grid is at least as coarse. The bounds and masses are read from
+   * the physics system.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHSpatialAggregator
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHSpatialAggregator);
+
+  public:
+    JPHSpatialAggregator();
+    ~JPHSpatialAggregator();
+
+    /**
+     * @brief Bins all valid bodies of the snapshot that are not in the interest mask.
+     *
+     * Must be called while no other thread modifies the bodies.
+     * @param in_pPhysicsSystem Provides the bounds and masses. If nullptr, the bounds only contain the positions and the kinetic energy is zero.
+     * @param in_snapshot The snapshot that is going to be encoded.
+     * @param in_interestMask One entry per slot, bodies with a non-zero entry are streamed individually and not aggregated.
+     * @param in_settings The cell size and the cell budget.
+     * @param out_grid Receives the occupied cells.
+     */
+    void Aggregate(const JPH::PhysicsSystem* in_pPhysicsSystem, const JPHBodySnapshot& in_snapshot, nsArrayPtr<const nsUInt8> in_interestMask,
+      const JPHAggregationSettings& in_settings, JPHAggregateGrid& out_grid);
+
+  private:
+    /// The sums a cell is built from while the bodies are binned.
+    struct CellAccumulator
+    {
+      nsUInt32 m_uiNumBodies = 0;
+      nsUInt32 m_uiNumActiveBodies = 0;
+      nsBoundingBox m_Bounds = nsBoundingBox::MakeInvalid();
+      nsVec3 m_vVelocitySum = nsVec3::MakeZero();
+      float m_fMaxKineticEnergy = 0.0f;
+
+      void Merge(const CellAccumulator& other);
+    };
+
+    /// The packed coordinates of neighboring cells only differ in a few bits, which nsHashHelper<nsUInt64> maps to the same buckets.
+    struct CellKeyHashHelper
+    {
+      NS_ALWAYS_INLINE static nsUInt32 Hash(nsUInt64 uiKey) { return static_cast<nsUInt32>((uiKey * 0x9E3779B97F4A7C15ull) >> 32); }
+      NS_ALWAYS_INLINE static bool Equal(nsUInt64 a, nsUInt64 b) { return a == b; }
+    };
+
+    using CellTable = nsHashTable<nsUInt64, CellAccumulator, CellKeyHashHelper>;
+
+    /// Bins cells into cells of 2^uiLevels the size. Lossless as long as the final grid is at least that coarse.
+    static void Coarsen(CellTable& ref_cells, nsUInt32 uiLevels);
+
+    nsDynamicArray<CellTable> m_ChunkCells; ///< Per chunk of slots, reused between steps.
+    nsDynamicArray<nsUInt8> m_ChunkLevels;  ///< Per chunk, how often its cells were coarsened to stay within the budget.
+    CellTable m_MergedCells;                ///< All chunks merged.
+    nsDynamicArray<nsUInt64> m_SortedKeys;  ///< The keys of m_MergedCells in ascending order.
+  };
+} // namespace JDebug::API
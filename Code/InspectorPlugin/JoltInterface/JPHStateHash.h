@@ -0,0 +1,151 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+namespace JDebug::API
+{
+  namespace IO
+  {
+    class JPHPVDFileReader;
+  }
+
+  struct JPHBodySnapshot;
+
+  /**
+   * @brief The groups of body fields that are hashed separately, so a divergence can be attributed to a field.
+   */
+  enum JPHStateHashField : nsUInt8
+  {
+    StateHash_Identity = NS_BIT(0),        ///< Body ID, motion type, state flags and object layer.
+    StateHash_Position = NS_BIT(1),        ///< Position.
+    StateHash_Rotation = NS_BIT(2),        ///< Rotation.
+    StateHash_LinearVelocity = NS_BIT(3),  ///< Linear velocity.
+    StateHash_AngularVelocity = NS_BIT(4), ///< Angular velocity.
+  };
+
+  /**
+   * @struct JPHStateHashSettings
+   * @brief Configuration of the per step state hash of JPHDebuggerInterface.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHStateHashSettings
+  {
+    bool m_bEnabled = false;           ///< Whether a hash is computed every step. It is streamed and captured along with the frames.
+    nsUInt32 m_uiSlotsPerRange = 1024; ///< Body slots per sub-hash. Smaller ranges locate a divergence more precisely, but make the hash larger.
+  };
+
+  /**
+   * @struct JPHStateHash
+   * @brief Hash of the exact state of all bodies after one step, split into sub-hashes per body slot range and field.
+   *
+   * The hash is computed over the float bits of a JPHBodySnapshot, so two runs only produce the same hash if they are bit for bit identical,
+   * which is what lockstep simulations rely on. The root hash is enough to detect a divergence, the sub-hashes tell which bodies
+   * and fields caused it without having to transfer the state itself.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHStateHash
+  {
+    static constexpr nsUInt32 s_uiNumFields = 5;
+
+    nsUInt64 m_uiRootHash = 0;            ///< Hash of all sub-hashes.
+    nsUInt32 m_uiSlotsPerRange = 0;       ///< Body slots covered by each range.
+    nsUInt32 m_uiNumSlots = 0;            ///< Number of body slots in the hashed snapshot.
+    nsDynamicArray<nsUInt64> m_SubHashes; ///< s_uiNumFields hashes per range, in the bit order of JPHStateHashField.
+
+    /**
+     * @brief Hashes the given snapshot. The ranges are hashed in parallel on the nsTaskSystem.
+     */
+    void Compute(const JPHBodySnapshot& in_snapshot, nsUInt32 in_uiSlotsPerRange);
+
+    /**
+     * @brief Returns the number of slot ranges.
+     */
+    nsUInt32 GetNumRanges() const { return m_SubHashes.GetCount() / s_uiNumFields; }
+
+    /**
+     * @brief Returns the sub-hash of one field of one range.
+     * @param in_uiRange The range index.
+     * @param in_uiField The field index, i.e. the bit index of the JPHStateHashField value.
+     */
+    nsUInt64 GetSubHash(nsUInt32 in_uiRange, nsUInt32 in_uiField) const { return m_SubHashes[in_uiRange * s_uiNumFields + in_uiField]; }
+
+    /**
+     * @brief Serializes the hash for the network stream and the capture file.
+     *
+     * Layout: u64 root hash, u32 slots per range, u32 slot count, u32 range count, then s_uiNumFields u64 sub-hashes per range.
+     */
+    void Write(nsDynamicArray<nsUInt8>& out_data) const;
+
+    /**
+     * @brief Reads data written by Write().
+     */
+    nsResult Read(nsArrayPtr<const nsUInt8> in_data);
+  };
+
+  /**
+   * @struct JPHDivergentRange
+   * @brief A slot range whose sub-hashes differ between two captures.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHDivergentRange
+  {
+    nsUInt32 m_uiFirstSlot = 0; ///< The first body slot of the range.
+    nsUInt32 m_uiNumSlots = 0;  ///< The number of slots in the range.
+    nsUInt8 m_uiFields = 0;     ///< Combination of JPHStateHashField, the fields whose sub-hashes differ.
+  };
+
+  /**
+   * @struct JPHDivergentBody
+   * @brief A body whose captured state differs between two captures.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHDivergentBody
+  {
+    nsUInt32 m_uiSlot = 0;        ///< The body slot.
+    nsUInt32 m_uiBodyIDs[2] = {}; ///< The body ID in the slot in the first and the second capture.
+    nsUInt8 m_uiFields = 0;       ///< Combination of JPHStateHashField, the fields that differ.
+  };
+
+  /**
+   * @struct JPHDivergenceReport
+   * @brief Result of JPHStateHashCompare::FindDivergence().
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHDivergenceReport
+  {
+    bool m_bDiverged = false;          ///< Whether the captures diverge at all.
+    nsUInt64 m_uiStepIndex = 0;        ///< The first step whose hashes differ.
+    bool m_bHasMatchingStep = false;   ///< Whether any common step before m_uiStepIndex had equal hashes.
+    nsUInt64 m_uiLastMatchingStep = 0; ///< The last common step before m_uiStepIndex with equal hashes.
+    nsUInt32 m_uiNumFramesRead = 0;    ///< How many frames had to be decompressed to find the divergence.
+    nsDynamicArray<JPHDivergentRange> m_Ranges;
+    nsDynamicArray<JPHDivergentBody> m_Bodies;
+  };
+
+  /**
+   * @class JPHStateHashCompare
+   * @brief Finds the first step in which two captures of the same simulation diverge.
+   *
+   * A simulation that diverged once does not converge again, so the first divergent step is found by bisecting the steps both captures
+   * contain, which only decompresses O(log n) frames. The sub-hashes of that step name the slot ranges and fields that differ,
+   * then the frames of both captures are decoded and compared body by body.
+   *
+   * The decoded frames are quantized, so a difference in the last bits of a value may only show up in the sub-hashes. Such ranges are
+   * reported without bodies.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHStateHashCompare
+  {
+  public:
+    /**
+     * @brief Compares two captures that both have state hashing enabled.
+     * @return NS_FAILURE if the captures have no common steps with hashes or a frame cannot be read.
+     */
+    static nsResult FindDivergence(const IO::JPHPVDFileReader& in_first, const IO::JPHPVDFileReader& in_second, JPHDivergenceReport& out_report);
+
+    /**
+     * @brief Writes a report to the log.
+     */
+    static void LogReport(const JPHDivergenceReport& in_report);
+  };
+} // namespace JDebug::API
@@ -0,0 +1,191 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Time/Time.h>
+#include <Foundation/Types/ArrayPtr.h>
+
+namespace JPH
+{
+  class PhysicsSystem;
+}
+
+namespace JDebug::API
+{
+  class JPHContactRecorder;
+
+  /**
+   * @brief The phases of PhysicsSystem::Update() that are timed separately. Each phase groups one or more Jolt jobs.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHStepPhase
+  {
+    using StorageType = nsUInt8;
+
+    enum Enum : nsUInt8
+    {
+      BroadPhase,    ///< UpdateBroadPhasePrepare, UpdateBroadPhaseFinalize
+      NarrowPhase,   ///< FindCollisions, which also runs the contact listener
+      Constraints,   ///< DetermineActiveConstraints, SetupVelocityConstraints
+      Islands,       ///< BuildIslandsFromConstraints, FinalizeIslands, BodySetIslandIndex
+      SolveVelocity, ///< SolveVelocityConstraints
+      Integrate,     ///< ApplyGravity, PreIntegrateVelocity, IntegrateVelocity, PostIntegrateVelocity
+      CCD,           ///< FindCCDContacts, ResolveCCDContacts
+      SolvePosition, ///< SolvePositionConstraints, which also checks for sleeping bodies
+      SoftBody,      ///< SoftBodyPrepare, SoftBodyCollide, SoftBodySimulate, SoftBodyFinalize
+      Listeners,     ///< StepListeners, ContactRemovedCallbacks
+
+      ENUM_COUNT,
+      Default = BroadPhase
+    };
+
+    /**
+     * @brief Returns the display name of a phase.
+     */
+    static const char* GetName(Enum in_ePhase);
+  };
+
+  /**
+   * @struct JPHStepPhaseTiming
+   * @brief How long the jobs of one phase ran during a physics step.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHStepPhaseTiming
+  {
+    nsTime m_CpuTime;         ///< The run time of all jobs of the phase, summed over all threads.
+    nsTime m_WallTime;        ///< From the start of the first job to the end of the last job of the phase.
+    nsUInt32 m_uiNumJobs = 0; ///< How many jobs of the phase ran.
+  };
+
+  /**
+   * @struct JPHStepStatistics
+   * @brief Timing and counters of one physics step, see JPHStepMonitor.
+   */
+  struct NS_INSPECTORPLUGIN_DLL JPHStepStatistics
+  {
+    /// Island sizes are counted in power of two buckets: 1, 2-3, 4-7, ..., 128 and more bodies.
+    static constexpr nsUInt32 s_uiNumIslandBuckets = 8;
+
+    nsTime m_StepTime;                                     ///< From the start of the first job to the end of the last job of the step.
+    JPHStepPhaseTiming m_Phases[JPHStepPhase::ENUM_COUNT]; ///< Per phase timing, zero if phase timing is disabled.
+
+    nsUInt32 m_uiNumBodies = 0;                        ///< All bodies in the physics system.
+    nsUInt32 m_uiNumActiveBodies = 0;                  ///< Awake rigid bodies.
+    nsUInt32 m_uiNumActiveSoftBodies = 0;              ///< Awake soft bodies.
+    nsUInt32 m_uiNumIslands = 0;                       ///< Islands the active rigid bodies were solved in, including islands of a single body.
+    nsUInt32 m_uiLargestIsland = 0;                    ///< Number of bodies in the largest island.
+    nsUInt32 m_IslandSizes[s_uiNumIslandBuckets] = {}; ///< Number of islands per size bucket.
+    nsUInt32 m_uiNumBodyPairs = 0;                     ///< Body pairs whose shapes touched in the narrow phase. Only counted if a JPHContactRecorder is attached.
+    nsUInt32 m_uiNumContactConstraints = 0;            ///< Contact manifolds that were turned into contact constraints. Only counted if a JPHContactRecorder is attached.
+    nsUInt32 m_uiNumCCDBodies = 0;                     ///< Active bodies with EMotionQuality::LinearCast, each of them may cast its shape in the CCD phase.
+    nsUInt32 m_uiNumVelocitySteps = 0;                 ///< Velocity iterations of the island that needed the most.
+    nsUInt32 m_uiNumPositionSteps = 0;                 ///< Position iterations of the island that needed the most.
+
+    /**
+     * @brief Serializes the statistics for the network stream and the capture file.
+     *
+     * Layout: u8 phase count, per phase: varuint CPU time, varuint wall time (both in nanoseconds), varuint job count,
+     * then varuint step time in nanoseconds, varuint body, active body, active soft body, island and largest island count,
+     * u8 bucket count, varuint islands per bucket, varuint body pair, contact constraint, CCD body, velocity step and position step count.
+     */
+    void Write(nsDynamicArray<nsUInt8>& out_data) const;
+
+    /**
+     * @brief Reads data written by Write(). Phases and buckets that this version does not know are skipped.
+     */
+    nsResult Read(nsArrayPtr<const nsUInt8> in_data);
+  };
+
+  /**
+   * @class JPHStepMonitor
+   * @brief Collects JPHStepStatistics after every physics step.
+   *
+   * Phase timing relies on JPHProfilerBridge: every Jolt job runs in a JPH_PROFILE scope named after the job, the bridge hands
+   * the scopes of known jobs to the monitor, which adds their durations up with a few atomic operations per job. Scope names are
+   * resolved through a small lock free cache, so other scopes cost a single lookup.
+   *
+   * Every monitor accumulates its own phases. The profile scopes do not know which physics system they belong to, so a
+   * JPHTaskJobSystem with a monitor set (see JPHTaskJobSystem::SetStepMonitor()) routes the jobs it runs to that monitor.
+   * Jobs of other job systems go to the monitor with timing enabled if there is exactly one, otherwise they are not timed.
+   *
+   * The counters are read after the step. The island statistics walk the active rigid bodies once, everything else is read
+   * from the physics system and the contact recorder directly, so Collect() stays in the order of microseconds.
+   * Jolt does not expose its broad phase pair count, the number of pairs that reached the narrow phase and touched is counted
+   * through the contact recorder instead.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHStepMonitor
+  {
+    NS_DISALLOW_COPY_AND_ASSIGN(JPHStepMonitor);
+
+  public:
+    /// Returned by FindPhase() for scopes that are not a phase job.
+    static constexpr nsUInt8 s_uiNoPhase = 0xFF;
+
+    JPHStepMonitor();
+    ~JPHStepMonitor();
+
+    /**
+     * @brief Enables or disables phase timing of this monitor. Must not be called while a physics system is updated.
+     */
+    void SetTimingEnabled(bool in_bEnabled);
+
+    /**
+     * @brief Returns whether phase timing of this monitor is enabled.
+     */
+    bool IsTimingEnabled() const { return m_bTimingEnabled; }
+
+    /**
+     * @brief Returns whether any monitor has phase timing enabled. Called by JPHProfilerBridge for every scope.
+     */
+    static bool IsAnyTimingEnabled();
+
+    /**
+     * @brief Sets the monitor that receives the phase measurements of the calling thread, returns the previous one.
+     *
+     * Used by JPHTaskJobSystem while it executes jobs. nullptr restores the default routing, see the class description.
+     */
+    static JPHStepMonitor* SetThreadMonitor(JPHStepMonitor* in_pMonitor);
+
+    /**
+     * @brief Returns the JPHStepPhase of a Jolt profile scope, or s_uiNoPhase. Called by JPHProfilerBridge for every scope.
+     */
+    static nsUInt8 FindPhase(const char* in_szScopeName);
+
+    /**
+     * @brief Adds one run of a phase job to the monitor of the calling thread. Called by JPHProfilerBridge from the job threads.
+     */
+    static void AddPhaseMeasurement(nsUInt8 in_uiPhase, nsTime in_beginTime, nsTime in_endTime);
+
+    /**
+     * @brief Fills the statistics of the step that was just simulated and restarts the phase timing.
+     *
+     * Must be called after PhysicsSystem::Update() and while no other thread modifies the bodies.
+     * @param in_system The physics system that was updated.
+     * @param in_pContactRecorder Provides the contact counts, may be nullptr. JPHContactRecorder::CollectContacts() has to be called first.
+     * @param out_statistics Receives the statistics.
+     */
+    void Collect(const JPH::PhysicsSystem& in_system, const JPHContactRecorder* in_pContactRecorder, JPHStepStatistics& out_statistics);
+
+  private:
+    /// Accumulated by the job threads, one cache line per phase so different phases do not contend.
+    struct alignas(64) PhaseAccumulator
+    {
+      nsAtomicInteger64 m_iCpuNanoseconds;
+      nsAtomicInteger64 m_iFirstBeginNanoseconds;
+      nsAtomicInteger64 m_iLastEndNanoseconds;
+      nsAtomicInteger32 m_iNumJobs;
+    };
+
+    void ResetPhases();
+    void AddPhase(nsUInt8 uiPhase, nsInt64 iBegin, nsInt64 iEnd);
+    void CollectIslands(const JPH::PhysicsSystem& system, JPHStepStatistics& inout_statistics);
+
+    PhaseAccumulator m_Phases[JPHStepPhase::ENUM_COUNT]; ///< The phases of the current step.
+    nsAtomicBool m_bTimingEnabled;                       ///< Read by the job threads, see AddPhaseMeasurement().
+    JPHStepMonitor* m_pNextTimedMonitor = nullptr;       ///< Links the monitors with timing enabled.
+    nsDynamicArray<nsUInt32> m_IslandSizes;              ///< Per island index, reused between steps.
+  };
+} // namespace JDebug::API
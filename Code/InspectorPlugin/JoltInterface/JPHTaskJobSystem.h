@@ -0,0 +1,119 @@
+/*
+ *   Copyright (c) 2024-present Mikael K. Aboagye & WD Studios L.L.C.
+ *   All rights reserved.
+ *   This Project & Code is Licensed under the MIT License.
+ */
+#pragma once
+#include <InspectorPlugin/InspectorPluginDLL.h>
+#include <Foundation/Threading/AtomicInteger.h>
+#include <Foundation/Threading/Mutex.h>
+#include <Foundation/Threading/TaskSystem.h>
+#include <Foundation/Types/SharedPtr.h>
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+namespace JDebug::API
+{
+  class JPHStepMonitor;
+
+  /**
+   * @class JPHTaskJobSystem
+   * @brief Runs Jolt's jobs on the nsTaskSystem worker threads instead of a separate thread pool.
+   *
+   * Each queued Jolt job is started as an nsTask with the configured priority, so physics shares the workers with the rest
+   * of the engine instead of competing with them for cores. The task objects are pooled and reused once they finished,
+   * after warm-up a step does not allocate.
+   *
+   * Jolt jobs always belong to a barrier, and the thread that waits on a barrier (usually the one calling PhysicsSystem::Update())
+   * executes all jobs of that barrier that are ready, before it goes to sleep. A job that was already executed by the waiting
+   * thread is skipped when its task runs, so the waiting thread never idles while work is queued in the task system.
+   *
+   * With a JPHStepMonitor set, the phases of all jobs this job system runs are timed for that monitor, so several physics systems
+   * that are updated at the same time with their own job systems get separate step statistics.
+   */
+  class NS_INSPECTORPLUGIN_DLL JPHTaskJobSystem final : public JPH::JobSystemWithBarrier
+  {
+  public:
+    JPH_OVERRIDE_NEW_DELETE
+
+    /**
+     * @brief Creates an uninitialized job system, Init() has to be called before it is used.
+     */
+    JPHTaskJobSystem() = default;
+
+    /**
+     * @brief Creates and initializes the job system.
+     * @param in_uiMaxJobs Maximum number of jobs that can be alive at the same time.
+     * @param in_uiMaxBarriers Maximum number of barriers that can be alive at the same time.
+     * @param in_ePriority The task priority the jobs are scheduled with.
+     */
+    JPHTaskJobSystem(JPH::uint in_uiMaxJobs, JPH::uint in_uiMaxBarriers, nsTaskPriority::Enum in_ePriority = nsTaskPriority::EarlyThisFrame);
+
+    /**
+     * @brief Waits until all tasks that were started by this job system finished.
+     */
+    virtual ~JPHTaskJobSystem() override;
+
+    /**
+     * @brief Initializes the job system, see the constructor for the parameters.
+     */
+    void Init(JPH::uint in_uiMaxJobs, JPH::uint in_uiMaxBarriers, nsTaskPriority::Enum in_ePriority = nsTaskPriority::EarlyThisFrame);
+
+    /**
+     * @brief Changes the priority of jobs that are queued from now on.
+     */
+    void SetTaskPriority(nsTaskPriority::Enum in_ePriority) { m_ePriority = in_ePriority; }
+
+    /**
+     * @brief Returns the task priority the jobs are scheduled with.
+     */
+    nsTaskPriority::Enum GetTaskPriority() const { return m_ePriority; }
+
+    /**
+     * @brief Sets the monitor the phases of the jobs are timed for, see JPHDebuggerInterface::SetJobSystem().
+     *
+     * Must not be called while a physics system is updated with this job system.
+     */
+    void SetStepMonitor(JPHStepMonitor* in_pMonitor) { m_pStepMonitor = in_pMonitor; }
+
+    /**
+     * @brief Returns the monitor set by SetStepMonitor().
+     */
+    JPHStepMonitor* GetStepMonitor() const { return m_pStepMonitor; }
+
+    /**
+     * @brief Returns the number of short task workers plus the thread that waits on the barrier.
+     */
+    virtual int GetMaxConcurrency() const override;
+
+    virtual JobHandle CreateJob(const char* in_szName, JPH::ColorArg in_color, const JobFunction& in_jobFunction, JPH::uint32 in_uiNumDependencies = 0) override;
+
+    /**
+     * @brief Executes the ready jobs of the barrier on the calling thread until all of them finished.
+     */
+    virtual void WaitForJobs(Barrier* in_pBarrier) override;
+
+  protected:
+    virtual void QueueJob(Job* in_pJob) override;
+    virtual void QueueJobs(Job** in_pJobs, JPH::uint in_uiNumJobs) override;
+    virtual void FreeJob(Job* in_pJob) override;
+
+  private:
+    class JobTask;
+
+    void StartJobTask(Job* pJob);
+    void OnJobTaskFinished(const nsSharedPtr<nsTask>& pTask);
+
+    using AvailableJobs = JPH::FixedSizeFreeList<Job>;
+
+    AvailableJobs m_Jobs;                                              ///< Storage of the jobs, same as in the Jolt job systems.
+    nsTaskPriority::Enum m_ePriority = nsTaskPriority::EarlyThisFrame; ///< Priority of the tasks that execute the jobs.
+    JPHStepMonitor* m_pStepMonitor = nullptr;                          ///< Receives the phase timing of the jobs, optional.
+
+    nsMutex m_TaskPoolMutex;
+    nsDynamicArray<nsSharedPtr<JobTask>> m_FreeTasks; ///< Finished tasks that can be reused.
+    nsAtomicInteger32 m_iTasksInFlight;               ///< Tasks that were started but did not finish yet, they hold a reference to a job.
+  };
+} // namespace JDebug::API
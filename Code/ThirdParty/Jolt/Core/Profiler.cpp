@@ -15,7 +15,7 @@ JPH_SUPPRESS_WARNINGS_STD_END
 
 JPH_NAMESPACE_BEGIN
 
-#if defined(JPH_EXTERNAL_PROFILE) && defined(JPH_SHARED_LIBRARY)
+#if defined(JPH_EXTERNAL_PROFILE) //nsEngine change: statically linked builds use the hooks as well
 
 ProfileStartMeasurementFunction ProfileStartMeasurement = [](const char *, uint32, uint8 *) { };
 ProfileEndMeasurementFunction ProfileEndMeasurement = [](uint8 *) { };
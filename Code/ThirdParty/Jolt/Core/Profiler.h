@@ -17,31 +17,28 @@ JPH_SUPPRESS_WARNINGS_STD_END
 
 JPH_NAMESPACE_BEGIN
 
-#ifdef JPH_SHARED_LIBRARY
+//nsEngine change
+// The hooks are used for statically linked builds as well, so every user of the library links without implementing
+// ExternalProfileMeasurement. They default to no-ops, the InspectorPlugin installs its own at runtime.
+
 /// Functions called when a profiler measurement starts or stops, need to be overridden by the user.
 using ProfileStartMeasurementFunction = void (*)(const char *inName, uint32 inColor, uint8 *ioUserData);
 using ProfileEndMeasurementFunction = void (*)(uint8 *ioUserData);
 
 JPH_EXPORT extern ProfileStartMeasurementFunction ProfileStartMeasurement;
 JPH_EXPORT extern ProfileEndMeasurementFunction ProfileEndMeasurement;
-#endif // JPH_SHARED_LIBRARY
 
 /// Create this class on the stack to start sampling timing information of a particular scope.
 ///
-/// For statically linked builds, this is left unimplemented intentionally. Needs to be implemented by the user of the library.
 /// On construction a measurement should start, on destruction it should be stopped.
-/// For dynamically linked builds, the user should override the ProfileStartMeasurement and ProfileEndMeasurement functions.
+/// The user should override the ProfileStartMeasurement and ProfileEndMeasurement functions.
 class alignas(16) ExternalProfileMeasurement : public NonCopyable
 {
 public:
 	/// Constructor
-#ifdef JPH_SHARED_LIBRARY
 	JPH_INLINE						ExternalProfileMeasurement(const char *inName, uint32 inColor = 0) { ProfileStartMeasurement(inName, inColor, mUserData); }
 	JPH_INLINE						~ExternalProfileMeasurement() { ProfileEndMeasurement(mUserData); }
-#else
-									ExternalProfileMeasurement(const char *inName, uint32 inColor = 0);
-									~ExternalProfileMeasurement();
-#endif
+//nsEngine change end
 
 private:
 	uint8							mUserData[64];
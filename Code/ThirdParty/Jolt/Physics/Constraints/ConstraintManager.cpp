@@ -68,6 +68,15 @@ Constraints ConstraintManager::GetConstraints() const
 	return copy;
 }
 
+//nsEngine change
+void ConstraintManager::GetConstraints(Constraints &outConstraints) const
+{
+	UniqueLock lock(mConstraintsMutex JPH_IF_ENABLE_ASSERTS(, mLockContext, EPhysicsLockTypes::ConstraintsList));
+
+	outConstraints.assign(mConstraints.begin(), mConstraints.end());
+}
+//nsEngine change end
+
 void ConstraintManager::GetActiveConstraints(uint32 inStartConstraintIdx, uint32 inEndConstraintIdx, Constraint **outActiveConstraints, uint32 &outNumActiveConstraints) const
 {
 	JPH_PROFILE_FUNCTION();
@@ -42,6 +42,11 @@ public:
 	/// Get a list of all constraints
 	Constraints				GetConstraints() const;
 
+	//nsEngine change
+	/// Get a list of all constraints, reusing the storage of outConstraints so that polling every step does not allocate
+	void					GetConstraints(Constraints &outConstraints) const;
+	//nsEngine change end
+
 	/// Get total number of constraints
 	inline uint32			GetNumConstraints() const					{ return uint32(mConstraints.size()); }
 
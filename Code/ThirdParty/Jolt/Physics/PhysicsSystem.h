@@ -98,6 +98,11 @@ public:
 	/// Get a list of all constraints
 	Constraints					GetConstraints() const										{ return mConstraintManager.GetConstraints(); }
 
+	//nsEngine change
+	/// Get a list of all constraints, reusing the storage of outConstraints so that polling every step does not allocate
+	void						GetConstraints(Constraints &outConstraints) const			{ mConstraintManager.GetConstraints(outConstraints); }
+	//nsEngine change end
+
 	/// Optimize the broadphase, needed only if you've added many bodies prior to calling Update() for the first time.
 	void						OptimizeBroadPhase();
 
@@ -259,4 +259,25 @@ NS_CREATE_SIMPLE_TEST(Communication, IpcChannel_Pipe)
   pServer.Clear();
 }
 
+#  if NS_ENABLED(NS_PLATFORM_LINUX)
+
+NS_CREATE_SIMPLE_TEST(Communication, IpcChannel_SharedMemory)
+{
+  nsUniquePtr<nsIpcChannel> pServer = nsIpcChannel::CreateSharedMemoryChannel("nsEngine_unit_test_channel", nsIpcChannel::Mode::Server);
+  nsUniquePtr<ChannelTester> pServerTester = NS_DEFAULT_NEW(ChannelTester, pServer.Borrow(), true);
+
+  nsUniquePtr<nsIpcChannel> pClient = nsIpcChannel::CreateSharedMemoryChannel("nsEngine_unit_test_channel", nsIpcChannel::Mode::Client);
+  nsUniquePtr<ChannelTester> pClientTester = NS_DEFAULT_NEW(ChannelTester, pClient.Borrow(), false);
+
+  TestIPCChannel(pServer.Borrow(), pServerTester.Borrow(), pClient.Borrow(), pClientTester.Borrow());
+
+  pClientTester.Clear();
+  pClient.Clear();
+
+  pServerTester.Clear();
+  pServer.Clear();
+}
+
+#  endif
+
 #endif
@@ -0,0 +1 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
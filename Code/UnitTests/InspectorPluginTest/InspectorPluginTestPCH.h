@@ -0,0 +1,10 @@
+#include <TestFramework/Framework/TestFramework.h>
+#include <TestFramework/Utilities/ConstructionCounter.h>
+
+#include <Foundation/Basics.h>
+#include <Foundation/Containers/DynamicArray.h>
+#include <Foundation/Math/Random.h>
+#include <Foundation/Types/ArrayPtr.h>
+#include <Foundation/Types/Types.h>
+
+#include <InspectorPlugin/InspectorPluginDLL.h>
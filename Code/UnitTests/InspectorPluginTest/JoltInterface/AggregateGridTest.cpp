@@ -0,0 +1,329 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <Foundation/Containers/Map.h>
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHSpatialAggregator.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  /// The expected content of one cell, gathered body by body.
+  struct ExpectedAggregateCell
+  {
+    nsUInt32 m_uiNumBodies = 0;
+    nsUInt32 m_uiNumActiveBodies = 0;
+    nsBoundingBox m_Bounds = nsBoundingBox::MakeInvalid();
+    nsVec3 m_vVelocitySum = nsVec3::MakeZero();
+  };
+
+  static nsUInt64 GetAggregateCellKey(const nsVec3I32& vCoords)
+  {
+    return (static_cast<nsUInt64>(vCoords.x + (1 << 20)) << 42) | (static_cast<nsUInt64>(vCoords.y + (1 << 20)) << 21) | static_cast<nsUInt64>(vCoords.z + (1 << 20));
+  }
+
+  static void FillAggregatedSnapshot(JPHBodySnapshot& ref_snapshot, nsDynamicArray<nsUInt8>& out_interestMask, nsUInt32 uiNumSlots, nsRandom& ref_rng)
+  {
+    ref_snapshot.SetSlotCount(uiNumSlots);
+    ref_snapshot.ClearSlots();
+    out_interestMask.SetCount(uiNumSlots);
+
+    for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+    {
+      out_interestMask[uiSlot] = uiSlot % 7 == 0 ? 1 : 0;
+
+      // leave some holes, like removed bodies do
+      if (uiSlot % 11 == 10)
+        continue;
+
+      ref_snapshot.m_BodyIDs[uiSlot] = uiSlot;
+      ref_snapshot.m_States[uiSlot] = JPHBodySnapshot::JPHBodyStateFlags::Valid;
+
+      if (uiSlot % 3 == 0)
+        ref_snapshot.m_States[uiSlot] |= JPHBodySnapshot::JPHBodyStateFlags::Active;
+
+      ref_snapshot.m_MotionTypes[uiSlot] = 2;
+      ref_snapshot.m_ObjectLayers[uiSlot] = 1;
+      ref_snapshot.m_Positions[uiSlot].Set(ref_rng.FloatMinMax(-200, 200), ref_rng.FloatMinMax(-200, 200), ref_rng.FloatMinMax(-50, 50));
+      ref_snapshot.m_Rotations[uiSlot] = nsQuat::MakeIdentity();
+      ref_snapshot.m_LinearVelocities[uiSlot].Set(ref_rng.FloatMinMax(-10, 10), ref_rng.FloatMinMax(-10, 10), 0);
+      ref_snapshot.m_AngularVelocities[uiSlot].SetZero();
+    }
+  }
+
+  /// Bins the bodies the way the aggregator is expected to, for a grid of the given base cell size and level.
+  static void BinAggregatedBodies(const JPHBodySnapshot& snapshot, nsArrayPtr<const nsUInt8> interestMask, float fBaseCellSize, nsUInt8 uiLevel, nsMap<nsUInt64, ExpectedAggregateCell>& out_cells)
+  {
+    out_cells.Clear();
+
+    for (nsUInt32 uiSlot = 0; uiSlot < snapshot.GetSlotCount(); ++uiSlot)
+    {
+      if (interestMask[uiSlot] != 0 || !snapshot.IsValid(uiSlot))
+        continue;
+
+      const nsVec3& vPosition = snapshot.m_Positions[uiSlot];
+      const float fInvCellSize = 1.0f / fBaseCellSize;
+      const nsVec3I32 vCoords(static_cast<nsInt32>(nsMath::Floor(vPosition.x * fInvCellSize)) >> uiLevel, static_cast<nsInt32>(nsMath::Floor(vPosition.y * fInvCellSize)) >> uiLevel,
+        static_cast<nsInt32>(nsMath::Floor(vPosition.z * fInvCellSize)) >> uiLevel);
+
+      ExpectedAggregateCell& cell = out_cells[GetAggregateCellKey(vCoords)];
+      ++cell.m_uiNumBodies;
+      cell.m_uiNumActiveBodies += snapshot.IsActive(uiSlot) ? 1 : 0;
+      cell.m_Bounds.ExpandToInclude(vPosition);
+      cell.m_vVelocitySum += snapshot.m_LinearVelocities[uiSlot];
+    }
+  }
+
+  static void TestAggregatedCells(const JPHAggregateGrid& grid, const nsMap<nsUInt64, ExpectedAggregateCell>& expected)
+  {
+    NS_TEST_INT(grid.m_Cells.GetCount(), expected.GetCount());
+
+    nsUInt32 uiNumBodies = 0;
+
+    for (nsUInt32 i = 0; i < grid.m_Cells.GetCount(); ++i)
+    {
+      const JPHAggregateCell& cell = grid.m_Cells[i];
+      uiNumBodies += cell.m_uiNumBodies;
+
+      // the map is ordered by the packed key, which orders by x, then y, then z, just like the grid
+      if (i > 0)
+      {
+        NS_TEST_BOOL(GetAggregateCellKey(grid.m_Cells[i - 1].m_Coords) < GetAggregateCellKey(cell.m_Coords));
+      }
+
+      auto it = expected.Find(GetAggregateCellKey(cell.m_Coords));
+      NS_TEST_BOOL(it.IsValid());
+
+      if (!it.IsValid())
+        continue;
+
+      NS_TEST_INT(cell.m_uiNumBodies, it.Value().m_uiNumBodies);
+      NS_TEST_INT(cell.m_uiNumActiveBodies, it.Value().m_uiNumActiveBodies);
+      NS_TEST_BOOL(cell.m_Bounds == it.Value().m_Bounds);
+      NS_TEST_VEC3(cell.m_vMeanVelocity, it.Value().m_vVelocitySum / static_cast<float>(it.Value().m_uiNumBodies), 0.001f);
+      NS_TEST_FLOAT(cell.m_fMaxKineticEnergy, 0.0f, 0.0f);
+    }
+
+    NS_TEST_INT(grid.m_uiNumBodies, uiNumBodies);
+  }
+
+  static void TestAggregateGridsMatch(const JPHAggregateGrid& expected, const JPHAggregateGrid& decoded)
+  {
+    NS_TEST_BOOL(decoded.m_fCellSize == expected.m_fCellSize);
+    NS_TEST_INT(decoded.m_uiLevel, expected.m_uiLevel);
+    NS_TEST_INT(decoded.m_uiNumBodies, expected.m_uiNumBodies);
+    NS_TEST_INT(decoded.m_Cells.GetCount(), expected.m_Cells.GetCount());
+
+    for (nsUInt32 i = 0; i < nsMath::Min(decoded.m_Cells.GetCount(), expected.m_Cells.GetCount()); ++i)
+    {
+      const JPHAggregateCell& a = expected.m_Cells[i];
+      const JPHAggregateCell& b = decoded.m_Cells[i];
+
+      // floats are stored as is
+      NS_TEST_BOOL(b.m_Coords == a.m_Coords);
+      NS_TEST_INT(b.m_uiNumBodies, a.m_uiNumBodies);
+      NS_TEST_INT(b.m_uiNumActiveBodies, a.m_uiNumActiveBodies);
+      NS_TEST_BOOL(b.m_Bounds == a.m_Bounds);
+      NS_TEST_BOOL(b.m_vMeanVelocity == a.m_vMeanVelocity);
+      NS_TEST_BOOL(b.m_fMaxKineticEnergy == a.m_fMaxKineticEnergy);
+    }
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, AggregateGrid)
+{
+  constexpr nsUInt32 uiNumSlots = 40000;
+
+  nsRandom rng;
+  rng.Initialize(24);
+
+  JPHBodySnapshot snapshot;
+  nsDynamicArray<nsUInt8> interestMask;
+  FillAggregatedSnapshot(snapshot, interestMask, uiNumSlots, rng);
+
+  JPHSpatialAggregator aggregator;
+  JPHAggregationSettings settings;
+  settings.m_fCellSize = 16.0f;
+  settings.m_uiMaxCells = 100000;
+
+  JPHAggregateGrid grid;
+  nsMap<nsUInt64, ExpectedAggregateCell> expected;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Aggregate")
+  {
+    // more slots than a single binning task takes, so the chunks have to be merged
+    aggregator.Aggregate(nullptr, snapshot, interestMask, settings, grid);
+    NS_TEST_INT(grid.m_uiLevel, 0);
+    NS_TEST_FLOAT(grid.m_fCellSize, settings.m_fCellSize, 0.0f);
+
+    BinAggregatedBodies(snapshot, interestMask, settings.m_fCellSize, 0, expected);
+    TestAggregatedCells(grid, expected);
+
+    // too many cells for the budget, the grid is coarsened until they fit
+    settings.m_uiMaxCells = 64;
+    JPHAggregateGrid coarseGrid;
+    aggregator.Aggregate(nullptr, snapshot, interestMask, settings, coarseGrid);
+    NS_TEST_BOOL(coarseGrid.m_uiLevel > 0);
+    NS_TEST_BOOL(coarseGrid.m_Cells.GetCount() <= settings.m_uiMaxCells);
+    NS_TEST_FLOAT(coarseGrid.m_fCellSize, settings.m_fCellSize * static_cast<float>(1u << coarseGrid.m_uiLevel), 0.0f);
+    NS_TEST_INT(coarseGrid.m_uiNumBodies, grid.m_uiNumBodies);
+
+    BinAggregatedBodies(snapshot, interestMask, settings.m_fCellSize, coarseGrid.m_uiLevel, expected);
+    TestAggregatedCells(coarseGrid, expected);
+
+    // the level is the smallest that fits
+    BinAggregatedBodies(snapshot, interestMask, settings.m_fCellSize, coarseGrid.m_uiLevel - 1, expected);
+    NS_TEST_BOOL(expected.GetCount() > settings.m_uiMaxCells);
+
+    // everything in the interest set
+    nsDynamicArray<nsUInt8> fullMask;
+    fullMask.SetCount(uiNumSlots, 1);
+    aggregator.Aggregate(nullptr, snapshot, fullMask, settings, coarseGrid);
+    NS_TEST_INT(coarseGrid.m_uiNumBodies, 0);
+    NS_TEST_INT(coarseGrid.m_Cells.GetCount(), 0);
+  }
+
+  // cells far apart, so the coordinate differences cover the whole range
+  grid.m_Cells.ExpandAndGetRef().m_Coords.Set(nsMath::MinValue<nsInt32>(), 0, nsMath::MaxValue<nsInt32>());
+  grid.m_Cells.ExpandAndGetRef().m_Coords.Set(nsMath::MaxValue<nsInt32>(), nsMath::MinValue<nsInt32>(), -1);
+  grid.m_Cells.PeekBack().m_uiNumBodies = nsMath::MaxValue<nsUInt32>();
+  grid.m_Cells.PeekBack().m_uiNumActiveBodies = nsMath::MaxValue<nsUInt32>();
+  grid.m_Cells.PeekBack().m_Bounds = nsBoundingBox::MakeFromMinMax(nsVec3(-1e30f), nsVec3(1e30f));
+  grid.m_Cells.PeekBack().m_fMaxKineticEnergy = 12345.678f;
+
+  nsDynamicArray<nsUInt8> data;
+  grid.Write(data);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Round Trip")
+  {
+    JPHAggregateGrid decoded;
+    NS_TEST_BOOL(decoded.Read(data).Succeeded());
+    TestAggregateGridsMatch(grid, decoded);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Empty")
+  {
+    JPHAggregateGrid empty;
+    empty.m_fCellSize = 32.0f;
+    empty.m_uiLevel = 1;
+
+    nsDynamicArray<nsUInt8> emptyData;
+    empty.Write(emptyData);
+    NS_TEST_INT(emptyData.GetCount(), 7);
+
+    // the existing content is replaced
+    JPHAggregateGrid decoded;
+    NS_TEST_BOOL(decoded.Read(data).Succeeded());
+    NS_TEST_BOOL(decoded.Read(emptyData).Succeeded());
+    TestAggregateGridsMatch(empty, decoded);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Truncated")
+  {
+    JPHAggregateGrid decoded;
+
+    for (nsUInt32 uiSize = 0; uiSize < data.GetCount(); ++uiSize)
+    {
+      NS_TEST_BOOL(decoded.Read(data.GetArrayPtr().GetSubArray(0, uiSize)).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt")
+  {
+    // header: float cell size, u8 level, then the varuint body and cell counts
+    constexpr nsUInt32 uiCountsOffset = 5;
+
+    JPHAggregateGrid header;
+    header.m_fCellSize = 16.0f;
+
+    auto ReadWithCounts = [&](nsUInt64 uiNumBodies, nsUInt64 uiNumCells, nsArrayPtr<const nsUInt8> cells) -> nsResult
+    {
+      nsDynamicArray<nsUInt8> corrupt;
+      header.Write(corrupt);
+      corrupt.SetCount(uiCountsOffset);
+
+      // the same encoding the writer uses, with values the writer never produces
+      for (nsUInt64 uiValue : {uiNumBodies, uiNumCells})
+      {
+        while (uiValue >= 0x80)
+        {
+          corrupt.PushBack(static_cast<nsUInt8>(uiValue | 0x80));
+          uiValue >>= 7;
+        }
+
+        corrupt.PushBack(static_cast<nsUInt8>(uiValue));
+      }
+
+      corrupt.PushBackRange(cells);
+
+      JPHAggregateGrid decoded;
+      return decoded.Read(corrupt);
+    };
+
+    // the cells of a valid grid with a single cell, the coordinates are the first three bytes
+    JPHAggregateGrid single;
+    single.m_Cells.ExpandAndGetRef().m_uiNumBodies = 2;
+    nsDynamicArray<nsUInt8> cellData;
+    single.Write(cellData);
+    nsDynamicArray<nsUInt8> cell;
+    cell = cellData.GetArrayPtr().GetSubArray(uiCountsOffset + 2);
+
+    NS_TEST_BOOL(ReadWithCounts(2, 1, cell).Succeeded());
+
+    // counts that don't fit the data or don't fit into 32 bit
+    NS_TEST_BOOL(ReadWithCounts(2, 2, cell).Failed());
+    NS_TEST_BOOL(ReadWithCounts(2, 0xFFFFFFFFull, cell).Failed());
+    // times the minimum cell size, this wraps around to 29 bytes
+    NS_TEST_BOOL(ReadWithCounts(2, 0x5B05B05B05B05B1ull, cell).Failed());
+    NS_TEST_BOOL(ReadWithCounts(2, 0xFFFFFFFFFFFFFFFFull, cell).Failed());
+    NS_TEST_BOOL(ReadWithCounts(0x100000000ull, 1, cell).Failed());
+
+    // more active bodies than bodies
+    nsDynamicArray<nsUInt8> corruptCell;
+    corruptCell = cell;
+    corruptCell[4] = 3;
+    NS_TEST_BOOL(ReadWithCounts(2, 1, corruptCell).Failed());
+
+    // a body count above 32 bit, 2^32 as varuint
+    const nsUInt8 uiVarUInt32[] = {0x80, 0x80, 0x80, 0x80, 0x10};
+    corruptCell.Clear();
+    corruptCell.PushBackRange(cell.GetArrayPtr().GetSubArray(0, 3));
+    corruptCell.PushBackRange(nsMakeArrayPtr(uiVarUInt32));
+    corruptCell.PushBackRange(cell.GetArrayPtr().GetSubArray(4));
+    NS_TEST_BOOL(ReadWithCounts(2, 1, corruptCell).Failed());
+
+    // coordinates outside of the 32 bit range, 2^32 and 2^64 - 1 are the zigzag encoded 2^31 and -2^63
+    const nsUInt8 uiVarUInt64[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+
+    corruptCell.Clear();
+    corruptCell.PushBackRange(nsMakeArrayPtr(uiVarUInt32));
+    corruptCell.PushBackRange(cell.GetArrayPtr().GetSubArray(1));
+    NS_TEST_BOOL(ReadWithCounts(2, 1, corruptCell).Failed());
+
+    corruptCell.Clear();
+    corruptCell.PushBackRange(nsMakeArrayPtr(uiVarUInt64));
+    corruptCell.PushBackRange(cell.GetArrayPtr().GetSubArray(1));
+    NS_TEST_BOOL(ReadWithCounts(2, 1, corruptCell).Failed());
+
+    nsDynamicArray<nsUInt8> trailing = data;
+    trailing.PushBack(0);
+
+    JPHAggregateGrid decoded;
+    NS_TEST_BOOL(decoded.Read(trailing).Failed());
+
+    for (nsUInt32 i = 0; i < 500; ++i)
+    {
+      nsDynamicArray<nsUInt8> corrupt = data;
+      corrupt[rng.UIntInRange(corrupt.GetCount())] ^= static_cast<nsUInt8>(1u << rng.UIntInRange(8));
+
+      if (decoded.Read(corrupt).Succeeded())
+      {
+        bool bValid = true;
+        for (const JPHAggregateCell& decodedCell : decoded.m_Cells)
+          bValid &= decodedCell.m_uiNumActiveBodies <= decodedCell.m_uiNumBodies;
+
+        NS_TEST_BOOL(bValid);
+      }
+    }
+  }
+}
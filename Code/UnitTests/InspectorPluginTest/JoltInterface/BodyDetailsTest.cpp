@@ -0,0 +1,389 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHBodyDetails.h>
+#include <InspectorPlugin/JoltInterface/JPHShapeDictionary.h>
+#include <InspectorPluginTest/JoltInterface/JoltTestHelpers.h>
+#include <Jolt/Core/JobSystemSingleThreaded.h>
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  static void MakeBodyDetails(nsUInt32 uiNumDetails, nsRandom& ref_rng, JPHBodyDetailBatch& out_batch)
+  {
+    out_batch.m_uiStepIndex = 0x123456789ABCull;
+    out_batch.m_bHasContacts = true;
+    out_batch.m_Details.SetCount(uiNumDetails);
+
+    for (nsUInt32 i = 0; i < uiNumDetails; ++i)
+    {
+      JPHBodyDetail& detail = out_batch.m_Details[i];
+      detail.m_uiBodyID = ref_rng.UInt();
+
+      // every third body was not found
+      if (i % 3 == 2)
+        continue;
+
+      detail.m_bFound = true;
+      detail.m_bActive = (i & 1) != 0;
+      detail.m_bSensor = (i & 2) != 0;
+      detail.m_bAllowSleeping = (i & 4) != 0;
+      detail.m_bHasGroupFilter = (i & 8) != 0;
+      detail.m_uiMotionType = static_cast<nsUInt8>(i % 3);
+      detail.m_uiMotionQuality = static_cast<nsUInt8>(i % 2);
+      detail.m_uiObjectLayer = i * 1000;
+      detail.m_uiUserData = (static_cast<nsUInt64>(ref_rng.UInt()) << 32) | ref_rng.UInt();
+      detail.m_uiCollisionGroupID = ref_rng.UInt();
+      detail.m_uiCollisionSubGroupID = ref_rng.UInt();
+      detail.m_fFriction = ref_rng.FloatMinMax(0, 1);
+      detail.m_fRestitution = ref_rng.FloatMinMax(0, 1);
+      detail.m_fMass = ref_rng.FloatMinMax(0, 1000);
+      detail.m_vInertiaDiagonal.Set(ref_rng.FloatMinMax(0, 10), ref_rng.FloatMinMax(0, 10), ref_rng.FloatMinMax(0, 10));
+      detail.m_qInertiaRotation = nsQuat::MakeFromAxisAndAngle(nsVec3(0, 1, 0), nsAngle::MakeFromDegree(ref_rng.FloatMinMax(0, 360)));
+      detail.m_fLinearDamping = ref_rng.FloatMinMax(0, 1);
+      detail.m_fAngularDamping = ref_rng.FloatMinMax(0, 1);
+      detail.m_fGravityFactor = ref_rng.FloatMinMax(0, 2);
+      detail.m_fMaxLinearVelocity = ref_rng.FloatMinMax(0, 500);
+      detail.m_fMaxAngularVelocity = ref_rng.FloatMinMax(0, 50);
+      detail.m_vCenterOfMass.Set(ref_rng.FloatMinMax(-100, 100), ref_rng.FloatMinMax(-100, 100), ref_rng.FloatMinMax(-100, 100));
+      detail.m_uiShapeID = i == 0 ? JPHShapeDictionary::s_uiInvalidShapeID : i;
+      detail.m_uiShapeType = static_cast<nsUInt8>(i % 5);
+      detail.m_uiShapeSubType = static_cast<nsUInt8>(i % 7);
+      detail.m_ShapeBounds = nsBoundingBox::MakeFromMinMax(nsVec3(-1, -2, -3), nsVec3(1, 2, ref_rng.FloatMinMax(3, 4)));
+      detail.m_fShapeVolume = ref_rng.FloatMinMax(0, 24);
+      detail.m_Contacts.SetCount(i % 4);
+
+      for (JPHBodyContactDetail& contact : detail.m_Contacts)
+      {
+        contact.m_uiOtherBodyID = ref_rng.UInt();
+        contact.m_uiSubShapeID = ref_rng.UInt();
+        contact.m_uiOtherSubShapeID = ref_rng.UInt();
+        contact.m_vNormal.Set(ref_rng.FloatMinMax(-1, 1), ref_rng.FloatMinMax(-1, 1), ref_rng.FloatMinMax(-1, 1));
+        contact.m_fPenetration = ref_rng.FloatMinMax(-0.01f, 0.1f);
+        contact.m_fImpulse = ref_rng.FloatMinMax(0.0f, 100.0f);
+        contact.m_eEvent = static_cast<JPHContactEvent>(ref_rng.UIntInRange(3));
+        contact.m_uiFlags = static_cast<nsUInt8>(ref_rng.UIntInRange(4));
+      }
+    }
+  }
+
+  static void TestBodyDetailsMatch(const JPHBodyDetail& expected, const JPHBodyDetail& decoded)
+  {
+    NS_TEST_INT(decoded.m_uiBodyID, expected.m_uiBodyID);
+    NS_TEST_BOOL(decoded.m_bFound == expected.m_bFound);
+    NS_TEST_BOOL(decoded.m_bActive == expected.m_bActive);
+    NS_TEST_BOOL(decoded.m_bSensor == expected.m_bSensor);
+    NS_TEST_BOOL(decoded.m_bAllowSleeping == expected.m_bAllowSleeping);
+    NS_TEST_BOOL(decoded.m_bHasGroupFilter == expected.m_bHasGroupFilter);
+
+    if (!expected.m_bFound)
+    {
+      // nothing but the ID is written for bodies that were not found
+      NS_TEST_INT(decoded.m_Contacts.GetCount(), 0);
+      NS_TEST_INT(decoded.m_uiObjectLayer, 0);
+      return;
+    }
+
+    // floats are stored as is
+    NS_TEST_INT(decoded.m_uiMotionType, expected.m_uiMotionType);
+    NS_TEST_INT(decoded.m_uiMotionQuality, expected.m_uiMotionQuality);
+    NS_TEST_INT(decoded.m_uiObjectLayer, expected.m_uiObjectLayer);
+    NS_TEST_BOOL(decoded.m_uiUserData == expected.m_uiUserData);
+    NS_TEST_INT(decoded.m_uiCollisionGroupID, expected.m_uiCollisionGroupID);
+    NS_TEST_INT(decoded.m_uiCollisionSubGroupID, expected.m_uiCollisionSubGroupID);
+    NS_TEST_BOOL(decoded.m_fFriction == expected.m_fFriction);
+    NS_TEST_BOOL(decoded.m_fRestitution == expected.m_fRestitution);
+    NS_TEST_BOOL(decoded.m_fMass == expected.m_fMass);
+    NS_TEST_BOOL(decoded.m_vInertiaDiagonal == expected.m_vInertiaDiagonal);
+    NS_TEST_BOOL(decoded.m_qInertiaRotation == expected.m_qInertiaRotation);
+    NS_TEST_BOOL(decoded.m_fLinearDamping == expected.m_fLinearDamping);
+    NS_TEST_BOOL(decoded.m_fAngularDamping == expected.m_fAngularDamping);
+    NS_TEST_BOOL(decoded.m_fGravityFactor == expected.m_fGravityFactor);
+    NS_TEST_BOOL(decoded.m_fMaxLinearVelocity == expected.m_fMaxLinearVelocity);
+    NS_TEST_BOOL(decoded.m_fMaxAngularVelocity == expected.m_fMaxAngularVelocity);
+    NS_TEST_BOOL(decoded.m_vCenterOfMass == expected.m_vCenterOfMass);
+    NS_TEST_INT(decoded.m_uiShapeID, expected.m_uiShapeID);
+    NS_TEST_INT(decoded.m_uiShapeType, expected.m_uiShapeType);
+    NS_TEST_INT(decoded.m_uiShapeSubType, expected.m_uiShapeSubType);
+    NS_TEST_BOOL(decoded.m_ShapeBounds == expected.m_ShapeBounds);
+    NS_TEST_BOOL(decoded.m_fShapeVolume == expected.m_fShapeVolume);
+    NS_TEST_INT(decoded.m_Contacts.GetCount(), expected.m_Contacts.GetCount());
+
+    for (nsUInt32 i = 0; i < nsMath::Min(decoded.m_Contacts.GetCount(), expected.m_Contacts.GetCount()); ++i)
+    {
+      const JPHBodyContactDetail& a = expected.m_Contacts[i];
+      const JPHBodyContactDetail& b = decoded.m_Contacts[i];
+
+      NS_TEST_INT(b.m_uiOtherBodyID, a.m_uiOtherBodyID);
+      NS_TEST_INT(b.m_uiSubShapeID, a.m_uiSubShapeID);
+      NS_TEST_INT(b.m_uiOtherSubShapeID, a.m_uiOtherSubShapeID);
+      NS_TEST_BOOL(b.m_vNormal == a.m_vNormal);
+      NS_TEST_BOOL(b.m_fPenetration == a.m_fPenetration);
+      NS_TEST_BOOL(b.m_fImpulse == a.m_fImpulse);
+      NS_TEST_BOOL(b.m_eEvent == a.m_eEvent);
+      NS_TEST_INT(b.m_uiFlags, a.m_uiFlags);
+    }
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, BodyDetails)
+{
+  nsRandom rng;
+  rng.Initialize(25);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Resolve")
+  {
+    JoltTestHelpers::TestPhysicsSystem physics;
+    JPH::BodyInterface& bodyInterface = physics.GetBodyInterface();
+
+    JPH::BodyCreationSettings floorSettings(new JPH::BoxShape(JPH::Vec3(50, 1, 50)), JPH::RVec3(0, -1, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Static, 0);
+    const JPH::BodyID floorID = bodyInterface.CreateAndAddBody(floorSettings, JPH::EActivation::DontActivate);
+
+    // slightly sunk into the floor, so the first step finds a contact
+    JPH::BodyCreationSettings sphereSettings(new JPH::SphereShape(0.5f), JPH::RVec3(0, 0.45f, 0), JPH::Quat::sIdentity(), JPH::EMotionType::Dynamic, 1);
+    sphereSettings.mFriction = 0.25f;
+    sphereSettings.mRestitution = 0.125f;
+    sphereSettings.mUserData = 0x1234567890ull;
+    sphereSettings.mCollisionGroup.SetGroupID(7);
+    sphereSettings.mCollisionGroup.SetSubGroupID(3);
+    const JPH::BodyID sphereID = bodyInterface.CreateAndAddBody(sphereSettings, JPH::EActivation::Activate);
+
+    // the ID of a body that no longer exists
+    const JPH::BodyID removedID = bodyInterface.CreateAndAddBody(sphereSettings, JPH::EActivation::DontActivate);
+    bodyInterface.RemoveBody(removedID);
+    bodyInterface.DestroyBody(removedID);
+
+    JPHContactRecorder recorder;
+    recorder.Attach(physics.GetSystem());
+
+    JPH::TempAllocatorImpl tempAllocator(4 * 1024 * 1024);
+    JPH::JobSystemSingleThreaded jobSystem(JPH::cMaxPhysicsJobs);
+    physics.GetSystem().Update(1.0f / 60.0f, 1, &tempAllocator, &jobSystem);
+    recorder.CollectContacts();
+    NS_TEST_BOOL(!recorder.GetContacts().IsEmpty());
+
+    const nsUInt32 requestedIDs[] = {sphereID.GetIndexAndSequenceNumber(), floorID.GetIndexAndSequenceNumber(), removedID.GetIndexAndSequenceNumber(),
+      JPH::BodyID::cBroadPhaseBit | 1};
+
+    JPHBodyDetailResolver resolver;
+    JPHBodyDetailBatch batch;
+    batch.m_uiStepIndex = 17;
+    resolver.Resolve(physics.GetSystem(), nullptr, &recorder, nsMakeArrayPtr(requestedIDs), batch);
+
+    NS_TEST_INT(batch.m_uiStepIndex, 17);
+    NS_TEST_BOOL(batch.m_bHasContacts);
+    NS_TEST_INT(batch.m_Details.GetCount(), 4);
+
+    if (batch.m_Details.GetCount() == 4)
+    {
+      const JPHBodyDetail& sphere = batch.m_Details[0];
+      const float fSphereMass = 1000.0f * 4.0f / 3.0f * nsMath::Pi<float>() * 0.125f;
+
+      NS_TEST_INT(sphere.m_uiBodyID, requestedIDs[0]);
+      NS_TEST_BOOL(sphere.m_bFound);
+      NS_TEST_BOOL(sphere.m_bActive);
+      NS_TEST_BOOL(!sphere.m_bSensor);
+      NS_TEST_BOOL(sphere.m_bAllowSleeping);
+      NS_TEST_INT(sphere.m_uiMotionType, static_cast<nsUInt8>(JPH::EMotionType::Dynamic));
+      NS_TEST_INT(sphere.m_uiObjectLayer, 1);
+      NS_TEST_BOOL(sphere.m_uiUserData == 0x1234567890ull);
+      NS_TEST_INT(sphere.m_uiCollisionGroupID, 7);
+      NS_TEST_INT(sphere.m_uiCollisionSubGroupID, 3);
+      NS_TEST_BOOL(!sphere.m_bHasGroupFilter);
+      NS_TEST_FLOAT(sphere.m_fFriction, 0.25f, 0.0f);
+      NS_TEST_FLOAT(sphere.m_fRestitution, 0.125f, 0.0f);
+      NS_TEST_FLOAT(sphere.m_fMass, fSphereMass, 0.1f);
+      NS_TEST_VEC3(sphere.m_vInertiaDiagonal, nsVec3(0.4f * fSphereMass * 0.25f), 0.01f);
+      NS_TEST_FLOAT(sphere.m_fGravityFactor, 1.0f, 0.0f);
+      NS_TEST_INT(sphere.m_uiShapeID, JPHShapeDictionary::s_uiInvalidShapeID);
+      NS_TEST_INT(sphere.m_uiShapeType, static_cast<nsUInt8>(JPH::EShapeType::Convex));
+      NS_TEST_INT(sphere.m_uiShapeSubType, static_cast<nsUInt8>(JPH::EShapeSubType::Sphere));
+      NS_TEST_BOOL(sphere.m_ShapeBounds.IsEqual(nsBoundingBox::MakeFromMinMax(nsVec3(-0.5f), nsVec3(0.5f)), 0.0001f));
+      NS_TEST_FLOAT(sphere.m_fShapeVolume, 4.0f / 3.0f * nsMath::Pi<float>() * 0.125f, 0.0001f);
+
+      const JPHBodyDetail& floor = batch.m_Details[1];
+      NS_TEST_BOOL(floor.m_bFound);
+      NS_TEST_BOOL(!floor.m_bActive);
+      NS_TEST_BOOL(!floor.m_bAllowSleeping);
+      NS_TEST_INT(floor.m_uiMotionType, static_cast<nsUInt8>(JPH::EMotionType::Static));
+      NS_TEST_FLOAT(floor.m_fMass, 0.0f, 0.0f);
+      NS_TEST_FLOAT(floor.m_fGravityFactor, 0.0f, 0.0f);
+      NS_TEST_VEC3(floor.m_vCenterOfMass, nsVec3(0, -1, 0), 0.0001f);
+      NS_TEST_INT(floor.m_uiShapeSubType, static_cast<nsUInt8>(JPH::EShapeSubType::Box));
+
+      NS_TEST_BOOL(!batch.m_Details[2].m_bFound);
+      NS_TEST_INT(batch.m_Details[2].m_uiBodyID, requestedIDs[2]);
+      NS_TEST_BOOL(!batch.m_Details[3].m_bFound);
+
+      // both bodies see the contact, each with the normal pointing to the other one
+      NS_TEST_BOOL(!sphere.m_Contacts.IsEmpty());
+      NS_TEST_INT(floor.m_Contacts.GetCount(), sphere.m_Contacts.GetCount());
+
+      for (const JPHBodyContactDetail& contact : sphere.m_Contacts)
+      {
+        NS_TEST_INT(contact.m_uiOtherBodyID, requestedIDs[1]);
+        NS_TEST_FLOAT(contact.m_vNormal.y, -1.0f, 0.001f);
+      }
+
+      for (const JPHBodyContactDetail& contact : floor.m_Contacts)
+      {
+        NS_TEST_INT(contact.m_uiOtherBodyID, requestedIDs[0]);
+        NS_TEST_FLOAT(contact.m_vNormal.y, 1.0f, 0.001f);
+      }
+
+      nsDynamicArray<nsUInt8> resolvedData;
+      batch.Write(resolvedData);
+
+      JPHBodyDetailBatch decoded;
+      NS_TEST_BOOL(decoded.Read(resolvedData).Succeeded());
+      NS_TEST_INT(decoded.m_Details.GetCount(), batch.m_Details.GetCount());
+
+      for (nsUInt32 i = 0; i < nsMath::Min(decoded.m_Details.GetCount(), batch.m_Details.GetCount()); ++i)
+      {
+        TestBodyDetailsMatch(batch.m_Details[i], decoded.m_Details[i]);
+      }
+    }
+
+    // without a contact recorder, the contact lists stay empty
+    resolver.Resolve(physics.GetSystem(), nullptr, nullptr, nsMakeArrayPtr(requestedIDs), batch);
+    NS_TEST_BOOL(!batch.m_bHasContacts);
+    NS_TEST_BOOL(batch.m_Details[0].m_Contacts.IsEmpty());
+
+    recorder.Detach();
+  }
+
+  JPHBodyDetailBatch batch;
+  MakeBodyDetails(40, rng, batch);
+
+  nsDynamicArray<nsUInt8> data;
+  batch.Write(data);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Round Trip")
+  {
+    JPHBodyDetailBatch decoded;
+    NS_TEST_BOOL(decoded.Read(data).Succeeded());
+    NS_TEST_BOOL(decoded.m_uiStepIndex == batch.m_uiStepIndex);
+    NS_TEST_BOOL(decoded.m_bHasContacts);
+    NS_TEST_INT(decoded.m_Details.GetCount(), batch.m_Details.GetCount());
+
+    for (nsUInt32 i = 0; i < nsMath::Min(decoded.m_Details.GetCount(), batch.m_Details.GetCount()); ++i)
+    {
+      TestBodyDetailsMatch(batch.m_Details[i], decoded.m_Details[i]);
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Empty")
+  {
+    JPHBodyDetailBatch empty;
+    empty.m_uiStepIndex = 5;
+
+    nsDynamicArray<nsUInt8> emptyData;
+    empty.Write(emptyData);
+    NS_TEST_INT(emptyData.GetCount(), 10);
+
+    // the existing content is replaced
+    JPHBodyDetailBatch decoded;
+    NS_TEST_BOOL(decoded.Read(data).Succeeded());
+    NS_TEST_BOOL(decoded.Read(emptyData).Succeeded());
+    NS_TEST_BOOL(decoded.m_uiStepIndex == 5);
+    NS_TEST_BOOL(!decoded.m_bHasContacts);
+    NS_TEST_INT(decoded.m_Details.GetCount(), 0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Truncated")
+  {
+    JPHBodyDetailBatch decoded;
+
+    for (nsUInt32 uiSize = 0; uiSize < data.GetCount(); ++uiSize)
+    {
+      NS_TEST_BOOL(decoded.Read(data.GetArrayPtr().GetSubArray(0, uiSize)).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt")
+  {
+    // header: u64 step index, u8 flags, then the varuint body count
+    constexpr nsUInt32 uiCountOffset = 9;
+
+    // a single found body without contacts, the object layer is the first varuint after the ID, flags and motion bytes
+    JPHBodyDetailBatch single;
+    single.m_Details.ExpandAndGetRef().m_bFound = true;
+
+    nsDynamicArray<nsUInt8> singleData;
+    single.Write(singleData);
+
+    constexpr nsUInt32 uiObjectLayerOffset = uiCountOffset + 1 + 7;
+    constexpr nsUInt32 uiContactCountOffset = uiObjectLayerOffset + 1 + 8 + 8 + 12 + 12 + 16 + 20 + 12 + 4 + 2 + 24 + 4;
+    NS_TEST_INT(singleData.GetCount(), uiContactCountOffset + 1);
+
+    auto ReadWithVarUInt = [&](nsUInt32 uiOffset, nsUInt64 uiValue) -> nsResult
+    {
+      nsDynamicArray<nsUInt8> corrupt;
+      corrupt = singleData.GetArrayPtr().GetSubArray(0, uiOffset);
+
+      // the same encoding the writer uses, with values the writer never produces
+      while (uiValue >= 0x80)
+      {
+        corrupt.PushBack(static_cast<nsUInt8>(uiValue | 0x80));
+        uiValue >>= 7;
+      }
+
+      corrupt.PushBack(static_cast<nsUInt8>(uiValue));
+      corrupt.PushBackRange(singleData.GetArrayPtr().GetSubArray(uiOffset + 1));
+
+      JPHBodyDetailBatch decoded;
+      return decoded.Read(corrupt);
+    };
+
+    NS_TEST_BOOL(ReadWithVarUInt(uiCountOffset, 1).Succeeded());
+    NS_TEST_BOOL(ReadWithVarUInt(uiObjectLayerOffset, 0xFFFFFFFFull).Succeeded());
+
+    // counts that don't fit the data, some of them wrap around to a few bytes or none when multiplied with the minimum size
+    NS_TEST_BOOL(ReadWithVarUInt(uiCountOffset, 2).Failed());
+    NS_TEST_BOOL(ReadWithVarUInt(uiCountOffset, 0xFFFFFFFFFFFFFFFFull).Failed());
+    NS_TEST_BOOL(ReadWithVarUInt(uiCountOffset, 0x3333333333333334ull).Failed());
+    NS_TEST_BOOL(ReadWithVarUInt(uiContactCountOffset, 1).Failed());
+    NS_TEST_BOOL(ReadWithVarUInt(uiContactCountOffset, 0xFFFFFFFFFFFFFFFFull).Failed());
+    NS_TEST_BOOL(ReadWithVarUInt(uiContactCountOffset, 0x8000000000000000ull).Failed());
+
+    // an object layer that doesn't fit into 32 bit
+    NS_TEST_BOOL(ReadWithVarUInt(uiObjectLayerOffset, 0x100000000ull).Failed());
+
+    // an unknown contact event
+    JPHBodyDetail& detail = single.m_Details.PeekBack();
+    detail.m_Contacts.ExpandAndGetRef().m_eEvent = JPHContactEvent::Removed;
+    single.Write(singleData);
+
+    JPHBodyDetailBatch decoded;
+    NS_TEST_BOOL(decoded.Read(singleData).Succeeded());
+
+    singleData[singleData.GetCount() - 2] = static_cast<nsUInt8>(JPHContactEvent::Removed) + 1;
+    NS_TEST_BOOL(decoded.Read(singleData).Failed());
+
+    nsDynamicArray<nsUInt8> trailing = data;
+    trailing.PushBack(0);
+    NS_TEST_BOOL(decoded.Read(trailing).Failed());
+
+    for (nsUInt32 i = 0; i < 500; ++i)
+    {
+      nsDynamicArray<nsUInt8> corrupt = data;
+      corrupt[rng.UIntInRange(corrupt.GetCount())] ^= static_cast<nsUInt8>(1u << rng.UIntInRange(8));
+
+      if (decoded.Read(corrupt).Succeeded())
+      {
+        bool bValid = true;
+        for (const JPHBodyDetail& decodedDetail : decoded.m_Details)
+        {
+          for (const JPHBodyContactDetail& contact : decodedDetail.m_Contacts)
+            bValid &= contact.m_eEvent <= JPHContactEvent::Removed;
+        }
+
+        NS_TEST_BOOL(bValid);
+      }
+    }
+  }
+}
@@ -0,0 +1,366 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <Foundation/Containers/Map.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHBodySeriesWriter.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileManager.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileReader.h>
+#include <InspectorPlugin/JoltInterface/JPHFrameEncoder.h>
+#include <Jolt/Physics/Body/BodyID.h>
+
+namespace
+{
+  using namespace JDebug::API;
+  using namespace JDebug::API::IO;
+
+  static constexpr nsUInt64 s_uiSeriesFirstStep = 100;
+  static constexpr nsUInt32 s_uiSeriesNumSteps = 2600;
+  static constexpr nsUInt32 s_uiSeriesNumSlots = 40;
+
+  using SeriesTruth = nsMap<nsUInt32, nsDynamicArray<JPHPVDBodySample>>;
+
+  static void SetSeriesBody(JPHBodySnapshot& ref_snapshot, nsUInt32 uiSlot, nsUInt32 uiSequence)
+  {
+    ref_snapshot.m_BodyIDs[uiSlot] = uiSlot | (uiSequence << 23);
+    ref_snapshot.m_States[uiSlot] = JPHBodySnapshot::JPHBodyStateFlags::Valid | JPHBodySnapshot::JPHBodyStateFlags::Active;
+    ref_snapshot.m_MotionTypes[uiSlot] = 2;
+    ref_snapshot.m_ObjectLayers[uiSlot] = 1;
+    ref_snapshot.m_ShapeIDs[uiSlot] = 0;
+    ref_snapshot.m_Positions[uiSlot].Set(static_cast<float>(uiSlot), 0, 0);
+    ref_snapshot.m_Rotations[uiSlot] = nsQuat::MakeIdentity();
+    ref_snapshot.m_LinearVelocities[uiSlot].SetZero();
+    ref_snapshot.m_AngularVelocities[uiSlot].SetZero();
+  }
+
+  /// Moves some bodies every step, replaces and removes bodies now and then and finally shrinks the slot count.
+  static void AdvanceSeriesScene(JPHBodySnapshot& ref_snapshot, nsUInt32 uiStep, nsRandom& ref_rng)
+  {
+    if (uiStep == 0)
+    {
+      ref_snapshot.SetSlotCount(s_uiSeriesNumSlots);
+      for (nsUInt32 uiSlot = 0; uiSlot < s_uiSeriesNumSlots; ++uiSlot)
+        SetSeriesBody(ref_snapshot, uiSlot, 0);
+
+      return;
+    }
+
+    if (uiStep == 2000)
+      ref_snapshot.SetSlotCount(s_uiSeriesNumSlots - 10);
+
+    const nsUInt32 uiNumSlots = ref_snapshot.GetSlotCount();
+
+    if (uiStep % 300 == 150)
+      SetSeriesBody(ref_snapshot, (uiStep / 300) % uiNumSlots, uiStep / 300 + 1);
+
+    if (uiStep % 450 == 225)
+      ref_snapshot.ClearSlot((uiStep / 450 + 7) % uiNumSlots);
+
+    if (uiStep % 450 == 400)
+      SetSeriesBody(ref_snapshot, (uiStep / 450 + 7) % uiNumSlots, uiStep / 450 + 100);
+
+    for (nsUInt32 i = 0; i < 10; ++i)
+    {
+      const nsUInt32 uiSlot = ref_rng.UIntInRange(uiNumSlots);
+      if (!ref_snapshot.IsValid(uiSlot))
+        continue;
+
+      ref_snapshot.m_Positions[uiSlot] += nsVec3(ref_rng.FloatMinMax(-0.5f, 0.5f), 0.2f, ref_rng.FloatMinMax(-0.5f, 0.5f));
+      ref_snapshot.m_Rotations[uiSlot] = nsQuat::MakeFromAxisAndAngle(nsVec3(0, 1, 0), nsAngle::MakeFromRadian(ref_rng.FloatMinMax(-3.0f, 3.0f)));
+      ref_snapshot.m_LinearVelocities[uiSlot].Set(ref_rng.FloatMinMax(-5.0f, 5.0f), 0, 0);
+      ref_snapshot.m_AngularVelocities[uiSlot].Set(0, ref_rng.FloatMinMax(-2.0f, 2.0f), 0);
+    }
+  }
+
+  /// The samples the series has to hold according to its definition: one for every sent body, and one when a body disappears from its slot.
+  static void AddExpectedSamples(const JPHBodySnapshot& decoded, nsArrayPtr<const nsUInt32> decodedSlots, bool bKeyframe, nsUInt64 uiStepIndex, nsDynamicArray<nsUInt32>& ref_slotBodyIDs, SeriesTruth& ref_truth)
+  {
+    auto AddRemoved = [&](nsUInt32 uiBodyID)
+    {
+      JPHPVDBodySample& sample = ref_truth[uiBodyID].ExpandAndGetRef();
+      sample.m_uiStepIndex = uiStepIndex;
+      sample.m_uiState = 0;
+    };
+
+    auto AddSlot = [&](nsUInt32 uiSlot)
+    {
+      const nsUInt32 uiBodyID = decoded.IsValid(uiSlot) ? decoded.m_BodyIDs[uiSlot] : JPH::BodyID::cInvalidBodyID;
+
+      if (ref_slotBodyIDs[uiSlot] != uiBodyID && ref_slotBodyIDs[uiSlot] != JPH::BodyID::cInvalidBodyID)
+        AddRemoved(ref_slotBodyIDs[uiSlot]);
+
+      ref_slotBodyIDs[uiSlot] = uiBodyID;
+
+      if (uiBodyID == JPH::BodyID::cInvalidBodyID)
+        return;
+
+      JPHPVDBodySample& sample = ref_truth[uiBodyID].ExpandAndGetRef();
+      sample.m_uiStepIndex = uiStepIndex;
+      sample.m_vPosition = decoded.m_Positions[uiSlot];
+      sample.m_qRotation = decoded.m_Rotations[uiSlot];
+      sample.m_vLinearVelocity = decoded.m_LinearVelocities[uiSlot];
+      sample.m_vAngularVelocity = decoded.m_AngularVelocities[uiSlot];
+      sample.m_uiState = decoded.m_States[uiSlot];
+    };
+
+    for (nsUInt32 uiSlot = decoded.GetSlotCount(); uiSlot < ref_slotBodyIDs.GetCount(); ++uiSlot)
+    {
+      if (ref_slotBodyIDs[uiSlot] != JPH::BodyID::cInvalidBodyID)
+        AddRemoved(ref_slotBodyIDs[uiSlot]);
+    }
+
+    ref_slotBodyIDs.SetCount(decoded.GetSlotCount(), JPH::BodyID::cInvalidBodyID);
+
+    if (bKeyframe)
+    {
+      for (nsUInt32 uiSlot = 0; uiSlot < decoded.GetSlotCount(); ++uiSlot)
+        AddSlot(uiSlot);
+    }
+    else
+    {
+      for (nsUInt32 uiSlot : decodedSlots)
+        AddSlot(uiSlot);
+    }
+  }
+
+  static nsResult WriteSeriesCapture(nsStringView sPath, bool bBodySeries, SeriesTruth& out_truth)
+  {
+    nsOSFile file;
+    NS_SUCCEED_OR_RETURN(file.Open(sPath, nsFileOpenMode::Write));
+
+    JPHPVDFileManager manager;
+    manager.SetBodySeriesEnabled(bBodySeries);
+    manager.Open(file);
+
+    nsRandom rng;
+    rng.Initialize(19);
+
+    JPHBodySnapshot snapshot;
+    JPHFrameEncoder encoder;
+    JPHFrameDecoder decoder;
+    JPHBodySnapshot decoded;
+    nsDynamicArray<nsUInt32> decodedSlots;
+    nsDynamicArray<nsUInt32> slotBodyIDs;
+    nsDynamicArray<nsUInt8> frame;
+
+    const nsBitflags<JPHFrameContent> content = JPHFrameContent::State | JPHFrameContent::Position | JPHFrameContent::Rotation | JPHFrameContent::Velocity;
+    out_truth.Clear();
+
+    for (nsUInt32 uiStep = 0; uiStep < s_uiSeriesNumSteps; ++uiStep)
+    {
+      AdvanceSeriesScene(snapshot, uiStep, rng);
+
+      const nsUInt64 uiStepIndex = s_uiSeriesFirstStep + uiStep;
+      const bool bKeyframe = encoder.EncodeFrame(snapshot, content, frame);
+
+      manager.BeginFrame(uiStepIndex, bKeyframe);
+      manager.WriteEncodedFrame(frame);
+      manager.EndFrame();
+
+      NS_SUCCEED_OR_RETURN(decoder.DecodeFrame(frame, decoded, &decodedSlots));
+      AddExpectedSamples(decoded, decodedSlots, bKeyframe, uiStepIndex, slotBodyIDs, out_truth);
+    }
+
+    manager.Close();
+    return NS_SUCCESS;
+  }
+
+  static void TestSeriesMatch(const JPHPVDFileReader& reader, nsUInt32 uiBodyID, nsUInt64 uiFirstStep, nsUInt64 uiLastStep, nsArrayPtr<const JPHPVDBodySample> expectedSamples)
+  {
+    nsDynamicArray<JPHPVDBodySample> samples;
+    NS_TEST_BOOL(reader.ReadBodySeries(uiBodyID, uiFirstStep, uiLastStep, samples).Succeeded());
+
+    nsUInt32 uiNumExpected = 0;
+    bool bMatches = true;
+
+    for (const JPHPVDBodySample& expected : expectedSamples)
+    {
+      if (expected.m_uiStepIndex < uiFirstStep || expected.m_uiStepIndex > uiLastStep)
+        continue;
+
+      if (uiNumExpected < samples.GetCount())
+      {
+        const JPHPVDBodySample& sample = samples[uiNumExpected];
+        bMatches = bMatches && sample.m_uiStepIndex == expected.m_uiStepIndex && sample.m_uiState == expected.m_uiState;
+        bMatches = bMatches && sample.m_vPosition == expected.m_vPosition && sample.m_vLinearVelocity == expected.m_vLinearVelocity;
+        bMatches = bMatches && sample.m_vAngularVelocity == expected.m_vAngularVelocity;
+
+        // the series stores rotations smallest-three packed
+        bMatches = bMatches && (expected.m_uiState == 0 || sample.m_qRotation.IsEqualRotation(expected.m_qRotation, 0.01f));
+      }
+
+      ++uiNumExpected;
+    }
+
+    NS_TEST_INT(samples.GetCount(), uiNumExpected);
+    NS_TEST_BOOL(bMatches);
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, BodySeries)
+{
+  nsStringBuilder sFolder = nsTestFramework::GetInstance()->GetAbsOutputPath();
+  sFolder.MakeCleanPath();
+  sFolder.AppendPath("InspectorPlugin");
+
+  nsStringBuilder sCapture = sFolder;
+  sCapture.AppendPath("BodySeries.jdc");
+
+  nsStringBuilder sCorrupt = sFolder;
+  sCorrupt.AppendPath("BodySeries_Corrupt.jdc");
+
+  NS_TEST_BOOL(nsOSFile::CreateDirectoryStructure(sFolder).Succeeded());
+
+  SeriesTruth truth;
+  NS_TEST_BOOL(WriteSeriesCapture(sCapture, true, truth).Succeeded());
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Round Trip")
+  {
+    JPHPVDFileReader reader;
+    NS_TEST_BOOL(reader.Open(sCapture).Succeeded());
+    NS_TEST_BOOL(reader.HasBodySeries());
+    NS_TEST_INT(reader.GetNumFrames(), s_uiSeriesNumSteps);
+
+    // the scene reuses slots, removes bodies and shrinks, all of which add bodies beyond the initial ones
+    NS_TEST_BOOL(truth.GetCount() > s_uiSeriesNumSlots);
+
+    for (auto it : truth)
+    {
+      TestSeriesMatch(reader, it.Key(), 0, nsMath::MaxValue<nsUInt64>(), it.Value());
+    }
+
+    // ranges within and across the chunks of s_uiMaxStepsPerChunk steps
+    const nsUInt64 uiChunkBoundary = s_uiSeriesFirstStep + JPHBodySeriesWriter::s_uiMaxStepsPerChunk;
+
+    for (auto it : truth)
+    {
+      TestSeriesMatch(reader, it.Key(), s_uiSeriesFirstStep + 10, s_uiSeriesFirstStep + 20, it.Value());
+      TestSeriesMatch(reader, it.Key(), uiChunkBoundary - 50, uiChunkBoundary + 50, it.Value());
+      TestSeriesMatch(reader, it.Key(), uiChunkBoundary, uiChunkBoundary, it.Value());
+    }
+
+    // a body that never existed, and steps outside of the capture
+    nsDynamicArray<JPHPVDBodySample> samples;
+    NS_TEST_BOOL(reader.ReadBodySeries(s_uiSeriesNumSlots + 5, 0, nsMath::MaxValue<nsUInt64>(), samples).Succeeded());
+    NS_TEST_INT(samples.GetCount(), 0);
+    NS_TEST_BOOL(reader.ReadBodySeries(0, 0, s_uiSeriesFirstStep - 1, samples).Succeeded());
+    NS_TEST_INT(samples.GetCount(), 0);
+    NS_TEST_BOOL(reader.ReadBodySeries(0, s_uiSeriesFirstStep + s_uiSeriesNumSteps, nsMath::MaxValue<nsUInt64>(), samples).Succeeded());
+    NS_TEST_INT(samples.GetCount(), 0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Disabled")
+  {
+    SeriesTruth unused;
+    NS_TEST_BOOL(WriteSeriesCapture(sCorrupt, false, unused).Succeeded());
+
+    JPHPVDFileReader reader;
+    NS_TEST_BOOL(reader.Open(sCorrupt).Succeeded());
+    NS_TEST_BOOL(!reader.HasBodySeries());
+
+    nsDynamicArray<JPHPVDBodySample> samples;
+    NS_TEST_BOOL(reader.ReadBodySeries(0, 0, nsMath::MaxValue<nsUInt64>(), samples).Failed());
+  }
+
+  nsDynamicArray<nsUInt8> fileData;
+  {
+    nsOSFile file;
+    NS_TEST_BOOL(file.Open(sCapture, nsFileOpenMode::Read).Succeeded());
+    fileData.SetCountUninitialized(static_cast<nsUInt32>(file.GetFileSize()));
+    NS_TEST_INT(file.Read(fileData.GetData(), fileData.GetCount()), fileData.GetCount());
+  }
+
+  auto OpenCorrupt = [&](const nsDynamicArray<nsUInt8>& data, JPHPVDFileReader& ref_reader) -> nsResult
+  {
+    {
+      nsOSFile file;
+      NS_SUCCEED_OR_RETURN(file.Open(sCorrupt, nsFileOpenMode::Write));
+      NS_SUCCEED_OR_RETURN(file.Write(data.GetData(), data.GetCount()));
+    }
+
+    return ref_reader.Open(sCorrupt);
+  };
+
+  // the series table closes the data of the index chunk: u32 count, then per chunk u64 first step, u64 last step, u64 chunk offset,
+  // u32 first body index and u32 body index count
+  JPHPVDFileFooter footer;
+  nsMemoryUtils::RawByteCopy(&footer, fileData.GetData() + fileData.GetCount() - sizeof(footer), sizeof(footer));
+
+  const nsUInt32 uiIndexDataSizeOffset = static_cast<nsUInt32>(footer.m_uiIndexChunkOffset) + 8 + 4 + 7 + 4;
+  nsUInt32 uiIndexDataSize = 0;
+  nsMemoryUtils::RawByteCopy(&uiIndexDataSize, fileData.GetData() + uiIndexDataSizeOffset, sizeof(nsUInt32));
+
+  constexpr nsUInt32 uiNumSeriesChunks = (s_uiSeriesNumSteps + JPHBodySeriesWriter::s_uiMaxStepsPerChunk - 1) / JPHBodySeriesWriter::s_uiMaxStepsPerChunk;
+  const nsUInt32 uiIndexDataEnd = uiIndexDataSizeOffset + 4 + uiIndexDataSize;
+  const nsUInt32 uiLastEntryOffset = uiIndexDataEnd - 32;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt Series Table")
+  {
+    nsUInt32 uiNumChunks = 0;
+    nsMemoryUtils::RawByteCopy(&uiNumChunks, fileData.GetData() + uiIndexDataEnd - uiNumSeriesChunks * 32 - 4, sizeof(nsUInt32));
+    NS_TEST_INT(uiNumChunks, uiNumSeriesChunks);
+
+    auto OpenWithValue = [&](nsUInt32 uiOffset, auto value) -> nsResult
+    {
+      nsDynamicArray<nsUInt8> data = fileData;
+      nsMemoryUtils::RawByteCopy(data.GetData() + uiOffset, &value, sizeof(value));
+
+      JPHPVDFileReader reader;
+      return OpenCorrupt(data, reader);
+    };
+
+    // the unchanged file opens
+    NS_TEST_BOOL(OpenWithValue(uiLastEntryOffset, s_uiSeriesFirstStep + 2 * JPHBodySeriesWriter::s_uiMaxStepsPerChunk).Succeeded());
+
+    // the last step before the first one
+    NS_TEST_BOOL(OpenWithValue(uiLastEntryOffset + 8, s_uiSeriesFirstStep).Failed());
+
+    // chunks beyond the end of the file
+    NS_TEST_BOOL(OpenWithValue(uiLastEntryOffset + 16, static_cast<nsUInt64>(fileData.GetCount())).Failed());
+    NS_TEST_BOOL(OpenWithValue(uiLastEntryOffset + 16, static_cast<nsUInt64>(fileData.GetCount() - 20)).Failed());
+    NS_TEST_BOOL(OpenWithValue(uiLastEntryOffset + 16, 0xFFFFFFFFFFFFFFF0ull).Failed());
+
+    // more body indices than a body ID can address
+    NS_TEST_BOOL(OpenWithValue(uiLastEntryOffset + 24, JPH::BodyID::cMaxBodyIndex).Failed());
+    NS_TEST_BOOL(OpenWithValue(uiLastEntryOffset + 28, 0xFFFFFFFFu).Failed());
+
+    // more chunks than the table holds
+    NS_TEST_BOOL(OpenWithValue(uiIndexDataEnd - uiNumSeriesChunks * 32 - 4, 0x10000000u).Failed());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt Directory")
+  {
+    nsUInt64 uiChunkOffset = 0;
+    nsUInt32 uiFirstBodyIndex = 0;
+    nsMemoryUtils::RawByteCopy(&uiChunkOffset, fileData.GetData() + uiLastEntryOffset + 16, sizeof(nsUInt64));
+    nsMemoryUtils::RawByteCopy(&uiFirstBodyIndex, fileData.GetData() + uiLastEntryOffset + 24, sizeof(nsUInt32));
+
+    // a body that has samples in the last chunk
+    const nsUInt32 uiBodyID = 3;
+    const nsUInt32 uiEntryOffset = static_cast<nsUInt32>(uiChunkOffset) + JPHBodySeriesWriter::s_uiChunkPrefixSize + JPHBodySeriesWriter::s_uiChunkHeaderSize + (uiBodyID - uiFirstBodyIndex) * sizeof(nsUInt32);
+
+    nsUInt32 uiRange[2] = {};
+    nsMemoryUtils::RawByteCopy(uiRange, fileData.GetData() + uiEntryOffset, sizeof(uiRange));
+    NS_TEST_BOOL(uiRange[0] < uiRange[1]);
+
+    auto ReadWithRange = [&](nsUInt32 uiFirst, nsUInt32 uiEnd) -> nsResult
+    {
+      nsDynamicArray<nsUInt8> data = fileData;
+      const nsUInt32 corruptRange[2] = {uiFirst, uiEnd};
+      nsMemoryUtils::RawByteCopy(data.GetData() + uiEntryOffset, corruptRange, sizeof(corruptRange));
+
+      JPHPVDFileReader reader;
+      NS_SUCCEED_OR_RETURN(OpenCorrupt(data, reader));
+
+      nsDynamicArray<JPHPVDBodySample> samples;
+      return reader.ReadBodySeries(uiBodyID, 0, nsMath::MaxValue<nsUInt64>(), samples);
+    };
+
+    NS_TEST_BOOL(ReadWithRange(uiRange[0], uiRange[1]).Succeeded());
+    NS_TEST_BOOL(ReadWithRange(uiRange[1], uiRange[0]).Failed());
+    NS_TEST_BOOL(ReadWithRange(uiRange[0], 0xFFFFFFFFu).Failed());
+    NS_TEST_BOOL(ReadWithRange(uiRange[0], fileData.GetCount() / JPHBodySeriesWriter::s_uiSampleSize).Failed());
+  }
+
+  nsOSFile::DeleteFile(sCorrupt).IgnoreResult();
+}
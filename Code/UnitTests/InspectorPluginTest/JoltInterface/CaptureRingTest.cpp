@@ -0,0 +1,236 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <Foundation/Threading/Thread.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHCaptureRing.h>
+
+namespace
+{
+  using namespace JDebug::API::IO;
+
+  static constexpr nsUInt64 s_uiNumRaceFrames = 20000;
+
+  static void MakeRingFrame(nsUInt64 uiSequence, JPHCaptureFrame& out_frame)
+  {
+    // the buffer is recycled, so every byte has to be written
+    out_frame.m_Data.SetCountUninitialized(static_cast<nsUInt32>(uiSequence % 16) + 1);
+    for (nsUInt8& ref_uiValue : out_frame.m_Data)
+    {
+      ref_uiValue = static_cast<nsUInt8>(uiSequence);
+    }
+
+    out_frame.m_uiStepIndex = uiSequence * 2;
+    out_frame.m_uiSequence = uiSequence;
+    out_frame.m_bKeyframe = (uiSequence % 4) == 0;
+  }
+
+  static bool IsRingFrame(nsUInt64 uiSequence, const JPHCaptureFrame& frame)
+  {
+    if (frame.m_uiSequence != uiSequence || frame.m_uiStepIndex != uiSequence * 2 || frame.m_bKeyframe != ((uiSequence % 4) == 0))
+      return false;
+
+    if (frame.m_Data.GetCount() != static_cast<nsUInt32>(uiSequence % 16) + 1)
+      return false;
+
+    for (nsUInt8 uiValue : frame.m_Data)
+    {
+      if (uiValue != static_cast<nsUInt8>(uiSequence))
+        return false;
+    }
+
+    return true;
+  }
+
+  /// Plays the writer thread, pops until the producer is done and the ring is empty.
+  class RingConsumerThread : public nsThread
+  {
+  public:
+    RingConsumerThread(JPHCaptureRing& ref_ring)
+      : nsThread("Capture Ring Consumer")
+      , m_Ring(ref_ring)
+    {
+    }
+
+    virtual nsUInt32 Run() override
+    {
+      JPHCaptureFrame frame;
+
+      while (true)
+      {
+        if (m_Ring.TryPop(frame))
+        {
+          m_Sequences.PushBack(frame.m_uiSequence);
+          m_uiNumCorrupt += IsRingFrame(frame.m_uiSequence, frame) ? 0 : 1;
+        }
+        else if (m_bProducerDone)
+        {
+          if (m_Ring.GetCount() == 0)
+            return 0;
+        }
+        else
+        {
+          nsThreadUtils::YieldTimeSlice();
+        }
+      }
+    }
+
+    JPHCaptureRing& m_Ring;
+    nsAtomicBool m_bProducerDone;
+    nsDynamicArray<nsUInt64> m_Sequences;
+    nsUInt32 m_uiNumCorrupt = 0;
+  };
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, CaptureRing)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Capacity")
+  {
+    JPHCaptureRing ring1(1);
+    NS_TEST_INT(ring1.GetCapacity(), 2);
+
+    JPHCaptureRing ring5(5);
+    NS_TEST_INT(ring5.GetCapacity(), 8);
+
+    JPHCaptureRing ring8(8);
+    NS_TEST_INT(ring8.GetCapacity(), 8);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Empty and Full")
+  {
+    JPHCaptureRing ring(4);
+    JPHCaptureFrame frame;
+
+    NS_TEST_INT(ring.GetCount(), 0);
+    NS_TEST_BOOL(!ring.TryPop(frame));
+
+    for (nsUInt64 i = 0; i < 4; ++i)
+    {
+      MakeRingFrame(i, frame);
+      NS_TEST_BOOL(ring.TryPush(frame));
+
+      // every slot is new, so the caller gets an empty buffer back
+      NS_TEST_BOOL(frame.m_Data.IsEmpty());
+    }
+
+    NS_TEST_INT(ring.GetCount(), 4);
+
+    // a failed push leaves the frame untouched
+    MakeRingFrame(4, frame);
+    NS_TEST_BOOL(!ring.TryPush(frame));
+    NS_TEST_BOOL(IsRingFrame(4, frame));
+    NS_TEST_INT(ring.GetCount(), 4);
+
+    for (nsUInt64 i = 0; i < 4; ++i)
+    {
+      NS_TEST_BOOL(ring.TryPop(frame));
+      NS_TEST_BOOL(IsRingFrame(i, frame));
+    }
+
+    NS_TEST_INT(ring.GetCount(), 0);
+    NS_TEST_BOOL(!ring.TryPop(frame));
+
+    // once drained, the ring accepts frames again
+    MakeRingFrame(5, frame);
+    NS_TEST_BOOL(ring.TryPush(frame));
+    NS_TEST_INT(ring.GetCount(), 1);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Wraparound")
+  {
+    JPHCaptureRing ring(4);
+    JPHCaptureFrame pushFrame;
+    JPHCaptureFrame popFrame;
+
+    nsUInt64 uiNextPush = 0;
+    nsUInt64 uiNextPop = 0;
+    bool bInOrder = true;
+
+    // push three, pop two, so the positions wrap around the cells many times at varying fill levels
+    for (nsUInt32 uiRound = 0; uiRound < 100; ++uiRound)
+    {
+      for (nsUInt32 i = 0; i < 3; ++i)
+      {
+        MakeRingFrame(uiNextPush, pushFrame);
+
+        if (!ring.TryPush(pushFrame))
+        {
+          NS_TEST_INT(ring.GetCount(), 4);
+          break;
+        }
+
+        ++uiNextPush;
+      }
+
+      for (nsUInt32 i = 0; i < 2; ++i)
+      {
+        NS_TEST_BOOL(ring.TryPop(popFrame));
+        bInOrder &= IsRingFrame(uiNextPop++, popFrame);
+      }
+    }
+
+    while (ring.TryPop(popFrame))
+    {
+      bInOrder &= IsRingFrame(uiNextPop++, popFrame);
+    }
+
+    NS_TEST_BOOL(bInOrder);
+    NS_TEST_INT(uiNextPop, uiNextPush);
+    NS_TEST_BOOL(uiNextPush > 4 * ring.GetCapacity());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Producer Drops Oldest")
+  {
+    // the capture writer pops on its thread, while the producer pops the oldest frame itself whenever the ring is full
+    JPHCaptureRing ring(4);
+    RingConsumerThread consumer(ring);
+    consumer.Start();
+
+    nsDynamicArray<nsUInt64> dropped;
+    nsUInt32 uiNumCorrupt = 0;
+    JPHCaptureFrame pushFrame;
+    JPHCaptureFrame dropFrame;
+
+    for (nsUInt64 i = 0; i < s_uiNumRaceFrames; ++i)
+    {
+      MakeRingFrame(i, pushFrame);
+
+      while (!ring.TryPush(pushFrame))
+      {
+        if (ring.TryPop(dropFrame))
+        {
+          dropped.PushBack(dropFrame.m_uiSequence);
+          uiNumCorrupt += IsRingFrame(dropFrame.m_uiSequence, dropFrame) ? 0 : 1;
+        }
+      }
+    }
+
+    consumer.m_bProducerDone = true;
+    consumer.Join();
+
+    NS_TEST_INT(uiNumCorrupt + consumer.m_uiNumCorrupt, 0);
+    NS_TEST_INT(dropped.GetCount() + consumer.m_Sequences.GetCount(), s_uiNumRaceFrames);
+
+    // each consumer sees the frames in order, and between them every frame was taken exactly once
+    nsDynamicArray<nsUInt8> seen;
+    seen.SetCount(static_cast<nsUInt32>(s_uiNumRaceFrames), 0);
+    bool bInOrder = true;
+
+    for (const nsDynamicArray<nsUInt64>* pSequences : {&dropped, &consumer.m_Sequences})
+    {
+      for (nsUInt32 i = 0; i < pSequences->GetCount(); ++i)
+      {
+        bInOrder &= (i == 0) || (*pSequences)[i - 1] < (*pSequences)[i];
+        ++seen[static_cast<nsUInt32>((*pSequences)[i])];
+      }
+    }
+
+    NS_TEST_BOOL(bInOrder);
+
+    nsUInt32 uiNumNotOnce = 0;
+    for (nsUInt8 uiCount : seen)
+    {
+      uiNumNotOnce += uiCount == 1 ? 0 : 1;
+    }
+
+    NS_TEST_INT(uiNumNotOnce, 0);
+  }
+}
@@ -0,0 +1,169 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Math/Random.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileManager.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileReader.h>
+#include <InspectorPlugin/JoltInterface/JPHCaptureWriter.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  /// What the producer did during one capture.
+  struct CaptureRun
+  {
+    nsUInt32 m_uiNumPushed = 0;
+    nsUInt32 m_uiNumRejected = 0; ///< Pushes that returned false.
+    nsUInt32 m_uiNumDropped = 0;  ///< As reported by the writer.
+  };
+
+  /// Pushes frames as fast as possible. Every frame is a keyframe if its step is a multiple of uiKeyframeInterval.
+  /// The producer ignores failed pushes on purpose, recovering from the gaps is left to the writer.
+  static nsResult RunCapture(nsStringView sPath, JPHCaptureBackpressure eBackpressure, nsUInt64 uiFirstStep, nsUInt32 uiNumFrames,
+    nsUInt32 uiKeyframeInterval, nsArrayPtr<const nsUInt8> frameData, CaptureRun& out_run)
+  {
+    nsOSFile file;
+    NS_SUCCEED_OR_RETURN(file.Open(sPath, nsFileOpenMode::Write));
+
+    IO::JPHPVDFileManager sink(file);
+
+    JPHCaptureWriterSettings settings;
+    settings.m_uiQueueCapacity = 2;
+    settings.m_eBackpressure = eBackpressure;
+
+    JPHCaptureWriter writer;
+    writer.Start(sink, settings);
+
+    out_run = CaptureRun();
+    nsDynamicArray<nsUInt8> data;
+
+    for (nsUInt64 uiStep = uiFirstStep; uiStep < uiFirstStep + uiNumFrames; ++uiStep)
+    {
+      data = frameData;
+
+      ++out_run.m_uiNumPushed;
+      if (!writer.Push(data, uiStep, (uiStep % uiKeyframeInterval) == 0))
+      {
+        ++out_run.m_uiNumRejected;
+      }
+    }
+
+    writer.Stop();
+    out_run.m_uiNumDropped = writer.GetNumDroppedFrames();
+
+    sink.Close();
+    file.Close();
+    return NS_SUCCESS;
+  }
+
+  /// Checks that the capture starts with a keyframe and that every delta frame directly follows the frame before it.
+  static bool IsDecodableCapture(const IO::JPHPVDFileReader& reader)
+  {
+    for (nsUInt32 uiFrame = 0; uiFrame < reader.GetNumFrames(); ++uiFrame)
+    {
+      const IO::JPHPVDFrameIndexEntry& frame = reader.GetFrameInfo(uiFrame);
+
+      if ((frame.m_uiFlags & IO::PVDFrame_Keyframe) != 0)
+        continue;
+
+      if (uiFrame == 0 || frame.m_uiStepIndex != reader.GetFrameInfo(uiFrame - 1).m_uiStepIndex + 1)
+        return false;
+    }
+
+    return true;
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, CaptureWriter)
+{
+  nsStringBuilder sCapture = nsTestFramework::GetInstance()->GetAbsOutputPath();
+  sCapture.MakeCleanPath();
+  sCapture.AppendPath("InspectorPlugin");
+  NS_TEST_BOOL(nsOSFile::CreateDirectoryStructure(sCapture).Succeeded());
+  sCapture.AppendPath("CaptureWriter.jdc");
+
+  // incompressible, so writing a frame takes much longer than pushing it and the ring overflows
+  nsDynamicArray<nsUInt8> largeFrame;
+  {
+    nsRandom random;
+    random.Initialize(42);
+
+    largeFrame.SetCountUninitialized(256 * 1024);
+    for (nsUInt8& ref_uiValue : largeFrame)
+    {
+      ref_uiValue = static_cast<nsUInt8>(random.UInt());
+    }
+  }
+
+  nsDynamicArray<nsUInt8> smallFrame;
+  smallFrame.SetCount(64, 7);
+
+  CaptureRun run;
+  IO::JPHPVDFileReader reader;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Wait For First Keyframe")
+  {
+    // steps 0 to 4 are delta frames, the capture has to start at the keyframe of step 5
+    NS_TEST_BOOL(RunCapture(sCapture, JPHCaptureBackpressure::Stall, 1, 12, 5, smallFrame, run).Succeeded());
+
+    NS_TEST_INT(run.m_uiNumRejected, 0);
+    NS_TEST_INT(run.m_uiNumDropped, 4);
+
+    NS_TEST_BOOL(reader.Open(sCapture).Succeeded());
+    NS_TEST_INT(reader.GetNumFrames(), 8);
+    NS_TEST_INT(reader.GetFrameInfo(0).m_uiStepIndex, 5);
+    NS_TEST_BOOL(IsDecodableCapture(reader));
+    reader.Close();
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Stall")
+  {
+    NS_TEST_BOOL(RunCapture(sCapture, JPHCaptureBackpressure::Stall, 0, 64, 16, largeFrame, run).Succeeded());
+
+    // nothing is lost, the producer waits instead
+    NS_TEST_INT(run.m_uiNumRejected, 0);
+    NS_TEST_INT(run.m_uiNumDropped, 0);
+
+    NS_TEST_BOOL(reader.Open(sCapture).Succeeded());
+    NS_TEST_INT(reader.GetNumFrames(), 64);
+    NS_TEST_BOOL(IsDecodableCapture(reader));
+
+    nsDynamicArray<nsUInt8> payload;
+    nsDynamicArray<IO::JPHPVDFileReader::Record> records;
+    NS_TEST_BOOL(reader.ReadFrame(63, payload).Succeeded());
+    NS_TEST_BOOL(IO::JPHPVDFileReader::GetRecords(payload, records).Succeeded());
+    NS_TEST_INT(records.GetCount(), 1);
+    NS_TEST_BOOL(records[0].m_Data == largeFrame.GetArrayPtr());
+    reader.Close();
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Drop Newest")
+  {
+    NS_TEST_BOOL(RunCapture(sCapture, JPHCaptureBackpressure::DropNewest, 0, 200, 16, largeFrame, run).Succeeded());
+
+    // the writer also drops the delta frames after a gap, which the producer does not notice
+    NS_TEST_BOOL(run.m_uiNumRejected > 0);
+    NS_TEST_BOOL(run.m_uiNumDropped >= run.m_uiNumRejected);
+
+    NS_TEST_BOOL(reader.Open(sCapture).Succeeded());
+    NS_TEST_INT(reader.GetNumFrames() + run.m_uiNumDropped, run.m_uiNumPushed);
+    NS_TEST_BOOL(IsDecodableCapture(reader));
+    reader.Close();
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Drop Oldest")
+  {
+    NS_TEST_BOOL(RunCapture(sCapture, JPHCaptureBackpressure::DropOldest, 0, 200, 16, largeFrame, run).Succeeded());
+
+    // the producer takes queued frames out itself, the writer only sees the gaps in the sequence
+    NS_TEST_BOOL(run.m_uiNumRejected > 0);
+    NS_TEST_BOOL(run.m_uiNumDropped >= run.m_uiNumRejected);
+
+    NS_TEST_BOOL(reader.Open(sCapture).Succeeded());
+    NS_TEST_INT(reader.GetNumFrames() + run.m_uiNumDropped, run.m_uiNumPushed);
+    NS_TEST_BOOL(IsDecodableCapture(reader));
+    reader.Close();
+  }
+}
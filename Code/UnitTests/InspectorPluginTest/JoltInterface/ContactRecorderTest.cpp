@@ -0,0 +1,165 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHContactRecorder.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  static void MakeContacts(nsUInt32 uiNumContacts, nsRandom& ref_rng, nsDynamicArray<JPHContactRecord>& out_contacts)
+  {
+    out_contacts.SetCount(uiNumContacts);
+
+    for (nsUInt32 i = 0; i < uiNumContacts; ++i)
+    {
+      JPHContactRecord& contact = out_contacts[i];
+      contact.m_uiBodyID1 = ref_rng.UInt();
+      contact.m_uiBodyID2 = ref_rng.UInt();
+      contact.m_uiSubShapeID1 = ref_rng.UInt();
+      contact.m_uiSubShapeID2 = ref_rng.UInt();
+      contact.m_eEvent = static_cast<JPHContactEvent>(i % 3);
+      contact.m_uiFlags = static_cast<nsUInt8>(ref_rng.UIntInRange(4));
+
+      if (contact.m_eEvent == JPHContactEvent::Removed)
+        continue;
+
+      contact.m_vNormal.Set(ref_rng.FloatMinMax(-1, 1), ref_rng.FloatMinMax(-1, 1), ref_rng.FloatMinMax(-1, 1));
+      contact.m_fPenetration = ref_rng.FloatMinMax(-0.01f, 0.1f);
+      contact.m_fImpulse = ref_rng.FloatMinMax(0.0f, 100.0f);
+      contact.m_uiNumPoints = static_cast<nsUInt8>(i % (JPHContactRecord::s_uiMaxPoints + 1));
+
+      for (nsUInt32 uiPoint = 0; uiPoint < contact.m_uiNumPoints; ++uiPoint)
+      {
+        contact.m_vPoints[uiPoint].Set(ref_rng.FloatMinMax(-100, 100), ref_rng.FloatMinMax(-100, 100), ref_rng.FloatMinMax(-100, 100));
+      }
+    }
+  }
+
+  static void TestContactsMatch(const JPHContactRecord& expected, const JPHContactRecord& decoded)
+  {
+    NS_TEST_INT(decoded.m_uiBodyID1, expected.m_uiBodyID1);
+    NS_TEST_INT(decoded.m_uiBodyID2, expected.m_uiBodyID2);
+    NS_TEST_INT(decoded.m_uiSubShapeID1, expected.m_uiSubShapeID1);
+    NS_TEST_INT(decoded.m_uiSubShapeID2, expected.m_uiSubShapeID2);
+    NS_TEST_BOOL(decoded.m_eEvent == expected.m_eEvent);
+    NS_TEST_INT(decoded.m_uiFlags, expected.m_uiFlags);
+
+    if (expected.m_eEvent == JPHContactEvent::Removed)
+    {
+      // only the IDs are known for removed contacts
+      NS_TEST_INT(decoded.m_uiNumPoints, 0);
+      NS_TEST_BOOL(decoded.m_vNormal.IsZero());
+      return;
+    }
+
+    // floats are stored as is
+    NS_TEST_BOOL(decoded.m_vNormal == expected.m_vNormal);
+    NS_TEST_BOOL(decoded.m_fPenetration == expected.m_fPenetration);
+    NS_TEST_BOOL(decoded.m_fImpulse == expected.m_fImpulse);
+    NS_TEST_INT(decoded.m_uiNumPoints, expected.m_uiNumPoints);
+
+    for (nsUInt32 uiPoint = 0; uiPoint < nsMath::Min<nsUInt32>(decoded.m_uiNumPoints, expected.m_uiNumPoints); ++uiPoint)
+    {
+      NS_TEST_BOOL(decoded.m_vPoints[uiPoint] == expected.m_vPoints[uiPoint]);
+    }
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, ContactRecorder)
+{
+  nsRandom rng;
+  rng.Initialize(8);
+
+  nsDynamicArray<JPHContactRecord> contacts;
+  MakeContacts(100, rng, contacts);
+
+  nsDynamicArray<nsUInt8> data;
+  JPHContactRecorder::WriteContacts(contacts, 17, data);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Round Trip")
+  {
+    nsDynamicArray<JPHContactRecord> decoded;
+    nsUInt32 uiNumDropped = 0;
+    NS_TEST_BOOL(JPHContactRecorder::ReadContacts(data, decoded, uiNumDropped).Succeeded());
+    NS_TEST_INT(uiNumDropped, 17);
+    NS_TEST_INT(decoded.GetCount(), contacts.GetCount());
+
+    for (nsUInt32 i = 0; i < nsMath::Min(decoded.GetCount(), contacts.GetCount()); ++i)
+    {
+      TestContactsMatch(contacts[i], decoded[i]);
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Empty")
+  {
+    nsDynamicArray<nsUInt8> emptyData;
+    JPHContactRecorder::WriteContacts(nsArrayPtr<const JPHContactRecord>(), 3, emptyData);
+    NS_TEST_INT(emptyData.GetCount(), 8);
+
+    nsDynamicArray<JPHContactRecord> decoded;
+    decoded.SetCount(5);
+    nsUInt32 uiNumDropped = 0;
+    NS_TEST_BOOL(JPHContactRecorder::ReadContacts(emptyData, decoded, uiNumDropped).Succeeded());
+    NS_TEST_INT(decoded.GetCount(), 0);
+    NS_TEST_INT(uiNumDropped, 3);
+
+    // the existing content is replaced
+    JPHContactRecorder::WriteContacts(contacts, 0, emptyData);
+    JPHContactRecorder::WriteContacts(nsArrayPtr<const JPHContactRecord>(), 0, emptyData);
+    NS_TEST_INT(emptyData.GetCount(), 8);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Truncated")
+  {
+    nsDynamicArray<JPHContactRecord> decoded;
+    nsUInt32 uiNumDropped = 0;
+
+    for (nsUInt32 uiSize = 0; uiSize < data.GetCount(); ++uiSize)
+    {
+      NS_TEST_BOOL(JPHContactRecorder::ReadContacts(data.GetArrayPtr().GetSubArray(0, uiSize), decoded, uiNumDropped).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt")
+  {
+    nsDynamicArray<JPHContactRecord> decoded;
+    nsUInt32 uiNumDropped = 0;
+
+    // header (u32 count, u32 dropped), then the first contact: 4 IDs, event, flags, point count
+    constexpr nsUInt32 uiEventOffset = 8 + 16;
+    constexpr nsUInt32 uiNumPointsOffset = uiEventOffset + 2;
+
+    nsDynamicArray<nsUInt8> corrupt = data;
+    corrupt[uiEventOffset] = static_cast<nsUInt8>(JPHContactEvent::Removed) + 1;
+    NS_TEST_BOOL(JPHContactRecorder::ReadContacts(corrupt, decoded, uiNumDropped).Failed());
+
+    corrupt = data;
+    corrupt[uiNumPointsOffset] = JPHContactRecord::s_uiMaxPoints + 1;
+    NS_TEST_BOOL(JPHContactRecorder::ReadContacts(corrupt, decoded, uiNumDropped).Failed());
+
+    corrupt = data;
+    corrupt[uiNumPointsOffset] = 0xFF;
+    NS_TEST_BOOL(JPHContactRecorder::ReadContacts(corrupt, decoded, uiNumDropped).Failed());
+
+    // more contacts than the data holds
+    const nsUInt32 uiHugeCount = 0xFFFFFFFFu;
+    corrupt = data;
+    nsMemoryUtils::RawByteCopy(corrupt.GetData(), &uiHugeCount, sizeof(nsUInt32));
+    NS_TEST_BOOL(JPHContactRecorder::ReadContacts(corrupt, decoded, uiNumDropped).Failed());
+
+    for (nsUInt32 i = 0; i < 500; ++i)
+    {
+      corrupt = data;
+      corrupt[rng.UIntInRange(corrupt.GetCount())] ^= static_cast<nsUInt8>(1u << rng.UIntInRange(8));
+
+      if (JPHContactRecorder::ReadContacts(corrupt, decoded, uiNumDropped).Succeeded())
+      {
+        bool bValid = true;
+        for (const JPHContactRecord& contact : decoded)
+          bValid &= contact.m_uiNumPoints <= JPHContactRecord::s_uiMaxPoints && contact.m_eEvent <= JPHContactEvent::Removed;
+
+        NS_TEST_BOOL(bValid);
+      }
+    }
+  }
+}
@@ -0,0 +1,256 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileReader.h>
+#include <InspectorPlugin/JoltInterface/JPHFlightRecorder.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  /// Records a frame whose bytes all hold the step, so a dump shows whether frames overwrote each other.
+  static void RecordStep(JPHFlightRecorder& ref_recorder, nsUInt64 uiStep, nsUInt32 uiSize, bool bKeyframe)
+  {
+    nsDynamicArray<nsUInt8> data;
+    data.SetCount(uiSize, static_cast<nsUInt8>(uiStep));
+
+    ref_recorder.Record(data, nsArrayPtr<const nsUInt8>(), uiStep, bKeyframe);
+  }
+
+  /// Dumps the ring into an empty folder and opens the dump.
+  static nsResult DumpAndOpen(JPHFlightRecorder& ref_recorder, IO::JPHPVDFileReader& out_reader)
+  {
+    const nsString& sFolder = ref_recorder.GetSettings().m_sDumpDirectory;
+    out_reader.Close();
+    nsOSFile::DeleteFolder(sFolder).IgnoreResult();
+
+    ref_recorder.TriggerDump();
+    ref_recorder.Update();
+    ref_recorder.WaitForDump();
+
+    nsFileSystemIterator it;
+    it.StartSearch(sFolder, nsFileSystemIteratorFlags::ReportFiles);
+
+    if (!it.IsValid())
+      return NS_FAILURE;
+
+    nsStringBuilder sPath = it.GetCurrentPath();
+    sPath.AppendPath(it.GetStats().m_sName);
+    return out_reader.Open(sPath);
+  }
+
+  /// Checks that the dump holds the given steps and that every frame still has the content it was recorded with.
+  static bool IsDumpOfSteps(const IO::JPHPVDFileReader& reader, nsArrayPtr<const nsUInt64> steps)
+  {
+    if (reader.GetNumFrames() != steps.GetCount())
+      return false;
+
+    nsDynamicArray<nsUInt8> payload;
+    nsDynamicArray<IO::JPHPVDFileReader::Record> records;
+
+    for (nsUInt32 uiFrame = 0; uiFrame < reader.GetNumFrames(); ++uiFrame)
+    {
+      if (reader.GetFrameInfo(uiFrame).m_uiStepIndex != steps[uiFrame])
+        return false;
+
+      if (reader.ReadFrame(uiFrame, payload).Failed() || IO::JPHPVDFileReader::GetRecords(payload, records).Failed() || records.IsEmpty())
+        return false;
+
+      for (nsUInt8 uiValue : records[0].m_Data)
+      {
+        if (uiValue != static_cast<nsUInt8>(steps[uiFrame]))
+          return false;
+      }
+    }
+
+    return true;
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, FlightRecorder)
+{
+  nsStringBuilder sFolder = nsTestFramework::GetInstance()->GetAbsOutputPath();
+  sFolder.MakeCleanPath();
+  sFolder.AppendPath("InspectorPlugin", "FlightRecorder");
+
+  JPHFlightRecorderSettings settings;
+  settings.m_sDumpDirectory = sFolder;
+  settings.m_uiMemoryBudget = 1000;
+  settings.m_uiMaxFrames = 16;
+  settings.m_bDumpOnAssert = false;
+
+  IO::JPHPVDFileReader reader;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Wraparound")
+  {
+    JPHFlightRecorder recorder;
+    recorder.SetSettings(settings);
+
+    RecordStep(recorder, 0, 300, true);
+    RecordStep(recorder, 1, 300, true);
+    RecordStep(recorder, 2, 300, true);
+    NS_TEST_INT(recorder.GetNumFrames(), 3);
+
+    // does not fit behind step 2, starts over at the beginning of the buffer where step 0 has to make room
+    RecordStep(recorder, 3, 300, true);
+    NS_TEST_INT(recorder.GetNumFrames(), 3);
+
+    // fits behind step 3, where step 1 has to make room
+    RecordStep(recorder, 4, 200, true);
+    NS_TEST_INT(recorder.GetNumFrames(), 3);
+
+    // only 100 bytes are left between step 4 and step 2, so step 2 has to make room as well
+    RecordStep(recorder, 5, 150, true);
+    NS_TEST_INT(recorder.GetNumFrames(), 3);
+
+    NS_TEST_BOOL(DumpAndOpen(recorder, reader).Succeeded());
+
+    const nsUInt64 steps[] = {3, 4, 5};
+    NS_TEST_BOOL(IsDumpOfSteps(reader, steps));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Max Frames")
+  {
+    JPHFlightRecorderSettings smallSettings = settings;
+    smallSettings.m_uiMaxFrames = 4;
+
+    JPHFlightRecorder recorder;
+    recorder.SetSettings(smallSettings);
+
+    for (nsUInt64 uiStep = 0; uiStep < 10; ++uiStep)
+    {
+      RecordStep(recorder, uiStep, 10, true);
+      NS_TEST_INT(recorder.GetNumFrames(), nsMath::Min<nsUInt32>(static_cast<nsUInt32>(uiStep) + 1, 4));
+    }
+
+    NS_TEST_BOOL(DumpAndOpen(recorder, reader).Succeeded());
+
+    const nsUInt64 steps[] = {6, 7, 8, 9};
+    NS_TEST_BOOL(IsDumpOfSteps(reader, steps));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Drop Until Keyframe")
+  {
+    JPHFlightRecorder recorder;
+    recorder.SetSettings(settings);
+
+    // a delta frame without a keyframe before it is useless
+    RecordStep(recorder, 0, 250, false);
+    NS_TEST_INT(recorder.GetNumFrames(), 0);
+    NS_TEST_BOOL(recorder.IsKeyframeNeeded());
+
+    RecordStep(recorder, 1, 250, true);
+    RecordStep(recorder, 2, 250, false);
+    RecordStep(recorder, 3, 250, false);
+    RecordStep(recorder, 4, 250, true);
+    NS_TEST_INT(recorder.GetNumFrames(), 4);
+
+    // the keyframe of step 1 makes room, the delta frames that build on it go as well
+    RecordStep(recorder, 5, 250, false);
+    NS_TEST_INT(recorder.GetNumFrames(), 2);
+    NS_TEST_BOOL(!recorder.IsKeyframeNeeded());
+
+    NS_TEST_BOOL(DumpAndOpen(recorder, reader).Succeeded());
+
+    const nsUInt64 steps[] = {4, 5};
+    NS_TEST_BOOL(IsDumpOfSteps(reader, steps));
+    NS_TEST_BOOL((reader.GetFrameInfo(0).m_uiFlags & IO::PVDFrame_Keyframe) != 0);
+
+    // the dump cleared the ring, when the only keyframe makes room for a delta frame, nothing is left
+    RecordStep(recorder, 6, 600, true);
+    RecordStep(recorder, 7, 300, false);
+    RecordStep(recorder, 8, 300, false);
+    NS_TEST_INT(recorder.GetNumFrames(), 0);
+    NS_TEST_BOOL(recorder.IsKeyframeNeeded());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Oversize Frame")
+  {
+    JPHFlightRecorder recorder;
+    recorder.SetSettings(settings);
+
+    RecordStep(recorder, 0, 100, true);
+    RecordStep(recorder, 1, 100, false);
+    NS_TEST_INT(recorder.GetNumFrames(), 2);
+
+    // the frame cannot be stored, and the frames after it cannot be decoded without it
+    RecordStep(recorder, 2, 1001, true);
+    NS_TEST_INT(recorder.GetNumFrames(), 0);
+    NS_TEST_BOOL(recorder.IsKeyframeNeeded());
+
+    RecordStep(recorder, 3, 100, false);
+    NS_TEST_INT(recorder.GetNumFrames(), 0);
+
+    RecordStep(recorder, 4, 1000, true);
+    NS_TEST_INT(recorder.GetNumFrames(), 1);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Duration")
+  {
+    JPHFlightRecorderSettings timedSettings = settings;
+    timedSettings.m_Duration = nsTime::MakeFromMilliseconds(200);
+
+    JPHFlightRecorder recorder;
+    recorder.SetSettings(timedSettings);
+
+    RecordStep(recorder, 0, 10, true);
+    RecordStep(recorder, 1, 10, false);
+    nsThreadUtils::Sleep(nsTime::MakeFromMilliseconds(120));
+
+    RecordStep(recorder, 2, 10, true);
+    RecordStep(recorder, 3, 10, false);
+    nsThreadUtils::Sleep(nsTime::MakeFromMilliseconds(120));
+
+    // step 0 is older than the duration, but the next keyframe is not, so step 0 stays to cover the start of the duration
+    RecordStep(recorder, 4, 10, false);
+    NS_TEST_INT(recorder.GetNumFrames(), 5);
+
+    nsThreadUtils::Sleep(nsTime::MakeFromMilliseconds(120));
+
+    // now step 2 is the last keyframe before the duration, everything before it goes
+    RecordStep(recorder, 5, 10, false);
+    NS_TEST_INT(recorder.GetNumFrames(), 4);
+
+    NS_TEST_BOOL(DumpAndOpen(recorder, reader).Succeeded());
+
+    const nsUInt64 steps[] = {2, 3, 4, 5};
+    NS_TEST_BOOL(IsDumpOfSteps(reader, steps));
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Shapes")
+  {
+    JPHFlightRecorderSettings smallSettings = settings;
+    smallSettings.m_uiMaxFrames = 2;
+
+    JPHFlightRecorder recorder;
+    recorder.SetSettings(smallSettings);
+
+    const nsUInt8 shape1[] = {1, 1, 1};
+    const nsUInt8 shape2[] = {2, 2};
+
+    recorder.RecordShape(1, shape1);
+    recorder.RecordShape(2, shape2);
+
+    // attaching the recorder to an interface again sends all shapes again
+    recorder.RecordShape(1, shape1);
+    NS_TEST_INT(recorder.GetNumShapes(), 2);
+
+    RecordStep(recorder, 5, 10, true);
+    recorder.ReleaseShape(1, 5);
+    RecordStep(recorder, 6, 10, false);
+
+    // step 5 may still reference the shape
+    NS_TEST_INT(recorder.GetNumShapes(), 2);
+
+    RecordStep(recorder, 7, 10, true);
+    NS_TEST_INT(recorder.GetNumFrames(), 1);
+    NS_TEST_INT(recorder.GetNumShapes(), 1);
+
+    NS_TEST_BOOL(DumpAndOpen(recorder, reader).Succeeded());
+    NS_TEST_BOOL(reader.GetShapeGeometry(1).IsEmpty());
+    NS_TEST_BOOL(reader.GetShapeGeometry(2) == nsArrayPtr<const nsUInt8>(shape2));
+  }
+
+  reader.Close();
+}
@@ -0,0 +1,438 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHEncodingUtils.h>
+#include <InspectorPlugin/JoltInterface/JPHFrameEncoder.h>
+
+NS_CREATE_SIMPLE_TEST_GROUP(JoltInterface);
+
+namespace
+{
+  using namespace JDebug::API;
+
+  using StateFlags = JPHBodySnapshot::JPHBodyStateFlags;
+
+  static nsQuat RandomRotation(nsRandom& ref_rng)
+  {
+    nsVec3 vAxis(ref_rng.FloatMinMax(-1.0f, 1.0f), ref_rng.FloatMinMax(-1.0f, 1.0f), ref_rng.FloatMinMax(-1.0f, 1.0f));
+    vAxis.NormalizeIfNotZero(nsVec3(0, 0, 1)).IgnoreResult();
+
+    return nsQuat::MakeFromAxisAndAngle(vAxis, nsAngle::MakeFromRadian(ref_rng.FloatMinMax(-nsMath::Pi<float>(), nsMath::Pi<float>())));
+  }
+
+  static float GetRotationError(const nsQuat& a, const nsQuat& b)
+  {
+    return 2.0f * nsMath::ACos(nsMath::Min(nsMath::Abs(a.Dot(b)), 1.0f)).GetRadian();
+  }
+
+  static void SetBody(JPHBodySnapshot& ref_snapshot, nsUInt32 uiSlot, nsRandom& ref_rng)
+  {
+    ref_snapshot.m_BodyIDs[uiSlot] = uiSlot | (ref_rng.UIntInRange(255) << 23);
+    ref_snapshot.m_States[uiSlot] = StateFlags::Valid | (ref_rng.Bool() ? StateFlags::Active : 0);
+    ref_snapshot.m_MotionTypes[uiSlot] = static_cast<nsUInt8>(ref_rng.UIntInRange(3));
+    ref_snapshot.m_ObjectLayers[uiSlot] = ref_rng.UIntInRange(300);
+    ref_snapshot.m_ShapeIDs[uiSlot] = ref_rng.UIntInRange(1000);
+    ref_snapshot.m_Positions[uiSlot].Set(ref_rng.FloatMinMax(-500.0f, 500.0f), ref_rng.FloatMinMax(-10.0f, 50.0f), ref_rng.FloatMinMax(-500.0f, 500.0f));
+    ref_snapshot.m_Rotations[uiSlot] = RandomRotation(ref_rng);
+    ref_snapshot.m_LinearVelocities[uiSlot].Set(ref_rng.FloatMinMax(-20.0f, 20.0f), ref_rng.FloatMinMax(-20.0f, 20.0f), ref_rng.FloatMinMax(-20.0f, 20.0f));
+    ref_snapshot.m_AngularVelocities[uiSlot].Set(ref_rng.FloatMinMax(-5.0f, 5.0f), ref_rng.FloatMinMax(-5.0f, 5.0f), ref_rng.FloatMinMax(-5.0f, 5.0f));
+  }
+
+  static void FillSnapshot(JPHBodySnapshot& ref_snapshot, nsUInt32 uiNumSlots, nsRandom& ref_rng)
+  {
+    ref_snapshot.SetSlotCount(uiNumSlots);
+    ref_snapshot.ClearSlots();
+
+    for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+    {
+      // leave some holes, like removed bodies do
+      if (ref_rng.UIntInRange(5) != 0)
+      {
+        SetBody(ref_snapshot, uiSlot, ref_rng);
+      }
+    }
+  }
+
+  static void TestSnapshotsMatch(const JPHBodySnapshot& expected, const JPHBodySnapshot& decoded)
+  {
+    NS_TEST_INT(decoded.GetSlotCount(), expected.GetSlotCount());
+    NS_TEST_INT(decoded.m_uiStepIndex, expected.m_uiStepIndex);
+
+    for (nsUInt32 uiSlot = 0; uiSlot < expected.GetSlotCount(); ++uiSlot)
+    {
+      NS_TEST_BOOL(decoded.IsValid(uiSlot) == expected.IsValid(uiSlot));
+
+      if (!expected.IsValid(uiSlot) || !decoded.IsValid(uiSlot))
+        continue;
+
+      NS_TEST_INT(decoded.m_BodyIDs[uiSlot], expected.m_BodyIDs[uiSlot]);
+      NS_TEST_INT(decoded.m_States[uiSlot], expected.m_States[uiSlot]);
+      NS_TEST_INT(decoded.m_MotionTypes[uiSlot], expected.m_MotionTypes[uiSlot]);
+      NS_TEST_INT(decoded.m_ObjectLayers[uiSlot], expected.m_ObjectLayers[uiSlot]);
+      NS_TEST_INT(decoded.m_ShapeIDs[uiSlot], expected.m_ShapeIDs[uiSlot]);
+      NS_TEST_VEC3(decoded.m_Positions[uiSlot], expected.m_Positions[uiSlot], 0.001f);
+      NS_TEST_VEC3(decoded.m_LinearVelocities[uiSlot], expected.m_LinearVelocities[uiSlot], 0.003f);
+      NS_TEST_VEC3(decoded.m_AngularVelocities[uiSlot], expected.m_AngularVelocities[uiSlot], 0.003f);
+      NS_TEST_BOOL(GetRotationError(decoded.m_Rotations[uiSlot], expected.m_Rotations[uiSlot]) < 0.005f);
+    }
+  }
+
+  static const nsBitflags<JPHFrameContent> s_AllContent = JPHFrameContent::State | JPHFrameContent::Position | JPHFrameContent::Rotation | JPHFrameContent::Velocity | JPHFrameContent::Shape;
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, FrameEncoder)
+{
+  nsRandom rng;
+  rng.Initialize(42);
+
+  JPHBodySnapshot source;
+  FillSnapshot(source, 500, rng);
+  source.m_uiStepIndex = 17;
+
+  JPHFrameEncoder encoder;
+  nsDynamicArray<nsUInt8> keyframe;
+  const bool bKeyframe = encoder.EncodeFrame(source, s_AllContent, keyframe);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Keyframe")
+  {
+    NS_TEST_BOOL(bKeyframe);
+
+    JPHFrameDecoder decoder;
+    JPHBodySnapshot decoded;
+    nsDynamicArray<nsUInt32> slots;
+    NS_TEST_BOOL(decoder.DecodeFrame(keyframe, decoded, &slots).Succeeded());
+
+    TestSnapshotsMatch(source, decoded);
+
+    nsUInt32 uiNumValid = 0;
+    for (nsUInt32 uiSlot = 0; uiSlot < source.GetSlotCount(); ++uiSlot)
+      uiNumValid += source.IsValid(uiSlot) ? 1 : 0;
+
+    NS_TEST_INT(slots.GetCount(), uiNumValid);
+    NS_TEST_INT(encoder.GetNumEncodedBodies(), uiNumValid);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Delta Frames")
+  {
+    JPHFrameDecoder decoder;
+    JPHBodySnapshot decoded;
+    NS_TEST_BOOL(decoder.DecodeFrame(keyframe, decoded).Succeeded());
+
+    JPHBodySnapshot current = source;
+
+    for (nsUInt32 uiFrame = 0; uiFrame < 10; ++uiFrame)
+    {
+      current.m_uiStepIndex++;
+
+      // move some bodies, remove some and add some
+      for (nsUInt32 uiSlot = 0; uiSlot < current.GetSlotCount(); ++uiSlot)
+      {
+        const nsUInt32 uiAction = rng.UIntInRange(20);
+
+        if (current.IsValid(uiSlot) && uiAction == 0)
+        {
+          current.ClearSlot(uiSlot);
+        }
+        else if (current.IsValid(uiSlot) && uiAction < 4)
+        {
+          current.m_Positions[uiSlot] += nsVec3(rng.FloatMinMax(-2.0f, 2.0f), rng.FloatMinMax(-2.0f, 2.0f), 0.5f);
+          current.m_Rotations[uiSlot] = RandomRotation(rng);
+          current.m_LinearVelocities[uiSlot].y -= 1.0f;
+        }
+        else if (!current.IsValid(uiSlot) && uiAction == 1)
+        {
+          SetBody(current, uiSlot, rng);
+        }
+      }
+
+      nsDynamicArray<nsUInt8> frame;
+      NS_TEST_BOOL(!encoder.EncodeFrame(current, s_AllContent, frame));
+      NS_TEST_BOOL(frame.GetCount() < keyframe.GetCount());
+
+      NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Succeeded());
+      TestSnapshotsMatch(current, decoded);
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Delta Frame Without Keyframe")
+  {
+    JPHBodySnapshot current = source;
+    current.m_uiStepIndex++;
+    current.m_Positions[1] += nsVec3(1, 0, 0);
+
+    JPHFrameEncoder deltaEncoder;
+    nsDynamicArray<nsUInt8> first, delta;
+    deltaEncoder.EncodeFrame(source, s_AllContent, first);
+    NS_TEST_BOOL(!deltaEncoder.EncodeFrame(current, s_AllContent, delta));
+
+    JPHFrameDecoder decoder;
+    JPHBodySnapshot decoded;
+    NS_TEST_BOOL(decoder.DecodeFrame(delta, decoded).Failed());
+
+    // after the keyframe the same delta frame is fine
+    NS_TEST_BOOL(decoder.DecodeFrame(first, decoded).Succeeded());
+    NS_TEST_BOOL(decoder.DecodeFrame(delta, decoded).Succeeded());
+    TestSnapshotsMatch(current, decoded);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Truncated Frame")
+  {
+    for (nsUInt32 uiSize = 0; uiSize < keyframe.GetCount(); ++uiSize)
+    {
+      JPHFrameDecoder decoder;
+      JPHBodySnapshot decoded;
+      NS_TEST_BOOL(decoder.DecodeFrame(keyframe.GetArrayPtr().GetSubArray(0, uiSize), decoded).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt Header")
+  {
+    // magic, version, slot count and record count, see JPHFrameEncoderDetail::FrameHeader
+    constexpr nsUInt32 uiVersionOffset = 4;
+    constexpr nsUInt32 uiNumSlotsOffset = 16;
+    constexpr nsUInt32 uiNumRecordsOffset = 20;
+
+    auto Decode = [](const nsDynamicArray<nsUInt8>& data) -> nsResult
+    {
+      JPHFrameDecoder decoder;
+      JPHBodySnapshot decoded;
+      return decoder.DecodeFrame(data, decoded);
+    };
+
+    nsDynamicArray<nsUInt8> data = keyframe;
+    data[0] ^= 0xFF;
+    NS_TEST_BOOL(Decode(data).Failed());
+
+    data = keyframe;
+    data[uiVersionOffset]++;
+    NS_TEST_BOOL(Decode(data).Failed());
+
+    // records refer to slots beyond the slot count
+    data = keyframe;
+    const nsUInt32 uiFewSlots = 10;
+    nsMemoryUtils::RawByteCopy(&data[uiNumSlotsOffset], &uiFewSlots, sizeof(nsUInt32));
+    NS_TEST_BOOL(Decode(data).Failed());
+
+    // a slot count no body ID can have must not be allocated
+    data = keyframe;
+    const nsUInt32 uiHugeSlots = 0xFFFFFFF0u;
+    nsMemoryUtils::RawByteCopy(&data[uiNumSlotsOffset], &uiHugeSlots, sizeof(nsUInt32));
+    NS_TEST_BOOL(Decode(data).Failed());
+
+    // more records than the data holds
+    data = keyframe;
+    const nsUInt32 uiManyRecords = 0xFFFFFFFFu;
+    nsMemoryUtils::RawByteCopy(&data[uiNumRecordsOffset], &uiManyRecords, sizeof(nsUInt32));
+    NS_TEST_BOOL(Decode(data).Failed());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Out Of Range Positions")
+  {
+    const nsBitflags<JPHFrameContent> positionContent = JPHFrameContent::State | JPHFrameContent::Position;
+    const float fLimit = static_cast<float>(1 << 30) * JPHFrameEncoderSettings().m_fPositionQuantum;
+
+    // clamped positions at both ends of the range, swapping them needs differences of 2^31
+    JPHBodySnapshot far;
+    far.SetSlotCount(2);
+    far.ClearSlots();
+    SetBody(far, 0, rng);
+    SetBody(far, 1, rng);
+    far.m_Positions[0].Set(1.0e30f, 0, 0);
+    far.m_Positions[1].Set(-1.0e30f, 0, 0);
+
+    JPHFrameEncoder farEncoder;
+    JPHFrameDecoder decoder;
+    JPHBodySnapshot decoded;
+    nsDynamicArray<nsUInt8> farKeyframe, frame;
+
+    farEncoder.EncodeFrame(far, positionContent, farKeyframe);
+    NS_TEST_BOOL(decoder.DecodeFrame(farKeyframe, decoded).Succeeded());
+    NS_TEST_FLOAT(decoded.m_Positions[0].x, fLimit, 0.0f);
+    NS_TEST_FLOAT(decoded.m_Positions[1].x, -fLimit, 0.0f);
+
+    nsMath::Swap(far.m_Positions[0], far.m_Positions[1]);
+    farEncoder.EncodeFrame(far, positionContent, frame);
+    NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Succeeded());
+    NS_TEST_FLOAT(decoded.m_Positions[0].x, -fLimit, 0.0f);
+    NS_TEST_FLOAT(decoded.m_Positions[1].x, fLimit, 0.0f);
+
+    // a frame with a single record for slot 0 that moves the body by the given x
+    constexpr nsUInt32 uiFlagsOffset = 5;
+    constexpr nsUInt32 uiNumRecordsOffset = 20;
+    constexpr nsUInt32 uiOriginOffset = 32;
+    constexpr nsUInt32 uiHeaderSize = 48;
+
+    auto MakeFrame = [&](bool bKeyframe, nsInt64 iDeltaX)
+    {
+      frame.Clear();
+      frame.PushBackRange(farKeyframe.GetArrayPtr().GetSubArray(0, uiHeaderSize));
+      frame[uiFlagsOffset] = static_cast<nsUInt8>(bKeyframe ? JPHFrameEncoder::Frame_Keyframe : 0);
+
+      const nsUInt32 uiNumRecords = 1;
+      nsMemoryUtils::RawByteCopy(&frame[uiNumRecordsOffset], &uiNumRecords, sizeof(nsUInt32));
+
+      IO::JPHByteWriter writer(frame);
+      writer.WriteVarUInt(0);
+
+      if (bKeyframe)
+      {
+        writer.Write<nsUInt8>(JPHFrameEncoder::Field_State | JPHFrameEncoder::Field_Position);
+        writer.Write<nsUInt32>(1);
+        writer.Write<nsUInt8>(StateFlags::Valid);
+        writer.Write<nsUInt8>(0);
+        writer.WriteVarUInt(0);
+      }
+      else
+      {
+        writer.Write<nsUInt8>(JPHFrameEncoder::Field_Position);
+      }
+
+      writer.WriteVarInt(iDeltaX);
+      writer.WriteVarInt(0);
+      writer.WriteVarInt(0);
+    };
+
+    // the keyframe of the two bodies has its origin at zero
+    MakeFrame(true, 1 << 30);
+    NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Succeeded());
+    NS_TEST_FLOAT(decoded.m_Positions[0].x, fLimit, 0.0f);
+
+    MakeFrame(false, -(nsInt64(1) << 31));
+    NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Succeeded());
+    NS_TEST_FLOAT(decoded.m_Positions[0].x, -fLimit, 0.0f);
+
+    // anything the encoder cannot produce, including values that used to be truncated to 32 bit
+    const nsInt64 corruptDeltas[] = {(1 << 30) + 1, -(1 << 30) - 1, nsInt64(1) << 32, (nsInt64(1) << 32) + 5, nsMath::MaxValue<nsInt64>(), nsMath::MinValue<nsInt64>()};
+
+    for (nsInt64 iDelta : corruptDeltas)
+    {
+      MakeFrame(true, iDelta);
+      NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Failed());
+    }
+
+    // relative to a body at the upper end of the range, even a step of one is out of range
+    MakeFrame(true, 1 << 30);
+    NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Succeeded());
+    MakeFrame(false, 1);
+    NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Failed());
+    MakeFrame(false, -(nsInt64(1) << 31) - 1);
+    NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Failed());
+
+    const nsInt32 iCorruptOrigin = nsMath::MaxValue<nsInt32>();
+    MakeFrame(true, 0);
+    nsMemoryUtils::RawByteCopy(&frame[uiOriginOffset], &iCorruptOrigin, sizeof(nsInt32));
+    NS_TEST_BOOL(decoder.DecodeFrame(frame, decoded).Failed());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Random Corruption")
+  {
+    // must never crash, whether the result is a failure or garbage that happens to parse
+    for (nsUInt32 i = 0; i < 200; ++i)
+    {
+      nsDynamicArray<nsUInt8> data = keyframe;
+      for (nsUInt32 uiFlip = 0; uiFlip < 8; ++uiFlip)
+      {
+        data[rng.UIntInRange(data.GetCount())] ^= static_cast<nsUInt8>(1u << rng.UIntInRange(8));
+      }
+
+      JPHFrameDecoder decoder;
+      JPHBodySnapshot decoded;
+      decoder.DecodeFrame(data, decoded).IgnoreResult();
+    }
+  }
+}
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, EncodingUtils)
+{
+  using namespace JDebug::API::IO;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "QuantizeFixed")
+  {
+    NS_TEST_INT(QuantizeFixed(1.0f, 1024.0f), 1024);
+    NS_TEST_INT(QuantizeFixed(-1.0f, 1024.0f), -1024);
+    NS_TEST_INT(QuantizeFixed(0.4f / 1024.0f, 1024.0f), 0);
+    NS_TEST_INT(QuantizeFixed(0.6f / 1024.0f, 1024.0f), 1);
+
+    // out of range values are clamped instead of being undefined, NaN maps to zero
+    NS_TEST_INT(QuantizeFixed(1.0e30f, 1024.0f), 1 << 30);
+    NS_TEST_INT(QuantizeFixed(-1.0e30f, 1024.0f), -(1 << 30));
+    NS_TEST_INT(QuantizeFixed(nsMath::Infinity<float>(), 1024.0f), 1 << 30);
+    NS_TEST_INT(QuantizeFixed(-nsMath::Infinity<float>(), 1024.0f), -(1 << 30));
+    NS_TEST_INT(QuantizeFixed(nsMath::NaN<float>(), 1024.0f), 0);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "PackQuatSmallestThree")
+  {
+    nsRandom rng;
+    rng.Initialize(7);
+
+    NS_TEST_BOOL(GetRotationError(UnpackQuatSmallestThree(PackQuatSmallestThree(nsQuat::MakeIdentity())), nsQuat::MakeIdentity()) < 0.005f);
+
+    float fMaxError = 0.0f;
+    for (nsUInt32 i = 0; i < 10000; ++i)
+    {
+      const nsQuat q = RandomRotation(rng);
+      fMaxError = nsMath::Max(fMaxError, GetRotationError(UnpackQuatSmallestThree(PackQuatSmallestThree(q)), q));
+    }
+
+    NS_TEST_BOOL(fMaxError < 0.005f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Varints")
+  {
+    const nsInt64 values[] = {0, 1, -1, 63, -64, 64, 300, -300, nsMath::MaxValue<nsInt32>(), nsMath::MinValue<nsInt32>(), nsMath::MaxValue<nsInt64>(), nsMath::MinValue<nsInt64>()};
+
+    nsDynamicArray<nsUInt8> data;
+    JPHByteWriter writer(data);
+    for (nsInt64 iValue : values)
+    {
+      writer.WriteVarInt(iValue);
+      writer.WriteVarUInt(static_cast<nsUInt64>(iValue));
+    }
+
+    JPHByteReader reader(data);
+    for (nsInt64 iValue : values)
+    {
+      nsInt64 iRead = 0;
+      nsUInt64 uiRead = 0;
+      NS_TEST_BOOL(reader.ReadVarInt(iRead));
+      NS_TEST_BOOL(reader.ReadVarUInt(uiRead));
+      NS_TEST_BOOL(iRead == iValue);
+      NS_TEST_BOOL(uiRead == static_cast<nsUInt64>(iValue));
+    }
+
+    NS_TEST_BOOL(reader.IsAtEnd());
+    NS_TEST_BOOL(!reader.HasFailed());
+
+    // an unterminated varint fails
+    const nsUInt8 unterminated[] = {0x80, 0x80};
+    JPHByteReader unterminatedReader(nsMakeArrayPtr(unterminated));
+    nsUInt64 uiValue = 0;
+    NS_TEST_BOOL(!unterminatedReader.ReadVarUInt(uiValue));
+    NS_TEST_BOOL(unterminatedReader.HasFailed());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "ByteReader Bounds")
+  {
+    const nsUInt8 data[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    JPHByteReader reader(nsMakeArrayPtr(data));
+    nsUInt32 uiValue = 0;
+    NS_TEST_BOOL(reader.Read(uiValue));
+    NS_TEST_INT(reader.GetOffset(), 4);
+
+    // sizes that wrap the offset around must not pass the bounds check
+    NS_TEST_BOOL(!reader.Skip(0xFFFFFFFFu));
+    NS_TEST_BOOL(reader.HasFailed());
+    NS_TEST_BOOL(reader.IsAtEnd());
+
+    JPHByteReader reader2(nsMakeArrayPtr(data));
+    NS_TEST_BOOL(reader2.Skip(2));
+    NS_TEST_BOOL(!reader2.ReadBytes(&uiValue, 0xFFFFFFFEu));
+    NS_TEST_BOOL(reader2.HasFailed());
+
+    JPHByteReader reader3(nsMakeArrayPtr(data));
+    NS_TEST_BOOL(reader3.Skip(8));
+    NS_TEST_BOOL(reader3.IsAtEnd());
+    NS_TEST_BOOL(!reader3.Read(uiValue));
+  }
+}
@@ -0,0 +1,75 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHInterestFilter.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  static void FillLayeredSnapshot(JPHBodySnapshot& ref_snapshot, nsUInt32 uiNumSlots)
+  {
+    ref_snapshot.SetSlotCount(uiNumSlots);
+    ref_snapshot.ClearSlots();
+
+    for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+    {
+      ref_snapshot.m_BodyIDs[uiSlot] = uiSlot;
+      ref_snapshot.m_States[uiSlot] = JPHBodySnapshot::JPHBodyStateFlags::Valid;
+      ref_snapshot.m_ObjectLayers[uiSlot] = uiSlot % 4;
+      ref_snapshot.m_Positions[uiSlot].Set(static_cast<float>(uiSlot), 0, 0);
+      ref_snapshot.m_Rotations[uiSlot] = nsQuat::MakeIdentity();
+    }
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, InterestFilter)
+{
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Changed Slots")
+  {
+    JPHBodySnapshot snapshot;
+    FillLayeredSnapshot(snapshot, 16);
+
+    JPHInterestFilterSettings settings;
+    settings.m_uiLingerSteps = 0;
+
+    JPHInterestFilter filter;
+    filter.SetSettings(settings);
+
+    JPHInterestSet set;
+    set.m_uiObjectLayerMask = NS_BIT(1);
+    filter.SetInterestSet(set);
+
+    // everything of interest is new
+    filter.Update(nullptr, snapshot);
+    NS_TEST_INT(filter.GetNumSelectedBodies(), 4);
+    NS_TEST_INT(filter.GetChangedSlots().GetCount(), 4);
+
+    filter.Update(nullptr, snapshot);
+    NS_TEST_BOOL(filter.GetChangedSlots().IsEmpty());
+
+    // layer 1 leaves, layer 2 enters
+    set.m_uiObjectLayerMask = NS_BIT(2);
+    filter.SetInterestSet(set);
+    filter.Update(nullptr, snapshot);
+
+    NS_TEST_INT(filter.GetChangedSlots().GetCount(), 8);
+
+    for (nsUInt32 uiSlot : filter.GetChangedSlots())
+    {
+      const nsUInt32 uiLayer = snapshot.m_ObjectLayers[uiSlot];
+      NS_TEST_BOOL(uiLayer == 1 || uiLayer == 2);
+      NS_TEST_INT(filter.GetMask()[uiSlot], uiLayer == 2 ? 1 : 0);
+    }
+
+    // a new slot of interest counts as changed, a removed body as well
+    FillLayeredSnapshot(snapshot, 20);
+    snapshot.ClearSlot(2);
+    filter.Update(nullptr, snapshot);
+
+    NS_TEST_INT(filter.GetChangedSlots().GetCount(), 2);
+    NS_TEST_INT(filter.GetChangedSlots()[0], 2);
+    NS_TEST_INT(filter.GetChangedSlots()[1], 18);
+    NS_TEST_INT(filter.GetNumSelectedBodies(), 4);
+  }
+}
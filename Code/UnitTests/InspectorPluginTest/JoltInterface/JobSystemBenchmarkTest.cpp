@@ -0,0 +1,50 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHJobSystemBenchmark.h>
+#include <InspectorPluginTest/JoltInterface/JoltTestHelpers.h>
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, JobSystemBenchmark)
+{
+  using namespace JDebug::API;
+
+  JoltTestHelpers::EnsureJoltInitialized();
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Small Scene")
+  {
+    JPHJobSystemBenchmarkSettings settings;
+    settings.m_uiNumBodies = 64;
+    settings.m_uiNumWarmupSteps = 1;
+    settings.m_uiNumSteps = 4;
+    settings.m_uiMaxThreads = 5;
+
+    const nsUInt32 uiPrevShortWorkers = nsTaskSystem::GetNumAllocatedWorkerThreads(nsWorkerThreadType::ShortTasks);
+
+    nsDynamicArray<JPHJobSystemBenchmarkResult> results;
+    JPHJobSystemBenchmark::Run(settings, results);
+
+    // a single thread is not measured
+    NS_TEST_INT(results.GetCount(), 2);
+    NS_TEST_INT(results[0].m_uiNumThreads, 2);
+    NS_TEST_INT(results[1].m_uiNumThreads, 4);
+
+    for (const JPHJobSystemBenchmarkResult& result : results)
+    {
+      NS_TEST_BOOL(result.m_ThreadPoolMin.IsPositive());
+      NS_TEST_BOOL(result.m_ThreadPoolMin <= result.m_ThreadPoolAverage);
+      NS_TEST_BOOL(result.m_TaskSystemMin.IsPositive());
+      NS_TEST_BOOL(result.m_TaskSystemMin <= result.m_TaskSystemAverage);
+    }
+
+    NS_TEST_INT(nsTaskSystem::GetNumAllocatedWorkerThreads(nsWorkerThreadType::ShortTasks), uiPrevShortWorkers);
+  }
+
+  // takes minutes, enable it to compare the job systems on this machine
+  NS_TEST_BLOCK(nsTestBlock::Disabled, "Full Benchmark")
+  {
+    nsDynamicArray<JPHJobSystemBenchmarkResult> results;
+    JPHJobSystemBenchmark::Run(JPHJobSystemBenchmarkSettings(), results);
+    JPHJobSystemBenchmark::LogResults(results);
+
+    NS_TEST_BOOL(!results.IsEmpty());
+  }
+}
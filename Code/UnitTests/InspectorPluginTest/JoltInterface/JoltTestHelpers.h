@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Jolt/Jolt.h>
+
+#include <Jolt/Core/Factory.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/RegisterTypes.h>
+
+namespace JoltTestHelpers
+{
+  /// Sets up the Jolt allocator, the factory and the type registry once. Every test that creates shapes or bodies calls this first.
+  inline void EnsureJoltInitialized()
+  {
+    static bool s_bInitialized = false;
+    if (s_bInitialized)
+      return;
+
+    s_bInitialized = true;
+    JPH::RegisterDefaultAllocator();
+    JPH::Factory::sInstance = new JPH::Factory();
+    JPH::RegisterTypes();
+  }
+
+  /// A physics system with a single object and broad phase layer in which everything collides, for tests that need bodies.
+  class TestPhysicsSystem
+  {
+  public:
+    explicit TestPhysicsSystem(JPH::uint uiMaxBodies = 1024)
+    {
+      EnsureJoltInitialized();
+      m_System.Init(uiMaxBodies, 0, uiMaxBodies, uiMaxBodies, m_BroadPhaseLayers, m_ObjectVsBroadPhaseFilter, m_ObjectPairFilter);
+    }
+
+    JPH::PhysicsSystem& GetSystem() { return m_System; }
+    JPH::BodyInterface& GetBodyInterface() { return m_System.GetBodyInterfaceNoLock(); }
+
+  private:
+    class BroadPhaseLayers final : public JPH::BroadPhaseLayerInterface
+    {
+    public:
+      virtual JPH::uint GetNumBroadPhaseLayers() const override { return 1; }
+      virtual JPH::BroadPhaseLayer GetBroadPhaseLayer(JPH::ObjectLayer) const override { return JPH::BroadPhaseLayer(0); }
+
+#if defined(JPH_EXTERNAL_PROFILE) || defined(JPH_PROFILE_ENABLED)
+      virtual const char* GetBroadPhaseLayerName(JPH::BroadPhaseLayer) const override { return "Default"; }
+#endif
+    };
+
+    // the base filters let everything collide
+    BroadPhaseLayers m_BroadPhaseLayers;
+    JPH::ObjectVsBroadPhaseLayerFilter m_ObjectVsBroadPhaseFilter;
+    JPH::ObjectLayerPairFilter m_ObjectPairFilter;
+    JPH::PhysicsSystem m_System;
+  };
+} // namespace JoltTestHelpers
@@ -0,0 +1,358 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <Foundation/IO/CompressedStreamZstd.h>
+#include <Foundation/IO/MemoryStream.h>
+#include <Foundation/IO/OSFile.h>
+#include <Foundation/Strings/StringBuilder.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileManager.h>
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileReader.h>
+
+namespace
+{
+  using namespace JDebug::API::IO;
+
+  static constexpr nsUInt64 s_uiFirstStep = 10;
+  static constexpr nsUInt64 s_uiSkippedStep = 20;
+  static constexpr nsUInt32 s_uiNumSteps = 300;
+
+  /// Compressible, but different for every step and record.
+  static void MakeData(nsUInt64 uiStep, nsUInt32 uiSalt, nsUInt32 uiSize, nsDynamicArray<nsUInt8>& out_data)
+  {
+    out_data.SetCountUninitialized(uiSize);
+    for (nsUInt32 i = 0; i < uiSize; ++i)
+    {
+      out_data[i] = static_cast<nsUInt8>(((i / 7) * 13 + uiStep * 31 + uiSalt) & 0x3F);
+    }
+  }
+
+  /// Most frames are small, some are larger than the smallest growth step of the decompression.
+  static nsUInt32 GetFrameSize(nsUInt64 uiStep)
+  {
+    return (uiStep % 50) == 0 ? 200 * 1024 : 100 + static_cast<nsUInt32>(uiStep % 37) * 20;
+  }
+
+  static nsResult WriteFileData(nsStringView sPath, nsArrayPtr<const nsUInt8> data)
+  {
+    nsOSFile file;
+    NS_SUCCEED_OR_RETURN(file.Open(sPath, nsFileOpenMode::Write));
+    return data.IsEmpty() ? NS_SUCCESS : file.Write(data.GetPtr(), data.GetCount());
+  }
+
+  static nsResult ReadFileData(nsStringView sPath, nsDynamicArray<nsUInt8>& out_data)
+  {
+    nsOSFile file;
+    NS_SUCCEED_OR_RETURN(file.Open(sPath, nsFileOpenMode::Read));
+    out_data.SetCountUninitialized(static_cast<nsUInt32>(file.GetFileSize()));
+    return file.Read(out_data.GetData(), out_data.GetCount()) == out_data.GetCount() ? NS_SUCCESS : NS_FAILURE;
+  }
+
+  /// Reads every frame of a capture that may be corrupt. Reading must fail or succeed, but never crash.
+  static void ReadAllFrames(const JPHPVDFileReader& reader)
+  {
+    nsDynamicArray<nsUInt8> payload;
+    nsDynamicArray<JPHPVDFileReader::Record> records;
+
+    for (nsUInt32 uiFrame = 0; uiFrame < reader.GetNumFrames(); ++uiFrame)
+    {
+      if (reader.ReadFrame(uiFrame, payload).Succeeded())
+      {
+        JPHPVDFileReader::GetRecords(payload, records).IgnoreResult();
+      }
+    }
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, PVDFile)
+{
+  nsStringBuilder sFolder = nsTestFramework::GetInstance()->GetAbsOutputPath();
+  sFolder.MakeCleanPath();
+  sFolder.AppendPath("InspectorPlugin");
+
+  nsStringBuilder sCapture = sFolder;
+  sCapture.AppendPath("PVDFile.jdc");
+
+  nsStringBuilder sCorrupt = sFolder;
+  sCorrupt.AppendPath("PVDFile_Corrupt.jdc");
+
+  NS_TEST_BOOL(nsOSFile::CreateDirectoryStructure(sFolder).Succeeded());
+
+  nsDynamicArray<nsUInt32> stringIDs;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Write")
+  {
+    nsOSFile file;
+    NS_TEST_BOOL(file.Open(sCapture, nsFileOpenMode::Write).Succeeded());
+
+    JPHPVDFileManager manager(file);
+    nsDynamicArray<nsUInt8> data, records;
+    nsStringBuilder sName;
+
+    for (nsUInt64 uiStep = s_uiFirstStep; uiStep < s_uiFirstStep + s_uiNumSteps; ++uiStep)
+    {
+      if (uiStep == s_uiSkippedStep)
+        continue;
+
+      manager.BeginFrame(uiStep, (uiStep % 50) == 0);
+
+      MakeData(uiStep, 0, GetFrameSize(uiStep), data);
+      manager.WriteEncodedFrame(data);
+
+      records.Clear();
+      MakeData(uiStep, 1, 100, data);
+      JPHPVDFileManager::AppendRecord(records, JPHPVDRecordType::Contacts, data);
+
+      if ((uiStep % 100) == 0)
+      {
+        MakeData(uiStep, 2, 1000, data);
+        JPHPVDFileManager::AppendRecord(records, JPHPVDRecordType::PhysicsState, data);
+      }
+
+      manager.WriteRecords(records);
+
+      if ((uiStep % 30) == 0)
+      {
+        sName.SetFormat("String {}", uiStep);
+        stringIDs.PushBack(manager.GetStringID(sName));
+      }
+
+      manager.EndFrame();
+    }
+
+    NS_TEST_INT(manager.GetNumFrames(), s_uiNumSteps - 1);
+
+    manager.Close();
+    file.Close();
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Read")
+  {
+    JPHPVDFileReader reader;
+    NS_TEST_BOOL(reader.Open(sCapture).Succeeded());
+    NS_TEST_INT(reader.GetNumFrames(), s_uiNumSteps - 1);
+
+    nsDynamicArray<nsUInt8> payload, expected;
+    nsDynamicArray<JPHPVDFileReader::Record> records;
+
+    for (nsUInt32 uiFrame = 0; uiFrame < reader.GetNumFrames(); ++uiFrame)
+    {
+      const nsUInt64 uiStep = reader.GetFrameInfo(uiFrame).m_uiStepIndex;
+      NS_TEST_INT(uiStep, uiFrame + s_uiFirstStep + (uiFrame + s_uiFirstStep >= s_uiSkippedStep ? 1 : 0));
+
+      NS_TEST_BOOL(reader.ReadFrame(uiFrame, payload).Succeeded());
+      NS_TEST_BOOL(JPHPVDFileReader::GetRecords(payload, records).Succeeded());
+      NS_TEST_INT(records.GetCount(), (uiStep % 100) == 0 ? 3 : 2);
+
+      if (records.GetCount() < 2)
+        continue;
+
+      MakeData(uiStep, 0, GetFrameSize(uiStep), expected);
+      NS_TEST_BOOL(records[0].m_eType == JPHPVDRecordType::EncodedFrame);
+      NS_TEST_BOOL(records[0].m_Data == expected.GetArrayPtr());
+
+      MakeData(uiStep, 1, 100, expected);
+      NS_TEST_BOOL(records[1].m_eType == JPHPVDRecordType::Contacts);
+      NS_TEST_BOOL(records[1].m_Data == expected.GetArrayPtr());
+
+      const nsUInt32 uiKeyframe = reader.GetKeyframe(uiFrame);
+      NS_TEST_BOOL(uiKeyframe == 0 || (reader.GetFrameInfo(uiKeyframe).m_uiStepIndex % 50) == 0);
+      NS_TEST_BOOL(uiStep - reader.GetFrameInfo(uiKeyframe).m_uiStepIndex < 50);
+    }
+
+    // the skipped step maps to the frame before it
+    NS_TEST_INT(reader.FindFrame(s_uiFirstStep - 1), nsInvalidIndex);
+    NS_TEST_INT(reader.GetFrameInfo(reader.FindFrame(s_uiFirstStep)).m_uiStepIndex, s_uiFirstStep);
+    NS_TEST_INT(reader.GetFrameInfo(reader.FindFrame(s_uiSkippedStep)).m_uiStepIndex, s_uiSkippedStep - 1);
+    NS_TEST_INT(reader.GetFrameInfo(reader.FindFrame(250)).m_uiStepIndex, 250);
+    NS_TEST_INT(reader.FindFrame(100000), reader.GetNumFrames() - 1);
+
+    const nsUInt32 uiStateFrame = reader.FindFrameWithFlags(reader.FindFrame(250), PVDFrame_PhysicsState);
+    NS_TEST_INT(reader.GetFrameInfo(uiStateFrame).m_uiStepIndex, 200);
+    NS_TEST_INT(reader.FindFrameWithFlags(reader.FindFrame(99), PVDFrame_PhysicsState), nsInvalidIndex);
+
+    nsStringBuilder sName;
+    for (nsUInt32 i = 0; i < stringIDs.GetCount(); ++i)
+    {
+      sName.SetFormat("String {}", (i + 1) * 30);
+      NS_TEST_BOOL(reader.GetString(stringIDs[i]) == sName);
+    }
+  }
+
+  nsDynamicArray<nsUInt8> fileData;
+  NS_TEST_BOOL(ReadFileData(sCapture, fileData).Succeeded());
+
+  JPHPVDFileFooter footer;
+  nsMemoryUtils::RawByteCopy(&footer, fileData.GetData() + fileData.GetCount() - sizeof(footer), sizeof(footer));
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Truncated File")
+  {
+    for (nsUInt32 uiSize = 0; uiSize < fileData.GetCount(); uiSize += (uiSize + 64 < fileData.GetCount()) ? 997 : 1)
+    {
+      NS_TEST_BOOL(WriteFileData(sCorrupt, fileData.GetArrayPtr().GetSubArray(0, uiSize)).Succeeded());
+
+      JPHPVDFileReader reader;
+      NS_TEST_BOOL(reader.Open(sCorrupt).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt Index")
+  {
+    const nsUInt64 uiIndexOffsets[] = {0, footer.m_uiIndexChunkOffset + 1, footer.m_uiIndexChunkOffset - 1, fileData.GetCount() - sizeof(footer), fileData.GetCount(), 0xFFFFFFFFFFFFFFFFull};
+
+    for (nsUInt64 uiIndexOffset : uiIndexOffsets)
+    {
+      nsDynamicArray<nsUInt8> data = fileData;
+      nsMemoryUtils::RawByteCopy(data.GetData() + data.GetCount() - sizeof(footer), &uiIndexOffset, sizeof(nsUInt64));
+      NS_TEST_BOOL(WriteFileData(sCorrupt, data).Succeeded());
+
+      JPHPVDFileReader reader;
+      NS_TEST_BOOL(reader.Open(sCorrupt).Failed());
+    }
+
+    // "NXT CHNK", the name length, "JDIndex", the version and the data size precede the frame count
+    const nsUInt32 uiFrameCountOffset = static_cast<nsUInt32>(footer.m_uiIndexChunkOffset) + 8 + 4 + 7 + 4 + 4;
+    const nsUInt32 uiFrameCounts[] = {0xFFFFFFFFu, 0x10000000u, s_uiNumSteps * 2};
+
+    for (nsUInt32 uiFrameCount : uiFrameCounts)
+    {
+      nsDynamicArray<nsUInt8> data = fileData;
+      nsMemoryUtils::RawByteCopy(data.GetData() + uiFrameCountOffset, &uiFrameCount, sizeof(nsUInt32));
+      NS_TEST_BOOL(WriteFileData(sCorrupt, data).Succeeded());
+
+      JPHPVDFileReader reader;
+      NS_TEST_BOOL(reader.Open(sCorrupt).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt Frames")
+  {
+    nsRandom rng;
+    rng.Initialize(3);
+
+    for (nsUInt32 i = 0; i < 50; ++i)
+    {
+      // only the frame and dictionary chunks, so the index stays intact and every frame is visited
+      nsDynamicArray<nsUInt8> data = fileData;
+      for (nsUInt32 uiFlip = 0; uiFlip < 16; ++uiFlip)
+      {
+        data[10 + rng.UIntInRange(static_cast<nsUInt32>(footer.m_uiIndexChunkOffset) - 10)] ^= static_cast<nsUInt8>(1u << rng.UIntInRange(8));
+      }
+
+      NS_TEST_BOOL(WriteFileData(sCorrupt, data).Succeeded());
+
+      JPHPVDFileReader reader;
+      if (reader.Open(sCorrupt).Succeeded())
+      {
+        ReadAllFrames(reader);
+      }
+    }
+  }
+
+  nsOSFile::DeleteFile(sCorrupt).IgnoreResult();
+}
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, PVDFilePayload)
+{
+  nsDynamicArray<nsUInt8> payload;
+  MakeData(1, 0, 300 * 1024, payload);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Uncompressed")
+  {
+    nsDynamicArray<nsUInt8> decoded;
+    NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(JPHPVDCompression::None, payload, payload.GetCount(), decoded).Succeeded());
+    NS_TEST_BOOL(decoded == payload);
+
+    NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(JPHPVDCompression::None, payload, payload.GetCount() + 1, decoded).Failed());
+    NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(JPHPVDCompression::None, payload.GetArrayPtr().GetSubArray(1), payload.GetCount(), decoded).Failed());
+    NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(static_cast<JPHPVDCompression>(200), payload, payload.GetCount(), decoded).Failed());
+  }
+
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+  nsDynamicArray<nsUInt8> compressed;
+  {
+    nsMemoryStreamContainerWrapperStorage<nsDynamicArray<nsUInt8>> storage(&compressed);
+    nsMemoryStreamWriter memoryWriter(&storage);
+
+    nsCompressedStreamWriterZstd compressor(&memoryWriter, 0, nsCompressedStreamWriterZstd::Compression::Default, 4);
+    NS_TEST_BOOL(compressor.WriteBytes(payload.GetData(), payload.GetCount()).Succeeded());
+    NS_TEST_BOOL(compressor.FinishCompressedStream().Succeeded());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Zstd")
+  {
+    nsDynamicArray<nsUInt8> decoded;
+    NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(JPHPVDCompression::Zstd, compressed, payload.GetCount(), decoded).Succeeded());
+    NS_TEST_BOOL(decoded == payload);
+
+    // the stored size has to match exactly
+    NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(JPHPVDCompression::Zstd, compressed, payload.GetCount() - 1, decoded).Failed());
+    NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(JPHPVDCompression::Zstd, compressed, payload.GetCount() + 1, decoded).Failed());
+
+    // nothing may follow the terminating zero size
+    nsDynamicArray<nsUInt8> trailing = compressed;
+    trailing.PushBack(0);
+    NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(JPHPVDCompression::Zstd, trailing, payload.GetCount(), decoded).Failed());
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Zstd Truncated")
+  {
+    nsDynamicArray<nsUInt8> decoded;
+    for (nsUInt32 uiSize = 0; uiSize < compressed.GetCount(); ++uiSize)
+    {
+      NS_TEST_BOOL(JPHPVDFileReader::DecompressPayload(JPHPVDCompression::Zstd, compressed.GetArrayPtr().GetSubArray(0, uiSize), payload.GetCount(), decoded).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Zstd Corrupt")
+  {
+    nsRandom rng;
+    rng.Initialize(11);
+
+    nsDynamicArray<nsUInt8> decoded;
+    for (nsUInt32 i = 0; i < 500; ++i)
+    {
+      nsDynamicArray<nsUInt8> data = compressed;
+      data[rng.UIntInRange(data.GetCount())] ^= static_cast<nsUInt8>(1u << rng.UIntInRange(8));
+
+      // zstd checksums are off, so a flipped literal may decode to different bytes, but never to more or fewer
+      if (JPHPVDFileReader::DecompressPayload(JPHPVDCompression::Zstd, data, payload.GetCount(), decoded).Succeeded())
+      {
+        NS_TEST_INT(decoded.GetCount(), payload.GetCount());
+      }
+    }
+  }
+#endif
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Records")
+  {
+    nsDynamicArray<nsUInt8> records, data;
+    MakeData(1, 1, 10, data);
+    JPHPVDFileManager::AppendRecord(records, JPHPVDRecordType::EncodedFrame, data);
+    MakeData(1, 2, 300, data);
+    JPHPVDFileManager::AppendRecord(records, JPHPVDRecordType::Contacts, data);
+    JPHPVDFileManager::AppendRecord(records, JPHPVDRecordType::StateHash, nsArrayPtr<const nsUInt8>());
+
+    nsDynamicArray<JPHPVDFileReader::Record> decoded;
+    NS_TEST_BOOL(JPHPVDFileReader::GetRecords(records, decoded).Succeeded());
+    NS_TEST_INT(decoded.GetCount(), 3);
+    NS_TEST_BOOL(decoded[1].m_eType == JPHPVDRecordType::Contacts);
+    NS_TEST_BOOL(decoded[1].m_Data == data.GetArrayPtr());
+    NS_TEST_BOOL(decoded[2].m_eType == JPHPVDRecordType::StateHash);
+    NS_TEST_INT(decoded[2].m_Data.GetCount(), 0);
+
+    // cutting a record short fails, only the cut after the last byte of a record is a valid, shorter payload
+    const nsUInt32 uiSecondRecord = 1 + 1 + 10;
+    const nsUInt32 uiThirdRecord = uiSecondRecord + 1 + 2 + 300;
+    for (nsUInt32 uiSize = 0; uiSize < records.GetCount(); ++uiSize)
+    {
+      const bool bValid = uiSize == 0 || uiSize == uiSecondRecord || uiSize == uiThirdRecord;
+      NS_TEST_BOOL(JPHPVDFileReader::GetRecords(records.GetArrayPtr().GetSubArray(0, uiSize), decoded).Succeeded() == bValid);
+    }
+
+    // sizes that wrap the offset around
+    const nsUInt8 hugeSize[] = {static_cast<nsUInt8>(JPHPVDRecordType::Contacts), 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 0xAB};
+    NS_TEST_BOOL(JPHPVDFileReader::GetRecords(nsMakeArrayPtr(hugeSize), decoded).Failed());
+
+    const nsUInt8 wrappedSize[] = {static_cast<nsUInt8>(JPHPVDRecordType::Contacts), 0xFE, 0xFF, 0xFF, 0xFF, 0x0F, 0xAB};
+    NS_TEST_BOOL(JPHPVDFileReader::GetRecords(nsMakeArrayPtr(wrappedSize), decoded).Failed());
+  }
+}
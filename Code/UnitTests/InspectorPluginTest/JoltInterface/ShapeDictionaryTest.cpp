@@ -0,0 +1,317 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <InspectorPlugin/JoltInterface/Internal/JPHPVDFileFormat.h>
+#include <InspectorPlugin/JoltInterface/JPHShapeDictionary.h>
+#include <InspectorPluginTest/JoltInterface/JoltTestHelpers.h>
+
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/MeshShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  // see the layout described at JPHShapeDictionary
+  static constexpr nsUInt32 s_uiGeometryVersionOffset = 4;
+  static constexpr nsUInt32 s_uiGeometryCompressionOffset = 7;
+  static constexpr nsUInt32 s_uiGeometryNumVerticesOffset = 32;
+  static constexpr nsUInt32 s_uiGeometryNumTrianglesOffset = 36;
+  static constexpr nsUInt32 s_uiGeometryPayloadSizeOffset = 40;
+  static constexpr nsUInt32 s_uiGeometryHeaderSize = 44;
+
+  static constexpr nsUInt32 s_uiGridSize = 60;
+
+  static float GetGridHeight(nsUInt32 x, nsUInt32 z)
+  {
+    return nsMath::Sin(nsAngle::MakeFromRadian(x * 0.3f)) * nsMath::Cos(nsAngle::MakeFromRadian(z * 0.2f)) * 2.0f;
+  }
+
+  static JPH::Ref<JPH::Shape> CreateGridMesh()
+  {
+    JPH::TriangleList triangles;
+
+    for (nsUInt32 z = 0; z < s_uiGridSize; ++z)
+    {
+      for (nsUInt32 x = 0; x < s_uiGridSize; ++x)
+      {
+        const JPH::Float3 v00(float(x), GetGridHeight(x, z), float(z));
+        const JPH::Float3 v10(float(x + 1), GetGridHeight(x + 1, z), float(z));
+        const JPH::Float3 v01(float(x), GetGridHeight(x, z + 1), float(z + 1));
+        const JPH::Float3 v11(float(x + 1), GetGridHeight(x + 1, z + 1), float(z + 1));
+        triangles.push_back(JPH::Triangle(v00, v01, v11));
+        triangles.push_back(JPH::Triangle(v00, v11, v10));
+      }
+    }
+
+    JPH::MeshShapeSettings settings(triangles);
+    return settings.Create().Get();
+  }
+
+  static float GetTriangleArea(const nsVec3& a, const nsVec3& b, const nsVec3& c)
+  {
+    return (b - a).CrossRH(c - a).GetLength() * 0.5f;
+  }
+
+  static float GetGridArea()
+  {
+    float fArea = 0.0f;
+
+    for (nsUInt32 z = 0; z < s_uiGridSize; ++z)
+    {
+      for (nsUInt32 x = 0; x < s_uiGridSize; ++x)
+      {
+        const nsVec3 v00(float(x), GetGridHeight(x, z), float(z));
+        const nsVec3 v10(float(x + 1), GetGridHeight(x + 1, z), float(z));
+        const nsVec3 v01(float(x), GetGridHeight(x, z + 1), float(z + 1));
+        const nsVec3 v11(float(x + 1), GetGridHeight(x + 1, z + 1), float(z + 1));
+        fArea += GetTriangleArea(v00, v01, v11) + GetTriangleArea(v00, v11, v10);
+      }
+    }
+
+    return fArea;
+  }
+
+  static void PatchGeometry(nsDynamicArray<nsUInt8>& ref_data, nsUInt32 uiOffset, nsUInt32 uiValue)
+  {
+    nsMemoryUtils::RawByteCopy(ref_data.GetData() + uiOffset, &uiValue, sizeof(nsUInt32));
+  }
+
+  static nsUInt32 ReadGeometryField(nsArrayPtr<const nsUInt8> data, nsUInt32 uiOffset)
+  {
+    nsUInt32 uiValue = 0;
+    nsMemoryUtils::RawByteCopy(&uiValue, data.GetPtr() + uiOffset, sizeof(nsUInt32));
+    return uiValue;
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, ShapeDictionary)
+{
+  JoltTestHelpers::EnsureJoltInitialized();
+
+  JPHShapeDictionary dictionary;
+
+  JPH::Ref<JPH::Shape> pBox = new JPH::BoxShape(JPH::Vec3(1.0f, 2.0f, 3.0f), 0.0f);
+  JPH::Ref<JPH::Shape> pSameBox = new JPH::BoxShape(JPH::Vec3(1.0f, 2.0f, 3.0f), 0.0f);
+  JPH::Ref<JPH::Shape> pSphere = new JPH::SphereShape(0.5f);
+  JPH::Ref<JPH::Shape> pMesh = CreateGridMesh();
+
+  nsUInt32 uiBoxID = JPHShapeDictionary::s_uiInvalidShapeID;
+  nsUInt32 uiSphereID = JPHShapeDictionary::s_uiInvalidShapeID;
+  nsUInt32 uiMeshID = JPHShapeDictionary::s_uiInvalidShapeID;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "RegisterShape")
+  {
+    bool bNew = false;
+    uiBoxID = dictionary.RegisterShape(pBox, bNew);
+    NS_TEST_BOOL(bNew);
+    NS_TEST_BOOL(uiBoxID != JPHShapeDictionary::s_uiInvalidShapeID);
+
+    NS_TEST_INT(dictionary.RegisterShape(pBox, bNew), uiBoxID);
+    NS_TEST_BOOL(!bNew);
+    NS_TEST_INT(dictionary.FindShapeID(pBox), uiBoxID);
+
+    // same content, different pointer
+    NS_TEST_INT(dictionary.RegisterShape(pSameBox, bNew), uiBoxID);
+    NS_TEST_BOOL(!bNew);
+
+    uiSphereID = dictionary.RegisterShape(pSphere, bNew);
+    NS_TEST_BOOL(bNew);
+    NS_TEST_BOOL(uiSphereID != uiBoxID);
+
+    uiMeshID = dictionary.RegisterShape(pMesh, bNew);
+    NS_TEST_BOOL(bNew);
+
+    NS_TEST_INT(dictionary.RegisterShape(nullptr, bNew), JPHShapeDictionary::s_uiInvalidShapeID);
+    NS_TEST_INT(dictionary.FindShapeID(nullptr), JPHShapeDictionary::s_uiInvalidShapeID);
+
+    NS_TEST_INT(dictionary.GetNumShapes(), 4);
+    NS_TEST_INT(dictionary.GetNumGeometries(), 3);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Decode Box")
+  {
+    const nsArrayPtr<const nsUInt8> data = dictionary.GetGeometryData(uiBoxID);
+    NS_TEST_INT(data[s_uiGeometryCompressionOffset], static_cast<nsUInt8>(IO::JPHPVDCompression::None));
+
+    JPHShapeGeometry geometry;
+    NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(data, geometry).Succeeded());
+    NS_TEST_INT(geometry.m_uiShapeID, uiBoxID);
+    NS_TEST_INT(geometry.m_uiType, static_cast<nsUInt8>(JPH::EShapeType::Convex));
+    NS_TEST_INT(geometry.m_uiSubType, static_cast<nsUInt8>(JPH::EShapeSubType::Box));
+    NS_TEST_VEC3(geometry.m_vBoundsMin, nsVec3(-1, -2, -3), 0.0001f);
+    NS_TEST_VEC3(geometry.m_vBoundsMax, nsVec3(1, 2, 3), 0.0001f);
+    NS_TEST_INT(geometry.m_Vertices.GetCount(), 8);
+    NS_TEST_INT(geometry.m_Indices.GetCount(), 12 * 3);
+
+    for (const nsVec3& v : geometry.m_Vertices)
+    {
+      NS_TEST_FLOAT(nsMath::Abs(v.x), 1.0f, 0.001f);
+      NS_TEST_FLOAT(nsMath::Abs(v.y), 2.0f, 0.001f);
+      NS_TEST_FLOAT(nsMath::Abs(v.z), 3.0f, 0.001f);
+    }
+
+    float fArea = 0.0f;
+    for (nsUInt32 i = 0; i < geometry.m_Indices.GetCount(); i += 3)
+    {
+      fArea += GetTriangleArea(geometry.m_Vertices[geometry.m_Indices[i]], geometry.m_Vertices[geometry.m_Indices[i + 1]], geometry.m_Vertices[geometry.m_Indices[i + 2]]);
+    }
+
+    NS_TEST_FLOAT(fArea, 2.0f * (2 * 4 + 2 * 6 + 4 * 6), 0.01f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Decode Mesh")
+  {
+    const nsArrayPtr<const nsUInt8> data = dictionary.GetGeometryData(uiMeshID);
+
+#ifdef BUILDSYSTEM_ENABLE_ZSTD_SUPPORT
+    NS_TEST_INT(data[s_uiGeometryCompressionOffset], static_cast<nsUInt8>(IO::JPHPVDCompression::Zstd));
+#endif
+
+    JPHShapeGeometry geometry;
+    NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(data, geometry).Succeeded());
+    NS_TEST_INT(geometry.m_Indices.GetCount(), s_uiGridSize * s_uiGridSize * 2 * 3);
+
+    // shared vertices are merged
+    NS_TEST_INT(geometry.m_Vertices.GetCount(), (s_uiGridSize + 1) * (s_uiGridSize + 1));
+
+    float fArea = 0.0f;
+    for (nsUInt32 i = 0; i < geometry.m_Indices.GetCount(); i += 3)
+    {
+      fArea += GetTriangleArea(geometry.m_Vertices[geometry.m_Indices[i]], geometry.m_Vertices[geometry.m_Indices[i + 1]], geometry.m_Vertices[geometry.m_Indices[i + 2]]);
+    }
+
+    const float fExpectedArea = GetGridArea();
+    NS_TEST_FLOAT(fArea, fExpectedArea, fExpectedArea * 0.001f);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Truncated Geometry")
+  {
+    JPHShapeGeometry geometry;
+
+    const nsArrayPtr<const nsUInt8> boxData = dictionary.GetGeometryData(uiBoxID);
+    for (nsUInt32 uiSize = 0; uiSize < boxData.GetCount(); ++uiSize)
+    {
+      NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(boxData.GetSubArray(0, uiSize), geometry).Failed());
+    }
+
+    const nsArrayPtr<const nsUInt8> meshData = dictionary.GetGeometryData(uiMeshID);
+    for (nsUInt32 uiSize = 0; uiSize < meshData.GetCount(); uiSize += (uiSize < s_uiGeometryHeaderSize + 64) ? 1 : 61)
+    {
+      NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(meshData.GetSubArray(0, uiSize), geometry).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt Header")
+  {
+    JPHShapeGeometry geometry;
+
+    for (nsUInt32 uiID : {uiBoxID, uiMeshID})
+    {
+      const nsArrayPtr<const nsUInt8> original = dictionary.GetGeometryData(uiID);
+      const nsUInt32 uiPayloadSize = ReadGeometryField(original, s_uiGeometryPayloadSizeOffset);
+      const nsUInt32 uiNumVertices = ReadGeometryField(original, s_uiGeometryNumVerticesOffset);
+      const nsUInt32 uiNumTriangles = ReadGeometryField(original, s_uiGeometryNumTrianglesOffset);
+
+      nsDynamicArray<nsUInt8> data;
+      data = original;
+      data[s_uiGeometryVersionOffset]++;
+      NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(data, geometry).Failed());
+
+      data = original;
+      data[s_uiGeometryCompressionOffset] = 200;
+      NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(data, geometry).Failed());
+
+      // sizes that do not match the stored data
+      const nsUInt32 payloadSizes[] = {0, uiPayloadSize - 1, uiPayloadSize + 1, 0xFFFFFFF0u};
+      for (nsUInt32 uiSize : payloadSizes)
+      {
+        data = original;
+        PatchGeometry(data, s_uiGeometryPayloadSizeOffset, uiSize);
+        NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(data, geometry).Failed());
+      }
+
+      // counts that need more or fewer bytes than the payload has, must fail before anything is allocated for them
+      const nsUInt32 vertexCounts[] = {0, uiNumVertices + 1, 0x7FFFFFFFu, 0xFFFFFFFFu};
+      for (nsUInt32 uiCount : vertexCounts)
+      {
+        data = original;
+        PatchGeometry(data, s_uiGeometryNumVerticesOffset, uiCount);
+        NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(data, geometry).Failed());
+      }
+
+      const nsUInt32 triangleCounts[] = {uiNumTriangles + 1, 0x55555556u, 0xFFFFFFFFu};
+      for (nsUInt32 uiCount : triangleCounts)
+      {
+        data = original;
+        PatchGeometry(data, s_uiGeometryNumTrianglesOffset, uiCount);
+        NS_TEST_BOOL(JPHShapeDictionary::DecodeGeometry(data, geometry).Failed());
+      }
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt Payload")
+  {
+    nsRandom rng;
+    rng.Initialize(5);
+
+    JPHShapeGeometry geometry;
+
+    for (nsUInt32 uiID : {uiBoxID, uiMeshID})
+    {
+      const nsArrayPtr<const nsUInt8> original = dictionary.GetGeometryData(uiID);
+
+      for (nsUInt32 i = 0; i < 300; ++i)
+      {
+        nsDynamicArray<nsUInt8> data;
+        data = original;
+        data[s_uiGeometryHeaderSize + rng.UIntInRange(data.GetCount() - s_uiGeometryHeaderSize)] ^= static_cast<nsUInt8>(1u << rng.UIntInRange(8));
+
+        // decoding may succeed with different positions, but indices must always be in range
+        if (JPHShapeDictionary::DecodeGeometry(data, geometry).Succeeded())
+        {
+          bool bIndicesValid = true;
+          for (nsUInt32 uiIndex : geometry.m_Indices)
+            bIndicesValid &= uiIndex < geometry.m_Vertices.GetCount();
+
+          NS_TEST_BOOL(bIndicesValid);
+        }
+      }
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "EvictReleasedShapes")
+  {
+    nsDynamicArray<nsUInt32> removedIDs;
+    dictionary.EvictReleasedShapes(removedIDs);
+    NS_TEST_INT(removedIDs.GetCount(), 0);
+
+    // the geometry stays as long as one shape uses it
+    pBox = nullptr;
+    dictionary.EvictReleasedShapes(removedIDs);
+    NS_TEST_INT(removedIDs.GetCount(), 0);
+    NS_TEST_INT(dictionary.GetNumShapes(), 3);
+    NS_TEST_BOOL(!dictionary.GetGeometryData(uiBoxID).IsEmpty());
+
+    pSameBox = nullptr;
+    pSphere = nullptr;
+    dictionary.EvictReleasedShapes(removedIDs);
+    NS_TEST_INT(removedIDs.GetCount(), 2);
+    NS_TEST_BOOL(removedIDs.Contains(uiBoxID));
+    NS_TEST_BOOL(removedIDs.Contains(uiSphereID));
+    NS_TEST_INT(dictionary.GetNumShapes(), 1);
+    NS_TEST_INT(dictionary.GetNumGeometries(), 1);
+    NS_TEST_BOOL(dictionary.GetGeometryData(uiBoxID).IsEmpty());
+
+    // IDs are never reused
+    JPH::Ref<JPH::Shape> pNewBox = new JPH::BoxShape(JPH::Vec3(1.0f, 2.0f, 3.0f), 0.0f);
+    bool bNew = false;
+    const nsUInt32 uiNewID = dictionary.RegisterShape(pNewBox, bNew);
+    NS_TEST_BOOL(bNew);
+    NS_TEST_BOOL(uiNewID != uiBoxID && uiNewID != uiSphereID && uiNewID != uiMeshID);
+
+    dictionary.Clear();
+    NS_TEST_INT(dictionary.GetNumShapes(), 0);
+    NS_TEST_INT(dictionary.GetNumGeometries(), 0);
+  }
+}
@@ -0,0 +1,373 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHSoftBodyEncoder.h>
+#include <InspectorPluginTest/JoltInterface/JoltTestHelpers.h>
+#include <Jolt/Physics/SoftBody/SoftBodyCreationSettings.h>
+#include <Jolt/Physics/SoftBody/SoftBodyMotionProperties.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  /// A flat square cloth with two faces per grid cell.
+  static JPH::Ref<JPH::SoftBodySharedSettings> CreateCloth(nsUInt32 uiGridSize)
+  {
+    JPH::Ref<JPH::SoftBodySharedSettings> pSettings = new JPH::SoftBodySharedSettings();
+
+    for (nsUInt32 y = 0; y < uiGridSize; ++y)
+    {
+      for (nsUInt32 x = 0; x < uiGridSize; ++x)
+      {
+        JPH::SoftBodySharedSettings::Vertex vertex;
+        vertex.mPosition = JPH::Float3(x * 0.1f, 0.0f, y * 0.1f);
+        pSettings->mVertices.push_back(vertex);
+      }
+    }
+
+    for (nsUInt32 y = 0; y + 1 < uiGridSize; ++y)
+    {
+      for (nsUInt32 x = 0; x + 1 < uiGridSize; ++x)
+      {
+        const nsUInt32 i = y * uiGridSize + x;
+        pSettings->AddFace(JPH::SoftBodySharedSettings::Face(i, i + uiGridSize, i + 1));
+        pSettings->AddFace(JPH::SoftBodySharedSettings::Face(i + 1, i + uiGridSize, i + uiGridSize + 1));
+      }
+    }
+
+    pSettings->Optimize();
+    return pSettings;
+  }
+
+  static JPH::Array<JPH::SoftBodyMotionProperties::Vertex>& GetSoftBodyVertices(JPH::Body* pBody)
+  {
+    return static_cast<JPH::SoftBodyMotionProperties*>(pBody->GetMotionProperties())->GetVertices();
+  }
+
+  /// Moves every vertex along a wave, so the quantized deltas are small.
+  static void WaveSoftBody(JPH::Body* pBody, float fTime)
+  {
+    for (JPH::SoftBodyMotionProperties::Vertex& vertex : GetSoftBodyVertices(pBody))
+    {
+      vertex.mPosition.SetY(0.05f * nsMath::Sin(nsAngle::MakeFromRadian(vertex.mPosition.GetX() * 10.0f + fTime)));
+    }
+  }
+
+  static nsUInt32 EncodeSoftBodies(JPHSoftBodyEncoder& ref_encoder, nsUInt64 uiStepIndex, nsArrayPtr<JPH::Body* const> bodies, nsDynamicArray<nsUInt8>& out_data)
+  {
+    ref_encoder.BeginFrame(uiStepIndex, out_data);
+
+    for (JPH::Body* pBody : bodies)
+      ref_encoder.EncodeBody(*pBody);
+
+    return ref_encoder.EndFrame() ? 1u : 0u;
+  }
+
+  static void TestSoftBodiesMatch(const JPHSoftBodyDecoder& decoder, nsArrayPtr<JPH::Body* const> bodies)
+  {
+    NS_TEST_INT(decoder.GetBodies().GetCount(), bodies.GetCount());
+
+    for (JPH::Body* pBody : bodies)
+    {
+      const JPHSoftBodyDecoder::Body* pDecoded = decoder.GetBodies().GetValue(pBody->GetID().GetIndexAndSequenceNumber());
+      NS_TEST_BOOL(pDecoded != nullptr);
+      if (pDecoded == nullptr)
+        continue;
+
+      const JPH::RVec3 vCenterOfMass = pBody->GetCenterOfMassPosition();
+      NS_TEST_VEC3(pDecoded->m_vCenterOfMass, nsVec3(static_cast<float>(vCenterOfMass.GetX()), static_cast<float>(vCenterOfMass.GetY()), static_cast<float>(vCenterOfMass.GetZ())), 0.0f);
+
+      const JPH::SoftBodyMotionProperties& motion = *static_cast<const JPH::SoftBodyMotionProperties*>(pBody->GetMotionProperties());
+      const JPHSoftBodyDecoder::Topology* pTopology = decoder.GetTopology(pDecoded->m_uiTopologyID);
+      NS_TEST_BOOL(pTopology != nullptr);
+      if (pTopology == nullptr)
+        continue;
+
+      NS_TEST_INT(pTopology->m_uiNumVertices, motion.GetVertices().size());
+      NS_TEST_INT(pTopology->m_Indices.GetCount(), motion.GetFaces().size() * 3);
+
+      bool bIndicesMatch = pTopology->m_Indices.GetCount() == motion.GetFaces().size() * 3;
+      for (nsUInt32 i = 0; bIndicesMatch && i < pTopology->m_Indices.GetCount(); ++i)
+        bIndicesMatch = pTopology->m_Indices[i] == motion.GetFaces()[i / 3].mVertex[i % 3];
+
+      NS_TEST_BOOL(bIndicesMatch);
+
+      NS_TEST_INT(pDecoded->m_Positions.GetCount(), motion.GetVertices().size());
+      if (pDecoded->m_Positions.GetCount() != motion.GetVertices().size())
+        continue;
+
+      // rounding to the nearest quantization step is off by at most half a step
+      const nsVec3 vMaxError = pDecoded->m_vQuantum * 0.5f + nsVec3(1e-5f);
+      bool bPositionsMatch = true;
+
+      for (nsUInt32 i = 0; i < pDecoded->m_Positions.GetCount(); ++i)
+      {
+        const JPH::Vec3 vPosition = motion.GetVertex(i).mPosition;
+        const nsVec3 vError = (pDecoded->m_Positions[i] - nsVec3(vPosition.GetX(), vPosition.GetY(), vPosition.GetZ())).Abs();
+        bPositionsMatch = bPositionsMatch && vError.x <= vMaxError.x && vError.y <= vMaxError.y && vError.z <= vMaxError.z;
+      }
+
+      NS_TEST_BOOL(bPositionsMatch);
+    }
+  }
+
+  /// Checks the invariants a consumer of a successfully decoded frame relies on.
+  static bool IsSoftBodyStateConsistent(const JPHSoftBodyDecoder& decoder)
+  {
+    for (auto it : decoder.GetBodies())
+    {
+      const JPHSoftBodyDecoder::Topology* pTopology = decoder.GetTopology(it.Value().m_uiTopologyID);
+      if (pTopology == nullptr || it.Value().m_Positions.GetCount() != pTopology->m_uiNumVertices)
+        return false;
+
+      for (nsUInt32 uiIndex : pTopology->m_Indices)
+      {
+        if (uiIndex >= pTopology->m_uiNumVertices)
+          return false;
+      }
+    }
+
+    return true;
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, SoftBodyEncoder)
+{
+  JoltTestHelpers::TestPhysicsSystem physics;
+  JPH::BodyInterface& bodyInterface = physics.GetBodyInterface();
+
+  JPH::Ref<JPH::SoftBodySharedSettings> pLargeCloth = CreateCloth(8);
+  JPH::Ref<JPH::SoftBodySharedSettings> pSmallCloth = CreateCloth(4);
+
+  // two bodies share a topology
+  JPH::Body* pBodies[3] = {
+    bodyInterface.CreateSoftBody(JPH::SoftBodyCreationSettings(pLargeCloth, JPH::RVec3(0, 2, 0), JPH::Quat::sIdentity(), 0)),
+    bodyInterface.CreateSoftBody(JPH::SoftBodyCreationSettings(pLargeCloth, JPH::RVec3(5, 3, 0), JPH::Quat::sIdentity(), 0)),
+    bodyInterface.CreateSoftBody(JPH::SoftBodyCreationSettings(pSmallCloth, JPH::RVec3(-5, 1, 2), JPH::Quat::sIdentity(), 0)),
+  };
+
+  JPHSoftBodyEncoder encoder;
+  JPHSoftBodyDecoder decoder;
+  nsDynamicArray<nsUInt8> keyframe;
+  nsDynamicArray<nsUInt8> deltaFrame;
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Keyframe")
+  {
+    NS_TEST_INT(EncodeSoftBodies(encoder, 1, pBodies, keyframe), 1);
+    NS_TEST_INT(encoder.GetNumBodies(), 3);
+    NS_TEST_INT(encoder.GetNumEncodedVertices(), 64 + 64 + 16);
+
+    NS_TEST_BOOL(decoder.DecodeFrame(keyframe).Succeeded());
+    NS_TEST_INT(decoder.GetStepIndex(), 1);
+    TestSoftBodiesMatch(decoder, pBodies);
+
+    const JPHSoftBodyDecoder::Body* pFirst = decoder.GetBodies().GetValue(pBodies[0]->GetID().GetIndexAndSequenceNumber());
+    const JPHSoftBodyDecoder::Body* pSecond = decoder.GetBodies().GetValue(pBodies[1]->GetID().GetIndexAndSequenceNumber());
+    NS_TEST_BOOL(pFirst != nullptr && pSecond != nullptr);
+    if (pFirst != nullptr && pSecond != nullptr)
+    {
+      NS_TEST_INT(pFirst->m_uiTopologyID, pSecond->m_uiTopologyID);
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Delta Frames")
+  {
+    for (nsUInt32 uiStep = 2; uiStep < 30; ++uiStep)
+    {
+      WaveSoftBody(pBodies[0], uiStep * 0.1f);
+      WaveSoftBody(pBodies[2], uiStep * -0.2f);
+
+      NS_TEST_INT(EncodeSoftBodies(encoder, uiStep, pBodies, deltaFrame), 0);
+      NS_TEST_BOOL(deltaFrame.GetCount() < keyframe.GetCount());
+
+      NS_TEST_BOOL(decoder.DecodeFrame(deltaFrame).Succeeded());
+      NS_TEST_INT(decoder.GetStepIndex(), uiStep);
+      TestSoftBodiesMatch(decoder, pBodies);
+    }
+
+    // nothing moved, only the body headers are sent
+    EncodeSoftBodies(encoder, 30, pBodies, deltaFrame);
+    NS_TEST_INT(deltaFrame.GetCount(), 24 + 3 * (4 + 1 + 1 + 12));
+    NS_TEST_BOOL(decoder.DecodeFrame(deltaFrame).Succeeded());
+    TestSoftBodiesMatch(decoder, pBodies);
+
+    // a vertex that leaves the bounds makes the encoder send new bounds
+    GetSoftBodyVertices(pBodies[1])[5].mPosition += JPH::Vec3(3, -2, 1);
+    EncodeSoftBodies(encoder, 31, pBodies, deltaFrame);
+    NS_TEST_BOOL(decoder.DecodeFrame(deltaFrame).Succeeded());
+    TestSoftBodiesMatch(decoder, pBodies);
+
+    GetSoftBodyVertices(pBodies[1])[5].mPosition -= JPH::Vec3(3, -2, 1);
+    EncodeSoftBodies(encoder, 32, pBodies, deltaFrame);
+    NS_TEST_BOOL(decoder.DecodeFrame(deltaFrame).Succeeded());
+    TestSoftBodiesMatch(decoder, pBodies);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Removed Bodies")
+  {
+    // the shared topology stays as long as one body uses it
+    JPH::Body* remaining[] = {pBodies[0], pBodies[2]};
+    EncodeSoftBodies(encoder, 33, remaining, deltaFrame);
+    NS_TEST_INT(encoder.GetNumBodies(), 2);
+    NS_TEST_BOOL(decoder.DecodeFrame(deltaFrame).Succeeded());
+    TestSoftBodiesMatch(decoder, remaining);
+
+    const nsUInt32 uiSmallTopology = decoder.GetBodies().GetValue(pBodies[2]->GetID().GetIndexAndSequenceNumber())->m_uiTopologyID;
+
+    JPH::Body* first[] = {pBodies[0]};
+    EncodeSoftBodies(encoder, 34, first, deltaFrame);
+    NS_TEST_BOOL(decoder.DecodeFrame(deltaFrame).Succeeded());
+    TestSoftBodiesMatch(decoder, first);
+    NS_TEST_BOOL(decoder.GetTopology(uiSmallTopology) == nullptr);
+
+    // returning bodies are sent in full, a released topology under a new ID
+    EncodeSoftBodies(encoder, 35, pBodies, deltaFrame);
+    NS_TEST_BOOL(decoder.DecodeFrame(deltaFrame).Succeeded());
+    TestSoftBodiesMatch(decoder, pBodies);
+    NS_TEST_BOOL(decoder.GetBodies().GetValue(pBodies[2]->GetID().GetIndexAndSequenceNumber())->m_uiTopologyID != uiSmallTopology);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Requested Keyframe")
+  {
+    WaveSoftBody(pBodies[1], 1.0f);
+    encoder.RequestKeyframe();
+    NS_TEST_INT(EncodeSoftBodies(encoder, 36, pBodies, keyframe), 1);
+
+    // a keyframe can be decoded without anything before it
+    JPHSoftBodyDecoder lateDecoder;
+    NS_TEST_BOOL(lateDecoder.DecodeFrame(keyframe).Succeeded());
+    TestSoftBodiesMatch(lateDecoder, pBodies);
+
+    NS_TEST_BOOL(decoder.DecodeFrame(keyframe).Succeeded());
+    TestSoftBodiesMatch(decoder, pBodies);
+
+    WaveSoftBody(pBodies[1], 1.1f);
+    NS_TEST_INT(EncodeSoftBodies(encoder, 37, pBodies, deltaFrame), 0);
+
+    JPHSoftBodyDecoder newDecoder;
+    NS_TEST_BOOL(newDecoder.DecodeFrame(deltaFrame).Failed());
+
+    NS_TEST_BOOL(lateDecoder.DecodeFrame(deltaFrame).Succeeded());
+    TestSoftBodiesMatch(lateDecoder, pBodies);
+
+    encoder.Reset();
+    NS_TEST_INT(EncodeSoftBodies(encoder, 38, pBodies, keyframe), 1);
+    NS_TEST_BOOL(lateDecoder.DecodeFrame(keyframe).Succeeded());
+    TestSoftBodiesMatch(lateDecoder, pBodies);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Truncated")
+  {
+    WaveSoftBody(pBodies[0], 2.0f);
+    EncodeSoftBodies(encoder, 39, pBodies, deltaFrame);
+
+    for (nsUInt32 uiSize = 0; uiSize < keyframe.GetCount(); ++uiSize)
+    {
+      JPHSoftBodyDecoder truncatedDecoder;
+      NS_TEST_BOOL(truncatedDecoder.DecodeFrame(keyframe.GetArrayPtr().GetSubArray(0, uiSize)).Failed());
+    }
+
+    for (nsUInt32 uiSize = 0; uiSize < deltaFrame.GetCount(); ++uiSize)
+    {
+      JPHSoftBodyDecoder truncatedDecoder;
+      NS_TEST_BOOL(truncatedDecoder.DecodeFrame(keyframe).Succeeded());
+      NS_TEST_BOOL(truncatedDecoder.DecodeFrame(deltaFrame.GetArrayPtr().GetSubArray(0, uiSize)).Failed());
+    }
+
+    JPHSoftBodyDecoder fullDecoder;
+    NS_TEST_BOOL(fullDecoder.DecodeFrame(keyframe).Succeeded());
+    NS_TEST_BOOL(fullDecoder.DecodeFrame(deltaFrame).Succeeded());
+    TestSoftBodiesMatch(fullDecoder, pBodies);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt")
+  {
+    // a new encoder starts with topology ID 0
+    JPHSoftBodyEncoder newEncoder;
+    EncodeSoftBodies(newEncoder, 40, pBodies, keyframe);
+
+    // header (24 bytes), then the first body: u32 ID, u8 flags, varint topology ID, float[3] center of mass,
+    // and its topology: varint vertex count, varint face count, varint index deltas
+    constexpr nsUInt32 uiFlagsOffset = 28;
+    constexpr nsUInt32 uiTopologyIDOffset = 29;
+    constexpr nsUInt32 uiNumVerticesOffset = 42;
+    constexpr nsUInt32 uiFirstIndexOffset = 44;
+
+    NS_TEST_INT(keyframe[uiTopologyIDOffset], 0);
+    NS_TEST_INT(keyframe[uiNumVerticesOffset], 64);
+
+    auto DecodeWithByte = [&](nsUInt32 uiOffset, nsUInt8 uiValue) -> nsResult
+    {
+      nsDynamicArray<nsUInt8> corrupt = keyframe;
+      corrupt[uiOffset] = uiValue;
+
+      JPHSoftBodyDecoder corruptDecoder;
+      return corruptDecoder.DecodeFrame(corrupt);
+    };
+
+    NS_TEST_BOOL(DecodeWithByte(0, keyframe[0] ^ 1).Failed());
+    NS_TEST_BOOL(DecodeWithByte(4, JPHSoftBodyEncoder::s_uiFrameVersion + 1).Failed());
+
+    // a delta frame without a keyframe
+    NS_TEST_BOOL(DecodeWithByte(5, 0).Failed());
+
+    // without the topology the body refers to an unknown one
+    NS_TEST_BOOL(DecodeWithByte(uiFlagsOffset, JPHSoftBodyEncoder::Body_Bounds).Failed());
+
+    // the body that shares the topology refers to an ID that was never sent
+    NS_TEST_BOOL(DecodeWithByte(uiTopologyIDOffset, 1).Failed());
+
+    // topology IDs are never reused, a delta frame cannot send a known one again
+    {
+      nsDynamicArray<nsUInt8> corrupt = keyframe;
+      corrupt[5] = 0;
+
+      JPHSoftBodyDecoder corruptDecoder;
+      NS_TEST_BOOL(corruptDecoder.DecodeFrame(keyframe).Succeeded());
+      NS_TEST_BOOL(corruptDecoder.DecodeFrame(corrupt).Failed());
+    }
+
+    // face indices beyond the vertex count
+    NS_TEST_BOOL(DecodeWithByte(uiNumVerticesOffset, 3).Failed());
+    NS_TEST_BOOL(DecodeWithByte(uiFirstIndexOffset, 127).Failed());
+    NS_TEST_BOOL(DecodeWithByte(uiFirstIndexOffset, 1).Failed());
+
+    // more vertices than the frame holds positions for, a 5 byte varint
+    {
+      nsDynamicArray<nsUInt8> corrupt;
+      corrupt = keyframe.GetArrayPtr().GetSubArray(0, uiNumVerticesOffset);
+      const nsUInt8 hugeCount[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F};
+      corrupt.PushBackRange(nsArrayPtr<const nsUInt8>(hugeCount));
+      corrupt.PushBackRange(keyframe.GetArrayPtr().GetSubArray(uiNumVerticesOffset + 1));
+
+      JPHSoftBodyDecoder corruptDecoder;
+      NS_TEST_BOOL(corruptDecoder.DecodeFrame(corrupt).Failed());
+    }
+
+    nsDynamicArray<nsUInt8> trailing = keyframe;
+    trailing.PushBack(0);
+
+    JPHSoftBodyDecoder trailingDecoder;
+    NS_TEST_BOOL(trailingDecoder.DecodeFrame(trailing).Failed());
+
+    nsRandom rng;
+    rng.Initialize(14);
+
+    for (nsUInt32 i = 0; i < 1000; ++i)
+    {
+      nsDynamicArray<nsUInt8> corrupt = (i % 2) == 0 ? keyframe : deltaFrame;
+      corrupt[rng.UIntInRange(corrupt.GetCount())] ^= static_cast<nsUInt8>(1u << rng.UIntInRange(8));
+
+      JPHSoftBodyDecoder corruptDecoder;
+      if ((i % 2) != 0)
+        corruptDecoder.DecodeFrame(keyframe).IgnoreResult();
+
+      if (corruptDecoder.DecodeFrame(corrupt).Succeeded())
+      {
+        NS_TEST_BOOL(IsSoftBodyStateConsistent(corruptDecoder));
+      }
+    }
+  }
+
+  for (JPH::Body* pBody : pBodies)
+    bodyInterface.DestroyBody(pBody->GetID());
+}
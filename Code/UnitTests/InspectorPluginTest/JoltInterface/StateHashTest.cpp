@@ -0,0 +1,187 @@
+#include <InspectorPluginTest/InspectorPluginTestPCH.h>
+
+#include <InspectorPlugin/JoltInterface/JPHBodySnapshot.h>
+#include <InspectorPlugin/JoltInterface/JPHStateHash.h>
+
+namespace
+{
+  using namespace JDebug::API;
+
+  static void FillHashedSnapshot(JPHBodySnapshot& ref_snapshot, nsUInt32 uiNumSlots, nsRandom& ref_rng)
+  {
+    ref_snapshot.SetSlotCount(uiNumSlots);
+    ref_snapshot.ClearSlots();
+
+    for (nsUInt32 uiSlot = 0; uiSlot < uiNumSlots; ++uiSlot)
+    {
+      // leave some holes, like removed bodies do
+      if (uiSlot % 5 == 4)
+        continue;
+
+      ref_snapshot.m_BodyIDs[uiSlot] = uiSlot;
+      ref_snapshot.m_States[uiSlot] = JPHBodySnapshot::JPHBodyStateFlags::Valid;
+      ref_snapshot.m_MotionTypes[uiSlot] = 2;
+      ref_snapshot.m_ObjectLayers[uiSlot] = 1;
+      ref_snapshot.m_Positions[uiSlot].Set(ref_rng.FloatMinMax(-100, 100), ref_rng.FloatMinMax(-100, 100), ref_rng.FloatMinMax(-100, 100));
+      ref_snapshot.m_Rotations[uiSlot] = nsQuat::MakeIdentity();
+      ref_snapshot.m_LinearVelocities[uiSlot].Set(ref_rng.FloatMinMax(-10, 10), 0, 0);
+      ref_snapshot.m_AngularVelocities[uiSlot].SetZero();
+    }
+  }
+
+  /// Returns the fields of the given range whose sub-hashes differ.
+  static nsUInt8 GetChangedFields(const JPHStateHash& a, const JPHStateHash& b, nsUInt32 uiRange)
+  {
+    nsUInt8 uiFields = 0;
+
+    for (nsUInt32 uiField = 0; uiField < JPHStateHash::s_uiNumFields; ++uiField)
+    {
+      if (a.GetSubHash(uiRange, uiField) != b.GetSubHash(uiRange, uiField))
+        uiFields |= static_cast<nsUInt8>(NS_BIT(uiField));
+    }
+
+    return uiFields;
+  }
+} // namespace
+
+NS_CREATE_SIMPLE_TEST(JoltInterface, StateHash)
+{
+  constexpr nsUInt32 uiNumSlots = 1000;
+  constexpr nsUInt32 uiSlotsPerRange = 64;
+  constexpr nsUInt32 uiNumRanges = (uiNumSlots + uiSlotsPerRange - 1) / uiSlotsPerRange;
+
+  nsRandom rng;
+  rng.Initialize(11);
+
+  JPHBodySnapshot snapshot;
+  FillHashedSnapshot(snapshot, uiNumSlots, rng);
+
+  JPHStateHash hash;
+  hash.Compute(snapshot, uiSlotsPerRange);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Compute")
+  {
+    NS_TEST_INT(hash.m_uiNumSlots, uiNumSlots);
+    NS_TEST_INT(hash.m_uiSlotsPerRange, uiSlotsPerRange);
+    NS_TEST_INT(hash.GetNumRanges(), uiNumRanges);
+
+    JPHStateHash same;
+    same.Compute(snapshot, uiSlotsPerRange);
+    NS_TEST_BOOL(same.m_uiRootHash == hash.m_uiRootHash);
+    NS_TEST_BOOL(same.m_SubHashes == hash.m_SubHashes);
+
+    // stale data in unused slots does not count
+    JPHBodySnapshot modified = snapshot;
+    NS_TEST_BOOL(!modified.IsValid(4));
+    modified.m_Positions[4].Set(1, 2, 3);
+    same.Compute(modified, uiSlotsPerRange);
+    NS_TEST_BOOL(same.m_uiRootHash == hash.m_uiRootHash);
+
+    // a change is attributed to its range and field
+    constexpr nsUInt32 uiSlot = 300;
+    modified = snapshot;
+    modified.m_Positions[uiSlot].y += 0.001f;
+
+    JPHStateHash changed;
+    changed.Compute(modified, uiSlotsPerRange);
+    NS_TEST_BOOL(changed.m_uiRootHash != hash.m_uiRootHash);
+
+    for (nsUInt32 uiRange = 0; uiRange < uiNumRanges; ++uiRange)
+    {
+      NS_TEST_INT(GetChangedFields(hash, changed, uiRange), uiRange == uiSlot / uiSlotsPerRange ? StateHash_Position : 0);
+    }
+
+    // removing a body changes its range in all fields
+    modified = snapshot;
+    modified.ClearSlot(uiSlot);
+    changed.Compute(modified, uiSlotsPerRange);
+
+    for (nsUInt32 uiRange = 0; uiRange < uiNumRanges; ++uiRange)
+    {
+      NS_TEST_INT(GetChangedFields(hash, changed, uiRange), uiRange == uiSlot / uiSlotsPerRange ? NS_BIT(JPHStateHash::s_uiNumFields) - 1 : 0);
+    }
+
+    // the slot count is part of the root hash, even if the added slots are empty
+    modified = snapshot;
+    modified.SetSlotCount(uiNumSlots + 1);
+    modified.ClearSlot(uiNumSlots);
+    changed.Compute(modified, uiSlotsPerRange);
+    NS_TEST_BOOL(changed.m_uiRootHash != hash.m_uiRootHash);
+
+    JPHBodySnapshot empty;
+    changed.Compute(empty, 0);
+    NS_TEST_INT(changed.GetNumRanges(), 0);
+    NS_TEST_INT(changed.m_uiSlotsPerRange, 1);
+  }
+
+  nsDynamicArray<nsUInt8> data;
+  hash.Write(data);
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Round Trip")
+  {
+    NS_TEST_INT(data.GetCount(), 20 + uiNumRanges * JPHStateHash::s_uiNumFields * sizeof(nsUInt64));
+
+    JPHStateHash decoded;
+    NS_TEST_BOOL(decoded.Read(data).Succeeded());
+    NS_TEST_BOOL(decoded.m_uiRootHash == hash.m_uiRootHash);
+    NS_TEST_INT(decoded.m_uiSlotsPerRange, hash.m_uiSlotsPerRange);
+    NS_TEST_INT(decoded.m_uiNumSlots, hash.m_uiNumSlots);
+    NS_TEST_BOOL(decoded.m_SubHashes == hash.m_SubHashes);
+
+    JPHStateHash empty;
+    empty.Compute(JPHBodySnapshot(), 16);
+    nsDynamicArray<nsUInt8> emptyData;
+    empty.Write(emptyData);
+    NS_TEST_BOOL(decoded.Read(emptyData).Succeeded());
+    NS_TEST_INT(decoded.GetNumRanges(), 0);
+    NS_TEST_BOOL(decoded.m_uiRootHash == empty.m_uiRootHash);
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Truncated")
+  {
+    JPHStateHash decoded;
+
+    for (nsUInt32 uiSize = 0; uiSize < data.GetCount(); ++uiSize)
+    {
+      NS_TEST_BOOL(decoded.Read(data.GetArrayPtr().GetSubArray(0, uiSize)).Failed());
+    }
+  }
+
+  NS_TEST_BLOCK(nsTestBlock::Enabled, "Corrupt")
+  {
+    // header: u64 root hash, u32 slots per range, u32 slot count, u32 range count
+    constexpr nsUInt32 uiSlotsPerRangeOffset = 8;
+    constexpr nsUInt32 uiNumSlotsOffset = 12;
+    constexpr nsUInt32 uiNumRangesOffset = 16;
+
+    auto ReadWithValue = [&](nsUInt32 uiOffset, nsUInt32 uiValue) -> nsResult
+    {
+      nsDynamicArray<nsUInt8> corrupt = data;
+      nsMemoryUtils::RawByteCopy(corrupt.GetData() + uiOffset, &uiValue, sizeof(nsUInt32));
+
+      JPHStateHash decoded;
+      return decoded.Read(corrupt);
+    };
+
+    NS_TEST_BOOL(ReadWithValue(uiSlotsPerRangeOffset, 0).Failed());
+    NS_TEST_BOOL(ReadWithValue(uiNumRangesOffset, 0xFFFFFFFFu).Failed());
+    NS_TEST_BOOL(ReadWithValue(uiNumRangesOffset, 0x40000000u).Failed());
+    NS_TEST_BOOL(ReadWithValue(uiNumRangesOffset, uiNumRanges - 1).Failed());
+
+    // the ranges have to cover the slots
+    NS_TEST_BOOL(ReadWithValue(uiNumSlotsOffset, uiNumSlots + uiSlotsPerRange).Failed());
+    NS_TEST_BOOL(ReadWithValue(uiNumSlotsOffset, (uiNumRanges - 1) * uiSlotsPerRange).Failed());
+    NS_TEST_BOOL(ReadWithValue(uiNumSlotsOffset, 0xFFFFFFFFu).Failed());
+    NS_TEST_BOOL(ReadWithValue(uiSlotsPerRangeOffset, 1).Failed());
+    NS_TEST_BOOL(ReadWithValue(uiSlotsPerRangeOffset, 0xFFFFFFFFu).Failed());
+
+    // any slot count that needs the same number of ranges is consistent
+    NS_TEST_BOOL(ReadWithValue(uiNumSlotsOffset, (uiNumRanges - 1) * uiSlotsPerRange + 1).Succeeded());
+
+    nsDynamicArray<nsUInt8> trailing = data;
+    trailing.PushBack(0);
+
+    JPHStateHash decoded;
+    NS_TEST_BOOL(decoded.Read(trailing).Failed());
+  }
+}